@@ -38,6 +38,8 @@
 #include "DbSubDMesh.h"
 #include "../../../../Components/Imports/STLImport/Include/STLImport.h"
 #include "Ge/GeTrMeshSimplification.h"
+#include "Ge/GeTrMeshLodSimplification.h"
+#include "OdPerfTimer.h"
 
 static void FMCreateBody(OdEdCommandContext* pCmdCtx, ExFmBody* pMyEnt, int color = 0)
 {
@@ -789,6 +791,70 @@ void _FMBodySimplification_func(OdEdCommandContext* pCmdCtx)
   }
 }
 
+void _FMBodySimplificationLod_func(OdEdCommandContext* pCmdCtx)
+{
+  OdDbCommandContextPtr pDbCmdCtx(pCmdCtx);
+  OdDbUserIO* pIO = (OdDbUserIO*)pDbCmdCtx->userIO();
+
+  OdDbSelectionSetIteratorPtr pIter = pIO->select(OD_T("Select FM bodies"))->newIterator();
+  OdArray<ExFmBodyPtr> aBody;
+  for (; !pIter->done(); pIter->next())
+  {
+    ExFmBodyPtr body = ExFmBody::cast(pIter->objectId().openObject());
+    if (body.isNull())
+      continue;
+    aBody.push_back(body);
+  }
+
+  if (aBody.logicalLength() == 0)
+  {
+    pIO->putError("No bodies are selected");
+    return;
+  }
+
+  // Benchmarks single edge collapse run producing all levels against parallel partitioned run
+  static const double aPercents[] = { 50., 75., 90., 97. };
+  const unsigned nLevels = sizeof(aPercents) / sizeof(aPercents[0]);
+  OdPerfTimerWrapper timer;
+  for (unsigned int i = 0; i < aBody.logicalLength(); ++i)
+  {
+    OdArray<FacetModeler::Body> bodies;
+    aBody[i]->getBodies(bodies);
+    for (unsigned int iBody = 0; iBody < bodies.logicalLength(); ++iBody)
+    {
+      GeMesh::OdGeTrMesh mesh;
+      bodies[iBody].generateMesh(mesh);
+      if (mesh.m_aTr.isEmpty())
+        continue;
+      pIO->putString(OdString().format(OD_T("Body %d: %d triangles"), iBody, mesh.m_aTr.logicalLength()));
+      for (int bParallel = 0; bParallel < 2; ++bParallel)
+      {
+        OdArray<GeMesh::OdGeTrMesh> levels;
+        timer.getTimer()->start();
+        if (bParallel)
+        {
+          GeMesh::GeTrngLodSimplification::buildLevelsParallel(mesh, aPercents, nLevels, levels);
+        }
+        else
+        {
+          GeMesh::GeTrngLodSimplification simp;
+          simp.reset(mesh);
+          simp.buildLevels(aPercents, nLevels, levels);
+        }
+        timer.getTimer()->stop();
+        const double sec = odmax(timer.getTimer()->countedSec(), 1e-6);
+        pIO->putString(OdString().format(OD_T("  %ls: %.3f sec, %.0f triangles/sec"), bParallel ? OD_T("Parallel") : OD_T("Serial"),
+          sec, mesh.m_aTr.logicalLength() / sec));
+        for (unsigned int l = 0; l < levels.logicalLength(); ++l)
+        {
+          pIO->putString(OdString().format(OD_T("    %.0f%%: %d triangles, Hausdorff error %g"), aPercents[l],
+            levels[l].m_aTr.logicalLength(), GeMesh::GeTrngLodSimplification::hausdorffDistance(mesh, levels[l], 1000)));
+        }
+      }
+    }
+  }
+}
+
 void _FMBodyConvert2SubDMesh_func(OdEdCommandContext* pCmdCtx)
 {
   // Get user IO
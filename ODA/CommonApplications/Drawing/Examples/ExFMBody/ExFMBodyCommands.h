@@ -45,6 +45,7 @@ CMD_DEF(FMBodyConvert, OD_T("FacetModeler Commands"))
 CMD_DEF(FMBooleanDemo, OD_T("FacetModeler Commands"))
 CMD_DEF(FMBodyShaded, OD_T("FacetModeler Commands"))
 CMD_DEF(FMBodySimplification, OD_T("FacetModeler Commands"))
+CMD_DEF(FMBodySimplificationLod, OD_T("FacetModeler Commands"))
 CMD_DEF(FMBodyConvert2SubDMesh, OD_T("FacetModeler Commands"))
 
 #ifdef DO_UNDEF_CMD_DEF
@@ -82,6 +82,10 @@ CMD_DEF       ( DIGITALSIGN               , L"File")
 CMD_DEF       ( SIGVALIDATE               , L"File")
 
 CMD_DEF       ( Purge                     , L"Drawing Utilities")
+CMD_DEF       ( IdMapBenchmark            , L"Drawing Utilities")
+CMD_DEF       ( UndoRecordStoreTest       , L"Drawing Utilities")
+CMD_DEF       ( SvgExportTest             , L"Drawing Utilities")
+CMD_DEF       ( TiledRasterImageTest      , L"Drawing Utilities")
 
 CMD_DEF       ( GeoMarkPosition           , L"GeoMap")
 
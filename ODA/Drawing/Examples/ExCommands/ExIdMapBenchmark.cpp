@@ -0,0 +1,149 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+#include "DbDatabase.h"
+#include "DbCommandContext.h"
+#include "Ed/EdUserIO.h"
+#include "OdIdHashMap.h"
+#include "OdPerfTimer.h"
+
+#define STL_USING_MAP
+#include "OdaSTL.h"
+
+namespace IdMapBenchmark
+{
+  enum { kLookups = 8 }; // Every mapped id is queried several times during conversion
+
+  struct Result
+  {
+    double m_insertTime;
+    double m_lookupTime;
+    OdUInt32 m_nFound;
+    OdUInt32 m_nCapacity;
+
+    Result() : m_insertTime(0.), m_lookupTime(0.), m_nFound(0), m_nCapacity(0) { }
+  };
+
+  void collectIds(OdDbDatabase* pDb, OdDbObjectIdArray& ids);
+  Result runStdMap(const OdDbObjectIdArray& ids);
+  Result runHashMap(const OdDbObjectIdArray& ids, OdUInt32 nReserve, const OdDbHandle* pHandseed);
+  OdString format(const OdChar* name, const Result& res, OdUInt32 nEntrySize);
+}
+
+void IdMapBenchmark::collectIds(OdDbDatabase* pDb, OdDbObjectIdArray& ids)
+{
+  const OdUInt64 nHandseed = (OdUInt64)pDb->handseed();
+  ids.reserve((OdUInt32)odmax(pDb->approxNumObjects(), (OdInt32)0));
+  for (OdUInt64 nHandle = 1; nHandle < nHandseed; ++nHandle)
+  {
+    OdDbObjectId id = pDb->getOdDbObjectId(OdDbHandle(nHandle));
+    if (!id.isNull())
+      ids.append(id);
+  }
+}
+
+IdMapBenchmark::Result IdMapBenchmark::runStdMap(const OdDbObjectIdArray& ids)
+{
+  Result res;
+  OdPerfTimerWrapper timer;
+  std::map<OdDbObjectId, OdDbObjectId> idMap;
+  timer.getTimer()->start();
+  for (OdUInt32 i = 0; i < ids.size(); ++i)
+    idMap[ids[i]] = ids[ids.size() - 1 - i];
+  timer.getTimer()->stop();
+  res.m_insertTime = timer.getTimer()->countedSec();
+  timer.getTimer()->start();
+  for (int nPass = 0; nPass < kLookups; ++nPass)
+  {
+    for (OdUInt32 i = 0; i < ids.size(); ++i)
+    {
+      if (idMap.find(ids[i]) != idMap.end())
+        ++res.m_nFound;
+    }
+  }
+  timer.getTimer()->stop();
+  res.m_lookupTime = timer.getTimer()->countedSec();
+  res.m_nCapacity = (OdUInt32)idMap.size();
+  return res;
+}
+
+IdMapBenchmark::Result IdMapBenchmark::runHashMap(const OdDbObjectIdArray& ids, OdUInt32 nReserve, const OdDbHandle* pHandseed)
+{
+  Result res;
+  OdPerfTimerWrapper timer;
+  OdIdHashMap<OdDbObjectId, OdDbObjectId> idMap;
+  timer.getTimer()->start();
+  if (pHandseed)
+    idMap.reserveByHandseed(*pHandseed);
+  else if (nReserve)
+    idMap.reserve(nReserve);
+  for (OdUInt32 i = 0; i < ids.size(); ++i)
+    idMap[ids[i]] = ids[ids.size() - 1 - i];
+  timer.getTimer()->stop();
+  res.m_insertTime = timer.getTimer()->countedSec();
+  timer.getTimer()->start();
+  for (int nPass = 0; nPass < kLookups; ++nPass)
+  {
+    for (OdUInt32 i = 0; i < ids.size(); ++i)
+    {
+      if (idMap.contains(ids[i]))
+        ++res.m_nFound;
+    }
+  }
+  timer.getTimer()->stop();
+  res.m_lookupTime = timer.getTimer()->countedSec();
+  res.m_nCapacity = idMap.capacity();
+  return res;
+}
+
+OdString IdMapBenchmark::format(const OdChar* name, const Result& res, OdUInt32 nEntrySize)
+{
+  OdString str;
+  str.format(OD_T("%ls: insert %.3f s, lookup %.3f s, found %u, entries %u (%u KB)"), name,
+    res.m_insertTime, res.m_lookupTime, res.m_nFound, res.m_nCapacity, (OdUInt32)(OdUInt64(res.m_nCapacity) * nEntrySize / 1024));
+  return str;
+}
+
+void _IdMapBenchmark_func(OdEdCommandContext* pCmdCtx)
+{
+  OdDbCommandContextPtr pDbCmdCtx(pCmdCtx);
+  OdDbDatabasePtr pDb = pDbCmdCtx->database();
+  OdEdUserIO* pIO = pDbCmdCtx->userIO();
+
+  OdDbObjectIdArray ids;
+  IdMapBenchmark::collectIds(pDb, ids);
+  OdString str;
+  str.format(OD_T("Objects: %u, handseed: %ls"), ids.size(), pDb->handseed().ascii().c_str());
+  pIO->putString(str);
+
+  // Entry sizes: tree node with two ids and three links, hash table entry with two ids
+  const OdUInt32 nNodeSize = 2 * sizeof(OdDbObjectId) + 3 * sizeof(void*) + sizeof(int);
+  const OdUInt32 nEntrySize = 2 * sizeof(OdDbObjectId);
+  const OdDbHandle handseed = pDb->handseed();
+  pIO->putString(IdMapBenchmark::format(OD_T("std::map"), IdMapBenchmark::runStdMap(ids), nNodeSize));
+  pIO->putString(IdMapBenchmark::format(OD_T("OdIdHashMap, no reserve"), IdMapBenchmark::runHashMap(ids, 0, NULL), nEntrySize));
+  pIO->putString(IdMapBenchmark::format(OD_T("OdIdHashMap, reserve by objects count"),
+    IdMapBenchmark::runHashMap(ids, (OdUInt32)odmax(pDb->approxNumObjects(), (OdInt32)0), NULL), nEntrySize));
+  pIO->putString(IdMapBenchmark::format(OD_T("OdIdHashMap, reserve by handseed"), IdMapBenchmark::runHashMap(ids, 0, &handseed), nEntrySize));
+}
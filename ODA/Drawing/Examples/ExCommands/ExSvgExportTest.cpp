@@ -0,0 +1,239 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+#include "DbHostAppServices.h"
+#include "DbBlockTable.h"
+#include "DbBlockReference.h"
+#include "DbPolyline.h"
+#include "DbCircle.h"
+#include "RxVariantValue.h"
+#include "MemoryStream.h"
+#include "ColorMapping.h"
+#include "GiContextForDbDatabase.h"
+#include "Gs/GsDevicePool.h"
+#include "Ge/GeExtents3d.h"
+#include "Ge/GeScale3d.h"
+
+#define STL_USING_SET
+#define STL_USING_STRING
+#include "OdaSTL.h"
+
+namespace SvgExportTest
+{
+  enum { kRefs = 4 }; // Three references differ by rotation and position, the last one is scaled
+
+  void createDrawing(OdDbDatabase* pDb);
+  OdAnsiString exportSvg(OdDbDatabase* pDb, bool bShareDefinitions, bool bStreamOutput, OdGsDevicePool* pPool = NULL);
+  OdUInt32 countTag(const OdAnsiString& svg, const char* tag);
+  OdUInt32 countPrimitives(const OdAnsiString& svg);
+  bool checkDocument(const OdAnsiString& svg, OdString& error);
+}
+
+void SvgExportTest::createDrawing(OdDbDatabase* pDb)
+{
+  OdDbBlockTablePtr pTable = pDb->getBlockTableId().safeOpenObject(OdDb::kForWrite);
+  OdDbBlockTableRecordPtr pBlock = OdDbBlockTableRecord::createObject();
+  pBlock->setName(OD_T("SvgExportTest"));
+  const OdDbObjectId blockId = pTable->add(pBlock);
+  OdDbPolylinePtr pFrame = OdDbPolyline::createObject();
+  pFrame->setDatabaseDefaults(pDb);
+  pFrame->addVertexAt(0, OdGePoint2d(0., 0.));
+  pFrame->addVertexAt(1, OdGePoint2d(10., 0.));
+  pFrame->addVertexAt(2, OdGePoint2d(10., 5.));
+  pFrame->addVertexAt(3, OdGePoint2d(0., 5.));
+  pFrame->setClosed(true);
+  pBlock->appendOdDbEntity(pFrame);
+  OdDbCirclePtr pCircle = OdDbCircle::createObject();
+  pCircle->setDatabaseDefaults(pDb);
+  pCircle->setCenter(OdGePoint3d(5., 2.5, 0.));
+  pCircle->setRadius(2.);
+  pBlock->appendOdDbEntity(pCircle);
+
+  OdDbBlockTableRecordPtr pMs = pDb->getModelSpaceId().safeOpenObject(OdDb::kForWrite);
+  for (int nRef = 0; nRef < kRefs; ++nRef)
+  {
+    OdDbBlockReferencePtr pRef = OdDbBlockReference::createObject();
+    pRef->setDatabaseDefaults(pDb);
+    pRef->setBlockTableRecord(blockId);
+    pRef->setPosition(OdGePoint3d(20. * nRef, 10. * (nRef % 2), 0.));
+    pRef->setRotation(OdaPI / 6. * nRef);
+    if (nRef == kRefs - 1)
+      pRef->setScaleFactors(OdGeScale3d(2.));
+    pMs->appendOdDbEntity(pRef);
+  }
+}
+
+// Device is leased from pPool if specified, so pooled device is reused for next export
+OdAnsiString SvgExportTest::exportSvg(OdDbDatabase* pDb, bool bShareDefinitions, bool bStreamOutput, OdGsDevicePool* pPool)
+{
+  OdGsModulePtr pModule = ::odrxDynamicLinker()->loadModule(OdSvgExportModuleName, false);
+  OdGsDevicePoolLease lease(pPool, pModule);
+  OdGsDevice* pDevice = lease.device();
+  OdMemoryStreamPtr pOutput = OdMemoryStream::createNew();
+  pDevice->properties()->putAt(OD_T("Output"), pOutput.get());
+  pDevice->properties()->putAt(OD_T("LineWeightScale"), OdRxVariantValue(1.0));
+  pDevice->properties()->putAt(OD_T("ShareDefinitions"), OdRxVariantValue(bShareDefinitions));
+  pDevice->properties()->putAt(OD_T("StreamOutput"), OdRxVariantValue(bStreamOutput));
+  pDevice->setLogicalPalette(odcmAcadLightPalette(), 256);
+
+  OdGiContextForDbDatabasePtr pCtx = OdGiContextForDbDatabase::createObject();
+  pCtx->setDatabase(pDb);
+  pCtx->setPlotGeneration(true);
+  pDevice->setUserGiContext(pCtx);
+  OdGsViewPtr pView = pDevice->createView();
+  pDevice->addView(pView);
+  OdDbBlockTableRecordPtr pMs = pDb->getModelSpaceId().safeOpenObject();
+  pView->add(pMs, 0);
+  OdGeExtents3d ext;
+  if (pMs->getGeomExtents(ext) == eOk)
+  {
+    const OdGePoint3d target = ext.center();
+    pView->setView(target + OdGeVector3d::kZAxis, target, OdGeVector3d::kYAxis,
+      (ext.maxPoint().x - ext.minPoint().x) * 1.1, (ext.maxPoint().y - ext.minPoint().y) * 1.1);
+  }
+  pDevice->onSize(OdGsDCRect(0, 1024, 768, 0)); // svg coordinates are upside-down
+  pDevice->update();
+  lease.setSucceeded();
+
+  OdAnsiString svg;
+  const int nLength = (int)pOutput->length();
+  pOutput->rewind();
+  if (nLength)
+    pOutput->getBytes(svg.getBuffer(nLength), nLength);
+  svg.releaseBuffer(nLength);
+  return svg;
+}
+
+OdUInt32 SvgExportTest::countTag(const OdAnsiString& svg, const char* tag)
+{
+  const std::string openTag = std::string("<") + tag + " ";
+  OdUInt32 nCount = 0;
+  for (const char* pPos = ::strstr(svg.c_str(), openTag.c_str()); pPos; pPos = ::strstr(pPos + 1, openTag.c_str()))
+    ++nCount;
+  return nCount;
+}
+
+OdUInt32 SvgExportTest::countPrimitives(const OdAnsiString& svg)
+{
+  return countTag(svg, "polyline") + countTag(svg, "polygon") + countTag(svg, "path") +
+         countTag(svg, "circle") + countTag(svg, "ellipse") + countTag(svg, "line");
+}
+
+// Document must be complete, and every referenced definition must be written before its first use,
+// so streamed output could be rendered progressively.
+bool SvgExportTest::checkDocument(const OdAnsiString& svg, OdString& error)
+{
+  if ((svg.find("<?xml") != 0) || (svg.reverseFind('<') < 0) || ::strncmp(svg.c_str() + svg.reverseFind('<'), "</svg>", 6))
+  {
+    error = OD_T("incomplete document");
+    return false;
+  }
+  static const char* const refPrefixes[] = { "url(#", "href=\"#" };
+  std::set<std::string> ids;
+  for (const char* pPos = svg.c_str(); *pPos; ++pPos)
+  {
+    if (!::strncmp(pPos, " id=\"", 5))
+    {
+      const char* pEnd = ::strchr(pPos + 5, '"');
+      if (!pEnd || !ids.insert(std::string(pPos + 5, pEnd)).second)
+      {
+        error = OD_T("duplicate definition id");
+        return false;
+      }
+      continue;
+    }
+    for (int nPrefix = 0; nPrefix < 2; ++nPrefix)
+    {
+      const size_t nPrefixLen = ::strlen(refPrefixes[nPrefix]);
+      if (!::strncmp(pPos, refPrefixes[nPrefix], nPrefixLen))
+      {
+        const char* pEnd = ::strpbrk(pPos + nPrefixLen, ")\"");
+        const std::string id(pPos + nPrefixLen, pEnd ? pEnd : pPos + nPrefixLen);
+        if (ids.find(id) == ids.end())
+        {
+          error.format(OD_T("reference to \"%hs\" precedes its definition"), id.c_str());
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void _SvgExportTest_func(OdEdCommandContext* pCmdCtx)
+{
+  OdDbCommandContextPtr pDbCmdCtx(pCmdCtx);
+  OdEdUserIO* pIO = pDbCmdCtx->userIO();
+  // Test drawing is created in separate database, so current one isn't modified
+  OdDbDatabasePtr pDb = pDbCmdCtx->database()->appServices()->createDatabase();
+  SvgExportTest::createDrawing(pDb);
+
+  static const OdChar* const modeNames[4] = { OD_T("default"), OD_T("ShareDefinitions"), OD_T("StreamOutput"),
+                                              OD_T("ShareDefinitions + StreamOutput") };
+  OdAnsiString svg[4];
+  bool bPassed = true;
+  OdString str;
+  for (int nMode = 0; nMode < 4; ++nMode)
+  {
+    svg[nMode] = SvgExportTest::exportSvg(pDb, GETBIT(nMode, 1), GETBIT(nMode, 2));
+    str.format(OD_T("%ls: %d bytes, %u primitives, %u symbols, %u uses"), modeNames[nMode], svg[nMode].getLength(),
+      SvgExportTest::countPrimitives(svg[nMode]), SvgExportTest::countTag(svg[nMode], "symbol"), SvgExportTest::countTag(svg[nMode], "use"));
+    pIO->putString(str);
+    OdString error;
+    if (!SvgExportTest::checkDocument(svg[nMode], error))
+      pIO->putString(OD_T("  FAILED: ") + error), bPassed = false;
+  }
+  // Block references without shared definitions are drawn in place
+  if (SvgExportTest::countTag(svg[0], "use") || SvgExportTest::countTag(svg[2], "use"))
+    pIO->putString(OD_T("  FAILED: <use> written without ShareDefinitions")), bPassed = false;
+  // Every reference is <use>, references differing by rotation and position share one <symbol>
+  for (int nMode = 1; nMode < 4; nMode += 2)
+  {
+    if ((SvgExportTest::countTag(svg[nMode], "use") != SvgExportTest::kRefs) || (SvgExportTest::countTag(svg[nMode], "symbol") != 2))
+      pIO->putString(OdString(OD_T("  FAILED: unexpected symbols in ")) + modeNames[nMode] + OD_T(" mode")), bPassed = false;
+    if (SvgExportTest::countPrimitives(svg[nMode]) >= SvgExportTest::countPrimitives(svg[0]))
+      pIO->putString(OdString(OD_T("  FAILED: shared symbols don't reduce output in ")) + modeNames[nMode] + OD_T(" mode")), bPassed = false;
+  }
+  // Streaming changes only order of definitions, not the geometry
+  for (int nMode = 0; nMode < 2; ++nMode)
+  {
+    if (SvgExportTest::countPrimitives(svg[nMode]) != SvgExportTest::countPrimitives(svg[nMode + 2]))
+      pIO->putString(OdString(OD_T("  FAILED: streamed output differs from ")) + modeNames[nMode] + OD_T(" mode")), bPassed = false;
+  }
+  // Device reused through OdGsDevicePool must produce the same document as new one
+  OdGsModulePtr pModule = ::odrxDynamicLinker()->loadModule(OdSvgExportModuleName, false);
+  OdGsDevicePoolPtr pPool = OdGsDevicePool::createObject(pModule, 1);
+  for (int nExport = 0; nExport < 2; ++nExport)
+  {
+    if (SvgExportTest::exportSvg(pDb, true, false, pPool) != svg[1])
+      pIO->putString(OD_T("  FAILED: pooled device output differs from new device")), bPassed = false;
+  }
+  const OdGsDevicePool::Stats stats = pPool->stats();
+  str.format(OD_T("pooled: %u created, %u reused, %u discarded"), stats.m_nCreated, stats.m_nReused, stats.m_nDiscarded);
+  pIO->putString(str);
+  if ((stats.m_nCreated != 1) || (stats.m_nReused != 1) || stats.m_nDiscarded)
+    pIO->putString(OD_T("  FAILED: SVG export device isn't reused by pool")), bPassed = false;
+  pPool.release();
+  pIO->putString(bPassed ? OD_T("SvgExportTest passed") : OD_T("SvgExportTest FAILED"));
+}
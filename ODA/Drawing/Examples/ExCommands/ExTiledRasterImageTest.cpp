@@ -0,0 +1,270 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+#include "Ed/EdUserIO.h"
+#include "RxRasterServices.h"
+#include "RxSystemServices.h"
+#include "RxDynamicModule.h"
+#include "OdPlatformStreamer.h"
+#include "ExGiTiledRasterImage.h"
+
+namespace TiledRasterImageTest
+{
+  enum
+  {
+    kWidth    = 300, // Not multiple of tile size, so border tiles are partial
+    kHeight   = 200,
+    kTileSize = 64,
+    kLevels   = 4    // 300 -> 150 -> 75 -> 38
+  };
+
+  // Pixels of one level, bytes per pixel * width per scanline, scanlines go bottom-up
+  struct Level
+  {
+    OdUInt32     m_width;
+    OdUInt32     m_height;
+    OdUInt8Array m_pixels;
+  };
+
+  OdUInt8 sample(OdUInt32 x, OdUInt32 y, OdUInt32 c);
+  void fillLevel(Level& level, OdUInt32 nBytes);
+  void downsample(const Level& src, Level& dst, OdUInt32 nBytes);
+  OdString writeBmp(const Level& level, OdUInt32 nBitCount, bool bAlphaBitFields);
+  bool checkRows(const OdGiRasterImage* pImg, const Level& level, OdUInt32 x, OdUInt32 y, OdUInt32 nBytes, OdString& error);
+  void check(const OdGiRasterImage* pImg, const Level& level, OdUInt32 x, OdUInt32 y,
+             OdUInt32 width, OdUInt32 height, OdUInt32 nBytes, const OdChar* pWhat);
+  bool run(OdRxRasterServices* pRasSvcs, OdUInt32 nBitCount, bool bAlphaBitFields, OdEdUserIO* pIO);
+}
+
+// Varies along both axes and channels, so misplaced tiles and rows are detected
+OdUInt8 TiledRasterImageTest::sample(OdUInt32 x, OdUInt32 y, OdUInt32 c)
+{
+  return (OdUInt8)((x * 7 + y * 13 + c * 61 + ((x * y) >> 5)) & 0xFF);
+}
+
+void TiledRasterImageTest::fillLevel(Level& level, OdUInt32 nBytes)
+{
+  level.m_width = kWidth;
+  level.m_height = kHeight;
+  level.m_pixels.resize(kWidth * kHeight * nBytes);
+  OdUInt8* pPixel = level.m_pixels.asArrayPtr();
+  for (OdUInt32 y = 0; y < kHeight; ++y)
+  {
+    for (OdUInt32 x = 0; x < kWidth; ++x)
+    {
+      for (OdUInt32 c = 0; c < nBytes; ++c)
+        *pPixel++ = sample(x, y, c);
+    }
+  }
+}
+
+// Expected overview level: true color pixels are averaged by 2x2 box, indexed pixels are
+// taken from even positions. Odd border column and scanline are repeated.
+void TiledRasterImageTest::downsample(const Level& src, Level& dst, OdUInt32 nBytes)
+{
+  dst.m_width = (src.m_width + 1) / 2;
+  dst.m_height = (src.m_height + 1) / 2;
+  dst.m_pixels.resize(dst.m_width * dst.m_height * nBytes);
+  const OdUInt8* pSrc = src.m_pixels.getPtr();
+  OdUInt8* pDst = dst.m_pixels.asArrayPtr();
+  for (OdUInt32 y = 0; y < dst.m_height; ++y)
+  {
+    const OdUInt32 y0 = y * 2, y1 = odmin(y0 + 1, src.m_height - 1);
+    for (OdUInt32 x = 0; x < dst.m_width; ++x)
+    {
+      const OdUInt32 x0 = x * 2, x1 = odmin(x0 + 1, src.m_width - 1);
+      for (OdUInt32 c = 0; c < nBytes; ++c)
+      {
+        if (nBytes == 1)
+          *pDst++ = pSrc[y0 * src.m_width + x0];
+        else
+          *pDst++ = (OdUInt8)((OdUInt32(pSrc[(y0 * src.m_width + x0) * nBytes + c]) + pSrc[(y0 * src.m_width + x1) * nBytes + c] +
+                               pSrc[(y1 * src.m_width + x0) * nBytes + c] + pSrc[(y1 * src.m_width + x1) * nBytes + c] + 2) >> 2);
+      }
+    }
+  }
+}
+
+// Writes bottom-up BMP file: 8 bits per pixel with gray palette, 24 bits BGR, 32 bits BGRX,
+// or 32 bits BGRA described by bit fields of BITMAPV4HEADER
+OdString TiledRasterImageTest::writeBmp(const Level& level, OdUInt32 nBitCount, bool bAlphaBitFields)
+{
+  const OdUInt32 nBytes = nBitCount / 8, nPitch = (level.m_width * nBytes + 3) & ~3;
+  const OdUInt32 nHdrSize = bAlphaBitFields ? 108 : 40, nPalSize = (nBitCount == 8) ? 256 * 4 : 0;
+  const OdUInt32 nOffBits = 14 + nHdrSize + nPalSize;
+  const OdString fileName = ::odrxSystemServices()->getTempFileName();
+  OdStreamBufPtr pFile = ::odrxSystemServices()->createFile(fileName, Oda::kFileWrite, Oda::kShareDenyNo, Oda::kCreateAlways);
+  OdPlatformStreamer::wrInt16(*pFile, 19778); // 'BM'
+  OdPlatformStreamer::wrInt32(*pFile, OdInt32(nOffBits + nPitch * level.m_height));
+  OdPlatformStreamer::wrInt32(*pFile, 0);
+  OdPlatformStreamer::wrInt32(*pFile, OdInt32(nOffBits));
+  OdPlatformStreamer::wrInt32(*pFile, OdInt32(nHdrSize));
+  OdPlatformStreamer::wrInt32(*pFile, OdInt32(level.m_width));
+  OdPlatformStreamer::wrInt32(*pFile, OdInt32(level.m_height));
+  OdPlatformStreamer::wrInt16(*pFile, 1);
+  OdPlatformStreamer::wrInt16(*pFile, OdInt16(nBitCount));
+  OdPlatformStreamer::wrInt32(*pFile, bAlphaBitFields ? 3 : 0); // BI_BITFIELDS : BI_RGB
+  OdPlatformStreamer::wrInt32(*pFile, OdInt32(nPitch * level.m_height));
+  OdPlatformStreamer::wrInt32(*pFile, 3780);
+  OdPlatformStreamer::wrInt32(*pFile, 3780);
+  OdPlatformStreamer::wrInt32(*pFile, 0);
+  OdPlatformStreamer::wrInt32(*pFile, 0);
+  if (bAlphaBitFields)
+  {
+    OdPlatformStreamer::wrInt32(*pFile, 0x00FF0000);
+    OdPlatformStreamer::wrInt32(*pFile, 0x0000FF00);
+    OdPlatformStreamer::wrInt32(*pFile, 0x000000FF);
+    OdPlatformStreamer::wrInt32(*pFile, OdInt32(0xFF000000));
+    OdPlatformStreamer::wrInt32(*pFile, 0x73524742); // LCS_sRGB
+    for (OdUInt32 n = 0; n < 12; ++n)              // Endpoints and gamma
+      OdPlatformStreamer::wrInt32(*pFile, 0);
+  }
+  for (OdUInt32 nColor = 0; nColor < nPalSize / 4; ++nColor)
+    OdPlatformStreamer::wrInt32(*pFile, OdInt32(nColor * 0x010101));
+  OdUInt8Array row;
+  row.resize(nPitch, 0);
+  for (OdUInt32 y = 0; y < level.m_height; ++y)
+  {
+    ::memcpy(row.asArrayPtr(), level.m_pixels.getPtr() + y * level.m_width * nBytes, level.m_width * nBytes);
+    pFile->putBytes(row.getPtr(), nPitch);
+  }
+  return fileName;
+}
+
+// Compares scanlines of the image with expected level pixels starting at x, y
+bool TiledRasterImageTest::checkRows(const OdGiRasterImage* pImg, const Level& level, OdUInt32 x, OdUInt32 y,
+                                     OdUInt32 nBytes, OdString& error)
+{
+  const OdUInt32 width = pImg->pixelWidth(), height = pImg->pixelHeight();
+  OdUInt8Array row;
+  row.resize(pImg->scanLineSize());
+  for (OdUInt32 nRow = 0; nRow < height; ++nRow)
+  {
+    const OdUInt8* pExpected = level.m_pixels.getPtr() + ((y + nRow) * level.m_width + x) * nBytes;
+    pImg->scanLines(row.asArrayPtr(), nRow, 1);
+    if (::memcmp(row.getPtr(), pExpected, width * nBytes))
+    {
+      error.format(OD_T("scanline %u mismatch"), nRow);
+      return false;
+    }
+  }
+  return true;
+}
+
+void TiledRasterImageTest::check(const OdGiRasterImage* pImg, const Level& level, OdUInt32 x, OdUInt32 y,
+                                 OdUInt32 width, OdUInt32 height, OdUInt32 nBytes, const OdChar* pWhat)
+{
+  OdString error;
+  if (!pImg)
+    error = OD_T("isn't created");
+  else if ((pImg->pixelWidth() != width) || (pImg->pixelHeight() != height))
+    error.format(OD_T("size %ux%u, expected %ux%u"), pImg->pixelWidth(), pImg->pixelHeight(), width, height);
+  else
+    checkRows(pImg, level, x, y, nBytes, error);
+  if (!error.isEmpty())
+    throw OdError(OdString(pWhat) + OD_T(": ") + error);
+}
+
+// Loads BMP file as tiled image and checks its tiles, crop and overview levels
+bool TiledRasterImageTest::run(OdRxRasterServices* pRasSvcs, OdUInt32 nBitCount, bool bAlphaBitFields, OdEdUserIO* pIO)
+{
+  const OdUInt32 nBytes = nBitCount / 8;
+  Level levels[kLevels];
+  fillLevel(levels[0], nBytes);
+  for (OdUInt32 nLevel = 1; nLevel < kLevels; ++nLevel)
+    downsample(levels[nLevel - 1], levels[nLevel], nBytes);
+  OdString fileName;
+  bool bPassed = true;
+  try
+  {
+    fileName = writeBmp(levels[0], nBitCount, bAlphaBitFields);
+    const OdUInt32 flags[] = { OdRxRasterServices::kLoadTiled, kTileSize, 0 };
+    OdGiRasterImagePtr pImg = pRasSvcs->loadRasterImage(fileName, flags);
+    const OdExGiRasterImageLevels* pLevels = dynamic_cast<const OdExGiRasterImageLevels*>(pImg.get());
+    if (!pLevels)
+      throw OdError(OD_T("image isn't loaded as tiled image"));
+    if (pImg->colorDepth() != nBitCount)
+      throw OdError(OD_T("source bit depth isn't kept"));
+    // Only bit fields with non-zero alpha mask make 32 bits per pixel image transparent
+    const bool bHasAlpha = (pImg->transparencyMode() != OdGiRasterImage::kTransparencyOff);
+    if (bHasAlpha != bAlphaBitFields)
+      throw OdError(bHasAlpha ? OD_T("BI_RGB image is transparent") : OD_T("alpha channel is lost"));
+    check(pImg, levels[0], 0, 0, kWidth, kHeight, nBytes, OD_T("full resolution"));
+    // Crossing tile borders in both directions
+    OdGiRasterImagePtr pCrop = pImg->crop(kTileSize - 10, kTileSize - 7, kTileSize * 2, kTileSize + 20);
+    check(pCrop, levels[0], kTileSize - 10, kTileSize - 7, kTileSize * 2, kTileSize + 20, nBytes, OD_T("crop"));
+    if (pLevels->numLevels() != kLevels)
+      throw OdError(OD_T("unexpected number of levels"));
+    for (OdUInt32 nLevel = 1; nLevel < kLevels; ++nLevel)
+    {
+      OdGiRasterImagePtr pLevelImg = pLevels->levelImage(nLevel);
+      OdString what;
+      what.format(OD_T("level %u"), nLevel);
+      check(pLevelImg, levels[nLevel], 0, 0, levels[nLevel].m_width, levels[nLevel].m_height, nBytes, what);
+    }
+    if ((pLevels->levelForScale(1.0) != 0) || (pLevels->levelForScale(2.0) != 1) || (pLevels->levelForScale(3.9) != 1) ||
+        (pLevels->levelForScale(8.0) != 3) || (pLevels->levelForScale(1000.0) != kLevels - 1))
+      throw OdError(OD_T("unexpected level for scale"));
+  }
+  catch (const OdError& err)
+  {
+    pIO->putString(OD_T("  FAILED: ") + err.description());
+    bPassed = false;
+  }
+  if (!fileName.isEmpty())
+  { // Tiled image is released already, so temporary file is deleted on close
+    try
+    {
+      ::odrxSystemServices()->createFile(fileName, (Oda::FileAccessMode)(Oda::kFileRead | Oda::kFileDelete),
+                                         Oda::kShareDenyNo, Oda::kOpenExisting);
+    }
+    catch (const OdError&)
+    {
+    }
+  }
+  if (bPassed)
+    pIO->putString(OD_T("  passed"));
+  return bPassed;
+}
+
+void _TiledRasterImageTest_func(OdEdCommandContext* pCmdCtx)
+{
+  OdEdUserIO* pIO = pCmdCtx->userIO();
+  OdRxRasterServicesPtr pRasSvcs = ::odrxDynamicLinker()->loadApp(RX_RASTER_SERVICES_APPNAME, false);
+  if (pRasSvcs.isNull())
+  {
+    pIO->putString(OD_T("Raster services module isn't available, TiledRasterImageTest FAILED"));
+    return;
+  }
+  bool bPassed = true;
+  pIO->putString(OD_T("8 bits per pixel, palette:"));
+  bPassed &= TiledRasterImageTest::run(pRasSvcs, 8, false, pIO);
+  pIO->putString(OD_T("24 bits per pixel:"));
+  bPassed &= TiledRasterImageTest::run(pRasSvcs, 24, false, pIO);
+  pIO->putString(OD_T("32 bits per pixel, BI_RGB:"));
+  bPassed &= TiledRasterImageTest::run(pRasSvcs, 32, false, pIO);
+  pIO->putString(OD_T("32 bits per pixel, BI_BITFIELDS with alpha:"));
+  bPassed &= TiledRasterImageTest::run(pRasSvcs, 32, true, pIO);
+  pIO->putString(bPassed ? OD_T("TiledRasterImageTest passed") : OD_T("TiledRasterImageTest FAILED"));
+}
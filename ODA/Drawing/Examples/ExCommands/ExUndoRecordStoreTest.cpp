@@ -0,0 +1,164 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+#include "Ed/EdUserIO.h"
+#include "ExUndoRecordStore.h"
+#include "MemoryStream.h"
+#include "FlatMemStream.h"
+
+namespace UndoRecordStoreTest
+{
+  enum
+  {
+    kRecords     = 64,          // Records pushed on the first pass
+    kMaxSteps    = 48,          // So the oldest records are evicted
+    kMaxMemory   = 64 * 1024,   // So compressed records are spilled
+    kSegmentSize = 64 * 1024    // So spilled records occupy several segments
+  };
+
+  void fillRecord(OdUInt32 nRecord, OdBinaryData& data);
+  void pushRecord(ExUndoRecordStore* pStore, OdUInt32 nRecord);
+  bool popRecord(ExUndoRecordStore* pStore, OdUInt32 nRecord, OdString& error);
+  bool run(OdUInt32 nFlags, OdEdUserIO* pIO);
+}
+
+// Text-like data with noise, so records compress, but not into few bytes
+void UndoRecordStoreTest::fillRecord(OdUInt32 nRecord, OdBinaryData& data)
+{
+  static const char sampleText[] = "AcDbEntity AcDbLine 10 20 30 11 21 31 ";
+  data.resize(1024 + (nRecord * 7919) % 32768);
+  OdUInt32 nSeed = nRecord * 2654435761U + 1;
+  for (OdUInt32 i = 0; i < data.size(); ++i)
+  {
+    nSeed = nSeed * 1103515245U + 12345U;
+    data[i] = ((nSeed >> 16) % 8) ? (OdUInt8)sampleText[i % (sizeof(sampleText) - 1)] : (OdUInt8)(nSeed >> 24);
+  }
+}
+
+void UndoRecordStoreTest::pushRecord(ExUndoRecordStore* pStore, OdUInt32 nRecord)
+{
+  OdBinaryData data;
+  fillRecord(nRecord, data);
+  OdStaticRxObject<OdFlatMemStream> stream;
+  stream.init(data.asArrayPtr(), data.size());
+  pStore->push(&stream, data.size(), nRecord);
+}
+
+bool UndoRecordStoreTest::popRecord(ExUndoRecordStore* pStore, OdUInt32 nRecord, OdString& error)
+{
+  OdBinaryData expected;
+  fillRecord(nRecord, expected);
+  OdMemoryStreamPtr pStream = OdMemoryStream::createNew();
+  const OdUInt32 opt = pStore->pop(pStream);
+  if (opt != nRecord)
+  {
+    error.format(OD_T("record %u: popped record %u"), nRecord, opt);
+    return false;
+  }
+  if ((OdUInt32)pStream->length() != expected.size())
+  {
+    error.format(OD_T("record %u: size %u, expected %u"), nRecord, (OdUInt32)pStream->length(), expected.size());
+    return false;
+  }
+  OdBinaryData data;
+  data.resize(expected.size());
+  pStream->rewind();
+  pStream->getBytes(data.asArrayPtr(), data.size());
+  if (::memcmp(data.getPtr(), expected.getPtr(), data.size()))
+  {
+    error.format(OD_T("record %u: data mismatch"), nRecord);
+    return false;
+  }
+  return true;
+}
+
+// Round trips records through compression, spill into temporary files and eviction
+bool UndoRecordStoreTest::run(OdUInt32 nFlags, OdEdUserIO* pIO)
+{
+  ExUndoRecordStorePtr pStore = ExUndoRecordStore::createObject(nFlags);
+  pStore->setLimits(kMaxSteps, kMaxMemory, 0x10000000);
+  pStore->setSpillOptions(kSegmentSize);
+  OdString str;
+  try
+  {
+    OdUInt32 nRecord;
+    for (nRecord = 0; nRecord < kRecords; ++nRecord)
+      pushRecord(pStore, nRecord);
+    pStore->flush();
+    ExUndoRecordStore::Stats stats = pStore->stats();
+    str.format(OD_T("  records %u, evicted %u, spilled %u in %u segments, memory %u KB, ratio %.2f"),
+      stats.m_nRecords, (OdUInt32)stats.m_nEvicted, stats.m_nSpilled, stats.m_nSegments,
+      (OdUInt32)(stats.m_nMemoryBytes / 1024), stats.compressionRatio());
+    pIO->putString(str);
+    if ((stats.m_nRecords != kMaxSteps) || (stats.m_nEvicted != kRecords - kMaxSteps))
+      str = OD_T("unexpected number of records after eviction");
+    else if (stats.m_nMemoryBytes > kMaxMemory)
+      str = OD_T("memory limit is exceeded");
+    else if (!stats.m_nSpilled || (stats.m_nSegments < 2))
+      str = OD_T("records aren't spilled");
+    else if (GETBIT(nFlags, ExUndoRecordStore::kCompress) && (stats.compressionRatio() <= 1.0))
+      str = OD_T("records aren't compressed");
+    else
+      str.empty();
+    if (!str.isEmpty())
+      throw OdError(str);
+    // Pop some records, reuse freed segment space and pop everything
+    for (nRecord = kRecords; nRecord > kRecords - 8; --nRecord)
+    {
+      if (!popRecord(pStore, nRecord - 1, str))
+        throw OdError(str);
+    }
+    for (nRecord = kRecords - 8; nRecord < kRecords; ++nRecord)
+      pushRecord(pStore, nRecord);
+    pStore->flush();
+    for (nRecord = kRecords; nRecord > kRecords - kMaxSteps; --nRecord)
+    {
+      if (!popRecord(pStore, nRecord - 1, str))
+        throw OdError(str);
+    }
+    stats = pStore->stats();
+    if (pStore->hasData() || stats.m_nStoredBytes || stats.m_nSpilledBytes || stats.m_nPending)
+      throw OdError(OD_T("store isn't empty after all records are popped"));
+  }
+  catch (const OdError& err)
+  {
+    pIO->putString(OD_T("  FAILED: ") + err.description());
+    return false;
+  }
+  pIO->putString(OD_T("  passed"));
+  return true;
+}
+
+void _UndoRecordStoreTest_func(OdEdCommandContext* pCmdCtx)
+{
+  OdEdUserIO* pIO = pCmdCtx->userIO();
+  bool bPassed = true;
+  pIO->putString(OD_T("Synchronous compression:"));
+  bPassed &= UndoRecordStoreTest::run(ExUndoRecordStore::kCompress | ExUndoRecordStore::kSpillToDisk, pIO);
+  pIO->putString(OD_T("Background compression:"));
+  bPassed &= UndoRecordStoreTest::run(ExUndoRecordStore::kDefaultFlags, pIO);
+  pIO->putString(OD_T("No compression:"));
+  bPassed &= UndoRecordStoreTest::run(ExUndoRecordStore::kSpillToDisk, pIO);
+  pIO->putString(bPassed ? OD_T("UndoRecordStoreTest passed") : OD_T("UndoRecordStoreTest FAILED"));
+}
@@ -0,0 +1,321 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OdaCommon.h"
+#include "ExDbCurveBatchIntersection.h"
+#include "Ge/GeCurveCurveInt3d.h"
+#include "Ge/GeBoundBlock3d.h"
+#include "RxThreadPoolService.h"
+#include "RxDynamicModule.h"
+#include "StaticRxObject.h"
+#include "OdHashMap.h"
+#include "OdMutex.h"
+#define STL_USING_ALGORITHM
+#include "OdaSTL.h"
+#include <math.h>
+
+ExDbCurveBatchIntersection::ExDbCurveBatchIntersection(double tol)
+  : m_tol(tol)
+{
+}
+
+ExDbCurveBatchIntersection::~ExDbCurveBatchIntersection()
+{
+  clear();
+}
+
+void ExDbCurveBatchIntersection::clear()
+{
+  for (size_t i = 0; i < m_curves.size(); ++i) {
+    delete m_curves[i].m_pCurve;
+  }
+  m_curves.clear();
+}
+
+int ExDbCurveBatchIntersection::addCurve(const OdDbCurve* pCurve)
+{
+  CurveData data;
+  data.m_pCurve = NULL;
+  if (pCurve->getOdGeCurve(data.m_pCurve) != eOk || !data.m_pCurve) {
+    delete data.m_pCurve;
+    return -1;
+  }
+  if (pCurve->getGeomExtents(data.m_ext) != eOk || !data.m_ext.isValidExtents()) {
+    OdGeBoundBlock3d block = data.m_pCurve->boundBlock();
+    OdGePoint3d ptMin, ptMax;
+    block.getMinMaxPoints(ptMin, ptMax);
+    data.m_ext.set(ptMin, ptMax);
+  }
+  data.m_ext.expandBy(OdGeVector3d(m_tol, m_tol, m_tol));
+  data.m_id = pCurve->objectId();
+  m_curves.push_back(data);
+  return int(m_curves.size() - 1);
+}
+
+OdUInt32 ExDbCurveBatchIntersection::addCurves(const OdDbObjectIdArray& ids)
+{
+  OdUInt32 nAdded = 0;
+  m_curves.reserve(m_curves.size() + ids.size());
+  for (OdUInt32 i = 0; i < ids.size(); ++i) {
+    OdDbCurvePtr pCurve = OdDbCurve::cast(ids[i].openObject());
+    if (pCurve.get() && addCurve(pCurve) >= 0) {
+      ++nAdded;
+    }
+  }
+  return nAdded;
+}
+
+namespace
+{
+  struct CurveMinXLess
+  {
+    const std::vector<ExDbCurveBatchIntersection::CurveData>& m_curves;
+    CurveMinXLess(const std::vector<ExDbCurveBatchIntersection::CurveData>& curves) : m_curves(curves) {}
+    bool operator ()(OdUInt32 n1, OdUInt32 n2) const
+    {
+      return m_curves[n1].m_ext.minPoint().x < m_curves[n2].m_ext.minPoint().x;
+    }
+  };
+
+  struct CrossingPairLess
+  {
+    bool operator ()(const ExDbCurveBatchIntersection::Crossing& c1, const ExDbCurveBatchIntersection::Crossing& c2) const
+    {
+      if (c1.m_nCurve1 != c2.m_nCurve1) {
+        return c1.m_nCurve1 < c2.m_nCurve1;
+      }
+      return c1.m_nCurve2 < c2.m_nCurve2;
+    }
+  };
+
+  void intersectPair(const ExDbCurveBatchIntersection::CurveData* pCurves, ExDbCurveBatchIntersection::CurvePair pair,
+                     double tol, ExDbCurveBatchIntersection::CrossingArray& crossings)
+  {
+    const double tol2 = tol * tol;
+    try {
+      OdGeCurveCurveInt3d intersection(*pCurves[pair.first].m_pCurve, *pCurves[pair.second].m_pCurve, OdGeVector3d::kIdentity, tol);
+      int nIntersections = intersection.numIntPoints();
+      intersection.orderWrt2();
+      const OdUInt32 nFirst = crossings.size();
+      for (int i = 0; i < nIntersections; ++i) {
+        OdGePoint3d pt = intersection.intPoint(i);
+        bool good = true;
+        for (OdUInt32 j = nFirst; j < crossings.size(); ++j) {
+          if (crossings[j].m_point.distanceSqrdTo(pt) <= tol2) {
+            good = false;
+            break;
+          }
+        }
+        if (good) {
+          ExDbCurveBatchIntersection::Crossing crossing;
+          crossing.m_nCurve1 = pair.first;
+          crossing.m_nCurve2 = pair.second;
+          crossing.m_point = pt;
+          crossings.push_back(crossing);
+        }
+      }
+    }
+    catch (const OdError&) {
+      // pair with degenerate geometry has no crossings
+    }
+  }
+
+  /** Description:
+      Intersects candidate pairs by thread pool threads. Every thread takes chunks of
+      pairs from shared counter and collects crossings into own array.
+  */
+  class PairIntersector : public OdApcAtom
+  {
+    const ExDbCurveBatchIntersection::CurveData* m_pCurves;
+    const std::vector<ExDbCurveBatchIntersection::CurvePair>* m_pPairs;
+    double m_tol;
+    OdMutex m_mutex;
+    size_t m_nNext;
+  public:
+    enum { kChunkSize = 256 };
+    std::vector<ExDbCurveBatchIntersection::CrossingArray> m_results;
+
+    PairIntersector() : m_pCurves(NULL), m_pPairs(NULL), m_tol(0.), m_nNext(0) {}
+
+    void init(const ExDbCurveBatchIntersection::CurveData* pCurves,
+              const std::vector<ExDbCurveBatchIntersection::CurvePair>& pairs, double tol, unsigned nThreads)
+    {
+      m_pCurves = pCurves;
+      m_pPairs = &pairs;
+      m_tol = tol;
+      m_nNext = 0;
+      m_results.resize(nThreads);
+    }
+
+    void apcEntryPoint(OdApcParamType parameter)
+    {
+      ExDbCurveBatchIntersection::CrossingArray& crossings = m_results[(unsigned)parameter];
+      for (;;) {
+        size_t nFirst, nLast;
+        {
+          TD_AUTOLOCK(m_mutex);
+          nFirst = m_nNext;
+          nLast = m_nNext = odmin(m_nNext + kChunkSize, m_pPairs->size());
+        }
+        if (nFirst == nLast) {
+          break;
+        }
+        for (size_t i = nFirst; i < nLast; ++i) {
+          intersectPair(m_pCurves, (*m_pPairs)[i], m_tol, crossings);
+        }
+      }
+    }
+  };
+
+  struct PointCell
+  {
+    double m_x, m_y, m_z; // integral cell coordinates
+
+    bool operator ==(const PointCell& c2) const
+    {
+      return (m_x == c2.m_x) && (m_y == c2.m_y) && (m_z == c2.m_z);
+    }
+    bool operator <(const PointCell& c2) const
+    {
+      if (m_x != c2.m_x) return m_x < c2.m_x;
+      if (m_y != c2.m_y) return m_y < c2.m_y;
+      return m_z < c2.m_z;
+    }
+  };
+  struct PointCellHash
+  {
+    size_t operator()(const PointCell& cell) const
+    {
+      OdUInt64 h = OdUInt64(OdInt64(cell.m_x)) * 0x9E3779B97F4A7C15ULL ^
+                   OdUInt64(OdInt64(cell.m_y)) * 0xC2B2AE3D27D4EB4FULL ^
+                   OdUInt64(OdInt64(cell.m_z)) * 0x165667B19E3779F9ULL;
+      return (size_t)(h ^ (h >> 29));
+    }
+  };
+}
+
+void ExDbCurveBatchIntersection::findCandidatePairs(std::vector<CurvePair>& pairs) const
+{
+  std::vector<OdUInt32> order(m_curves.size());
+  for (OdUInt32 i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), CurveMinXLess(m_curves));
+
+  // sweep along X axis: active curves are curves which X range contains current position
+  std::vector<OdUInt32> active;
+  for (OdUInt32 i = 0; i < order.size(); ++i) {
+    const OdGeExtents3d& ext = m_curves[order[i]].m_ext;
+    for (size_t j = 0; j < active.size(); ) {
+      const OdGeExtents3d& extActive = m_curves[active[j]].m_ext;
+      if (extActive.maxPoint().x < ext.minPoint().x) {
+        active[j] = active.back();
+        active.pop_back();
+        continue;
+      }
+      if (extActive.minPoint().y <= ext.maxPoint().y && ext.minPoint().y <= extActive.maxPoint().y &&
+          extActive.minPoint().z <= ext.maxPoint().z && ext.minPoint().z <= extActive.maxPoint().z) {
+        pairs.push_back(CurvePair(odmin(active[j], order[i]), odmax(active[j], order[i])));
+      }
+      ++j;
+    }
+    active.push_back(order[i]);
+  }
+}
+
+OdResult ExDbCurveBatchIntersection::intersectAll(CrossingArray& crossings, bool bParallel) const
+{
+  crossings.clear();
+  std::vector<CurvePair> pairs;
+  findCandidatePairs(pairs);
+  if (pairs.empty()) {
+    return eOk;
+  }
+
+  OdRxThreadPoolServicePtr pThreadPool;
+  if (bParallel && pairs.size() > PairIntersector::kChunkSize) {
+    pThreadPool = ::odrxDynamicLinker()->getModule(OdThreadPoolModuleName);
+  }
+  if (pThreadPool.isNull() || pThreadPool->numCPUs() < 2) {
+    for (size_t i = 0; i < pairs.size(); ++i) {
+      intersectPair(&m_curves[0], pairs[i], m_tol, crossings);
+    }
+  }
+  else {
+    const unsigned nThreads = (unsigned)odmin(pThreadPool->numCPUs(), int((pairs.size() + PairIntersector::kChunkSize - 1) / PairIntersector::kChunkSize));
+    OdStaticRxObject<PairIntersector> intersector;
+    intersector.init(&m_curves[0], pairs, m_tol, nThreads);
+    OdApcQueuePtr pQueue = pThreadPool->newMTQueue(ThreadsCounter::kNoAttributes, nThreads, kMtQueueAllowExecByMain);
+    for (unsigned i = 0; i < nThreads; ++i) {
+      pQueue->addEntryPoint(&intersector, (OdApcParamType)i);
+    }
+    pQueue->wait();
+    OdUInt32 nCrossings = 0;
+    for (unsigned i = 0; i < nThreads; ++i) {
+      nCrossings += intersector.m_results[i].size();
+    }
+    crossings.reserve(nCrossings);
+    for (unsigned i = 0; i < nThreads; ++i) {
+      crossings.append(intersector.m_results[i]);
+    }
+  }
+  // stable sort keeps order of crossings inside of each pair
+  std::stable_sort(crossings.begin(), crossings.end(), CrossingPairLess());
+  return eOk;
+}
+
+void ExDbCurveBatchIntersection::uniquePoints(const CrossingArray& crossings, OdGePoint3dArray& points) const
+{
+  // Points closer than tolerance are in the same or adjacent cells
+  const double cellSize = odmax(m_tol, 1e-12);
+  const double tol2 = m_tol * m_tol;
+  OdHashMap<PointCell, OdUInt32, PointCellHash> cells; // cell -> first point in the cell
+  std::vector<OdUInt32> nextInCell;
+  points.clear();
+  for (OdUInt32 i = 0; i < crossings.size(); ++i) {
+    const OdGePoint3d& pt = crossings[i].m_point;
+    PointCell cell = { floor(pt.x / cellSize), floor(pt.y / cellSize), floor(pt.z / cellSize) };
+    bool good = true;
+    for (int dx = -1; dx <= 1 && good; ++dx) {
+      for (int dy = -1; dy <= 1 && good; ++dy) {
+        for (int dz = -1; dz <= 1 && good; ++dz) {
+          PointCell adjacent = { cell.m_x + dx, cell.m_y + dy, cell.m_z + dz };
+          OdHashMap<PointCell, OdUInt32, PointCellHash>::const_iterator pIt = cells.find(adjacent);
+          for (OdUInt32 j = (pIt == cells.end()) ? OdUInt32(-1) : pIt->second; j != OdUInt32(-1); j = nextInCell[j]) {
+            if (points[j].distanceSqrdTo(pt) <= tol2) {
+              good = false;
+              break;
+            }
+          }
+        }
+      }
+    }
+    if (good) {
+      std::pair<OdHashMap<PointCell, OdUInt32, PointCellHash>::iterator, bool> res =
+        cells.insert(std::make_pair(cell, points.size()));
+      nextInCell.push_back(res.second ? OdUInt32(-1) : res.first->second);
+      res.first->second = points.size();
+      points.push_back(pt);
+    }
+  }
+}
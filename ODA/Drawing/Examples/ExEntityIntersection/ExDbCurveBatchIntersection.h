@@ -0,0 +1,119 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _EX_DBCURVE_BATCHINTERSECTION_
+#define _EX_DBCURVE_BATCHINTERSECTION_
+
+#include "DbCurve.h"
+#include "Ge/GeCurve3d.h"
+#include "Ge/GeExtents3d.h"
+#define STL_USING_VECTOR
+#include "OdaSTL.h"
+
+/** Description:
+    This class computes all crossings among a set of curves.
+
+    Ge curves are created once per entity when curves are added. Candidate pairs are
+    found by sweeping curve extents along the X axis, candidate pairs are intersected
+    in parallel by thread pool threads (if thread pool module is loaded) and crossing
+    points are merged by a spatial hash.
+
+    Cached Ge curves are only read during intersection, so curves of any type which
+    OdDbCurve::getOdGeCurve() returns may be intersected concurrently.
+
+    Library:
+    ExEntityIntersection
+*/
+class ExDbCurveBatchIntersection
+{
+public:
+  /** Description:
+      Single crossing of two curves.
+  */
+  struct Crossing
+  {
+    OdUInt32 m_nCurve1;  // index of first curve (m_nCurve1 < m_nCurve2)
+    OdUInt32 m_nCurve2;  // index of second curve
+    OdGePoint3d m_point;
+  };
+  typedef OdArray<Crossing> CrossingArray;
+
+  ExDbCurveBatchIntersection(double tol = 1e-8);
+  ~ExDbCurveBatchIntersection();
+
+  /**
+    Description:
+    Adds curve into the set. Returns index of the curve or -1 if Ge curve can't be created.
+  */
+  int addCurve(const OdDbCurve* pCurve);
+
+  /**
+    Description:
+    Adds curves of all entities from the array which are OdDbCurve objects.
+    Returns number of added curves.
+  */
+  OdUInt32 addCurves(const OdDbObjectIdArray& ids);
+
+  OdUInt32 numCurves() const { return (OdUInt32)m_curves.size(); }
+  OdDbObjectId curveId(OdUInt32 nCurve) const { return m_curves[nCurve].m_id; }
+  const OdGeCurve3d* geCurve(OdUInt32 nCurve) const { return m_curves[nCurve].m_pCurve; }
+
+  void clear();
+
+  /**
+    Description:
+    Intersects all pairs of curves (both operands are not extended). Crossings are
+    ordered by curve indices, crossings of each pair are ordered along second curve.
+
+    Arguments:
+    crossings (O) Receives crossings.
+    bParallel (I) Intersect pairs by thread pool threads if thread pool is available.
+  */
+  OdResult intersectAll(CrossingArray& crossings, bool bParallel = true) const;
+
+  /**
+    Description:
+    Merges crossing points which are closer than tolerance.
+  */
+  void uniquePoints(const CrossingArray& crossings, OdGePoint3dArray& points) const;
+
+  double tolerance() const { return m_tol; }
+
+  struct CurveData
+  {
+    OdGeCurve3d*  m_pCurve;
+    OdGeExtents3d m_ext;
+    OdDbObjectId  m_id;
+  };
+  typedef std::pair<OdUInt32, OdUInt32> CurvePair;
+protected:
+  void findCandidatePairs(std::vector<CurvePair>& pairs) const;
+
+  std::vector<CurveData> m_curves;
+  double m_tol;
+private:
+  ExDbCurveBatchIntersection(const ExDbCurveBatchIntersection&);
+  ExDbCurveBatchIntersection& operator =(const ExDbCurveBatchIntersection&);
+};
+
+#endif //_EX_DBCURVE_BATCHINTERSECTION_
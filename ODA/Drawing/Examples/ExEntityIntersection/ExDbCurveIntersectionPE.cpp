@@ -138,3 +138,30 @@ OdResult ExDbCurveIntersectionPE::boundingBoxIntersectWith(
 {
   return eNotImplementedYet;
 }
+
+OdResult ExDbCurveIntersectionPE::intersectAll(
+    const OdDbObjectIdArray& ids, ExDbCurveBatchIntersection::CrossingArray& crossings,
+    OdGePoint3dArray* pPoints, bool bParallel) const
+{
+  ExDbCurveBatchIntersection batch;
+  OdIntArray idIndices;
+  idIndices.reserve(ids.size());
+  for (OdUInt32 i = 0; i < ids.size(); ++i) {
+    OdDbCurvePtr pCurve = OdDbCurve::cast(ids[i].openObject());
+    if (pCurve.get() && batch.addCurve(pCurve) >= 0) {
+      idIndices.push_back(i);
+    }
+  }
+
+  OdResult res = batch.intersectAll(crossings, bParallel);
+  if (res != eOk)
+    return res;
+  if (pPoints) {
+    batch.uniquePoints(crossings, *pPoints);
+  }
+  for (OdUInt32 i = 0; i < crossings.size(); ++i) {
+    crossings[i].m_nCurve1 = idIndices[crossings[i].m_nCurve1];
+    crossings[i].m_nCurve2 = idIndices[crossings[i].m_nCurve2];
+  }
+  return eOk;
+}
@@ -27,6 +27,7 @@
 
 
 #include "DbEntityIntersectionPE.h"
+#include "ExDbCurveBatchIntersection.h"
 
 /** Description:
     This class defines the interface for the Entity Intersection Protocol Extension classes.
@@ -70,6 +71,21 @@ public:
     const OdDbEntity* pThisEnt, const OdDbEntity* pEnt,
     OdDb::Intersect intType, const OdGePlane& projPlane, OdGePoint3dArray& points,
     OdGsMarker thisGsMarker, OdGsMarker otherGsMarker) const;
+
+  /**
+    Description:
+    Computes all crossings among the specified curves (see ExDbCurveBatchIntersection).
+    Curve indices of crossings refer to the ids array, entities which aren't curves are skipped.
+
+    Arguments:
+    ids       (I) Entities to intersect.
+    crossings (O) Receives crossings ordered by entity indices.
+    pPoints   (O) Optional, receives crossing points with duplicates merged.
+    bParallel (I) Intersect pairs by thread pool threads if thread pool is available.
+  */
+  virtual OdResult intersectAll(
+    const OdDbObjectIdArray& ids, ExDbCurveBatchIntersection::CrossingArray& crossings,
+    OdGePoint3dArray* pPoints = NULL, bool bParallel = true) const;
 };
 
 /** Description:
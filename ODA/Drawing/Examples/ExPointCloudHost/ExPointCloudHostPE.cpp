@@ -42,17 +42,30 @@ OdGeExtents3d ExPointCloudItem::extents() const
 
 OdInt64 ExPointCloudItem::pointsCount() const
 {
+  if (!m_pOctree.isNull())
+    return (OdInt64)m_pOctree->pointsCount();
   return m_points.size();
 }
 
 bool ExPointCloudItem::worldDrawPoints(const OdDbPointCloud* pEnt, OdGiWorldDraw* pWd) const
 {
+  // Octree nodes are selected depending on view
+  if (!m_pOctree.isNull())
+    return false;
   drawPoints(pWd->geometry());
   return true;
 }
 
 void ExPointCloudItem::viewportDrawPoints(const OdDbPointCloud* pEnt, OdGiViewportDraw* pWd) const
 {
+  if (!m_pOctree.isNull())
+  {
+    OdDbDatabasePtr pDb = pWd->context()->database();
+    OdInt16 pointSize = pDb->getPOINTCLOUDPOINTSIZE();
+
+    OdGiPointCloudPtr pGiPointCloud = m_pOctree->newGiPointCloud(pointSize);
+    pWd->geometry().pointCloud(*pGiPointCloud);
+  }
 //  drawPoints(pWd->geometry());
 }
 
@@ -71,6 +84,21 @@ OdResult ExPointCloudHostPE::load(const OdString& filename, OdDbPointCloudItemPt
   if(!::odSystemServices()->accessFile(filename, Oda::kFileRead))
     return eCantOpenFile;
 
+  // Use persisted octree, build it on first load. If octree file can't be written
+  // next to the source file all points are loaded into memory.
+  const OdString octPath = ExPointCloudOctree::octreePath(filename);
+  ExPointCloudOctreePtr pOctree = ExPointCloudOctree::open(octPath, filename);
+  if (pOctree.isNull() && (ExPointCloudOctree::build(filename, octPath) == eOk))
+    pOctree = ExPointCloudOctree::open(octPath, filename);
+  if (!pOctree.isNull())
+  {
+    ExPointCloudItemImplPtr exItem = ExPointCloudItem::createObject();
+    exItem->m_extents = pOctree->extents();
+    exItem->m_pOctree = pOctree;
+    pItem = exItem;
+    return eOk;
+  }
+
   OdRdFileBuf pcgFile(filename);
 
   char cMagic[3];
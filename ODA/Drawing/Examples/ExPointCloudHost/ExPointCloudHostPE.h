@@ -27,6 +27,7 @@
 
 #include "DbPointCloudObj/DbPointCloudHostPE.h"
 #include "Gi/GiGeometry.h"
+#include "ExPointCloudOctree.h"
 
 #include "TD_PackPush.h"
 
@@ -48,6 +49,7 @@ private:
 
   OdGePoint3dArray m_points;
   OdGeExtents3d m_extents;
+  ExPointCloudOctreePtr m_pOctree; // Out-of-core octree, points aren't loaded if it is available
 
   friend class ExPointCloudHostPE;
 };
@@ -0,0 +1,1269 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OdaCommon.h"
+#include "RxObjectImpl.h"
+#include "RxSystemServices.h"
+#include "RxThreadPoolService.h"
+#include "DynamicLinker.h"
+#include "StaticRxObject.h"
+#include "OdPlatformStreamer.h"
+#include "Ge/GeExtents2d.h"
+#include "ExPointCloudOctree.h"
+
+#define STL_USING_ALGORITHM
+#define STL_USING_VECTOR
+#define STL_USING_QUEUE
+#include "OdaSTL.h"
+#include <stdio.h>
+
+// Octree file layout: header, node point blocks (never crossing kChunkSize boundary, so every
+// block can be accessed through single mapped chunk) and node table. Data written in native
+// byte order, files with foreign byte order are rejected and rebuilt.
+
+static const char g_octreeMagic[8] = { 'E', 'X', 'P', 'C', 'O', 'C', 'T', '1' };
+static const OdUInt32 g_octreeVersion = 1;
+static const OdUInt32 g_octreeByteOrder = 0x01020304;
+
+struct ExPointCloudOctreeHeader
+{
+  char     m_magic[8];
+  OdUInt32 m_version;
+  OdUInt32 m_byteOrder;
+  OdUInt64 m_sourceLength;  // Length of source PCG file
+  OdUInt64 m_sourceStamp;   // Hash of source PCG file header and tail
+  OdUInt64 m_nPoints;
+  double   m_translation[3];
+  double   m_extents[6];
+  OdUInt64 m_nodesOffset;
+  OdUInt32 m_nNodes;
+  OdUInt32 m_chunkSize;
+};
+
+namespace
+{
+  enum
+  {
+    kReadBlockRecords   = 65536,     // Points read from source file at once
+    kGridDepth          = 7,         // Depth of counting grid used for bucketing
+    kBucketPoints       = 4194304,   // Bucket with more points is split (until kGridDepth reached)
+    kScatterBufferBytes = 0x4000000, // Total size of bucket write buffers
+    kMaxIoBytes         = 0x4000000, // Maximal size of single read or write call
+    kDecodeBatchPoints  = 4194304    // Points decoded at once by queries
+  };
+
+  struct PcgPoint
+  {
+    float m_x, m_y, m_z;
+  };
+
+  inline OdUInt64 fnvHash(OdUInt64 h, const OdUInt8 *pData, OdUInt32 nData)
+  {
+    for (OdUInt32 i = 0; i < nData; ++i)
+      h = (h ^ pData[i]) * 0x100000001B3ULL;
+    return h;
+  }
+
+  void readBytes(OdStreamBuf &stream, void *pBuffer, OdUInt64 nBytes)
+  {
+    OdUInt8 *pOut = (OdUInt8*)pBuffer;
+    while (nBytes)
+    {
+      const OdUInt32 nPart = (OdUInt32)odmin(nBytes, OdUInt64(kMaxIoBytes));
+      stream.getBytes(pOut, nPart);
+      pOut += nPart; nBytes -= nPart;
+    }
+  }
+
+  void writeBytes(OdStreamBuf &stream, const void *pBuffer, OdUInt64 nBytes)
+  {
+    const OdUInt8 *pIn = (const OdUInt8*)pBuffer;
+    while (nBytes)
+    {
+      const OdUInt32 nPart = (OdUInt32)odmin(nBytes, OdUInt64(kMaxIoBytes));
+      stream.putBytes(pIn, nPart);
+      pIn += nPart; nBytes -= nPart;
+    }
+  }
+
+  void removeFile(const OdString &path)
+  {
+    ::remove(OdAnsiString(path).c_str());
+  }
+
+  /** Description:
+      Receives blocks of points streamed from PCG file.
+  */
+  class PcgPointVisitor
+  {
+  public:
+    virtual ~PcgPointVisitor() { }
+    virtual void addPoints(const PcgPoint *pPoints, OdUInt32 nPoints) = 0;
+  };
+
+  /** Description:
+      PCG file reader. Points are read in large blocks instead of per-value stream calls.
+  */
+  class PcgSource
+  {
+    OdStreamBufPtr m_pStream;
+    OdUInt64       m_nLength;
+    OdUInt64       m_nDataBegin;
+    OdUInt32       m_nRecordSize;
+  public:
+    OdGeExtents3d  m_extents;
+    OdGeVector3d   m_translation;
+    OdUInt64       m_nStamp;
+
+    PcgSource() : m_nLength(0), m_nDataBegin(0), m_nRecordSize(0), m_nStamp(0) { }
+
+    OdUInt64 length() const { return m_nLength; }
+
+    OdResult open(const OdString &path)
+    {
+      if (!::odrxSystemServices()->accessFile(path, Oda::kFileRead))
+        return eCantOpenFile;
+      m_pStream = ::odrxSystemServices()->createFile(path, Oda::kFileRead, Oda::kShareDenyWrite, Oda::kOpenExisting);
+      m_nLength = m_pStream->length();
+      if (m_nLength < 5)
+        return eUnsupportedFileFormat;
+
+      char cMagic[3];
+      m_pStream->getBytes(cMagic, 3);
+      if (cMagic[0] != 'P' || cMagic[1] != 'C' || cMagic[2] != 'G')
+        return eUnsupportedFileFormat;
+
+      // read pcg file version
+      OdUInt16 pcgFileVer = OdPlatformStreamer::rdInt16(*m_pStream);
+      OdUInt32 nExtentsOffset;
+      switch (pcgFileVer)
+      {
+      case 3:
+        nExtentsOffset = 7;
+        m_nRecordSize = 4 + 3 * sizeof(float);
+        break;
+      case 4:
+        nExtentsOffset = 19;
+        m_nRecordSize = 8 + 3 * sizeof(float);
+        break;
+      default:
+        return eInvalidFileVersion;
+      }
+      m_nDataBegin = nExtentsOffset + 9 * sizeof(double);
+      if (m_nLength < m_nDataBegin)
+        return eUnsupportedFileFormat;
+
+      m_pStream->seek(nExtentsOffset, OdDb::kSeekFromStart);
+      double vals[9];
+      for (int i = 0; i < 9; ++i)
+        vals[i] = OdPlatformStreamer::rdDouble(*m_pStream);
+      m_extents.set(OdGePoint3d(vals[0], vals[1], vals[2]), OdGePoint3d(vals[3], vals[4], vals[5]));
+      m_translation.set(vals[6], vals[7], vals[8]);
+
+      // Stamp detects source file modifications without reading all points
+      OdUInt8 buf[4096];
+      m_pStream->seek(0, OdDb::kSeekFromStart);
+      m_pStream->getBytes(buf, (OdUInt32)m_nDataBegin);
+      m_nStamp = fnvHash(0xCBF29CE484222325ULL ^ m_nLength, buf, (OdUInt32)m_nDataBegin);
+      const OdUInt32 nTail = (OdUInt32)odmin(m_nLength - m_nDataBegin, OdUInt64(sizeof(buf)));
+      m_pStream->seek(m_nLength - nTail, OdDb::kSeekFromStart);
+      m_pStream->getBytes(buf, nTail);
+      m_nStamp = fnvHash(m_nStamp, buf, nTail);
+      return eOk;
+    }
+
+    // Streams points from the end of file backwards (as ExPointCloudHostPE::load does,
+    // because start of points data is unknown). Reading stops at zero point.
+    OdUInt64 read(PcgPointVisitor &visitor)
+    {
+      const OdUInt64 nRecords = (m_nLength > m_nDataBegin) ? (m_nLength - m_nDataBegin - 1) / m_nRecordSize : 0;
+      OdBinaryData buf;
+      buf.resize(kReadBlockRecords * m_nRecordSize);
+      std::vector<PcgPoint> points(kReadBlockRecords);
+      OdUInt64 nRead = 0, nEnd = m_nLength;
+      while (nRead < nRecords)
+      {
+        const OdUInt32 nBlock = (OdUInt32)odmin(OdUInt64(kReadBlockRecords), nRecords - nRead);
+        const OdUInt64 nBegin = nEnd - OdUInt64(nBlock) * m_nRecordSize;
+        m_pStream->seek((OdInt64)nBegin, OdDb::kSeekFromStart);
+        m_pStream->getBytes(buf.asArrayPtr(), nBlock * m_nRecordSize);
+        const OdUInt8 *pRead = buf.getPtr() + nBlock * m_nRecordSize;
+        OdUInt32 nPoints = 0;
+        bool bZero = false;
+        for (OdUInt32 i = 0; i < nBlock; ++i)
+        {
+          pRead -= m_nRecordSize;
+          // Temp variables are necessary because of possible alignment problems
+          OdUInt32 coords[3];
+          ::memcpy(coords, pRead, 3 * sizeof(float));
+          odSwap4BytesNumber(coords[0]);
+          odSwap4BytesNumber(coords[1]);
+          odSwap4BytesNumber(coords[2]);
+          PcgPoint &pt = points[nPoints];
+          ::memcpy(&pt, coords, 3 * sizeof(float));
+          // if the points run out, exit from the reading cycle
+          if (pt.m_x == 0.0f && pt.m_y == 0.0f && pt.m_z == 0.0f)
+          {
+            bZero = true;
+            break;
+          }
+          ++nPoints;
+        }
+        if (nPoints)
+          visitor.addPoints(&points[0], nPoints);
+        nRead += nPoints;
+        if (bZero)
+          break;
+        nEnd = nBegin;
+      }
+      return nRead;
+    }
+  };
+
+  inline OdUInt16 quantize(float v, float vMin, float scale)
+  {
+    const float q = (v - vMin) * scale + 0.5f;
+    if (q <= 0.0f)
+      return 0;
+    if (q >= 65535.0f)
+      return 65535;
+    return (OdUInt16)q;
+  }
+
+  /** Description:
+      Out-of-core octree construction.
+
+      Pass 1 counts points and computes their bounds, pass 2 counts points in cells of regular
+      counting grid, and adaptive buckets are selected so each bucket fits in memory. Pass 3
+      distributes points into buckets stored in temporary file and collects level of detail
+      samples for nodes above buckets. Finally every bucket is loaded and its subtree is built
+      and written in memory.
+  */
+  class OctreeBuilder
+  {
+  public:
+    struct BuildNode
+    {
+      ExPointCloudOctree::Node m_node;
+      OdUInt32 m_children[8];
+      OdUInt32 m_nChildren;
+    };
+    struct UpperNode
+    {
+      OdUInt32 m_nBuildNode;
+      OdUInt32 m_nDepth;
+      OdUInt64 m_nStride;
+      OdUInt64 m_nCounter;
+      std::vector<OdUInt16> m_samples;
+      OdInt32  m_child[8];   // Upper child node index or -1
+    };
+    struct Bucket
+    {
+      OdUInt32 m_nParent;    // Upper parent node index or -1
+      OdUInt32 m_nDepth, m_x, m_y, m_z;
+      OdUInt64 m_nPoints;
+      OdUInt64 m_nOffset;    // In points inside temporary file
+      OdUInt64 m_nWritten;
+      std::vector<PcgPoint> m_buffer;
+    };
+  protected:
+    PcgSource              &m_source;
+    OdStreamBufPtr          m_pOut;
+    OdUInt64                m_nOutPos;
+    std::vector<BuildNode>  m_nodes;
+    std::vector<UpperNode>  m_upper;
+    std::vector<Bucket>     m_buckets;
+    std::vector<OdUInt64>   m_grid[kGridDepth + 1];
+    std::vector<OdUInt32>   m_cellBucket;  // Bucket of every counting grid cell
+    OdUInt64                m_nBucketed;
+    float                   m_min[3];
+    float                   m_size;
+    double                  m_cellScale;
+    OdUInt32                m_nRoot;
+  public:
+    OctreeBuilder(PcgSource &source) : m_source(source), m_nOutPos(0), m_nBucketed(0), m_size(1.0f), m_cellScale(1.0), m_nRoot(0)
+    {
+      m_min[0] = m_min[1] = m_min[2] = 0.0f;
+    }
+
+    // Pass 1: points count and bounds
+    class BoundsVisitor : public PcgPointVisitor
+    {
+    public:
+      float m_min[3], m_max[3];
+      OdUInt64 m_nPoints;
+      BoundsVisitor() : m_nPoints(0)
+      {
+        m_min[0] = m_min[1] = m_min[2] = 3.0e38f;
+        m_max[0] = m_max[1] = m_max[2] = -3.0e38f;
+      }
+      void addPoints(const PcgPoint *pPoints, OdUInt32 nPoints)
+      {
+        for (OdUInt32 i = 0; i < nPoints; ++i)
+        {
+          const float *pCoords = &pPoints[i].m_x;
+          for (int j = 0; j < 3; ++j)
+          {
+            m_min[j] = odmin(m_min[j], pCoords[j]);
+            m_max[j] = odmax(m_max[j], pCoords[j]);
+          }
+        }
+        m_nPoints += nPoints;
+      }
+    };
+
+    inline OdUInt32 cellCoord(float v, int nAxis) const
+    {
+      const double c = (double(v) - m_min[nAxis]) * m_cellScale;
+      if (c <= 0.0)
+        return 0;
+      const OdUInt32 nCells = 1 << kGridDepth;
+      return odmin((OdUInt32)c, nCells - 1);
+    }
+    static inline OdUInt64 cellIndex(OdUInt32 nDepth, OdUInt32 x, OdUInt32 y, OdUInt32 z)
+    {
+      return (OdUInt64(z) << (2 * nDepth)) | (OdUInt64(y) << nDepth) | x;
+    }
+
+    // Pass 2: counting grid
+    class GridVisitor : public PcgPointVisitor
+    {
+      OctreeBuilder &m_builder;
+    public:
+      GridVisitor(OctreeBuilder &builder) : m_builder(builder) { }
+      void addPoints(const PcgPoint *pPoints, OdUInt32 nPoints)
+      {
+        std::vector<OdUInt64> &grid = m_builder.m_grid[kGridDepth];
+        for (OdUInt32 i = 0; i < nPoints; ++i)
+          grid[(size_t)cellIndex(kGridDepth, m_builder.cellCoord(pPoints[i].m_x, 0),
+                                 m_builder.cellCoord(pPoints[i].m_y, 1), m_builder.cellCoord(pPoints[i].m_z, 2))]++;
+      }
+    };
+
+    // Pass 3: distribution into buckets
+    class ScatterVisitor : public PcgPointVisitor
+    {
+      OctreeBuilder &m_builder;
+      OdStreamBuf   &m_tmp;
+    public:
+      ScatterVisitor(OctreeBuilder &builder, OdStreamBuf &tmp) : m_builder(builder), m_tmp(tmp) { }
+      void flush(Bucket &bucket)
+      {
+        if (bucket.m_buffer.empty())
+          return;
+        m_tmp.seek((OdInt64)((bucket.m_nOffset + bucket.m_nWritten) * sizeof(PcgPoint)), OdDb::kSeekFromStart);
+        writeBytes(m_tmp, &bucket.m_buffer[0], bucket.m_buffer.size() * sizeof(PcgPoint));
+        bucket.m_nWritten += bucket.m_buffer.size();
+        bucket.m_buffer.clear();
+      }
+      void addPoints(const PcgPoint *pPoints, OdUInt32 nPoints)
+      {
+        for (OdUInt32 i = 0; i < nPoints; ++i)
+        {
+          const PcgPoint &pt = pPoints[i];
+          const OdUInt32 x = m_builder.cellCoord(pt.m_x, 0), y = m_builder.cellCoord(pt.m_y, 1), z = m_builder.cellCoord(pt.m_z, 2);
+          Bucket &bucket = m_builder.m_buckets[m_builder.m_cellBucket[(size_t)cellIndex(kGridDepth, x, y, z)]];
+          bucket.m_buffer.push_back(pt);
+          if (bucket.m_buffer.size() == bucket.m_buffer.capacity())
+            flush(bucket);
+          // Level of detail samples of nodes above buckets
+          OdInt32 nUpper = m_builder.m_upper.empty() ? -1 : 0;
+          while (nUpper >= 0)
+          {
+            UpperNode &upper = m_builder.m_upper[nUpper];
+            if (!(upper.m_nCounter++ % upper.m_nStride) && (upper.m_samples.size() < 3 * ExPointCloudOctree::kLodPoints))
+            {
+              const ExPointCloudOctree::Node &node = m_builder.m_nodes[upper.m_nBuildNode].m_node;
+              const float scale = 65535.0f / node.m_size;
+              upper.m_samples.push_back(quantize(pt.m_x, node.m_min[0], scale));
+              upper.m_samples.push_back(quantize(pt.m_y, node.m_min[1], scale));
+              upper.m_samples.push_back(quantize(pt.m_z, node.m_min[2], scale));
+            }
+            const OdUInt32 nShift = kGridDepth - upper.m_nDepth - 1;
+            nUpper = upper.m_child[((x >> nShift) & 1) | (((y >> nShift) & 1) << 1) | (((z >> nShift) & 1) << 2)];
+          }
+        }
+      }
+    };
+
+    OdUInt32 addNode(OdUInt32 nDepth, OdUInt32 x, OdUInt32 y, OdUInt32 z)
+    {
+      BuildNode node;
+      ::memset(&node, 0, sizeof(BuildNode));
+      node.m_node.m_size = m_size / float(1 << nDepth);
+      node.m_node.m_min[0] = m_min[0] + node.m_node.m_size * x;
+      node.m_node.m_min[1] = m_min[1] + node.m_node.m_size * y;
+      node.m_node.m_min[2] = m_min[2] + node.m_node.m_size * z;
+      m_nodes.push_back(node);
+      return OdUInt32(m_nodes.size() - 1);
+    }
+    OdUInt32 addNode(const ExPointCloudOctree::Node &parent, OdUInt32 nOctant)
+    {
+      BuildNode node;
+      ::memset(&node, 0, sizeof(BuildNode));
+      node.m_node.m_size = parent.m_size * 0.5f;
+      node.m_node.m_min[0] = parent.m_min[0] + ((nOctant & 1) ? node.m_node.m_size : 0.0f);
+      node.m_node.m_min[1] = parent.m_min[1] + ((nOctant & 2) ? node.m_node.m_size : 0.0f);
+      node.m_node.m_min[2] = parent.m_min[2] + ((nOctant & 4) ? node.m_node.m_size : 0.0f);
+      m_nodes.push_back(node);
+      return OdUInt32(m_nodes.size() - 1);
+    }
+
+    // Selects buckets top-down over counting grid pyramid, returns upper node index or -1
+    OdInt32 selectCells(OdUInt32 nDepth, OdUInt32 x, OdUInt32 y, OdUInt32 z, OdUInt32 nParent)
+    {
+      const OdUInt64 nPoints = m_grid[nDepth][(size_t)cellIndex(nDepth, x, y, z)];
+      if (!nPoints)
+        return -1;
+      if ((nPoints <= kBucketPoints) || (nDepth == kGridDepth))
+      {
+        Bucket bucket;
+        bucket.m_nParent = nParent;
+        bucket.m_nDepth = nDepth; bucket.m_x = x; bucket.m_y = y; bucket.m_z = z;
+        bucket.m_nPoints = nPoints;
+        bucket.m_nOffset = m_nBucketed;
+        bucket.m_nWritten = 0;
+        m_nBucketed += nPoints;
+        const OdUInt32 nBucket = OdUInt32(m_buckets.size());
+        m_buckets.push_back(bucket);
+        const OdUInt32 nShift = kGridDepth - nDepth, nCells = 1 << nShift;
+        for (OdUInt32 cz = 0; cz < nCells; ++cz)
+          for (OdUInt32 cy = 0; cy < nCells; ++cy)
+            for (OdUInt32 cx = 0; cx < nCells; ++cx)
+              m_cellBucket[(size_t)cellIndex(kGridDepth, (x << nShift) + cx, (y << nShift) + cy, (z << nShift) + cz)] = nBucket;
+        return -1;
+      }
+      const OdUInt32 nUpper = OdUInt32(m_upper.size());
+      m_upper.push_back(UpperNode());
+      m_upper[nUpper].m_nBuildNode = addNode(nDepth, x, y, z);
+      m_upper[nUpper].m_nDepth = nDepth;
+      m_upper[nUpper].m_nStride = (nPoints + ExPointCloudOctree::kLodPoints - 1) / ExPointCloudOctree::kLodPoints;
+      m_upper[nUpper].m_nCounter = 0;
+      if (nParent != OdUInt32(-1))
+        linkChild(m_upper[nParent].m_nBuildNode, m_upper[nUpper].m_nBuildNode);
+      for (OdUInt32 nOctant = 0; nOctant < 8; ++nOctant)
+      {
+        const OdInt32 nChild = selectCells(nDepth + 1, (x << 1) | (nOctant & 1), (y << 1) | ((nOctant >> 1) & 1),
+                                           (z << 1) | ((nOctant >> 2) & 1), nUpper);
+        m_upper[nUpper].m_child[nOctant] = nChild;
+      }
+      return OdInt32(nUpper);
+    }
+
+    void linkChild(OdUInt32 nParent, OdUInt32 nChild)
+    {
+      BuildNode &parent = m_nodes[nParent];
+      parent.m_children[parent.m_nChildren++] = nChild;
+    }
+
+    // Writes node points block into output file
+    OdUInt64 writeBlock(const void *pData, OdUInt32 nBytes)
+    {
+      static const OdUInt8 zeros[4096] = { 0 };
+      const OdUInt64 nChunkRest = ExPointCloudOctree::kChunkSize - (m_nOutPos % ExPointCloudOctree::kChunkSize);
+      if (nBytes > nChunkRest)
+      {
+        for (OdUInt64 nPad = nChunkRest; nPad; )
+        {
+          const OdUInt32 nPart = (OdUInt32)odmin(nPad, OdUInt64(sizeof(zeros)));
+          m_pOut->putBytes(zeros, nPart);
+          nPad -= nPart;
+        }
+        m_nOutPos += nChunkRest;
+      }
+      const OdUInt64 nOffset = m_nOutPos;
+      if (nBytes)
+        m_pOut->putBytes(pData, nBytes);
+      m_nOutPos += nBytes;
+      return nOffset;
+    }
+
+    void writeQuantized(ExPointCloudOctree::Node &node, const std::vector<OdUInt16> &samples)
+    {
+      node.m_encoding = ExPointCloudOctree::kQuantizedPoints;
+      node.m_nPoints = OdUInt32(samples.size() / 3);
+      node.m_dataOffset = writeBlock(samples.empty() ? NULL : &samples[0], node.dataSize());
+    }
+
+    // Builds subtree over points range in memory
+    OdUInt32 buildSubtree(std::vector<PcgPoint> &points, std::vector<PcgPoint> &tmp, size_t nBegin, size_t nEnd,
+                          OdUInt32 nNode, OdUInt32 nDepth)
+    {
+      size_t nPoints = nEnd - nBegin;
+      if ((nPoints <= ExPointCloudOctree::kLeafPoints) || (nDepth >= ExPointCloudOctree::kMaxDepth))
+      {
+        if (nPoints > ExPointCloudOctree::kMaxNodePoints)
+        { // Points are closer than float precision here, so thinning doesn't lose visible details
+          for (size_t i = 0; i < ExPointCloudOctree::kMaxNodePoints; ++i)
+            points[nBegin + i] = points[nBegin + size_t(OdUInt64(i) * nPoints / ExPointCloudOctree::kMaxNodePoints)];
+          nPoints = ExPointCloudOctree::kMaxNodePoints;
+        }
+        ExPointCloudOctree::Node &node = m_nodes[nNode].m_node;
+        node.m_encoding = ExPointCloudOctree::kFloatPoints;
+        node.m_nPoints = OdUInt32(nPoints);
+        node.m_dataOffset = writeBlock(&points[nBegin], node.dataSize());
+        return nNode;
+      }
+      { // Level of detail sample (points keep source order inside ranges, so stride gives uniform sample)
+        const ExPointCloudOctree::Node &node = m_nodes[nNode].m_node;
+        const size_t nStride = (nPoints + ExPointCloudOctree::kLodPoints - 1) / ExPointCloudOctree::kLodPoints;
+        const float scale = 65535.0f / node.m_size;
+        std::vector<OdUInt16> samples;
+        samples.reserve(3 * ExPointCloudOctree::kLodPoints);
+        for (size_t i = nBegin; i < nEnd; i += nStride)
+        {
+          samples.push_back(quantize(points[i].m_x, node.m_min[0], scale));
+          samples.push_back(quantize(points[i].m_y, node.m_min[1], scale));
+          samples.push_back(quantize(points[i].m_z, node.m_min[2], scale));
+        }
+        writeQuantized(m_nodes[nNode].m_node, samples);
+      }
+      // Stable partition into octants
+      const ExPointCloudOctree::Node node = m_nodes[nNode].m_node;
+      const float half = node.m_size * 0.5f;
+      const float mid[3] = { node.m_min[0] + half, node.m_min[1] + half, node.m_min[2] + half };
+      size_t counts[8] = { 0 }, offsets[8];
+      for (size_t i = nBegin; i < nEnd; ++i)
+        counts[(points[i].m_x >= mid[0] ? 1 : 0) | (points[i].m_y >= mid[1] ? 2 : 0) | (points[i].m_z >= mid[2] ? 4 : 0)]++;
+      offsets[0] = nBegin;
+      for (int i = 1; i < 8; ++i)
+        offsets[i] = offsets[i - 1] + counts[i - 1];
+      for (size_t i = nBegin; i < nEnd; ++i)
+        tmp[offsets[(points[i].m_x >= mid[0] ? 1 : 0) | (points[i].m_y >= mid[1] ? 2 : 0) | (points[i].m_z >= mid[2] ? 4 : 0)]++] = points[i];
+      std::copy(tmp.begin() + nBegin, tmp.begin() + nEnd, points.begin() + nBegin);
+      size_t nFirst = nBegin;
+      for (OdUInt32 nOctant = 0; nOctant < 8; ++nOctant)
+      {
+        if (counts[nOctant])
+        {
+          const OdUInt32 nChild = addNode(node, nOctant);
+          linkChild(nNode, nChild);
+          buildSubtree(points, tmp, nFirst, nFirst + counts[nOctant], nChild, nDepth + 1);
+        }
+        nFirst += counts[nOctant];
+      }
+      return nNode;
+    }
+
+    void run(const OdString &octPath)
+    {
+      const OdString tmpPath = octPath + OD_T(".tmp");
+      const OdString ptsPath = octPath + OD_T(".pts");
+      try
+      {
+        build(tmpPath, ptsPath);
+        m_pOut.release();
+        removeFile(ptsPath);
+        removeFile(octPath);
+        if (::rename(OdAnsiString(tmpPath).c_str(), OdAnsiString(octPath).c_str()))
+          throw OdError(eFileWriteError);
+      }
+      catch (...)
+      {
+        m_pOut.release();
+        removeFile(ptsPath);
+        removeFile(tmpPath);
+        throw;
+      }
+    }
+
+    void build(const OdString &tmpPath, const OdString &ptsPath)
+    {
+      BoundsVisitor bounds;
+      m_source.read(bounds);
+      if (!bounds.m_nPoints)
+        throw OdError(eEmptySet);
+      float size = 0.0f;
+      for (int j = 0; j < 3; ++j)
+      {
+        m_min[j] = bounds.m_min[j];
+        size = odmax(size, bounds.m_max[j] - bounds.m_min[j]);
+      }
+      m_size = (size > 0.0f) ? (size * 1.0001f) : 1.0f;
+      m_cellScale = double(1 << kGridDepth) / m_size;
+
+      // Counting grid and its pyramid
+      for (OdUInt32 nDepth = 0; nDepth <= kGridDepth; ++nDepth)
+        m_grid[nDepth].resize(size_t(1) << (3 * nDepth), 0);
+      {
+        GridVisitor grid(*this);
+        m_source.read(grid);
+      }
+      for (OdUInt32 nDepth = kGridDepth; nDepth > 0; --nDepth)
+      {
+        const OdUInt32 nCells = 1 << nDepth;
+        for (OdUInt32 z = 0; z < nCells; ++z)
+          for (OdUInt32 y = 0; y < nCells; ++y)
+            for (OdUInt32 x = 0; x < nCells; ++x)
+              m_grid[nDepth - 1][(size_t)cellIndex(nDepth - 1, x >> 1, y >> 1, z >> 1)] += m_grid[nDepth][(size_t)cellIndex(nDepth, x, y, z)];
+      }
+      m_cellBucket.resize(m_grid[kGridDepth].size(), 0);
+      selectCells(0, 0, 0, 0, OdUInt32(-1));
+      for (OdUInt32 nDepth = 0; nDepth <= kGridDepth; ++nDepth)
+        std::vector<OdUInt64>().swap(m_grid[nDepth]);
+
+      // Distribute points into buckets
+      {
+        OdStreamBufPtr pTmp = ::odrxSystemServices()->createFile(ptsPath, (Oda::FileAccessMode)(Oda::kFileRead | Oda::kFileWrite),
+                                                                 Oda::kShareDenyReadWrite, Oda::kCreateAlways);
+        const size_t nBufferPoints = odmax(size_t(256), size_t(kScatterBufferBytes / sizeof(PcgPoint)) / m_buckets.size());
+        for (size_t i = 0; i < m_buckets.size(); ++i)
+          m_buckets[i].m_buffer.reserve((size_t)odmin(OdUInt64(nBufferPoints), m_buckets[i].m_nPoints));
+        ScatterVisitor scatter(*this, *pTmp);
+        m_source.read(scatter);
+        for (size_t i = 0; i < m_buckets.size(); ++i)
+        {
+          scatter.flush(m_buckets[i]);
+          std::vector<PcgPoint>().swap(m_buckets[i].m_buffer);
+        }
+      }
+
+      m_pOut = ::odrxSystemServices()->createFile(tmpPath, Oda::kFileWrite, Oda::kShareDenyReadWrite, Oda::kCreateAlways);
+      ExPointCloudOctreeHeader header;
+      ::memset(&header, 0, sizeof(ExPointCloudOctreeHeader));
+      m_pOut->putBytes(&header, sizeof(ExPointCloudOctreeHeader));
+      m_nOutPos = sizeof(ExPointCloudOctreeHeader);
+
+      for (size_t i = 0; i < m_upper.size(); ++i)
+      {
+        writeQuantized(m_nodes[m_upper[i].m_nBuildNode].m_node, m_upper[i].m_samples);
+        std::vector<OdUInt16>().swap(m_upper[i].m_samples);
+      }
+
+      // Build bucket subtrees
+      {
+        OdStreamBufPtr pTmp = ::odrxSystemServices()->createFile(ptsPath, Oda::kFileRead, Oda::kShareDenyWrite, Oda::kOpenExisting);
+        std::vector<PcgPoint> points, tmp;
+        for (size_t i = 0; i < m_buckets.size(); ++i)
+        {
+          const Bucket &bucket = m_buckets[i];
+          if (bucket.m_nWritten != bucket.m_nPoints)
+            throw OdError(eFileInternalErr); // Source file changed during build
+          points.resize((size_t)bucket.m_nPoints);
+          tmp.resize((size_t)bucket.m_nPoints);
+          pTmp->seek((OdInt64)(bucket.m_nOffset * sizeof(PcgPoint)), OdDb::kSeekFromStart);
+          readBytes(*pTmp, &points[0], bucket.m_nPoints * sizeof(PcgPoint));
+          const OdUInt32 nNode = addNode(bucket.m_nDepth, bucket.m_x, bucket.m_y, bucket.m_z);
+          if (bucket.m_nParent != OdUInt32(-1))
+            linkChild(m_upper[bucket.m_nParent].m_nBuildNode, nNode);
+          buildSubtree(points, tmp, 0, points.size(), nNode, bucket.m_nDepth);
+        }
+      }
+      m_nRoot = m_upper.empty() ? 0 : m_upper[0].m_nBuildNode;
+
+      // Node table in breadth first order, so children of every node are contiguous
+      std::vector<OdUInt32> order;
+      order.reserve(m_nodes.size());
+      order.push_back(m_nRoot);
+      std::vector<ExPointCloudOctree::Node> table(m_nodes.size());
+      for (size_t i = 0; i < order.size(); ++i)
+      {
+        const BuildNode &node = m_nodes[order[i]];
+        table[i] = node.m_node;
+        table[i].m_firstChild = OdUInt32(order.size());
+        table[i].m_nChildren = node.m_nChildren;
+        for (OdUInt32 j = 0; j < node.m_nChildren; ++j)
+          order.push_back(node.m_children[j]);
+      }
+      for (size_t i = table.size(); i-- > 0; )
+      {
+        ExPointCloudOctree::Node &node = table[i];
+        if (node.isLeaf())
+        {
+          node.m_firstChild = 0;
+          node.m_nSubtreePoints = node.m_nPoints;
+        }
+        else
+        {
+          node.m_nSubtreePoints = 0;
+          for (OdUInt32 j = 0; j < node.m_nChildren; ++j)
+            node.m_nSubtreePoints += table[node.m_firstChild + j].m_nSubtreePoints;
+        }
+      }
+
+      static const OdUInt8 zeros[8] = { 0 };
+      const OdUInt32 nAlign = OdUInt32((8 - (m_nOutPos & 7)) & 7);
+      m_pOut->putBytes(zeros, nAlign);
+      m_nOutPos += nAlign;
+      ::memcpy(header.m_magic, g_octreeMagic, sizeof(g_octreeMagic));
+      header.m_version = g_octreeVersion;
+      header.m_byteOrder = g_octreeByteOrder;
+      header.m_sourceLength = m_source.length();
+      header.m_sourceStamp = m_source.m_nStamp;
+      header.m_nPoints = table[0].m_nSubtreePoints;
+      for (int j = 0; j < 3; ++j)
+      {
+        header.m_translation[j] = m_source.m_translation[j];
+        header.m_extents[j] = m_source.m_extents.minPoint()[j];
+        header.m_extents[j + 3] = m_source.m_extents.maxPoint()[j];
+      }
+      header.m_nodesOffset = m_nOutPos;
+      header.m_nNodes = OdUInt32(table.size());
+      header.m_chunkSize = ExPointCloudOctree::kChunkSize;
+      writeBytes(*m_pOut, &table[0], table.size() * sizeof(ExPointCloudOctree::Node));
+      m_pOut->seek(0, OdDb::kSeekFromStart);
+      m_pOut->putBytes(&header, sizeof(ExPointCloudOctreeHeader));
+    }
+  };
+
+  /** Description:
+      Decodes octree nodes by thread pool threads. Every thread takes next node from shared counter.
+  */
+  class NodeDecoder : public OdApcAtom
+  {
+    const ExPointCloudOctree *m_pOctree;
+    const OdUInt32 *m_pNodes;
+    const OdUInt8 * const *m_pData;
+    OdGePoint3dArray *m_pOut;
+    OdUInt32 m_nNodes;
+    OdMutex m_mutex;
+    OdUInt32 m_nNext;
+  public:
+    NodeDecoder() : m_pOctree(NULL), m_pNodes(NULL), m_pData(NULL), m_pOut(NULL), m_nNodes(0), m_nNext(0) { }
+
+    void init(const ExPointCloudOctree *pOctree, const OdUInt32 *pNodes, const OdUInt8 * const *pData,
+              OdUInt32 nNodes, OdGePoint3dArray *pOut)
+    {
+      m_pOctree = pOctree;
+      m_pNodes = pNodes;
+      m_pData = pData;
+      m_nNodes = nNodes;
+      m_pOut = pOut;
+      m_nNext = 0;
+    }
+
+    void apcEntryPoint(OdApcParamType /*parameter*/)
+    {
+      for (;;)
+      {
+        OdUInt32 nIndex;
+        {
+          TD_AUTOLOCK(m_mutex);
+          if (m_nNext == m_nNodes)
+            break;
+          nIndex = m_nNext++;
+        }
+        m_pOctree->decodeNode(m_pNodes[nIndex], m_pData[nIndex], m_pOut[nIndex]);
+      }
+    }
+  };
+
+  /** Description:
+      Keeps data chunks of nodes mapped while they are decoded.
+  */
+  class NodePins
+  {
+    const ExPointCloudOctree &m_octree;
+    const OdUInt32 *m_pNodes;
+    OdUInt32 m_nNodes;
+  public:
+    OdArray<const OdUInt8*, OdMemoryAllocator<const OdUInt8*> > m_data;
+
+    NodePins(const ExPointCloudOctree &octree, const OdUInt32 *pNodes, OdUInt32 nNodes)
+      : m_octree(octree), m_pNodes(pNodes), m_nNodes(nNodes)
+    {
+      m_data.resize(nNodes, NULL);
+      m_octree.pinNodes(pNodes, nNodes, m_data.asArrayPtr());
+    }
+    ~NodePins()
+    {
+      m_octree.unpinNodes(m_pNodes, m_nNodes);
+    }
+  };
+
+  struct NodeCandidate
+  {
+    double   m_priority;
+    OdUInt32 m_nNode;
+
+    NodeCandidate(double priority, OdUInt32 nNode) : m_priority(priority), m_nNode(nNode) { }
+    bool operator <(const NodeCandidate &c2) const { return m_priority < c2.m_priority; }
+  };
+
+  // Splits selected nodes into batches, so decoded data size stays bounded
+  OdUInt32 nextBatch(const ExPointCloudOctree &octree, const OdUInt32Array &nodes, OdUInt32 nFirst)
+  {
+    OdUInt32 nBatch = 0;
+    OdUInt64 nPoints = 0;
+    while ((nFirst + nBatch < nodes.size()) && (!nBatch || (nPoints < kDecodeBatchPoints)))
+      nPoints += octree.node(nodes[nFirst + nBatch++]).m_nPoints;
+    return nBatch;
+  }
+
+  /** Description:
+      Gi point cloud which streams octree nodes selected for drawn viewport.
+  */
+  class ExPointCloudOctreeGi : public OdGiPointCloud
+  {
+    ExPointCloudOctreePtr m_pOctree;
+    OdUInt32 m_pointSize;
+  public:
+    ExPointCloudOctreeGi() : m_pointSize(0) { }
+
+    void init(const ExPointCloudOctree *pOctree, OdUInt32 pointSize)
+    {
+      m_pOctree = const_cast<ExPointCloudOctree*>(pOctree);
+      m_pointSize = pointSize;
+    }
+
+    virtual OdUInt32 totalPointsCount() const
+    {
+      return (OdUInt32)odmin(m_pOctree->pointsCount(), OdUInt64(0xFFFFFFFF));
+    }
+
+    virtual OdInt32 defaultPointSize() const
+    {
+      return (OdInt32)m_pointSize;
+    }
+
+    virtual bool getExtents(OdGeBoundBlock3d &bb) const
+    {
+      if (!m_pOctree->numNodes())
+        return false;
+      const OdGeExtents3d ext = m_pOctree->nodeExtents(0);
+      bb.set(ext.minPoint(), ext.maxPoint());
+      return true;
+    }
+
+    virtual bool isDataCompatible(const OdGiViewport &pVp1, const OdGiViewport &pVp2) const
+    {
+      if ((pVp1.isPerspective() != pVp2.isPerspective()) || (pVp1.getModelToEyeTransform() != pVp2.getModelToEyeTransform()))
+        return false;
+      OdGePoint2d dcMin1, dcMax1, dcMin2, dcMax2;
+      pVp1.getViewportDcCorners(dcMin1, dcMax1);
+      pVp2.getViewportDcCorners(dcMin2, dcMax2);
+      return (dcMin1 == dcMin2) && (dcMax1 == dcMax2);
+    }
+
+    virtual bool updatePointsData(OdGiPointCloudReceiver *pReceiver, OdUInt32 /*components*/,
+                                  const OdGiViewport *pVp, OdUInt32 pointSize) const
+    {
+      OdUInt32Array nodes;
+      m_pOctree->selectNodes(pVp, pointSize ? pointSize : m_pointSize, nodes);
+      OdArray<OdGePoint3dArray> decoded;
+      OdGiPointCloud::ComponentsRaw comps;
+      comps.m_pColors = NULL; comps.m_pTransparencies = NULL; comps.m_pNormals = NULL;
+      for (OdUInt32 nFirst = 0; nFirst < nodes.size(); )
+      {
+        const OdUInt32 nBatch = nextBatch(*m_pOctree, nodes, nFirst);
+        decoded.clear();
+        decoded.resize(nBatch);
+        m_pOctree->decodeNodes(nodes.getPtr() + nFirst, nBatch, decoded.asArrayPtr());
+        // Receivers aren't thread safe, so decoded nodes are passed from calling thread
+        for (OdUInt32 i = 0; i < nBatch; ++i)
+        {
+          if (decoded[i].isEmpty())
+            continue;
+          comps.m_pPoints = decoded[i].getPtr();
+          if (!pReceiver->addPoints(comps, decoded[i].size(), nodes[nFirst + i]))
+            return false;
+        }
+        nFirst += nBatch;
+      }
+      return true;
+    }
+  };
+}
+
+ExPointCloudOctree::ExPointCloudOctree()
+  : m_nFileLength(0)
+  , m_nPoints(0)
+  , m_nMappedBytes(0)
+  , m_nMappedLimit((sizeof(void*) > 4) ? OdUInt64(0x40000000) : OdUInt64(0x10000000))
+  , m_nUseCounter(0)
+{
+}
+
+ExPointCloudOctree::~ExPointCloudOctree()
+{
+  closeFile();
+}
+
+OdString ExPointCloudOctree::octreePath(const OdString &pcgPath)
+{
+  return pcgPath + OD_T(".exoct");
+}
+
+OdResult ExPointCloudOctree::build(const OdString &pcgPath, const OdString &octPath)
+{
+  PcgSource source;
+  OdResult res = source.open(pcgPath);
+  if (res != eOk)
+    return res;
+  try
+  {
+    OctreeBuilder builder(source);
+    builder.run(octPath);
+  }
+  catch (const OdError &err)
+  {
+    return err.code();
+  }
+  return eOk;
+}
+
+ExPointCloudOctreePtr ExPointCloudOctree::open(const OdString &octPath, const OdString &pcgPath)
+{
+  PcgSource source;
+  if ((source.open(pcgPath) != eOk) || !::odrxSystemServices()->accessFile(octPath, Oda::kFileRead))
+    return ExPointCloudOctreePtr();
+  OdStreamBufPtr pStream = ::odrxSystemServices()->createFile(octPath, Oda::kFileRead, Oda::kShareDenyWrite, Oda::kOpenExisting);
+  const OdUInt64 nLength = pStream->length();
+  if (nLength < sizeof(ExPointCloudOctreeHeader))
+    return ExPointCloudOctreePtr();
+  ExPointCloudOctreeHeader header;
+  pStream->getBytes(&header, sizeof(ExPointCloudOctreeHeader));
+  if (::memcmp(header.m_magic, g_octreeMagic, sizeof(g_octreeMagic)) || (header.m_version != g_octreeVersion) ||
+      (header.m_byteOrder != g_octreeByteOrder) || (header.m_chunkSize != kChunkSize) || !header.m_nNodes ||
+      (header.m_sourceLength != source.length()) || (header.m_sourceStamp != source.m_nStamp) ||
+      (header.m_nodesOffset + OdUInt64(header.m_nNodes) * sizeof(Node) > nLength))
+    return ExPointCloudOctreePtr();
+
+  ExPointCloudOctreePtr pOctree = OdRxObjectImpl<ExPointCloudOctree>::createObject();
+  pOctree->m_filePath = octPath;
+  pOctree->m_nFileLength = nLength;
+  pOctree->m_nPoints = header.m_nPoints;
+  pOctree->m_translation.set(header.m_translation[0], header.m_translation[1], header.m_translation[2]);
+  pOctree->m_extents.set(OdGePoint3d(header.m_extents[0], header.m_extents[1], header.m_extents[2]),
+                         OdGePoint3d(header.m_extents[3], header.m_extents[4], header.m_extents[5]));
+  pOctree->m_nodes.resize(header.m_nNodes);
+  pStream->seek((OdInt64)header.m_nodesOffset, OdDb::kSeekFromStart);
+  readBytes(*pStream, pOctree->m_nodes.asArrayPtr(), OdUInt64(header.m_nNodes) * sizeof(Node));
+  pStream.release();
+  if (!pOctree->openFile())
+    return ExPointCloudOctreePtr();
+  return pOctree;
+}
+
+bool ExPointCloudOctree::openFile()
+{
+  return m_file.open(m_filePath);
+}
+
+void ExPointCloudOctree::closeFile()
+{
+  for (ChunkMap::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+    unmapChunk(it->second);
+  m_chunks.clear();
+  m_nMappedBytes = 0;
+  m_file.close();
+}
+
+bool ExPointCloudOctree::mapChunk(OdUInt32 nChunk, MappedChunk &chunk) const
+{
+  if (!m_file.map(chunk.m_view, OdUInt64(nChunk) * kChunkSize, kChunkSize))
+    return false;
+  m_nMappedBytes += chunk.m_view.size();
+  return true;
+}
+
+void ExPointCloudOctree::unmapChunk(MappedChunk &chunk) const
+{
+  if (chunk.m_view.isNull())
+    return;
+  m_nMappedBytes -= chunk.m_view.size();
+  OdFileMapping::unmap(chunk.m_view);
+}
+
+void ExPointCloudOctree::evictChunks() const
+{
+  while (m_nMappedBytes > m_nMappedLimit)
+  {
+    ChunkMap::iterator itLru = m_chunks.end();
+    for (ChunkMap::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+    {
+      if (!it->second.m_nPins && ((itLru == m_chunks.end()) || (it->second.m_nLastUse < itLru->second.m_nLastUse)))
+        itLru = it;
+    }
+    if (itLru == m_chunks.end())
+      break;
+    unmapChunk(itLru->second);
+    m_chunks.erase(itLru);
+  }
+}
+
+void ExPointCloudOctree::setMappedLimit(OdUInt64 nBytes)
+{
+  TD_AUTOLOCK(m_mutex);
+  m_nMappedLimit = nBytes;
+  evictChunks();
+}
+
+OdUInt64 ExPointCloudOctree::mappedBytes() const
+{
+  TD_AUTOLOCK(m_mutex);
+  return m_nMappedBytes;
+}
+
+void ExPointCloudOctree::pinNodes(const OdUInt32 *pNodes, OdUInt32 nNodes, const OdUInt8 **pData) const
+{
+  TD_AUTOLOCK(m_mutex);
+  for (OdUInt32 i = 0; i < nNodes; ++i)
+  {
+    const Node &node = m_nodes[pNodes[i]];
+    pData[i] = NULL;
+    if (!node.m_nPoints)
+      continue;
+    const OdUInt32 nChunk = OdUInt32(node.m_dataOffset / kChunkSize);
+    const OdUInt32 nOffset = OdUInt32(node.m_dataOffset % kChunkSize);
+    ChunkMap::iterator it = m_chunks.find(nChunk);
+    if (it == m_chunks.end())
+    {
+      MappedChunk chunk;
+      if (!mapChunk(nChunk, chunk))
+        continue;
+      it = m_chunks.insert(ChunkMap::value_type(nChunk, chunk)).first;
+    }
+    if (nOffset + node.dataSize() > it->second.size())
+      continue;
+    it->second.m_nPins++;
+    it->second.m_nLastUse = ++m_nUseCounter;
+    pData[i] = it->second.m_view.data() + nOffset;
+  }
+}
+
+void ExPointCloudOctree::unpinNodes(const OdUInt32 *pNodes, OdUInt32 nNodes) const
+{
+  TD_AUTOLOCK(m_mutex);
+  for (OdUInt32 i = 0; i < nNodes; ++i)
+  {
+    const Node &node = m_nodes[pNodes[i]];
+    if (!node.m_nPoints)
+      continue;
+    ChunkMap::iterator it = m_chunks.find(OdUInt32(node.m_dataOffset / kChunkSize));
+    if ((it != m_chunks.end()) && it->second.m_nPins &&
+        (OdUInt32(node.m_dataOffset % kChunkSize) + node.dataSize() <= it->second.size()))
+      it->second.m_nPins--;
+  }
+  evictChunks();
+}
+
+void ExPointCloudOctree::decodeNode(OdUInt32 nNode, const OdUInt8 *pData, OdGePoint3dArray &points) const
+{
+  const Node &node = m_nodes[nNode];
+  if (!pData)
+  {
+    points.clear();
+    return;
+  }
+  points.resize(node.m_nPoints);
+  OdGePoint3d *pOut = points.asArrayPtr();
+  if (node.m_encoding == kQuantizedPoints)
+  {
+    const double scale = double(node.m_size) / 65535.0;
+    const OdGePoint3d base(node.m_min[0] + m_translation.x, node.m_min[1] + m_translation.y, node.m_min[2] + m_translation.z);
+    OdUInt16 q[3];
+    for (OdUInt32 i = 0; i < node.m_nPoints; ++i, pData += sizeof(q))
+    {
+      ::memcpy(q, pData, sizeof(q));
+      pOut[i].set(base.x + q[0] * scale, base.y + q[1] * scale, base.z + q[2] * scale);
+    }
+  }
+  else
+  {
+    float coords[3];
+    for (OdUInt32 i = 0; i < node.m_nPoints; ++i, pData += sizeof(coords))
+    {
+      ::memcpy(coords, pData, sizeof(coords));
+      //sum coords with translation coords and set it to point
+      pOut[i].set(coords[0] + m_translation.x, coords[1] + m_translation.y, coords[2] + m_translation.z);
+    }
+  }
+}
+
+void ExPointCloudOctree::decodeNodes(const OdUInt32 *pNodes, OdUInt32 nNodes, OdGePoint3dArray *pNodePoints, bool bParallel) const
+{
+  if (!nNodes)
+    return;
+  NodePins pins(*this, pNodes, nNodes);
+  OdRxThreadPoolServicePtr pThreadPool;
+  if (bParallel && (nNodes > 1))
+    pThreadPool = ::odrxDynamicLinker()->getModule(OdThreadPoolModuleName);
+  if (pThreadPool.isNull() || (pThreadPool->numCPUs() < 2))
+  {
+    for (OdUInt32 i = 0; i < nNodes; ++i)
+      decodeNode(pNodes[i], pins.m_data[i], pNodePoints[i]);
+  }
+  else
+  {
+    const unsigned nThreads = (unsigned)odmin(pThreadPool->numCPUs(), int(nNodes));
+    OdStaticRxObject<NodeDecoder> decoder;
+    decoder.init(this, pNodes, pins.m_data.getPtr(), nNodes, pNodePoints);
+    OdApcQueuePtr pQueue = pThreadPool->newMTQueue(ThreadsCounter::kNoAttributes, nThreads, kMtQueueAllowExecByMain);
+    for (unsigned i = 0; i < nThreads; ++i)
+      pQueue->addEntryPoint(&decoder, (OdApcParamType)i);
+    pQueue->wait();
+  }
+}
+
+OdGeExtents3d ExPointCloudOctree::nodeExtents(OdUInt32 nNode) const
+{
+  const Node &node = m_nodes[nNode];
+  const OdGePoint3d minPt(node.m_min[0] + m_translation.x, node.m_min[1] + m_translation.y, node.m_min[2] + m_translation.z);
+  return OdGeExtents3d(minPt, minPt + OdGeVector3d(node.m_size, node.m_size, node.m_size));
+}
+
+double ExPointCloudOctree::nodeSpacing(OdUInt32 nNode) const
+{
+  const Node &node = m_nodes[nNode];
+  if (!node.m_nPoints)
+    return 0.0;
+  // Scanned points are mostly placed on surfaces, so points count grows as square of resolution
+  return node.m_size * OdGeVector3d(1.0, 1.0, 1.0).length() / sqrt(double(node.m_nPoints));
+}
+
+void ExPointCloudOctree::selectNodes(const OdGiViewport *pVp, OdUInt32 pointSize, OdUInt32Array &nodes, OdUInt64 nMaxPoints) const
+{
+  nodes.clear();
+  if (m_nodes.isEmpty())
+    return;
+  OdGeMatrix3d xModelToEye, xModelToWorld;
+  OdGePoint2d dcMin, dcMax;
+  bool bPerspective = false;
+  if (pVp)
+  {
+    xModelToEye = pVp->getModelToEyeTransform();
+    xModelToWorld = pVp->getEyeToWorldTransform() * xModelToEye;
+    bPerspective = pVp->isPerspective();
+    pVp->getViewportDcCorners(dcMin, dcMax); // in eye coordinates
+  }
+  const double maxSpacing = odmax(OdUInt32(1), pointSize);
+
+  // Nodes are refined in order of their points spacing in pixels until it is small enough
+  // or points limit reached. Children points replace points of refined node.
+  std::priority_queue<NodeCandidate> queue;
+  OdUInt64 nSelected = 0;
+  OdUInt32 nCandidate = 0;
+  OdUInt32 nCandidates = 1;
+  for (;;)
+  {
+    for (; nCandidate < nCandidates; ++nCandidate)
+    {
+      const OdUInt32 nNode = nCandidate;
+      const OdGeExtents3d ext = nodeExtents(nNode);
+      double priority = nodeSpacing(nNode);
+      if (pVp)
+      {
+        bool bVisible = true;
+        OdGeExtents2d eyeExt;
+        for (int nCorner = 0; (nCorner < 8) && bVisible; ++nCorner)
+        {
+          OdGePoint3d pt((nCorner & 1) ? ext.maxPoint().x : ext.minPoint().x, (nCorner & 2) ? ext.maxPoint().y : ext.minPoint().y,
+                         (nCorner & 4) ? ext.maxPoint().z : ext.minPoint().z);
+          pt.transformBy(xModelToEye);
+          if (bPerspective && !pVp->doPerspective(pt))
+            break; // Corner behind camera, keep node
+          eyeExt.addPoint(pt.convert2d());
+          if (nCorner == 7)
+            bVisible = (eyeExt.minPoint().x <= dcMax.x) && (eyeExt.maxPoint().x >= dcMin.x) &&
+                       (eyeExt.minPoint().y <= dcMax.y) && (eyeExt.maxPoint().y >= dcMin.y);
+        }
+        if (!bVisible)
+          continue;
+        OdGePoint2d density;
+        pVp->getNumPixelsInUnitSquare(ext.center().transformBy(xModelToWorld), density, true);
+        priority *= odmax(fabs(density.x), fabs(density.y));
+      }
+      queue.push(NodeCandidate(priority, nNode));
+      nSelected += m_nodes[nNode].m_nPoints;
+    }
+    if (queue.empty())
+      break;
+    const NodeCandidate top = queue.top();
+    queue.pop();
+    const Node &node = m_nodes[top.m_nNode];
+    OdUInt64 nChildPoints = 0;
+    for (OdUInt32 i = 0; i < node.m_nChildren; ++i)
+      nChildPoints += m_nodes[node.m_firstChild + i].m_nPoints;
+    if (node.isLeaf() || (pVp && (top.m_priority <= maxSpacing)) || (nSelected - node.m_nPoints + nChildPoints > nMaxPoints))
+    {
+      nodes.push_back(top.m_nNode);
+      continue;
+    }
+    nSelected -= node.m_nPoints;
+    nCandidate = node.m_firstChild;
+    nCandidates = node.m_firstChild + node.m_nChildren;
+  }
+}
+
+void ExPointCloudOctree::selectNodes(const OdGeExtents3d &box, double minSpacing, OdUInt32Array &nodes) const
+{
+  nodes.clear();
+  if (m_nodes.isEmpty())
+    return;
+  OdUInt32Array stack;
+  stack.push_back(0);
+  while (!stack.isEmpty())
+  {
+    const OdUInt32 nNode = stack.last();
+    stack.removeLast();
+    if (box.isDisjoint(nodeExtents(nNode)))
+      continue;
+    const Node &node = m_nodes[nNode];
+    if (node.isLeaf() || ((minSpacing > 0.0) && (nodeSpacing(nNode) <= minSpacing)))
+    {
+      nodes.push_back(nNode);
+      continue;
+    }
+    for (OdUInt32 i = 0; i < node.m_nChildren; ++i)
+      stack.push_back(node.m_firstChild + i);
+  }
+}
+
+OdUInt64 ExPointCloudOctree::queryPoints(const OdGeExtents3d &box, OdGePoint3dArray &points, double minSpacing, bool bParallel) const
+{
+  OdUInt32Array nodes;
+  selectNodes(box, minSpacing, nodes);
+  const OdUInt32 nPrev = points.size();
+  OdArray<OdGePoint3dArray> decoded;
+  for (OdUInt32 nFirst = 0; nFirst < nodes.size(); )
+  {
+    const OdUInt32 nBatch = nextBatch(*this, nodes, nFirst);
+    decoded.clear();
+    decoded.resize(nBatch);
+    decodeNodes(nodes.getPtr() + nFirst, nBatch, decoded.asArrayPtr(), bParallel);
+    for (OdUInt32 i = 0; i < nBatch; ++i)
+    {
+      const OdGePoint3dArray &nodePoints = decoded[i];
+      if (box.contains(nodeExtents(nodes[nFirst + i])))
+      {
+        points.append(nodePoints);
+        continue;
+      }
+      for (OdUInt32 j = 0; j < nodePoints.size(); ++j)
+      {
+        if (box.contains(nodePoints[j]))
+          points.push_back(nodePoints[j]);
+      }
+    }
+    nFirst += nBatch;
+  }
+  return points.size() - nPrev;
+}
+
+OdGiPointCloudPtr ExPointCloudOctree::newGiPointCloud(OdUInt32 pointSize) const
+{
+  OdSmartPtr<ExPointCloudOctreeGi> pCloud = OdRxObjectImpl<ExPointCloudOctreeGi>::createObject();
+  pCloud->init(this, pointSize);
+  return pCloud;
+}
@@ -0,0 +1,173 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef __OD_EX_POINTCLOUD_OCTREE__
+#define __OD_EX_POINTCLOUD_OCTREE__
+
+#include "RxObject.h"
+#include "OdMutex.h"
+#include "OdBinaryData.h"
+#include "UInt32Array.h"
+#include "Ge/GePoint3dArray.h"
+#include "Ge/GeExtents3d.h"
+#include "Gi/GiPointCloud.h"
+#include "OdFileMapping.h"
+
+#include <map>
+
+#include "TD_PackPush.h"
+
+/** Description:
+    Out-of-core octree built over PCG point cloud and persisted into sidecar file.
+
+    Every octree node owns a block of points in the file. Leaf nodes store all their points
+    as floats relative to PCG translation (so full resolution data is lossless), internal nodes
+    store fixed size level of detail sample of their subtree quantized into 16-bit node cube
+    coordinates. Views and clip queries select a cut through the tree, only data chunks of the
+    selected nodes are memory mapped, and node blocks are decoded by thread pool threads.
+
+    {group:OdDbPointCloud_Classes}
+*/
+class ExPointCloudOctree : public OdRxObject
+{
+public:
+  enum
+  {
+    kLeafPoints   = 32768,    // Node with more points is subdivided
+    kLodPoints    = 16384,    // Size of internal node level of detail sample
+    kMaxDepth     = 20,       // Points of nodes at this depth are thinned to kMaxNodePoints
+    kMaxNodePoints = 1048576,
+    kChunkSize    = 0x1000000 // Mapping unit (16 Mb), node blocks never cross chunk boundary
+  };
+
+  enum NodeEncoding
+  {
+    kFloatPoints     = 0, // 3 floats relative to translation
+    kQuantizedPoints = 1  // 3 x 16-bit integers relative to node cube
+  };
+
+  // On-disk node descriptor. Children of node are stored contiguously.
+  struct Node
+  {
+    float    m_min[3];        // Node cube origin relative to translation
+    float    m_size;          // Node cube size
+    OdUInt64 m_dataOffset;    // Offset of points block in file
+    OdUInt64 m_nSubtreePoints;
+    OdUInt32 m_nPoints;       // Number of points stored by this node
+    OdUInt32 m_firstChild;
+    OdUInt32 m_nChildren;
+    OdUInt32 m_encoding;      // NodeEncoding
+
+    bool isLeaf() const { return m_nChildren == 0; }
+    OdUInt32 dataSize() const { return m_nPoints * ((m_encoding == kQuantizedPoints) ? 6 : 12); }
+  };
+
+protected:
+  struct MappedChunk
+  {
+    OdFileMapping::View m_view;
+    OdUInt32            m_nPins;
+    OdUInt64            m_nLastUse;
+
+    MappedChunk() : m_nPins(0), m_nLastUse(0) { }
+    OdUInt32 size() const { return (OdUInt32)m_view.size(); }
+  };
+  typedef std::map<OdUInt32, MappedChunk> ChunkMap;
+
+  OdString          m_filePath;
+  OdUInt64          m_nFileLength;
+  OdUInt64          m_nPoints;
+  OdGeVector3d      m_translation;
+  OdGeExtents3d     m_extents;
+  OdArray<Node, OdMemoryAllocator<Node> > m_nodes;
+  OdFileMapping     m_file;
+  mutable ChunkMap  m_chunks;
+  mutable OdUInt64  m_nMappedBytes;
+  OdUInt64          m_nMappedLimit;
+  mutable OdUInt64  m_nUseCounter;
+  mutable OdMutex   m_mutex;
+
+  bool openFile();
+  void closeFile();
+  bool mapChunk(OdUInt32 nChunk, MappedChunk &chunk) const;
+  void unmapChunk(MappedChunk &chunk) const;
+  void evictChunks() const;
+public:
+  ExPointCloudOctree();
+  ~ExPointCloudOctree();
+
+  ODRX_USING_HEAP_OPERATORS(OdRxObject);
+
+  // Returns sidecar octree file path for PCG file
+  static OdString octreePath(const OdString &pcgPath);
+  // Builds octree file for PCG file. Points are streamed from source in blocks and
+  // distributed into spatial buckets through temporary file, so memory usage doesn't
+  // depend on number of points.
+  static OdResult build(const OdString &pcgPath, const OdString &octPath);
+  // Opens octree file. Returns null if file doesn't exist or doesn't match source PCG file.
+  static OdSmartPtr<ExPointCloudOctree> open(const OdString &octPath, const OdString &pcgPath);
+
+  const OdString &filePath() const { return m_filePath; }
+  OdUInt64 pointsCount() const { return m_nPoints; }
+  const OdGeExtents3d &extents() const { return m_extents; }
+  const OdGeVector3d &translation() const { return m_translation; }
+  OdUInt32 numNodes() const { return m_nodes.size(); }
+  const Node &node(OdUInt32 nNode) const { return m_nodes[nNode]; }
+  OdGeExtents3d nodeExtents(OdUInt32 nNode) const;
+
+  // Limit of memory mapped data chunks which aren't used by running requests
+  void setMappedLimit(OdUInt64 nBytes);
+  OdUInt64 mappedLimit() const { return m_nMappedLimit; }
+  OdUInt64 mappedBytes() const;
+
+  // Selects octree nodes required to draw viewport with specified point size. If viewport
+  // isn't specified coarse cut limited by number of points is selected.
+  void selectNodes(const OdGiViewport *pVp, OdUInt32 pointSize, OdUInt32Array &nodes,
+                   OdUInt64 nMaxPoints = 20000000) const;
+  // Selects octree nodes intersecting box. Subdivision stops at nodes with points spacing
+  // less or equal to minSpacing, so zero spacing selects full resolution data.
+  void selectNodes(const OdGeExtents3d &box, double minSpacing, OdUInt32Array &nodes) const;
+  // Estimated distance between neighbor points stored by node
+  double nodeSpacing(OdUInt32 nNode) const;
+
+  // Decodes points of specified nodes (nodePoints receives one array per node). Nodes are
+  // decoded by thread pool threads if bParallel is set.
+  void decodeNodes(const OdUInt32 *pNodes, OdUInt32 nNodes, OdGePoint3dArray *pNodePoints, bool bParallel = true) const;
+  // Collects points inside box (clip query)
+  OdUInt64 queryPoints(const OdGeExtents3d &box, OdGePoint3dArray &points, double minSpacing = 0.0, bool bParallel = true) const;
+
+  // Creates Gi point cloud which streams octree nodes selected for drawn viewport
+  OdGiPointCloudPtr newGiPointCloud(OdUInt32 pointSize) const;
+
+  // Data access for node decoders
+  void pinNodes(const OdUInt32 *pNodes, OdUInt32 nNodes, const OdUInt8 **pData) const;
+  void unpinNodes(const OdUInt32 *pNodes, OdUInt32 nNodes) const;
+  void decodeNode(OdUInt32 nNode, const OdUInt8 *pData, OdGePoint3dArray &points) const;
+};
+
+typedef OdSmartPtr<ExPointCloudOctree> ExPointCloudOctreePtr;
+
+#include "TD_PackPop.h"
+
+#endif // __OD_EX_POINTCLOUD_OCTREE__
@@ -27,7 +27,7 @@
 /*                                                                                 */
 /* Calling sequence:                                                               */
 /*                                                                                 */
-/*   OdColladaImportEx <input file> <output file>                                  */
+/*   OdColladaImportEx <input file> <output file> [-parallel] [-weld] [-blocks]    */
 /***********************************************************************************/
 
 #include "OdaCommon.h"
@@ -38,6 +38,7 @@
 #include "RxModule.h"
 #include "RxDynamicModule.h"
 #include "RxVariantValue.h"
+#include "RxThreadPoolService.h"
 #include "../../Imports/ColladaImport/Include/ColladaImport.h"
 using namespace TD_COLLADA_IMPORT;
 
@@ -109,9 +110,12 @@ ODRX_BEGIN_STATIC_MODULE_MAP()
   /**********************************************************************/
   if (argc < 3) 
   {
-    odPrintConsoleString(L"usage: OdColladaImportEx <input file> <output file>\n");
+    odPrintConsoleString(L"usage: OdColladaImportEx <input file> <output file> [-parallel] [-weld] [-blocks]\n");
     odPrintConsoleString(L"   <input file>  - .dae file\n");
     odPrintConsoleString(L"   <output file> - .dxf or .dwg file\n");
+    odPrintConsoleString(L"   -parallel     - convert geometries using thread pool\n");
+    odPrintConsoleString(L"   -weld         - merge coincident mesh positions\n");
+    odPrintConsoleString(L"   -blocks       - import repeated geometry instances as block references\n");
     return 1;
   }
 
@@ -149,6 +153,19 @@ ODRX_BEGIN_STATIC_MODULE_MAP()
       importer->properties()->putAt( L"ColladaPath", OdRxVariantValue( OdString(argv[1]) ) );
       importer->properties()->putAt( L"ImportTextures", OdRxVariantValue( true ) );
       importer->properties()->putAt( L"ConsoleInfo", OdRxVariantValue( true ) );
+      for (int nArg = 3; nArg < argc; ++nArg)
+      {
+        OdString sArg(argv[nArg]);
+        if (sArg == L"-parallel")
+        {
+          ::odrxDynamicLinker()->loadModule(OdThreadPoolModuleName);
+          importer->properties()->putAt( L"ParallelGeometry", OdRxVariantValue( true ) );
+        }
+        else if (sArg == L"-weld")
+          importer->properties()->putAt( L"WeldVertices", OdRxVariantValue( true ) );
+        else if (sArg == L"-blocks")
+          importer->properties()->putAt( L"InstanceBlocks", OdRxVariantValue( true ) );
+      }
 
       /**************************************************************/
       /* Import Collada file                                        */
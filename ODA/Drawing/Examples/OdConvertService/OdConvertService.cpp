@@ -0,0 +1,672 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+/************************************************************************/
+/* Long-lived headless conversion service.                              */
+/*                                                                      */
+/* Drawings SDK is initialized once, so modules loaded by the first     */
+/* jobs stay loaded for the following ones. Jobs are read line by line  */
+/* from stdin or from a local socket and converted in parallel by a     */
+/* bounded number of worker threads.                                    */
+/*                                                                      */
+/* Output files are written into temporary file which then replaces    */
+/* the target, so several service processes (or other readers) never   */
+/* observe partially written drawings.                                  */
+/************************************************************************/
+
+static const char cUsage[] =
+{
+"Usage:\n"
+"OdConvertService [-j <workers>] [-socket <path>] [-ver <OutVer>] [-type <OutType>] [-audit]\n"
+"    -j      maximal number of parallel conversions (default is number of CPUs)\n"
+"    -socket accept jobs over local socket instead of stdin (not on Windows)\n"
+"    -ver    default output version: ACAD12, ACAD13, ACAD14, ACAD2000, ACAD2004,\n"
+"            ACAD2007, ACAD2010, ACAD2013, ACAD2018 (default is latest supported version)\n"
+"    -type   default output type: DWG, DXF, DXB (default is DWG)\n"
+"    -audit  audit and fix drawings before saving by default\n"
+"\n"
+"Job line (UTF-8, fields separated by TAB):\n"
+"    <source file> <target file> [OutVer] [OutType] [AUDIT|NOAUDIT]\n"
+"    Empty lines and lines starting with '#' are ignored, \"quit\" stops the service.\n"
+"Result line (fields separated by TAB):\n"
+"    <job number> OK|FAILED <time, ms> <process peak memory, KB> <peak growth, KB> <target file or error>\n\n"
+};
+/************************************************************************/
+
+#include "OdaCommon.h"
+#include "DbDatabase.h"
+#include "DbAudit.h"
+#include "RxDynamicModule.h"
+#include "DynamicLinker.h"
+#include "RxThreadPoolService.h"
+#include "ExSystemServices.h"
+#include "ExHostAppServices.h"
+#include "OdPerfTimer.h"
+#include "OdMutex.h"
+#include "diagnostics.h"
+
+#define STL_USING_IOSTREAM
+#include "OdaSTL.h"
+#define  STD(a)  std:: a
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ODA_WINDOWS) && !defined(_WINRT)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#define OD_CONVERTSERVICE_SOCKET
+#endif
+
+#ifdef OD_HAVE_CONSOLE_H_FILE
+#include <console.h>
+#endif
+
+/************************************************************************/
+/* Define a module map for statically linked modules:                   */
+/************************************************************************/
+#ifndef _TOOLKIT_IN_DLL_
+
+ODRX_DECLARE_STATIC_MODULE_ENTRY_POINT(OdRecomputeDimBlockModule);
+ODRX_DECLARE_STATIC_MODULE_ENTRY_POINT(ModelerModule);
+ODRX_DECLARE_STATIC_MODULE_ENTRY_POINT(OdRxThreadPoolImpl);
+
+ODRX_BEGIN_STATIC_MODULE_MAP()
+  ODRX_DEFINE_STATIC_APPLICATION(OdRecomputeDimBlockModuleName, OdRecomputeDimBlockModule)
+  ODRX_DEFINE_STATIC_APPLICATION(OdModelerGeometryModuleName,  ModelerModule)
+  ODRX_DEFINE_STATIC_APPMODULE(OdThreadPoolModuleName,         OdRxThreadPoolImpl)
+ODRX_END_STATIC_MODULE_MAP()
+
+#endif
+
+/************************************************************************/
+/* Define a Custom Services class.                                      */
+/*                                                                      */
+/* Combines the platform dependent functionality of                     */
+/* ExSystemServices and ExHostAppServices                               */ 
+/************************************************************************/
+class MyServices : public ExSystemServices, public ExHostAppServices
+{
+protected:
+  ODRX_USING_HEAP_OPERATORS(ExSystemServices);
+};
+
+/************************************************************************/
+/* Audit info which doesn't print anything (jobs run in parallel)       */
+/************************************************************************/
+class SilentAuditInfo : public OdDbAuditInfo
+{
+  void printError(const OdString& /*strName*/, const OdString& /*strValue*/,
+                  const OdString& /*strValidation*/, const OdString& /*strDefaultValue*/)
+  {
+  }
+  void printInfo(const OdString& /*strInfo*/)
+  {
+  }
+};
+
+/********************************************************************************/
+/* Define Assert function to not crash Debug application if assertion is fired. */
+/********************************************************************************/
+static void MyAssert(const char* expression, const char* fileName, int nLineNo)
+{
+  OdString message;
+  message.format(L"\n!!! Assertion failed: \"%s\"\n    file: %ls, line %d\n\n", OdString(expression).c_str(), OdString(fileName).c_str(), nLineNo);
+  odPrintConsoleString(message);
+}
+
+/************************************************************************/
+/* Parse output version and type                                        */
+/************************************************************************/
+static bool parseVersion(const OdString& sVer, OdDb::DwgVersion& outVer)
+{
+  if      (!odStrICmp(sVer, OD_T("ACAD12")))    outVer = OdDb::vAC12;
+  else if (!odStrICmp(sVer, OD_T("ACAD13")))    outVer = OdDb::vAC13;
+  else if (!odStrICmp(sVer, OD_T("ACAD14")))    outVer = OdDb::vAC14;
+  else if (!odStrICmp(sVer, OD_T("ACAD2000")))  outVer = OdDb::vAC15;
+  else if (!odStrICmp(sVer, OD_T("ACAD2004")))  outVer = OdDb::vAC18;
+  else if (!odStrICmp(sVer, OD_T("ACAD2007")))  outVer = OdDb::vAC21;
+  else if (!odStrICmp(sVer, OD_T("ACAD2010")))  outVer = OdDb::vAC24;
+  else if (!odStrICmp(sVer, OD_T("ACAD2013")))  outVer = OdDb::vAC27;
+  else if (!odStrICmp(sVer, OD_T("ACAD2018")))  outVer = OdDb::vAC32;
+  else return false;
+  return true;
+}
+
+static bool parseType(const OdString& sType, OdDb::SaveType& outType)
+{
+  if      (!odStrICmp(sType, OD_T("DWG"))) outType = OdDb::kDwg;
+  else if (!odStrICmp(sType, OD_T("DXF"))) outType = OdDb::kDxf;
+  else if (!odStrICmp(sType, OD_T("DXB"))) outType = OdDb::kDxb;
+  else return false;
+  return true;
+}
+
+/************************************************************************/
+/* Process memory usage                                                 */
+/************************************************************************/
+static OdUInt64 processPeakMemoryKB()
+{
+#if defined(ODA_WINDOWS) && !defined(_WINRT)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (::GetProcessMemoryInfo(::GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return (OdUInt64)pmc.PeakWorkingSetSize / 1024;
+  return 0;
+#else
+  struct rusage usage;
+  if (::getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return (OdUInt64)usage.ru_maxrss / 1024; // bytes on Mac OS X
+#else
+  return (OdUInt64)usage.ru_maxrss; // kilobytes
+#endif
+#endif
+}
+
+/************************************************************************/
+/* Replaces target file by completely written temporary file            */
+/************************************************************************/
+static OdString temporaryPath(const OdString& target, OdUInt32 nJob)
+{
+  OdString sTmp;
+#if defined(ODA_WINDOWS) && !defined(_WINRT)
+  sTmp.format(OD_T("%ls.%u_%u.tmp"), target.c_str(), (unsigned)::GetCurrentProcessId(), (unsigned)nJob);
+#else
+  sTmp.format(OD_T("%ls.%u_%u.tmp"), target.c_str(), (unsigned)::getpid(), (unsigned)nJob);
+#endif
+  return sTmp;
+}
+
+static bool replaceFile(const OdString& source, const OdString& target)
+{
+#if defined(ODA_WINDOWS) && !defined(_WINRT)
+  return ::MoveFileExW(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  return ::rename(OdAnsiString(source, CP_UTF_8).c_str(), OdAnsiString(target, CP_UTF_8).c_str()) == 0;
+#endif
+}
+
+static void removeFile(const OdString& path)
+{
+#if defined(ODA_WINDOWS) && !defined(_WINRT)
+  ::DeleteFileW(path.c_str());
+#else
+  ::remove(OdAnsiString(path, CP_UTF_8).c_str());
+#endif
+}
+
+/************************************************************************/
+/* Destination of job results: stdout or client socket                  */
+/************************************************************************/
+class ResultChannel : public OdRxObject
+{
+  OdMutex m_mutex;
+  int     m_fd; // socket, or -1 for stdout
+public:
+  ResultChannel() : m_fd(-1) { }
+  ~ResultChannel()
+  {
+#ifdef OD_CONVERTSERVICE_SOCKET
+    if (m_fd >= 0)
+      ::close(m_fd);
+#endif
+  }
+  static OdSmartPtr<ResultChannel> createObject(int fd = -1)
+  {
+    OdSmartPtr<ResultChannel> pChannel = OdRxObjectImpl<ResultChannel>::createObject();
+    pChannel->m_fd = fd;
+    return pChannel;
+  }
+  void writeLine(const OdString& sLine)
+  {
+    OdAnsiString sUtf8(sLine, CP_UTF_8);
+    sUtf8 += '\n';
+    TD_AUTOLOCK(m_mutex);
+#ifdef OD_CONVERTSERVICE_SOCKET
+    if (m_fd >= 0)
+    {
+      const char* pData = sUtf8.c_str();
+      size_t nLeft = (size_t)sUtf8.getLength();
+      while (nLeft)
+      {
+        ssize_t nWritten = ::send(m_fd, pData, nLeft, 0);
+        if (nWritten < 0 && errno == EINTR)
+          continue;
+        if (nWritten <= 0)
+          break; // client gone, result is lost
+        pData += nWritten;
+        nLeft -= (size_t)nWritten;
+      }
+      return;
+    }
+#endif
+    ::fputs(sUtf8.c_str(), stdout);
+    ::fflush(stdout);
+  }
+};
+typedef OdSmartPtr<ResultChannel> ResultChannelPtr;
+
+/************************************************************************/
+/* Service totals                                                       */
+/************************************************************************/
+struct ServiceStats
+{
+  OdMutex  m_mutex;
+  OdUInt32 m_nJobs;
+  OdUInt32 m_nFailed;
+  double   m_totalSec;
+
+  ServiceStats() : m_nJobs(0), m_nFailed(0), m_totalSec(0.) { }
+  void add(bool bSucceeded, double sec)
+  {
+    TD_AUTOLOCK(m_mutex);
+    m_nJobs++;
+    if (!bSucceeded)
+      m_nFailed++;
+    m_totalSec += sec;
+  }
+};
+
+/************************************************************************/
+/* Single conversion                                                    */
+/************************************************************************/
+class ConvertJob : public OdRxObject
+{
+public:
+  OdUInt32         m_nJob;
+  OdString         m_source;
+  OdString         m_target;
+  OdDb::DwgVersion m_outVer;
+  OdDb::SaveType   m_outType;
+  bool             m_bAudit;
+  ResultChannelPtr m_pChannel;
+
+  ConvertJob() : m_nJob(0), m_outVer(OdDb::kDHL_CURRENT), m_outType(OdDb::kDwg), m_bAudit(false) { }
+
+  void run(MyServices& svcs, ServiceStats& stats)
+  {
+    OdPerfTimerWrapper timer;
+    timer.getTimer()->start();
+    const OdUInt64 nPeakBefore = processPeakMemoryKB();
+    OdString sError;
+    try
+    {
+      OdDbDatabasePtr pDb = svcs.readFile(m_source);
+      if (m_bAudit)
+      {
+        SilentAuditInfo ainfo;
+        ainfo.setFixErrors(true);
+        pDb->auditDatabase(&ainfo);
+      }
+      OdString sTmp = temporaryPath(m_target, m_nJob);
+      try
+      {
+        pDb->writeFile(sTmp, m_outType, m_outVer, false /* Generate Bitmap */);
+      }
+      catch (...)
+      {
+        removeFile(sTmp);
+        throw;
+      }
+      pDb.release();
+      if (!replaceFile(sTmp, m_target))
+      {
+        removeFile(sTmp);
+        sError = OD_T("Can't replace target file");
+      }
+    }
+    catch (const OdError& err)
+    {
+      sError = err.description();
+    }
+    catch (...)
+    {
+      sError = OD_T("General exception");
+    }
+    timer.getTimer()->stop();
+    const double sec = timer.getTimer()->countedSec();
+    const OdUInt64 nPeak = processPeakMemoryKB();
+    stats.add(sError.isEmpty(), sec);
+
+    OdString sResult;
+    sResult.format(OD_T("%u\t%ls\t%u\t%u\t%u\t%ls"), (unsigned)m_nJob, sError.isEmpty() ? OD_T("OK") : OD_T("FAILED"),
+                   (unsigned)(sec * 1000. + .5), (unsigned)nPeak, (unsigned)(nPeak - nPeakBefore),
+                   sError.isEmpty() ? m_target.c_str() : sError.c_str());
+    m_pChannel->writeLine(sResult);
+  }
+};
+typedef OdSmartPtr<ConvertJob> ConvertJobPtr;
+
+/************************************************************************/
+/* Worker entry point                                                   */
+/************************************************************************/
+class ConvertAtom : public OdApcAtom
+{
+public:
+  MyServices*   m_pSvcs;
+  ServiceStats* m_pStats;
+
+  void apcEntryPoint(OdRxObject* pMessage)
+  {
+    static_cast<ConvertJob*>(pMessage)->run(*m_pSvcs, *m_pStats);
+  }
+};
+
+/************************************************************************/
+/* Reads job lines until end of input or "quit" command                 */
+/************************************************************************/
+struct ServiceContext
+{
+  MyServices*           m_pSvcs;
+  ServiceStats          m_stats;
+  OdStaticRxObject<ConvertAtom> m_atom;
+  OdApcQueuePtr         m_pQueue; // null if jobs are executed sequentially
+  OdDb::DwgVersion      m_outVer;
+  OdDb::SaveType        m_outType;
+  bool                  m_bAudit;
+  OdUInt32              m_nJobs;
+
+  ServiceContext() : m_pSvcs(0), m_outVer(OdDb::kDHL_CURRENT), m_outType(OdDb::kDwg), m_bAudit(false), m_nJobs(0)
+  {
+    m_atom.m_pStats = &m_stats;
+  }
+};
+
+static bool readLine(FILE* pIn, OdAnsiString& sLine)
+{
+  sLine.empty();
+  char buf[1024];
+  while (::fgets(buf, sizeof(buf), pIn))
+  {
+    sLine += buf;
+    if (sLine.getLength() && sLine.getAt(sLine.getLength() - 1) == '\n')
+      break;
+  }
+  if (sLine.isEmpty())
+    return false;
+  sLine.trimRight("\r\n");
+  return true;
+}
+
+static void splitFields(const OdString& sLine, OdStringArray& fields)
+{
+  int nStart = 0;
+  for (;;)
+  {
+    int nTab = sLine.find(L'\t', nStart);
+    if (nTab < 0)
+    {
+      fields.append(sLine.mid(nStart));
+      break;
+    }
+    fields.append(sLine.mid(nStart, nTab - nStart));
+    nStart = nTab + 1;
+  }
+}
+
+static bool processInput(FILE* pIn, ResultChannel* pChannel, ServiceContext& ctx)
+{
+  OdAnsiString sLineUtf8;
+  while (readLine(pIn, sLineUtf8))
+  {
+    OdString sLine(sLineUtf8.c_str(), CP_UTF_8);
+    sLine.trimLeft();
+    if (sLine.isEmpty() || sLine[0] == L'#')
+      continue;
+    if (!odStrICmp(sLine, OD_T("quit")))
+      return true;
+
+    OdStringArray fields;
+    splitFields(sLine, fields);
+    ConvertJobPtr pJob = OdRxObjectImpl<ConvertJob>::createObject();
+    pJob->m_nJob = ++ctx.m_nJobs;
+    pJob->m_outVer = ctx.m_outVer;
+    pJob->m_outType = ctx.m_outType;
+    pJob->m_bAudit = ctx.m_bAudit;
+    pJob->m_pChannel = pChannel;
+    OdString sError;
+    if (fields.size() < 2 || fields[0].isEmpty() || fields[1].isEmpty())
+      sError = OD_T("Source and target files expected");
+    else
+    {
+      pJob->m_source = fields[0];
+      pJob->m_target = fields[1];
+      if (fields.size() > 2 && !fields[2].isEmpty() && !parseVersion(fields[2], pJob->m_outVer))
+        sError = OD_T("Unknown output version ") + fields[2];
+      if (fields.size() > 3 && !fields[3].isEmpty() && !parseType(fields[3], pJob->m_outType))
+        sError = OD_T("Unknown output type ") + fields[3];
+      if (fields.size() > 4)
+        pJob->m_bAudit = !odStrICmp(fields[4], OD_T("AUDIT"));
+    }
+    if (!sError.isEmpty())
+    {
+      OdString sResult;
+      sResult.format(OD_T("%u\tFAILED\t0\t0\t0\t%ls"), (unsigned)pJob->m_nJob, sError.c_str());
+      pChannel->writeLine(sResult);
+      continue;
+    }
+    if (ctx.m_pQueue.isNull())
+      pJob->run(*ctx.m_pSvcs, ctx.m_stats);
+    else
+      ctx.m_pQueue->addEntryPoint(&ctx.m_atom, pJob.get());
+  }
+  return false;
+}
+
+#ifdef OD_CONVERTSERVICE_SOCKET
+/************************************************************************/
+/* Accepts clients on local socket, one client's input at a time.       */
+/* Results of jobs are sent back to the client which submitted them.    */
+/************************************************************************/
+static int runSocketService(const OdAnsiString& sPath, ServiceContext& ctx)
+{
+  sockaddr_un addr;
+  ::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if ((size_t)sPath.getLength() >= sizeof(addr.sun_path))
+  {
+    STD(cout) << "Socket path is too long\n";
+    return 1;
+  }
+  ::strcpy(addr.sun_path, sPath.c_str());
+
+  // Don't take over socket of other running service process
+  int probeFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (probeFd >= 0)
+  {
+    bool bAlive = ::connect(probeFd, (sockaddr*)&addr, sizeof(addr)) == 0;
+    ::close(probeFd);
+    if (bAlive)
+    {
+      STD(cout) << "Other service is already listening on " << sPath.c_str() << "\n";
+      return 1;
+    }
+  }
+  ::unlink(sPath.c_str());
+
+  int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd < 0 || ::bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listenFd, 16) != 0)
+  {
+    STD(cout) << "Can't listen on " << sPath.c_str() << "\n";
+    if (listenFd >= 0)
+      ::close(listenFd);
+    return 1;
+  }
+  ::signal(SIGPIPE, SIG_IGN); // disconnected clients are detected by send()
+
+  bool bQuit = false;
+  while (!bQuit)
+  {
+    int clientFd = ::accept(listenFd, NULL, NULL);
+    if (clientFd < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    FILE* pIn = ::fdopen(::dup(clientFd), "r");
+    ResultChannelPtr pChannel = ResultChannel::createObject(clientFd); // closed by the last job
+    if (pIn)
+    {
+      bQuit = processInput(pIn, pChannel, ctx);
+      ::fclose(pIn);
+    }
+  }
+  ::close(listenFd);
+  ::unlink(sPath.c_str());
+  return 0;
+}
+#endif
+
+/************************************************************************/
+/* Main                                                                 */
+/************************************************************************/
+#if defined(OD_USE_WMAIN)
+int wmain(int argc, wchar_t* argv[])
+#else
+int main(int argc, char* argv[])
+#endif
+{
+#ifdef OD_HAVE_CCOMMAND_FUNC
+  argc = ccommand(&argv);
+#endif
+
+#ifndef _TOOLKIT_IN_DLL_
+  ODRX_INIT_STATIC_MODULE_MAP();
+#endif
+
+  /**********************************************************************/
+  /* Parse arguments                                                    */
+  /**********************************************************************/
+  ServiceContext ctx;
+  int nWorkers = 0;
+  OdString sSocket;
+  for (int i = 1; i < argc; i++)
+  {
+    OdString sArg(argv[i]);
+    bool bHasValue = (i + 1) < argc;
+    if (!odStrICmp(sArg, OD_T("-j")) && bHasValue)
+      nWorkers = ::atoi(OdAnsiString(OdString(argv[++i])).c_str());
+    else if (!odStrICmp(sArg, OD_T("-socket")) && bHasValue)
+      sSocket = argv[++i];
+    else if (!odStrICmp(sArg, OD_T("-ver")) && bHasValue && parseVersion(OdString(argv[i + 1]), ctx.m_outVer))
+      i++;
+    else if (!odStrICmp(sArg, OD_T("-type")) && bHasValue && parseType(OdString(argv[i + 1]), ctx.m_outType))
+      i++;
+    else if (!odStrICmp(sArg, OD_T("-audit")))
+      ctx.m_bAudit = true;
+    else
+    {
+      STD(cout) << cUsage;
+      return 1;
+    }
+  }
+#ifndef OD_CONVERTSERVICE_SOCKET
+  if (!sSocket.isEmpty())
+  {
+    STD(cout) << "Local socket input is not supported on this platform\n";
+    return 1;
+  }
+#endif
+
+  /**********************************************************************/
+  /* Set customized assert function                                     */
+  /**********************************************************************/
+  odSetAssertFunc(MyAssert);
+
+  /**********************************************************************/
+  /* Initialize Drawings once for all jobs                              */
+  /**********************************************************************/
+  OdStaticRxObject<MyServices> svcs;
+  odInitialize(&svcs);
+  svcs.disableOutput(true);
+  ctx.m_pSvcs = &svcs;
+  ctx.m_atom.m_pSvcs = &svcs;
+
+  int nRes = 0;
+  try
+  {
+    // Modules which are loaded on demand during reading are loaded here,
+    // so worker threads don't compete in module loading.
+    ::odrxDynamicLinker()->loadModule(OdRecomputeDimBlockModuleName, true);
+    ::odrxDynamicLinker()->loadModule(OdModelerGeometryModuleName, true);
+
+    OdRxThreadPoolServicePtr pThreadPool = ::odrxDynamicLinker()->loadApp(OdThreadPoolModuleName, true);
+    if (!pThreadPool.isNull())
+    {
+      if (nWorkers <= 0)
+        nWorkers = pThreadPool->numCPUs();
+      if (nWorkers > 1)
+        ctx.m_pQueue = pThreadPool->newMTQueue(ThreadsCounter::kMtLoadingAttributes, nWorkers, kMtQueueForceNewThreads);
+    }
+    OdString sReady;
+    sReady.format(OD_T("# ready, %d worker(s)"), ctx.m_pQueue.isNull() ? 1 : nWorkers);
+
+#ifdef OD_CONVERTSERVICE_SOCKET
+    if (!sSocket.isEmpty())
+    {
+      ResultChannel::createObject()->writeLine(sReady);
+      nRes = runSocketService(OdAnsiString(sSocket, CP_UTF_8), ctx);
+    }
+    else
+#endif
+    {
+      ResultChannelPtr pStdout = ResultChannel::createObject();
+      pStdout->writeLine(sReady);
+      processInput(stdin, pStdout, ctx);
+    }
+    if (!ctx.m_pQueue.isNull())
+      ctx.m_pQueue->wait();
+    ctx.m_pQueue.release();
+  }
+  catch (OdError& err)
+  {
+    odPrintConsoleString(L"\nOdError thrown: %ls\n", err.description().c_str());
+    nRes = -1;
+  }
+  catch (...)
+  {
+    STD(cout) << "\nGeneral exception thrown, exiting\n";
+    nRes = -1;
+  }
+
+  OdString sSummary;
+  sSummary.format(OD_T("# %u job(s), %u failed, %.3f s in conversions, peak memory %u KB"),
+                  (unsigned)ctx.m_stats.m_nJobs, (unsigned)ctx.m_stats.m_nFailed, ctx.m_stats.m_totalSec,
+                  (unsigned)processPeakMemoryKB());
+  ResultChannel::createObject()->writeLine(sSummary);
+
+  /**********************************************************************/
+  /* Uninitialize Drawings.                                             */
+  /**********************************************************************/
+  odUninitialize();
+  return nRes;
+}
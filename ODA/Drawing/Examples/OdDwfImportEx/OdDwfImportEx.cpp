@@ -28,7 +28,7 @@
 /*                                                                      */
 /* Calling sequence:                                                    */
 /*                                                                      */
-/*    OdDwfImportEx <source file> <target file>                         */
+/*    OdDwfImportEx <source file> <target file> [-parallel]             */
 /*                                                                      */
 /************************************************************************/
 
@@ -44,6 +44,7 @@
 #include "RxModule.h"
 #include "RxDynamicModule.h"
 #include "RxVariantValue.h"
+#include "RxThreadPoolService.h"
 #include "../../Imports/DwfImport/Include/DwfImport.h"
 #include <locale.h>
 #include "diagnostics.h"
@@ -90,7 +91,8 @@ int main(int argc, char* argv[])
   
   if (argc < 3) 
   {
-    odPrintConsoleString(L"usage: OdDwfImportEx <source file> <target file>\n");
+    odPrintConsoleString(L"usage: OdDwfImportEx <source file> <target file> [-parallel]\n");
+    odPrintConsoleString(L"   -parallel - prefetch and decode sheets using thread pool\n");
   }
   else
   {
@@ -158,6 +160,14 @@ int main(int argc, char* argv[])
         /**************************************************************/
         importer->properties()->putAt( L"ImportW3d", OdRxVariantValue(true) );
         /**************************************************************/
+        /* Optionally stage sheets of multi-sheet package in parallel */
+        /**************************************************************/
+        if (argc > 3 && OdString(argv[3]) == L"-parallel")
+        {
+          ::odrxDynamicLinker()->loadModule(OdThreadPoolModuleName);
+          importer->properties()->putAt( L"ParallelSections", OdRxVariantValue(true) );
+        }
+        /**************************************************************/
         /* Import DWF file                                            */
         /**************************************************************/
         importer->import();
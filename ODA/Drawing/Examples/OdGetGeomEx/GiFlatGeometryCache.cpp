@@ -0,0 +1,518 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OdaCommon.h"
+#include "GiFlatGeometryCache.h"
+#include "DbDatabase.h"
+#include "DbEntity.h"
+#include "DbBlockReference.h"
+#include "DbSymbolTable.h"
+#include "DbSymbolTableRecord.h"
+#include "DbFiler.h"
+#include "RxSystemServices.h"
+#include "StaticRxObject.h"
+#include "FlatMemStream.h"
+#include "Gi/OdFNVHash.h"
+#include "Ge/GePoint2d.h"
+#include "Ge/GeVector2d.h"
+#include "Ge/GeScale3d.h"
+
+namespace
+{
+  /**********************************************************************/
+  /* Filer which computes hash of all written DWG fields. Objects owned */
+  /* by hard ownership (vertices, attributes, extension dictionaries)   */
+  /* are hashed with their owner                                        */
+  /**********************************************************************/
+  class StampFiler : public OdIdFiler
+  {
+    OdDbDatabase*     m_pDb;
+    OdUInt64          m_hash;
+    OdDbObjectIdArray m_owned;
+
+    void hash(const void* pData, size_t nSize) { m_hash = odFNV64HashBuf(pData, nSize, m_hash); }
+    template <class T> void hashVal(const T& val) { hash(&val, sizeof(T)); }
+    void hashId(const OdDbObjectId& id) { hashVal((OdUInt64)id.getHandle()); }
+
+    void hashObject(const OdDbObject* pObj)
+    {
+      const OdString className = pObj->isA()->name();
+      hash(className.c_str(), className.getLength() * sizeof(OdChar));
+      pObj->dwgOutFields(this);
+    }
+  public:
+    StampFiler() : m_pDb(NULL), m_hash(0xcbf29ce484222325ULL) { }
+
+    OdUInt64 objectStamp(const OdDbObject* pObj)
+    {
+      m_pDb = pObj->database();
+      m_hash = 0xcbf29ce484222325ULL;
+      m_owned.clear();
+      hashObject(pObj);
+      // Owned objects are appended while they are hashed
+      for (OdUInt32 n = 0; n < m_owned.size(); ++n)
+      {
+        OdDbObjectPtr pOwned = m_owned[n].openObject();
+        if (!pOwned.isNull())
+          hashObject(pOwned);
+      }
+      return m_hash;
+    }
+
+    FilerType filerType() const { return OdDbFiler::kFileFiler; }
+    OdDbDatabase* database() const { return m_pDb; }
+
+    void wrBool(bool value) { hashVal(value); }
+    void wrString(const OdString& value) { hashVal(value.getLength()); hash(value.c_str(), value.getLength() * sizeof(OdChar)); }
+    void wrBytes(const void* buffer, OdUInt32 numBytes) { hashVal(numBytes); hash(buffer, numBytes); }
+    void wrInt8(OdInt8 value) { hashVal(value); }
+    void wrUInt8(OdUInt8 value) { hashVal(value); }
+    void wrInt16(OdInt16 value) { hashVal(value); }
+    void wrInt32(OdInt32 value) { hashVal(value); }
+    void wrInt64(OdInt64 value) { hashVal(value); }
+    void wrAddress(const void* /*value*/) { } // Session specific
+    void wrDouble(double value) { hashVal(value); }
+    void wrDbHandle(const OdDbHandle& value) { hashVal((OdUInt64)value); }
+    void wrSoftOwnershipId(const OdDbObjectId& value) { hashId(value); }
+    void wrHardOwnershipId(const OdDbObjectId& value)
+    {
+      hashId(value);
+      if (!value.isNull())
+        m_owned.push_back(value);
+    }
+    void wrSoftPointerId(const OdDbObjectId& value) { hashId(value); }
+    void wrHardPointerId(const OdDbObjectId& value) { hashId(value); }
+    void wrPoint2d(const OdGePoint2d& value) { hashVal(value); }
+    void wrPoint3d(const OdGePoint3d& value) { hashVal(value); }
+    void wrVector2d(const OdGeVector2d& value) { hashVal(value); }
+    void wrVector3d(const OdGeVector3d& value) { hashVal(value); }
+    void wrScale3d(const OdGeScale3d& value) { hashVal(value); }
+  };
+
+  inline OdUInt64 combineStamps(OdUInt64 nStamp1, OdUInt64 nStamp2)
+  {
+    return odFNV64HashBuf(&nStamp2, sizeof(OdUInt64), nStamp1);
+  }
+
+  inline OdUInt64 stubHandle(OdDbStub* id)
+  {
+    return id ? (OdUInt64)OdDbObjectId(id).getHandle() : 0;
+  }
+
+  inline OdDbStub* handleStub(OdDbDatabase* pDb, OdUInt64 nHandle)
+  {
+    return nHandle ? (OdDbStub*)pDb->getOdDbObjectId(OdDbHandle(nHandle)) : NULL;
+  }
+
+  /**********************************************************************/
+  /* Geometry of single entity in metafile section                      */
+  /**********************************************************************/
+  void wrGeometry(OdGsFiler& filer, const OdGiFlatGeometry& geom)
+  {
+    OdGsFiler_wrArrayRaw(filer, geom.m_vertices, sizeof(OdGePoint3d));
+    OdGsFiler_wrArrayRaw(filer, geom.m_indices, sizeof(OdInt32));
+    OdGsFiler_wrArrayRaw(filer, geom.m_text, sizeof(OdChar));
+    OdGsFiler_wrArrayRaw(filer, geom.m_primitives, sizeof(OdGiFlatGeometry::Primitive));
+    filer.wrUInt32(geom.m_traits.size());
+    for (OdUInt32 i = 0; i < geom.m_traits.size(); ++i)
+    {
+      const OdGiFlatGeometry::Traits& traits = geom.m_traits[i];
+      filer.wrUInt32(traits.m_color.color());
+      filer.wrUInt32(traits.m_transparency.serializeOut());
+      filer.wrUInt64(stubHandle(traits.m_layer));
+      filer.wrUInt64(stubHandle(traits.m_lineType));
+      filer.wrInt32(traits.m_lineWeight);
+    }
+    OdGsFiler_wrArray(filer, geom.m_transforms, wrMatrix3d);
+    filer.wrUInt32(geom.m_entities.size());
+    for (OdUInt32 i = 0; i < geom.m_entities.size(); ++i)
+    {
+      filer.wrUInt64(stubHandle(geom.m_entities[i].m_id));
+      filer.wrUInt32(geom.m_entities[i].m_firstPrimitive);
+      filer.wrUInt32(geom.m_entities[i].m_nPrimitives);
+    }
+  }
+
+  void rdGeometry(OdGsFiler& filer, OdDbDatabase* pDb, OdGiFlatGeometry& geom)
+  {
+    OdGsFiler_rdArrayRaw(filer, geom.m_vertices, sizeof(OdGePoint3d));
+    OdGsFiler_rdArrayRaw(filer, geom.m_indices, sizeof(OdInt32));
+    OdGsFiler_rdArrayRaw(filer, geom.m_text, sizeof(OdChar));
+    OdGsFiler_rdArrayRaw(filer, geom.m_primitives, sizeof(OdGiFlatGeometry::Primitive));
+    geom.m_traits.resize(filer.rdUInt32());
+    for (OdUInt32 i = 0; i < geom.m_traits.size(); ++i)
+    {
+      OdGiFlatGeometry::Traits& traits = geom.m_traits[i];
+      traits.m_color.setColor(filer.rdUInt32());
+      traits.m_transparency.serializeIn(filer.rdUInt32());
+      traits.m_layer = handleStub(pDb, filer.rdUInt64());
+      traits.m_lineType = handleStub(pDb, filer.rdUInt64());
+      traits.m_lineWeight = (OdDb::LineWeight)filer.rdInt32();
+    }
+    OdGsFiler_rdArrayArg(filer, geom.m_transforms, rdMatrix3d);
+    geom.m_entities.resize(filer.rdUInt32());
+    for (OdUInt32 i = 0; i < geom.m_entities.size(); ++i)
+    {
+      geom.m_entities[i].m_id = handleStub(pDb, filer.rdUInt64());
+      geom.m_entities[i].m_firstPrimitive = filer.rdUInt32();
+      geom.m_entities[i].m_nPrimitives = filer.rdUInt32();
+    }
+  }
+}
+
+OdGiFlatGeometryCache::OdGiFlatGeometryCache()
+  : m_pDb(NULL)
+  , m_deviation(0.0)
+  , m_dbStamp(0)
+{
+}
+
+OdGiFlatGeometryCache::~OdGiFlatGeometryCache()
+{
+  closeFile();
+}
+
+void OdGiFlatGeometryCache::closeFile()
+{
+  m_readers.clear();
+  OdFileMapping::unmap(m_file);
+}
+
+bool OdGiFlatGeometryCache::createReader(Reader& reader) const
+{
+  if (m_file.isNull())
+    return false;
+  try
+  {
+    reader.m_pStream = OdFlatMemStream::createNew(const_cast<OdUInt8*>(m_file.data()), m_file.size());
+    reader.m_pFiler = OdGsFiler::createObject(reader.m_pStream, false, m_pDb);
+  }
+  catch (const OdError&)
+  {
+    reader.m_pFiler.release();
+    reader.m_pStream.release();
+    return false;
+  }
+  return true;
+}
+
+bool OdGiFlatGeometryCache::acquireReader(Reader& reader)
+{
+  {
+    TD_AUTOLOCK(m_mutex);
+    if (!m_readers.empty())
+    {
+      reader = m_readers.back();
+      m_readers.pop_back();
+      return true;
+    }
+  }
+  return createReader(reader);
+}
+
+void OdGiFlatGeometryCache::releaseReader(Reader& reader)
+{
+  if (reader.m_pFiler.isNull())
+    return;
+  TD_AUTOLOCK(m_mutex);
+  m_readers.push_back(reader);
+}
+
+OdUInt64 OdGiFlatGeometryCache::databaseStamp() const
+{
+  OdStaticRxObject<StampFiler> filer;
+  const OdString guid = m_pDb->getFINGERPRINTGUID();
+  OdUInt64 nStamp = odFNV64HashBuf(guid.c_str(), guid.getLength() * sizeof(OdChar));
+  nStamp = odFNV64HashBuf(&m_deviation, sizeof(double), nStamp);
+
+  /**********************************************************************/
+  /* System variables which affect vectorization of entities            */
+  /**********************************************************************/
+  const double dVars[] = { m_pDb->getLTSCALE(), m_pDb->getPDSIZE(), m_pDb->getFACETRES() };
+  const OdInt32 nVars[] = { m_pDb->getPDMODE(), m_pDb->getISOLINES(), m_pDb->getFILLMODE(), m_pDb->getQTEXTMODE(),
+                            m_pDb->getMIRRTEXT(), m_pDb->getDISPSILH(), m_pDb->getPSLTSCALE() };
+  nStamp = odFNV64HashBuf(dVars, sizeof(dVars), nStamp);
+  nStamp = odFNV64HashBuf(nVars, sizeof(nVars), nStamp);
+
+  /**********************************************************************/
+  /* Symbol table records referenced by entities                        */
+  /**********************************************************************/
+  const OdDbObjectId tableIds[] = { m_pDb->getLayerTableId(), m_pDb->getLinetypeTableId(),
+                                    m_pDb->getTextStyleTableId(), m_pDb->getDimStyleTableId() };
+  for (size_t nTable = 0; nTable < sizeof(tableIds) / sizeof(OdDbObjectId); ++nTable)
+  {
+    OdDbSymbolTablePtr pTable = tableIds[nTable].openObject();
+    if (pTable.isNull())
+      continue;
+    for (OdDbSymbolTableIteratorPtr pIter = pTable->newIterator(); !pIter->done(); pIter->step())
+      nStamp = combineStamps(nStamp, filer.objectStamp(pIter->getRecord()));
+  }
+  return nStamp;
+}
+
+OdUInt64 OdGiFlatGeometryCache::blockStamp(OdDbStub* blockId, int nDepth)
+{
+  std::map<OdDbStub*, OdUInt64>::iterator pIt = m_blockStamps.find(blockId);
+  if (pIt != m_blockStamps.end())
+    return pIt->second;
+  // Stamp is registered before traversal, so self-referencing blocks are finite
+  pIt = m_blockStamps.insert(std::make_pair(blockId, OdUInt64(0))).first;
+  OdStaticRxObject<StampFiler> filer;
+  OdUInt64 nStamp = 0;
+  OdDbBlockTableRecordPtr pBlock = OdDbBlockTableRecord::cast(OdDbObjectId(blockId).openObject());
+  if (!pBlock.isNull())
+  {
+    nStamp = filer.objectStamp(pBlock);
+    for (OdDbObjectIteratorPtr pIter = pBlock->newIterator(); !pIter->done(); pIter->step())
+    {
+      OdDbEntityPtr pEntity = pIter->entity();
+      nStamp = combineStamps(nStamp, filer.objectStamp(pEntity));
+      OdDbBlockReference* pRef = OdDbBlockReference::cast(pEntity).get();
+      if (pRef && nDepth < kMaxBlockDepth)
+        nStamp = combineStamps(nStamp, blockStamp(pRef->blockTableRecord(), nDepth + 1));
+    }
+  }
+  pIt->second = nStamp;
+  return nStamp;
+}
+
+OdUInt64 OdGiFlatGeometryCache::entityStamp(const OdDbEntity* pEntity)
+{
+  OdStaticRxObject<StampFiler> filer;
+  OdUInt64 nStamp = filer.objectStamp(pEntity);
+  const OdDbBlockReference* pRef = OdDbBlockReference::cast(pEntity).get();
+  if (pRef)
+  {
+    TD_AUTOLOCK(m_blockMutex);
+    nStamp = combineStamps(nStamp, blockStamp(pRef->blockTableRecord(), 0));
+  }
+  return nStamp;
+}
+
+void OdGiFlatGeometryCache::clearBlockStamps()
+{
+  TD_AUTOLOCK(m_blockMutex);
+  m_blockStamps.clear();
+}
+
+bool OdGiFlatGeometryCache::open(const OdString& fileName, OdDbDatabase* pDb, double deviation)
+{
+  closeFile();
+  m_entries.clear();
+  m_blockStamps.clear();
+  m_stats = Stats();
+  m_pDb = pDb;
+  m_deviation = deviation;
+  m_dbStamp = databaseStamp();
+
+  Reader reader;
+  if (!OdFileMapping::mapFile(fileName, m_file) || !createReader(reader))
+  {
+    closeFile();
+    return false;
+  }
+  try
+  {
+    OdGsFiler* pFiler = reader.m_pFiler;
+    /********************************************************************/
+    /* Index is the last section, metafile sections are skipped         */
+    /********************************************************************/
+    for (;;)
+    {
+      const OdGsFiler::Section section = pFiler->rdSection();
+      if (section == OdGsFiler::kEOFSection)
+        break;
+      if (section != OdGsFiler::kClientModelSection)
+      {
+        pFiler->skipSection();
+        continue;
+      }
+      if (pFiler->rdUInt32() != kFormatVersion || pFiler->rdUInt64() != m_dbStamp ||
+          pFiler->rdUInt32() != sizeof(OdChar) || pFiler->rdUInt32() != sizeof(OdGiFlatGeometry::Primitive))
+        break;
+      const OdUInt32 nEntries = pFiler->rdUInt32();
+      for (OdUInt32 i = 0; i < nEntries; ++i)
+      {
+        const OdUInt64 nHandle = pFiler->rdUInt64();
+        Entry& entry = m_entries[nHandle];
+        entry.m_stamp = pFiler->rdUInt64();
+        entry.m_offset = pFiler->rdUInt64();
+      }
+      if (!pFiler->checkEOF())
+      {
+        m_entries.clear();
+        break;
+      }
+      m_stats.m_nLoaded = nEntries;
+      m_readers.push_back(reader);
+      return true;
+    }
+  }
+  catch (const OdError&)
+  {
+    m_entries.clear();
+  }
+  reader = Reader();
+  closeFile();
+  return false;
+}
+
+bool OdGiFlatGeometryCache::readGeometry(Reader& reader, OdUInt64 nHandle, OdUInt64 stamp, OdUInt64 offset, OdGiFlatGeometry& geometry) const
+{
+  if (!offset || reader.m_pFiler.isNull())
+    return false;
+  try
+  {
+    OdGsFiler* pFiler = reader.m_pFiler;
+    reader.m_pStream->seek(offset, OdDb::kSeekFromStart);
+    if (pFiler->rdSection() != OdGsFiler::kClientMetafileSection ||
+        pFiler->rdUInt64() != nHandle || pFiler->rdUInt64() != stamp)
+      return false;
+    rdGeometry(*pFiler, m_pDb, geometry);
+    return pFiler->checkEOF();
+  }
+  catch (const OdError&)
+  {
+    // Filer state is undefined, reader isn't reused
+    reader = Reader();
+  }
+  return false;
+}
+
+bool OdGiFlatGeometryCache::lookup(OdDbStub* id, OdUInt64 stamp, OdGiFlatGeometry& geometry)
+{
+  const OdUInt64 nHandle = stubHandle(id);
+  OdUInt64 offset = 0;
+  {
+    TD_AUTOLOCK(m_mutex);
+    EntryMap::iterator pIt = m_entries.find(nHandle);
+    if (pIt == m_entries.end() || pIt->second.m_stamp != stamp)
+    {
+      m_stats.m_nMisses++;
+      return false;
+    }
+    if (pIt->second.m_bInMemory)
+    {
+      pIt->second.m_bUsed = true;
+      geometry = pIt->second.m_geometry;
+      m_stats.m_nHits++;
+      return true;
+    }
+    offset = pIt->second.m_offset;
+  }
+  /**********************************************************************/
+  /* Metafile section is decoded from the mapped file without lock      */
+  /**********************************************************************/
+  geometry.clear();
+  Reader reader;
+  bool bRead = false;
+  if (acquireReader(reader))
+  {
+    bRead = readGeometry(reader, nHandle, stamp, offset, geometry);
+    releaseReader(reader);
+  }
+  TD_AUTOLOCK(m_mutex);
+  if (!bRead)
+  {
+    m_stats.m_nMisses++;
+    return false;
+  }
+  EntryMap::iterator pIt = m_entries.find(nHandle);
+  if (pIt != m_entries.end() && pIt->second.m_stamp == stamp)
+    pIt->second.m_bUsed = true;
+  m_stats.m_nHits++;
+  return true;
+}
+
+void OdGiFlatGeometryCache::store(OdDbStub* id, OdUInt64 stamp, const OdGiFlatGeometry& geometry)
+{
+  const OdUInt64 nHandle = stubHandle(id);
+  TD_AUTOLOCK(m_mutex);
+  Entry& entry = m_entries[nHandle];
+  entry.m_stamp = stamp;
+  entry.m_offset = 0;
+  entry.m_bInMemory = true;
+  entry.m_bUsed = true;
+  entry.m_geometry = geometry;
+  m_stats.m_nStored++;
+}
+
+bool OdGiFlatGeometryCache::save(const OdString& fileName)
+{
+  if (!m_pDb)
+    return false;
+  TD_AUTOLOCK(m_mutex);
+  /**********************************************************************/
+  /* Unchanged entries are read before cache file is overwritten        */
+  /**********************************************************************/
+  Reader reader;
+  EntryMap::iterator pIt = m_entries.begin();
+  while (pIt != m_entries.end())
+  {
+    Entry& entry = pIt->second;
+    if (entry.m_bUsed && !entry.m_bInMemory && (!reader.m_pFiler.isNull() || createReader(reader)))
+      entry.m_bInMemory = readGeometry(reader, pIt->first, entry.m_stamp, entry.m_offset, entry.m_geometry);
+    if (!entry.m_bUsed || !entry.m_bInMemory)
+      m_entries.erase(pIt++);
+    else
+      ++pIt;
+  }
+  reader = Reader();
+  closeFile();
+  try
+  {
+    OdStreamBufPtr pStream = ::odrxSystemServices()->createFile(fileName, Oda::kFileWrite, Oda::kShareDenyWrite, Oda::kCreateAlways);
+    OdGsFilerPtr pFiler = OdGsFiler::createObject(pStream, true, m_pDb);
+    for (pIt = m_entries.begin(); pIt != m_entries.end(); ++pIt)
+    {
+      pIt->second.m_offset = pStream->tell();
+      pFiler->wrSectionBegin(OdGsFiler::kClientMetafileSection);
+      pFiler->wrUInt64(pIt->first);
+      pFiler->wrUInt64(pIt->second.m_stamp);
+      wrGeometry(*pFiler, pIt->second.m_geometry);
+      pFiler->wrSectionEnd(OdGsFiler::kClientMetafileSection);
+    }
+    pFiler->wrSectionBegin(OdGsFiler::kClientModelSection);
+    pFiler->wrUInt32(kFormatVersion);
+    pFiler->wrUInt64(m_dbStamp);
+    pFiler->wrUInt32(sizeof(OdChar));
+    pFiler->wrUInt32(sizeof(OdGiFlatGeometry::Primitive));
+    pFiler->wrUInt32((OdUInt32)m_entries.size());
+    for (pIt = m_entries.begin(); pIt != m_entries.end(); ++pIt)
+    {
+      pFiler->wrUInt64(pIt->first);
+      pFiler->wrUInt64(pIt->second.m_stamp);
+      pFiler->wrUInt64(pIt->second.m_offset);
+    }
+    pFiler->wrSectionEnd(OdGsFiler::kClientModelSection);
+    pFiler->wrEOFSection();
+  }
+  catch (const OdError&)
+  {
+    return false;
+  }
+  // Written geometry stays in memory, so entries don't refer to the file
+  for (pIt = m_entries.begin(); pIt != m_entries.end(); ++pIt)
+    pIt->second.m_offset = 0;
+  return true;
+}
@@ -0,0 +1,157 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __OD_GI_FLAT_GEOMETRY_CACHE__
+#define __OD_GI_FLAT_GEOMETRY_CACHE__
+
+#include "GiFlatGeometryExtractor.h"
+#include "Gs/GsFiler.h"
+#include "OdMutex.h"
+#include "OdFileMapping.h"
+
+#define STL_USING_VECTOR
+#include "OdaSTL.h"
+
+class OdDbDatabase;
+
+/************************************************************************/
+/* Persistent cache of extracted geometry. Geometry of every entity is  */
+/* stored in own metafile section of a GS filer stream and is keyed by  */
+/* entity handle plus stamp of entity content. Stamp is a hash of DWG   */
+/* fields of the entity and its owned subobjects, block references      */
+/* include stamps of referenced block definitions.                      */
+/*                                                                      */
+/* The cache serves OdGiFlatGeometryExtractor only. It doesn't persist  */
+/* OdGsBaseModel nodes: device state including model caches is saved   */
+/* and restored by OdGsDevice::saveDeviceState()/loadDeviceState()      */
+/* as a whole, Gs doesn't support per-entity reload of the state.       */
+/*                                                                      */
+/* On open the cache file is memory mapped and only the index section  */
+/* is read, metafile sections are decoded on lookup. Whole cache is     */
+/* dropped if database, tessellation deviation, symbol table records or */
+/* system variables which affect vectorization are changed.             */
+/*                                                                      */
+/* lookup(), store() and entityStamp() may be called from several      */
+/* threads concurrently. Sections are decoded from the mapped file by   */
+/* per-call readers outside of the lock, so lookups don't serialize on  */
+/* file access. open() and save() must not run concurrently with them.  */
+/************************************************************************/
+class OdGiFlatGeometryCache
+{
+public:
+  enum
+  {
+    kFormatVersion = 1,
+    kMaxBlockDepth = 16 // Nesting of block references which is taken into account by stamps
+  };
+  struct Stats
+  {
+    OdUInt32 m_nLoaded;  // Entries read from cache file on open
+    OdUInt32 m_nHits;    // Lookups which returned cached geometry
+    OdUInt32 m_nMisses;  // Lookups of missing or changed entities
+    OdUInt32 m_nStored;  // Entries stored after vectorization
+
+    Stats() : m_nLoaded(0), m_nHits(0), m_nMisses(0), m_nStored(0) { }
+  };
+protected:
+  struct Entry
+  {
+    OdUInt64         m_stamp;
+    OdUInt64         m_offset;     // Position of metafile section in cache file, 0 if not in file
+    bool             m_bInMemory;  // m_geometry is valid (entry is stored after open)
+    bool             m_bUsed;      // Entry is looked up or stored, unused entries aren't saved
+    OdGiFlatGeometry m_geometry;
+
+    Entry() : m_stamp(0), m_offset(0), m_bInMemory(false), m_bUsed(false) { }
+  };
+  typedef std::map<OdUInt64, Entry> EntryMap;
+  /**********************************************************************/
+  /* Filer over memory stream of the mapped cache file. Every lookup    */
+  /* takes own reader, readers are reused                               */
+  /**********************************************************************/
+  struct Reader
+  {
+    OdStreamBufPtr m_pStream;
+    OdGsFilerPtr   m_pFiler;
+  };
+
+  OdDbDatabase*                  m_pDb;
+  double                         m_deviation;
+  OdUInt64                       m_dbStamp;
+  EntryMap                       m_entries;
+  OdFileMapping::View            m_file;
+  std::vector<Reader>            m_readers;
+  std::map<OdDbStub*, OdUInt64>  m_blockStamps;
+  OdMutex                        m_mutex;
+  OdMutex                        m_blockMutex;
+  Stats                          m_stats;
+
+  OdUInt64 databaseStamp() const;
+  OdUInt64 blockStamp(OdDbStub* blockId, int nDepth);
+  bool createReader(Reader& reader) const;
+  bool acquireReader(Reader& reader);
+  void releaseReader(Reader& reader);
+  bool readGeometry(Reader& reader, OdUInt64 nHandle, OdUInt64 stamp, OdUInt64 offset, OdGiFlatGeometry& geometry) const;
+  void closeFile();
+public:
+  OdGiFlatGeometryCache();
+  ~OdGiFlatGeometryCache();
+
+  /**********************************************************************/
+  /* Opens cache file for the database. Returns false if file is        */
+  /* missing or outdated, cache is empty in this case                   */
+  /**********************************************************************/
+  bool open(const OdString& fileName, OdDbDatabase* pDb, double deviation);
+
+  /**********************************************************************/
+  /* Writes all entries used since open() into cache file, entries of   */
+  /* erased entities are dropped                                        */
+  /**********************************************************************/
+  bool save(const OdString& fileName);
+
+  /**********************************************************************/
+  /* Returns stamp of entity content                                    */
+  /**********************************************************************/
+  OdUInt64 entityStamp(const OdDbEntity* pEntity);
+
+  /**********************************************************************/
+  /* Forgets stamps of block definitions, should be called when blocks  */
+  /* could be modified since previous call of entityStamp()             */
+  /**********************************************************************/
+  void clearBlockStamps();
+
+  /**********************************************************************/
+  /* Returns geometry of single entity if it is cached with equal stamp */
+  /**********************************************************************/
+  bool lookup(OdDbStub* id, OdUInt64 stamp, OdGiFlatGeometry& geometry);
+
+  /**********************************************************************/
+  /* Stores geometry of single entity                                   */
+  /**********************************************************************/
+  void store(OdDbStub* id, OdUInt64 stamp, const OdGiFlatGeometry& geometry);
+
+  double deviation() const { return m_deviation; }
+  const Stats& stats() const { return m_stats; }
+};
+
+#endif // __OD_GI_FLAT_GEOMETRY_CACHE__
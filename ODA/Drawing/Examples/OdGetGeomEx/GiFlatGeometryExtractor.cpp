@@ -0,0 +1,702 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OdaCommon.h"
+#include "GiFlatGeometryExtractor.h"
+#include "GiFlatGeometryCache.h"
+#include "GiContextForDbDatabase.h"
+#include "DbDatabase.h"
+#include "DbEntity.h"
+#include "DbSymbolTable.h"
+#include "DbBlockReference.h"
+#include "Db3dSolid.h"
+#include "DbRegion.h"
+#include "DbBody.h"
+#include "DbSurface.h"
+#include "DbSubDMesh.h"
+#include "DbPolyFaceMesh.h"
+#include "DbPolygonMesh.h"
+#include "DbProxyEntity.h"
+#include "DbText.h"
+#include "DbMText.h"
+#include "DbDimension.h"
+#include "DbHatch.h"
+#include "DbMLeader.h"
+#include "RxThreadPoolService.h"
+#include "DynamicLinker.h"
+#include "StaticRxObject.h"
+#include "OdPerfTimer.h"
+
+static const OdUInt32 kInvalidIndex = 0xFFFFFFFF;
+
+/************************************************************************/
+/* OdGiFlatGeometry                                                     */
+/************************************************************************/
+OdGiFlatGeometry::OdGiFlatGeometry()
+{
+  m_vertices.setGrowLength(-100);
+  m_indices.setGrowLength(-100);
+  m_text.setGrowLength(-100);
+  m_primitives.setGrowLength(-100);
+  m_entities.setGrowLength(-100);
+}
+
+void OdGiFlatGeometry::clear()
+{
+  m_vertices.clear();
+  m_indices.clear();
+  m_text.clear();
+  m_primitives.clear();
+  m_traits.clear();
+  m_transforms.clear();
+  m_entities.clear();
+}
+
+void OdGiFlatGeometry::append(const OdGiFlatGeometry& other)
+{
+  const OdUInt32 nVertices = m_vertices.size(), nIndices = m_indices.size(), nText = m_text.size();
+  const OdUInt32 nPrimitives = m_primitives.size(), nTransforms = m_transforms.size(), nEntities = m_entities.size();
+
+  /**********************************************************************/
+  /* Equal traits are shared by both buffers                            */
+  /**********************************************************************/
+  std::map<Traits, OdUInt32> traitsMap;
+  for (OdUInt32 i = 0; i < m_traits.size(); ++i)
+    traitsMap.insert(std::make_pair(m_traits[i], i));
+  OdUInt32Array traitsRemap;
+  traitsRemap.resize(other.m_traits.size());
+  for (OdUInt32 i = 0; i < other.m_traits.size(); ++i)
+  {
+    std::pair<std::map<Traits, OdUInt32>::iterator, bool> res = traitsMap.insert(std::make_pair(other.m_traits[i], m_traits.size()));
+    if (res.second)
+      m_traits.push_back(other.m_traits[i]);
+    traitsRemap[i] = res.first->second;
+  }
+
+  m_vertices.insert(m_vertices.end(), other.m_vertices.begin(), other.m_vertices.end());
+  m_indices.insert(m_indices.end(), other.m_indices.begin(), other.m_indices.end());
+  m_text.insert(m_text.end(), other.m_text.begin(), other.m_text.end());
+  m_transforms.insert(m_transforms.end(), other.m_transforms.begin(), other.m_transforms.end());
+
+  m_primitives.resize(nPrimitives + other.m_primitives.size());
+  Primitive* pPrim = m_primitives.asArrayPtr() + nPrimitives;
+  for (OdUInt32 i = 0; i < other.m_primitives.size(); ++i, ++pPrim)
+  {
+    *pPrim = other.m_primitives[i];
+    pPrim->m_nTraits = traitsRemap[pPrim->m_nTraits];
+    pPrim->m_nTransform += nTransforms;
+    pPrim->m_nEntity += nEntities;
+    pPrim->m_firstVertex += nVertices;
+    pPrim->m_firstIndex += (pPrim->m_type == kText) ? nText : nIndices;
+  }
+
+  m_entities.resize(nEntities + other.m_entities.size());
+  Entity* pEntity = m_entities.asArrayPtr() + nEntities;
+  for (OdUInt32 i = 0; i < other.m_entities.size(); ++i, ++pEntity)
+  {
+    *pEntity = other.m_entities[i];
+    pEntity->m_firstPrimitive += nPrimitives;
+  }
+}
+
+/************************************************************************/
+/* OdGiFlatGeometrySink                                                 */
+/************************************************************************/
+OdGiFlatGeometrySink::OdGiFlatGeometrySink()
+  : m_pOut(NULL)
+  , m_pVectorizer(NULL)
+  , m_nCurTraits(kInvalidIndex)
+  , m_nCurTransform(kInvalidIndex)
+{
+}
+
+void OdGiFlatGeometrySink::setOutput(OdGiFlatGeometry* pOut, OdGiBaseVectorizer* pVectorizer)
+{
+  m_pOut = pOut;
+  m_pVectorizer = pVectorizer;
+  m_traitsMap.clear();
+  for (OdUInt32 i = 0; i < pOut->m_traits.size(); ++i)
+    m_traitsMap.insert(std::make_pair(pOut->m_traits[i], i));
+  m_nCurTraits = kInvalidIndex;
+  m_nCurTransform = kInvalidIndex;
+}
+
+void OdGiFlatGeometrySink::closeOutput()
+{
+  m_traitsMap.clear();
+  m_pOut = NULL;
+  m_nCurTraits = kInvalidIndex;
+  m_nCurTransform = kInvalidIndex;
+}
+
+void OdGiFlatGeometrySink::beginEntity(OdDbStub* id)
+{
+  OdGiFlatGeometry::Entity entity;
+  entity.m_id = id;
+  entity.m_firstPrimitive = m_pOut->m_primitives.size();
+  entity.m_nPrimitives = 0;
+  m_pOut->m_entities.push_back(entity);
+  m_nCurTransform = kInvalidIndex;
+}
+
+void OdGiFlatGeometrySink::setTraits(const OdGiSubEntityTraitsData& traits)
+{
+  m_curTraits.m_color = traits.trueColor();
+  m_curTraits.m_transparency = traits.transparency();
+  m_curTraits.m_layer = traits.layer();
+  m_curTraits.m_lineType = traits.lineType();
+  m_curTraits.m_lineWeight = traits.lineWeight();
+  std::pair<TraitsMap::iterator, bool> res =
+    m_traitsMap.insert(std::make_pair(m_curTraits, m_pOut->m_traits.size()));
+  if (res.second)
+    m_pOut->m_traits.push_back(m_curTraits);
+  m_nCurTraits = res.first->second;
+}
+
+OdGiFlatGeometry::Primitive& OdGiFlatGeometrySink::addPrimitive(OdUInt8 type, OdInt32 nVertices, const OdGePoint3d* pVertices)
+{
+  if (m_nCurTraits == kInvalidIndex)
+    setTraits(m_pVectorizer->effectiveTraits());
+  /**********************************************************************/
+  /* Transform changes inside of block references only                  */
+  /**********************************************************************/
+  const OdGeMatrix3d xfm = m_pVectorizer->getModelToWorldTransform();
+  if (m_nCurTransform == kInvalidIndex || m_pOut->m_transforms[m_nCurTransform] != xfm)
+  {
+    m_nCurTransform = m_pOut->m_transforms.size();
+    m_pOut->m_transforms.push_back(xfm);
+  }
+  ODA_ASSERT(!m_pOut->m_entities.isEmpty());
+  m_pOut->m_entities.last().m_nPrimitives++;
+
+  OdGiFlatGeometry::Primitive prim;
+  prim.m_type = type;
+  prim.m_flags = 0;
+  prim.m_nTraits = m_nCurTraits;
+  prim.m_nTransform = m_nCurTransform;
+  prim.m_nEntity = m_pOut->m_entities.size() - 1;
+  prim.m_firstVertex = m_pOut->m_vertices.size();
+  prim.m_nVertices = (OdUInt32)nVertices;
+  prim.m_firstIndex = 0;
+  prim.m_nIndices = 0;
+  prim.m_marker = m_pVectorizer->selectionMarker();
+  if (pVertices)
+    m_pOut->m_vertices.insert(m_pOut->m_vertices.end(), pVertices, pVertices + nVertices);
+  m_pOut->m_primitives.push_back(prim);
+  return m_pOut->m_primitives.last();
+}
+
+void OdGiFlatGeometrySink::polylineOut(OdInt32 numPoints, const OdGePoint3d* vertexList)
+{
+  addPrimitive(OdGiFlatGeometry::kPolyline, numPoints, vertexList);
+}
+
+void OdGiFlatGeometrySink::polygonOut(OdInt32 numPoints, const OdGePoint3d* vertexList, const OdGeVector3d* /*pNormal*/)
+{
+  addPrimitive(OdGiFlatGeometry::kPolygon, numPoints, vertexList);
+}
+
+void OdGiFlatGeometrySink::shellProc(OdInt32 numVertices, const OdGePoint3d* vertexList, OdInt32 faceListSize, const OdInt32* faceList,
+                                     const OdGiEdgeData* /*pEdgeData*/, const OdGiFaceData* /*pFaceData*/, const OdGiVertexData* /*pVertexData*/)
+{
+  OdGiFlatGeometry::Primitive& prim = addPrimitive(OdGiFlatGeometry::kShell, numVertices, vertexList);
+  prim.m_firstIndex = m_pOut->m_indices.size();
+  prim.m_nIndices = (OdUInt32)faceListSize;
+  m_pOut->m_indices.insert(m_pOut->m_indices.end(), faceList, faceList + faceListSize);
+}
+
+void OdGiFlatGeometrySink::meshProc(OdInt32 numRows, OdInt32 numColumns, const OdGePoint3d* vertexList,
+                                    const OdGiEdgeData* /*pEdgeData*/, const OdGiFaceData* /*pFaceData*/, const OdGiVertexData* /*pVertexData*/)
+{
+  /**********************************************************************/
+  /* Mesh is written as shell with quadrilateral faces                  */
+  /**********************************************************************/
+  OdGiFlatGeometry::Primitive& prim = addPrimitive(OdGiFlatGeometry::kShell, numRows * numColumns, vertexList);
+  const OdUInt32 nFaces = (numRows > 1 && numColumns > 1) ? OdUInt32((numRows - 1) * (numColumns - 1)) : 0;
+  prim.m_firstIndex = m_pOut->m_indices.size();
+  prim.m_nIndices = nFaces * 5;
+  m_pOut->m_indices.resize(prim.m_firstIndex + prim.m_nIndices);
+  OdInt32* pFace = m_pOut->m_indices.asArrayPtr() + prim.m_firstIndex;
+  for (OdInt32 nRow = 0; nRow < numRows - 1; ++nRow)
+  {
+    for (OdInt32 nCol = 0; nCol < numColumns - 1; ++nCol, pFace += 5)
+    {
+      const OdInt32 nVertex = nRow * numColumns + nCol;
+      pFace[0] = 4;
+      pFace[1] = nVertex;
+      pFace[2] = nVertex + 1;
+      pFace[3] = nVertex + numColumns + 1;
+      pFace[4] = nVertex + numColumns;
+    }
+  }
+}
+
+void OdGiFlatGeometrySink::textProc(const OdGePoint3d& position, const OdGeVector3d& u, const OdGeVector3d& v,
+                                    const OdChar* msg, OdInt32 length, bool raw, const OdGiTextStyle* /*pTextStyle*/,
+                                    const OdGeVector3d* /*pExtrusion*/)
+{
+  const OdGePoint3d pts[3] = { position, position + u, position + v };
+  OdGiFlatGeometry::Primitive& prim = addPrimitive(OdGiFlatGeometry::kText, 3, pts);
+  if (length < 0)
+    length = (OdInt32)odStrLen(msg);
+  if (raw)
+    prim.m_flags |= OdGiFlatGeometry::kRawText;
+  prim.m_firstIndex = m_pOut->m_text.size();
+  prim.m_nIndices = (OdUInt32)length;
+  m_pOut->m_text.insert(m_pOut->m_text.end(), msg, msg + length);
+}
+
+void OdGiFlatGeometrySink::polypointProc(OdInt32 numPoints, const OdGePoint3d* vertexList, const OdCmEntityColor* /*pColors*/,
+                                         const OdCmTransparency* /*pTransparency*/, const OdGeVector3d* /*pNormals*/,
+                                         const OdGeVector3d* /*pExtrusions*/, const OdGsMarker* /*pSubEntMarkers*/, OdInt32 /*nPointSize*/)
+{
+  addPrimitive(OdGiFlatGeometry::kPoints, numPoints, vertexList);
+}
+
+void OdGiFlatGeometrySink::xlineProc(const OdGePoint3d& firstPoint, const OdGePoint3d& secondPoint)
+{
+  const OdGePoint3d pts[2] = { firstPoint, secondPoint };
+  addPrimitive(OdGiFlatGeometry::kXline, 2, pts);
+}
+
+void OdGiFlatGeometrySink::rayProc(const OdGePoint3d& basePoint, const OdGePoint3d& throughPoint)
+{
+  const OdGePoint3d pts[2] = { basePoint, throughPoint };
+  addPrimitive(OdGiFlatGeometry::kRay, 2, pts);
+}
+
+/************************************************************************/
+/* OdGiFlatGeometryVectorizer                                           */
+/************************************************************************/
+OdGiFlatGeometryVectorizer::OdGiFlatGeometryVectorizer()
+{
+}
+
+void OdGiFlatGeometryVectorizer::init(OdGiContext* pUserContext, OdGiFlatGeometry* pOut, double deviation)
+{
+  OdGiBaseVectorizer::setContext(pUserContext);
+  m_pModelToEyeProc->setDrawContext(drawContext());
+  m_sink.setDrawContext(drawContext());
+  OdGeDoubleArray deviations;
+  deviations.resize(5, deviation);
+  m_sink.setDeviation(deviations);
+  m_sink.setOutput(pOut, this);
+  output().setDestGeometry(m_sink);
+}
+
+void OdGiFlatGeometryVectorizer::setOutput(OdGiFlatGeometry* pOut)
+{
+  m_sink.setOutput(pOut, this);
+}
+
+void OdGiFlatGeometryVectorizer::closeOutput()
+{
+  m_sink.closeOutput();
+}
+
+void OdGiFlatGeometryVectorizer::drawEntity(const OdDbEntity* pEntity)
+{
+  m_sink.beginEntity(pEntity->objectId());
+  draw(pEntity);
+}
+
+void OdGiFlatGeometryVectorizer::onTraitsModified()
+{
+  OdGiBaseVectorizer::onTraitsModified();
+  m_sink.setTraits(effectiveTraits());
+}
+
+/************************************************************************/
+/* OdGiFlatGeometryExtractor                                            */
+/************************************************************************/
+namespace
+{
+  /**********************************************************************/
+  /* Vectorizes batches of entities. Every thread creates own context   */
+  /* and vectorizer, takes batches from scheduler and accumulates own   */
+  /* statistics                                                         */
+  /**********************************************************************/
+  class BatchExtractor : public OdApcAtom
+  {
+    OdDbDatabase            *m_pDb;
+    const OdDbObjectId      *m_pIds;
+    OdGsRegenBatchScheduler *m_pScheduler;
+    OdGiFlatGeometry        *m_pBatches;
+    GsRegenPerformanceData  *m_pStats;
+    OdGiFlatGeometryCache   *m_pCache;
+    OdResult                *m_pStatus;
+    double                   m_deviation;
+  public:
+    BatchExtractor() : m_pDb(NULL), m_pIds(NULL), m_pScheduler(NULL), m_pBatches(NULL), m_pStats(NULL), m_pCache(NULL), m_pStatus(NULL), m_deviation(0.0) { }
+
+    // pStatus receives result of every batch, exceptions aren't propagated from worker threads
+    void init(OdDbDatabase *pDb, const OdDbObjectId *pIds, OdGsRegenBatchScheduler *pScheduler,
+              OdGiFlatGeometry *pBatches, GsRegenPerformanceData *pStats, OdGiFlatGeometryCache *pCache,
+              OdResult *pStatus, double deviation)
+    {
+      m_pCache = pCache;
+      m_pStatus = pStatus;
+      m_pDb = pDb;
+      m_pIds = pIds;
+      m_pScheduler = pScheduler;
+      m_pBatches = pBatches;
+      m_pStats = pStats;
+      m_deviation = deviation;
+    }
+
+    /********************************************************************/
+    /* Transient data of vectorization (traits lookup) is allocated     */
+    /* from arena which is reset when output buffers are complete       */
+    /********************************************************************/
+    static void extractRange(OdGiFlatGeometryVectorizer &vect, OdArenaAllocator &arena, const OdDbObjectId *pIds,
+                             OdUInt32 nIds, OdGiFlatGeometryCache *pCache, OdGiFlatGeometry *pOut)
+    {
+      if (!pCache)
+      {
+        OdArenaAllocatorScope scope(arena);
+        vect.setOutput(pOut);
+        for (OdUInt32 i = 0; i < nIds; ++i)
+        {
+          OdDbEntityPtr pEntity = OdDbEntity::cast(pIds[i].openObject());
+          if (!pEntity.isNull())
+            vect.drawEntity(pEntity);
+        }
+        vect.closeOutput();
+        return;
+      }
+      for (OdUInt32 i = 0; i < nIds; ++i)
+      {
+        OdDbEntityPtr pEntity = OdDbEntity::cast(pIds[i].openObject());
+        if (pEntity.isNull())
+          continue;
+        /****************************************************************/
+        /* Every entity is written into own buffers which are cached    */
+        /****************************************************************/
+        const OdUInt64 stamp = pCache->entityStamp(pEntity);
+        OdGiFlatGeometry entityGeom;
+        if (!pCache->lookup(pIds[i], stamp, entityGeom))
+        {
+          {
+            OdArenaAllocatorScope scope(arena);
+            vect.setOutput(&entityGeom);
+            vect.drawEntity(pEntity);
+            vect.closeOutput();
+          }
+          pCache->store(pIds[i], stamp, entityGeom);
+        }
+        pOut->append(entityGeom);
+      }
+    }
+
+    void apcEntryPoint(OdApcParamType parameter)
+    {
+      const OdUInt32 nThread = (OdUInt32)parameter;
+      GsRegenThreadStats &stats = m_pStats->m_threads[nThread];
+      OdPerfTimerWrapper timer;
+      timer.getTimer()->start();
+      OdGiContextForDbDatabasePtr pContext = OdGiContextForDbDatabase::createObject();
+      pContext->setDatabase(m_pDb, false);
+      OdStaticRxObject<OdGiFlatGeometryVectorizer> vect;
+      OdArenaAllocator arena;
+      OdUInt32 nBatch;
+      bool bStolen;
+      while (m_pScheduler->next(nThread, nBatch, bStolen))
+      {
+        const OdGsRegenBatchScheduler::Batch &batch = m_pScheduler->batch(nBatch);
+        try
+        {
+          vect.init(pContext, m_pBatches + nBatch, m_deviation);
+          extractRange(vect, arena, m_pIds + batch.m_first, batch.m_count, m_pCache, m_pBatches + nBatch);
+        }
+        catch (const OdError &err)
+        {
+          m_pStatus[nBatch] = err.code();
+        }
+        catch (...)
+        {
+          m_pStatus[nBatch] = eExtendedError;
+        }
+        stats.m_nItems += batch.m_count;
+        stats.m_nBatches++;
+        if (bStolen)
+          stats.m_nStolenBatches++;
+        stats.m_cost += batch.m_cost;
+      }
+      timer.getTimer()->stop();
+      stats.m_time = timer.getTimer()->countedSec();
+    }
+  };
+}
+
+namespace
+{
+  /**********************************************************************/
+  /* Estimates costs of contiguous slices of entities. Only block       */
+  /* references are opened, blocks traversed by one thread are shared   */
+  /* with other threads through lock-free table                         */
+  /**********************************************************************/
+  class CostEstimator : public OdApcAtom
+  {
+    const OdDbObjectId   *m_pIds;
+    OdUInt32             *m_pCosts;
+    OdResult             *m_pStatus;
+    OdUInt32              m_nIds;
+    OdUInt32              m_nSlices;
+    OdGsRegenSharedCosts  m_sharedCosts;
+  public:
+    CostEstimator() : m_pIds(NULL), m_pCosts(NULL), m_pStatus(NULL), m_nIds(0), m_nSlices(1) { }
+
+    // pStatus receives result of every slice, exceptions aren't propagated from worker threads
+    void init(const OdDbObjectId *pIds, OdUInt32 *pCosts, OdResult *pStatus, OdUInt32 nIds, OdUInt32 nSlices, OdUInt32 nBlocks)
+    {
+      m_pIds = pIds;
+      m_pCosts = pCosts;
+      m_pStatus = pStatus;
+      m_nIds = nIds;
+      m_nSlices = nSlices;
+      m_sharedCosts.init(nBlocks);
+    }
+
+    void apcEntryPoint(OdApcParamType parameter)
+    {
+      const OdUInt32 nSlice = (OdUInt32)parameter;
+      const OdUInt32 nFirst = OdUInt32(OdUInt64(m_nIds) * nSlice / m_nSlices);
+      const OdUInt32 nLast = OdUInt32(OdUInt64(m_nIds) * (nSlice + 1) / m_nSlices);
+      std::map<OdDbStub*, OdUInt32> localCosts;
+      try
+      {
+        for (OdUInt32 i = nFirst; i < nLast; ++i)
+          m_pCosts[i] = OdGiFlatGeometryExtractor::entityCost(m_pIds[i], m_sharedCosts, localCosts, 0);
+      }
+      catch (const OdError &err)
+      {
+        m_pStatus[nSlice] = err.code();
+      }
+      catch (...)
+      {
+        m_pStatus[nSlice] = eExtendedError;
+      }
+    }
+  };
+
+  /**********************************************************************/
+  /* Switches database into multithreaded rendering mode and restores   */
+  /* previous mode on destruction, so exceptions don't leave it changed */
+  /**********************************************************************/
+  class MTRenderingModeScope
+  {
+    OdDbDatabase             *m_pDb;
+    OdDb::MultiThreadedMode   m_prevMode;
+  public:
+    MTRenderingModeScope(OdDbDatabase *pDb)
+      : m_pDb(pDb)
+      , m_prevMode(pDb->multiThreadedMode())
+    {
+      if (m_prevMode != OdDb::kMTRendering)
+        m_pDb->setMultiThreadedMode(OdDb::kMTRendering);
+    }
+    ~MTRenderingModeScope()
+    {
+      if (m_prevMode != OdDb::kMTRendering)
+        m_pDb->setMultiThreadedMode(m_prevMode);
+    }
+  };
+
+  // Throws first failure recorded by worker threads
+  void throwFirstFailure(const OdResult *pStatus, OdUInt32 nStatus)
+  {
+    for (OdUInt32 i = 0; i < nStatus; ++i)
+    {
+      if (pStatus[i] != eOk)
+        throw OdError(pStatus[i]);
+    }
+  }
+}
+
+OdGiFlatGeometryExtractor::OdGiFlatGeometryExtractor()
+  : m_deviation(0.01)
+  , m_nThreads(0)
+  , m_pCache(NULL)
+{
+}
+
+OdUInt32 OdGiFlatGeometryExtractor::entityCost(const OdDbObjectId& id, OdGsRegenSharedCosts& sharedCosts,
+                                               std::map<OdDbStub*, OdUInt32>& localCosts, int nDepth)
+{
+  OdRxClass* pClass = id.objectClass();
+  if (!pClass)
+    return 1;
+  if (pClass->isDerivedFrom(OdDbBlockReference::desc()))
+  {
+    if (nDepth >= kMaxBlockDepth)
+      return 1;
+    OdDbBlockReferencePtr pRef = OdDbBlockReference::cast(id.openObject());
+    if (pRef.isNull())
+      return 1;
+    const OdDbObjectId blockId = pRef->blockTableRecord();
+    std::map<OdDbStub*, OdUInt32>::iterator pIt = localCosts.find(blockId);
+    if (pIt != localCosts.end())
+      return pIt->second;
+    OdUInt32 nBlockCost;
+    if (sharedCosts.find(blockId, nBlockCost))
+    {
+      localCosts[blockId] = nBlockCost;
+      return nBlockCost;
+    }
+    // Cost is registered before traversal, so self-referencing blocks are finite
+    pIt = localCosts.insert(std::make_pair((OdDbStub*)blockId, OdUInt32(1))).first;
+    OdUInt64 nCost = 1;
+    OdDbBlockTableRecordPtr pBlock = OdDbBlockTableRecord::cast(blockId.openObject());
+    if (!pBlock.isNull())
+    {
+      for (OdDbObjectIteratorPtr pIter = pBlock->newIterator(); !pIter->done(); pIter->step())
+        nCost += entityCost(pIter->objectId(), sharedCosts, localCosts, nDepth + 1);
+    }
+    pIt->second = OdUInt32(odmin(nCost, OdUInt64(0x00FFFFFF)));
+    sharedCosts.insert(blockId, pIt->second);
+    return pIt->second;
+  }
+  if (pClass->isDerivedFrom(OdDb3dSolid::desc()) || pClass->isDerivedFrom(OdDbRegion::desc()) ||
+      pClass->isDerivedFrom(OdDbBody::desc()) || pClass->isDerivedFrom(OdDbSurface::desc()) ||
+      pClass->isDerivedFrom(OdDbSubDMesh::desc()) || pClass->isDerivedFrom(OdDbPolyFaceMesh::desc()) ||
+      pClass->isDerivedFrom(OdDbPolygonMesh::desc()) || pClass->isDerivedFrom(OdDbProxyEntity::desc()))
+    return 32;
+  if (pClass->isDerivedFrom(OdDbText::desc()) || pClass->isDerivedFrom(OdDbMText::desc()) ||
+      pClass->isDerivedFrom(OdDbDimension::desc()) || pClass->isDerivedFrom(OdDbHatch::desc()) ||
+      pClass->isDerivedFrom(OdDbMLeader::desc()))
+    return 8;
+  return 1;
+}
+
+void OdGiFlatGeometryExtractor::extract(const OdDbBlockTableRecord* pBlock, OdGiFlatGeometry& out)
+{
+  OdPerfTimerWrapper timer;
+  timer.getTimer()->start();
+  out.clear();
+  m_stats = Stats();
+
+  OdDbObjectIdArray ids;
+  for (OdDbObjectIteratorPtr pIter = pBlock->newIterator(); !pIter->done(); pIter->step())
+    ids.push_back(pIter->objectId());
+  if (ids.isEmpty())
+    return;
+  OdDbDatabase* pDb = pBlock->database();
+
+  OdGiFlatGeometryCache* pCache = m_pCache;
+  ODA_ASSERT(!pCache || pCache->deviation() == m_deviation);
+  if (pCache && pCache->deviation() != m_deviation)
+    pCache = NULL;
+  OdUInt32 nHits = 0;
+  if (pCache)
+  {
+    pCache->clearBlockStamps();
+    nHits = pCache->stats().m_nHits;
+  }
+
+  OdRxThreadPoolServicePtr pThreadPool;
+  if ((m_nThreads != 1) && (ids.size() > 1))
+    pThreadPool = ::odrxDynamicLinker()->getModule(OdThreadPoolModuleName);
+  unsigned nThreads = 1;
+  if (!pThreadPool.isNull())
+    nThreads = odmin(m_nThreads ? m_nThreads : (unsigned)pThreadPool->numCPUs(), (unsigned)ids.size());
+
+  if (nThreads < 2)
+  {
+    OdGiContextForDbDatabasePtr pContext = OdGiContextForDbDatabase::createObject();
+    pContext->setDatabase(pDb, false);
+    OdStaticRxObject<OdGiFlatGeometryVectorizer> vect;
+    vect.init(pContext, &out, m_deviation);
+    OdArenaAllocator arena;
+    BatchExtractor::extractRange(vect, arena, ids.getPtr(), ids.size(), pCache, &out);
+  }
+  else
+  {
+    /********************************************************************/
+    /* Costs are estimated and entities are vectorized by worker        */
+    /* threads. Only block references are opened by costs estimation    */
+    /********************************************************************/
+    MTRenderingModeScope mtMode(pDb);
+    OdUInt32Array costs;
+    costs.resize(ids.size());
+    OdArray<OdResult> status;
+    {
+      OdUInt32 nBlocks = 0;
+      OdDbSymbolTablePtr pBlocks = pDb->getBlockTableId().safeOpenObject();
+      for (OdDbSymbolTableIteratorPtr pIter = pBlocks->newIterator(); !pIter->done(); pIter->step())
+        ++nBlocks;
+      status.resize(nThreads, eOk);
+      {
+        OdStaticRxObject<CostEstimator> estimator;
+        estimator.init(ids.getPtr(), costs.asArrayPtr(), status.asArrayPtr(), ids.size(), nThreads, nBlocks);
+        OdApcQueuePtr pQueue = pThreadPool->newMTQueue(ThreadsCounter::kMtRegenAttributes, nThreads, kMtQueueAllowExecByMain);
+        for (unsigned i = 0; i < nThreads; ++i)
+          pQueue->addEntryPoint(&estimator, (OdApcParamType)i);
+        pQueue->wait();
+      }
+      throwFirstFailure(status.getPtr(), status.size());
+    }
+    OdGsRegenBatchScheduler scheduler;
+    scheduler.build(costs.getPtr(), ids.size(), nThreads, kBatchesPerThread);
+    const OdUInt32 nBatches = scheduler.numBatches();
+    m_stats.m_regen.reset(nThreads);
+
+    OdArray<OdGiFlatGeometry> batches;
+    batches.resize(nBatches);
+    {
+      status.clear();
+      status.resize(nBatches, eOk);
+      {
+        OdStaticRxObject<BatchExtractor> extractor;
+        extractor.init(pDb, ids.getPtr(), &scheduler, batches.asArrayPtr(), &m_stats.m_regen, pCache, status.asArrayPtr(), m_deviation);
+        OdApcQueuePtr pQueue = pThreadPool->newMTQueue(ThreadsCounter::kMtRegenAttributes, nThreads, kMtQueueAllowExecByMain);
+        for (unsigned i = 0; i < nThreads; ++i)
+          pQueue->addEntryPoint(&extractor, (OdApcParamType)i);
+        pQueue->wait();
+      }
+      throwFirstFailure(status.getPtr(), status.size());
+    }
+
+    OdUInt32 nVertices = 0, nPrimitives = 0;
+    for (OdUInt32 i = 0; i < nBatches; ++i)
+    {
+      nVertices += batches[i].m_vertices.size();
+      nPrimitives += batches[i].m_primitives.size();
+    }
+    out.m_vertices.reserve(nVertices);
+    out.m_primitives.reserve(nPrimitives);
+    out.m_entities.reserve(ids.size());
+    for (OdUInt32 i = 0; i < nBatches; ++i)
+    {
+      out.append(batches[i]);
+      batches[i].clear();
+    }
+  }
+  timer.getTimer()->stop();
+  m_stats.m_nEntities = out.m_entities.size();
+  m_stats.m_nPrimitives = out.m_primitives.size();
+  m_stats.m_nVertices = out.m_vertices.size();
+  m_stats.m_nThreads = nThreads;
+  if (pCache)
+    m_stats.m_nCached = pCache->stats().m_nHits - nHits;
+  m_stats.m_seconds = timer.getTimer()->countedSec();
+}
@@ -0,0 +1,293 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __OD_GI_FLAT_GEOMETRY_EXTRACTOR__
+#define __OD_GI_FLAT_GEOMETRY_EXTRACTOR__
+
+#include "Gi/GiBaseVectorizer.h"
+#include "Gi/GiGeometrySimplifier.h"
+#include "Ge/GeMatrix3dArray.h"
+#include "DbBlockTableRecord.h"
+#include "Gs/GsVectPerformance.h"
+#include "Gs/GsRegenScheduler.h"
+#include "ChunkAllocator.h"
+
+#define STL_USING_MAP
+#include "OdaSTL.h"
+
+class OdGiFlatGeometryCache;
+
+/************************************************************************/
+/* Geometry of a block written into contiguous typed buffers: a vertex  */
+/* pool, shell face lists, text characters and primitive records which  */
+/* refer to ranges of these pools, plus tables of traits, transforms    */
+/* and source entities shared by the primitives                         */
+/************************************************************************/
+struct OdGiFlatGeometry
+{
+  enum PrimitiveType
+  {
+    kPolyline = 0, // Vertices are polyline points
+    kPolygon,      // Vertices are polygon points
+    kShell,        // Vertices are shell vertices, indices are shell face list
+    kText,         // Vertices are position, end of direction and end of up vectors, indices are text characters
+    kPoints,       // Vertices are separate points
+    kXline,        // Vertices are two points of infinite line
+    kRay           // Vertices are base point and through point of ray
+  };
+  enum PrimitiveFlags
+  {
+    kRawText = 1   // Text doesn't contain control sequences
+  };
+  struct Primitive
+  {
+    OdUInt8    m_type;
+    OdUInt8    m_flags;
+    OdUInt32   m_nTraits;     // Index in m_traits
+    OdUInt32   m_nTransform;  // Index in m_transforms (block transform the primitive is drawn with)
+    OdUInt32   m_nEntity;     // Index in m_entities
+    OdUInt32   m_firstVertex;
+    OdUInt32   m_nVertices;
+    OdUInt32   m_firstIndex;  // First entry of m_indices (shells) or m_text (text)
+    OdUInt32   m_nIndices;
+    OdGsMarker m_marker;      // Subentity selection marker
+  };
+  struct Traits
+  {
+    OdCmEntityColor  m_color;
+    OdCmTransparency m_transparency;
+    OdDbStub*        m_layer;
+    OdDbStub*        m_lineType;
+    OdDb::LineWeight m_lineWeight;
+
+    Traits() : m_layer(NULL), m_lineType(NULL), m_lineWeight(OdDb::kLnWtByLwDefault) { }
+    bool operator <(const Traits& t2) const
+    {
+      if (m_color.color() != t2.m_color.color()) return m_color.color() < t2.m_color.color();
+      if (m_transparency.serializeOut() != t2.m_transparency.serializeOut())
+        return m_transparency.serializeOut() < t2.m_transparency.serializeOut();
+      if (m_layer != t2.m_layer) return m_layer < t2.m_layer;
+      if (m_lineType != t2.m_lineType) return m_lineType < t2.m_lineType;
+      return m_lineWeight < t2.m_lineWeight;
+    }
+  };
+  struct Entity
+  {
+    OdDbStub* m_id;
+    OdUInt32  m_firstPrimitive;
+    OdUInt32  m_nPrimitives;
+  };
+
+  OdGePoint3dArray                                 m_vertices;
+  OdInt32Array                                     m_indices;
+  OdArray<OdChar, OdMemoryAllocator<OdChar> >       m_text;
+  OdArray<Primitive, OdMemoryAllocator<Primitive> > m_primitives;
+  OdArray<Traits>                                  m_traits;
+  OdGeMatrix3dArray                                m_transforms;
+  OdArray<Entity, OdMemoryAllocator<Entity> >       m_entities;
+
+  OdGiFlatGeometry();
+
+  /**********************************************************************/
+  /* Removes all data keeping allocated memory                          */
+  /**********************************************************************/
+  void clear();
+
+  /**********************************************************************/
+  /* Appends contents of other buffers rebasing all indices, equal      */
+  /* traits are merged                                                  */
+  /**********************************************************************/
+  void append(const OdGiFlatGeometry& other);
+};
+
+/************************************************************************/
+/* Conveyor output which writes primitives into OdGiFlatGeometry.       */
+/* Curves are tessellated by OdGiGeometrySimplifier, shells, meshes and */
+/* text are written without tessellation                                */
+/************************************************************************/
+class OdGiFlatGeometrySink : public OdGiGeometrySimplifier
+{
+protected:
+  OdGiFlatGeometry*       m_pOut;
+  OdGiBaseVectorizer*     m_pVectorizer;
+  OdGiFlatGeometry::Traits m_curTraits;
+  OdUInt32                m_nCurTraits;
+  OdUInt32                m_nCurTransform;
+  // Nodes are allocated from arena which is active while output is set
+  typedef std::map<OdGiFlatGeometry::Traits, OdUInt32, std::less<OdGiFlatGeometry::Traits>,
+                   OdArenaStlAllocator<std::pair<const OdGiFlatGeometry::Traits, OdUInt32> > > TraitsMap;
+  TraitsMap               m_traitsMap;
+
+  OdGiFlatGeometry::Primitive& addPrimitive(OdUInt8 type, OdInt32 nVertices, const OdGePoint3d* pVertices);
+public:
+  OdGiFlatGeometrySink();
+
+  void setOutput(OdGiFlatGeometry* pOut, OdGiBaseVectorizer* pVectorizer);
+
+  /**********************************************************************/
+  /* Releases lookup data of output buffers, output must be set again   */
+  /* before following primitives                                        */
+  /**********************************************************************/
+  void closeOutput();
+
+  /**********************************************************************/
+  /* Entity which owns primitives output until the next call            */
+  /**********************************************************************/
+  void beginEntity(OdDbStub* id);
+
+  /**********************************************************************/
+  /* Sets traits of following primitives                                */
+  /**********************************************************************/
+  void setTraits(const OdGiSubEntityTraitsData& traits);
+
+  void polylineOut(OdInt32 numPoints, const OdGePoint3d* vertexList);
+  void polygonOut(OdInt32 numPoints, const OdGePoint3d* vertexList, const OdGeVector3d* pNormal = 0);
+  void shellProc(OdInt32 numVertices, const OdGePoint3d* vertexList, OdInt32 faceListSize, const OdInt32* faceList,
+                 const OdGiEdgeData* pEdgeData = 0, const OdGiFaceData* pFaceData = 0, const OdGiVertexData* pVertexData = 0);
+  void meshProc(OdInt32 numRows, OdInt32 numColumns, const OdGePoint3d* vertexList,
+                const OdGiEdgeData* pEdgeData = 0, const OdGiFaceData* pFaceData = 0, const OdGiVertexData* pVertexData = 0);
+  void textProc(const OdGePoint3d& position, const OdGeVector3d& u, const OdGeVector3d& v,
+                const OdChar* msg, OdInt32 length, bool raw, const OdGiTextStyle* pTextStyle, const OdGeVector3d* pExtrusion = 0);
+  void polypointProc(OdInt32 numPoints, const OdGePoint3d* vertexList, const OdCmEntityColor* pColors,
+                     const OdCmTransparency* pTransparency = 0, const OdGeVector3d* pNormals = 0,
+                     const OdGeVector3d* pExtrusions = 0, const OdGsMarker* pSubEntMarkers = 0, OdInt32 nPointSize = 0);
+  void xlineProc(const OdGePoint3d& firstPoint, const OdGePoint3d& secondPoint);
+  void rayProc(const OdGePoint3d& basePoint, const OdGePoint3d& throughPoint);
+};
+
+/************************************************************************/
+/* Vectorizer which passes geometry and traits to OdGiFlatGeometrySink  */
+/************************************************************************/
+class OdGiFlatGeometryVectorizer : public OdGiBaseVectorizer
+{
+protected:
+  OdGiFlatGeometrySink m_sink;
+public:
+  ODRX_HEAP_OPERATORS();
+
+  OdGiFlatGeometryVectorizer();
+
+  /**********************************************************************/
+  /* Setup context, output buffers and curves tessellation deviation    */
+  /**********************************************************************/
+  void init(OdGiContext* pUserContext, OdGiFlatGeometry* pOut, double deviation);
+
+  /**********************************************************************/
+  /* Redirects following primitives into other output buffers           */
+  /**********************************************************************/
+  void setOutput(OdGiFlatGeometry* pOut);
+
+  /**********************************************************************/
+  /* Releases lookup data of output buffers                             */
+  /**********************************************************************/
+  void closeOutput();
+
+  /**********************************************************************/
+  /* Writes all primitives of the entity into output buffers            */
+  /**********************************************************************/
+  void drawEntity(const OdDbEntity* pEntity);
+
+  void onTraitsModified();
+};
+
+/************************************************************************/
+/* Extracts all primitives of a block table record into flat buffers.   */
+/* Entities are split into batches of equal estimated cost which are    */
+/* vectorized by thread pool threads with their own vectorizers,        */
+/* threads which finished own batches steal batches of other threads.   */
+/* Batch buffers are appended in the order of entities, so result       */
+/* doesn't depend on threads count                                      */
+/************************************************************************/
+class OdGiFlatGeometryExtractor
+{
+public:
+  struct Stats
+  {
+    OdUInt32 m_nEntities;
+    OdUInt32 m_nPrimitives;
+    OdUInt32 m_nVertices;
+    OdUInt32 m_nThreads;
+    OdUInt32 m_nCached;             // Entities taken from cache without vectorization
+    double   m_seconds;
+    GsRegenPerformanceData m_regen; // Per-thread statistics of multithreaded extraction
+
+    Stats() : m_nEntities(0), m_nPrimitives(0), m_nVertices(0), m_nThreads(0), m_nCached(0), m_seconds(0.0) { }
+    double primitivesPerSecond() const { return (m_seconds > 0.0) ? m_nPrimitives / m_seconds : 0.0; }
+  };
+  enum
+  {
+    kBatchesPerThread = 8,  // Batches are stolen by threads which finished own batches
+    kMaxBlockDepth    = 16  // Nesting of block references which is taken into account by cost estimation
+  };
+protected:
+  double   m_deviation;
+  unsigned m_nThreads;
+  Stats    m_stats;
+  OdGiFlatGeometryCache* m_pCache;
+
+public:
+  /**********************************************************************/
+  /* Relative cost of entity vectorization estimated by its class,      */
+  /* block reference costs as its block definition entities. Costs of   */
+  /* traversed blocks are shared between threads by sharedCosts,        */
+  /* localCosts keeps blocks of this thread (including blocks which are */
+  /* being traversed, so self-referencing blocks are finite)            */
+  /**********************************************************************/
+  static OdUInt32 entityCost(const OdDbObjectId& id, OdGsRegenSharedCosts& sharedCosts,
+                             std::map<OdDbStub*, OdUInt32>& localCosts, int nDepth);
+
+  OdGiFlatGeometryExtractor();
+
+  /**********************************************************************/
+  /* Deviation of curves tessellation in world units                    */
+  /**********************************************************************/
+  void setDeviation(double deviation) { m_deviation = deviation; }
+  double deviation() const { return m_deviation; }
+
+  /**********************************************************************/
+  /* Number of threads, 0 - number of CPUs reported by thread pool,     */
+  /* 1 - extraction in calling thread                                   */
+  /**********************************************************************/
+  void setNumThreads(unsigned nThreads) { m_nThreads = nThreads; }
+  unsigned numThreads() const { return m_nThreads; }
+
+  /**********************************************************************/
+  /* Cache of entities geometry, unchanged entities are taken from the  */
+  /* cache and vectorized entities are stored to it. Cache must be      */
+  /* opened with the same deviation                                     */
+  /**********************************************************************/
+  void setCache(OdGiFlatGeometryCache* pCache) { m_pCache = pCache; }
+  OdGiFlatGeometryCache* cache() const { return m_pCache; }
+
+  /**********************************************************************/
+  /* Writes all primitives of the block into output buffers             */
+  /**********************************************************************/
+  void extract(const OdDbBlockTableRecord* pBlock, OdGiFlatGeometry& out);
+
+  /**********************************************************************/
+  /* Statistics of the last extract() call                              */
+  /**********************************************************************/
+  const Stats& stats() const { return m_stats; }
+};
+
+#endif // __OD_GI_FLAT_GEOMETRY_EXTRACTOR__
@@ -30,6 +30,12 @@
 /*    OdGetGeomEx <input file> <entity handle> [<output file>]          */
 /*    If <output file> is not specified, output is written to stdout.   */
 /*                                                                      */
+/*    OdGetGeomEx <input file> -flat [<number of threads>] [-cache]     */
+/*    Extracts all primitives of model space into flat buffers and      */
+/*    reports extraction statistics. With -cache geometry of entities   */
+/*    is kept in <input file>.flatcache and only changed entities are   */
+/*    vectorized on next run.                                           */
+/*                                                                      */
 /************************************************************************/
 
 #include "OdaCommon.h"
@@ -43,8 +49,12 @@
 #include "GiContextForDbDatabase.h"
 #include "../OdVectorizeEx/GiDumperImpl.h"
 #include "GiDrawObjectForGetGeometry.h"
+#include "GiFlatGeometryExtractor.h"
+#include "GiFlatGeometryCache.h"
+#include "DbBlockTableRecord.h"
 
 #include "RxDynamicModule.h"
+#include "RxThreadPoolService.h"
 
 #define STL_USING_IOSTREAM
 #define STL_USING_STREAM
@@ -87,9 +97,11 @@ static void MyAssert(const char* expresssion, const char* fileName, int nLineNo)
 #if !defined(_TOOLKIT_IN_DLL_)
 
 ODRX_DECLARE_STATIC_MODULE_ENTRY_POINT(ModelerModule);
+ODRX_DECLARE_STATIC_MODULE_ENTRY_POINT(OdRxThreadPoolImpl);
 
 ODRX_BEGIN_STATIC_MODULE_MAP()
   ODRX_DEFINE_STATIC_APPLICATION(OdModelerGeometryModuleName,  ModelerModule)
+  ODRX_DEFINE_STATIC_APPMODULE(OdThreadPoolModuleName,         OdRxThreadPoolImpl)
 ODRX_END_STATIC_MODULE_MAP()
 
 #endif
@@ -110,6 +122,7 @@ int main(int argc, char* argv[])
   if (argc < 3)
   {
     printf("usage: OdGetGeomEx <input file> <entity handle> [> <output file>]\n");
+    printf("       OdGetGeomEx <input file> -flat [<number of threads>] [-cache]\n");
   }
   else
   {
@@ -148,7 +161,61 @@ int main(int argc, char* argv[])
 
       pDb = svcs.readFile( argv[1], false, false, Oda::kShareDenyNo ); 
 
-      if(!pDb.isNull())
+      if(!pDb.isNull() && !odStrCmp(OdString(argv[2]), OD_T("-flat")))
+      {
+        /****************************************************************/
+        /* Modules which are loaded on demand during vectorization are  */
+        /* loaded here, so worker threads don't compete in loading      */
+        /****************************************************************/
+        ::odrxDynamicLinker()->loadModule(OdModelerGeometryModuleName, true);
+        ::odrxDynamicLinker()->loadApp(OdThreadPoolModuleName, true);
+
+        /****************************************************************/
+        /* Extract all primitives of model space into flat buffers      */
+        /****************************************************************/
+        OdDbBlockTableRecordPtr pMS = pDb->getModelSpaceId().openObject();
+        OdGiFlatGeometryExtractor extractor;
+        OdGiFlatGeometryCache cache;
+        OdString cacheFileName;
+        for (int nArg = 3; nArg < argc; ++nArg)
+        {
+          if (!odStrCmp(OdString(argv[nArg]), OD_T("-cache")))
+            cacheFileName = OdString(argv[1]) + OD_T(".flatcache");
+          else
+            extractor.setNumThreads((unsigned)odStrToInt(OdString(argv[nArg]).c_str()));
+        }
+        if (!cacheFileName.isEmpty())
+        {
+          if (!cache.open(cacheFileName, pDb, extractor.deviation()))
+            printf("\nCache file is missing or outdated, all entities are vectorized\n");
+          extractor.setCache(&cache);
+        }
+        OdGiFlatGeometry geometry;
+        extractor.extract(pMS, geometry);
+
+        const OdGiFlatGeometryExtractor::Stats& stats = extractor.stats();
+        printf("\nEntities: %u, primitives: %u, vertices: %u, traits: %u, transforms: %u\n",
+               stats.m_nEntities, stats.m_nPrimitives, stats.m_nVertices,
+               geometry.m_traits.size(), geometry.m_transforms.size());
+        printf("Threads: %u, time: %.3f sec, %.0f primitives/sec\n",
+               stats.m_nThreads, stats.m_seconds, stats.primitivesPerSecond());
+        for (OdUInt32 i = 0; i < stats.m_regen.m_threads.size(); ++i)
+        {
+          const GsRegenThreadStats& thread = stats.m_regen.m_threads[i];
+          printf("  Thread %u: entities: %u, batches: %u (stolen: %u), cost: %u, time: %.3f sec\n",
+                 i, thread.m_nItems, thread.m_nBatches, thread.m_nStolenBatches, (OdUInt32)thread.m_cost, thread.m_time);
+        }
+        if (stats.m_regen.m_threads.size())
+          printf("Imbalance (max/average thread time): %.2f\n", stats.m_regen.imbalance());
+        if (!cacheFileName.isEmpty())
+        {
+          printf("Cache: %u entries loaded, %u entities taken from cache, %u vectorized\n",
+                 cache.stats().m_nLoaded, stats.m_nCached, stats.m_nEntities - stats.m_nCached);
+          if (!cache.save(cacheFileName))
+            printf("Cache file can't be written\n");
+        }
+      }
+      else if(!pDb.isNull())
       {
         /****************************************************************/
         /* Get the input handle                                         */
@@ -29,5 +29,7 @@
 #include "mono_dxt1_compressor.cpp"
 
 #include "TtfFontsCache.cpp"
+#include "TtfGlyphStore.cpp"
+#include "OdFileMapping.cpp"
 
 //
@@ -161,6 +161,7 @@ android|iphone {
     SOURCES += $${ODADIR}/Kernel/Extensions/ExServices/OdFileBuf.cpp
     SOURCES += $${ODADIR}/Drawing/Extensions/ExServices/ExHostAppServices.cpp
     SOURCES += $${ODADIR}/Drawing/Extensions/ExServices/ExUndoController.cpp
+    SOURCES += $${ODADIR}/Kernel/Extensions/ExServices/ExUndoRecordStore.cpp
     SOURCES += $${ODADIR}/Drawing/Extensions/ExServices/ExPageController.cpp
     SOURCES += $${ODADIR}/Drawing/Extensions/ExServices/ExDbCommandContext.cpp
     SOURCES += $${ODADIR}/Kernel/Extensions/ExServices/ExStringIO.cpp
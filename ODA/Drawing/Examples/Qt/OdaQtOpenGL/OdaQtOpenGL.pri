@@ -71,6 +71,7 @@ INCLUDEPATH += $${ODADIR}/Kernel/Include
 INCLUDEPATH += $${ODADIR}/Drawing/Include
 INCLUDEPATH += $${ODADIR}/Kernel/Extensions/ExRender
 INCLUDEPATH += $${ODADIR}/Kernel/Extensions/ExRender/OpenGL
+INCLUDEPATH += $${ODADIR}/Kernel/Extensions/ExServices
 
 #android|iphone:contains(QT_MAJOR_VERSION, 5) {
 ## WinGLES2
@@ -124,6 +125,8 @@ HEADERS += $${ODADIR}/Kernel/Extensions/ExRender/ExGsHelpers.h
 HEADERS += $${ODADIR}/Kernel/Extensions/ExRender/MetafileTransformStack.h
 HEADERS += $${ODADIR}/Kernel/Extensions/ExRender/mono_dxt1_compressor.h
 HEADERS += $${ODADIR}/Kernel/Extensions/ExRender/TtfFontsCache.h
+HEADERS += $${ODADIR}/Kernel/Extensions/ExRender/TtfGlyphStore.h
+HEADERS += $${ODADIR}/Kernel/Extensions/ExServices/OdFileMapping.h
 HEADERS += $${ODADIR}/Kernel/Extensions/ExRender/OpenGL/OpenGL_ES.h
 HEADERS += $${ODADIR}/Kernel/Extensions/ExRender/OpenGL/OpenGLExtensions.h
 
@@ -135,6 +138,8 @@ SOURCES += $${ODADIR}/Kernel/Extensions/ExRender/OpenGL/ExOpenGLMetafileWriter.c
 SOURCES += $${ODADIR}/Kernel/Extensions/ExRender/OpenGL/GsOpenGLStreamVectorizer.cpp
 SOURCES += $${ODADIR}/Kernel/Extensions/ExRender/mono_dxt1_compressor.cpp
 SOURCES += $${ODADIR}/Kernel/Extensions/ExRender/TtfFontsCache.cpp
+SOURCES += $${ODADIR}/Kernel/Extensions/ExRender/TtfGlyphStore.cpp
+SOURCES += $${ODADIR}/Kernel/Extensions/ExServices/OdFileMapping.cpp
 #}
 
 #RESOURCES += data/data.qrc
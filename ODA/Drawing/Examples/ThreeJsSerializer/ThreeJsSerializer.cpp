@@ -216,6 +216,7 @@ int main(int argc, char* argv[])
     TD_THREEJSJSON_EXPORT::ThreejsJSONModulePtr pModule = odrxDynamicLinker()->loadApp(OdThreejsJSONExportModuleName);
     OdGsDevicePtr pDevice;
     OdTrVisRendition* pRendition = NULL;
+    OdGsDevicePoolPtr pDevicePool; // Shares device between subsequent -j commands if -r specified
 
     char chOp = L'\0';
     for (int idxArg = 1; true; idxArg++)
@@ -249,6 +250,12 @@ int main(int argc, char* argv[])
 
       switch (chOp)
       {
+      case L'r':
+        if (!pModule.isNull() && pDevicePool.isNull())
+          pDevicePool = pModule->createDevicePool(1);
+        idxArg--; // Option hasn't argument
+        break;
+
       case L'f':
         if (idxArg < argc)
           bEnabledFaces  = !((sArg = argv[idxArg]).makeLower() == L"false" || sArg == L"0");
@@ -308,7 +315,10 @@ int main(int argc, char* argv[])
 
           if (!pModule.isNull())
           {
-            OdUInt32 errorCode = pModule->exportThreejsJSON(pRxDb.get(), buff.get(), clrPaletteBackground, bEnabledFaces);
+            OdUInt32 errorCode = (pDevicePool.isNull()) ? pModule->exportThreejsJSON(pRxDb.get(), buff.get(), clrPaletteBackground, bEnabledFaces)
+                                                        : pModule->exportThreejsJSON(pRxDb.get(), buff.get(), clrPaletteBackground, bEnabledFaces, pDevicePool);
+            if (errorCode != eOk)
+              odPrintConsoleString(L"\nSerialize failed: %ls\n", OdError((OdResult)errorCode).description().c_str());
           }
         }
         odPrintConsoleString(L"\nSerialize Done.\n");
@@ -318,6 +328,13 @@ int main(int argc, char* argv[])
     } // end for
 
     pDevice = NULL;
+    if (!pDevicePool.isNull())
+    {
+      const OdGsDevicePool::Stats poolStats = pDevicePool->stats();
+      odPrintConsoleString(L"\nDevices created: %u, reused: %u, discarded: %u\n",
+                           poolStats.m_nCreated, poolStats.m_nReused, poolStats.m_nDiscarded);
+      pDevicePool = NULL;
+    }
 
     if (bNothingToDump)
     {
@@ -327,6 +344,9 @@ int main(int argc, char* argv[])
 	  odPrintConsoleString(L"      [-f true     - is default]\n");
       odPrintConsoleString(L" -o <input DWG/DXF file to Open> \n");
       odPrintConsoleString(L" -j <output file to Dump JSON> \n");
+      odPrintConsoleString(L" -r             to reuse one device for all -j commands, e.g.\n");
+      odPrintConsoleString(L"      ThreeJsSerializer -r -o a.dwg -j a.json -o b.dwg -j b.json\n");
+      odPrintConsoleString(L"      reports 1 created and 1 reused device\n");
       return 1;
     }
   }
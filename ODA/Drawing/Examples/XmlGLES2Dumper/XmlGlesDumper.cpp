@@ -57,6 +57,10 @@
 #include "ExtDbModule.h"
 
 #include "TrVisRenderClient.h"
+#include "TrVisRendition.h"
+#include "TrVisMetafilePlayback.h"
+#include "TrVisMfStreamStats.h"
+#include "OdDToStr.h"
 
 #include "diagnostics.h"
 
@@ -144,6 +148,64 @@ public:
   }
 };
 
+/************************************************************************/
+/* Rendition filter which packs loaded metafiles into geometry blocks   */
+/* and reports draw calls and memory saved by packing. Metafiles are    */
+/* packed in order of loading, rejected metafiles complete current      */
+/* block since they are drawn between blocks.                           */
+/************************************************************************/
+
+class OdMetafilePackingRedir : public OdTrVisRenditionRedir
+{
+  OdTrVisMetafilePacker m_packer;
+  OdTrVisMetafileStreamStats m_stats;
+
+  struct DrawCallCounter : public OdTrVisPackedGeometryPlaybackCallback
+  {
+    OdUInt64 m_nDrawCalls, m_nPrimitives;
+    DrawCallCounter() : m_nDrawCalls(0), m_nPrimitives(0) { }
+    virtual bool metafilePackedDrawCall(const OdTrVisPackedGeometryBlock & /*block*/, OdTrVisGeomPrim primType,
+                                        OdUInt32 /*firstIndex*/, OdUInt32 nIndices)
+    {
+      m_nDrawCalls++;
+      m_nPrimitives += nIndices / ((primType == kTrVisTriangles) ? 3 : ((primType == kTrVisLines) ? 2 : 1));
+      return true;
+    }
+  };
+public:
+  OdMetafilePackingRedir() : m_packer(0.0) { }
+
+  void setup(OdTrVisRendition *pRendition, double tolerance)
+  {
+    setRedirections(pRendition);
+    m_packer.clear();
+    m_packer.setTolerance(tolerance);
+    m_stats.clearStats();
+  }
+
+  virtual OdTrVisDisplayId onMetafileAdded(OdTrVisMetafileId metafileId, const OdTrVisMetafileDef &pDef)
+  {
+    if (!pDef.m_pMetafile.isNull())
+    {
+      m_stats.startMetafileAnalyse(pDef.m_pMetafile.get());
+      if (!m_packer.addMetafile(pDef.m_pMetafile.get(), (OdUInt64)metafileId))
+        m_packer.finish();
+    }
+    return OdTrVisRenditionRedir::onMetafileAdded(metafileId, pDef);
+  }
+
+  OdString report()
+  {
+    m_packer.finish();
+    m_stats.addPackingStats(m_packer.stats());
+    DrawCallCounter counter;
+    OdTrVisPackedGeometryPlayback playback(&counter, OdTrVisMetafilePlayback::kPlayForDisplaying);
+    playback.playPacked(m_packer);
+    return m_stats.printStats() + OdString().format(OD_T("Packed playback: %llu draw calls, %llu primitives\n"),
+                                                    counter.m_nDrawCalls, counter.m_nPrimitives);
+  }
+};
+
 /************************************************************************/
 /* Define a module map for statically linked modules                    */
 /************************************************************************/
@@ -233,6 +295,8 @@ int main(int argc, char* argv[])
          bBlocksCache = false,
          useTTFCache = false,
          bSubentMarkers = false;
+    double packTolerance = -1.0; // packing of loaded metafiles is disabled
+    OdStaticRxObject<OdMetafilePackingRedir> packingRedir;
 
     /****************************************************************/
     /* Create the XmlGLES2 rendering device, and set the output     */
@@ -330,11 +394,15 @@ int main(int argc, char* argv[])
                                            OdString().format(L"%d", indexLayout).c_str(),
                                            L"0"); //L"%d"); // possible to split by size limit
         }
-        if (!pXmlParser->parse(sOutPathName, pRendition))
+        if (packTolerance >= 0.0)
+          packingRedir.setup(pRendition, packTolerance);
+        if (!pXmlParser->parse(sOutPathName, (packTolerance >= 0.0) ? &packingRedir : pRendition))
         {
           odPrintConsoleString(L"Xml parse error: %ls \n", pXmlParser->errorMessage().c_str());
           argc = 0; // pDevice = NULL;
         }
+        else if (packTolerance >= 0.0)
+          odPrintConsoleString(L"\n%ls", packingRedir.report().c_str());
         // do not it here to keep internal m_mapFakeDbStub in loader //pXmlParser = NULL;
         break;
 
@@ -402,6 +470,10 @@ int main(int argc, char* argv[])
         if (idxArg < argc)
           bSubentMarkers = !((sArg = argv[idxArg]).makeLower() == L"false" || sArg == L"0");
         break;
+      case L'a':
+        if (idxArg < argc)
+          packTolerance = odStrToD((sArg = argv[idxArg]).c_str());
+        break;
 
       case L'o': // open input DWG/DXF file
         if (bNothingToDump)
@@ -753,6 +825,8 @@ int main(int argc, char* argv[])
       odPrintConsoleString(L" -r true        to use subentity maRkers\n");
       odPrintConsoleString(L"      [-r false    - is default]\n");
       odPrintConsoleString(L" -l <input XML file to Load>\n");
+      odPrintConsoleString(L" -a <tolerance> to pAck metafiles of loaded XML file with maximal position error\n");
+      odPrintConsoleString(L"                and print packing statistics (must precede -l)\n");
       //odPrintConsoleString(L" -g <input LLG file to Load>\n");
       return 1;
     }
@@ -46,6 +46,7 @@
 namespace TD_COLLADA_IMPORT
 {
   class ExtraDataHandler;
+  struct StagedMesh;
 
   /** \details
     This class implements the document importer.
@@ -54,6 +55,9 @@ namespace TD_COLLADA_IMPORT
   {
     bool m_bConsoleOut;
     bool m_bImportTextures;
+    bool m_bParallelGeometry;
+    bool m_bWeldVertices;
+    bool m_bInstanceBlocks;
   public:
     /** Maps unique ids of framework images to the corresponding framework image.
     */
@@ -91,6 +95,9 @@ namespace TD_COLLADA_IMPORT
 
     typedef std::map<OdDbObjectId, COLLADAFW::String > ObjectObjectNameMap;
 
+    /** Geometries staged for conversion after the document is loaded.
+    */
+    typedef std::vector<StagedMesh*> StagedMeshArray;
 
     /** Pair of db entity's id and its instantiated material.
     */
@@ -135,6 +142,7 @@ namespace TD_COLLADA_IMPORT
     UniqueIdMaterialIdMap       m_UniqueIdMaterialIdMap;
                                  
     OdDbBlockTableRecordPtr     m_pTmpGeometryRecord;
+    StagedMeshArray             m_StagedMeshes;
 
     /** Disable default copy ctor. 
     */
@@ -144,7 +152,8 @@ namespace TD_COLLADA_IMPORT
     const DocumentImporter& operator= ( const DocumentImporter& pre );
 
   public:
-    DocumentImporter(const OdString &filepath, OdDbDatabase* m_pDatabase, bool bImportTextures, bool bConsoleOut);
+    DocumentImporter(const OdString &filepath, OdDbDatabase* m_pDatabase, bool bImportTextures, bool bConsoleOut,
+      bool bParallelGeometry = false, bool bWeldVertices = false, bool bInstanceBlocks = false);
 
     virtual ~DocumentImporter();
 
@@ -286,6 +295,8 @@ namespace TD_COLLADA_IMPORT
 
     const FileInfo& getFileInfo() const { return m_FileInfo; }
 
+    StagedMeshArray& getStagedMeshes() { return m_StagedMeshes; }
+
     friend class ImporterBase;
   };
 };
@@ -29,6 +29,8 @@
 #include "COLLADAFWMeshVertexData.h"
 #include "DbSubDMesh.h"
 #include "COLLADAFWGeometry.h"
+#include "Int32Array.h"
+#include "UInt32Array.h"
 
 
 /** \details
@@ -36,6 +38,47 @@
 */
 namespace TD_COLLADA_IMPORT
 {
+  /** \details
+    This structure keeps a mesh primitive copied from the framework mesh and its conversion results.
+  */
+  struct StagedMeshPrimitive
+  {
+    COLLADAFW::UniqueId m_uniqueId;
+    COLLADAFW::MaterialId m_materialId;
+    OdUInt32 m_faceCount;
+    OdInt32Array m_faceVertexCounts;   //empty for triangles
+    OdUInt32Array m_positionIndices;
+    OdUInt32Array m_normalIndices;
+    OdUInt32Array m_uvIndices;
+
+    //OdDbSubDMesh arrays
+    OdGePoint3dArray m_vertices;
+    OdInt32Array m_faces;
+    OdGeVector3dArray m_normals;
+    OdGePoint3dArray m_uvs;
+    bool m_bConverted;
+
+    StagedMeshPrimitive() : m_materialId(0), m_faceCount(0), m_bConverted(false) {}
+  };
+
+  /** \details
+    This structure keeps a mesh copied from the framework mesh, so it can be converted
+    after the document is loaded.
+  */
+  struct StagedMesh
+  {
+    COLLADAFW::UniqueId m_uniqueId;
+    OdGePoint3dArray m_positions;
+    OdGeVector3dArray m_normals;
+    OdGePoint3dArray m_uvs;
+    OdUInt32Array m_weldMap;           //index of the coincident position which replaces each position
+    std::vector<StagedMeshPrimitive> m_primitives;
+    OdUInt64 m_hash;                   //hash of the conversion results
+    const StagedMesh* m_pInstanceOf;   //identical mesh committed instead of this one
+
+    StagedMesh() : m_hash(0), m_pInstanceOf(NULL) {}
+  };
+
   /** \details
     This class implements the geometry importer.
   */
@@ -57,6 +100,25 @@ namespace TD_COLLADA_IMPORT
 
     bool importDbSubDMesh(const COLLADAFW::Mesh* pMesh);
 
+    /** Copies the framework mesh data which is needed for the conversion.
+    */
+    bool stageMesh(const COLLADAFW::Mesh* pMesh, StagedMesh& mesh);
+
+    /** Converts all primitives of the staged mesh into OdDbSubDMesh arrays.
+        Doesn't access the database, so different meshes can be converted concurrently.
+    */
+    static void convertStagedMesh(StagedMesh& mesh, bool bWeldVertices);
+
+    /** Creates OdDbSubDMesh entities from the converted mesh.
+    */
+    bool commitStagedMesh(StagedMesh& mesh);
+
+    /** Converts and commits all meshes staged by the document importer.
+    */
+    bool commitStagedMeshes();
+
+    static void clearStagedMeshes(DocumentImporter::StagedMeshArray& meshes);
+
     void importMeshPositions(const COLLADAFW::Mesh* pMesh, OdGePoint3dArray& positionsArray);
 
     void importMeshUVCoords(const COLLADAFW::Mesh* pMesh, int iSourceIndex, OdGePoint3dArray& vertexTextureArray);
@@ -66,6 +128,12 @@ namespace TD_COLLADA_IMPORT
     template<class NumberArray> 
     void setPolygonMeshUVVertices(const NumberArray& uvArray, size_t stride, size_t startPosition, OdUInt32 vertsCount, OdGePoint3dArray& vertexTextureArray );
 
+    static void weldPositions(StagedMesh& mesh);
+
+    static bool convertPrimitive(const StagedMesh& mesh, StagedMeshPrimitive& primitive);
+
+    static bool isSameGeometry(const StagedMesh& mesh1, const StagedMesh& mesh2);
+
     void fillPolygonMeshMapPerSet(const COLLADAFW::MeshVertexData& uvCoordinates, const COLLADAFW::MeshVertexData::InputInfosArray& inputInfos,
                                   size_t sourceIndex, OdGePoint3dArray& vertexTextureArray);
   };
@@ -46,6 +46,10 @@ namespace TD_COLLADA_IMPORT{
   // Documented properties are:
   // "Database"    - OdDbDatabase object, where dae is imported
   // "ColladaPath" - string, path to the imported dae file
+  // "ParallelGeometry" - bool, convert geometries concurrently using the thread pool service
+  // "WeldVertices"     - bool, merge coincident positions shared by mesh primitives
+  // "InstanceBlocks"   - bool, share identical geometries and import repeated geometry
+  //                      instances as references to a common block definition
 
      virtual OdRxDictionaryPtr properties() = 0;
   };
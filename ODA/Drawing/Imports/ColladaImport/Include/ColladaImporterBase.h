@@ -97,6 +97,14 @@ namespace TD_COLLADA_IMPORT
 
     const bool isImportTextures();
 
+    const bool isParallelGeometry();
+
+    const bool isWeldVertices();
+
+    const bool isInstanceBlocks();
+
+    DocumentImporter::StagedMeshArray& getStagedMeshes();
+
     const DocumentImporter::UniqueIdFWMaterialMap& getUniqueIdFWMaterialMap();
 
     typedef DocumentImporter::UniqueIdSubUniqueIdMultiMap::const_iterator SubUniqueIdIter;
@@ -70,6 +70,9 @@ namespace TD_COLLADA_IMPORT
     */
     bool importNodes(const COLLADAFW::NodePointerArray& nodeArray, InternalNode& parentImportNode);
 
+    template<class Instance>
+    void importInstance(Instance* instance, InternalNode& parentImportNode, void (SceneGraphCreator::*postProcess)(Instance*, OdDbObjectId, const COLLADAFW::UniqueId&) = NULL);
+
     template<class Instance>
     bool importInstances(const COLLADAFW::PointerArray<Instance>& instanceArray, InternalNode& parentImportNode, void (SceneGraphCreator::*postProcess)(Instance*, OdDbObjectId, const COLLADAFW::UniqueId&) = NULL);
 
@@ -84,6 +87,20 @@ namespace TD_COLLADA_IMPORT
 
     bool importInstanceNodes(const COLLADAFW::InstanceNodePointerArray& instanceNodeArray, InternalNode& parentImportNode);
 
+    /** Returns the unique id shared by all identical geometries.
+    */
+    COLLADAFW::UniqueId getGeometryKey(const COLLADAFW::UniqueId& uniqueId);
+
+    /** Counts instances of every geometry in the node hierarchy.
+    */
+    void countGeometryInstances(const COLLADAFW::NodePointerArray& nodeArray);
+
+    void countGeometryInstances(const COLLADAFW::Node* pNode);
+
+    /** Returns the block definition shared by instances with the same geometry and material bindings.
+    */
+    OdDbObjectId getInstanceBlock(COLLADAFW::InstanceGeometry* instanceGeometry);
+
     template<COLLADAFW::ClassId classId>
     void storeMaterialBinding(COLLADAFW::InstanceBindingBase<classId>* instanceGeometry, OdDbObjectId objId, const COLLADAFW::UniqueId& uniqueId)
     {
@@ -111,7 +128,13 @@ namespace TD_COLLADA_IMPORT
     }
 
   private:
+    typedef std::map<COLLADAFW::UniqueId, unsigned int> GeometryInstanceCountMap;
+    typedef std::vector<COLLADAFW::UniqueId> InstanceBlockKey; //geometry followed by bound materials
+    typedef std::map<InstanceBlockKey, OdDbObjectId> InstanceBlockMap;
+
     OdDbBlockTableRecordPtr pBTRTmp; //Temporary object. Optimization
+    GeometryInstanceCountMap m_geometryInstanceCounts;
+    InstanceBlockMap m_instanceBlocks;
     /** Disable default copy ctor. 
     */
     SceneGraphCreator(const SceneGraphCreator& pre);
@@ -66,11 +66,15 @@ void odPrint4Collada(const wchar_t* fmt, ...)
 
 namespace TD_COLLADA_IMPORT
 {
-  DocumentImporter::DocumentImporter(const OdString &filepath, OdDbDatabase* pDatabase, bool bImportTextures, bool bConsoleOut)
+  DocumentImporter::DocumentImporter(const OdString &filepath, OdDbDatabase* pDatabase, bool bImportTextures, bool bConsoleOut,
+    bool bParallelGeometry, bool bWeldVertices, bool bInstanceBlocks)
     : m_strImportFilePath(filepath)
     , m_pDatabase(pDatabase)
     , m_bImportTextures(bImportTextures)
     , m_bConsoleOut(bConsoleOut)
+    , m_bParallelGeometry(bParallelGeometry)
+    , m_bWeldVertices(bWeldVertices)
+    , m_bInstanceBlocks(bInstanceBlocks)
   {
     m_ExtraDataHandler = new ExtraDataHandler(this);    
   }
@@ -78,6 +82,7 @@ namespace TD_COLLADA_IMPORT
   DocumentImporter::~DocumentImporter()
   {
     delete m_ExtraDataHandler; 
+    GeometryImporter::clearStagedMeshes(m_StagedMeshes);
   }
 
   bool DocumentImporter::createSceneGraph()
@@ -117,6 +122,17 @@ namespace TD_COLLADA_IMPORT
       m_pTmpGeometryRecord->erase();
       return false;
     }
+
+    //Geometries staged during loading are converted (concurrently if requested) and committed in document order
+    if (!m_StagedMeshes.empty())
+    {
+      GeometryImporter geometryImporter(this);
+      if (!geometryImporter.commitStagedMeshes())
+      {
+        m_pTmpGeometryRecord->erase();
+        return false;
+      }
+    }
       
     if (!createSceneGraph())
     {
@@ -29,6 +29,10 @@
 #include "COLLADAFWUniqueId.h"
 #include "ColladaDocumentImporter.h"
 #include "ColladaGeometryImporter.h"
+#include "RxThreadPoolService.h"
+#include "DynamicLinker.h"
+#include "StaticRxObject.h"
+#include <algorithm>
 
 
 namespace TD_COLLADA_IMPORT
@@ -68,7 +72,20 @@ namespace TD_COLLADA_IMPORT
       const_cast<COLLADAFW::Mesh*>(pMesh)->getTristripsTriangleCount() > 0 ||
       const_cast<COLLADAFW::Mesh*>(pMesh)->getTrifansTriangleCount() > 0)
     {
-      bSuccess = importDbSubDMesh(pMesh);
+      if (isParallelGeometry() || isInstanceBlocks())
+      {
+        //framework mesh is destroyed after this call, so the data is copied and converted after loading
+        StagedMesh* pStagedMesh = new StagedMesh;
+        bSuccess = stageMesh(pMesh, *pStagedMesh);
+        if (bSuccess)
+          getStagedMeshes().push_back(pStagedMesh);
+        else
+          delete pStagedMesh;
+      }
+      else
+      {
+        bSuccess = importDbSubDMesh(pMesh);
+      }
     }
 
     return bSuccess;
@@ -76,196 +93,440 @@ namespace TD_COLLADA_IMPORT
 
   bool GeometryImporter::importDbSubDMesh(const COLLADAFW::Mesh* pMesh)
   {
-    OdResult res = eOk;
-    OdDbBlockTableRecordPtr pBTR = this->getDocumentImporter()->getGeometryTmpBTR();
+    StagedMesh mesh;
+    if (!stageMesh(pMesh, mesh))
+      return false;
+    convertStagedMesh(mesh, isWeldVertices());
+    return commitStagedMesh(mesh);
+  }
 
-    OdGePoint3dArray positionsMeshArray;
-    importMeshPositions(pMesh, positionsMeshArray);
-    ODA_ASSERT(positionsMeshArray.size() > 0);
-    if (positionsMeshArray.size() == 0)
+  template<class ValuesArray, class OdArrayType>
+  static void copyValues(const ValuesArray& values, OdArrayType& array)
+  {
+    array.resize(OdUInt32(values.getCount()));
+    if (!array.isEmpty())
+      ::memcpy(array.asArrayPtr(), values.getData(), array.size() * sizeof(array[0]));
+  }
+
+  bool GeometryImporter::stageMesh(const COLLADAFW::Mesh* pMesh, StagedMesh& mesh)
+  {
+    mesh.m_uniqueId = pMesh->getUniqueId();
+    importMeshPositions(pMesh, mesh.m_positions);
+    ODA_ASSERT(mesh.m_positions.size() > 0);
+    if (mesh.m_positions.size() == 0)
       return false;
 
-    OdGeVector3dArray vertexNormalsMeshArray;
-    importMeshNormals(pMesh, vertexNormalsMeshArray);
+    importMeshNormals(pMesh, mesh.m_normals);
 
     //TODO: should we read colors?
 
-    OdGePoint3dArray vertexTextureMeshArray;
     int sourceIndex = 0; //It should be tested when several images are in a material.
-    importMeshUVCoords(pMesh, sourceIndex, vertexTextureMeshArray);
-
-    std::vector<OdUInt32> usedPositionsIdx;
+    importMeshUVCoords(pMesh, sourceIndex, mesh.m_uvs);
 
     const COLLADAFW::MeshPrimitiveArray& meshPrimitiveArray = pMesh->getMeshPrimitives();
     size_t primitiveMeshCount = meshPrimitiveArray.getCount();
+    mesh.m_primitives.reserve(primitiveMeshCount);
     for (size_t idxPrimitiveMesh = 0; idxPrimitiveMesh < primitiveMeshCount; ++idxPrimitiveMesh)
     {
       const COLLADAFW::MeshPrimitive* meshPrimitive = meshPrimitiveArray[idxPrimitiveMesh];
       if (!meshPrimitive)
         continue;
-      OdDbSubDMeshPtr pSubDMesh = OdDbSubDMesh::createObject();
-      pSubDMesh->setDatabaseDefaults(pBTR->database());
-      OdDbObjectId objId = pBTR->appendOdDbEntity(pSubDMesh);
 
       COLLADAFW::MeshPrimitive::PrimitiveType type = meshPrimitive->getPrimitiveType();
       //TODO: implement other cases, e.g. LINES
       if (type == COLLADAFW::MeshPrimitive::TRIANGLE_STRIPS || type == COLLADAFW::MeshPrimitive::TRIANGLE_FANS)
       {
         ODA_FAIL(); //detect this case.
+        continue;
       }
-      else if (type == COLLADAFW::MeshPrimitive::TRIANGLES || type == COLLADAFW::MeshPrimitive::POLYGONS)
+      if (type != COLLADAFW::MeshPrimitive::TRIANGLES && type != COLLADAFW::MeshPrimitive::POLYGONS)
+        continue;
+
+      const COLLADAFW::UIntValuesArray& positionIndices = meshPrimitive->getPositionIndices();
+      if (positionIndices.getCount() == 0 && primitiveMeshCount > 1)
       {
-        const COLLADAFW::UIntValuesArray& positionIndices = meshPrimitive->getPositionIndices();
-        const COLLADAFW::UIntValuesArray& normalIndices = meshPrimitive->getNormalIndices();
-        const COLLADAFW::IndexListArray& uvIndexArray = meshPrimitive->getUVCoordIndicesArray();
-        const COLLADAFW::UIntValuesArray* uvIndices = NULL;
-        if (uvIndexArray.getCount() > 0)
-          uvIndices = &uvIndexArray[sourceIndex]->getIndices();
-
-        size_t faceCount = meshPrimitive->getFaceCount();
-
-        //prepare arrays for OdDbSubDMesh
-        //all of them are either copies of the global corresponding array
-        //or are created from the global array through indices
-        OdInt32Array faceArray;
-        faceArray.reserve(OdUInt32(faceCount));
-        OdGePoint3dArray vertexArray;
-        if (positionIndices.getCount() > 0)
-        {
-          vertexArray.reserve(OdUInt32(odmin(positionsMeshArray.size(), positionIndices.getCount())));
-        }
-        else if (primitiveMeshCount == 1)
-        {
-          vertexArray = positionsMeshArray;
-        }
-        else
-        {
-          //can there be multiple primitive meshes and no indices?
-          ODA_FAIL();
-          return false;
-        }
+        //can there be multiple primitive meshes and no indices?
+        ODA_FAIL();
+        return false;
+      }
+
+      mesh.m_primitives.push_back(StagedMeshPrimitive());
+      StagedMeshPrimitive& primitive = mesh.m_primitives.back();
+      primitive.m_uniqueId = meshPrimitive->getUniqueId();
+      primitive.m_materialId = meshPrimitive->getMaterialId();
+      primitive.m_faceCount = OdUInt32(meshPrimitive->getFaceCount());
+      copyValues(positionIndices, primitive.m_positionIndices);
+      if (!mesh.m_normals.isEmpty())
+        copyValues(meshPrimitive->getNormalIndices(), primitive.m_normalIndices);
+      const COLLADAFW::IndexListArray& uvIndexArray = meshPrimitive->getUVCoordIndicesArray();
+      if (!mesh.m_uvs.isEmpty() && uvIndexArray.getCount() > 0)
+        copyValues(uvIndexArray[sourceIndex]->getIndices(), primitive.m_uvIndices);
+      if (type == COLLADAFW::MeshPrimitive::POLYGONS)
+        copyValues(static_cast<const COLLADAFW::Polygons*>(meshPrimitive)->getGroupedVerticesVertexCountArray(), primitive.m_faceVertexCounts);
+    }
+    return true;
+  }
 
-        OdGeVector3dArray vertexNormalsArray;
-        if (vertexNormalsMeshArray.size() > 0)
+  struct PositionLess
+  {
+    const OdGePoint3d* m_pPositions;
+    PositionLess(const OdGePoint3d* pPositions) : m_pPositions(pPositions) {}
+    bool operator()(OdUInt32 i1, OdUInt32 i2) const
+    {
+      const OdGePoint3d& p1 = m_pPositions[i1];
+      const OdGePoint3d& p2 = m_pPositions[i2];
+      if (p1.x != p2.x) return p1.x < p2.x;
+      if (p1.y != p2.y) return p1.y < p2.y;
+      if (p1.z != p2.z) return p1.z < p2.z;
+      return i1 < i2;
+    }
+  };
+
+  void GeometryImporter::weldPositions(StagedMesh& mesh)
+  {
+    //exporters often duplicate positions for every primitive (or every normal), so coincident positions
+    //are replaced by the first one. Coordinates are compared exactly, there is no tolerance here.
+    const OdUInt32 nPositions = mesh.m_positions.size();
+    const OdGePoint3d* pPositions = mesh.m_positions.getPtr();
+    std::vector<OdUInt32> order(nPositions);
+    for (OdUInt32 idxPosition = 0; idxPosition < nPositions; ++idxPosition)
+      order[idxPosition] = idxPosition;
+    std::sort(order.begin(), order.end(), PositionLess(pPositions));
+
+    mesh.m_weldMap.resize(nPositions);
+    OdUInt32* pWeldMap = mesh.m_weldMap.asArrayPtr();
+    for (OdUInt32 idxOrder = 0; idxOrder < nPositions; ++idxOrder)
+    {
+      const OdUInt32 idxPosition = order[idxOrder];
+      if (idxOrder > 0)
+      {
+        const OdGePoint3d& pt = pPositions[idxPosition];
+        const OdGePoint3d& ptPrev = pPositions[order[idxOrder - 1]];
+        if (pt.x == ptPrev.x && pt.y == ptPrev.y && pt.z == ptPrev.z)
         {
-          //indices may be present only for some of primitive meshes
-          if (normalIndices.getCount() > 0)
-          {
-            vertexNormalsArray.reserve(OdUInt32(vertexArray.size()));
-          }
-          else if (primitiveMeshCount == 1)
-          {
-            //this is theoretical case where indices are implicitly 0, 1, 2, ...
-            vertexNormalsArray = vertexNormalsMeshArray;
-          }
+          pWeldMap[idxPosition] = pWeldMap[order[idxOrder - 1]];
+          continue;
         }
+      }
+      pWeldMap[idxPosition] = idxPosition;
+    }
+  }
+
+  bool GeometryImporter::convertPrimitive(const StagedMesh& mesh, StagedMeshPrimitive& primitive)
+  {
+    const OdUInt32 faceCount = primitive.m_faceCount;
+    const OdInt32* pFaceVertexCounts = NULL;
+    if (!primitive.m_faceVertexCounts.isEmpty())
+    {
+      if (primitive.m_faceVertexCounts.size() < faceCount)
+        return false;
+      pFaceVertexCounts = primitive.m_faceVertexCounts.getPtr();
+    }
+
+    //sizes of all arrays are known before the faces are walked
+    OdUInt32 cornerCount = 0;
+    for (OdUInt32 idxFace = 0; idxFace < faceCount; ++idxFace)
+    {
+      //holes are marked with negative numbers
+      cornerCount += pFaceVertexCounts ? OdUInt32(Od_abs(pFaceVertexCounts[idxFace])) : 3;
+    }
+
+    const OdUInt32 positionCount = mesh.m_positions.size();
+    const bool bIndexed = !primitive.m_positionIndices.isEmpty();
+    if (bIndexed ? primitive.m_positionIndices.size() < cornerCount : positionCount < cornerCount)
+      return false;
+    const bool bNormals = primitive.m_normalIndices.size() >= cornerCount && cornerCount > 0;
+    const bool bUVs = primitive.m_uvIndices.size() >= cornerCount && cornerCount > 0;
+
+    const OdGePoint3d* pPositions = mesh.m_positions.getPtr();
+    const OdGeVector3d* pMeshNormals = mesh.m_normals.getPtr();
+    const OdGePoint3d* pMeshUVs = mesh.m_uvs.getPtr();
+    const OdUInt32* pPositionIndices = primitive.m_positionIndices.getPtr();
+    const OdUInt32* pNormalIndices = primitive.m_normalIndices.getPtr();
+    const OdUInt32* pUVIndices = primitive.m_uvIndices.getPtr();
+    const OdUInt32* pWeldMap = mesh.m_weldMap.isEmpty() ? NULL : mesh.m_weldMap.getPtr();
+
+    primitive.m_faces.resize(faceCount + cornerCount);
+    OdInt32* pFaces = primitive.m_faces.asArrayPtr();
+    primitive.m_vertices.clear();
+    primitive.m_normals.clear();
+    primitive.m_uvs.clear();
+    if (bIndexed)
+    {
+      primitive.m_vertices.reserve(odmin(positionCount, cornerCount));
+      if (bNormals)
+        primitive.m_normals.reserve(primitive.m_vertices.physicalLength());
+      if (bUVs)
+        primitive.m_uvs.reserve(primitive.m_vertices.physicalLength());
+    }
+    else
+    {
+      //OdArray buffer is shared, so this isn't a copy
+      primitive.m_vertices = mesh.m_positions;
+      //this is theoretical case where indices are implicitly 0, 1, 2, ...
+      if (!bNormals && mesh.m_primitives.size() == 1)
+        primitive.m_normals = mesh.m_normals;
+      if (!bUVs && mesh.m_primitives.size() == 1)
+        primitive.m_uvs = mesh.m_uvs;
+    }
+
+    const static OdUInt32 INVALID_POS = ~1;
+    std::vector<OdUInt32> usedPositionsIdx(bIndexed ? positionCount : 0, INVALID_POS);
 
-        OdGePoint3dArray textureUvArray;
-        if (vertexTextureMeshArray.size() > 0)
+    OdUInt32 idxCorner = 0;
+    for (OdUInt32 idxFace = 0; idxFace < faceCount; ++idxFace)
+    {
+      const OdUInt32 faceVertexCount = pFaceVertexCounts ? OdUInt32(Od_abs(pFaceVertexCounts[idxFace])) : 3;
+      *pFaces++ = OdInt32(faceVertexCount);
+      for (OdUInt32 idxFaceVertex = 0; idxFaceVertex < faceVertexCount; ++idxFaceVertex, ++idxCorner)
+      {
+        //set vertex positions
+        bool newVertex = true;
+        OdUInt32 vertexIdx = idxCorner;
+        if (bIndexed)
         {
-          //indices may be present only for some of primitive meshes
-          if (uvIndices)
+          OdUInt32 positionIdx = pPositionIndices[idxCorner];
+          if (positionIdx >= positionCount)
+            return false;
+          if (pWeldMap)
+            positionIdx = pWeldMap[positionIdx];
+          if (usedPositionsIdx[positionIdx] != INVALID_POS)
           {
-            textureUvArray.reserve(OdUInt32(vertexArray.size()));
-            textureUvArray.clear();
+            vertexIdx = usedPositionsIdx[positionIdx];
+            newVertex = false;
           }
-          else if (primitiveMeshCount == 1)
+          else
           {
-            //this is theoretical case where indices are implicitly 0, 1, 2, ...
-            textureUvArray = vertexTextureMeshArray;
+            vertexIdx = primitive.m_vertices.size();
+            primitive.m_vertices.push_back(pPositions[positionIdx]);
+            usedPositionsIdx[positionIdx] = vertexIdx;
           }
         }
+        *pFaces++ = OdInt32(vertexIdx);
 
-        const static OdUInt32 INVALID_POS = ~1;
-        usedPositionsIdx.assign(positionsMeshArray.size(), INVALID_POS);
-
-        const COLLADAFW::IntValuesArray* faceVertexCountArray = NULL;
-        if (type == COLLADAFW::MeshPrimitive::POLYGONS)
-          faceVertexCountArray = &static_cast<const COLLADAFW::Polygons*>(meshPrimitive)->getGroupedVerticesVertexCountArray();
-
-        //fill OdDbSubDMesh arrays
-        size_t idxPrimitiveMeshVertex = 0;
-        for (size_t idxCurrentFace = 0; idxCurrentFace < faceCount; ++idxCurrentFace)
+        //set normals
+        if (bNormals)
         {
-          //holes are marked with negative numbers
-          int faceVertexCount = faceVertexCountArray ? Od_abs((*faceVertexCountArray)[idxCurrentFace]) : 3;
-          faceArray.append(faceVertexCount);
-          for (int idxFaceVertex = 0; idxFaceVertex < faceVertexCount; ++idxFaceVertex, ++idxPrimitiveMeshVertex)
+          const OdUInt32 normalIdx = pNormalIndices[idxCorner];
+          if (normalIdx >= mesh.m_normals.size())
+            return false;
+          const OdGeVector3d& normal = pMeshNormals[normalIdx];
+          if (newVertex)
+            primitive.m_normals.push_back(normal);
+          else
           {
-            //set vertex positions
-            OdUInt32 positionIdx = positionIndices[idxPrimitiveMeshVertex];
-            bool newVertex = true;
-            OdUInt32 vertexIdx;
-            if (positionIndices.getCount() > 0)
-            {
-              if (usedPositionsIdx[positionIdx] != INVALID_POS)
-              {
-                vertexIdx = usedPositionsIdx[positionIdx];
-                newVertex = false;
-              }
-              else
-              {
-                vertexIdx = vertexArray.append(positionsMeshArray[positionIdx]);
-                usedPositionsIdx[positionIdx] = vertexIdx;
-              }
-              faceArray.append(vertexIdx);
-            }
-            else
-              faceArray.append(OdUInt32(idxPrimitiveMeshVertex));
-
-            //set normals
-            if (vertexNormalsMeshArray.size() > 0 && normalIndices.getCount() > 0)
-            {
-              OdUInt32 normalIdx = normalIndices[idxPrimitiveMeshVertex];
-              const OdGeVector3d& normal = vertexNormalsMeshArray[normalIdx];
-              if (newVertex)
-                vertexNormalsArray.append(normal);
-              else
-              {
-                OdGeVector3d newNormal = vertexNormalsArray[vertexIdx] + normal;
-                //OdDbSubDMesh doesn't support face normals. Vertex normals can sometimes be zero if face normals are opposed
-                //Thus, there may be problems with 2 sided planes...
-                if (!newNormal.isZeroLength())
-                  vertexNormalsArray[vertexIdx] = newNormal;
-              }
-            }
-
-            //read and set texture uv coordinates
-            //I assume that if vertex is met multiple times, its texture uvCoords are the same, so I take only first uvCoord
-            if (newVertex && vertexTextureMeshArray.size() > 0 && uvIndices)
-            {
-              OdUInt32 uvIdx = (*uvIndices)[idxPrimitiveMeshVertex];
-              textureUvArray.append(vertexTextureMeshArray[uvIdx]);
-            }
+            OdGeVector3d newNormal = primitive.m_normals[vertexIdx] + normal;
+            //OdDbSubDMesh doesn't support face normals. Vertex normals can sometimes be zero if face normals are opposed
+            //Thus, there may be problems with 2 sided planes...
+            if (!newNormal.isZeroLength())
+              primitive.m_normals[vertexIdx] = newNormal;
           }
         }
-        OdResult res = pSubDMesh->setSubDMesh(vertexArray, faceArray, 0);
-        if (eOk == res && vertexNormalsArray.size() > 0)
-        {
-          OdGeVector3d* vertexNormalsPtr = vertexNormalsArray.asArrayPtr();
-          //OdDbSubDMesh should normalize vectors but it doesn't, so we do it ourselves.
-          //After .dwg -> .dae export by ODA normals can become zero (why?) so we should avoid exceptions here
-          for (OdUInt32 idxNormal = 0; idxNormal < vertexNormalsArray.size(); ++idxNormal)
-            vertexNormalsPtr[idxNormal].normalizeGetLength();
-          res = pSubDMesh->setVertexNormalArray(vertexNormalsArray);
-        }
-        if (eOk == res && textureUvArray.size() > 0)
-        {
-          res = pSubDMesh->setVertexTextureArray(textureUvArray);
-        }
 
-        if (eOk == res)
+        //read and set texture uv coordinates
+        //I assume that if vertex is met multiple times, its texture uvCoords are the same, so I take only first uvCoord
+        if (newVertex && bUVs)
         {
-          handleObjectReferences(meshPrimitive, objId, meshPrimitive->getMaterialId());
-          addUniqueIdSubUniqueIdPair(pMesh->getUniqueId(), meshPrimitive->getUniqueId());
+          const OdUInt32 uvIdx = pUVIndices[idxCorner];
+          if (uvIdx >= mesh.m_uvs.size())
+            return false;
+          primitive.m_uvs.push_back(pMeshUVs[uvIdx]);
         }
-        else
+      }
+    }
+
+    //OdDbSubDMesh should normalize vectors but it doesn't, so we do it ourselves.
+    //After .dwg -> .dae export by ODA normals can become zero (why?) so we should avoid exceptions here
+    if (!primitive.m_normals.isEmpty())
+    {
+      OdGeVector3d* vertexNormalsPtr = primitive.m_normals.asArrayPtr();
+      for (OdUInt32 idxNormal = 0; idxNormal < primitive.m_normals.size(); ++idxNormal)
+        vertexNormalsPtr[idxNormal].normalizeGetLength();
+    }
+    return true;
+  }
+
+  static void hashBytes(OdUInt64& hash, const void* pData, size_t nBytes)
+  {
+    //FNV-1a
+    const OdUInt8* pBytes = static_cast<const OdUInt8*>(pData);
+    for (size_t idxByte = 0; idxByte < nBytes; ++idxByte)
+    {
+      hash ^= pBytes[idxByte];
+      hash *= 0x100000001B3ULL;
+    }
+  }
+
+  template<class OdArrayType>
+  static void hashArray(OdUInt64& hash, const OdArrayType& array)
+  {
+    const OdUInt32 nSize = array.size();
+    hashBytes(hash, &nSize, sizeof(nSize));
+    if (nSize)
+      hashBytes(hash, array.getPtr(), nSize * sizeof(array[0]));
+  }
+
+  template<class OdArrayType>
+  static bool isSameArray(const OdArrayType& array1, const OdArrayType& array2)
+  {
+    return array1.size() == array2.size() &&
+      (array1.isEmpty() || !::memcmp(array1.getPtr(), array2.getPtr(), array1.size() * sizeof(array1[0])));
+  }
+
+  void GeometryImporter::convertStagedMesh(StagedMesh& mesh, bool bWeldVertices)
+  {
+    if (bWeldVertices)
+      weldPositions(mesh);
+    mesh.m_hash = 0xCBF29CE484222325ULL;
+    for (size_t idxPrimitive = 0; idxPrimitive < mesh.m_primitives.size(); ++idxPrimitive)
+    {
+      StagedMeshPrimitive& primitive = mesh.m_primitives[idxPrimitive];
+      primitive.m_bConverted = convertPrimitive(mesh, primitive);
+      hashBytes(mesh.m_hash, &primitive.m_materialId, sizeof(primitive.m_materialId));
+      hashArray(mesh.m_hash, primitive.m_vertices);
+      hashArray(mesh.m_hash, primitive.m_faces);
+      hashArray(mesh.m_hash, primitive.m_normals);
+      hashArray(mesh.m_hash, primitive.m_uvs);
+    }
+  }
+
+  bool GeometryImporter::isSameGeometry(const StagedMesh& mesh1, const StagedMesh& mesh2)
+  {
+    if (mesh1.m_hash != mesh2.m_hash || mesh1.m_primitives.size() != mesh2.m_primitives.size())
+      return false;
+    for (size_t idxPrimitive = 0; idxPrimitive < mesh1.m_primitives.size(); ++idxPrimitive)
+    {
+      const StagedMeshPrimitive& primitive1 = mesh1.m_primitives[idxPrimitive];
+      const StagedMeshPrimitive& primitive2 = mesh2.m_primitives[idxPrimitive];
+      if (!primitive1.m_bConverted || !primitive2.m_bConverted ||
+          primitive1.m_materialId != primitive2.m_materialId ||
+          !isSameArray(primitive1.m_vertices, primitive2.m_vertices) ||
+          !isSameArray(primitive1.m_faces, primitive2.m_faces) ||
+          !isSameArray(primitive1.m_normals, primitive2.m_normals) ||
+          !isSameArray(primitive1.m_uvs, primitive2.m_uvs))
+        return false;
+    }
+    return true;
+  }
+
+  bool GeometryImporter::commitStagedMesh(StagedMesh& mesh)
+  {
+    if (mesh.m_pInstanceOf)
+    {
+      //instances of identical geometry share entities (and block definition) of the first one
+      for (size_t idxPrimitive = 0; idxPrimitive < mesh.m_pInstanceOf->m_primitives.size(); ++idxPrimitive)
+        addUniqueIdSubUniqueIdPair(mesh.m_uniqueId, mesh.m_pInstanceOf->m_primitives[idxPrimitive].m_uniqueId);
+      return true;
+    }
+
+    OdDbBlockTableRecordPtr pBTR = this->getDocumentImporter()->getGeometryTmpBTR();
+    for (size_t idxPrimitive = 0; idxPrimitive < mesh.m_primitives.size(); ++idxPrimitive)
+    {
+      StagedMeshPrimitive& primitive = mesh.m_primitives[idxPrimitive];
+      if (!primitive.m_bConverted)
+        return false;
+
+      OdDbSubDMeshPtr pSubDMesh = OdDbSubDMesh::createObject();
+      pSubDMesh->setDatabaseDefaults(pBTR->database());
+      OdDbObjectId objId = pBTR->appendOdDbEntity(pSubDMesh);
+
+      OdResult res = pSubDMesh->setSubDMesh(primitive.m_vertices, primitive.m_faces, 0);
+      if (eOk == res && primitive.m_normals.size() > 0)
+      {
+        res = pSubDMesh->setVertexNormalArray(primitive.m_normals);
+      }
+      if (eOk == res && primitive.m_uvs.size() > 0)
+      {
+        res = pSubDMesh->setVertexTextureArray(primitive.m_uvs);
+      }
+
+      if (eOk == res)
+      {
+        addUniqueIdOdDbObjectIdPair(primitive.m_uniqueId, objId);
+        addUniqueIdMaterialIdPair(primitive.m_uniqueId, primitive.m_materialId);
+        addUniqueIdSubUniqueIdPair(mesh.m_uniqueId, primitive.m_uniqueId);
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /** \details
+    Converts staged meshes in the thread pool threads.
+  */
+  class StagedMeshConverter : public OdApcAtom
+  {
+  public:
+    StagedMesh** m_pMeshes;
+    bool m_bWeldVertices;
+
+    StagedMeshConverter() : m_pMeshes(NULL), m_bWeldVertices(false) {}
+    void apcEntryPoint(OdApcParamType idxMesh)
+    {
+      GeometryImporter::convertStagedMesh(*m_pMeshes[(size_t)idxMesh], m_bWeldVertices);
+    }
+  };
+
+  bool GeometryImporter::commitStagedMeshes()
+  {
+    DocumentImporter::StagedMeshArray& meshes = getStagedMeshes();
+    const bool bWeldVertices = isWeldVertices();
+
+    //conversion doesn't touch the database, so meshes are converted concurrently
+    OdRxThreadPoolServicePtr pThreadPool;
+    if (isParallelGeometry() && meshes.size() > 1)
+      pThreadPool = ::odrxDynamicLinker()->getModule(OdThreadPoolModuleName);
+    if (!pThreadPool.isNull())
+    {
+      OdStaticRxObject<StagedMeshConverter> converter;
+      converter.m_pMeshes = &meshes.front();
+      converter.m_bWeldVertices = bWeldVertices;
+      OdApcQueuePtr pQueue = pThreadPool->newMTQueue(ThreadsCounter::kNoAttributes, 0, kMtQueueAllowExecByMain);
+      for (size_t idxMesh = 0; idxMesh < meshes.size(); ++idxMesh)
+        pQueue->addEntryPoint(&converter, (OdApcParamType)idxMesh);
+      pQueue->wait();
+    }
+    else
+    {
+      for (size_t idxMesh = 0; idxMesh < meshes.size(); ++idxMesh)
+        convertStagedMesh(*meshes[idxMesh], bWeldVertices);
+    }
+
+    //identical geometries (often written by exporters for every instance) are committed once
+    if (isInstanceBlocks())
+    {
+      typedef std::multimap<OdUInt64, const StagedMesh*> HashMeshMap;
+      HashMeshMap committedMeshes;
+      for (size_t idxMesh = 0; idxMesh < meshes.size(); ++idxMesh)
+      {
+        StagedMesh& mesh = *meshes[idxMesh];
+        std::pair<HashMeshMap::const_iterator, HashMeshMap::const_iterator> range = committedMeshes.equal_range(mesh.m_hash);
+        for (HashMeshMap::const_iterator it = range.first; it != range.second && !mesh.m_pInstanceOf; ++it)
         {
-          return false;
+          if (isSameGeometry(*it->second, mesh))
+            mesh.m_pInstanceOf = it->second;
         }
+        if (!mesh.m_pInstanceOf)
+          committedMeshes.insert(std::make_pair(mesh.m_hash, &mesh));
       }
     }
-    return true;
+
+    //database objects are created in the document order
+    bool bSuccess = true;
+    for (size_t idxMesh = 0; idxMesh < meshes.size() && bSuccess; ++idxMesh)
+      bSuccess = commitStagedMesh(*meshes[idxMesh]);
+    clearStagedMeshes(meshes);
+    return bSuccess;
+  }
+
+  void GeometryImporter::clearStagedMeshes(DocumentImporter::StagedMeshArray& meshes)
+  {
+    for (size_t idxMesh = 0; idxMesh < meshes.size(); ++idxMesh)
+      delete meshes[idxMesh];
+    meshes.clear();
   }
 
 
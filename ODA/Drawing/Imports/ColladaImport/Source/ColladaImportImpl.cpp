@@ -36,17 +36,26 @@ namespace TD_COLLADA_IMPORT{
     ODRX_DECLARE_PROPERTY(ColladaPath)
     ODRX_DECLARE_PROPERTY(ImportTextures)
     ODRX_DECLARE_PROPERTY(ConsoleInfo)
+    ODRX_DECLARE_PROPERTY(ParallelGeometry)
+    ODRX_DECLARE_PROPERTY(WeldVertices)
+    ODRX_DECLARE_PROPERTY(InstanceBlocks)
 
     ODRX_DEFINE_PROPERTY_OBJECT(Database, ColladaProperties, get_Database, put_Database, OdDbDatabase)
     ODRX_DEFINE_PROPERTY(ColladaPath, ColladaProperties, getString)
     ODRX_DEFINE_PROPERTY(ImportTextures, ColladaProperties, getBool)
     ODRX_DEFINE_PROPERTY(ConsoleInfo, ColladaProperties, getBool)
+    ODRX_DEFINE_PROPERTY(ParallelGeometry, ColladaProperties, getBool)
+    ODRX_DEFINE_PROPERTY(WeldVertices, ColladaProperties, getBool)
+    ODRX_DEFINE_PROPERTY(InstanceBlocks, ColladaProperties, getBool)
 
     ODRX_BEGIN_DYNAMIC_PROPERTY_MAP(ColladaProperties);
     ODRX_GENERATE_PROPERTY(Database)
     ODRX_GENERATE_PROPERTY(ColladaPath)
     ODRX_GENERATE_PROPERTY(ImportTextures)
     ODRX_GENERATE_PROPERTY(ConsoleInfo)
+    ODRX_GENERATE_PROPERTY(ParallelGeometry)
+    ODRX_GENERATE_PROPERTY(WeldVertices)
+    ODRX_GENERATE_PROPERTY(InstanceBlocks)
     ODRX_END_DYNAMIC_PROPERTY_MAP(ColladaProperties);
 
 class ColladaImportCommand : public OdEdCommand
@@ -125,7 +134,8 @@ OdColladaImport::ImportResult OdColladaImportImpl::import()
   m_database->closeInput();  // some problems (with viewport) in case that db was open partially
 
   DocumentImporter cldImporter(m_properties->get_ColladaPath(), dynamic_cast<OdDbDatabase*>(m_properties->get_Database().get()), 
-    m_properties->get_ImportTextures(), m_properties->get_ConsoleInfo());
+    m_properties->get_ImportTextures(), m_properties->get_ConsoleInfo(),
+    m_properties->get_ParallelGeometry(), m_properties->get_WeldVertices(), m_properties->get_InstanceBlocks());
   try
   {
     return cldImporter.import() ? OdColladaImport::success : OdColladaImport::fail;
@@ -43,6 +43,9 @@ class ColladaProperties : public OdRxDispatchImpl<>
   OdDbDatabasePtr m_database;
   bool m_bImportTextures;
   bool m_bConsoleInfo;
+  bool m_bParallelGeometry;
+  bool m_bWeldVertices;
+  bool m_bInstanceBlocks;
   //OdSmartPtr<OdEdUserIO> m_pUserIO;
   //OdStreamBufPtr m_stream;
 public:
@@ -50,6 +53,9 @@ public:
   {
     m_bImportTextures = false;
     m_bConsoleInfo   = false;
+    m_bParallelGeometry = false;
+    m_bWeldVertices   = false;
+    m_bInstanceBlocks = false;
   }
   ODRX_DECLARE_DYNAMIC_PROPERTY_MAP( ColladaProperties );
   static OdRxDictionaryPtr createObject();
@@ -62,6 +68,12 @@ public:
   void put_ImportTextures( bool bVal ) { m_bImportTextures = bVal; }
   bool get_ConsoleInfo() const         { return m_bConsoleInfo; }
   void put_ConsoleInfo( bool bVal )    { m_bConsoleInfo = bVal; }
+  bool get_ParallelGeometry() const    { return m_bParallelGeometry; }
+  void put_ParallelGeometry( bool bVal ) { m_bParallelGeometry = bVal; }
+  bool get_WeldVertices() const        { return m_bWeldVertices; }
+  void put_WeldVertices( bool bVal )   { m_bWeldVertices = bVal; }
+  bool get_InstanceBlocks() const      { return m_bInstanceBlocks; }
+  void put_InstanceBlocks( bool bVal ) { m_bInstanceBlocks = bVal; }
 };
 typedef OdSmartPtr<ColladaProperties> ColladaPropertiesPtr;
 
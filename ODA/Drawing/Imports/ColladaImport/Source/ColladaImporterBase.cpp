@@ -199,4 +199,24 @@ namespace TD_COLLADA_IMPORT
   {
     return m_DocumentImporter->m_bImportTextures;
   }
+
+  const bool ImporterBase::isParallelGeometry()
+  {
+    return m_DocumentImporter->m_bParallelGeometry;
+  }
+
+  const bool ImporterBase::isWeldVertices()
+  {
+    return m_DocumentImporter->m_bWeldVertices;
+  }
+
+  const bool ImporterBase::isInstanceBlocks()
+  {
+    return m_DocumentImporter->m_bInstanceBlocks;
+  }
+
+  DocumentImporter::StagedMeshArray& ImporterBase::getStagedMeshes()
+  {
+    return m_DocumentImporter->getStagedMeshes();
+  }
 } 
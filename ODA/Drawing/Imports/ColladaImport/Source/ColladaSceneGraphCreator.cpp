@@ -23,6 +23,7 @@
 #include "ColladaSceneGraphCreator.h"
 #include "COLLADAFWVisualScene.h"
 #include "DbEntity.h"
+#include "DbBlockReference.h"
 #include "COLLADAFWNode.h"
 
 namespace TD_COLLADA_IMPORT
@@ -39,6 +40,9 @@ namespace TD_COLLADA_IMPORT
     if ( !pVisualScene )
       return false;
 
+    if (isInstanceBlocks())
+      countGeometryInstances(pVisualScene->getRootNodes());
+
     InternalNode parentNode;
     importNodes(pVisualScene->getRootNodes(), parentNode);
     return true;
@@ -94,58 +98,177 @@ namespace TD_COLLADA_IMPORT
   }
 
   //------------------------------
+  template<class Instance>
+  void SceneGraphCreator::importInstance(Instance* instance,
+    InternalNode& parentImportNode, void (SceneGraphCreator::*postProcess)(Instance*, OdDbObjectId, const COLLADAFW::UniqueId&))
+  {
+    const COLLADAFW::UniqueId& uniqueId = instance->getInstanciatedObjectId();
+    const COLLADAFW::Controller* pController = getFWControllerByUniqueId(uniqueId);
+    SubUniqueIdIter first, last;
+    if (pController)
+    {
+      COLLADAFW::UniqueId prevId(pController->getSource());
+      COLLADAFW::UniqueId currId(uniqueId);
+      while (pController->getSource().getClassId() == COLLADAFW::COLLADA_TYPE::CONTROLLER && prevId != currId)
+      {
+        prevId = pController->getSource();
+        pController = getFWControllerByUniqueId(prevId);
+        currId = pController->getSource();
+      }
+      getSubUniqueIdsByUniqueId(pController->getSource(), first, last);
+    }
+    else
+    {
+      getSubUniqueIdsByUniqueId(uniqueId, first, last);
+    }
+    for (SubUniqueIdIter it = first; it != last; ++it)
+    {
+      COLLADAFW::UniqueId subUniqueId = it->second;
+      //clone object with transformation.
+      OdDbObjectId oldObjectId = getOdDbObjectIdByUniqueId(subUniqueId);
+      ODA_ASSERT_ONCE(!oldObjectId.isNull());
+      OdDbEntityPtr pEnt = oldObjectId.safeOpenObject();
+      OdDbEntityPtr pClone = pEnt->clone();
+      if (pBTRTmp.isNull())
+      {
+        pBTRTmp = pEnt->database()->getModelSpaceId().safeOpenObject(OdDb::kForWrite);
+      }
+      OdDbObjectId objectId = pBTRTmp->appendOdDbEntity(pClone);
+      pClone->transformBy(parentImportNode.m_matTransformation);
+
+      // post process the creation
+      if (postProcess)
+        (this->*postProcess)(instance, objectId, subUniqueId);
+    }
+  }
+
   template<class Instance>
   bool SceneGraphCreator::importInstances(const COLLADAFW::PointerArray<Instance>& instanceArray,
     InternalNode& parentImportNode, void (SceneGraphCreator::*postProcess)(Instance*, OdDbObjectId, const COLLADAFW::UniqueId&))
   {
     for (size_t idxInstance = 0, count = instanceArray.getCount(); idxInstance < count; ++idxInstance)
     {
-      Instance* instance = instanceArray[idxInstance];
-      const COLLADAFW::UniqueId& uniqueId = instance->getInstanciatedObjectId();
-      const COLLADAFW::Controller* pController = getFWControllerByUniqueId(uniqueId);
-      SubUniqueIdIter first, last;
-      if (pController)
+      importInstance(instanceArray[idxInstance], parentImportNode, postProcess);
+    }
+    return true;
+  }
+
+  bool SceneGraphCreator::importInstanceGeometries(const COLLADAFW::InstanceGeometryPointerArray& instanceGeometryArray, InternalNode& parentImportNode)
+  {
+    if (!isInstanceBlocks())
+      return importInstances<COLLADAFW::InstanceGeometry>(instanceGeometryArray, parentImportNode, &SceneGraphCreator::storeMaterialBinding<COLLADAFW::COLLADA_TYPE::INSTANCE_GEOMETRY>);
+
+    for (size_t idxInstance = 0, count = instanceGeometryArray.getCount(); idxInstance < count; ++idxInstance)
+    {
+      COLLADAFW::InstanceGeometry* instance = instanceGeometryArray[idxInstance];
+      //geometry instantiated once is cloned into model space as usual
+      if (m_geometryInstanceCounts[getGeometryKey(instance->getInstanciatedObjectId())] < 2)
       {
-        COLLADAFW::UniqueId prevId(pController->getSource());
-        COLLADAFW::UniqueId currId(uniqueId);
-        while (pController->getSource().getClassId() == COLLADAFW::COLLADA_TYPE::CONTROLLER && prevId != currId)
-        {
-          prevId = pController->getSource();
-          pController = getFWControllerByUniqueId(prevId);
-          currId = pController->getSource();
-        }
-        getSubUniqueIdsByUniqueId(pController->getSource(), first, last);
+        importInstance(instance, parentImportNode, &SceneGraphCreator::storeMaterialBinding<COLLADAFW::COLLADA_TYPE::INSTANCE_GEOMETRY>);
+        continue;
       }
-      else
+      OdDbObjectId blockId = getInstanceBlock(instance);
+      if (blockId.isNull())
+        continue;
+      OdDbDatabase* pDb = blockId.database();
+      if (pBTRTmp.isNull())
       {
-        getSubUniqueIdsByUniqueId(uniqueId, first, last);
+        pBTRTmp = pDb->getModelSpaceId().safeOpenObject(OdDb::kForWrite);
       }
-      for (SubUniqueIdIter it = first; it != last; ++it)
+      OdDbBlockReferencePtr pBlockRef = OdDbBlockReference::createObject();
+      pBlockRef->setDatabaseDefaults(pDb);
+      pBlockRef->setBlockTableRecord(blockId);
+      //transformation which can't be represented by block reference (e.g. non-uniform scale with shear) is applied to clones
+      if (pBlockRef->setBlockTransform(parentImportNode.m_matTransformation) != eOk)
       {
-        COLLADAFW::UniqueId subUniqueId = it->second;
-        //clone object with transformation.
-        OdDbObjectId oldObjectId = getOdDbObjectIdByUniqueId(subUniqueId);
-        ODA_ASSERT_ONCE(!oldObjectId.isNull());
-        OdDbEntityPtr pEnt = oldObjectId.safeOpenObject();
-        OdDbEntityPtr pClone = pEnt->clone();
-        if (pBTRTmp.isNull())
-        {
-          pBTRTmp = pEnt->database()->getModelSpaceId().safeOpenObject(OdDb::kForWrite);
-        }
-        OdDbObjectId objectId = pBTRTmp->appendOdDbEntity(pClone);
-        pClone->transformBy(parentImportNode.m_matTransformation);
-        
-        // post process the creation
-        if (postProcess)
-          (this->*postProcess)(instance, objectId, subUniqueId);
+        importInstance(instance, parentImportNode, &SceneGraphCreator::storeMaterialBinding<COLLADAFW::COLLADA_TYPE::INSTANCE_GEOMETRY>);
+        continue;
       }
+      pBTRTmp->appendOdDbEntity(pBlockRef);
     }
     return true;
   }
 
-  bool SceneGraphCreator::importInstanceGeometries(const COLLADAFW::InstanceGeometryPointerArray& instanceGeometryArray, InternalNode& parentImportNode)
+  COLLADAFW::UniqueId SceneGraphCreator::getGeometryKey(const COLLADAFW::UniqueId& uniqueId)
+  {
+    //identical geometries are committed once, so their sub ids are the same
+    SubUniqueIdIter first, last;
+    getSubUniqueIdsByUniqueId(uniqueId, first, last);
+    return (first != last) ? first->second : uniqueId;
+  }
+
+  void SceneGraphCreator::countGeometryInstances(const COLLADAFW::NodePointerArray& nodeArray)
+  {
+    for (size_t idxNode = 0, count = nodeArray.getCount(); idxNode < count; ++idxNode)
+    {
+      countGeometryInstances(nodeArray[idxNode]);
+    }
+  }
+
+  void SceneGraphCreator::countGeometryInstances(const COLLADAFW::Node* pNode)
+  {
+    const COLLADAFW::InstanceGeometryPointerArray& instanceGeometryArray = pNode->getInstanceGeometries();
+    for (size_t idxInstance = 0, count = instanceGeometryArray.getCount(); idxInstance < count; ++idxInstance)
+      ++m_geometryInstanceCounts[getGeometryKey(instanceGeometryArray[idxInstance]->getInstanciatedObjectId())];
+    countGeometryInstances(pNode->getChildNodes());
+
+    // same traversal as importInstanceNodes
+    const COLLADAFW::InstanceNodePointerArray& instanceNodeArray = pNode->getInstanceNodes();
+    for (size_t idxInstance = 0, count = instanceNodeArray.getCount(); idxInstance < count; ++idxInstance)
+    {
+      const COLLADAFW::UniqueId& uniqueId = instanceNodeArray[idxInstance]->getInstanciatedObjectId();
+      if (!getOdDbObjectIdByUniqueId(uniqueId).isNull())
+        continue;
+      const COLLADAFW::Node* instanciatedFWNode = getFWNodeByUniqueId(uniqueId);
+      if (instanciatedFWNode)
+        countGeometryInstances(instanciatedFWNode);
+    }
+  }
+
+  OdDbObjectId SceneGraphCreator::getInstanceBlock(COLLADAFW::InstanceGeometry* instanceGeometry)
   {
-    return importInstances<COLLADAFW::InstanceGeometry>(instanceGeometryArray, parentImportNode, &SceneGraphCreator::storeMaterialBinding<COLLADAFW::COLLADA_TYPE::INSTANCE_GEOMETRY>);
+    const COLLADAFW::UniqueId& uniqueId = instanceGeometry->getInstanciatedObjectId();
+    InstanceBlockKey key(1, getGeometryKey(uniqueId));
+    const COLLADAFW::MaterialBindingArray& materialBindings = instanceGeometry->getMaterialBindings();
+    for (size_t matBindIdx = 0; matBindIdx < materialBindings.getCount(); ++matBindIdx)
+      key.push_back(materialBindings[matBindIdx].getReferencedMaterial());
+
+    InstanceBlockMap::const_iterator itBlock = m_instanceBlocks.find(key);
+    if (itBlock != m_instanceBlocks.end())
+      return itBlock->second;
+
+    SubUniqueIdIter first, last;
+    getSubUniqueIdsByUniqueId(uniqueId, first, last);
+    if (first == last)
+      return OdDbObjectId();
+
+    OdDbDatabasePtr pDb = getDocumentImporter()->getDatabase();
+    OdDbBlockTablePtr pTable = pDb->getBlockTableId().safeOpenObject(OdDb::kForWrite);
+    OdString blockName;
+    for (unsigned int idxName = (unsigned int)m_instanceBlocks.size() + 1; ; ++idxName)
+    {
+      blockName.format(OD_T("ColladaGeometry%u"), idxName);
+      if (!pTable->has(blockName))
+        break;
+    }
+    OdDbBlockTableRecordPtr pBlock = OdDbBlockTableRecord::createObject();
+    pBlock->setName(blockName);
+    OdDbObjectId blockId = pTable->add(pBlock);
+
+    for (SubUniqueIdIter it = first; it != last; ++it)
+    {
+      COLLADAFW::UniqueId subUniqueId = it->second;
+      OdDbObjectId oldObjectId = getOdDbObjectIdByUniqueId(subUniqueId);
+      ODA_ASSERT_ONCE(!oldObjectId.isNull());
+      if (oldObjectId.isNull())
+        continue;
+      OdDbEntityPtr pClone = oldObjectId.safeOpenObject()->clone();
+      OdDbObjectId objectId = pBlock->appendOdDbEntity(pClone);
+      //materials are assigned to the block entities, so instances with different bindings use different blocks
+      storeMaterialBinding(instanceGeometry, objectId, subUniqueId);
+    }
+    m_instanceBlocks[key] = blockId;
+    return blockId;
   }
 
   bool SceneGraphCreator::importInstanceLights(const COLLADAFW::InstanceLightPointerArray& instanceLightArray, InternalNode& parentImportNode)
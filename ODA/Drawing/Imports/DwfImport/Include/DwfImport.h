@@ -71,6 +71,9 @@ public:
   // "PaperWidth"  - double, (default 297),   paper width in millimeters
   // "PaperHeight" - double, (default 210),   paper height in millimeters
   // "Background"  - ODCOLORREF, (defaulf 0xffffff), (output parameter), paper color
+  // "ParallelSections" - bool, (default false), prefetch W2D streams and decode raster overlays of the
+  //                      sheets concurrently (requires "DwfPath" and loaded thread pool module),
+  //                      sheets are still added to the database in package order
 
   virtual OdRxDictionaryPtr properties() = 0;
 };
@@ -63,6 +63,8 @@
 #include "dwfcore/MIME.h"
 #include "EmbeddedImageDef.h"
 #include "DbRasterImage.h"
+#include "RxRasterServices.h"
+#include "RxThreadPoolService.h"
 #if defined(_MSC_VER)
 #include "dwf/publisher/win32/EmbeddedFontImpl.h"
 #endif
@@ -91,6 +93,7 @@ class DwfProperties : public OdRxDispatchImpl<>
   bool _processGradients;
   bool _modelToLayout;
   bool _markupFrozen;
+  bool _parallelSections;
   OdIntPtr _palette;
 public:
   DwfProperties() : _paperWidth( 297 ), _paperHeight( 210 ),_background(0xffffffff), 
@@ -101,7 +104,8 @@ public:
     _processGradients(true), 
     _palette(0),
     _modelToLayout(false),
-    _markupFrozen(true)
+    _markupFrozen(true),
+    _parallelSections(false)
   {}
   ODRX_DECLARE_DYNAMIC_PROPERTY_MAP( DwfProperties );
   static OdRxDictionaryPtr createObject();
@@ -136,6 +140,8 @@ public:
   void put_ModelToLayout(bool b) { _modelToLayout = b; }
   bool get_MarkupFrozen()const { return _markupFrozen; }
   void put_MarkupFrozen(bool b) { _markupFrozen = b; }
+  bool get_ParallelSections()const { return _parallelSections; }
+  void put_ParallelSections(bool b) { _parallelSections = b; }
 
 };
 
@@ -162,6 +168,7 @@ ODRX_DECLARE_PROPERTY(ProcessGradients)
 ODRX_DECLARE_PROPERTY(DwgPalette)
 ODRX_DECLARE_PROPERTY(ModelToLayout)
 ODRX_DECLARE_PROPERTY(MarkupFrozen)
+ODRX_DECLARE_PROPERTY(ParallelSections)
 
 ODRX_DEFINE_PROPERTY(DwfPath, DwfProperties, getString)
 ODRX_DEFINE_PROPERTY(Password, DwfProperties, getString)
@@ -178,6 +185,7 @@ ODRX_DEFINE_PROPERTY(ProcessGradients, DwfProperties, getBool)
 ODRX_DEFINE_PROPERTY(DwgPalette, DwfProperties, getIntPtr)
 ODRX_DEFINE_PROPERTY(ModelToLayout, DwfProperties, getBool)
 ODRX_DEFINE_PROPERTY(MarkupFrozen, DwfProperties, getBool)
+ODRX_DEFINE_PROPERTY(ParallelSections, DwfProperties, getBool)
 
 ODRX_BEGIN_DYNAMIC_PROPERTY_MAP( DwfProperties );
   ODRX_GENERATE_PROPERTY( DwfPath )
@@ -195,6 +203,7 @@ ODRX_BEGIN_DYNAMIC_PROPERTY_MAP( DwfProperties );
   ODRX_GENERATE_PROPERTY( DwgPalette )
   ODRX_GENERATE_PROPERTY( ModelToLayout )
   ODRX_GENERATE_PROPERTY( MarkupFrozen )
+  ODRX_GENERATE_PROPERTY( ParallelSections )
 ODRX_END_DYNAMIC_PROPERTY_MAP(DwfProperties);
 
 #if defined(_MSC_VER) && (_MSC_VER >= 1300)
@@ -211,7 +220,8 @@ DwfImporter::DwfImporter() :
   _lines(this),
   _ignoreMetadata(true),
   _currentSegment(0),
-  _idxNextMaterial(0)
+  _idxNextMaterial(0),
+  _pStaged(NULL)
 {
   cleanupW2D();
 }
@@ -598,7 +608,37 @@ OdDwfImport::ImportResult DwfImporter::load2dResourceXps(DWFToolkit::DWFPackageR
 }
 
 namespace image{
-  EmbeddedImageDefPtr createImageDef(OdDbDatabase* db, OdDbObjectId& imageDefId, OdStreamBufPtr buf,int cols, int rows, bool useStableNames );
+  EmbeddedImageDefPtr createImageDef(OdDbDatabase* db, OdDbObjectId& imageDefId, OdStreamBufPtr buf,int cols, int rows, bool useStableNames,
+                                     OdGiRasterImage* pDecoded = NULL );
+}
+
+OdStreamBufPtr DwfImporter::extractResource(DWFToolkit::DWFPackageReader* pReader, const DWFCore::DWFString& href, 
+                                            OdGiRasterImagePtr* pImage) // = NULL
+{
+  if (_pStaged)
+  {
+    StagedResourceMap::iterator pIt = _pStaged->find(OdString((const wchar_t*)href));
+    if (pIt != _pStaged->end() && !pIt->second._data.isNull())
+    {
+      if (pImage)
+        *pImage = pIt->second._image;
+      pIt->second._data->rewind();
+      return pIt->second._data;
+    }
+  }
+  DWFInputStream* pStream = pReader->extract(href, false);
+  OdStreamBufPtr pData;
+  try
+  {
+    pData = dwfImp::toOdStreamBuf(pStream);
+  }
+  catch (...)
+  {
+    DWFCORE_FREE_OBJECT(pStream);
+    throw;
+  }
+  DWFCORE_FREE_OBJECT(pStream);
+  return pData;
 }
 
 void DwfImporter::loadFontResources(DWFToolkit::DWFPackageReader* pReader, DWFToolkit::DWFSection* pSection, 
@@ -652,17 +692,8 @@ void DwfImporter::loadRasterResource(DWFToolkit::DWFPackageReader* pReader, DWFT
     {
       if (DWFImageResource* pRasterRes = dynamic_cast<DWFImageResource*>(piResources->get()))
       {
-        OdStreamBufPtr data = OdMemoryStream::createNew();
-        {
-          DWFInputStream* pStream = pReader->extract( pRasterRes->href(), false );
-          while(pStream->available())
-          {
-            char buf[1024];
-            data->putBytes(buf, (OdUInt32)pStream->read(buf, 1024));
-          }
-          DWFCORE_FREE_OBJECT(pStream);
-          data->rewind();
-        }
+        OdGiRasterImagePtr pDecoded;
+        OdStreamBufPtr data = extractResource(pReader, pRasterRes->href(), &pDecoded);
         OdDbObjectId imageDefId;
         OdGePoint2d minpt(pRasterRes->extents()[0], pRasterRes->extents()[1]);
         OdGePoint2d maxpt(pRasterRes->extents()[2], pRasterRes->extents()[3]);
@@ -688,7 +719,7 @@ void DwfImporter::loadRasterResource(DWFToolkit::DWFPackageReader* pReader, DWFT
               ODA_ASSERT_ONCE_X(TDWF, units == OdDbPlotSettings::kMillimeters);
           }
         }
-        EmbeddedImageDefPtr pImageDef = image::createImageDef(database(), imageDefId, data, (int)width, (int)height, false);
+        EmbeddedImageDefPtr pImageDef = image::createImageDef(database(), imageDefId, data, (int)width, (int)height, false, pDecoded);
         OdString name = (const wchar_t*) pRasterRes->href();
         int slash = name.reverseFind('\\');
         if (slash != -1)
@@ -760,18 +791,16 @@ OdDwfImport::ImportResult DwfImporter::load2dResource(DWFToolkit::DWFPackageRead
 
         if (bForExtents)
         {
-          DWFInputStream* pW2DStream = pReader->extract(pW2D->href(), false);
           _extent._collectBounds = true;
           try {
             WT_File wtFile;
-            //CORE-16665 seek is unsupported directly for pW2DStream //res = loadStream(pW2DStream, wtFile);
-            OdStreamBufPtr pStream = dwfImp::toOdStreamBuf(pW2DStream);
+            //CORE-16665 seek is unsupported directly for W2D stream of package //res = loadStream(pW2DStream, wtFile);
+            OdStreamBufPtr pStream = extractResource(pReader, pW2D->href());
             DWFInputStreamWrapper w(pStream);
             res = loadStream(&w, wtFile);
           }
           catch (const DWFException& err) {
             // CORE-16665 // ODA_FAIL_ONCE_X(TDWF);
-            DWFCORE_FREE_OBJECT(pW2DStream);
             OdString sMsg = err.message();
             bool bMissing = sWarnings.find(sMsg) < 0;
             if (bMissing)
@@ -782,24 +811,19 @@ OdDwfImport::ImportResult DwfImporter::load2dResource(DWFToolkit::DWFPackageRead
             }
             continue; // throw OdError(err.message());
           }
-          DWFCORE_FREE_OBJECT( pW2DStream );
           if (res != OdDwfImport::success)
             break;
         }
         else
         {
-          DWFInputStream* pW2DStream = pReader->extract(pW2D->href(), false);
-          DWFMonitoredInputStream pMonitor(pW2DStream, true);
-          ProgressMonitor m(pW2DStream->available(), pm, 100./layoutCount);
-          pMonitor.attach(&m, false);
           _ignoreMetadata = false;
           _extent._collectBounds = false;
           //if (!bMarkUp)
             _extent.calculateScale();
           try {
             WT_File wtFile;
-            //CORE-16665 seek is unsupported directly for pW2DStream //res = loadStream(pW2DStream, wtFile);
-            OdStreamBufPtr pStream = dwfImp::toOdStreamBuf(pW2DStream);
+            //CORE-16665 seek is unsupported directly for W2D stream of package //res = loadStream(pW2DStream, wtFile);
+            OdStreamBufPtr pStream = extractResource(pReader, pW2D->href());
             DWFInputStreamWrapper w(pStream);
             res = loadStream(&w, wtFile);
           }
@@ -846,19 +870,17 @@ OdDwfImport::ImportResult DwfImporter::getPrimaryUnits(DWFToolkit::DWFPackageRea
           retval = OdDwfImport::encrypted_file;
           break;
         }
-        DWFInputStream* pW2DStream = pReader->extract(pW2D->href(), false);
         _extent._collectBounds = true;
         {
           try {
             WT_File wtFile;
-            //CORE-16665 seek is unsupported directly for pW2DStream //retval = loadStream(pW2DStream, wtFile);
-            OdStreamBufPtr pStream = dwfImp::toOdStreamBuf(pW2DStream);
+            //CORE-16665 seek is unsupported directly for W2D stream of package //retval = loadStream(pW2DStream, wtFile);
+            OdStreamBufPtr pStream = extractResource(pReader, pW2D->href());
             DWFInputStreamWrapper w(pStream); 
             retval = loadStream(&w, wtFile);
           }
           catch (const DWFException& err) {
             // CORE-16665 // ODA_FAIL_ONCE_X(TDWF);
-            DWFCORE_FREE_OBJECT(pW2DStream);
             OdString sMsg = err.message();
             bool bMissing = sWarnings.find(sMsg) < 0;
             if (bMissing)
@@ -870,7 +892,6 @@ OdDwfImport::ImportResult DwfImporter::getPrimaryUnits(DWFToolkit::DWFPackageRea
             continue; // throw OdError(err.message());
           }
         }
-        DWFCORE_FREE_OBJECT(pW2DStream);
         if (_extent._useUnits)
         {
           OdGeMatrix3d global;
@@ -899,12 +920,192 @@ OdDwfImport::ImportResult DwfImporter::getPrimaryUnits(DWFToolkit::DWFPackageRea
   return retval;
 }
 
+/** \details
+  This class prefetches W2D and raster resources of the sheet sections concurrently.
+
+  Every section is staged by a thread pool atom, which opens own package reader on the
+  source file, extracts the W2D streams into memory buffers and decodes raster overlays.
+  Sections are committed to the database by the main thread in sheet order: acquireSection()
+  waits for the section staging and schedules staging of the next sections, so only a
+  limited number of sections is kept in memory.
+*/
+class DwfSectionStager : public OdApcAtom
+{
+  struct Stage
+  {
+    OdArray<OdString> _w2d;     // hrefs of W2D resources
+    OdArray<OdString> _rasters; // hrefs of raster overlays
+    OdStreamBufPtr _pFile;      // own source file stream
+    DwfImporter::StagedResourceMap _resources;
+    OdApcEventPtr _pDone;
+  };
+  OdString _path;
+  OdString _password;
+  OdRxRasterServicesPtr _pRasSvcs;
+  OdRxThreadPoolServicePtr _pThreadPool;
+  OdApcQueuePtr _pQueue;
+  std::vector<Stage> _stages;
+  std::map<DWFSection*, unsigned> _index;
+  unsigned _nSubmitted;
+  unsigned _nWindow;
+
+  static void collectHrefs(DWFSection* pSection, const wchar_t* pRoleName, OdArray<OdString>& hrefs)
+  {
+    if (DWFToolkit::DWFResourceContainer::ResourceIterator* piResources = pSection->findResourcesByRole(pRoleName))
+    {
+      for (; piResources->valid(); piResources->next())
+      {
+        if (DWFResource* pRes = piResources->get())
+        {
+          if (pRes->mime() != DWFCore::DWFMIME::kzMIMEType_W2D_S) // encrypted stream is reported by load2dResource
+            hrefs.append(OdString((const wchar_t*)pRes->href()));
+        }
+      }
+      DWFCORE_FREE_OBJECT(piResources);
+    }
+  }
+  void submit()
+  {
+    Stage& stage = _stages[_nSubmitted];
+    stage._pFile = odrxSystemServices()->createFile(_path);
+    stage._pDone = _pThreadPool->newEvent();
+    _pQueue->addEntryPoint(this, (OdApcParamType)_nSubmitted);
+    ++_nSubmitted;
+  }
+public:
+  DwfSectionStager() : _nSubmitted(0), _nWindow(0) {}
+  ~DwfSectionStager()
+  {
+    if (!_pQueue.isNull())
+      _pQueue->wait();
+  }
+
+  // returns false if staging isn't possible (no thread pool or package isn't loaded from file)
+  bool init(const OdString& path, const OdString& password, const std::vector<DWFSection*>& sections, bool bXps)
+  {
+    if (path.isEmpty() || sections.empty())
+      return false;
+    _pThreadPool = ::odrxDynamicLinker()->getModule(OdThreadPoolModuleName);
+    if (_pThreadPool.isNull() || _pThreadPool->numCPUs() < 2)
+      return false;
+    _path = path;
+    _password = password;
+    _pRasSvcs = ::odrxDynamicLinker()->loadApp(RX_RASTER_SERVICES_APPNAME);
+    _pQueue = _pThreadPool->newMTQueue(ThreadsCounter::kNoAttributes, 0, kMtQueueAllowExecByMain);
+    _nWindow = (unsigned)_pThreadPool->numCPUs() * 2;
+    _stages.resize(sections.size());
+    for (unsigned nSection = 0; nSection < sections.size(); ++nSection)
+    {
+      Stage& stage = _stages[nSection];
+      _index[sections[nSection]] = nSection;
+      collectHrefs(sections[nSection], DWFXML::kzRole_RasterOverlay, stage._rasters);
+      if (!bXps) // XAML pages are read through the resource streams of the main reader
+      {
+        collectHrefs(sections[nSection], DWFXML::kzRole_Graphics2d, stage._w2d);
+        collectHrefs(sections[nSection], DWFXML::kzRole_Graphics2dOverlay, stage._w2d);
+        collectHrefs(sections[nSection], DWFXML::kzRole_Graphics2dMarkup, stage._w2d);
+      }
+    }
+    while (_nSubmitted < _stages.size() && _nSubmitted < _nWindow)
+      submit();
+    return true;
+  }
+
+  // waits for the staged resources of the section
+  DwfImporter::StagedResourceMap* acquireSection(DWFSection* pSection)
+  {
+    std::map<DWFSection*, unsigned>::const_iterator pIt = _index.find(pSection);
+    if (pIt == _index.end())
+      return NULL;
+    while (_nSubmitted < _stages.size() && _nSubmitted <= pIt->second + _nWindow)
+      submit();
+    Stage& stage = _stages[pIt->second];
+    if (stage._pDone.isNull())
+      return NULL;
+    stage._pDone->wait();
+    return &stage._resources;
+  }
+
+  // frees staged resources of the committed section
+  void releaseSection(DWFSection* pSection)
+  {
+    std::map<DWFSection*, unsigned>::const_iterator pIt = _index.find(pSection);
+    if (pIt != _index.end())
+    {
+      Stage& stage = _stages[pIt->second];
+      stage._resources.clear();
+      stage._pFile.release();
+    }
+  }
+
+  void apcEntryPoint(OdApcParamType parameter)
+  {
+    Stage& stage = _stages[(unsigned)parameter];
+    try
+    {
+      if (!stage._pFile.isNull())
+      {
+        DWFInputStreamWrapper w(stage._pFile);
+        OdDwfImport::ImportResult res = OdDwfImport::success;
+        if (DWFPackageReader* pReader = createReader(w, _password, res))
+        {
+          // resources failed here are extracted again by the main thread, which reports the errors
+          for (unsigned nRes = 0; nRes < stage._w2d.size(); ++nRes)
+            stage._resources[stage._w2d[nRes]]._data = extract(pReader, stage._w2d[nRes]);
+          for (unsigned nRes = 0; nRes < stage._rasters.size(); ++nRes)
+          {
+            DwfImporter::StagedResource& res = stage._resources[stage._rasters[nRes]];
+            res._data = extract(pReader, stage._rasters[nRes]);
+            if (!res._data.isNull() && !_pRasSvcs.isNull())
+            {
+              try
+              {
+                res._image = _pRasSvcs->loadRasterImage(res._data);
+              }
+              catch (...)
+              {
+                res._image.release();
+              }
+              res._data->rewind();
+            }
+          }
+          DWFCORE_FREE_OBJECT(pReader);
+        }
+      }
+    }
+    catch (...)
+    {
+    }
+    stage._pDone->set();
+  }
+private:
+  static OdStreamBufPtr extract(DWFPackageReader* pReader, const OdString& href)
+  {
+    DWFInputStream* pStream = NULL;
+    OdStreamBufPtr pData;
+    try
+    {
+      pStream = pReader->extract(DWFString(href.c_str()), false);
+      if (pStream && pStream->available() > 0)
+        pData = dwfImp::toOdStreamBuf(pStream);
+    }
+    catch (...)
+    {
+      pData.release();
+    }
+    if (pStream)
+      DWFCORE_FREE_OBJECT(pStream);
+    return pData;
+  }
+};
+
 #define CHECK_RESULT(v) retval = v; if (retval != OdDwfImport::success) break
 
 OdDwfImport::ImportResult DwfImporter::loadPackage(DWFInputStream& stream, const OdChar* password,
                                                    DWFImportProgressMeter& pm, OdString& sWarnings)
 {
   ImportResult retval = OdDwfImport::success;
+  _pStaged = NULL;
   DWFPackageReader* pReader = createReader( stream, password, retval );
   if (!pReader) 
     return OdDwfImport::fail;
@@ -933,6 +1134,27 @@ OdDwfImport::ImportResult DwfImporter::loadPackage(DWFInputStream& stream, const
     if (nLayoutRequired != -1)
       layoutCount = 1;
 
+    // sheet sections are staged concurrently if package may be reopened from file
+    OdStaticRxObject<DwfSectionStager> stager;
+    bool bStaged = false;
+    int nCommitted = 0;
+    if (_properties->get_ParallelSections() && _properties->get_Stream().isNull())
+    {
+      std::vector<DWFSection*> sections;
+      for (int nSection = 0; piSections->valid(); piSections->next())
+      {
+        DWFSection* pSection = piSections->get();
+        if (pSection && pSection->type() == DWFString(_DWF_FORMAT_EPLOT_TYPE_STRING))
+        {
+          if (nLayoutRequired == -1 || nSection == nLayoutRequired)
+            sections.push_back(pSection);
+          ++nSection;
+        }
+      }
+      piSections->reset();
+      bStaged = stager.init(_properties->get_DwfPath(), _properties->get_Password(), sections, _xps);
+    }
+
     for (; piSections->valid(); piSections->next())
     {
       DWFSection* pSection = piSections->get();
@@ -1000,6 +1222,9 @@ OdDwfImport::ImportResult DwfImporter::loadPackage(DWFInputStream& stream, const
           bModelToLayout = OdRxVariantValue(properties()->getAt(L"ModelToLayout").get())->getBool();
         setupLayout(_usedLayoutNames, sLayoutName, _db, _blocks, bModelToLayout);
 
+        if (bStaged)
+          _pStaged = stager.acquireSection(pSection);
+
         loadRasterResource(pReader, pSection, DWFXML::kzRole_RasterOverlay, 
                            dPaperWidth, dPaperHeight, units, // in/out
                            pPaper);
@@ -1031,6 +1256,13 @@ OdDwfImport::ImportResult DwfImporter::loadPackage(DWFInputStream& stream, const
         }
         
         cleanupW2D();
+        if (bStaged)
+        {
+          _pStaged = NULL;
+          stager.releaseSection(pSection);
+          // package stream isn't read by the main thread while sections are staged
+          pm.stepTo(100 * ++nCommitted / layoutCount);
+        }
       }
       else if (pSection && (pSection->type() == DWFString(_DWF_FORMAT_EMODEL_TYPE_STRING)))
       {
@@ -1040,6 +1272,7 @@ OdDwfImport::ImportResult DwfImporter::loadPackage(DWFInputStream& stream, const
         }
       }
     }
+    _pStaged = NULL;
     DWFCORE_FREE_OBJECT( piSections );
   }
 
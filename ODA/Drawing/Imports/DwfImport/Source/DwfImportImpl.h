@@ -35,10 +35,12 @@
 #define STL_USING_MAP
 #define STL_USING_SET
 #define STL_USING_MEMORY
+#define STL_USING_VECTOR
 #include "OdaSTL.h"
 #include "Ge/GeMatrix3d.h"
 #include "Ge/GeExtents2d.h"
 #include "Gi/GiMaterialTraitsData.h"
+#include "Gi/GiRasterImage.h"
 
 // MKU 07/14/05 - for converting to DWF Toolkit v7.0
 //
@@ -147,7 +149,21 @@ public:
   OdRxDictionaryPtr properties();
   ImportResult import(OdString* pWarnings = NULL);
   std::map<OdString, OdString> _embeddedFontMap;
+
+  // Resource of the section prefetched (and decoded for rasters) by the section stager
+  struct StagedResource
+  {
+    OdStreamBufPtr _data;
+    OdGiRasterImagePtr _image;
+  };
+  // staged resources of the section keyed by href
+  typedef std::map<OdString, StagedResource> StagedResourceMap;
 private:
+  // staged resources of the currently imported section (NULL if sections are loaded serially)
+  StagedResourceMap* _pStaged;
+  // returns staged resource data or extracts it from the package
+  OdStreamBufPtr extractResource(DWFToolkit::DWFPackageReader* pReader, const DWFCore::DWFString& href, 
+                                 OdGiRasterImagePtr* pImage = NULL);
 	
 	// load DWF (ver >= 600)
   // return values described in "Dwfimport.h"
@@ -57,6 +57,12 @@ public:
     m_pOuterMeter->meterProgress();
     ++_current;
   }
+  // steps the meter up to the specified position (used for per section progress)
+  void stepTo(int pos)
+  {
+    while (_current < pos)
+      step();
+  }
 private:
   DWFImportProgressMeter(); // disabled // CORE-16301 
   DWFImportProgressMeter(const DWFImportProgressMeter& other); // disabled
@@ -434,7 +434,8 @@ namespace image
     return buf;
   }
 
-  EmbeddedImageDefPtr createImageDef(OdDbDatabase* db, OdDbObjectId& imageDefId, OdStreamBufPtr buf,int cols, int rows, bool useStableNames )
+  EmbeddedImageDefPtr createImageDef(OdDbDatabase* db, OdDbObjectId& imageDefId, OdStreamBufPtr buf,int cols, int rows, bool useStableNames,
+                                     OdGiRasterImage* pDecoded = NULL )
   {
 		// Add an image entity to the drawing.
 		OdDbObjectId imageDictId = OdDbRasterImageDef::createImageDictionary(db);
@@ -456,11 +457,14 @@ namespace image
     // add image to reactor, to be notified of db saving
     DwfEventReactor::getReactor(db)->addImage(pImageDef);
 
-    OdGiRasterImagePtr img;
-    // try to load image (for rendering), else set placeholder
-    OdRxRasterServicesPtr pRasSvcs = odrxDynamicLinker()->loadApp(RX_RASTER_SERVICES_APPNAME);
-    if ( !pRasSvcs.isNull() )
-      img = pRasSvcs->loadRasterImage(buf);
+    OdGiRasterImagePtr img = pDecoded;
+    // try to load image (for rendering) if it isn't decoded yet, else set placeholder
+    if ( img.isNull() )
+    {
+      OdRxRasterServicesPtr pRasSvcs = odrxDynamicLinker()->loadApp(RX_RASTER_SERVICES_APPNAME);
+      if ( !pRasSvcs.isNull() )
+        img = pRasSvcs->loadRasterImage(buf);
+    }
     
     if ( !img.isNull() )
       pImageDef->setImage(img);
@@ -29,73 +29,70 @@
 
 namespace TD_DGN_EXPORT {
 
-class OdDgnExportContextData
+// Export context bound to the calling thread
+
+#if defined(TD_SINGLE_THREAD)
+#define ODDGNEXPORT_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define ODDGNEXPORT_THREAD_LOCAL __declspec(thread)
+#else
+#define ODDGNEXPORT_THREAD_LOCAL __thread
+#endif
+
+static ODDGNEXPORT_THREAD_LOCAL OdDgnExportContextData* g_pThreadContext = NULL;
+
+static inline OdDgnExportContextData* getCurrentContext()
 {
-public:
-	OdDgnExportContextData() :m_bInternalExport(false), m_b3dFlag(false), m_bCloseNurbCurves(false), 
-                            m_dMasterToUORsScale(1.0), m_bKeepNonDbro(false), m_uColorByBlockIndex(OdDg::kColorByCell),
-                            m_uLineStyleByBlockIndex(OdDg::kLineStyleByCell), m_uLineWeightByBlockIndex(OdDg::kLineWeightByCell),
-                            m_dLineStyleScaleCorrectionFactor(1.0), m_bgColor(0), m_bRecomputeDims(false)
-  {
+  return g_pThreadContext;
+}
 
-  };
-
-public:
-  DgnExporter*                                         m_pDgnExporter;
-  bool                                                 m_bInternalExport;
-  bool                                                 m_b3dFlag;
-  bool                                                 m_bKeepNonDbro;
-  bool                                                 m_bCloseNurbCurves;
-  double                                               m_dMasterToUORsScale;
-  double                                               m_dLineStyleScaleCorrectionFactor;
-  OdUInt32                                             m_uColorByBlockIndex;
-  OdUInt32                                             m_uLineStyleByBlockIndex;
-  OdUInt32                                             m_uLineWeightByBlockIndex;
-  OdArray<OdDgnExportHatchAssociation>                 m_arrHatchAssoc;
-  std::set<OdDbObjectId>                               m_setProcessedBlockIds;
-  std::set<OdDbObjectId>                               m_setSkippedObjectIds;
-  std::map<OdDbObjectId, OdDgElementId>                m_mapAttrDefSet;
-  std::map<OdDbObjectId, OdDbObjectId>                 m_mapViewportClip;
-  OdDgElementId                                        m_idModelSpaceModel;
-  std::set<OdDbObjectId>                               m_setBlocksWithXRefInserts;
-  OdGePoint3d                                          m_ptBlockRefOffset;
-  OdDgElementId                                        m_idPointBlock;
-  ODCOLORREF                                           m_bgColor;
-  bool                                                 m_bRecomputeDims;
-  OdArray<OdDgnExportDimAssocData>                     m_arrDimAssoc;
-};
-
-OdArray<OdDgnExportContextData>   g_exportContextDataArr;
-
-static OdDgnExportContextData* getCurrentContext()
-{
-  if( g_exportContextDataArr.size() > 0 )
-  {
-    return g_exportContextDataArr.asArrayPtr() + g_exportContextDataArr.size() - 1;
-  }
-  else
-  {
-    return NULL;
-  }
+//---------------------------------------------------------------------------
+
+OdDgnExportContextData* OdDgnExportContext::getContextData()
+{
+  return getCurrentContext();
+}
+
+//---------------------------------------------------------------------------
+
+OdDgnExportContextData* OdDgnExportContext::bindContext( OdDgnExportContextData* pContextData )
+{
+  OdDgnExportContextData* pPrevContextData = g_pThreadContext;
+
+  if( pContextData )
+    g_pThreadContext = pContextData;
+
+  return pPrevContextData;
+}
+
+//---------------------------------------------------------------------------
+
+void OdDgnExportContext::unbindContext( OdDgnExportContextData* pPrevContextData )
+{
+  g_pThreadContext = pPrevContextData;
 }
 
 //---------------------------------------------------------------------------
 
 void OdDgnExportContext::restoreAfterExport()
 {
-  if( g_exportContextDataArr.size() > 0 )
-  {
-    g_exportContextDataArr.removeLast();
-  }
+  OdDgnExportContextData* pContextData = getCurrentContext();
+
+  if( pContextData )
+    unbindContext( pContextData->m_pPrevContext );
 }
 
 //---------------------------------------------------------------------------
 
 void         OdDgnExportContext::prepareToExport( DgnExporter* pDgnExporter )
 {
+  if( !pDgnExporter )
+    return;
+
   OdDgnExportContextData* pContextData = getCurrentContext();
 
-  OdDgnExportContextData newData;
+  OdDgnExportContextData& newData = pDgnExporter->exportContext();
+  newData = OdDgnExportContextData();
   newData.m_pDgnExporter = pDgnExporter;
 
   if (pContextData)
@@ -106,7 +103,7 @@ void         OdDgnExportContext::prepareToExport( DgnExporter* pDgnExporter )
     newData.m_bRecomputeDims = pContextData->m_bRecomputeDims;
   }
 
-  g_exportContextDataArr.push_back( newData );
+  newData.m_pPrevContext = bindContext( &newData );
 }
 
 //---------------------------------------------------------------------------
@@ -399,7 +396,7 @@ void OdDgnExportContext::addProcessingBlockId(const OdDbObjectId& idBlock)
   OdDgnExportContextData* pContextData = getCurrentContext();
 
   if (pContextData)
-    pContextData->m_setProcessedBlockIds.insert(idBlock);
+    pContextData->m_setProcessedBlockIds.insert(idBlock, true);
 }
 
 void OdDgnExportContext::removeProcessingBlockId(const OdDbObjectId& idBlock)
@@ -419,12 +416,7 @@ bool OdDgnExportContext::isBlockOnProcessing(const OdDbObjectId& idBlock)
   OdDgnExportContextData* pContextData = getCurrentContext();
 
   if( pContextData )
-  {
-    std::set<OdDbObjectId>::iterator pIter = pContextData->m_setProcessedBlockIds.find(idBlock);
-
-    if( pIter != pContextData->m_setProcessedBlockIds.end() )
-      bRet = true;
-  }
+    bRet = pContextData->m_setProcessedBlockIds.contains(idBlock);
 
   return bRet;
 }
@@ -492,12 +484,7 @@ bool           OdDgnExportContext::skipObjectExport(const OdDbObjectId& idObject
   OdDgnExportContextData* pContextData = getCurrentContext();
 
   if( pContextData )
-  {
-    std::set<OdDbObjectId>::iterator pIter = pContextData->m_setSkippedObjectIds.find(idObject);
-
-    if (pIter != pContextData->m_setSkippedObjectIds.end())
-      bRet = true;
-  }
+    bRet = pContextData->m_setSkippedObjectIds.contains(idObject);
 
   return bRet;
 }
@@ -509,7 +496,7 @@ void           OdDgnExportContext::addObjectToSkipExport(const OdDbObjectId& idO
   OdDgnExportContextData* pContextData = getCurrentContext();
 
   if (pContextData)
-    pContextData->m_setSkippedObjectIds.insert(idObject);
+    pContextData->m_setSkippedObjectIds.insert(idObject, true);
 }
 
 //----------------------------------------------------------------------------
@@ -25,9 +25,11 @@
 #define _DGN_EXPORTCONTEXT_INCLUDED_
 
 #define STL_USING_MAP
+#define STL_USING_SET
 #include <OdaSTL.h>
 #include <DgDatabase.h>
 #include <DbDimAssoc.h>
+#include <OdIdHashMap.h>
 
 /** \details
   <group OdExport_Classes> 
@@ -64,6 +66,55 @@ struct OdDgnExportHatchAssociation
   OdArray<OdDgnExportHatchLoopAssociation> m_arrLoopAssoc;
 };
 
+/** \details
+  State of single DWG to DGN export. Each DgnExporter owns its own state object, so
+  exporters running in different threads don't share any export data.
+*/
+class OdDgnExportContextData
+{
+public:
+  OdDgnExportContextData() : m_pDgnExporter(NULL), m_pPrevContext(NULL), m_bInternalExport(false), m_b3dFlag(false), m_bKeepNonDbro(false),
+                             m_bCloseNurbCurves(false), m_dMasterToUORsScale(1.0), m_dLineStyleScaleCorrectionFactor(1.0),
+                             m_uColorByBlockIndex(OdDg::kColorByCell), m_uLineStyleByBlockIndex(OdDg::kLineStyleByCell),
+                             m_uLineWeightByBlockIndex(OdDg::kLineWeightByCell), m_bgColor(0), m_bRecomputeDims(false)
+  {
+  }
+
+public:
+  DgnExporter*                                         m_pDgnExporter;
+  OdDgnExportContextData*                              m_pPrevContext; // Context bound to the thread before this export
+  bool                                                 m_bInternalExport;
+  bool                                                 m_b3dFlag;
+  bool                                                 m_bKeepNonDbro;
+  bool                                                 m_bCloseNurbCurves;
+  double                                               m_dMasterToUORsScale;
+  double                                               m_dLineStyleScaleCorrectionFactor;
+  OdUInt32                                             m_uColorByBlockIndex;
+  OdUInt32                                             m_uLineStyleByBlockIndex;
+  OdUInt32                                             m_uLineWeightByBlockIndex;
+  OdArray<OdDgnExportHatchAssociation>                 m_arrHatchAssoc;
+  OdIdHashMap<OdDbObjectId, bool>                      m_setProcessedBlockIds;
+  OdIdHashMap<OdDbObjectId, bool>                      m_setSkippedObjectIds;
+  std::map<OdDbObjectId, OdDgElementId>                m_mapAttrDefSet;
+  std::map<OdDbObjectId, OdDbObjectId>                 m_mapViewportClip;
+  OdDgElementId                                        m_idModelSpaceModel;
+  std::set<OdDbObjectId>                               m_setBlocksWithXRefInserts;
+  OdGePoint3d                                          m_ptBlockRefOffset;
+  OdDgElementId                                        m_idPointBlock;
+  ODCOLORREF                                           m_bgColor;
+  bool                                                 m_bRecomputeDims;
+  OdArray<OdDgnExportDimAssocData>                     m_arrDimAssoc;
+};
+
+/** \details
+  Access to the export state of the DgnExporter running in the calling thread.
+
+  prepareToExport() binds the state owned by the exporter to the calling thread and
+  restoreAfterExport() unbinds it, so static accessors of this class always work with
+  the state of the export started by the calling thread. Worker threads of the same
+  export may share its state by bindContext() and unbindContext(). The bound state is
+  kept in a thread-local pointer, so accessors don't take any locks.
+*/
 class OdDgnExportContext
 {
 public:
@@ -72,6 +123,9 @@ public:
 
   static void           restoreAfterExport();
   static void           prepareToExport( DgnExporter* pDgnExporter );
+  static OdDgnExportContextData* getContextData();
+  static OdDgnExportContextData* bindContext( OdDgnExportContextData* pContextData );
+  static void           unbindContext( OdDgnExportContextData* pPrevContextData );
   static DgnExporter*   getDgnExporter();
   static bool           getInternalExportFlag();
   static void           setInternalExportFlag( bool bSet );
@@ -148,6 +148,9 @@ namespace TD_DGN_EXPORT
     if (_services.isNull())
       _services = OdRxObjectImpl<ExHostAppServices>::createObject();
 
+    bool bLoadersRegistered = false;
+    bool bContextPrepared   = false;
+
     try
     {
       OdDbDatabasePtr pDwgDb = _properties->get_DwgDatabase();
@@ -158,6 +161,8 @@ namespace TD_DGN_EXPORT
       if (pDwgDb.isNull())
         return OdDgnExport::bad_file;
 
+      m_idMap.reserve((OdUInt32)odmax(pDwgDb->approxNumObjects(), (OdInt32)0));
+
       // choose active model and prepare export params
 
       double dMasterUnitsToUORsScale = 1.0;
@@ -180,8 +185,10 @@ namespace TD_DGN_EXPORT
         return OdDgnExport::fail;
 
       registerElementLoaders();
+      bLoadersRegistered = true;
 
       OdDgnExportContext::prepareToExport(this);
+      bContextPrepared = true;
 
       OdDgModelPtr pActiveModel = idActiveModel.openObject(OdDg::kForWrite);
 
@@ -227,19 +234,26 @@ namespace TD_DGN_EXPORT
       restoreDimensionAssociations();
 
       unregisterElementLoaders();
+      bLoadersRegistered = false;
 
       m_pDwgDb = pDwgDb.get();
       m_pDgHostAppServices = svc.get();
     }
     catch (OdError& e)
     {
-      OdDgnExportContext::restoreAfterExport();
+      if( bLoadersRegistered )
+        unregisterElementLoaders();
+      if( bContextPrepared )
+        OdDgnExportContext::restoreAfterExport();
       _services->warning(e);
       return OdDgnExport::fail;
     }
     catch (...)
     {
-      OdDgnExportContext::restoreAfterExport();
+      if( bLoadersRegistered )
+        unregisterElementLoaders();
+      if( bContextPrepared )
+        OdDgnExportContext::restoreAfterExport();
       throw;
     }
 
@@ -1097,10 +1111,10 @@ namespace TD_DGN_EXPORT
   {
     OdDgElementId retVal;
 
-    IdDbToDgMap::const_iterator pIter = m_idMap.find(idDwg);
+    const OdDgElementId* pIdDgn = m_idMap.find(idDwg);
 
-    if (pIter != m_idMap.end())
-      retVal = pIter->second;
+    if (pIdDgn)
+      retVal = *pIdDgn;
 
     return retVal;
   }
@@ -1111,12 +1125,21 @@ namespace TD_DGN_EXPORT
 
   //========================================================================================================================
 
+  // Export protocol extensions are shared by all exporters, so they are registered
+  // by the first running export and removed after the last one is finished.
+
+  static OdMutex  g_elementLoadersMutex;
+  static OdUInt32 g_nElementLoadersRefs = 0;
+
   void DgnExporter::registerElementLoaders()
   {
     if( OdDgnExportContext::getInternalExportFlag())
       return;
 
-    setExportPEToElements();
+    TD_AUTOLOCK(g_elementLoadersMutex);
+
+    if( !g_nElementLoadersRefs++ )
+      setExportPEToElements();
   }
 
   //========================================================================================================================
@@ -1126,7 +1149,10 @@ namespace TD_DGN_EXPORT
     if( OdDgnExportContext::getInternalExportFlag() )
       return;
 
-    removeExportPEFromElements();
+    TD_AUTOLOCK(g_elementLoadersMutex);
+
+    if( g_nElementLoadersRefs && !--g_nElementLoadersRefs )
+      removeExportPEFromElements();
   }
 
   //========================================================================================================================
@@ -43,6 +43,8 @@
 #include <DbRay.h>
 #include <DbXline.h>
 #include "DgDatabase.h"
+#include "DgnExportContext.h"
+#include "OdIdHashMap.h"
 
 class OdDbDatabase;
 class OdDgLevelTableRecord;
@@ -171,12 +173,15 @@ public:
 
   void addIdPair(const OdDbObjectId& idDwg, const OdDgElementId& idDgn);
 
+  OdDgnExportContextData& exportContext() { return m_exportContext; }
+
 private:
-  typedef std::map<OdDbObjectId, OdDgElementId> IdDbToDgMap;
+  typedef OdIdHashMap<OdDbObjectId, OdDgElementId> IdDbToDgMap;
 
   IdDbToDgMap          m_idMap;
   OdDbDatabase*        m_pDwgDb;
   OdDgHostAppServices* m_pDgHostAppServices;
+  OdDgnExportContextData m_exportContext;
 };
 
 }
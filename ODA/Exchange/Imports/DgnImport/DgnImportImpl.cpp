@@ -149,6 +149,7 @@ OdDgnImport::ImportResult DgnImporter::import()
 
     DgnLSImporter::prepareLS(dgn); // Populate additional database-resident objects before getting handseed
     pDb->getOdDbObjectId(dgn->getHandseed(), true);
+    _idMap.reserveByHandseed(dgn->getHandseed());
     if (!isInitialized)
       pDb->initialize();
     OdDgnImportContext::setPalette( dgn );
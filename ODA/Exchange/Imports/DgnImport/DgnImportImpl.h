@@ -42,6 +42,7 @@
 #include "DgDimStyleTableRecord.h"
 #include <DbDimStyleTableRecord.h>
 #include "DgDatabase.h"
+#include "OdIdHashMap.h"
 
 class OdDbDatabase;
 class OdDgLevelTableRecord;
@@ -234,7 +235,7 @@ public:
 */
 class DgnImporter : public OdDgnImport
 {
-  typedef std::map<OdDgElementId, OdDgnImportPathToDwgObject> IdMap;
+  typedef OdIdHashMap<OdDgElementId, OdDgnImportPathToDwgObject> IdMap;
   typedef std::map<OdDbObjectId, bool> IdResourceUsage;
   IdMap _idMap;
   OdArray<IdMap> m_arrIdMapStack;
@@ -417,14 +417,14 @@ OdDbObjectId DgnImporter::getObjectId( const OdDgElementId& idDgnElement ) const
 {
   OdDbObjectId retVal;
 
-  IdMap::const_iterator pIter = _idMap.find( idDgnElement );
+  const OdDgnImportPathToDwgObject* pDwgPath = _idMap.find( idDgnElement );
 
-  if( pIter != _idMap.end() )
+  if( pDwgPath )
   {
 
-    if( pIter->second.m_bExists )
+    if( pDwgPath->m_bExists )
     {
-      OdDbObjectIdArray arrPath = pIter->second.m_idPath.objectIds();
+      OdDbObjectIdArray arrPath = pDwgPath->m_idPath.objectIds();
 
       retVal = arrPath[arrPath.size() - 1];
     }
@@ -437,11 +437,11 @@ bool DgnImporter::getObjectPath( const OdDgElementId& idDgnElement, OdDgnImportP
 {
   bool bRet = false;
 
-  IdMap::const_iterator pIter = _idMap.find( idDgnElement );
+  const OdDgnImportPathToDwgObject* pDwgPath = _idMap.find( idDgnElement );
 
-  if( pIter != _idMap.end() )
+  if( pDwgPath )
   {
-    dwgPath = pIter->second;
+    dwgPath = *pDwgPath;
     bRet = true;
   }
 
@@ -25,7 +25,10 @@
 #include "FMProfile3D.h"
 #include "FMCreateStart.h"
 #include "FMDataSerialize.h"
+#include "FMDataMapped.h"
+#include "OdFileMapping.h"
 #include "Modeler/FMMdlIterators.h"
+#include "Modeler/FMMdlBodyBoolTree.h"
 
 #include "Ge/GeCircArc2d.h"
 #include "Ge/GeScale3d.h"
@@ -33,6 +36,10 @@
 #include "Ge/GeCircArc3d.h"
 
 #include "CmColorBase.h"
+#include "OdPerfTimer.h"
+#include "ExPrintConsole.h"
+
+#include <stdio.h>
 
 using namespace FacetModeler;
 
@@ -59,6 +66,8 @@ void CreateBodyExample(const DeviationParams& devParams, OdStreamBuf* pStream, C
   case kWrench:      body = createWrench(devParams); break;
   case kMeshTetra:   body = createMeshTetrahedron(devParams); break;
   case kMeshCuboid:    body = createMeshCuboid(devParams); break;
+  case kCityBlocks:  body = createCityBlocks(devParams); break;
+  case kMappedSphere: body = createMappedSphere(devParams); break;
   default: ODA_ASSERT(false);
   }
 
@@ -563,6 +572,147 @@ Body createLogo(const DeviationParams& devDeviation, double length, double thick
   return logo;
 }
 
+// Simple deterministic pseudo-random generator
+static double cityRandom(OdUInt32& seed, double minVal, double maxVal)
+{
+  seed = seed * 1103515245 + 12345;
+  return minVal + (maxVal - minVal) * double((seed >> 16) & 0x7FFF) / 32767.0;
+}
+
+// Fills array by buildings of city blocks. Buildings of each block overlap each other,
+// blocks are separated by streets.
+static void createCityBuildings(std::vector<Body>& aBuildings, unsigned int blocksCnt, unsigned int buildingsCnt)
+{
+  const double blockSize = 100.0;
+  const double streetWidth = 20.0;
+  OdUInt32 seed = 12345; // Fixed seed, so both benchmark passes get the same buildings
+  for (unsigned int blockX = 0; blockX < blocksCnt; blockX++)
+  {
+    for (unsigned int blockY = 0; blockY < blocksCnt; blockY++)
+    {
+      const OdGePoint3d blockOrigin(blockX * (blockSize + streetWidth), blockY * (blockSize + streetWidth), 0.0);
+      for (unsigned int building = 0; building < buildingsCnt; building++)
+      {
+        const OdGeVector3d sizes(cityRandom(seed, 15.0, 40.0), cityRandom(seed, 15.0, 40.0), cityRandom(seed, 10.0, 80.0));
+        const OdGeVector3d position(cityRandom(seed, 0.0, blockSize - sizes.x), cityRandom(seed, 0.0, blockSize - sizes.y), 0.0);
+        aBuildings.push_back(Body::box(blockOrigin + position, sizes));
+      }
+    }
+  }
+}
+
+Body createCityBlocks(const DeviationParams& devDeviation, unsigned int blocksCnt, unsigned int buildingsCnt)
+{
+  OdPerfTimerWrapper timer;
+
+  // Serial chain of boolean operations
+  std::vector<Body> aBuildings;
+  createCityBuildings(aBuildings, blocksCnt, buildingsCnt);
+  timer.getTimer()->start();
+  Body chain;
+  for (size_t building = 0; building < aBuildings.size(); building++)
+    chain = chain.isNull() ? aBuildings[building] : Body::boolOper(eUnion, chain, aBuildings[building]);
+  timer.getTimer()->stop();
+  const double chainTime = timer.getTimer()->countedSec();
+  const double chainVolume = chain.volume();
+
+  // Reduction tree, using thread pool if it is available
+  aBuildings.clear();
+  createCityBuildings(aBuildings, blocksCnt, buildingsCnt);
+  OdRxThreadPoolServicePtr pThreadPool = ::odrxDynamicLinker()->loadApp(OdThreadPoolModuleName, true);
+  BoolTreeStats stats;
+  timer.getTimer()->start();
+  Body city = boolUnion(aBuildings, false, pThreadPool.get(), &stats);
+  timer.getTimer()->stop();
+  const double treeTime = timer.getTimer()->countedSec();
+
+  odPrintConsoleString(L"\nBuildings: %u, boolean operations: %u, pruned pairs: %u, tree levels: %u",
+    stats.m_nOperands, stats.m_nBoolOpers, stats.m_nPrunedPairs, stats.m_nLevels);
+  odPrintConsoleString(L"\nSerial union: %.3f s, tree union (%ls): %.3f s",
+    chainTime, pThreadPool.isNull() ? L"single thread" : L"thread pool", treeTime);
+  odPrintConsoleString(L"\nVolume: serial %.3f, tree %.3f\n", chainVolume, city.volume());
+
+  return city;
+}
+
+Body createMappedSphere(const DeviationParams& devDeviation, OdUInt16 segmentsCnt, double radius)
+{
+  // Dense body, so reading time isn't dominated by the file opening
+  Body sphere = createSphere(DeviationParams(devDeviation.Deviation, segmentsCnt, segmentsCnt), radius);
+  // Flat layout keeps only the mesh data
+  for (FaceIterator itF(&sphere); !itF.done(); itF.next())
+    itF.get()->setSurface(NULL);
+  sphere.deleteUnusedSurfaces();
+  sphere.clearVertexTags();
+  sphere.clearEdgeTags();
+  sphere.clearFaceTags();
+  sphere.clearBodyTags();
+
+  OdPerfTimerWrapper timer;
+  const OdString streamFile = ::odrxSystemServices()->getTempFileName();
+  const OdString mappedFile = ::odrxSystemServices()->getTempFileName();
+
+  // Per-field BinaryStream format
+  {
+    OdStreamBufPtr pStream = ::odrxSystemServices()->createFile(streamFile, Oda::kFileWrite, Oda::kShareDenyNo, Oda::kCreateAlways);
+    BinaryStream sout;
+    sout.Create(pStream);
+    sout.Write(sphere);
+  }
+  timer.getTimer()->start();
+  Body streamBody;
+  {
+    BinaryStream sin;
+    if (sin.Open(streamFile))
+      sin.Read(streamBody);
+  }
+  timer.getTimer()->stop();
+  const double streamTime = timer.getTimer()->countedSec();
+
+  // Flat memory-mapped format
+  const bool bMapped = MappedBodyWriter::write(sphere, mappedFile);
+  timer.getTimer()->start();
+  Body mappedBody;
+  {
+    OdFileMapping::View view;
+    MappedBodyFile mapped;
+    if (bMapped && OdFileMapping::mapFile(mappedFile, view) && mapped.attach(view.data(), view.size()))
+      mappedBody = mapped.createBody();
+    OdFileMapping::unmap(view);
+  }
+  timer.getTimer()->stop();
+  const double mappedTime = timer.getTimer()->countedSec();
+
+  // Out of range vertex index and face counts which don't match the header are rejected
+  bool bRejected = false;
+  if (bMapped)
+  {
+    OdStreamBufPtr pStream = ::odrxSystemServices()->createFile(mappedFile, Oda::kFileRead, Oda::kShareDenyNo, Oda::kOpenExisting);
+    std::vector<OdUInt64> aData((OdUInt32)((pStream->length() + 7) / 8));
+    pStream->getBytes(&aData.front(), (OdUInt32)pStream->length());
+    const MappedBodyHeader& header = *reinterpret_cast<const MappedBodyHeader*>(&aData.front());
+    OdInt32* pFaceData = reinterpret_cast<OdInt32*>((OdUInt8*)&aData.front() + header.m_offsets[MappedBodyHeader::eFaceData]);
+    MappedBodyFile corrupted;
+    const OdInt32 nIndex = pFaceData[1];
+    pFaceData[1] = (OdInt32)header.m_nVertices;
+    bRejected = !corrupted.attach(&aData.front(), header.m_dataSize);
+    pFaceData[1] = nIndex;
+    pFaceData[0]++;
+    bRejected &= !corrupted.attach(&aData.front(), header.m_dataSize);
+  }
+
+  ::remove(OdAnsiString(streamFile).c_str());
+  ::remove(OdAnsiString(mappedFile).c_str());
+
+  odPrintConsoleString(L"\nVertices: %u, faces: %u", sphere.vertexCount(), sphere.faceCount());
+  odPrintConsoleString(L"\nBinaryStream read: %.3f s, mapped read: %.3f s", streamTime, mappedTime);
+  odPrintConsoleString(L"\nCorrupted face data rejected: %ls", bRejected ? L"yes" : L"no");
+  odPrintConsoleString(L"\nVolume: source %.3f, BinaryStream %.3f, mapped %.3f\n",
+    sphere.volume(), streamBody.isNull() ? 0. : streamBody.volume(), mappedBody.isNull() ? 0. : mappedBody.volume());
+
+  return mappedBody.isNull() ? sphere : mappedBody;
+}
+
 template< typename T, size_t N >
 std::vector<T> makeVector(const T(&data)[N])
 {
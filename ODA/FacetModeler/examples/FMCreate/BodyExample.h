@@ -136,6 +136,18 @@ FacetModeler::Body createLogo(
   double thickness = 30.0
 );
 
+FacetModeler::Body createCityBlocks(
+  const FacetModeler::DeviationParams& devDeviation,
+  unsigned int blocksCnt = 6,
+  unsigned int buildingsCnt = 12
+);
+
+FacetModeler::Body createMappedSphere(
+  const FacetModeler::DeviationParams& devDeviation,
+  OdUInt16 segmentsCnt = 720,
+  double radius = 200.0
+);
+
 FacetModeler::Body createMeshTetrahedron(
   const FacetModeler::DeviationParams& devDeviation
 );
@@ -27,6 +27,9 @@
 #include "FMCreateStart.h"
 #include "Ge/GeExtents2d.h"
 #include "Ge/GeCircArc2d.h"
+#include "Contours/FMContourBroadPhase.h"
+#include "OdPerfTimer.h"
+#include "ExPrintConsole.h"
 
 using namespace FacetModeler;
 
@@ -48,6 +51,9 @@ void CreateContourExample(const DeviationParams& devParams, OdStreamBuf* pStream
   case kNutProfile:
     profile = createNutProfile();
     break;
+  case kContourIsect:
+    profile = createContourIsect();
+    break;
   default: ODA_ASSERT(false);
   }
 
@@ -115,3 +121,53 @@ Profile2D createNutProfile(double majorRadius, double minorRadius)
 
   return nutProfile;
 }
+
+Profile2D createContourIsect(unsigned int gridCnt, unsigned int sidesCnt)
+{
+  // Grid of overlapping polygons: many short segments of similar size
+  const double radius = 1.0, step = 1.5;
+  Profile2D profile;
+  for (unsigned int i = 0; i < gridCnt; ++i)
+  {
+    for (unsigned int j = 0; j < gridCnt; ++j)
+    {
+      OdGeCircArc2d circle(OdGePoint2d(i * step, j * step), radius);
+      OdGePoint2dArray points;
+      circle.getSamplePoints(sidesCnt, points);
+      profile.push_back(Contour2D());
+      profile.back().appendVertices(points);
+      profile.back().setClosed();
+    }
+  }
+  // Long diagonals crossing the whole grid make segment sizes different
+  const double size = (gridCnt - 1) * step;
+  for (unsigned int i = 0; i < gridCnt; ++i)
+  {
+    profile.push_back(Contour2D());
+    profile.back().appendVertex(OdGePoint2d(i * step, 0.0));
+    profile.back().appendVertex(OdGePoint2d(size, size - i * step));
+  }
+
+  OdRxThreadPoolServicePtr pThreadPool = ::odrxDynamicLinker()->loadApp(OdThreadPoolModuleName, true);
+  ContourBroadPhaseIntersector intersector;
+  intersector.addGroup(true, (OdUInt32)profile.size());
+  intersector.addProfile(profile, 0);
+
+  static const ContourBroadPhase aBroadPhases[] = { ebpSweep, ebpGrid, ebpBVH, ebpAuto };
+  static const wchar_t* aNames[] = { L"sweep", L"grid", L"BVH", L"auto" };
+  odPrintConsoleString(L"\nContours: %u, thread pool: %ls", (unsigned)profile.size(), pThreadPool.isNull() ? L"no" : L"yes");
+  OdPerfTimerWrapper timer;
+  for (int i = 0; i < 4; ++i)
+  {
+    std::vector<IntersectionWithIDs> points;
+    timer.getTimer()->start();
+    const OdUInt32 nPoints = intersector.getIntersections(points, aBroadPhases[i], true, pThreadPool.get());
+    timer.getTimer()->stop();
+    odPrintConsoleString(L"\n%ls: %.3f s, intersections: %u", aNames[i], timer.getTimer()->countedSec(), nPoints);
+    if (aBroadPhases[i] == ebpAuto)
+      odPrintConsoleString(L", selected %ls", aNames[intersector.lastBroadPhase()]);
+  }
+  odPrintConsoleString(L"\n");
+
+  return profile;
+}
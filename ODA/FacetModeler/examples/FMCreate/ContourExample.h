@@ -64,3 +64,14 @@ Profile2D createPolygon(double radius = 4.0, unsigned int sidesCnt = 6);
 */
 Profile2D createNutProfile(double majorRadius = 4.0, double minorRadius = 3.0);
 
+/** \details
+   Benchmark of the contour intersection broad phases.
+   Intersects a grid of overlapping polygons crossed by long diagonal lines
+   using sweep, grid, BVH and automatically selected broad phase.
+
+   \param gridCnt  [in] Count of polygons along each side of the grid.
+   \param sidesCnt [in] Count of polygon sides.
+   \returns Resulting Profile2D with all intersected contours.
+*/
+Profile2D createContourIsect(unsigned int gridCnt = 40, unsigned int sidesCnt = 64);
+
@@ -39,6 +39,8 @@ FMCREATECASE(Wrench,          "single body - an example of using the Body::boolO
 FMCREATECASE(Logo,            "single body - an example of using the Body::boolOper",       CreateBodyExample  )
 FMCREATECASE(MeshTetra,       "single body - an example of using the Body::createFromMesh", CreateBodyExample  )
 FMCREATECASE(MeshCuboid,      "single body - an example of using the Body::createFromMesh", CreateBodyExample  )
+FMCREATECASE(CityBlocks,      "single body - benchmark of the N-ary boolUnion on city blocks", CreateBodyExample  )
+FMCREATECASE(MappedSphere,    "single body - benchmark of the BinaryStream and flat mapped body formats", CreateBodyExample  )
 FMCREATECASE(SliceBody,       "single profile - an example of using the Body::slice",       propsBodyExample )
 FMCREATECASE(IsectBody,       "points array - an example of using the Body::intersectLine", propsBodyExample )
 FMCREATECASE(VolumeBody,      "double value - an example of using the Body::volume",        propsBodyExample )
@@ -47,5 +49,6 @@ FMCREATECASE(Square,          "single profile - an example of contour2d/profile2
 FMCREATECASE(Circle,          "single profile - an example of contour2d/profile2d creation",          CreateContourExample )
 FMCREATECASE(Polygon,         "single profile - an example of contour2d/profile2d creation",          CreateContourExample )
 FMCREATECASE(NutProfile,      "single profile - an example of using the Profile2D::PerformOperation", CreateContourExample )
+FMCREATECASE(ContourIsect,    "single profile - benchmark of sweep, grid and BVH contour intersection broad phases", CreateContourExample )
 
 #undef FMCREATECASE
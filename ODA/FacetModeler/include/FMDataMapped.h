@@ -0,0 +1,492 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _FM_DATA_MAPPED_
+#define _FM_DATA_MAPPED_
+
+#include <OdaCommon.h>
+#include "OdPlatformSettings.h"
+#include "OdStreamBuf.h"
+#include "RxSystemServices.h"
+#include "Modeler/FMMdlBody.h"
+#include "Modeler/FMMdlIterators.h"
+#include "Ge/GePoint2d.h"
+#include <vector>
+#include <algorithm>
+#include <string.h>
+
+namespace FacetModeler
+{
+  /** \details
+     Header of the flat (memory-mappable) body layout.
+
+     \remarks
+     The layout consists of this header followed by sections of plain arrays.
+     Every section starts at an 8-byte aligned offset from the beginning of the data,
+     so the arrays can be used directly from the mapped memory without copying:
+
+     vertices      - OdGePoint3d[nVertices]
+     vertex flags  - OdUInt32[nVertices]
+     face data     - OdInt32[nFaceData], Body::createFromMesh() face data format
+     face flags    - OdUInt32[nFaces]
+     face colors   - OdUInt32[nFaces]
+     edge flags    - OdUInt32[nEdges], in face data order
+     edge colors   - OdUInt32[nEdges], in face data order
+     mapping       - OdGePoint2d[nMappingCoords], edge mapping coordinates in face data order,
+                     nMappingCoords is either 0 or nEdges
+
+     The layout keeps everything Body::createFromMesh() accepts. Surfaces and tags can't be
+     represented, so bodies which have them are rejected by the writer.
+
+     Data is written in native byte order. Data with foreign byte order or
+     unknown version is rejected by the reader.
+  */
+  struct MappedBodyHeader
+  {
+    /** \details
+       Defines flat layout format versions.
+    */
+    enum Version
+    {
+      /** Initial version. */
+      vInitial = 1,
+
+      /** Edge mapping coordinates. */
+      vMappingCoords = 2,
+
+      /** Current version. */
+      vCurrent = 2
+    };
+
+    /** \details
+       Defines layout sections.
+    */
+    enum Section
+    {
+      /** Vertex points. */
+      eVertices = 0,
+
+      /** Vertex flags. */
+      eVertexFlags,
+
+      /** Face data. */
+      eFaceData,
+
+      /** Face flags. */
+      eFaceFlags,
+
+      /** Face colors. */
+      eFaceColors,
+
+      /** Edge flags. */
+      eEdgeFlags,
+
+      /** Edge colors. */
+      eEdgeColors,
+
+      /** Edge mapping coordinates. */
+      eMappingCoords,
+
+      /** Number of sections. */
+      eNumSections
+    };
+
+    char     m_signature[4];               // "FMMB"
+    OdUInt16 m_version;                    // Layout version
+    OdUInt16 m_headerSize;                 // sizeof(MappedBodyHeader) of the writer
+    OdUInt32 m_byteOrder;                  // 0x01020304 in the writer byte order
+    OdUInt32 m_nVertices;                  // Number of vertices
+    OdUInt32 m_nFaces;                     // Number of faces
+    OdUInt32 m_nEdges;                     // Number of edges (face corners)
+    OdUInt32 m_nFaceData;                  // Number of integers in the face data
+    OdUInt32 m_nMappingCoords;             // Number of mapping coordinates, 0 or m_nEdges
+    OdUInt64 m_dataSize;                   // Total size of the header and all sections
+    OdUInt64 m_offsets[eNumSections];      // Offsets of the sections from the start of the header
+
+    /** \details
+       Constructor. Creates an empty header of the current version.
+    */
+    MappedBodyHeader()
+    {
+      ::memset(this, 0, sizeof(MappedBodyHeader));
+      ::memcpy(m_signature, "FMMB", 4);
+      m_version = vCurrent;
+      m_headerSize = (OdUInt16)sizeof(MappedBodyHeader);
+      m_byteOrder = 0x01020304;
+    }
+
+    /** \details
+       Checks whether the header describes valid data of the specified size.
+
+       \param nSize [in] Size of the available data in bytes.
+       \returns true if the header and all sections fit into the data, false otherwise.
+    */
+    bool isValid(OdUInt64 nSize) const
+    {
+      if (::memcmp(m_signature, "FMMB", 4) || m_version != vCurrent ||
+          m_headerSize != sizeof(MappedBodyHeader) || m_byteOrder != 0x01020304 ||
+          m_dataSize > nSize || (m_nMappingCoords && m_nMappingCoords != m_nEdges))
+        return false;
+      for (int nSection = 0; nSection < eNumSections; nSection++)
+      {
+        if ((m_offsets[nSection] & 7) || m_offsets[nSection] < sizeof(MappedBodyHeader) ||
+            m_offsets[nSection] + sectionSize((Section)nSection) > m_dataSize)
+          return false;
+      }
+      return true;
+    }
+
+    /** \details
+       Checks whether the face data matches the header.
+
+       \param pFaceData [in] Pointer to the face data section.
+       \returns true if the face data consists of m_nFaces faces with at least 3 vertices each,
+       vertex indices are less than m_nVertices, and face vertex counts sum to m_nEdges with
+       the whole section of m_nFaceData integers used, false otherwise.
+    */
+    bool isValidFaceData(const OdInt32* pFaceData) const
+    {
+      OdUInt32 nPos = 0;
+      OdUInt64 nEdges = 0;
+      for (OdUInt32 nFace = 0; nFace < m_nFaces; nFace++)
+      {
+        if (nPos >= m_nFaceData || pFaceData[nPos] < 3 || OdUInt32(pFaceData[nPos]) >= m_nFaceData - nPos)
+          return false;
+        const OdUInt32 nFaceEdges = OdUInt32(pFaceData[nPos++]);
+        for (OdUInt32 nEdge = 0; nEdge < nFaceEdges; nEdge++, nPos++)
+        {
+          if (pFaceData[nPos] < 0 || OdUInt32(pFaceData[nPos]) >= m_nVertices)
+            return false;
+        }
+        nEdges += nFaceEdges;
+      }
+      return nPos == m_nFaceData && nEdges == m_nEdges;
+    }
+
+    /** \details
+       Gets the size of the specified section.
+
+       \param eSection [in] Section.
+       \returns Size of the section in bytes.
+    */
+    OdUInt64 sectionSize(Section eSection) const
+    {
+      switch (eSection)
+      {
+      case eVertices:    return OdUInt64(m_nVertices) * sizeof(OdGePoint3d);
+      case eVertexFlags: return OdUInt64(m_nVertices) * sizeof(OdUInt32);
+      case eFaceData:    return OdUInt64(m_nFaceData) * sizeof(OdInt32);
+      case eFaceFlags:
+      case eFaceColors:  return OdUInt64(m_nFaces) * sizeof(OdUInt32);
+      case eEdgeFlags:
+      case eEdgeColors:  return OdUInt64(m_nEdges) * sizeof(OdUInt32);
+      case eMappingCoords: return OdUInt64(m_nMappingCoords) * sizeof(OdGePoint2d);
+      default:           return 0;
+      }
+    }
+
+    /** \details
+       Computes aligned section offsets and the total data size from the element counts.
+    */
+    void layout()
+    {
+      OdUInt64 nOffset = sizeof(MappedBodyHeader);
+      for (int nSection = 0; nSection < eNumSections; nSection++)
+      {
+        nOffset = (nOffset + 7) & ~OdUInt64(7);
+        m_offsets[nSection] = nOffset;
+        nOffset += sectionSize((Section)nSection);
+      }
+      m_dataSize = (nOffset + 7) & ~OdUInt64(7);
+    }
+  };
+
+  /** \details
+     Provides functionality for writing bodies in the flat memory-mappable layout.
+  */
+  class MappedBodyWriter
+  {
+  public:
+    /** \details
+       Writes the body into the stream buffer in the flat layout.
+
+       \param body  [in] Body to write.
+       \param pStream [in] Pointer to the stream buffer to write to.
+       \returns true if the body is written successfully, or false if the body has faces with holes,
+       surfaces or non-zero tags, which can not be represented by the flat layout.
+    */
+    static bool write(const Body& body, OdStreamBuf* pStream)
+    {
+      if (!pStream || body.surfaceCount() || body.tag())
+        return false;
+
+      // Vertex indices are found by binary search in the sorted vertex pointers
+      std::vector<const Vertex*> aVertices;
+      aVertices.reserve(body.vertexCount());
+      for (VertexIterator itV(&body); !itV.done(); itV.next())
+      {
+        if (itV.get()->tag())
+          return false;
+        aVertices.push_back(itV.get());
+      }
+      std::vector< std::pair<const Vertex*, OdUInt32> > aSorted(aVertices.size());
+      for (size_t nVertex = 0; nVertex < aVertices.size(); nVertex++)
+        aSorted[nVertex] = std::make_pair(aVertices[nVertex], (OdUInt32)nVertex);
+      std::sort(aSorted.begin(), aSorted.end());
+
+      MappedBodyHeader header;
+      header.m_nVertices = (OdUInt32)aVertices.size();
+
+      std::vector<OdInt32> aFaceData;
+      std::vector<OdUInt32> aFaceFlags, aFaceColors, aEdgeFlags, aEdgeColors;
+      std::vector<OdGePoint2d> aMappingCoords;
+      bool bMappingCoords = false;
+      aFaceFlags.reserve(body.faceCount());
+      aFaceColors.reserve(body.faceCount());
+      for (FaceIterator itF(&body); !itF.done(); itF.next())
+      {
+        const Face* pFace = itF.get();
+        if (pFace->loopCount() != 1 || pFace->surface() || pFace->tag())
+          return false;
+        const OdUInt32 nEdges = pFace->loopEdgeCount(0);
+        aFaceData.push_back((OdInt32)nEdges);
+        const Edge* pEdge = pFace->edge(0);
+        for (OdUInt32 nEdge = 0; nEdge < nEdges; nEdge++, pEdge = pEdge->next())
+        {
+          const std::pair<const Vertex*, OdUInt32> key(pEdge->vertex(), 0);
+          std::vector< std::pair<const Vertex*, OdUInt32> >::const_iterator itVtx =
+            std::lower_bound(aSorted.begin(), aSorted.end(), key);
+          if (itVtx == aSorted.end() || itVtx->first != pEdge->vertex() || pEdge->tag())
+            return false;
+          aFaceData.push_back((OdInt32)itVtx->second);
+          aEdgeFlags.push_back(pEdge->flags());
+          aEdgeColors.push_back(pEdge->color());
+          bool bInitialized = false;
+          aMappingCoords.push_back(pEdge->mappingCoord(bInitialized));
+          bMappingCoords |= bInitialized;
+        }
+        aFaceFlags.push_back(pFace->flags());
+        aFaceColors.push_back(pFace->color());
+      }
+      header.m_nFaces = (OdUInt32)aFaceFlags.size();
+      header.m_nEdges = (OdUInt32)aEdgeFlags.size();
+      header.m_nFaceData = (OdUInt32)aFaceData.size();
+      if (!bMappingCoords)
+        aMappingCoords.clear();
+      header.m_nMappingCoords = (OdUInt32)aMappingCoords.size();
+      header.layout();
+
+      std::vector<OdGePoint3d> aPoints(aVertices.size());
+      std::vector<OdUInt32> aVertexFlags(aVertices.size());
+      for (size_t nVertex = 0; nVertex < aVertices.size(); nVertex++)
+      {
+        aPoints[nVertex] = aVertices[nVertex]->point();
+        aVertexFlags[nVertex] = aVertices[nVertex]->flags();
+      }
+
+      OdUInt64 nWritten = 0;
+      putSection(pStream, nWritten, 0, &header, sizeof(MappedBodyHeader));
+      putVector(pStream, nWritten, header.m_offsets[MappedBodyHeader::eVertices], aPoints);
+      putVector(pStream, nWritten, header.m_offsets[MappedBodyHeader::eVertexFlags], aVertexFlags);
+      putVector(pStream, nWritten, header.m_offsets[MappedBodyHeader::eFaceData], aFaceData);
+      putVector(pStream, nWritten, header.m_offsets[MappedBodyHeader::eFaceFlags], aFaceFlags);
+      putVector(pStream, nWritten, header.m_offsets[MappedBodyHeader::eFaceColors], aFaceColors);
+      putVector(pStream, nWritten, header.m_offsets[MappedBodyHeader::eEdgeFlags], aEdgeFlags);
+      putVector(pStream, nWritten, header.m_offsets[MappedBodyHeader::eEdgeColors], aEdgeColors);
+      putVector(pStream, nWritten, header.m_offsets[MappedBodyHeader::eMappingCoords], aMappingCoords);
+      putSection(pStream, nWritten, header.m_dataSize, NULL, 0);
+      return true;
+    }
+
+    /** \details
+       Writes the body into the file in the flat layout.
+
+       \param body   [in] Body to write.
+       \param szFile [in] Filename string.
+       \returns true if the body is written successfully, or false otherwise.
+    */
+    static bool write(const Body& body, const OdString& szFile)
+    {
+      OdStreamBufPtr pStream = ::odrxSystemServices()->createFile(szFile, Oda::kFileWrite, Oda::kShareDenyReadWrite, Oda::kCreateAlways);
+      return write(body, pStream.get());
+    }
+
+  private:
+    static void putSection(OdStreamBuf* pStream, OdUInt64& nWritten, OdUInt64 nOffset, const void* pData, OdUInt32 nBytes)
+    {
+      static const OdUInt8 aPadding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+      ODA_ASSERT(nOffset >= nWritten && nOffset - nWritten < 8);
+      if (nOffset > nWritten)
+        pStream->putBytes(aPadding, (OdUInt32)(nOffset - nWritten));
+      if (nBytes)
+        pStream->putBytes(pData, nBytes);
+      nWritten = nOffset + nBytes;
+    }
+
+    template<typename T>
+    static void putVector(OdStreamBuf* pStream, OdUInt64& nWritten, OdUInt64 nOffset, const std::vector<T>& aData)
+    {
+      putSection(pStream, nWritten, nOffset, aData.empty() ? NULL : &aData.front(), (OdUInt32)(aData.size() * sizeof(T)));
+    }
+  };
+
+  /** \details
+     Provides read-only access to a body stored in the flat layout.
+
+     \remarks
+     The data is not owned by this object. Typically it is a memory-mapped file
+     (see OdFileMapping in ExServices), so arrays returned by the accessors point directly
+     into the mapped memory without copying.
+  */
+  class MappedBodyFile
+  {
+  public:
+    /** \details
+       Default constructor.
+    */
+    MappedBodyFile()
+      : m_pData(NULL), m_nSize(0)
+    {}
+
+    /** \details
+       Attaches to the flat layout data which is already in memory.
+
+       \param pData [in] Pointer to the 8-byte aligned data.
+       \param nSize [in] Size of the data in bytes.
+       \returns true if the data has a valid layout, or false otherwise.
+
+       \remarks
+       The data is not copied and must stay valid while this object is used.
+       Face data is checked against the header once here, so createBody() never passes
+       out of range vertex indices or inconsistent counts to Body::createFromMesh().
+    */
+    bool attach(const void* pData, OdUInt64 nSize)
+    {
+      detach();
+      if (!pData || nSize < sizeof(MappedBodyHeader) || (((OdIntPtr)pData) & 7))
+        return false;
+      const MappedBodyHeader* pHeader = reinterpret_cast<const MappedBodyHeader*>(pData);
+      if (!pHeader->isValid(nSize) || !pHeader->isValidFaceData(reinterpret_cast<const OdInt32*>(
+            (const OdUInt8*)pData + pHeader->m_offsets[MappedBodyHeader::eFaceData])))
+        return false;
+      m_pData = (const OdUInt8*)pData;
+      m_nSize = nSize;
+      return true;
+    }
+
+    /** \details
+       Detaches from the data.
+    */
+    void detach()
+    {
+      m_pData = NULL;
+      m_nSize = 0;
+    }
+
+    /** \details
+       Checks whether the data is available.
+
+       \returns true if the data is attached, false otherwise.
+    */
+    bool isOpen() const { return m_pData != NULL; }
+
+    /** \details
+       Gets the layout header.
+
+       \returns Reference to the header in the mapped memory.
+    */
+    const MappedBodyHeader& header() const
+    {
+      ODA_ASSERT(m_pData);
+      return *reinterpret_cast<const MappedBodyHeader*>(m_pData);
+    }
+
+    /** \returns Number of vertices. */
+    OdUInt32 vertexCount() const { return header().m_nVertices; }
+    /** \returns Number of faces. */
+    OdUInt32 faceCount() const { return header().m_nFaces; }
+    /** \returns Number of edges. */
+    OdUInt32 edgeCount() const { return header().m_nEdges; }
+    /** \returns Number of integers in the face data. */
+    OdUInt32 faceDataSize() const { return header().m_nFaceData; }
+
+    /** \returns Pointer to the vertex points in the mapped memory. */
+    const OdGePoint3d* vertices() const { return section<OdGePoint3d>(MappedBodyHeader::eVertices); }
+    /** \returns Pointer to the vertex flags in the mapped memory. */
+    const OdUInt32* vertexFlags() const { return section<OdUInt32>(MappedBodyHeader::eVertexFlags); }
+    /** \returns Pointer to the face data in the mapped memory. */
+    const OdInt32* faceData() const { return section<OdInt32>(MappedBodyHeader::eFaceData); }
+    /** \returns Pointer to the face flags in the mapped memory. */
+    const OdUInt32* faceFlags() const { return section<OdUInt32>(MappedBodyHeader::eFaceFlags); }
+    /** \returns Pointer to the face colors in the mapped memory. */
+    const OdUInt32* faceColors() const { return section<OdUInt32>(MappedBodyHeader::eFaceColors); }
+    /** \returns Pointer to the edge flags in the mapped memory. */
+    const OdUInt32* edgeFlags() const { return section<OdUInt32>(MappedBodyHeader::eEdgeFlags); }
+    /** \returns Pointer to the edge colors in the mapped memory. */
+    const OdUInt32* edgeColors() const { return section<OdUInt32>(MappedBodyHeader::eEdgeColors); }
+    /** \returns Pointer to the edge mapping coordinates in the mapped memory, or NULL if the body has no mapping coordinates. */
+    const OdGePoint2d* mappingCoords() const
+    {
+      return header().m_nMappingCoords ? section<OdGePoint2d>(MappedBodyHeader::eMappingCoords) : NULL;
+    }
+
+    /** \details
+       Creates a body from the mapped data.
+
+       \returns Resulting body, or an empty body if no data is available.
+
+       \remarks
+       Body::createFromMesh() accepts only std::vector arrays, so every section is copied
+       once in bulk. Sections are never parsed per element. Use the accessors to read
+       the data without copying.
+    */
+    Body createBody() const
+    {
+      if (!isOpen() || !faceCount())
+        return Body();
+      const std::vector<OdGePoint3d> aVertices(vertices(), vertices() + vertexCount());
+      const std::vector<OdInt32> aFaceData(faceData(), faceData() + faceDataSize());
+      const std::vector<OdUInt32> aFaceFlags(faceFlags(), faceFlags() + faceCount());
+      const std::vector<OdUInt32> aEdgeFlags(edgeFlags(), edgeFlags() + edgeCount());
+      const std::vector<OdUInt32> aVertexFlags(vertexFlags(), vertexFlags() + vertexCount());
+      const std::vector<OdUInt32> aFaceColors(faceColors(), faceColors() + faceCount());
+      const std::vector<OdUInt32> aEdgeColors(edgeColors(), edgeColors() + edgeCount());
+      if (!mappingCoords())
+        return Body::createFromMesh(aVertices, aFaceData, &aFaceFlags, &aEdgeFlags, &aVertexFlags, &aFaceColors, &aEdgeColors);
+      const std::vector<OdGePoint2d> aMappingCoords(mappingCoords(), mappingCoords() + edgeCount());
+      return Body::createFromMesh(aVertices, aFaceData, &aFaceFlags, &aEdgeFlags, &aVertexFlags, &aFaceColors, &aEdgeColors, &aMappingCoords);
+    }
+
+  private:
+    template<typename T>
+    const T* section(MappedBodyHeader::Section eSection) const
+    {
+      return reinterpret_cast<const T*>(m_pData + header().m_offsets[eSection]);
+    }
+
+    const OdUInt8* m_pData;                // Attached data
+    OdUInt64 m_nSize;                      // Size of the data in bytes
+  };
+
+} // ::
+#endif //_FM_DATA_MAPPED_
@@ -0,0 +1,235 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef __FMMDL_BODYBOOLTREE_H__
+#define __FMMDL_BODYBOOLTREE_H__
+
+#include "Modeler/FMMdlBody.h"
+#include "RxThreadPoolService.h"
+#include "RxDynamicModule.h"
+#include "DynamicLinker.h"
+#include "StaticRxObject.h"
+#include <algorithm>
+
+namespace FacetModeler
+{
+  /** \details
+     Statistics of the N-ary boolean union.
+  */
+  struct BoolTreeStats
+  {
+    /** Number of non-empty input bodies. */
+    OdUInt32 m_nOperands;
+    /** Number of performed boolean operations. */
+    OdUInt32 m_nBoolOpers;
+    /** Number of operand pairs with non-overlapping extents, which are combined without boolean operation. */
+    OdUInt32 m_nPrunedPairs;
+    /** Number of reduction tree levels. */
+    OdUInt32 m_nLevels;
+
+    BoolTreeStats() : m_nOperands(0), m_nBoolOpers(0), m_nPrunedPairs(0), m_nLevels(0) { }
+  };
+
+  /** \details
+     Reduces operands of N-ary boolean union by pairs. Used by boolUnion().
+  */
+  class BodyUnionReducer : public OdApcAtom
+  {
+  public:
+    enum PairResult
+    {
+      kNotProcessed = 0,
+      kBoolOper,
+      kPruned,
+      kFailed
+    };
+
+    std::vector<Body>          m_aBodies;
+    std::vector<OdGeExtents3d> m_aExtents;
+    std::vector<OdUInt8>       m_aResults;
+    bool                       m_bOptimization;
+
+    BodyUnionReducer() : m_bOptimization(false) { }
+
+    // Sorts operands along Morton curve of their extents centers, so neighbor operands are
+    // spatially close to each other.
+    void cluster()
+    {
+      const size_t nBodies = m_aBodies.size();
+      OdGeExtents3d extAll;
+      for (size_t nBody = 0; nBody < nBodies; nBody++)
+        extAll.addExt(m_aExtents[nBody]);
+      const OdGeVector3d vSize = extAll.maxPoint() - extAll.minPoint();
+      std::vector<std::pair<OdUInt32, OdUInt32> > aKeys(nBodies);
+      for (size_t nBody = 0; nBody < nBodies; nBody++)
+      {
+        const OdGePoint3d ptCenter = m_aExtents[nBody].center();
+        const double coords[3] = { ptCenter.x - extAll.minPoint().x, ptCenter.y - extAll.minPoint().y, ptCenter.z - extAll.minPoint().z };
+        const double sizes[3] = { vSize.x, vSize.y, vSize.z };
+        OdUInt32 nKey = 0;
+        for (int nAxis = 0; nAxis < 3; nAxis++)
+        {
+          const OdUInt32 nCell = (sizes[nAxis] > 0.0) ? OdUInt32(odmin(coords[nAxis] / sizes[nAxis], 1.0) * 1023.0) : 0;
+          for (int nBit = 0; nBit < 10; nBit++)
+            nKey |= ((nCell >> nBit) & 1) << (nBit * 3 + nAxis);
+        }
+        aKeys[nBody] = std::make_pair(nKey, (OdUInt32)nBody);
+      }
+      std::sort(aKeys.begin(), aKeys.end());
+      std::vector<Body> aBodies(nBodies);
+      std::vector<OdGeExtents3d> aExtents(nBodies);
+      for (size_t nBody = 0; nBody < nBodies; nBody++)
+      {
+        aBodies[nBody] = m_aBodies[aKeys[nBody].second];
+        aExtents[nBody] = m_aExtents[aKeys[nBody].second];
+      }
+      m_aBodies.swap(aBodies);
+      m_aExtents.swap(aExtents);
+    }
+
+    // Unites pair of operands into the first operand of pair
+    void apcEntryPoint(OdApcParamType nPair)
+    {
+      const size_t nFirst = size_t(nPair) * 2, nSecond = nFirst + 1;
+      try
+      {
+        if (m_aExtents[nFirst].isDisjoint(m_aExtents[nSecond], FMGeGbl::gTol))
+        {
+          m_aBodies[nFirst] = m_aBodies[nFirst].combine(m_aBodies[nSecond]);
+          m_aResults[nPair] = kPruned;
+        }
+        else
+        {
+          m_aBodies[nFirst] = Body::boolOper(eUnion, m_aBodies[nFirst], m_aBodies[nSecond], m_bOptimization);
+          m_aResults[nPair] = kBoolOper;
+        }
+        m_aExtents[nFirst].addExt(m_aExtents[nSecond]);
+      }
+      catch (...)
+      {
+        m_aResults[nPair] = kFailed;
+      }
+    }
+
+    // Performs one level of reduction tree. Returns false if any of operations is failed.
+    bool reduceLevel(OdApcQueue *pQueue, BoolTreeStats &stats)
+    {
+      const size_t nPairs = m_aBodies.size() / 2;
+      m_aResults.assign(nPairs, (OdUInt8)kNotProcessed);
+      if (pQueue && (nPairs > 1))
+      {
+        for (size_t nPair = 0; nPair < nPairs; nPair++)
+          pQueue->addEntryPoint(this, (OdApcParamType)nPair);
+        pQueue->wait();
+      }
+      else
+      {
+        for (size_t nPair = 0; nPair < nPairs; nPair++)
+          apcEntryPoint((OdApcParamType)nPair);
+      }
+      bool bSucceeded = true;
+      for (size_t nPair = 0; nPair < nPairs; nPair++)
+      {
+        switch (m_aResults[nPair])
+        {
+          case kBoolOper: stats.m_nBoolOpers++; break;
+          case kPruned: stats.m_nPrunedPairs++; break;
+          default: bSucceeded = false;
+        }
+        // Pair results are moved to the front, odd operand (if any) is moved to the end
+        m_aBodies[nPair] = m_aBodies[nPair * 2];
+        m_aExtents[nPair] = m_aExtents[nPair * 2];
+      }
+      if (m_aBodies.size() & 1)
+      {
+        m_aBodies[nPairs] = m_aBodies.back();
+        m_aExtents[nPairs] = m_aExtents.back();
+      }
+      m_aBodies.resize(m_aBodies.size() - nPairs);
+      m_aExtents.resize(m_aExtents.size() - nPairs);
+      stats.m_nLevels++;
+      return bSucceeded;
+    }
+  };
+
+  /** \details
+     Performs boolean union of any number of bodies destroying operands.
+
+     \param aOperands     [in] Operands. Cleared on return.
+     \param bOptimization [in] Optimization flag passed to Body::boolOper.
+     \param pThreadPool   [in] Thread pool used to perform independent operations in parallel. If null,
+                               thread pool module is used if it is loaded, otherwise operations are
+                               performed in calling thread.
+     \param pStats        [out] Optional statistics of performed operations.
+
+     \returns Resulting body.
+
+     \remarks
+     Operands are sorted along space filling curve of their extents centers and united by balanced
+     reduction tree, so operations of each tree level are independent from each other and operands
+     of each operation have comparable complexity. Pairs of operands with non-overlapping extents
+     are combined by Body::combine without boolean operation.
+     Throws OdError(eGeneralModelingFailure) if any of boolean operations is failed.
+  */
+  inline Body boolUnion(std::vector<Body>& aOperands, bool bOptimization = false,
+                        OdRxThreadPoolService* pThreadPool = NULL, BoolTreeStats* pStats = NULL)
+  {
+    OdStaticRxObject<BodyUnionReducer> reducer;
+    reducer.m_bOptimization = bOptimization;
+    for (size_t nBody = 0; nBody < aOperands.size(); nBody++)
+    {
+      if (aOperands[nBody].isNull())
+        continue;
+      reducer.m_aBodies.push_back(aOperands[nBody]);
+      reducer.m_aExtents.push_back(aOperands[nBody].interval());
+    }
+    aOperands.clear();
+    BoolTreeStats stats;
+    stats.m_nOperands = (OdUInt32)reducer.m_aBodies.size();
+    if (reducer.m_aBodies.empty())
+    {
+      if (pStats)
+        *pStats = stats;
+      return Body();
+    }
+    reducer.cluster();
+    OdApcQueuePtr pQueue;
+    if (reducer.m_aBodies.size() > 3)
+    {
+      OdRxThreadPoolServicePtr pTP = pThreadPool;
+      if (pTP.isNull())
+        pTP = ::odrxDynamicLinker()->getModule(OdThreadPoolModuleName);
+      if (!pTP.isNull())
+        pQueue = pTP->newMTQueue(ThreadsCounter::kNoAttributes, 0, kMtQueueAllowExecByMain);
+    }
+    bool bSucceeded = true;
+    while (bSucceeded && (reducer.m_aBodies.size() > 1))
+      bSucceeded = reducer.reduceLevel(pQueue.get(), stats);
+    if (pStats)
+      *pStats = stats;
+    if (!bSucceeded)
+      throw OdError(eGeneralModelingFailure);
+    return reducer.m_aBodies.front();
+  }
+}
+
+#endif //__FMMDL_BODYBOOLTREE_H__
@@ -0,0 +1,601 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef __FMGE_CONTOUR_BROADPHASE_H__
+#define __FMGE_CONTOUR_BROADPHASE_H__
+
+#include "Contours/FMContourIntersectors.h"
+#include "Contours/FMCachedSeg2D.h"
+#include "Ge/GeExtents2d.h"
+#include "RxThreadPoolService.h"
+#include "RxDynamicModule.h"
+#include "DynamicLinker.h"
+#include "StaticRxObject.h"
+#include <algorithm>
+
+namespace FacetModeler
+{
+
+    // Broad phase used to find candidate pairs of segments
+    enum ContourBroadPhase
+    {
+        ebpSweep = 0, // 1-D sweep of ContourIntersector
+        ebpGrid,      // Uniform 2D grid, best for many short segments of similar size
+        ebpBVH,       // 2D bounding volume hierarchy, best for segments of different sizes
+        ebpAuto       // Selected from number of segments and their sizes, see selectBroadPhase()
+    };
+
+
+    class ContourBroadPhaseIntersector;
+
+    // Thread pool task of ContourBroadPhaseIntersector
+    class ContourBroadPhaseChunk : public OdApcAtom
+    {
+    public:
+        ContourBroadPhaseChunk() : m_pOwner( NULL ) { };
+
+        void apcEntryPoint( OdApcParamType iChunk );
+
+        ContourBroadPhaseIntersector * m_pOwner;
+    };
+
+
+    // This helper class finds intersections of contours using 2D broad phase.
+    // Contours are added in the same way as into ContourIntersector and have the same grouping
+    // rules. Contours aren't copied, so they must stay valid until intersections are found.
+    // Candidate pairs of large inputs are intersected in parallel on the thread pool.
+
+    class ContourBroadPhaseIntersector
+    {
+    public:
+
+        ContourBroadPhaseIntersector( const OdGeTol & gTol = FMGeGbl::gTol )
+            : m_gTol( gTol ), m_eBroadPhase( ebpAuto ), m_bStopAtFirst( false ), m_bFound( false )
+            , m_uGridX( 0 ), m_uGridY( 0 ), m_dCellX( 0 ), m_dCellY( 0 )
+        { };
+
+        // Clear all groups and set tolerance
+        void reset( const OdGeTol & gTol = FMGeGbl::gTol )
+        {
+            m_gTol = gTol;
+            m_vecGroups.clear();
+            clearCache();
+        };
+
+        // Add a new group of contours. Returns group index.
+        OdUInt32 addGroup( bool bSelfIntersecting = false, OdUInt32 uReservedContours = 0 )
+        {
+            m_vecGroups.push_back( GroupRec() );
+            m_vecGroups.back().bSelfIntersecting = bSelfIntersecting;
+            m_vecGroups.back().vecContours.reserve( uReservedContours );
+            return (OdUInt32)m_vecGroups.size() - 1;
+        };
+
+        inline OdUInt32 numGroups() const { return (OdUInt32)m_vecGroups.size(); };
+
+        // Add contour/profile to an intersection group.
+        // Contours from rProfile are added with auto-incremented IDs, starting from uFirstID
+        Result addContour( const IContour2D & rContour, OdUInt32 uID, OdUInt32 uGroup = 0 )
+        {
+            if (uGroup >= m_vecGroups.size())
+                return erParamBounds;
+            m_vecGroups[uGroup].vecContours.push_back( ContourRec( &rContour, uID ) );
+            return erOk;
+        };
+
+        Result addProfile( const Profile2D & rProfile, OdUInt32 uFirstID, OdUInt32 uGroup = 0 )
+        {
+            for (OdUInt32 i = 0; i < (OdUInt32)rProfile.size(); i++)
+            {
+                Result res = addContour( rProfile[i].impl(), uFirstID + i, uGroup );
+                if (res != erOk)
+                    return res;
+            }
+            return erOk;
+        };
+
+        // Appends intersection points to vecPoints using specified broad phase.
+        // If pThreadPool is null, thread pool module is used if it is loaded.
+        // Returns number of intersections.
+        OdUInt32 getIntersections( std::vector< IntersectionWithIDs > & vecPoints,
+            ContourBroadPhase eBroadPhase = ebpAuto, bool bOrderByGroups = true,
+            OdRxThreadPoolService * pThreadPool = NULL )
+        {
+            if (!run( eBroadPhase, false, pThreadPool ))
+            {
+                ContourIntersector cSweep( m_gTol );
+                fillSweepIntersector( cSweep );
+                return cSweep.getIntersections( vecPoints, bOrderByGroups );
+            }
+            const size_t iPrevSize = vecPoints.size();
+            for (size_t iChunk = 0; iChunk < m_vecChunkResults.size(); iChunk++)
+            {
+                vecPoints.insert( vecPoints.end(), m_vecChunkResults[iChunk].begin(), m_vecChunkResults[iChunk].end() );
+            }
+            if (!bOrderByGroups)
+            {
+                // Order by contour IDs instead of groups
+                for (size_t i = iPrevSize; i < vecPoints.size(); i++)
+                {
+                    if (vecPoints[i].uContourA > vecPoints[i].uContourB)
+                        vecPoints[i].swapParams();
+                }
+            }
+            clearCache();
+            return (OdUInt32)(vecPoints.size() - iPrevSize);
+        };
+
+        // Returns true, if any intersection was found
+        bool hasIntersections( ContourBroadPhase eBroadPhase = ebpAuto, OdRxThreadPoolService * pThreadPool = NULL )
+        {
+            if (!run( eBroadPhase, true, pThreadPool ))
+            {
+                ContourIntersector cSweep( m_gTol );
+                fillSweepIntersector( cSweep );
+                return cSweep.hasIntersections();
+            }
+            const bool bFound = m_bFound;
+            clearCache();
+            return bFound;
+        };
+
+        // Returns broad phase used by the last getIntersections()/hasIntersections() call
+        inline ContourBroadPhase lastBroadPhase() const { return m_eBroadPhase; };
+
+    private:
+
+        friend class ContourBroadPhaseChunk;
+
+        // Processes chunk of grid cells or BVH queries
+        void processChunk( OdUInt32 uChunk )
+        {
+            const OdUInt32 uItems = (m_eBroadPhase == ebpGrid) ? m_uGridX * m_uGridY : (OdUInt32)m_vecSegments.size();
+            const OdUInt32 uFirst = uChunk * kChunkSize, uLast = odmin( uItems, uFirst + kChunkSize );
+            std::vector< IntersectionWithIDs > & vecDest = m_vecChunkResults[uChunk];
+            for (OdUInt32 uItem = uFirst; (uItem < uLast) && !(m_bStopAtFirst && m_bFound); uItem++)
+            {
+                if (m_eBroadPhase == ebpGrid)
+                    processCell( uItem, vecDest );
+                else
+                    processQuery( uItem, vecDest );
+            }
+        };
+
+        enum
+        {
+            kChunkSize = 1024,         // Grid cells or BVH queries processed by single thread pool task
+            kParallelThreshold = 4096, // Minimal number of segments to intersect in parallel
+            kLeafSize = 4,             // Maximal number of segments in BVH leaf
+            kAutoSweepThreshold = 256, // ebpAuto: maximal number of segments intersected by sweep
+            kAutoSizeRatio = 32        // ebpAuto: maximal/average segment size ratio which selects BVH instead of grid
+        };
+
+        struct ContourRec
+        {
+            ContourRec( const IContour2D * pC = NULL, OdUInt32 uID = 0 ) : pContour( pC ), uContourID( uID ) { };
+
+            const IContour2D * pContour;
+            OdUInt32 uContourID;
+        };
+
+        struct GroupRec
+        {
+            GroupRec() : bSelfIntersecting( false ) { };
+
+            bool bSelfIntersecting;
+            std::vector< ContourRec > vecContours;
+        };
+
+        struct Box2D
+        {
+            double dMinX, dMinY, dMaxX, dMaxY;
+
+            inline bool overlaps( const Box2D & rB ) const
+            {
+                return (dMinX <= rB.dMaxX) && (rB.dMinX <= dMaxX) && (dMinY <= rB.dMaxY) && (rB.dMinY <= dMaxY);
+            };
+            inline void add( const Box2D & rB )
+            {
+                dMinX = odmin( dMinX, rB.dMinX ); dMinY = odmin( dMinY, rB.dMinY );
+                dMaxX = odmax( dMaxX, rB.dMaxX ); dMaxY = odmax( dMaxY, rB.dMaxY );
+            };
+        };
+
+        struct SegmentRec
+        {
+            Box2D    box;
+            OdUInt32 uGroup;
+            OdUInt32 uContour;   // Index of contour in group
+            OdUInt32 uSegment;
+            OdUInt32 uSegments;  // Number of segments in contour
+            bool     bClosed;
+        };
+
+        struct BVHNode
+        {
+            Box2D    box;
+            OdUInt32 uFirst; // First item of leaf or index of the left child (right child follows it)
+            OdUInt32 uCount; // Number of items of leaf, zero for internal node
+        };
+
+        // Sorts segment indexes by box center along axis
+        struct CenterLess
+        {
+            CenterLess( const std::vector< SegmentRec > & vecS, int iAxis ) : m_vecS( vecS ), m_iAxis( iAxis ) { };
+
+            inline double center( OdUInt32 i ) const
+            {
+                const Box2D & b = m_vecS[i].box;
+                return m_iAxis ? (b.dMinY + b.dMaxY) : (b.dMinX + b.dMaxX);
+            };
+            inline bool operator ()( OdUInt32 i1, OdUInt32 i2 ) const { return center( i1 ) < center( i2 ); };
+
+            const std::vector< SegmentRec > & m_vecS;
+            int m_iAxis;
+        };
+
+        OdGeTol m_gTol;
+        std::vector< GroupRec > m_vecGroups;
+
+        // Data valid during run()
+        ContourBroadPhase m_eBroadPhase;
+        bool m_bStopAtFirst;
+        volatile bool m_bFound;
+        std::vector< SegmentRec > m_vecSegments;
+        std::vector< CachedSeg2D > m_vecGeometry;
+        Box2D m_boxAll;
+        // Grid: items of cell i are m_vecCellItems[ m_vecCellStart[i] .. m_vecCellStart[i + 1] )
+        OdUInt32 m_uGridX, m_uGridY;
+        double m_dCellX, m_dCellY;
+        std::vector< OdUInt32 > m_vecCellStart;
+        std::vector< OdUInt32 > m_vecCellItems;
+        // BVH
+        std::vector< BVHNode > m_vecNodes;
+        std::vector< OdUInt32 > m_vecNodeItems;
+        std::vector< std::vector< IntersectionWithIDs > > m_vecChunkResults;
+        OdStaticRxObject< ContourBroadPhaseChunk > m_chunkTask;
+
+    private:
+
+        void clearCache()
+        {
+            m_vecSegments.clear();
+            m_vecGeometry.clear();
+            m_vecCellStart.clear();
+            m_vecCellItems.clear();
+            m_vecNodes.clear();
+            m_vecNodeItems.clear();
+            m_vecChunkResults.clear();
+        };
+
+        void fillSweepIntersector( ContourIntersector & cSweep ) const
+        {
+            for (size_t iGroup = 0; iGroup < m_vecGroups.size(); iGroup++)
+            {
+                const GroupRec & rGroup = m_vecGroups[iGroup];
+                const OdUInt32 uGroup = cSweep.addGroup( rGroup.bSelfIntersecting, (OdUInt32)rGroup.vecContours.size() );
+                for (size_t iContour = 0; iContour < rGroup.vecContours.size(); iContour++)
+                    cSweep.addContour( *rGroup.vecContours[iContour].pContour, rGroup.vecContours[iContour].uContourID, uGroup );
+            }
+        };
+
+        void collectSegments()
+        {
+            const double dTol = m_gTol.equalPoint();
+            m_boxAll.dMinX = m_boxAll.dMinY = 1e300;
+            m_boxAll.dMaxX = m_boxAll.dMaxY = -1e300;
+            for (OdUInt32 uGroup = 0; uGroup < m_vecGroups.size(); uGroup++)
+            {
+                const GroupRec & rGroup = m_vecGroups[uGroup];
+                for (OdUInt32 uContour = 0; uContour < rGroup.vecContours.size(); uContour++)
+                {
+                    const IContour2D & rContour = *rGroup.vecContours[uContour].pContour;
+                    const OdUInt32 uSegments = rContour.numSegments();
+                    for (OdUInt32 uSegment = 0; uSegment < uSegments; uSegment++)
+                    {
+                        CachedSeg2D cSeg;
+                        if (rContour.getSegmentAt( uSegment, cSeg ) != erOk)
+                            continue;
+                        OdGeExtents2d ext;
+                        cSeg.addExtents( ext, dTol );
+                        SegmentRec rec;
+                        rec.box.dMinX = ext.minPoint().x; rec.box.dMinY = ext.minPoint().y;
+                        rec.box.dMaxX = ext.maxPoint().x; rec.box.dMaxY = ext.maxPoint().y;
+                        rec.uGroup = uGroup;
+                        rec.uContour = uContour;
+                        rec.uSegment = uSegment;
+                        rec.uSegments = uSegments;
+                        rec.bClosed = rContour.isClosed();
+                        m_boxAll.add( rec.box );
+                        m_vecSegments.push_back( rec );
+                        m_vecGeometry.push_back( cSeg );
+                    }
+                }
+            }
+        };
+
+        inline OdUInt32 cellX( double dX ) const
+        {
+            return odmin( m_uGridX - 1, (OdUInt32)odmax( 0.0, (dX - m_boxAll.dMinX) / m_dCellX ) );
+        };
+        inline OdUInt32 cellY( double dY ) const
+        {
+            return odmin( m_uGridY - 1, (OdUInt32)odmax( 0.0, (dY - m_boxAll.dMinY) / m_dCellY ) );
+        };
+
+        void buildGrid()
+        {
+            const OdUInt32 uSegments = (OdUInt32)m_vecSegments.size();
+            const double dSizeX = odmax( m_boxAll.dMaxX - m_boxAll.dMinX, m_gTol.equalPoint() );
+            const double dSizeY = odmax( m_boxAll.dMaxY - m_boxAll.dMinY, m_gTol.equalPoint() );
+            // About two segments per cell
+            const double dCell = sqrt( dSizeX * dSizeY * 2.0 / uSegments );
+            m_uGridX = (OdUInt32)odmax( 1.0, odmin( 4096.0, ceil( dSizeX / dCell ) ) );
+            m_uGridY = (OdUInt32)odmax( 1.0, odmin( 4096.0, ceil( dSizeY / dCell ) ) );
+            m_dCellX = dSizeX / m_uGridX;
+            m_dCellY = dSizeY / m_uGridY;
+            // Counting sort of segments by cells
+            m_vecCellStart.assign( m_uGridX * m_uGridY + 1, 0 );
+            for (int iPass = 0; iPass < 2; iPass++)
+            {
+                for (OdUInt32 uSeg = 0; uSeg < uSegments; uSeg++)
+                {
+                    const Box2D & b = m_vecSegments[uSeg].box;
+                    const OdUInt32 uX1 = cellX( b.dMinX ), uX2 = cellX( b.dMaxX );
+                    const OdUInt32 uY1 = cellY( b.dMinY ), uY2 = cellY( b.dMaxY );
+                    for (OdUInt32 uY = uY1; uY <= uY2; uY++)
+                    {
+                        for (OdUInt32 uX = uX1; uX <= uX2; uX++)
+                        {
+                            if (iPass)
+                                m_vecCellItems[m_vecCellStart[uY * m_uGridX + uX + 1]++] = uSeg;
+                            else
+                                m_vecCellStart[uY * m_uGridX + uX + 1]++;
+                        }
+                    }
+                }
+                if (!iPass)
+                {
+                    // Cell items are filled from m_vecCellStart[i + 1] which is shifted to the end of cell i
+                    for (size_t i = 1; i < m_vecCellStart.size(); i++)
+                        m_vecCellStart[i] += m_vecCellStart[i - 1];
+                    m_vecCellItems.resize( m_vecCellStart.back() );
+                    for (size_t i = m_vecCellStart.size() - 1; i > 0; i--)
+                        m_vecCellStart[i] = m_vecCellStart[i - 1];
+                }
+            }
+        };
+
+        void buildBVH()
+        {
+            const OdUInt32 uSegments = (OdUInt32)m_vecSegments.size();
+            m_vecNodeItems.resize( uSegments );
+            for (OdUInt32 uSeg = 0; uSeg < uSegments; uSeg++)
+                m_vecNodeItems[uSeg] = uSeg;
+            m_vecNodes.reserve( 2 * (uSegments / kLeafSize + 1) );
+            BVHNode root;
+            root.uFirst = 0;
+            root.uCount = uSegments;
+            m_vecNodes.push_back( root );
+            std::vector< OdUInt32 > vecStack( 1, 0 );
+            while (!vecStack.empty())
+            {
+                const OdUInt32 uNode = vecStack.back();
+                vecStack.pop_back();
+                const OdUInt32 uFirst = m_vecNodes[uNode].uFirst, uCount = m_vecNodes[uNode].uCount;
+                Box2D box = m_vecSegments[m_vecNodeItems[uFirst]].box;
+                for (OdUInt32 i = 1; i < uCount; i++)
+                    box.add( m_vecSegments[m_vecNodeItems[uFirst + i]].box );
+                m_vecNodes[uNode].box = box;
+                if (uCount <= kLeafSize)
+                    continue;
+                // Median split along the longest axis
+                const int iAxis = ((box.dMaxY - box.dMinY) > (box.dMaxX - box.dMinX)) ? 1 : 0;
+                const OdUInt32 uHalf = uCount / 2;
+                std::nth_element( m_vecNodeItems.begin() + uFirst, m_vecNodeItems.begin() + uFirst + uHalf,
+                                  m_vecNodeItems.begin() + uFirst + uCount, CenterLess( m_vecSegments, iAxis ) );
+                BVHNode left, right;
+                left.uFirst = uFirst; left.uCount = uHalf;
+                right.uFirst = uFirst + uHalf; right.uCount = uCount - uHalf;
+                const OdUInt32 uLeft = (OdUInt32)m_vecNodes.size();
+                m_vecNodes.push_back( left );
+                m_vecNodes.push_back( right );
+                m_vecNodes[uNode].uFirst = uLeft;
+                m_vecNodes[uNode].uCount = 0;
+                vecStack.push_back( uLeft );
+                vecStack.push_back( uLeft + 1 );
+            }
+        };
+
+        // Selects broad phase for collected segments. Sweep has the lowest setup cost, so it is used for small
+        // inputs. Long segments are registered in many grid cells, so BVH is used if segment sizes vary a lot.
+        ContourBroadPhase selectBroadPhase() const
+        {
+            const OdUInt32 uSegments = (OdUInt32)m_vecSegments.size();
+            if (uSegments < kAutoSweepThreshold)
+                return ebpSweep;
+            double dSum = 0.0, dMax = 0.0;
+            for (OdUInt32 uSeg = 0; uSeg < uSegments; uSeg++)
+            {
+                const Box2D & b = m_vecSegments[uSeg].box;
+                const double dSize = odmax( b.dMaxX - b.dMinX, b.dMaxY - b.dMinY );
+                dSum += dSize;
+                dMax = odmax( dMax, dSize );
+            }
+            return (dMax * uSegments > dSum * kAutoSizeRatio) ? ebpBVH : ebpGrid;
+        };
+
+        // Returns false if sweep must be used instead
+        bool run( ContourBroadPhase eBroadPhase, bool bStopAtFirst, OdRxThreadPoolService * pThreadPool )
+        {
+            clearCache();
+            m_eBroadPhase = eBroadPhase;
+            m_bStopAtFirst = bStopAtFirst;
+            m_bFound = false;
+            if (eBroadPhase == ebpSweep)
+                return false;
+            collectSegments();
+            if (eBroadPhase == ebpAuto)
+            {
+                m_eBroadPhase = eBroadPhase = selectBroadPhase();
+                if (eBroadPhase == ebpSweep)
+                {
+                    clearCache();
+                    return false;
+                }
+            }
+            const OdUInt32 uSegments = (OdUInt32)m_vecSegments.size();
+            if (uSegments < 2)
+                return true;
+            OdUInt32 uItems;
+            if (eBroadPhase == ebpGrid)
+            {
+                buildGrid();
+                uItems = m_uGridX * m_uGridY;
+            }
+            else
+            {
+                buildBVH();
+                uItems = uSegments;
+            }
+            const OdUInt32 uChunks = (uItems + kChunkSize - 1) / kChunkSize;
+            m_vecChunkResults.resize( uChunks );
+            m_chunkTask.m_pOwner = this;
+            OdApcQueuePtr pQueue;
+            if ((uSegments >= kParallelThreshold) && (uChunks > 1))
+            {
+                OdRxThreadPoolServicePtr pTP = pThreadPool;
+                if (pTP.isNull())
+                    pTP = ::odrxDynamicLinker()->getModule( OdThreadPoolModuleName );
+                if (!pTP.isNull())
+                    pQueue = pTP->newMTQueue( ThreadsCounter::kNoAttributes, 0, kMtQueueAllowExecByMain );
+            }
+            for (OdUInt32 uChunk = 0; uChunk < uChunks; uChunk++)
+            {
+                if (pQueue.isNull())
+                    processChunk( uChunk );
+                else
+                    pQueue->addEntryPoint( &m_chunkTask, (OdApcParamType)uChunk );
+            }
+            if (!pQueue.isNull())
+                pQueue->wait();
+            return true;
+        };
+
+        // Pairs in the cell. Pair is processed only in the cell which contains minimal corner of boxes overlap.
+        void processCell( OdUInt32 uCell, std::vector< IntersectionWithIDs > & vecDest )
+        {
+            const OdUInt32 uStart = m_vecCellStart[uCell], uEnd = m_vecCellStart[uCell + 1];
+            for (OdUInt32 i = uStart; i < uEnd; i++)
+            {
+                const OdUInt32 uSegA = m_vecCellItems[i];
+                const Box2D & boxA = m_vecSegments[uSegA].box;
+                for (OdUInt32 j = i + 1; j < uEnd; j++)
+                {
+                    const OdUInt32 uSegB = m_vecCellItems[j];
+                    const Box2D & boxB = m_vecSegments[uSegB].box;
+                    if (!boxA.overlaps( boxB ))
+                        continue;
+                    if (cellY( odmax( boxA.dMinY, boxB.dMinY ) ) * m_uGridX + cellX( odmax( boxA.dMinX, boxB.dMinX ) ) != uCell)
+                        continue;
+                    intersectPair( uSegA, uSegB, vecDest );
+                }
+            }
+        };
+
+        // Pairs of segment with segments of greater index
+        void processQuery( OdUInt32 uSegA, std::vector< IntersectionWithIDs > & vecDest )
+        {
+            const Box2D & boxA = m_vecSegments[uSegA].box;
+            OdUInt32 aStack[64];
+            OdUInt32 uStack = 0;
+            aStack[uStack++] = 0;
+            while (uStack)
+            {
+                const BVHNode & rNode = m_vecNodes[aStack[--uStack]];
+                if (!rNode.box.overlaps( boxA ))
+                    continue;
+                if (rNode.uCount)
+                {
+                    for (OdUInt32 i = 0; i < rNode.uCount; i++)
+                    {
+                        const OdUInt32 uSegB = m_vecNodeItems[rNode.uFirst + i];
+                        if ((uSegB > uSegA) && boxA.overlaps( m_vecSegments[uSegB].box ))
+                            intersectPair( uSegA, uSegB, vecDest );
+                    }
+                }
+                else
+                {
+                    aStack[uStack++] = rNode.uFirst;
+                    aStack[uStack++] = rNode.uFirst + 1;
+                }
+            }
+        };
+
+        // Narrow phase. Segment A always precedes segment B in group, contour and segment order.
+        void intersectPair( OdUInt32 uSegA, OdUInt32 uSegB, std::vector< IntersectionWithIDs > & vecDest )
+        {
+            const SegmentRec & rA = m_vecSegments[uSegA];
+            const SegmentRec & rB = m_vecSegments[uSegB];
+            bool bNextJoint = false, bPrevJoint = false;
+            if (rA.uGroup == rB.uGroup)
+            {
+                if (!m_vecGroups[rA.uGroup].bSelfIntersecting)
+                    return;
+                if (rA.uContour == rB.uContour)
+                {
+                    if (rA.uSegment == rB.uSegment)
+                        return;
+                    bNextJoint = (rB.uSegment == rA.uSegment + 1);
+                    bPrevJoint = rA.bClosed && !rA.uSegment && (rB.uSegment + 1 == rA.uSegments);
+                }
+            }
+            Intersection aInts[2];
+            const OdUInt32 uInts = m_vecGeometry[uSegA].intersect( m_vecGeometry[uSegB], &aInts[0], &aInts[1], m_gTol );
+            for (OdUInt32 i = 0; i < uInts; i++)
+            {
+                const Intersection & rInt = aInts[i];
+                // Skip joints of adjacent segments
+                if (bNextJoint && rInt.ptPoint.isEqualTo( m_vecGeometry[uSegA].endPt(), m_gTol ))
+                    continue;
+                if (bPrevJoint && rInt.ptPoint.isEqualTo( m_vecGeometry[uSegA].startPt(), m_gTol ))
+                    continue;
+                if (m_bStopAtFirst)
+                {
+                    m_bFound = true;
+                    return;
+                }
+                vecDest.push_back( IntersectionWithIDs( rInt.ptPoint,
+                    m_vecGroups[rA.uGroup].vecContours[rA.uContour].uContourID, rA.uSegment + rInt.dParamA,
+                    m_vecGroups[rB.uGroup].vecContours[rB.uContour].uContourID, rB.uSegment + rInt.dParamB, rInt.eType ) );
+            }
+        };
+    };
+
+    inline void ContourBroadPhaseChunk::apcEntryPoint( OdApcParamType iChunk )
+    {
+        m_pOwner->processChunk( (OdUInt32)iChunk );
+    }
+
+};
+
+#endif  //__FMGE_CONTOUR_BROADPHASE_H__
@@ -35,12 +35,17 @@
 #include "Ge/GePlane.h"
 #include "Ge/GeLineSeg3d.h"
 #include <UInt32Array.h>
-#include "Si/SiSpatialIndex.h"
+#include "Si/SiPackedRTree.h"
 #include "Si/SiShapePlane.h"
 #include "Si/SiShapeBoundPlane.h"
 #include "Si/SiShapeRay.h"
 #include "Ge/GeLine3d.h"
 #include "FMDebugDraw.h"
+#include "RxThreadPoolService.h"
+#include "RxDynamicModule.h"
+#include "DynamicLinker.h"
+#include "StaticRxObject.h"
+#include <algorithm>
 //#include "../sampleapplications/TADebugTx/Debug.h"
 
 namespace FacetModeler
@@ -119,11 +124,11 @@ public:
   ~FaceSpatialIndex() {
     destroy( true );
   }
-  OdSiSpatialIndex& build( const Body* pBody, double eps ) {
+  OdSiSpatialIndex& build( const Body* pBody, double eps, OdUInt32 siFlags = OdSiSpatialIndex::kSiNoFlags ) {
     destroy();
     OdUInt32 n = pBody->faceCount();
     if ( n ) {
-      m_pFacesIndex = OdSiSpatialIndex::createObject( false, 0, 30, 20, eps );
+      m_pFacesIndex = OdSi::createSpatialIndex( siFlags, 0, 30, 20, eps );
       m_spatialDataArray.resize( n );
       TSpatFData* pSFD = m_spatialDataArray.asArrayPtr();
       FaceIterator iter( pBody );
@@ -383,4 +388,167 @@ public:
   }
 };
 
+//////////////////////////////////////////////////////////////////////////
+// Slices explicitly specified faces by single plane, without spatial index query.
+class PlaneFacesSlicer : public SlicerBaseImpl
+{
+public:
+  void slice( const OdGePlane& cutPlane, const FaceConstPtrArray& faces,
+              const OdGeTol& tol, Profile2D* pResult )
+  {
+    EdgeGraph::Clear();
+    setTolerance( tol );
+    set_cut_plane( cutPlane );
+    ReserveBuffers( faces.size() );
+    m_pCurSegMerger = &m_segmentsMerger;
+    for( OdUInt32 i = 0; i < faces.size(); ++i )
+      collect_face( faces[i] );
+    collect_all_segments();
+    bool checkFaceByRay = false;
+    build_results( pResult, 0, 0, 0, 0, 0, false, checkFaceByRay );
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////
+// Slices body by set of parallel planes.
+// Faces are distributed between planes by single pass over the body: each face is
+// added to the planes which lie within its extent along the planes normal. Profiles
+// of different planes are built concurrently on the thread pool.
+class MultiPlaneSlicer : public OdApcAtom
+{
+  const OdGePlane*               m_pPlanes;
+  Profile2D*                     m_pResults;
+  std::vector<FaceConstPtrArray> m_faces; // Faces crossing each plane
+  std::vector<OdResult>          m_status; // Result of each plane slicing
+  OdGeTol                        m_tol;
+
+  struct OffsetLess
+  {
+    const std::vector<double>& m_offsets;
+    OffsetLess( const std::vector<double>& offsets ) : m_offsets( offsets ) {}
+    bool operator()( OdUInt32 i1, OdUInt32 i2 ) const { return m_offsets[i1] < m_offsets[i2]; }
+  };
+public:
+  MultiPlaneSlicer() : m_pPlanes( 0 ), m_pResults( 0 ) {}
+
+  // Slices single plane. Called by thread pool, so failure is recorded instead of being thrown
+  // on worker thread.
+  void apcEntryPoint( OdApcParamType nPlane )
+  {
+    try
+    {
+      PlaneFacesSlicer slicer;
+      slicer.slice( m_pPlanes[nPlane], m_faces[nPlane], m_tol, m_pResults + nPlane );
+    }
+    catch( const OdError& err )
+    {
+      m_status[nPlane] = err.code();
+    }
+    catch( ... )
+    {
+      m_status[nPlane] = eGeneralModelingFailure;
+    }
+  }
+
+  // Slices body by planes. All planes must be parallel. Planes are expected to be sorted along
+  // the normal of the first plane, unsorted planes are sorted internally.
+  // pResults must point to nPlanes profiles. eps is relative tolerance, it is scaled by body
+  // extents in the same way as tolerance of the face spatial index.
+  // If pThreadPool is null, thread pool module is used if it is loaded.
+  // If slicing of any plane fails, OdError with its result is thrown after all planes are processed.
+  void slice( const Body* pBody, const OdGePlane* pPlanes, OdUInt32 nPlanes, Profile2D* pResults,
+              double eps = OdGeTol().equalVector(), OdRxThreadPoolService* pThreadPool = 0 )
+  {
+    if( !nPlanes )
+      return;
+    const OdGeVector3d normal = pPlanes[0].normal();
+    for( OdUInt32 i = 1; i < nPlanes; ++i )
+    {
+      if( !pPlanes[i].normal().isParallelTo( normal ) )
+        throw OdError( eInvalidInput );
+    }
+    m_pPlanes = pPlanes;
+    m_pResults = pResults;
+    const OdGeExtents3d bodyExt = pBody->interval();
+    double scale = 1.0;
+    if( bodyExt.isValidExtents() )
+      scale = mymax( scale, ( bodyExt.maxPoint() - bodyExt.minPoint() ).length() );
+    m_tol = OdGeTol( eps * scale, 1e-5 );
+    const double offsetTol = m_tol.equalPoint();
+
+    // Plane offsets along normal in ascending order
+    std::vector<double> offsets( nPlanes );
+    std::vector<OdUInt32> order( nPlanes );
+    for( OdUInt32 i = 0; i < nPlanes; ++i )
+    {
+      offsets[i] = normal.dotProduct( pPlanes[i].pointOnPlane().asVector() );
+      order[i] = i;
+    }
+    bool bSorted = true;
+    for( OdUInt32 i = 1; i < nPlanes && bSorted; ++i )
+      bSorted = offsets[i - 1] <= offsets[i];
+    if( !bSorted )
+      std::sort( order.begin(), order.end(), OffsetLess( offsets ) );
+    std::vector<double> sortedOffsets( nPlanes );
+    for( OdUInt32 i = 0; i < nPlanes; ++i )
+      sortedOffsets[i] = offsets[order[i]];
+
+    // Single pass over faces
+    m_faces.clear();
+    m_faces.resize( nPlanes );
+    FaceIterator iter( pBody );
+    while( !iter.done() )
+    {
+      const Face* pFace = iter.get();
+      iter.next();
+      Edge* pEdge = pFace->edge();
+      if( !pEdge )
+        continue;
+      Edge* pEnd = pEdge;
+      double minOffset = normal.dotProduct( pEdge->vertex()->point().asVector() ), maxOffset = minOffset;
+      do
+      {
+        pEdge = pEdge->next();
+        const double offset = normal.dotProduct( pEdge->vertex()->point().asVector() );
+        minOffset = odmin( minOffset, offset );
+        maxOffset = odmax( maxOffset, offset );
+      }
+      while( pEdge != pEnd );
+      std::vector<double>::const_iterator itFirst =
+        std::lower_bound( sortedOffsets.begin(), sortedOffsets.end(), minOffset - offsetTol );
+      std::vector<double>::const_iterator itLast =
+        std::upper_bound( itFirst, (std::vector<double>::const_iterator)sortedOffsets.end(), maxOffset + offsetTol );
+      for( ; itFirst != itLast; ++itFirst )
+        m_faces[order[itFirst - sortedOffsets.begin()]].push_back( pFace );
+    }
+
+    OdApcQueuePtr pQueue;
+    if( nPlanes > 1 )
+    {
+      OdRxThreadPoolServicePtr pTP = pThreadPool;
+      if( pTP.isNull() )
+        pTP = ::odrxDynamicLinker()->getModule( OdThreadPoolModuleName );
+      if( !pTP.isNull() )
+        pQueue = pTP->newMTQueue( ThreadsCounter::kNoAttributes, 0, kMtQueueAllowExecByMain );
+    }
+    m_status.assign( nPlanes, eOk );
+    for( OdUInt32 i = 0; i < nPlanes; ++i )
+    {
+      if( pQueue.isNull() )
+        apcEntryPoint( (OdApcParamType)i );
+      else
+        pQueue->addEntryPoint( this, (OdApcParamType)i );
+    }
+    if( !pQueue.isNull() )
+      pQueue->wait();
+    m_faces.clear();
+    // Failure of the first failed plane is thrown in calling thread after all planes are processed
+    for( OdUInt32 i = 0; i < nPlanes; ++i )
+    {
+      if( m_status[i] != eOk )
+        throw OdError( m_status[i] );
+    }
+  }
+};
+
 }
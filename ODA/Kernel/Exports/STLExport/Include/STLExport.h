@@ -35,6 +35,7 @@
 #include "Gi/GiDrawable.h"
 #include "OdStreamBuf.h"
 #include "DbBaseDatabase.h"
+#include "Gs/GsDevicePool.h"
 
 /** \details
   <group OdExport_Classes> 
@@ -80,6 +81,42 @@ namespace TD_STL_EXPORT
   */
   OdResult exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool positiveOctant = true);
 
+  /** \details
+    Exports an element to STL format stream using device from the pool.
+
+    \param pDb            [in] Database.
+    \param pEntity        [in] Entity to export.
+    \param pOutStream    [out] Output stream.
+    \param bTextMode      [in] If true, export to ASCII STL format, else to binary STL format.
+    \param dDeviation     [in] Maximum allowed deviation.
+    \param positiveOctant [in] If true, move STL coordinates into all positive octant.
+    \param pPool          [in] Pool created by createSTLDevicePool() with the same bTextMode.
+    \returns eOk if successful, or an appropriate error code otherwise.
+  */
+  OdResult exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool positiveOctant, OdGsDevicePool *pPool);
+
+  /** \details
+    Exports an element to STL format stream with checking of solid topology using device from the pool.
+
+    \param pDb            [in] Database.
+    \param pEntity        [in] Entity to export.
+    \param pOutStream    [out] Output stream.
+    \param bTextMode      [in] If true, export to ASCII STL format, else to binary STL format.
+    \param dDeviation     [in] Maximum allowed deviation.
+    \param positiveOctant [in] If true, move STL coordinates into all positive octant.
+    \param pPool          [in] Pool created by createSTLDevicePool() with the same bTextMode.
+    \returns eOk if successful, or an appropriate error code otherwise.
+  */
+  OdResult exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool positiveOctant, OdGsDevicePool *pPool);
+
+  /** \details
+    Creates pool of devices for batch STL export.
+
+    \param bTextMode [in] If true, pool serves ASCII STL export, else binary STL export.
+    \param nMaxIdle  [in] Maximal number of idle devices kept by pool.
+  */
+  OdGsDevicePoolPtr createSTLDevicePool(bool bTextMode, OdUInt32 nMaxIdle = 4);
+
 };
 
 #endif // _STL_EXPORT_INCLUDED_
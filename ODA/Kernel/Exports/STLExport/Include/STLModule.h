@@ -28,6 +28,7 @@
 #include "STLExportDef.h"
 #include "RxDynamicModule.h"
 #include "DbBaseDatabase.h"
+#include "Gs/GsDevicePool.h"
 
 class OdGiDrawable;
 class OdStreamBuf;
@@ -90,6 +91,26 @@ namespace TD_STL_EXPORT
       are positive numbers from the (0.01, +inf) interval.
     */
     virtual OdResult exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool positiveOctant = true);
+
+    /** \details
+      Exports an element to STL format stream using device from the pool.
+      See exportSTL() and createDevicePool().
+    */
+    virtual OdResult exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool positiveOctant, OdGsDevicePool *pPool);
+
+    /** \details
+      Exports an element to STL format stream with checking of solid topology using device from the pool.
+      See exportSTLEx() and createDevicePool().
+    */
+    virtual OdResult exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool positiveOctant, OdGsDevicePool *pPool);
+
+    /** \details
+      Creates pool of devices for batch STL export.
+
+      \param bTextMode [in] If true, pool serves ASCII STL export, else binary STL export.
+      \param nMaxIdle  [in] Maximal number of idle devices kept by pool.
+    */
+    virtual OdGsDevicePoolPtr createDevicePool(bool bTextMode, OdUInt32 nMaxIdle = 4);
   };
 
   /** \details
@@ -470,14 +470,10 @@ namespace TD_STL_EXPORT
     }
   };
 
+  // Output stream is set into the view by each export, so one module instance (and
+  // devices created by it) could serve any number of exports.
   class StubDeviceModuleText : public OdGsBaseModule
   {
-    OdStreamBuf *m_pOutStream;
-  public:
-    void setStream(OdStreamBuf *pOutStream) 
-    {
-      m_pOutStream = pOutStream;
-    }
   protected:
     OdSmartPtr<OdGsBaseVectorizeDevice> createDeviceObject()
     {
@@ -485,9 +481,7 @@ namespace TD_STL_EXPORT
     }
     OdSmartPtr<OdGsViewImpl> createViewObject()
     {
-      OdSmartPtr<OdGsViewImpl> pP = OdRxObjectImpl<OdSTLOutText, OdGsViewImpl>::createObject();
-      ((OdSTLOutText*)pP.get())->setStream(m_pOutStream);
-      return pP;
+      return OdRxObjectImpl<OdSTLOutText, OdGsViewImpl>::createObject();
     }
     OdSmartPtr<OdGsBaseVectorizeDevice> createBitmapDeviceObject()
     {
@@ -499,14 +493,10 @@ namespace TD_STL_EXPORT
     }
   };
 
+  // Output stream is set into the view by each export, so one module instance (and
+  // devices created by it) could serve any number of exports.
   class StubDeviceModuleBinary : public OdGsBaseModule
   {
-    OdStreamBuf *m_pOutStream;
-  public:
-    void setStream(OdStreamBuf *pOutStream) 
-    {
-      m_pOutStream = pOutStream;
-    }
   protected:
     OdSmartPtr<OdGsBaseVectorizeDevice> createDeviceObject()
     {
@@ -514,9 +504,7 @@ namespace TD_STL_EXPORT
     }
     OdSmartPtr<OdGsViewImpl> createViewObject()
     {
-      OdSmartPtr<OdGsViewImpl> pP = OdRxObjectImpl<OdSTLOutBinary, OdGsViewImpl>::createObject();
-      ((OdSTLOutBinary*)pP.get())->setStream(m_pOutStream);
-      return pP;
+      return OdRxObjectImpl<OdSTLOutBinary, OdGsViewImpl>::createObject();
     }
     OdSmartPtr<OdGsBaseVectorizeDevice> createBitmapDeviceObject()
     {
@@ -541,7 +529,8 @@ namespace TD_STL_EXPORT
     virtual void vectorizationTest(OdGsDevicePtr pDevice) const;
   };
 
-  void tryToVectorize(OdGiDrawable &pEntity, OdStreamBuf &pOutStream, OdDbBaseDatabase *pDb, bool bTextMode, double dDeviation, bool fCorrectSolids, bool positiveOctant, const TryToVectorizeMod &pMod = TryToVectorizeMod());
+  void tryToVectorize(OdGiDrawable &pEntity, OdStreamBuf &pOutStream, OdDbBaseDatabase *pDb, bool bTextMode, double dDeviation, bool fCorrectSolids, bool positiveOctant,
+                      OdGsDevicePool *pPool = NULL, const TryToVectorizeMod &pMod = TryToVectorizeMod());
 
   void TryToVectorizeMod::modifyContext(OdGiDefaultContextPtr &/*pCtx*/) const { }
   
@@ -577,40 +566,62 @@ namespace TD_STL_EXPORT
     pDevice->update();
   }
 
-  void tryToVectorize(OdGiDrawable &pEntity, OdStreamBuf &pOutStream, OdDbBaseDatabase *pDb, bool bTextMode, double dDeviation, bool fCorrectSolids, bool positiveOctant, const TryToVectorizeMod &pMod)
+  OdGsModulePtr stubDeviceModule(bool bTextMode)
   {
-    odgsInitialize();
-    OdGsModulePtr pGsModule = bTextMode ? ODRX_STATIC_MODULE_ENTRY_POINT(StubDeviceModuleText)(OD_T("StubDeviceModuleText"))
-                                        : ODRX_STATIC_MODULE_ENTRY_POINT(StubDeviceModuleBinary)(OD_T("StubDeviceModuleBinary"));
+    return bTextMode ? ODRX_STATIC_MODULE_ENTRY_POINT(StubDeviceModuleText)(OD_T("StubDeviceModuleText"))
+                     : ODRX_STATIC_MODULE_ENTRY_POINT(StubDeviceModuleBinary)(OD_T("StubDeviceModuleBinary"));
+  }
+
+  // Pseudo static entry point creates new module instance on each call, so pooled export uses
+  // module instance owned by the pool.
+  OdGsModulePtr stubDeviceModule(bool bTextMode, OdGsDevicePool *pPool)
+  {
+    if (!pPool)
+      return stubDeviceModule(bTextMode);
+    OdGsModulePtr pGsModule = pPool->module();
+    if (pGsModule->moduleName() != (bTextMode ? OD_T("StubDeviceModuleText") : OD_T("StubDeviceModuleBinary")))
+      throw OdError(eInvalidInput); // Pool isn't created by createSTLDevicePool() with the same mode
+    return pGsModule;
+  }
 
-    if (bTextMode)
-      ((StubDeviceModuleText*)pGsModule.get())->setStream(&pOutStream);
-    else
-      ((StubDeviceModuleBinary*)pGsModule.get())->setStream(&pOutStream);
+  void tryToVectorize(OdGiDrawable &pEntity, OdStreamBuf &pOutStream, OdDbBaseDatabase *pDb, bool bTextMode, double dDeviation, bool fCorrectSolids, bool positiveOctant,
+                      OdGsDevicePool *pPool, const TryToVectorizeMod &pMod)
+  {
+    OdGsModulePtr pGsModule = stubDeviceModule(bTextMode, pPool);
+    odgsInitialize();
 
     OdGiDefaultContextPtr pContext = OdDbBaseDatabasePEPtr(pDb)->createGiContext(pDb);
-    OdGsDevicePtr pDevice = pGsModule->createDevice();
+    {
+      // Device is taken from the pool if specified, so Gs and device initialization is shared between exports
+      OdGsDevicePoolLease deviceLease(pPool, pGsModule);
+      OdGsDevicePtr pDevice = deviceLease.device();
 
-    //pContext->setDatabase(pDb);
-    //pContext->enableGsModel(bGsModelEnable);
-    pMod.modifyContext(pContext);
-    pMod.initDevice(&pEntity, pDb, pDevice, pContext, dDeviation, fCorrectSolids, positiveOctant);
+      //pContext->setDatabase(pDb);
+      //pContext->enableGsModel(bGsModelEnable);
+      pMod.modifyContext(pContext);
+      pMod.initDevice(&pEntity, pDb, pDevice, pContext, dDeviation, fCorrectSolids, positiveOctant);
+      // Stream belongs to this export only, pooled device gets new view for each export
+      for (int nView = 0; nView < pDevice->numViews(); nView++)
+        static_cast<OdSTLOutBase*>(pDevice->viewAt(nView))->setStream(&pOutStream);
 
-    OdGsDCRect screenRect(OdGsDCPoint(0, 1000), OdGsDCPoint(1000, 0));
-    pDevice->onSize(screenRect);
-    pMod.vectorizationTest(pDevice);
-    pDevice.release();
+      OdGsDCRect screenRect(OdGsDCPoint(0, 1000), OdGsDCPoint(1000, 0));
+      pDevice->onSize(screenRect);
+      pMod.vectorizationTest(pDevice);
+      pDevice.release();
+      deviceLease.setSucceeded();
+    }
     pContext.release();
     pGsModule.release();
     odgsUninitialize();
   }
 
-  OdResult doExport(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool fCorrectSolid, bool positiveOctant)
+  OdResult doExport(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool fCorrectSolid, bool positiveOctant,
+                    OdGsDevicePool *pPool = NULL)
   {
     OdResult ret = eOk;
     try
     {
-      tryToVectorize((OdGiDrawable &)pEntity, pOutStream, pDb, bTextMode, dDeviation, fCorrectSolid, positiveOctant);
+      tryToVectorize((OdGiDrawable &)pEntity, pOutStream, pDb, bTextMode, dDeviation, fCorrectSolid, positiveOctant, pPool);
     }
     catch (const OdError& e)
     {
@@ -633,4 +644,19 @@ namespace TD_STL_EXPORT
   {
     return doExport(pDb, pEntity, pOutStream, bTextMode, dDeviation, true, positiveOctant);
   }
+
+  OdResult exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool positiveOctant, OdGsDevicePool *pPool)
+  {
+    return doExport(pDb, pEntity, pOutStream, bTextMode, dDeviation, false, positiveOctant, pPool);
+  }
+
+  OdResult exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool positiveOctant, OdGsDevicePool *pPool)
+  {
+    return doExport(pDb, pEntity, pOutStream, bTextMode, dDeviation, true, positiveOctant, pPool);
+  }
+
+  OdGsDevicePoolPtr createSTLDevicePool(bool bTextMode, OdUInt32 nMaxIdle)
+  {
+    return OdGsDevicePool::createObject(stubDeviceModule(bTextMode), nMaxIdle);
+  }
 };
@@ -49,4 +49,19 @@ OdResult STLModule::exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEnti
 {
   return TD_STL_EXPORT::exportSTLEx(pDb, pEntity, pOutStream, bTextMode, dDeviation, positiveOctant);
 }
+
+OdResult STLModule::exportSTL(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool positiveOctant, OdGsDevicePool *pPool)
+{
+  return TD_STL_EXPORT::exportSTL(pDb, pEntity, pOutStream, bTextMode, dDeviation, positiveOctant, pPool);
+}
+
+OdResult STLModule::exportSTLEx(OdDbBaseDatabase *pDb, const OdGiDrawable &pEntity, OdStreamBuf &pOutStream, bool bTextMode, double dDeviation, bool positiveOctant, OdGsDevicePool *pPool)
+{
+  return TD_STL_EXPORT::exportSTLEx(pDb, pEntity, pOutStream, bTextMode, dDeviation, positiveOctant, pPool);
+}
+
+OdGsDevicePoolPtr STLModule::createDevicePool(bool bTextMode, OdUInt32 nMaxIdle)
+{
+  return TD_STL_EXPORT::createSTLDevicePool(bTextMode, nMaxIdle);
+}
 }
@@ -59,6 +59,15 @@
   * "ExplodeShxTexts" - SHX texts are represented as lines & curves (true by default)
   * "RemoveFirstSpacesOfText" Skip initial spaces when rendering text strings (true by default)
   * "ColorPolicy" - 0 = Colors are unchanged, 1 = Drawing is converted to monochrome, 2 = Drawing is converted to grayscale
+  * "ShareDefinitions" - Identical clip paths and gradients are written once, block references
+      differing by position and rotation only are written as <use> of shared <symbol> (false by default)
+  * "StreamOutput" - Completed groups are written to "Output" during vectorization and released,
+      instead of building whole document in memory (false by default)
+
+  Device can be reused for subsequent exports, for example through OdGsDevicePool
+  (Gs/GsDevicePool.h) created for SvgExport module. "Output" is released at the end of
+  OdGsDevice::update(), so it must be set for every export; other properties keep their
+  values. Render devices of shaded viewports are released together with the views.
 */
 
 #endif
@@ -36,6 +36,7 @@
 #include "../../2dExport/Include/2dExportDevice.h"
 #include "DbHyperlink.h"
 #include "Gi/GiRasterWrappers.h"
+#include "Gi/GiDummyGeometry.h"
 #include "DynamicLinker.h"
 
 #define STL_USING_STACK
@@ -76,6 +77,7 @@ public:
 
   virtual void onTraitsModified();
   void draw(const OdGiDrawable* pDrawable);
+  bool drawBlockSymbol(const OdGiDrawable* pDrawable);
 
   TD_USING(Od2dExportView::update);
   virtual void shell(OdInt32 numVertices, const OdGePoint3d* vertexList, OdInt32 faceListSize, const OdInt32* faceList, const OdGiEdgeData* pEdgeData, const OdGiFaceData* pFaceData, const OdGiVertexData* pVertexData) ODRX_OVERRIDE;
@@ -113,6 +115,8 @@ class SvgProperties : public OdRxDispatchImpl<>
   bool _bExplodeShxFonts;
   bool _bRemoveFirstSpacesOfText;
   ColorPolicy _colorPolicy;
+  bool _bShareDefinitions;
+  bool _bStreamOutput;
 public:
   SvgProperties() 
     : _tolerance( 0.5 )
@@ -125,6 +129,9 @@ public:
     , _bEnableGouraudShading(true)
     , _bExplodeShxFonts(true)
     , _bRemoveFirstSpacesOfText(true)
+    , _colorPolicy(kNoPolicy)
+    , _bShareDefinitions(false)
+    , _bStreamOutput(false)
   {}
   ODRX_DECLARE_DYNAMIC_PROPERTY_MAP(SvgProperties);
   static SvgPropertiesPtr createObject()
@@ -176,6 +183,10 @@ public:
   void put_RemoveFirstSpacesOfText(bool b){ _bRemoveFirstSpacesOfText = b; }
   OdInt32 get_ColorPolicy() { return _colorPolicy; }
   void put_ColorPolicy(OdInt32 c) { _colorPolicy = (ColorPolicy)c; }
+  bool get_ShareDefinitions() const { return _bShareDefinitions; }
+  void put_ShareDefinitions(bool b){ _bShareDefinitions = b; }
+  bool get_StreamOutput() const { return _bStreamOutput; }
+  void put_StreamOutput(bool b){ _bStreamOutput = b; }
 };
 
 ODRX_DECLARE_PROPERTY(DefaultImageExt)
@@ -193,6 +204,8 @@ ODRX_DECLARE_PROPERTY(EnableGouraudShading)
 ODRX_DECLARE_PROPERTY(ExplodeShxTexts)
 ODRX_DECLARE_PROPERTY(RemoveFirstSpacesOfText)
 ODRX_DECLARE_PROPERTY(ColorPolicy)
+ODRX_DECLARE_PROPERTY(ShareDefinitions)
+ODRX_DECLARE_PROPERTY(StreamOutput)
 
 ODRX_DEFINE_PROPERTY(DefaultImageExt, SvgProperties, getString)
 ODRX_DEFINE_PROPERTY(ShxLineWeight, SvgProperties, getDouble)
@@ -209,6 +222,8 @@ ODRX_DEFINE_PROPERTY(EnableGouraudShading, SvgProperties, getBool)
 ODRX_DEFINE_PROPERTY(ExplodeShxTexts, SvgProperties, getBool)
 ODRX_DEFINE_PROPERTY(RemoveFirstSpacesOfText, SvgProperties, getBool)
 ODRX_DEFINE_PROPERTY(ColorPolicy, SvgProperties, getInt32)
+ODRX_DEFINE_PROPERTY(ShareDefinitions, SvgProperties, getBool)
+ODRX_DEFINE_PROPERTY(StreamOutput, SvgProperties, getBool)
 
 ODRX_BEGIN_DYNAMIC_PROPERTY_MAP( SvgProperties );
   ODRX_GENERATE_PROPERTY(DefaultImageExt)
@@ -226,6 +241,8 @@ ODRX_BEGIN_DYNAMIC_PROPERTY_MAP( SvgProperties );
   ODRX_GENERATE_PROPERTY(ExplodeShxTexts)
   ODRX_GENERATE_PROPERTY(RemoveFirstSpacesOfText)
   ODRX_GENERATE_PROPERTY(ColorPolicy)
+  ODRX_GENERATE_PROPERTY(ShareDefinitions)
+  ODRX_GENERATE_PROPERTY(StreamOutput)
 ODRX_END_DYNAMIC_PROPERTY_MAP(SvgProperties);
 
 namespace svg
@@ -296,6 +313,90 @@ struct OdSvgDashArrayDescription
   }
 };
 
+// Key of shared block definition (<symbol>). Block references share single definition
+// if they refer the same block with the same attributes in the same view, and their
+// block to device transforms differ by 2d rotation and translation only. Such references
+// produce identical geometry, so each one may be written as <use> of the first one.
+//
+struct OdSvgSymbolKey
+{
+  const OdDbStub* m_blockId;
+  const void*     m_pView;
+  const OdDbStub* m_layer;
+  const OdDbStub* m_lineType;
+  const OdDbStub* m_plotStyle;
+  OdUInt32        m_color;
+  OdUInt32        m_transparency;
+  OdInt32         m_lineWeight;
+  OdInt32         m_orientation;
+  double          m_ltScale;
+  double          m_metric[6]; // Gram matrix of block axes projected onto device plane
+
+  // Quantizes transform invariant, so rounding noise doesn't break sharing
+  static double roundMetric(double v)
+  {
+    int e;
+    double m = frexp(v, &e);
+    return ldexp(floor(m * 4294967296. + .5) / 4294967296., e);
+  }
+
+  // Returns false if references can't be shared with this transform
+  bool set(const OdDbStub* blockId, const void* pView, const OdGiSubEntityTraitsData& traits,
+           const OdGeMatrix3d& blockToDevice, OdGeMatrix2d& xform)
+  {
+    const OdGeMatrix3d& m = blockToDevice;
+    if (!OdZero(m[3][0]) || !OdZero(m[3][1]) || !OdZero(m[3][2]) || !OdEqual(m[3][3], 1.))
+      return false; // perspective
+    const OdGeVector2d axis[3] = { OdGeVector2d(m[0][0], m[1][0]), OdGeVector2d(m[0][1], m[1][1]), OdGeVector2d(m[0][2], m[1][2]) };
+    const double det = axis[0].crossProduct(axis[1]);
+    if (OdZero(det, 1.e-20))
+      return false; // block plane is perpendicular to view
+    m_blockId = blockId;
+    m_pView = pView;
+    m_layer = traits.layer();
+    m_lineType = traits.lineType();
+    m_plotStyle = traits.plotStyleNameId();
+    m_color = traits.trueColor().color();
+    m_transparency = traits.transparency().serializeOut();
+    m_lineWeight = (OdInt32)traits.lineWeight();
+    m_orientation = (det > 0.) ? 1 : -1;
+    m_ltScale = traits.lineTypeScale();
+    int n = 0;
+    for (int i = 0; i < 3; i++)
+    {
+      for (int j = i; j < 3; j++)
+        m_metric[n++] = roundMetric(axis[i].dotProduct(axis[j]));
+    }
+    xform.setCoordSystem(OdGePoint2d(m[0][3], m[1][3]), axis[0], axis[1]);
+    return true;
+  }
+
+  bool operator <(const OdSvgSymbolKey& k) const
+  {
+    if (m_blockId != k.m_blockId) return m_blockId < k.m_blockId;
+    if (m_pView != k.m_pView) return m_pView < k.m_pView;
+    if (m_layer != k.m_layer) return m_layer < k.m_layer;
+    if (m_lineType != k.m_lineType) return m_lineType < k.m_lineType;
+    if (m_plotStyle != k.m_plotStyle) return m_plotStyle < k.m_plotStyle;
+    if (m_color != k.m_color) return m_color < k.m_color;
+    if (m_transparency != k.m_transparency) return m_transparency < k.m_transparency;
+    if (m_lineWeight != k.m_lineWeight) return m_lineWeight < k.m_lineWeight;
+    if (m_orientation != k.m_orientation) return m_orientation < k.m_orientation;
+    if (m_ltScale != k.m_ltScale) return m_ltScale < k.m_ltScale;
+    for (int i = 0; i < 6; i++)
+    {
+      if (m_metric[i] != k.m_metric[i]) return m_metric[i] < k.m_metric[i];
+    }
+    return false;
+  }
+};
+
+struct OdSvgSymbol
+{
+  OdString     m_id;
+  OdGeMatrix2d m_invXform; // Inverse transform of the defining reference
+};
+
 static void convertColorToGrayscale(ODCOLORREF& rgb)
 {
   OdUInt8 gray = (OdUInt8)((30 * ODGETRED(rgb) + 59 * ODGETGREEN(rgb) + 11 * ODGETBLUE(rgb)) / 100);
@@ -345,6 +446,26 @@ class OdSvgDevice : public Od2dExportDevice
   std::map<const OdDbStub*, OdSvgDashArrayDescription> m_dashArrayMap;
   OdSvgDashArrayDescription m_curDashArray;
   bool _bShellMode;
+
+  // "ShareDefinitions" mode
+  struct SharedDef
+  {
+    OdString m_content; // Serialized definition, except its id
+    OdString m_id;
+    SharedDef( const OdString& content, const OdString& id ) : m_content( content ), m_id( id ) {}
+  };
+  typedef std::multimap<OdUInt64, SharedDef> SharedDefsMap;
+  SharedDefsMap _sharedDefs; // definition content hash -> definitions
+  typedef std::map<OdSvgSymbolKey, OdSvgSymbol> SymbolMap;
+  SymbolMap _symbols;
+  int _symbolCount;
+  xml::Node* _captureNode; // <symbol> being filled by the first block reference
+  bool _bCaptureBroken;
+  bool _bNewGroup; // next primitive must start new group
+
+  // "StreamOutput" mode: completed top level nodes are written and released
+  // as soon as their number exceeds this limit
+  enum { kStreamNodesLimit = 256 };
 public:
   bool _plotLineweights;
   OdSvgDevice() : Od2dExportDevice(DeviceType(kSupport2dPolyline | kSupport2dCircle | kSupport2dEllipse | kSupportNrcClip | kSupportContourFill))
@@ -366,6 +487,10 @@ public:
     , _pathCount( 0 )
     , _currentDrawable(0)
     , _bShellMode(false)
+    , _symbolCount(0)
+    , _captureNode(0)
+    , _bCaptureBroken(false)
+    , _bNewGroup(false)
     , _plotLineweights(true)
   {
   }
@@ -415,20 +540,53 @@ public:
     }
 
     _currentNode = _svgRoot;
-    Od2dExportDevice::update( pUpdatedRect );
-    flushFonts();
     ODA_ASSERT( _properties->get_Output() ); 
     // "Output" property must be set before exporting
     OdStreamBufPtr stream = _properties->get_Output();
-    writeFile( *stream.get() );
+    const bool bStream = _properties->get_StreamOutput();
+    if ( bStream )
+    {
+      writeHeader( *stream.get() );
+      xml::writeOpenTag( *stream.get(), *_svgRoot );
+    }
+    Od2dExportDevice::update( pUpdatedRect );
+    flushFonts();
+    if ( bStream )
+    {
+      streamCompletedNodes( true );
+      xml::writeCloseTag( *stream.get(), *_svgRoot );
+    }
+    else
+      writeFile( *stream.get() );
     delete _svgRoot;
+    delete _captureNode;
     // Clear all settings to be safe for initiate secondary vectorization
-    _currentNode = _svgRoot = _defs = 0;
+    _currentNode = _svgRoot = _defs = _captureNode = 0;
     _color = _color2 = 0;
     _alpha = 255;
     _fill = _fillContour = false;
     _currentLineWeight = 1.0;
-    _filterCount = _clipCount = _imageNum = _gradientCount = _pathCount = 0;
+    _filterCount = _clipCount = _imageNum = _gradientCount = _pathCount = _symbolCount = 0;
+    _bNewGroup = false;
+    _sharedDefs.clear();
+    _symbols.clear();
+    _clipId.empty();
+    while ( !_clipsStack.empty() )
+      _clipsStack.pop();
+    _hyperlink.empty();
+    _currentDrawable = 0;
+    // Linetypes are cached by ids of the exported database
+    m_dashArrayMap.clear();
+    // Device may be kept for next export (see OdGsDevicePool), so it doesn't hold the output stream
+    _properties->put_Output( 0 );
+  }
+
+  // Render devices are created for views of the exported database
+  void eraseAllViews()
+  {
+    setRenderDevice( 0, false );
+    Od2dExportDevice::eraseAllViews();
+    m_dashArrayMap.clear();
   }
   
   void flushFonts()
@@ -442,17 +600,137 @@ public:
     _fontMap.clear();
   }
 
-  void writeFile( OdStreamBuf& stream )
+  void writeHeader( OdStreamBuf& stream )
   {
     stream << OdString( OD_T("<?xml version=\"1.0\" standalone=\"no\"?>\r\n") );
+  }
+  void writeFile( OdStreamBuf& stream )
+  {
+    writeHeader( stream );
     stream << *_svgRoot;
   }
+  // Writes and releases top level nodes, except the last one which may still be filled.
+  // Definitions are always placed before the nodes referencing them; once written,
+  // new <defs> section is started on demand.
+  void streamCompletedNodes( bool bAll = false )
+  {
+    if ( !_svgRoot || !_properties->get_StreamOutput() )
+      return;
+    std::vector<xml::Node*>& nodes = _svgRoot->_children;
+    if ( !bAll && nodes.size() <= kStreamNodesLimit )
+      return;
+    size_t nNodes = bAll ? nodes.size() : nodes.size() - 1;
+    OdStreamBufPtr stream = _properties->get_Output();
+    for ( size_t i = 0; i < nNodes; i++ )
+    {
+      *stream.get() << *nodes[i];
+      if ( nodes[i] == _defs )
+        _defs = 0;
+      delete nodes[i];
+    }
+    nodes.erase( nodes.begin(), nodes.begin() + nNodes );
+  }
   void addDefs()
   {
     if ( _defs ) return;
     _defs = new xml::Node( OD_T("defs") );
     _svgRoot->_children.insert( _svgRoot->_children.begin(), _defs );
   }
+  // Adds definition with new id, or returns id of the identical one in "ShareDefinitions" mode
+  OdString addDefinition( xml::Node* pDef, const OdChar* idFormat, int& counter )
+  {
+    const bool bShare = _properties->get_ShareDefinitions();
+    OdUInt64 hash = 0;
+    OdString content;
+    if ( bShare )
+    {
+      // Written definitions are already released in "StreamOutput" mode, so hash collisions
+      // are resolved by comparing serialized contents
+      xml::contentString( *pDef, content );
+      hash = xml::stringHash( content );
+      std::pair<SharedDefsMap::const_iterator, SharedDefsMap::const_iterator> shared = _sharedDefs.equal_range( hash );
+      for ( ; shared.first != shared.second; ++shared.first )
+      {
+        if ( shared.first->second.m_content == content )
+        {
+          delete pDef;
+          return shared.first->second.m_id;
+        }
+      }
+    }
+    OdString id; id.format( idFormat, counter++ );
+    pDef->_attributes.insert( pDef->_attributes.begin(), xml::Attribute( OD_T("id"), id ) );
+    addDefs();
+    _defs->addChild( pDef );
+    if ( bShare )
+      _sharedDefs.insert( SharedDefsMap::value_type( hash, SharedDef( content, id ) ) );
+    return id;
+  }
+  // Top level node for new groups
+  xml::Node* groupRoot() { return _captureNode ? _captureNode : _svgRoot; }
+  // Adds top level group clipped by the current clip path
+  xml::Node* addClippedGroup()
+  {
+    xml::Node* pGroup = groupRoot()->addChild( OD_T("g") );
+    if ( !_clipId.isEmpty() )
+      pGroup->addAttribute( OD_T("clip-path"), OdString(OD_T("url(#")) + _clipId + OD_T(")") );
+    return pGroup;
+  }
+
+  // Block reference geometry is collected into <symbol> definition
+  void beginSymbol()
+  {
+    _captureNode = new xml::Node( OD_T("symbol") );
+    _bCaptureBroken = false;
+    _bNewGroup = true;
+    _currentNode = _captureNode;
+  }
+  // If pKey is null or symbol can't be shared, collected geometry is written in place
+  void endSymbol( const OdSvgSymbolKey* pKey, const OdGeMatrix2d& xform )
+  {
+    xml::Node* pSymbol = _captureNode;
+    _captureNode = 0;
+    _currentNode = _svgRoot;
+    _bNewGroup = true;
+    if ( !pKey || _bCaptureBroken || pSymbol->_children.empty() )
+    {
+      // Geometry was captured without viewport clipping, so it is enclosed into group
+      // clipped in the same way as <use> would be
+      if ( !pSymbol->_children.empty() && !_clipId.isEmpty() )
+        _currentNode = addClippedGroup();
+      _currentNode->_children.insert( _currentNode->_children.end(), pSymbol->_children.begin(), pSymbol->_children.end() );
+      pSymbol->_children.clear();
+      delete pSymbol;
+      streamCompletedNodes();
+      return;
+    }
+    // clip path is applied by the referencing node
+    for ( unsigned int i = 0; i < pSymbol->_children.size(); i++ )
+    {
+      xml::Node* pGroup = pSymbol->_children[i];
+      pGroup->removeAttribute( OD_T("clip-path") );
+      for ( unsigned int j = 0; j < pGroup->_children.size(); j++ ) // hyperlink group
+        pGroup->_children[j]->removeAttribute( OD_T("clip-path") );
+    }
+    pSymbol->addAttribute( OD_T("overflow"), OD_T("visible") );
+    OdSvgSymbol& symbol = _symbols[*pKey];
+    symbol.m_id = addDefinition( pSymbol, OD_T("s_%d"), _symbolCount );
+    symbol.m_invXform = xform.inverse();
+    useSymbol( symbol, xform );
+  }
+  void useSymbol( const OdSvgSymbol& symbol, const OdGeMatrix2d& xform )
+  {
+    xml::Node* pUse = new xml::Node( OD_T("use") );
+    pUse->addAttribute( OD_T("xlink:href"), OdString(OD_T("#")) + symbol.m_id );
+    OdGeMatrix2d m = xform * symbol.m_invXform;
+    if ( !m.isEqualTo( OdGeMatrix2d::kIdentity ) )
+      pUse->addAttribute( OD_T("transform"), svg::formatMatrix( m ) );
+    // Primitives which don't start new group (raster images) are added after <use> into the same clipped group
+    _currentNode = _clipId.isEmpty() ? _svgRoot : addClippedGroup();
+    _currentNode->addChild( pUse );
+    _bNewGroup = true;
+    streamCompletedNodes();
+  }
 
   OdGsViewPtr createView( const OdGsClientViewInfo* pViewInfo = 0, bool bEnableLayerVisibilityPerView = false )
   {
@@ -463,7 +741,7 @@ public:
   }
  
   OdString createClipPath( int rings, const int* counts, const OdGePoint2d* pp);
-  xml::Node* createGradient(OdString& id, const OdCmEntityColor& col1, const OdCmEntityColor& col2, const OdGePoint3d& p1, const OdGePoint3d& p2);
+  void createGradient(OdString& id, const OdCmEntityColor& col1, const OdCmEntityColor& col2, const OdGePoint3d& p1, const OdGePoint3d& p2);
 
   void setDashArrayData(const  OdSvgDashArrayDescription& dashArray )
   {
@@ -513,6 +791,8 @@ public:
   // Od2dExportDevice interface
   void dc_pushClip(int rings, const int* counts, const OdGsDCPointArray &nrcPoints)
   {
+    if (_captureNode) // clip isn't transformed together with symbol
+      _bCaptureBroken = true;
     _clipsStack.push(_clipId); // save old clip id
     
     OdGePoint2dArray clip; // temporary fix - dc_pushClip should be changed in Od2dExportDevice, to avoid double conversion
@@ -534,9 +814,9 @@ public:
       throw OdError(eNotApplicable);
     _clipId = _clipsStack.top();
     _clipsStack.pop();
-    _currentNode = _svgRoot->addChild( OD_T("g") );
-    if (!_clipId.isEmpty())
-      _currentNode->addAttribute(OD_T("clip-path"), OdString(OD_T("url(#")) + _clipId + OD_T(")"));
+    _currentNode = addClippedGroup();
+    _bNewGroup = false;
+    streamCompletedNodes();
   }
 
   // usually traits are set in View::OnTraitsModified(), 
@@ -630,21 +910,22 @@ public:
     applyColorPolicy(color, _properties->get_ColorPolicy());
     applyColorPolicy(color2, _properties->get_ColorPolicy());
   
-    if ( forceCreateGroup || _color != color || fill != _fill || lw != _currentLineWeight || _alpha != alpha ||
+    if ( forceCreateGroup || _bNewGroup || _color != color || fill != _fill || lw != _currentLineWeight || _alpha != alpha ||
          (fill && ((fillContour != _fillContour) || (fillContour && _color2 != color2))) )
     {
       _color = color;
       _alpha = alpha;
       _fill = fill;
       _currentLineWeight = lw;
+      _bNewGroup = false;
       if (addHyperlink)
       {
-        _currentNode = _svgRoot->addChild( OD_T("a") );
+        _currentNode = groupRoot()->addChild( OD_T("a") );
         _currentNode->addAttribute( OD_T("xlink:href"), _hyperlink );
         _currentNode = _currentNode->addChild( OD_T("g") );
       }
       else
-        _currentNode = _svgRoot->addChild( OD_T("g") );
+        _currentNode = groupRoot()->addChild( OD_T("g") );
       if (!_clipId.isEmpty())
         _currentNode->addAttribute( OD_T("clip-path"), OdString(OD_T("url(#")) + _clipId + OD_T(")"));
       double alphaDbl = (_alpha == 255) ? 1.0 : traits.transparency().alphaPercent();
@@ -677,6 +958,7 @@ public:
         if (_alpha != 255) _currentNode->addAttribute( OD_T("stroke-opacity"), alphaDbl );
         _currentNode->addAttribute( OD_T("stroke-width"), _currentLineWeight );
       }
+      streamCompletedNodes();
     }
   }
 
@@ -899,6 +1181,7 @@ public:
   void gouraud_triangle(OdGePoint3d* pts, OdCmEntityColor* cols)
   {
     svg::Path* path = new svg::Path();
+    addDefs();
     _defs->addChild(path);
     OdString pathId;
     pathId.format(L"t_%d", _pathCount++);
@@ -1623,18 +1906,79 @@ void OdSvgView::draw(const OdGiDrawable* pDrawable)
 {
   m_pLinetyper->enable();
 
+  if (device()->_properties->get_ShareDefinitions() && drawBlockSymbol(pDrawable))
+    return;
   OdGiBaseVectorizer::draw(pDrawable);
 }
 
+// Writes block reference as <use> of shared <symbol>, created by the first reference with same key.
+// Returns false if reference must be drawn as usual.
+bool OdSvgView::drawBlockSymbol(const OdGiDrawable* pDrawable)
+{
+  OdSvgDevice* pDevice = device();
+  // nested references are part of outer symbol; HLR output isn't ordered by drawables
+  if (!pDevice->_svgRoot || pDevice->_captureNode || pDevice->isUseHLR() || view().isPerspective() ||
+      isFrontClipped() || isBackClipped())
+    return false;
+  OdDbBaseBlockRefPEPtr pBlockRefPE = OdDbBaseBlockRefPE::cast(pDrawable);
+  if (pBlockRefPE.isNull() || !pBlockRefPE->isGeneric(pDrawable) || pBlockRefPE->isMInsert(pDrawable))
+    return false;
+  // attributes and hyperlinks are individual for each reference
+  OdRxIteratorPtr pAttribs = pBlockRefPE->newAttribIterator(pDrawable);
+  if (!pAttribs.isNull() && !pAttribs->done())
+    return false;
+  OdDbEntityHyperlinkPEPtr pHyperlinkPE = OdDbEntityHyperlinkPE::cast(pDrawable);
+  if (!pHyperlinkPE.isNull())
+  {
+    OdDbHyperlinkCollectionPtr pHyperlinks = pHyperlinkPE->getHyperlinkCollection(pDrawable, true);
+    if (!pHyperlinks.isNull() && pHyperlinks->count() > 0)
+      return false;
+  }
+  OdGiSubEntityTraitsData attribs;
+  OdGiSubEntityTraitsToData traits(attribs);
+  if (GETBIT(pDrawable->setAttributes(&traits), OdGiDrawable::kDrawableIsInvisible))
+    return false;
+
+  OdSvgSymbolKey key;
+  OdGeMatrix2d xform;
+  if (!key.set(pBlockRefPE->blockId(pDrawable), this, attribs,
+               objectToDeviceMatrix() * pBlockRefPE->blockTransform(pDrawable), xform))
+    return false;
+  OdSvgDevice::SymbolMap::const_iterator pSymbol = pDevice->_symbols.find(key);
+  if (pSymbol != pDevice->_symbols.end())
+  {
+    pDevice->useSymbol(pSymbol->second, xform);
+    return true;
+  }
+  // Symbol geometry mustn't be clipped by viewport of the first reference,
+  // viewport clip path is applied to each <use> instead.
+  const bool bViewportClip = m_pViewportClip->enabled();
+  if (bViewportClip)
+    m_pViewportClip->disable();
+  pDevice->beginSymbol();
+  try
+  {
+    OdGiBaseVectorizer::draw(pDrawable);
+  }
+  catch (...)
+  {
+    if (bViewportClip)
+      m_pViewportClip->enable();
+    pDevice->endSymbol(NULL, xform);
+    throw;
+  }
+  if (bViewportClip)
+    m_pViewportClip->enable();
+  pDevice->endSymbol(&key, xform);
+  return true;
+}
+
 // Inlined functions containing static variables cause warnings on the mac (bad semantics), 
 // so move createClipPath and createFilter down to here.
 
 OdString OdSvgDevice::createClipPath( int rings, const int* counts, const OdGePoint2d* pp )
 {
-  addDefs();
-  OdString clipId; clipId.format( OD_T("clipId%d"), _clipCount++ );
-  xml::Node* clipPath = _defs->addChild( new xml::Node( OD_T("clipPath") ) );
-  clipPath->addAttribute( OD_T("id"), clipId );
+  xml::Node* clipPath = new xml::Node( OD_T("clipPath") );
   svg::Path* path = new svg::Path;
   clipPath->addChild( path );
   int currentPos = 0;
@@ -1643,7 +1987,7 @@ OdString OdSvgDevice::createClipPath( int rings, const int* counts, const OdGePo
     path->addLoop( counts[i], pp + currentPos );
     currentPos += counts[i];
   }
-  return clipId;
+  return addDefinition( clipPath, OD_T("clipId%d"), _clipCount );
 }
 
 xml::Node* OdSvgDevice::createFilter( OdString& id )
@@ -1655,7 +1999,7 @@ xml::Node* OdSvgDevice::createFilter( OdString& id )
   return filter;
 }
 
-xml::Node* OdSvgDevice::createGradient(OdString& id, const OdCmEntityColor& col1, const OdCmEntityColor& col2, const OdGePoint3d& p1, const OdGePoint3d& p2)
+void OdSvgDevice::createGradient(OdString& id, const OdCmEntityColor& col1, const OdCmEntityColor& col2, const OdGePoint3d& p1, const OdGePoint3d& p2)
 {
   addDefs();
   if (_gradientCount == 0)
@@ -1677,9 +2021,7 @@ xml::Node* OdSvgDevice::createGradient(OdString& id, const OdCmEntityColor& col1
     comp->addAttribute(L"k3", L"1");
     comp->addAttribute(L"k4", L"0");
   }
-  xml::Node* grad = _defs->addChild( L"linearGradient" );
-  id.format( L"g_%d", _gradientCount++ );
-  grad->addAttribute( L"id", id );
+  xml::Node* grad = new xml::Node( L"linearGradient" );
   grad->addAttribute( L"gradientUnits", L"userSpaceOnUse");
   grad->addAttribute( L"x1", p1.x);
   grad->addAttribute( L"y1", p1.y);
@@ -1697,7 +2039,7 @@ xml::Node* OdSvgDevice::createGradient(OdString& id, const OdCmEntityColor& col1
   stop2->addAttribute(L"offset", L"1");
   stop2->addAttribute(L"stop-color", svg::formatColor(color2));
   stop2->addAttribute(L"stop-opacity", (col1 == col2) ? L"0" : L"1");
-  return grad;
+  id = addDefinition( grad, L"g_%d", _gradientCount );
 }
 
 void OdSvgView::setOuterClipPath()
@@ -148,6 +148,62 @@ namespace xml
     }
     return stream;
   };
+
+  // Incremental output: node tag is written separately from its children,
+  // so children may be written and released while node is being filled.
+  //
+  void writeOpenTag( OdStreamBuf& stream, const Node& node )
+  {
+    stream << '<' << node._name << ' ';
+    Node::AttributeMap::const_iterator i = node._attributes.begin();
+    for ( ; i != node._attributes.end(); ++i ) stream << *i;
+    stream << '>' << '\r' << '\n';
+  }
+
+  void writeCloseTag( OdStreamBuf& stream, const Node& node )
+  {
+    stream << '<' << '/' << node._name << '>' << '\r' << '\n';
+  }
+
+  // Serialized node contents, used to share identical definitions.
+  // "id" attribute of the node itself is skipped.
+  //
+  void contentString( const Node& node, OdString& s, bool bSkipId = true )
+  {
+    s += '<';
+    s += node._name;
+    Node::AttributeMap::const_iterator i = node._attributes.begin();
+    for ( ; i != node._attributes.end(); ++i )
+    {
+      if ( bSkipId && i->_name == OD_T("id") )
+        continue;
+      s += ' ';
+      s += i->_name;
+      s += OD_T("=\"");
+      s += i->_value;
+      s += '\"';
+    }
+    s += '>';
+    s += node._contents;
+    for ( unsigned int j = 0; j < node._children.size(); j++ )
+      contentString( *node._children[j], s, false );
+    s += OD_T("</");
+    s += node._name;
+    s += '>';
+  }
+
+  // FNV-1a hash of the string
+  inline OdUInt64 stringHash( const OdString& s )
+  {
+    OdUInt64 h = 14695981039346656037ULL;
+    const OdUInt8* p = (const OdUInt8*)s.c_str();
+    for ( size_t n = s.getLength() * sizeof(OdChar); n; --n, ++p )
+    {
+      h ^= *p;
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
 }
 
 /** \details
@@ -32,6 +32,7 @@
 #define _THREEJSJSON_EXPORT_INCLUDED_
 
 #include "DbBaseDatabase.h"
+#include "Gs/GsDevicePool.h"
 
 class OdStreamBuf;
 
@@ -53,6 +54,27 @@ namespace TD_THREEJSJSON_EXPORT
   */
   OdResult exportThreejsJSON(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, const ODCOLORREF &background, bool bFacesEnabled = false);
 
+  /** \details
+     Exports an element to ThreejsJSON file using device from the pool
+
+     Input : background - color of scene background
+             bFacesEnabled - if true, export to JSON with faces, else - with lines and points
+             pPool - pool created by createThreejsJSONDevicePool (shouldn't be shared between
+                     exports with different bFacesEnabled flag)
+     Output: pOutStream - output stream (file stream, memory stream)
+
+     Return : eOk is ok
+              or OdResult error code
+  */
+  OdResult exportThreejsJSON(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, const ODCOLORREF &background, bool bFacesEnabled, OdGsDevicePool *pPool);
+
+  /** \details
+     Creates pool of devices for batch ThreejsJSON export
+
+     Input : nMaxIdle - maximal number of idle devices kept by pool
+  */
+  OdGsDevicePoolPtr createThreejsJSONDevicePool(OdUInt32 nMaxIdle = 4);
+
 };
 
 #endif // _THREEJSJSON_EXPORT_INCLUDED_
@@ -28,6 +28,7 @@
 #include "ThreejsJSONExportDef.h"
 #include "RxDynamicModule.h"
 #include "DbBaseDatabase.h"
+#include "Gs/GsDevicePool.h"
 
 class OdGiDrawable;
 class OdStreamBuf;
@@ -57,6 +58,16 @@ namespace TD_THREEJSJSON_EXPORT
       Exports to the ThreejsJSON.
     */
     virtual OdResult exportThreejsJSON(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, const ODCOLORREF &background, bool bFacesEnabled = false);
+
+    /** \details
+      Exports to the ThreejsJSON using device from the pool.
+    */
+    virtual OdResult exportThreejsJSON(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, const ODCOLORREF &background, bool bFacesEnabled, OdGsDevicePool *pPool);
+
+    /** \details
+      Creates pool of devices for batch export.
+    */
+    virtual OdGsDevicePoolPtr createDevicePool(OdUInt32 nMaxIdle = 4);
   };
 
   /** \details
@@ -27,6 +27,7 @@
 #include "RxDynamicModule.h"
 
 #include "Gs/GsBaseVectorizeDevice.h" // for OdSmartPtr<OdGsBaseVectorizeDevice>
+#include "Gs/GsDevicePool.h"
 
 #include "Tr/vec/TrVecBaseModule.h"
 #include "RxDispatchImpl.h"
@@ -106,7 +107,8 @@ namespace TD_THREEJSJSON_EXPORT
     virtual void vectorizationTest(OdGsDevice* pDevice) const;
   };
 
-  void tryToVectorize(OdStreamBuf *pOutStream, OdDbBaseDatabase *pDb, const ODCOLORREF &background, bool bFacesEnabled, const TryToVectorizeMod &pMod = TryToVectorizeMod());
+  void tryToVectorize(OdStreamBuf *pOutStream, OdDbBaseDatabase *pDb, const ODCOLORREF &background, bool bFacesEnabled,
+                      OdGsDevicePool *pPool = NULL, const TryToVectorizeMod &pMod = TryToVectorizeMod());
 
 
   OdGsDevicePtr TryToVectorizeMod::initDevice(OdDbBaseDatabase *pDb, OdGsDevice* pDevice, const ODCOLORREF &background) const
@@ -129,13 +131,25 @@ namespace TD_THREEJSJSON_EXPORT
     pDevice->update();
   }
 
-  void tryToVectorize(OdStreamBuf *pOutStream, OdDbBaseDatabase *pDb, const ODCOLORREF &background, bool bFacesEnabled, const TryToVectorizeMod &pMod)
+  void tryToVectorize(OdStreamBuf *pOutStream, OdDbBaseDatabase *pDb, const ODCOLORREF &background, bool bFacesEnabled,
+                      OdGsDevicePool *pPool, const TryToVectorizeMod &pMod)
   {
+    // Pseudo static entry point creates new module instance on each call, so pooled export uses
+    // module instance owned by the pool.
+    OdGsModulePtr pGsModule;
+    if (pPool)
+    {
+      pGsModule = pPool->module();
+      if (pGsModule->moduleName() != OD_T("TrJsonModule"))
+        throw OdError(eInvalidInput); // Pool isn't created by createThreejsJSONDevicePool()
+    }
+    else
+      pGsModule = ODRX_STATIC_MODULE_ENTRY_POINT(TrJsonModule)(OD_T("TrJsonModule"));
     odgsInitialize();
-    OdGsModulePtr pGsModule = ODRX_STATIC_MODULE_ENTRY_POINT(TrJsonModule)(OD_T("TrJsonModule"));
     {
-      OdGsDevicePtr pDevice = pGsModule->createDevice();
-      pDevice = pMod.initDevice(pDb, pDevice, background);
+      // Device is taken from the pool if specified, so module, Gs and device initialization is shared between exports
+      OdGsDevicePoolLease deviceLease(pPool, pGsModule);
+      OdGsDevicePtr pDevice = pMod.initDevice(pDb, deviceLease.device(), background);
 
       OdGsDCRect screenRect(OdGsDCPoint(0, 2000), OdGsDCPoint(2000, 0));
       pDevice->onSize(screenRect);
@@ -166,19 +180,22 @@ namespace TD_THREEJSJSON_EXPORT
 
       pMod.vectorizationTest(pDevice);
       pJsonServer->flushOut();
+      if (pPool) // Pooled device shouldn't refer json server after export
+        pProperties->putAt(OD_T("JsonServer"), OdRxVariantValue((OdIntPtr)0));
       pDevice.release();
+      deviceLease.setSucceeded();
     }
     pGsModule.release();
     odgsUninitialize();
   }
 
-  OdResult doExport(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, const ODCOLORREF &background, bool bFacesEnabled)
+  OdResult doExport(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, const ODCOLORREF &background, bool bFacesEnabled, OdGsDevicePool *pPool = NULL)
   {
     OdResult ret = eOk;
 
     try
     {
-      tryToVectorize(pOutStream, pDb, background, bFacesEnabled);
+      tryToVectorize(pOutStream, pDb, background, bFacesEnabled, pPool);
     }
     catch (const OdError& e)
     {
@@ -196,4 +213,15 @@ namespace TD_THREEJSJSON_EXPORT
   {
     return doExport(pDb, pOutStream, background, bFacesEnabled);
   }
+
+  OdResult exportThreejsJSON(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, const ODCOLORREF &background, bool bFacesEnabled, OdGsDevicePool *pPool)
+  {
+    return doExport(pDb, pOutStream, background, bFacesEnabled, pPool);
+  }
+
+  OdGsDevicePoolPtr createThreejsJSONDevicePool(OdUInt32 nMaxIdle)
+  {
+    OdGsModulePtr pGsModule = ODRX_STATIC_MODULE_ENTRY_POINT(TrJsonModule)(OD_T("TrJsonModule"));
+    return OdGsDevicePool::createObject(pGsModule, nMaxIdle);
+  }
 };
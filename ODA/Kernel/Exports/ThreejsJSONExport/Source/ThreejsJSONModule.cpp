@@ -44,4 +44,14 @@ namespace TD_THREEJSJSON_EXPORT
   {
     return TD_THREEJSJSON_EXPORT::exportThreejsJSON(pDb, pOutStream, background, bFacesEnabled);
   }
+
+  OdResult ThreejsJSONModule::exportThreejsJSON(OdDbBaseDatabase *pDb, OdStreamBuf *pOutStream, const ODCOLORREF &background, bool bFacesEnabled, OdGsDevicePool *pPool)
+  {
+    return TD_THREEJSJSON_EXPORT::exportThreejsJSON(pDb, pOutStream, background, bFacesEnabled, pPool);
+  }
+
+  OdGsDevicePoolPtr ThreejsJSONModule::createDevicePool(OdUInt32 nMaxIdle)
+  {
+    return TD_THREEJSJSON_EXPORT::createThreejsJSONDevicePool(nMaxIdle);
+  }
 }
@@ -81,6 +81,7 @@ ODRX_DECLARE_PROPERTY2(ClearScreen, className) \
 ODRX_DECLARE_PROPERTY2(AlternativeHlt, className) \
 ODRX_DECLARE_PROPERTY2(AlternativeHltColor, className) \
 ODRX_DECLARE_PROPERTY2(UseTTFCache, className) \
+ODRX_DECLARE_PROPERTY2(TTFGlyphStore, className) \
 ODRX_DECLARE_PROPERTY2(UseLutPalette, className) \
 ODRX_DECLARE_PROPERTY2(LinesRepMode, className) \
 ODRX_DECLARE_PROPERTY2(LineweightOptimization, className) \
@@ -93,6 +94,7 @@ ODRX_BEGIN_DYNAMIC_PROPERTY_MAP(className); \
   ODRX_GENERATE_PROPERTY2(AlternativeHlt, className) \
   ODRX_GENERATE_PROPERTY2(AlternativeHltColor, className) \
   ODRX_GENERATE_PROPERTY2(UseTTFCache, className) \
+  ODRX_GENERATE_PROPERTY2(TTFGlyphStore, className) \
   ODRX_GENERATE_PROPERTY2(UseLutPalette, className) \
   ODRX_GENERATE_PROPERTY2(LinesRepMode, className) \
   ODRX_GENERATE_PROPERTY2(LineweightOptimization, className) \
@@ -104,6 +106,7 @@ ODRX_DEFINE_PROPERTY_METHODS2(ClearScreen,            className, className, isCl
 ODRX_DEFINE_PROPERTY_METHODS2(AlternativeHlt,         className, className, isAlternativeHltEnabled,       enableAlternativeHlt,          getBool) \
 ODRX_DEFINE_PROPERTY_METHODS2(AlternativeHltColor,    className, className, alternativeHltColor,           setAlternativeHltColor,        getUInt32) \
 ODRX_DEFINE_PROPERTY_METHODS2(UseTTFCache,            className, className, isTTFCacheEnabled,             enableTTFCache,                getBool) \
+ODRX_DEFINE_PROPERTY_METHODS2(TTFGlyphStore,          className, className, ttfGlyphStorePath,             setTTFGlyphStorePath,          getString) \
 ODRX_DEFINE_PROPERTY_METHODS2(UseLutPalette,          className, className, useLutPalette,                 setUseLutPalette,              getUInt32) \
 ODRX_DEFINE_PROPERTY_METHODS2(LinesRepMode,           className, className, isLinesRepModeEnabled,         enableLinesRepMode,            getBool) \
 ODRX_DEFINE_PROPERTY_METHODS2(LineweightOptimization, className, className, getLineweightOptimizationProp, setLineweightOptimizationProp, getUInt32)
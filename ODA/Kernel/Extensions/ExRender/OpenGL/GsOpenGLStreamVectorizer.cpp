@@ -123,6 +123,14 @@ OdGsOpenGLStreamVectorizeDevice::~OdGsOpenGLStreamVectorizeDevice()
   clearRasterImageCache();
 }
 
+void OdGsOpenGLStreamVectorizeDevice::update(OdGsDCRect* pUpdatedRect)
+{
+  m_ttfFontsCache->setGlyphStorePath(isTTFCacheEnabled() ? ttfGlyphStorePath() : OdString::kEmpty);
+  OdGsOpenGLVectorizeDevice::update(pUpdatedRect);
+  // Glyphs recorded during this update are saved while vectorization threads are idle
+  m_ttfFontsCache->flushGlyphStore();
+}
+
 void OdGsOpenGLStreamVectorizeDevice::clearRasterImageCache()
 {
   OdUInt32 i;
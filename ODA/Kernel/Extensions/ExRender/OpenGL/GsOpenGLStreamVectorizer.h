@@ -298,6 +298,8 @@ public:
   OdGsOpenGLStreamVectorizeDevice();
   ~OdGsOpenGLStreamVectorizeDevice();
 
+  void update(OdGsDCRect* pUpdatedRect);
+
   // Open sharing for this level
   bool isModelCompatible(OdGsModel* pModel) const { return OdGsBaseVectorizeDevice::isModelCompatible(pModel); }
 
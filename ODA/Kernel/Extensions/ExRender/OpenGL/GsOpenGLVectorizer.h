@@ -93,6 +93,7 @@ class OdGsOpenGLVectorizeDevice : public OdGsBaseVectorizeDevice
   bool m_bForceAlternativeHlt;
   OdUInt32 m_alternativeHltColor;
   bool m_bUseTTFCache;
+  OdString m_ttfGlyphStorePath;
   OdUInt32 m_bUseLutPalette;
   bool m_bLinesRepMode;
   OdUInt32 m_lineweightOptimization;
@@ -282,6 +283,16 @@ public:
   */
   void enableTTFCache(bool bSet) { m_bUseTTFCache = bSet; }
 
+  /** \details
+    Returns path to persistent TrueType glyphs store file used by TTF cache.
+  */
+  const OdString &ttfGlyphStorePath() const { return m_ttfGlyphStorePath; }
+  /** \details
+    Sets path to persistent TrueType glyphs store file. Empty path disables persistent glyphs store.
+    \param filePath [in]  Store file path.
+  */
+  void setTTFGlyphStorePath(const OdString &filePath) { m_ttfGlyphStorePath = filePath; }
+
   /** \details
     Returns current state of UseLutPalette flags.
   */
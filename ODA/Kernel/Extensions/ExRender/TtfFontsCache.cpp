@@ -47,6 +47,27 @@ OdTtfFontsCache::OdTtfFontsCache(OdTtfFontsCacheCallback *pCallback)
 
 OdTtfFontsCache::~OdTtfFontsCache()
 {
+  flushGlyphStore();
+}
+
+void OdTtfFontsCache::setGlyphStorePath(const OdString &filePath)
+{
+  if (!m_pGlyphStore.isNull())
+  {
+    if (m_pGlyphStore->filePath() == filePath)
+      return;
+    m_pGlyphStore->flush();
+    m_pGlyphStore.release();
+  }
+  if (!filePath.isEmpty())
+    m_pGlyphStore = OdTtfGlyphStore::createObject(filePath);
+}
+
+bool OdTtfFontsCache::flushGlyphStore()
+{
+  if (m_pGlyphStore.isNull())
+    return true;
+  return m_pGlyphStore->flush();
 }
 
 OdSmartPtr<OdTtfFontsCache> OdTtfFontsCache::createObject()
@@ -366,13 +387,52 @@ void OdTtfFontsCache::procCharacter(OdFont *pFont, FontKey &fontKey, FontCache &
     chrCache->m_pMetafile = m_pCallback->tfcNewMetafile(pSessionId);
     OdGiConveyorGeometry *pGeom = m_pCallback->tfcBeginMetafile(chrCache->m_pMetafile, pSessionId);
     OdGePoint2d advance;
-    pFont->drawCharacter((OdChar)chr, advance, pGeom, textProperties);
+    drawCharacter(pFont, fontKey, fontCache, chr, textProperties, pGeom, advance);
     tfcFinalizeMetafileExt(fontKey, chr, chrCache->m_pMetafile, pSessionId);
     m_pCallback->tfcFinalizeMetafile(chrCache->m_pMetafile, pSessionId);
     chrCache->m_sideMult = advance.x;
   }
 }
 
+void OdTtfFontsCache::drawCharacter(OdFont *pFont, const FontKey &fontKey, FontCache &fontCache, CharKey chr, OdTextProperties& textProperties,
+                                    OdGiConveyorGeometry *pGeom, OdGePoint2d &advance)
+{
+  OdTtfGlyphStore *pGlyphStore = m_pGlyphStore.get();
+  if (!pGlyphStore)
+  {
+    pFont->drawCharacter((OdChar)chr, advance, pGeom, textProperties);
+    return;
+  }
+  OdTtfGlyphStore::GlyphKey glyphKey;
+  {
+    TD_AUTOLOCK_P_DEF(fontCache.m_mutex)
+    if (!fontCache.m_bGlyphStoreHash)
+    {
+      fontCache.m_glyphStoreHash = OdTtfGlyphStore::fontHash(pFont);
+      fontCache.m_bGlyphStoreHash = true;
+    }
+    glyphKey.m_fontHash = fontCache.m_glyphStoreHash;
+  }
+  glyphKey.m_char = chr;
+  glyphKey.m_quality = (OdUInt16)textProperties.textQuality();
+  glyphKey.m_flags = (OdUInt16)(fontKey.second & 0xFF);
+  SETBIT(glyphKey.m_flags, 0x100, textProperties.isGlyph());
+  SETBIT(glyphKey.m_flags, 0x200, textProperties.ttfPolyDraw());
+  advance.y = 0.0;
+  if (pGlyphStore->playGlyph(glyphKey, pGeom, advance.x))
+    return;
+  OdTtfGlyphRecorder recorder;
+  pFont->drawCharacter((OdChar)chr, advance, &recorder, textProperties);
+  if (recorder.isValid() && OdZero(advance.y))
+  {
+    pGlyphStore->addGlyph(glyphKey, recorder.data(), recorder.numPrimitives(), advance.x);
+    if (pGlyphStore->playGlyph(glyphKey, pGeom, advance.x))
+      return;
+  }
+  // Glyph contains geometry which couldn't be stored
+  pFont->drawCharacter((OdChar)chr, advance, pGeom, textProperties);
+}
+
 #ifdef OD_TTFFONTSCACHE_SHAREABLENAMESPACE
 }
 #endif // OD_TTFFONTSCACHE_SHAREABLENAMESPACE
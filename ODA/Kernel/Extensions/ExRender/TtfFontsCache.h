@@ -34,6 +34,8 @@
 #include "Gi/GiEmptyGeometry.h"
 #include "ThreadsCounter.h"
 #include "SharedPtr.h"
+#include "OdHashMap.h"
+#include "TtfGlyphStore.h"
 
 #define STL_USING_MAP
 #include "OdaSTL.h"
@@ -76,6 +78,13 @@ class OdTtfFontsCache : public OdRxObject,
     // Key for font character
     typedef OdUInt32 CharKey;
   protected:
+    // Hash function for cache keys
+    struct KeyHash
+    {
+      size_t operator()(CharKey chr) const { return (size_t)chr; }
+      size_t operator()(OdUInt64 key) const { return (size_t)(key ^ (key >> 32)); }
+      size_t operator()(const FontKey &fontKey) const { return operator()(OdUInt64(fontKey.first ^ (fontKey.second * 0x9E3779B97F4A7C15ULL))); }
+    };
     // Character cache
     struct CharCache
     {
@@ -83,23 +92,27 @@ class OdTtfFontsCache : public OdRxObject,
       double m_sideMult; // Side movement multiplier
     };
     // Map for characters cache
-    typedef std::map<CharKey, CharCache> CharMap;
+    typedef OdHashMap<CharKey, CharCache, KeyHash> CharMap;
     // Fonts cache
     struct FontCache
     {
       OdFont *m_pFont;
       CharMap m_cache;
       OdMutexPtr m_mutex;
-      FontCache() : m_pFont(NULL) { }
-      FontCache(OdFont *pFont) : m_pFont(pFont) { }
+      OdUInt64 m_glyphStoreHash; // Font file hash for persistent glyphs store
+      bool m_bGlyphStoreHash;
+      FontCache() : m_pFont(NULL), m_glyphStoreHash(0), m_bGlyphStoreHash(false) { }
+      FontCache(OdFont *pFont) : m_pFont(pFont), m_glyphStoreHash(0), m_bGlyphStoreHash(false) { }
     };
     // Map for fonts
-    typedef std::map<FontKey, OdSharedPtr<FontCache> > FontMap;
+    typedef OdHashMap<FontKey, OdSharedPtr<FontCache>, KeyHash> FontMap;
     FontMap m_cache;
     OdTtfFontsCacheCallback *m_pCallback;
     // Alias map
-    typedef std::map<OdUInt64, OdUInt64> AliasMap;
+    typedef OdHashMap<OdUInt64, OdUInt64, KeyHash> AliasMap;
     AliasMap m_aliases;
+    // Persistent glyphs store
+    OdTtfGlyphStorePtr m_pGlyphStore;
     // MTRegen mutex
     OdMutexPtr m_mutex;
   public:
@@ -124,6 +137,14 @@ class OdTtfFontsCache : public OdRxObject,
     void setCallback(OdTtfFontsCacheCallback *pCallback);
     OdTtfFontsCacheCallback *callback() const { return m_pCallback; }
 
+    // Setup persistent glyphs store, shared between devices and sessions (pass null to disable)
+    void setGlyphStore(OdTtfGlyphStore *pGlyphStore) { m_pGlyphStore = pGlyphStore; }
+    OdTtfGlyphStorePtr glyphStore() const { return m_pGlyphStore; }
+    // Opens persistent glyphs store file (empty path disables store), keeps store if path isn't changed
+    void setGlyphStorePath(const OdString &filePath);
+    // Writes glyphs recorded since last flush into store file (must not be invoked during vectorization)
+    bool flushGlyphStore();
+
     // Initialize cache and process (returns false if this specific text couldn't be processed)
     bool processText(const OdGePoint3d &position, const OdGeVector3d &u, const OdGeVector3d &v,
                      const OdChar *pMsg, OdInt32 nLength, bool bRaw, const OdGiTextStyle *pTextStyle,
@@ -146,6 +167,8 @@ class OdTtfFontsCache : public OdRxObject,
     FontCache &getFontCache(FontKey &fontKey, OdFont *pFont);
     OdRxObjectPtr createTextIterator(OdGiConveyorContext *pDrawContext, const OdChar* textString, int length, bool raw, const OdGiTextStyle* pTextStyle) const;
     void procCharacter(OdFont *pFont, FontKey &fontKey, FontCache &fontCache, CharKey chr, OdTextProperties& textProperties, void *pSessionId);
+    void drawCharacter(OdFont *pFont, const FontKey &fontKey, FontCache &fontCache, CharKey chr, OdTextProperties& textProperties,
+                       OdGiConveyorGeometry *pGeom, OdGePoint2d &advance);
     // Stub implementation
     virtual OdRxObjectPtr tfcNewMetafile(void * /*pSessionId*/) { return OdRxObjectPtr(); }
     virtual OdGiConveyorGeometry *tfcBeginMetafile(OdRxObject * /*pMetafile*/, void * /*pSessionId*/) { return &OdGiEmptyGeometry::kVoid; }
@@ -0,0 +1,571 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance").
+// All rights reserved.
+//
+// This software and its documentation and related materials are owned by
+// the Alliance. The software may only be incorporated into application
+// programs owned by members of the Alliance, subject to a signed
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable
+// trade secrets of the Alliance and its suppliers. The software is also
+// protected by copyright law and international treaty provisions. Application
+// programs incorporating this software must include the following statement
+// with their copyright notices:
+//
+//   This application incorporates Open Design Alliance software pursuant to a license
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance.
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OdaCommon.h"
+#include "RxObjectImpl.h"
+#include "RxSystemServices.h"
+#include "OdFont.h"
+#include "Gi/TtfDescriptor.h"
+#include "TtfGlyphStore.h"
+
+#if defined(ODA_WINDOWS) && !defined(_WINRT)
+#include <windows.h>
+#define OD_TTFGLYPHSTORE_WINFILES
+#define odGlyphStoreProcessId() ((unsigned)::GetCurrentProcessId())
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define odGlyphStoreProcessId() ((unsigned)::getpid())
+#else
+#define odGlyphStoreProcessId() 0u
+#endif
+#include <stdio.h>
+
+#ifdef OD_TTFFONTSCACHE_SHAREABLENAMESPACE
+namespace OD_TTFFONTSCACHE_SHAREABLENAMESPACE {
+#endif // OD_TTFFONTSCACHE_SHAREABLENAMESPACE
+
+// Store file layout. All sections are 8-byte aligned, so mapped points could be passed
+// into geometry conveyor without copying. Data written in native byte order, files with
+// foreign byte order are rejected (and rewritten on next flush).
+
+static const char g_glyphStoreMagic[8] = { 'O', 'D', 'T', 'T', 'F', 'G', 'C', '1' };
+static const OdUInt32 g_glyphStoreVersion = 1;
+static const OdUInt32 g_glyphStoreByteOrder = 0x01020304;
+
+// Temporary files of concurrent flushes (from this or other processes) must never collide
+static OdRefCounter g_glyphStoreTmpSeed = 0;
+
+static OdString odGlyphStoreTmpPath(const OdString &filePath)
+{
+  OdString tmpPath;
+  tmpPath.format(OD_T("%ls.%u_%u.tmp"), filePath.c_str(), odGlyphStoreProcessId(), (unsigned)++g_glyphStoreTmpSeed);
+  return tmpPath;
+}
+
+static bool odGlyphStoreReplaceFile(const OdString &source, const OdString &target)
+{
+#if defined(OD_TTFGLYPHSTORE_WINFILES)
+  return ::MoveFileExW(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  return ::rename(OdAnsiString(source, CP_UTF_8).c_str(), OdAnsiString(target, CP_UTF_8).c_str()) == 0;
+#endif
+}
+
+static void odGlyphStoreRemoveFile(const OdString &path)
+{
+#if defined(OD_TTFGLYPHSTORE_WINFILES)
+  ::DeleteFileW(path.c_str());
+#else
+  ::remove(OdAnsiString(path, CP_UTF_8).c_str());
+#endif
+}
+
+struct OdTtfGlyphStoreHeader
+{
+  char     m_magic[8];
+  OdUInt32 m_version;
+  OdUInt32 m_byteOrder;
+  OdUInt32 m_nGlyphs;
+  OdUInt32 m_reserved;
+  OdUInt64 m_dataSize;
+};
+
+struct OdTtfGlyphStoreRecord
+{
+  OdUInt64 m_fontHash;
+  OdUInt32 m_char;
+  OdUInt16 m_quality;
+  OdUInt16 m_flags;
+  double   m_advance;
+  OdUInt32 m_nPrimitives;
+  OdUInt32 m_recordSize; // Including this header
+};
+
+struct OdTtfGlyphStorePrimitive
+{
+  enum Type
+  {
+    kPolyline = 0,
+    kPolygon,
+    kShell,
+    kTtfPolyDraw
+  };
+  enum Flags
+  {
+    kHasNormal = 1
+  };
+  OdUInt16 m_type;
+  OdUInt16 m_flags;
+  OdInt32  m_nPoints;
+  OdInt32  m_nInts;
+  OdInt32  m_nBytes;
+};
+
+inline OdUInt32 odTtfGlyphStoreAlign(OdUInt32 nSize)
+{
+  return (nSize + 7) & ~OdUInt32(7);
+}
+
+// OdTtfGlyphStore
+
+OdTtfGlyphStore::OdTtfGlyphStore()
+{
+}
+
+OdTtfGlyphStore::~OdTtfGlyphStore()
+{
+  unmap();
+}
+
+OdSmartPtr<OdTtfGlyphStore> OdTtfGlyphStore::createObject(const OdString &filePath)
+{
+  OdSmartPtr<OdTtfGlyphStore> pStore = OdRxObjectImpl<OdTtfGlyphStore>::createObject();
+  pStore->open(filePath);
+  return pStore;
+}
+
+void OdTtfGlyphStore::unmap()
+{
+  m_index.clear();
+  OdFileMapping::unmap(m_mapped);
+}
+
+bool OdTtfGlyphStore::map()
+{
+  unmap();
+  if (m_filePath.isEmpty() || !OdFileMapping::mapFile(m_filePath, m_mapped))
+    return false;
+  if (m_mapped.size() < sizeof(OdTtfGlyphStoreHeader))
+  {
+    unmap();
+    return false;
+  }
+  const OdTtfGlyphStoreHeader *pHeader = reinterpret_cast<const OdTtfGlyphStoreHeader*>(m_mapped.data());
+  if (::memcmp(pHeader->m_magic, g_glyphStoreMagic, sizeof(g_glyphStoreMagic)) ||
+      (pHeader->m_version != g_glyphStoreVersion) || (pHeader->m_byteOrder != g_glyphStoreByteOrder) ||
+      (pHeader->m_dataSize + sizeof(OdTtfGlyphStoreHeader) > m_mapped.size()))
+  {
+    unmap();
+    return false;
+  }
+  buildIndex();
+  return true;
+}
+
+// Checks that all primitives of the record (including face lists, which are passed into
+// conveyor as is) lay inside the record, so corrupted store can't cause out of bounds reads.
+static bool odTtfGlyphStoreValidateFaceList(const OdInt32 *pFaces, OdInt32 nFaces, OdInt32 nPoints)
+{
+  OdInt32 nFace = 0;
+  while (nFace < nFaces)
+  {
+    const OdInt32 nFaceVerts = pFaces[nFace++];
+    if ((nFaceVerts == 0) || (nFaceVerts == OdInt32(0x80000000)))
+      return false;
+    const OdInt32 nAbsVerts = (nFaceVerts < 0) ? -nFaceVerts : nFaceVerts;
+    if (nAbsVerts > nFaces - nFace)
+      return false;
+    for (OdInt32 nVert = 0; nVert < nAbsVerts; nVert++, nFace++)
+    {
+      if ((pFaces[nFace] < 0) || (pFaces[nFace] >= nPoints))
+        return false;
+    }
+  }
+  return true;
+}
+
+static bool odTtfGlyphStoreValidateRecord(const OdTtfGlyphStoreRecord *pRecord)
+{
+  if (pRecord->m_recordSize != odTtfGlyphStoreAlign(pRecord->m_recordSize))
+    return false;
+  const OdUInt8 *pData = reinterpret_cast<const OdUInt8*>(pRecord + 1);
+  OdUInt64 nLeft = pRecord->m_recordSize - sizeof(OdTtfGlyphStoreRecord);
+  for (OdUInt32 nPrim = 0; nPrim < pRecord->m_nPrimitives; nPrim++)
+  {
+    if (nLeft < sizeof(OdTtfGlyphStorePrimitive))
+      return false;
+    const OdTtfGlyphStorePrimitive *pPrim = reinterpret_cast<const OdTtfGlyphStorePrimitive*>(pData);
+    if ((pPrim->m_type > OdTtfGlyphStorePrimitive::kTtfPolyDraw) ||
+        (pPrim->m_nPoints < 0) || (pPrim->m_nInts < 0) || (pPrim->m_nBytes < 0))
+      return false;
+    const OdUInt64 nTail = sizeof(OdInt32) * OdUInt64(pPrim->m_nInts) + OdUInt64(pPrim->m_nBytes);
+    const OdUInt64 nPrimSize = sizeof(OdTtfGlyphStorePrimitive) +
+      (GETBIT(pPrim->m_flags, OdTtfGlyphStorePrimitive::kHasNormal) ? sizeof(OdGeVector3d) : 0) +
+      sizeof(OdGePoint3d) * OdUInt64(pPrim->m_nPoints) + ((nTail + 7) & ~OdUInt64(7));
+    if (nPrimSize > nLeft)
+      return false;
+    if ((pPrim->m_type == OdTtfGlyphStorePrimitive::kShell) || (pPrim->m_type == OdTtfGlyphStorePrimitive::kTtfPolyDraw))
+    {
+      const OdInt32 *pInts = reinterpret_cast<const OdInt32*>(pData + (nPrimSize - ((nTail + 7) & ~OdUInt64(7))));
+      if (!::odTtfGlyphStoreValidateFaceList(pInts, pPrim->m_nInts, pPrim->m_nPoints))
+        return false;
+      if ((pPrim->m_type == OdTtfGlyphStorePrimitive::kTtfPolyDraw) && pPrim->m_nBytes && (pPrim->m_nBytes < pPrim->m_nPoints))
+        return false;
+    }
+    pData += nPrimSize;
+    nLeft -= nPrimSize;
+  }
+  return true;
+}
+
+void OdTtfGlyphStore::buildIndex()
+{
+  const OdTtfGlyphStoreHeader *pHeader = reinterpret_cast<const OdTtfGlyphStoreHeader*>(m_mapped.data());
+  const OdUInt8 *pData = m_mapped.data() + sizeof(OdTtfGlyphStoreHeader);
+  const OdUInt8 *pDataEnd = pData + pHeader->m_dataSize;
+  for (OdUInt32 nGlyph = 0; nGlyph < pHeader->m_nGlyphs; nGlyph++)
+  {
+    if (pData + sizeof(OdTtfGlyphStoreRecord) > pDataEnd)
+      break;
+    const OdTtfGlyphStoreRecord *pRecord = reinterpret_cast<const OdTtfGlyphStoreRecord*>(pData);
+    if ((pRecord->m_recordSize < sizeof(OdTtfGlyphStoreRecord)) || (pData + pRecord->m_recordSize > pDataEnd))
+      break; // Truncated file
+    if (!::odTtfGlyphStoreValidateRecord(pRecord))
+    { // Corrupted record is skipped (and dropped on next flush), size is still usable to reach next one
+      pData += pRecord->m_recordSize;
+      continue;
+    }
+    GlyphKey key;
+    key.m_fontHash = pRecord->m_fontHash;
+    key.m_char     = pRecord->m_char;
+    key.m_quality  = pRecord->m_quality;
+    key.m_flags    = pRecord->m_flags;
+    m_index[key] = pData;
+    pData += pRecord->m_recordSize;
+  }
+}
+
+bool OdTtfGlyphStore::open(const OdString &filePath)
+{
+  TD_AUTOLOCK(m_mutex);
+  m_filePath = filePath;
+  return map();
+}
+
+void OdTtfGlyphStore::playRecord(const OdUInt8 *pData, OdGiConveyorGeometry *pGeom, double &advance)
+{
+  const OdTtfGlyphStoreRecord *pRecord = reinterpret_cast<const OdTtfGlyphStoreRecord*>(pData);
+  advance = pRecord->m_advance;
+  pData += sizeof(OdTtfGlyphStoreRecord);
+  for (OdUInt32 nPrim = 0; nPrim < pRecord->m_nPrimitives; nPrim++)
+  {
+    const OdTtfGlyphStorePrimitive *pPrim = reinterpret_cast<const OdTtfGlyphStorePrimitive*>(pData);
+    pData += sizeof(OdTtfGlyphStorePrimitive);
+    const OdGeVector3d *pNormal = NULL;
+    if (GETBIT(pPrim->m_flags, OdTtfGlyphStorePrimitive::kHasNormal))
+    {
+      pNormal = reinterpret_cast<const OdGeVector3d*>(pData);
+      pData += sizeof(OdGeVector3d);
+    }
+    const OdGePoint3d *pPoints = reinterpret_cast<const OdGePoint3d*>(pData);
+    pData += sizeof(OdGePoint3d) * pPrim->m_nPoints;
+    const OdInt32 *pInts = reinterpret_cast<const OdInt32*>(pData);
+    const OdUInt8 *pBytes = pData + sizeof(OdInt32) * pPrim->m_nInts;
+    pData += odTtfGlyphStoreAlign(sizeof(OdInt32) * pPrim->m_nInts + pPrim->m_nBytes);
+    switch (pPrim->m_type)
+    {
+      case OdTtfGlyphStorePrimitive::kPolyline:
+        pGeom->polylineProc(pPrim->m_nPoints, pPoints, pNormal);
+      break;
+      case OdTtfGlyphStorePrimitive::kPolygon:
+        pGeom->polygonProc(pPrim->m_nPoints, pPoints, pNormal);
+      break;
+      case OdTtfGlyphStorePrimitive::kShell:
+        pGeom->shellProc(pPrim->m_nPoints, pPoints, pPrim->m_nInts, pInts);
+      break;
+      case OdTtfGlyphStorePrimitive::kTtfPolyDraw:
+        pGeom->ttfPolyDrawProc(pPrim->m_nPoints, pPoints, pPrim->m_nInts, pInts, (pPrim->m_nBytes) ? pBytes : NULL);
+      break;
+    }
+  }
+}
+
+bool OdTtfGlyphStore::playGlyph(const GlyphKey &key, OdGiConveyorGeometry *pGeom, double &advance) const
+{
+  const OdUInt8 *pRecord = NULL;
+  {
+    TD_AUTOLOCK(m_mutex);
+    MappedIndex::const_iterator it = m_index.find(key);
+    if (it != m_index.end())
+      pRecord = it->second;
+    else
+    {
+      PendingMap::const_iterator itPending = m_pending.find(key);
+      if (itPending != m_pending.end())
+        pRecord = itPending->second.getPtr();
+    }
+    if (pRecord)
+      m_stats.m_nHits++;
+    else
+      m_stats.m_nMisses++;
+  }
+  // Mapping and pending records stay unchanged until flush(), which must not be
+  // invoked concurrently with vectorization.
+  if (pRecord)
+    playRecord(pRecord, pGeom, advance);
+  return pRecord != NULL;
+}
+
+void OdTtfGlyphStore::addGlyph(const GlyphKey &key, const OdBinaryData &primitives, OdUInt32 nPrimitives, double advance)
+{
+  OdBinaryData record;
+  record.resize(sizeof(OdTtfGlyphStoreRecord) + primitives.size());
+  OdTtfGlyphStoreRecord *pRecord = reinterpret_cast<OdTtfGlyphStoreRecord*>(record.asArrayPtr());
+  pRecord->m_fontHash    = key.m_fontHash;
+  pRecord->m_char        = key.m_char;
+  pRecord->m_quality     = key.m_quality;
+  pRecord->m_flags       = key.m_flags;
+  pRecord->m_advance     = advance;
+  pRecord->m_nPrimitives = nPrimitives;
+  pRecord->m_recordSize  = record.size();
+  if (!primitives.isEmpty())
+    ::memcpy(pRecord + 1, primitives.getPtr(), primitives.size());
+  TD_AUTOLOCK(m_mutex);
+  // Existing record could be played by other thread outside the lock, so it must never be replaced
+  if ((m_index.find(key) == m_index.end()) && (m_pending.find(key) == m_pending.end()))
+    m_pending[key] = record;
+}
+
+bool OdTtfGlyphStore::flush()
+{
+  TD_AUTOLOCK(m_mutex);
+  if (m_pending.empty() || m_filePath.isEmpty())
+    return m_pending.empty();
+  // Other process could update store file since it was mapped, so remap it to merge glyphs
+  map();
+  OdUInt64 nDataSize = 0;
+  OdUInt32 nGlyphs = 0;
+  {
+    MappedIndex::const_iterator it = m_index.begin();
+    for (; it != m_index.end(); it++, nGlyphs++)
+      nDataSize += reinterpret_cast<const OdTtfGlyphStoreRecord*>(it->second)->m_recordSize;
+    PendingMap::const_iterator itPending = m_pending.begin();
+    for (; itPending != m_pending.end(); itPending++)
+    {
+      if (m_index.find(itPending->first) == m_index.end())
+        nDataSize += itPending->second.size(), nGlyphs++;
+    }
+  }
+  OdTtfGlyphStoreHeader header;
+  ::memcpy(header.m_magic, g_glyphStoreMagic, sizeof(g_glyphStoreMagic));
+  header.m_version = g_glyphStoreVersion;
+  header.m_byteOrder = g_glyphStoreByteOrder;
+  header.m_nGlyphs = nGlyphs;
+  header.m_reserved = 0;
+  header.m_dataSize = nDataSize;
+  // Write new store into temporary file, so readers always see complete store
+  const OdString tmpPath = ::odGlyphStoreTmpPath(m_filePath);
+  try
+  {
+    OdStreamBufPtr pStream = ::odrxSystemServices()->createFile(tmpPath, Oda::kFileWrite, Oda::kShareDenyReadWrite, Oda::kCreateAlways);
+    pStream->putBytes(&header, sizeof(OdTtfGlyphStoreHeader));
+    MappedIndex::const_iterator it = m_index.begin();
+    for (; it != m_index.end(); it++)
+      pStream->putBytes(it->second, reinterpret_cast<const OdTtfGlyphStoreRecord*>(it->second)->m_recordSize);
+    PendingMap::const_iterator itPending = m_pending.begin();
+    for (; itPending != m_pending.end(); itPending++)
+    {
+      if (m_index.find(itPending->first) == m_index.end())
+        pStream->putBytes(itPending->second.getPtr(), itPending->second.size());
+    }
+  }
+  catch (const OdError &)
+  {
+    ::odGlyphStoreRemoveFile(tmpPath);
+    return false;
+  }
+  // Mapping must be released before file replacement on Windows
+  unmap();
+  const bool bReplaced = ::odGlyphStoreReplaceFile(tmpPath, m_filePath);
+  map();
+  if (!bReplaced)
+  {
+    ::odGlyphStoreRemoveFile(tmpPath);
+    return false;
+  }
+  // Keep pending glyphs which wasn't found in the new mapping (file could be replaced by other process)
+  PendingMap::iterator itPending = m_pending.begin();
+  while (itPending != m_pending.end())
+  {
+    if (m_index.find(itPending->first) != m_index.end())
+      m_pending.erase(itPending++);
+    else
+      itPending++;
+  }
+  return true;
+}
+
+OdTtfGlyphStore::Stats OdTtfGlyphStore::stats() const
+{
+  TD_AUTOLOCK(m_mutex);
+  Stats curStats = m_stats;
+  curStats.m_nMapped = (OdUInt32)m_index.size();
+  curStats.m_nPending = (OdUInt32)m_pending.size();
+  curStats.m_nMappedBytes = m_mapped.size();
+  return curStats;
+}
+
+// FNV-1a
+inline void odTtfGlyphStoreHash(OdUInt64 &hash, const void *pData, size_t nSize)
+{
+  const OdUInt8 *pBytes = reinterpret_cast<const OdUInt8*>(pData);
+  for (size_t nByte = 0; nByte < nSize; nByte++)
+  {
+    hash ^= pBytes[nByte];
+    hash *= 0x100000001B3ULL;
+  }
+}
+
+OdUInt64 OdTtfGlyphStore::fontHash(const OdFont *pFont)
+{
+  // Font files could be large, so hash only file length and head and tail blocks, which
+  // contain font tables directory and naming information.
+  const OdUInt32 nBlock = 65536;
+  OdUInt64 hash = 0xCBF29CE484222325ULL;
+  OdBinaryData buf;
+  const OdUInt32 nFontData = pFont->getFontData(0, 0, NULL, 0);
+  if (nFontData && (nFontData != OdUInt32(-1)))
+  {
+    odTtfGlyphStoreHash(hash, &nFontData, sizeof(OdUInt32));
+    buf.resize(odmin(nFontData, nBlock));
+    if (pFont->getFontData(0, 0, buf.asArrayPtr(), buf.size()) == buf.size())
+    {
+      odTtfGlyphStoreHash(hash, buf.getPtr(), buf.size());
+      if (nFontData > nBlock && pFont->getFontData(0, nFontData - buf.size(), buf.asArrayPtr(), buf.size()) == buf.size())
+        odTtfGlyphStoreHash(hash, buf.getPtr(), buf.size());
+      return hash;
+    }
+  }
+  const OdString fileName = pFont->getFileName();
+  if (!fileName.isEmpty() && ::odrxSystemServices()->accessFile(fileName, Oda::kFileRead))
+  {
+    try
+    {
+      OdStreamBufPtr pStream = ::odrxSystemServices()->createFile(fileName, Oda::kFileRead, Oda::kShareDenyWrite, Oda::kOpenExisting);
+      const OdUInt64 nLength = pStream->length();
+      odTtfGlyphStoreHash(hash, &nLength, sizeof(OdUInt64));
+      buf.resize((OdUInt32)odmin(nLength, (OdUInt64)nBlock));
+      pStream->getBytes(buf.asArrayPtr(), buf.size());
+      odTtfGlyphStoreHash(hash, buf.getPtr(), buf.size());
+      if (nLength > nBlock)
+      {
+        pStream->seek(nLength - buf.size(), OdDb::kSeekFromStart);
+        pStream->getBytes(buf.asArrayPtr(), buf.size());
+        odTtfGlyphStoreHash(hash, buf.getPtr(), buf.size());
+      }
+      return hash;
+    }
+    catch (const OdError &)
+    {
+    }
+  }
+  // Font file isn't accessible, so identify font by descriptor
+  OdTtfDescriptor ttfDesc;
+  pFont->getDescriptor(ttfDesc);
+  odTtfGlyphStoreHash(hash, ttfDesc.typeface().c_str(), ttfDesc.typeface().getLength() * sizeof(OdChar));
+  odTtfGlyphStoreHash(hash, ttfDesc.fileName().c_str(), ttfDesc.fileName().getLength() * sizeof(OdChar));
+  const OdUInt32 descFlags = (OdUInt32)ttfDesc.charSet() | ((OdUInt32)ttfDesc.pitchAndFamily() << 16);
+  odTtfGlyphStoreHash(hash, &descFlags, sizeof(OdUInt32));
+  return hash;
+}
+
+// OdTtfGlyphRecorder
+
+void OdTtfGlyphRecorder::addPrimitive(OdUInt16 type, const OdGeVector3d *pNormal, OdInt32 nPoints, const OdGePoint3d *pPoints,
+                                      OdInt32 nInts, const OdInt32 *pInts, OdInt32 nBytes, const OdUInt8 *pBytes)
+{
+  const OdUInt32 nTail = sizeof(OdInt32) * nInts + nBytes;
+  const OdUInt32 nSize = sizeof(OdTtfGlyphStorePrimitive) + ((pNormal) ? sizeof(OdGeVector3d) : 0) +
+                         sizeof(OdGePoint3d) * nPoints + odTtfGlyphStoreAlign(nTail);
+  const OdUInt32 nOffset = m_data.size();
+  m_data.resize(nOffset + nSize, 0);
+  OdUInt8 *pData = m_data.asArrayPtr() + nOffset;
+  OdTtfGlyphStorePrimitive *pPrim = reinterpret_cast<OdTtfGlyphStorePrimitive*>(pData);
+  pPrim->m_type = type;
+  pPrim->m_flags = (pNormal) ? OdTtfGlyphStorePrimitive::kHasNormal : 0;
+  pPrim->m_nPoints = nPoints;
+  pPrim->m_nInts = nInts;
+  pPrim->m_nBytes = nBytes;
+  pData += sizeof(OdTtfGlyphStorePrimitive);
+  if (pNormal)
+  {
+    ::memcpy(pData, pNormal, sizeof(OdGeVector3d));
+    pData += sizeof(OdGeVector3d);
+  }
+  if (nPoints)
+  {
+    ::memcpy(pData, pPoints, sizeof(OdGePoint3d) * nPoints);
+    pData += sizeof(OdGePoint3d) * nPoints;
+  }
+  if (nInts)
+  {
+    ::memcpy(pData, pInts, sizeof(OdInt32) * nInts);
+    pData += sizeof(OdInt32) * nInts;
+  }
+  if (nBytes)
+    ::memcpy(pData, pBytes, nBytes);
+  m_nPrimitives++;
+}
+
+void OdTtfGlyphRecorder::polylineProc(OdInt32 numPoints, const OdGePoint3d* vertexList, const OdGeVector3d* pNormal,
+                                      const OdGeVector3d* pExtrusion, OdGsMarker /*baseSubEntMarker*/)
+{
+  if (pExtrusion)
+    invalidate();
+  else
+    addPrimitive(OdTtfGlyphStorePrimitive::kPolyline, pNormal, numPoints, vertexList, 0, NULL, 0, NULL);
+}
+
+void OdTtfGlyphRecorder::polygonProc(OdInt32 numPoints, const OdGePoint3d* vertexList, const OdGeVector3d* pNormal,
+                                     const OdGeVector3d* pExtrusion)
+{
+  if (pExtrusion)
+    invalidate();
+  else
+    addPrimitive(OdTtfGlyphStorePrimitive::kPolygon, pNormal, numPoints, vertexList, 0, NULL, 0, NULL);
+}
+
+void OdTtfGlyphRecorder::shellProc(OdInt32 numVertices, const OdGePoint3d* vertexList, OdInt32 faceListSize, const OdInt32* faceList,
+                                   const OdGiEdgeData* pEdgeData, const OdGiFaceData* pFaceData, const OdGiVertexData* pVertexData)
+{
+  if (pEdgeData || pFaceData || pVertexData)
+    invalidate();
+  else
+    addPrimitive(OdTtfGlyphStorePrimitive::kShell, NULL, numVertices, vertexList, faceListSize, faceList, 0, NULL);
+}
+
+void OdTtfGlyphRecorder::ttfPolyDrawProc(OdInt32 numVertices, const OdGePoint3d* vertexList, OdInt32 faceListSize, const OdInt32* faceList,
+                                         const OdUInt8* pBezierTypes, const OdGiFaceData* pFaceData)
+{
+  if (pFaceData)
+    invalidate();
+  else
+    addPrimitive(OdTtfGlyphStorePrimitive::kTtfPolyDraw, NULL, numVertices, vertexList, faceListSize, faceList,
+                 (pBezierTypes) ? numVertices : 0, pBezierTypes);
+}
+
+#ifdef OD_TTFFONTSCACHE_SHAREABLENAMESPACE
+}
+#endif // OD_TTFFONTSCACHE_SHAREABLENAMESPACE
+
+//
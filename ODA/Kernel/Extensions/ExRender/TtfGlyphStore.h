@@ -0,0 +1,213 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance").
+// All rights reserved.
+//
+// This software and its documentation and related materials are owned by
+// the Alliance. The software may only be incorporated into application
+// programs owned by members of the Alliance, subject to a signed
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable
+// trade secrets of the Alliance and its suppliers. The software is also
+// protected by copyright law and international treaty provisions. Application
+// programs incorporating this software must include the following statement
+// with their copyright notices:
+//
+//   This application incorporates Open Design Alliance software pursuant to a license
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance.
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ODTTFGLYPHSTORE_INCLUDED
+#define ODTTFGLYPHSTORE_INCLUDED
+
+#include "TD_PackPush.h"
+
+#include "RxObject.h"
+#include "OdBinaryData.h"
+#include "OdHashMap.h"
+#include "OdMutex.h"
+#include "Gi/GiConveyorGeometry.h"
+#include "OdFileMapping.h"
+
+class OdFont;
+
+#ifdef OD_TTFFONTSCACHE_SHAREABLENAMESPACE
+namespace OD_TTFFONTSCACHE_SHAREABLENAMESPACE {
+#endif // OD_TTFFONTSCACHE_SHAREABLENAMESPACE
+
+// OdTtfGlyphStore
+
+/** \details
+  Persistent, process and device independent storage for tessellated TrueType glyphs.
+
+  Glyphs are keyed by font file content hash, character (or glyph index), text quality
+  and font style flags. Stored file is memory mapped on open and recorded geometry is
+  played directly from the mapped memory. Glyphs created during session are written
+  by flush() into temporary file which replaces the previous store file, so concurrent
+  processes never see partially written store.
+
+  <group ExRender_Classes>
+*/
+class OdTtfGlyphStore : public OdRxObject
+{
+  public:
+    // Key for single glyph
+    struct GlyphKey
+    {
+      OdUInt64 m_fontHash; // Content hash of font file
+      OdUInt32 m_char;     // Character code or glyph index
+      OdUInt16 m_quality;  // Text quality (tessellation deviation)
+      OdUInt16 m_flags;    // Font style and tessellation flags
+
+      GlyphKey() : m_fontHash(0), m_char(0), m_quality(0), m_flags(0) { }
+      bool operator ==(const GlyphKey &k2) const
+      {
+        return (m_fontHash == k2.m_fontHash) && (m_char == k2.m_char) &&
+               (m_quality == k2.m_quality) && (m_flags == k2.m_flags);
+      }
+      bool operator <(const GlyphKey &k2) const
+      {
+        if (m_fontHash != k2.m_fontHash) return m_fontHash < k2.m_fontHash;
+        if (m_char != k2.m_char) return m_char < k2.m_char;
+        if (m_quality != k2.m_quality) return m_quality < k2.m_quality;
+        return m_flags < k2.m_flags;
+      }
+    };
+    struct GlyphKeyHash
+    {
+      size_t operator()(const GlyphKey &key) const
+      {
+        OdUInt64 h = key.m_fontHash ^ (OdUInt64(key.m_char) * 0x9E3779B97F4A7C15ULL) ^
+                     (OdUInt64(key.m_quality) << 48) ^ (OdUInt64(key.m_flags) << 32);
+        return (size_t)(h ^ (h >> 29));
+      }
+    };
+    // Usage statistics
+    struct Stats
+    {
+      OdUInt32 m_nMapped;   // Glyphs available from mapped file
+      OdUInt32 m_nPending;  // Glyphs recorded in this session and not flushed yet
+      OdUInt64 m_nHits;
+      OdUInt64 m_nMisses;
+      OdUInt64 m_nMappedBytes;
+
+      Stats() : m_nMapped(0), m_nPending(0), m_nHits(0), m_nMisses(0), m_nMappedBytes(0) { }
+    };
+  protected:
+    typedef OdHashMap<GlyphKey, const OdUInt8*, GlyphKeyHash> MappedIndex;
+    typedef OdHashMap<GlyphKey, OdBinaryData, GlyphKeyHash> PendingMap;
+    OdString       m_filePath;
+    OdFileMapping::View m_mapped;
+    MappedIndex    m_index;
+    PendingMap     m_pending;
+    mutable OdMutex m_mutex;
+    mutable Stats  m_stats;
+
+    void unmap();
+    bool map();
+    void buildIndex();
+    static void playRecord(const OdUInt8 *pRecord, OdGiConveyorGeometry *pGeom, double &advance);
+  public:
+    OdTtfGlyphStore();
+    ~OdTtfGlyphStore();
+
+    ODRX_USING_HEAP_OPERATORS(OdRxObject);
+
+    // Creates store and opens (or prepares for creation) specified file
+    static OdSmartPtr<OdTtfGlyphStore> createObject(const OdString &filePath);
+
+    // Opens store file. Returns false if file doesn't exist or has incompatible format.
+    bool open(const OdString &filePath);
+    const OdString &filePath() const { return m_filePath; }
+    // Writes glyphs recorded during session into store file
+    bool flush();
+
+    // Plays stored glyph into geometry. Returns false if glyph isn't stored.
+    bool playGlyph(const GlyphKey &key, OdGiConveyorGeometry *pGeom, double &advance) const;
+    // Stores glyph recorded by OdTtfGlyphRecorder
+    void addGlyph(const GlyphKey &key, const OdBinaryData &primitives, OdUInt32 nPrimitives, double advance);
+
+    Stats stats() const;
+
+    // Computes font key from font file contents (falls back to font descriptor if file isn't accessible)
+    static OdUInt64 fontHash(const OdFont *pFont);
+};
+
+typedef OdSmartPtr<OdTtfGlyphStore> OdTtfGlyphStorePtr;
+
+// OdTtfGlyphRecorder
+
+/** \details
+  Records glyph geometry output into OdTtfGlyphStore format. Glyph is marked as
+  not recordable if font emits primitives which aren't supported by the store.
+
+  <group ExRender_Classes>
+*/
+class OdTtfGlyphRecorder : public OdGiConveyorGeometry
+{
+  protected:
+    OdBinaryData m_data;
+    OdUInt32     m_nPrimitives;
+    bool         m_bValid;
+
+    void addPrimitive(OdUInt16 type, const OdGeVector3d *pNormal, OdInt32 nPoints, const OdGePoint3d *pPoints,
+                      OdInt32 nInts, const OdInt32 *pInts, OdInt32 nBytes, const OdUInt8 *pBytes);
+    void invalidate() { m_bValid = false; }
+  public:
+    OdTtfGlyphRecorder() : m_nPrimitives(0), m_bValid(true) { }
+
+    bool isValid() const { return m_bValid; }
+    const OdBinaryData &data() const { return m_data; }
+    OdUInt32 numPrimitives() const { return m_nPrimitives; }
+
+    // Recorded primitives
+    void polylineProc(OdInt32 numPoints, const OdGePoint3d* vertexList, const OdGeVector3d* pNormal = 0,
+                      const OdGeVector3d* pExtrusion = 0, OdGsMarker baseSubEntMarker = -1);
+    void polygonProc(OdInt32 numPoints, const OdGePoint3d* vertexList, const OdGeVector3d* pNormal = 0,
+                     const OdGeVector3d* pExtrusion = 0);
+    void shellProc(OdInt32 numVertices, const OdGePoint3d* vertexList, OdInt32 faceListSize, const OdInt32* faceList,
+                   const OdGiEdgeData* pEdgeData = 0, const OdGiFaceData* pFaceData = 0, const OdGiVertexData* pVertexData = 0);
+    void ttfPolyDrawProc(OdInt32 numVertices, const OdGePoint3d* vertexList, OdInt32 faceListSize, const OdInt32* faceList,
+                         const OdUInt8* pBezierTypes, const OdGiFaceData* pFaceData = 0);
+
+    // Not supported primitives
+    void plineProc(const OdGiPolyline& , const OdGeMatrix3d* = 0, OdUInt32 = 0, OdUInt32 = 0) { invalidate(); }
+    void xlineProc(const OdGePoint3d& , const OdGePoint3d& ) { invalidate(); }
+    void rayProc(const OdGePoint3d& , const OdGePoint3d& ) { invalidate(); }
+    void meshProc(OdInt32 , OdInt32 , const OdGePoint3d* , const OdGiEdgeData* = 0, const OdGiFaceData* = 0,
+                  const OdGiVertexData* = 0) { invalidate(); }
+    void circleProc(const OdGePoint3d& , double , const OdGeVector3d& , const OdGeVector3d* = 0) { invalidate(); }
+    void circleProc(const OdGePoint3d& , const OdGePoint3d& , const OdGePoint3d& , const OdGeVector3d* = 0) { invalidate(); }
+    void circularArcProc(const OdGePoint3d& , double , const OdGeVector3d& , const OdGeVector3d& , double ,
+                         OdGiArcType = kOdGiArcSimple, const OdGeVector3d* = 0) { invalidate(); }
+    void circularArcProc(const OdGePoint3d& , const OdGePoint3d& , const OdGePoint3d& ,
+                         OdGiArcType = kOdGiArcSimple, const OdGeVector3d* = 0) { invalidate(); }
+    void ellipArcProc(const OdGeEllipArc3d& , const OdGePoint3d* = 0, OdGiArcType = kOdGiArcSimple,
+                      const OdGeVector3d* = 0) { invalidate(); }
+    void nurbsProc(const OdGeNurbCurve3d& ) { invalidate(); }
+    void textProc(const OdGePoint3d& , const OdGeVector3d& , const OdGeVector3d& , const OdChar* , OdInt32 ,
+                  bool , const OdGiTextStyle* , const OdGeVector3d* = 0) { invalidate(); }
+    void shapeProc(const OdGePoint3d& , const OdGeVector3d& , const OdGeVector3d& , int ,
+                   const OdGiTextStyle* , const OdGeVector3d* = 0) { invalidate(); }
+    void rasterImageProc(const OdGePoint3d& , const OdGeVector3d& , const OdGeVector3d& , const OdGiRasterImage* ,
+                         const OdGePoint2d* , OdUInt32 , bool = false, double = 50.0, double = 50.0, double = 0.0) { invalidate(); }
+    void metafileProc(const OdGePoint3d& , const OdGeVector3d& , const OdGeVector3d& , const OdGiMetafile* ,
+                      bool = true, bool = false) { invalidate(); }
+    void polypointProc(OdInt32 , const OdGePoint3d* , const OdCmEntityColor* , const OdCmTransparency* ,
+                       const OdGeVector3d* , const OdGeVector3d* , const OdGsMarker* , OdInt32 ) { invalidate(); }
+    void rowOfDotsProc(OdInt32 , const OdGePoint3d& , const OdGeVector3d& ) { invalidate(); }
+    void pointCloudProc(const OdGiPointCloud &, const OdGiPointCloudFilter * = NULL) { invalidate(); }
+    void edgeProc(const OdGiEdge2dArray& , const OdGeMatrix3d* = 0) { invalidate(); }
+};
+
+#ifdef OD_TTFFONTSCACHE_SHAREABLENAMESPACE
+}
+#endif // OD_TTFFONTSCACHE_SHAREABLENAMESPACE
+
+#include "TD_PackPop.h"
+
+#endif // ODTTFGLYPHSTORE_INCLUDED
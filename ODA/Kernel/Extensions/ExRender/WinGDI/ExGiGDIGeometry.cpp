@@ -41,6 +41,7 @@
 #include "Gi/GiViewportGeometry.h"
 #include "Gi/GiRasterWrappers.h"
 #include "Gi/GiSubEntityTraitsData.h"
+#include "ExGiTiledRasterImage.h"
 
 #include "RxDictionary.h"
 #include "OdFontServices.h"
@@ -2778,6 +2779,39 @@ void ExGiGDIGeometry::rasterImageProc(const OdGePoint3d& origin,
   if(u2d.isParallelTo(v2d))
     return ; // image became degenerated
 
+  // Zoomed out tiled images are drawn from mip level which matches device resolution,
+  // so full resolution tiles aren't decoded
+  const OdExGiRasterImageLevels *pLevels = dynamic_cast<const OdExGiRasterImageLevels*>(pImg);
+  if(pLevels && !pLevels->level())
+  {
+    const OdUInt32 nLevel = pLevels->levelForScale(1.0 / odmax(u2d.length(), v2d.length()));
+    if(nLevel)
+    {
+      OdGiRasterImagePtr pLevelImg = pLevels->levelImage(nLevel);
+      const double scale = double(1 << nLevel);
+      const double srcHeight = pImg->pixelHeight(), dstHeight = pLevelImg->pixelHeight();
+      OdGePoint2d corners[4];
+      if(!numBoundPts)
+      {
+        corners[0].set(-0.5, -0.5);
+        corners[2].set(pImg->pixelWidth() - 0.5, srcHeight - 0.5);
+        corners[1].set(corners[0].x, corners[2].y);
+        corners[3].set(corners[2].x, corners[0].y);
+        uvBoundary = corners;
+        numBoundPts = 4;
+      }
+      // Levels are aligned by bottom left corner, so origin stays the same and partial
+      // top row of level is clipped off by the converted boundary
+      OdGePoint2dArray levelBoundary(numBoundPts);
+      for(OdUInt32 nPt = 0; nPt < numBoundPts; nPt++)
+        levelBoundary.push_back(OdGePoint2d((uvBoundary[nPt].x + 0.5) / scale - 0.5,
+                                            dstHeight - 0.5 - (srcHeight - 0.5 - uvBoundary[nPt].y) / scale));
+      rasterImageProc(origin, u * scale, v * scale, pLevelImg, levelBoundary.getPtr(), numBoundPts,
+                      transparency, brightness, contrast, fade);
+      return;
+    }
+  }
+
 #ifndef _WIN32_WCE
   StretchBltModeSaver _sbms( m_hTargetDC, (pImg->colorDepth() > 1) ? COLORONCOLOR : StretchBltModeSaver::monoImageMode(transparency, m_paletteColors[0]));
 #endif
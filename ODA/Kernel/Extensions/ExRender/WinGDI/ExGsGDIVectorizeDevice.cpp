@@ -76,6 +76,7 @@ ODRX_DECLARE_PROPERTY(ClearScreen)
 ODRX_DECLARE_PROPERTY(EnableSoftwareHLR)
 ODRX_DECLARE_PROPERTY(UseTextOut)
 ODRX_DECLARE_PROPERTY(UseTTFCache)
+ODRX_DECLARE_PROPERTY(TTFGlyphStore)
 ODRX_DECLARE_PROPERTY(MinTTFTextSize)
 ODRX_DECLARE_PROPERTY(GradientsAsBitmap)
 ODRX_DECLARE_PROPERTY(GradientsAsPolys)
@@ -88,6 +89,7 @@ ODRX_BEGIN_DYNAMIC_PROPERTY_MAP(ExGsGDIVectorizeDevice);
   ODRX_GENERATE_PROPERTY(EnableSoftwareHLR)
   ODRX_GENERATE_PROPERTY(UseTextOut)
   ODRX_GENERATE_PROPERTY(UseTTFCache)
+  ODRX_GENERATE_PROPERTY(TTFGlyphStore)
   ODRX_GENERATE_PROPERTY(MinTTFTextSize)
   ODRX_GENERATE_PROPERTY(GradientsAsBitmap)
   ODRX_GENERATE_PROPERTY(GradientsAsPolys)
@@ -99,6 +101,7 @@ ODRX_DEFINE_PROPERTY_METHODS(ClearScreen,               ExGsGDIVectorizeDevice,
 ODRX_DEFINE_PROPERTY_METHODS(EnableSoftwareHLR,         ExGsGDIVectorizeDevice, useSoftwareHLR,               setUseSoftwareHLR,               getBool);
 ODRX_DEFINE_PROPERTY_METHODS(UseTextOut,                ExGsGDIVectorizeDevice, useTextOut,                   setUseTextOut,                   getBool);
 ODRX_DEFINE_PROPERTY_METHODS(UseTTFCache,               ExGsGDIVectorizeDevice, useTtfCache,                  setUseTtfCache,                  getBool);
+ODRX_DEFINE_PROPERTY_METHODS(TTFGlyphStore,             ExGsGDIVectorizeDevice, ttfGlyphStorePath,            setTtfGlyphStorePath,            getString);
 ODRX_DEFINE_PROPERTY_METHODS(MinTTFTextSize,            ExGsGDIVectorizeDevice, minimalTTFTextSize,           setMinimalTTFTextSize,           getDouble);
 ODRX_DEFINE_PROPERTY_METHODS(GradientsAsBitmap,         ExGsGDIVectorizeDevice, gradientsAsBitmap,            setGradientsAsBitmap,            getBool);
 ODRX_DEFINE_PROPERTY_METHODS(GradientsAsPolys,          ExGsGDIVectorizeDevice, gradientsAsPolygons,          setGradientsAsPolygons,          getBool);
@@ -379,6 +382,8 @@ void ExGsGDIVectorizeDevice::update(OdGsDCRect* pUpdatedRect)
     m_pTtfCache = OdTtfFontsCache::createObject(this);
   else if (!useTtfCache() && !m_pTtfCache.isNull())
     m_pTtfCache.release();
+  if (!m_pTtfCache.isNull())
+    m_pTtfCache->setGlyphStorePath(ttfGlyphStorePath());
 
   if (!supportPartialUpdate())
   {
@@ -397,6 +402,10 @@ void ExGsGDIVectorizeDevice::update(OdGsDCRect* pUpdatedRect)
   {
     endPaint();
   }
+
+  // Glyphs recorded during this update are saved while vectorization threads are idle
+  if (!m_pTtfCache.isNull())
+    m_pTtfCache->flushGlyphStore();
 }
 
 //*******************************************************************************/
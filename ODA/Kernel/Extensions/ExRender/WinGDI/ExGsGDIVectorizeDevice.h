@@ -141,6 +141,7 @@ class ExGsGDIVectorizeDevice : public ExGsBaseGDIVectorizeDevice
   double                  m_dMinTTFTextSize;
   OdGsBaseDeviceMTHelpers m_deviceSync;
   OdTtfFontsCachePtr      m_pTtfCache;
+  OdString                m_ttfGlyphStorePath;
 
   HDC createDrawDc();
   void deleteDrawDc();
@@ -225,6 +226,16 @@ public:
   */
   void setUseTtfCache(bool useTtfCache) { m_bUseTtfCache = useTtfCache; }
 
+  /** \details
+    Returns path to persistent TrueType glyphs store file used by TtfFonts cache of this Vectorizer Device object.
+  */
+  const OdString &ttfGlyphStorePath() const { return m_ttfGlyphStorePath; }
+  /** \details
+    Controls path to persistent TrueType glyphs store file. Empty path disables persistent glyphs store.
+    \param filePath [in]  Store file path.
+  */
+  void setTtfGlyphStorePath(const OdString &filePath) { m_ttfGlyphStorePath = filePath; }
+
   /** \details
     Returns minimal TrueType Text size with which text still not rendered as simplified geometry.
   */
@@ -47,6 +47,7 @@ ODRX_DECLARE_PROPERTY(BitPerPixel)
 ODRX_DECLARE_PROPERTY(EnableSoftwareHLR)
 ODRX_DECLARE_PROPERTY(UseTextOut)
 ODRX_DECLARE_PROPERTY(UseTTFCache)
+ODRX_DECLARE_PROPERTY(TTFGlyphStore)
 ODRX_DECLARE_PROPERTY(GDITransparencyMode)
 public:
 
@@ -78,6 +79,7 @@ ODRX_GENERATE_PROPERTY(BitPerPixel)
 ODRX_GENERATE_PROPERTY(EnableSoftwareHLR)
 ODRX_GENERATE_PROPERTY(UseTextOut)
 ODRX_GENERATE_PROPERTY(UseTTFCache)
+ODRX_GENERATE_PROPERTY(TTFGlyphStore)
 ODRX_GENERATE_PROPERTY(GDITransparencyMode)
 ODRX_END_DYNAMIC_PROPERTY_MAP(ExGsGDIBitmapVectorizeDevice)
 
@@ -86,6 +88,7 @@ ODRX_DEFINE_PROPERTY_PREFIX(ExGsGDIBitmapVectorizeDevice::, BitPerPixel, ExGsGDI
 ODRX_DEFINE_PROPERTY_METHODS_PREFIX(ExGsGDIBitmapVectorizeDevice::, EnableSoftwareHLR, ExGsGDIBitmapVectorizeDevice, useSoftwareHLR, setUseSoftwareHLR, getBool)
 ODRX_DEFINE_PROPERTY_METHODS_PREFIX(ExGsGDIBitmapVectorizeDevice::, UseTextOut, ExGsGDIBitmapVectorizeDevice, useTextOut, setUseTextOut, getBool)
 ODRX_DEFINE_PROPERTY_METHODS_PREFIX( ExGsGDIBitmapVectorizeDevice::, UseTTFCache, ExGsGDIBitmapVectorizeDevice, useTtfCache, setUseTtfCache, getBool )
+ODRX_DEFINE_PROPERTY_METHODS_PREFIX(ExGsGDIBitmapVectorizeDevice::, TTFGlyphStore, ExGsGDIBitmapVectorizeDevice, ttfGlyphStorePath, setTtfGlyphStorePath, getString)
 ODRX_DEFINE_PROPERTY_METHODS_PREFIX(ExGsGDIBitmapVectorizeDevice::, GDITransparencyMode, ExGsGDIBitmapVectorizeDevice, getTransparencyMode, setTransparencyMode, getUInt8 )
 
 class WinGDIModule : public OdGsBaseModule
@@ -36,6 +36,11 @@ ExFileUndoController::ExFileUndoController()
 
 void ExFileUndoController::pushData(OdStreamBuf* pStream, OdUInt32 nSize, OdUInt32 opt)
 {
+  if (!m_pStore.isNull())
+  {
+    m_pStore->push(pStream, nSize, opt);
+    return;
+  }
   if (m_pStorage.isNull())
   {
     throw OdError(eFileAccessErr);
@@ -51,11 +56,15 @@ void ExFileUndoController::pushData(OdStreamBuf* pStream, OdUInt32 nSize, OdUInt
 
 bool ExFileUndoController::hasData() const
 {
+  if (!m_pStore.isNull())
+    return m_pStore->hasData();
   return !m_records.empty();
 }
 
 OdUInt32 ExFileUndoController::popData(OdStreamBuf* pStream)
 {
+  if (!m_pStore.isNull())
+    return m_pStore->pop(pStream);
   if(!hasData())
     throw OdError(eEndOfFile);
 
@@ -110,6 +119,8 @@ public:
 
 OdRxIteratorPtr ExFileUndoController::newRecordStackIterator() const
 {
+  if (!m_pStore.isNull())
+    return m_pStore->newRecordStackIterator();
   OdSmartPtr<ExFileUndoControllerIterator> pIter =
     OdRxObjectImpl<ExFileUndoControllerIterator>::createObject();
   pIter->m_iter = m_records.rbegin();
@@ -125,6 +136,8 @@ void ExFileUndoController::clearData()
     m_pStorage->rewind();
     m_pStorage->truncate();
   }
+  if (!m_pStore.isNull())
+    m_pStore->clear();
 }
 
 void ExFileUndoController::setStorage(OdStreamBufPtr pStorage)
@@ -138,3 +151,11 @@ void ExFileUndoController::setStorage(OdStreamBufPtr pStorage)
   m_pStorage = pStorage;
   clearData();
 }
+
+void ExFileUndoController::setRecordStore(ExUndoRecordStore* pStore)
+{
+  clearData();
+  m_pStore = pStore;
+  if (!m_pStore.isNull())
+    m_pStore->clear();
+}
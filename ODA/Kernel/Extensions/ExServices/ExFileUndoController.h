@@ -28,6 +28,7 @@
 #include "DbUndoController.h"
 #include "UInt8Array.h"
 #include "OdList.h"
+#include "ExUndoRecordStore.h"
 
 /** \details
 This class implements platform-independent UndoController objects.
@@ -45,6 +46,7 @@ public:
 private:
   OdList<UndoRecord> m_records;
   OdStreamBufPtr     m_pStorage;
+  ExUndoRecordStorePtr m_pStore;
 protected:
   ExFileUndoController();
 
@@ -75,6 +77,20 @@ public:
   void clearData();
 
   void setStorage(OdStreamBufPtr pStorage);
+
+  /** \details
+    Sets record store which keeps records of this UndoController object in compressed form
+    with memory budget. If store is null, records are kept by this UndoController object itself.
+    \param pStore [in]  Pointer to the record store.
+    \remarks
+    Clears existing records.
+  */
+  void setRecordStore(ExUndoRecordStore* pStore);
+
+  /** \details
+    Returns record store of this UndoController object, or null if store isn't set.
+  */
+  ExUndoRecordStorePtr recordStore() const { return m_pStore; }
 };
 
 /** \details
@@ -24,6 +24,8 @@
 #include "OdaCommon.h"
 #include "RxObjectImpl.h"
 #include "../ExServices/ExGiRasterImage.h"
+#include "../ExServices/ExGiTiledRasterImage.h"
+#include "DynamicLinker.h"
 #include "OdRound.h"
 
 // for ExRasterModule
@@ -1129,8 +1131,34 @@ inline OdGiRasterImagePtr embedFileName(const OdString &fileName, OdGiRasterImag
   return image;
 }
 
+OdGiRasterImagePtr ExRasterModule::loadTiledRasterImage(const OdString &fileName, const OdUInt32 *pFlagsChain)
+{
+  OdExGiRasterTileCachePtr pCache = static_cast<OdExGiRasterTileCache*>(m_pTileCache.get());
+  if (pCache.isNull())
+    m_pTileCache = pCache = OdExGiRasterTileCache::createObject();
+  if (::flagsChainContains(pFlagsChain, kTileCacheSize))
+    pCache->setBudget(OdUInt64(::flagsChainGetUInt(pFlagsChain, kTileCacheSize)) * 1024 * 1024);
+  // Uncompressed bitmaps are read region by region, other formats are decoded on first tile request
+  OdExGiRasterTileSourcePtr pSource = ::odExCreateBmpTileSource(fileName);
+  if (pSource.isNull())
+    pSource = ::odExCreateDeferredTileSource(this, fileName, pFlagsChain);
+  // Decode tiles in parallel only if application already loaded thread pool module
+  OdRxThreadPoolServicePtr pThreadPool = odrxDynamicLinker()->getModule(OdThreadPoolModuleName);
+  const OdUInt32 nTileSize = ::flagsChainGetUInt(pFlagsChain, kLoadTiled);
+  OdExGiTiledRasterImagePtr pImage = OdExGiTiledRasterImage::createObject(pSource, pCache, pThreadPool,
+                                       nTileSize ? nTileSize : (OdUInt32)OdExGiTiledRasterImage::kDefaultTileSize);
+  if (pImage.isNull())
+    return OdGiRasterImagePtr();
+  pImage->setImageSource(OdGiRasterImage::kFromFile);
+  pImage->setSourceFileName(fileName);
+  return pImage;
+}
+
 OdGiRasterImagePtr ExRasterModule::loadRasterImage(const OdString &fileName, const OdUInt32 *pFlagsChain)
 {
+  if (::flagsChainContains(pFlagsChain, kLoadTiled))
+    return loadTiledRasterImage(fileName, pFlagsChain);
+
   OdUInt32 preferFormat = (OdUInt32)kUnknown;
   if (::flagsChainContains(pFlagsChain, kLoadFmt))
     preferFormat = ::flagsChainGetUInt(pFlagsChain, kLoadFmt);
@@ -2419,6 +2447,7 @@ void ExRasterModule::initApp()
 */
 void ExRasterModule::uninitApp()
 {
+  m_pTileCache.release();
 #if defined(RASTER_FREE_IMAGE) && defined(FREEIMAGE_LIB)
   FreeImage_DeInitialise();
 #endif
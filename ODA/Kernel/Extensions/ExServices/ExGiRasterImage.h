@@ -381,6 +381,12 @@ public:
 */
 class ExRasterModule : public OdRxRasterServices
 {
+  OdRxObjectPtr m_pTileCache; // Tiles cache shared by all images loaded with kLoadTiled flag
+
+  /** \details
+      Creates lazily decoded tiled image for the specified file (see kLoadTiled flag).
+  */
+  OdGiRasterImagePtr loadTiledRasterImage(const OdString &filename, const OdUInt32 *pFlagsChain);
 public:
   /** \details
       Loads the specified Raster Image file.
@@ -0,0 +1,1109 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance").
+// All rights reserved.
+//
+// This software and its documentation and related materials are owned by
+// the Alliance. The software may only be incorporated into application
+// programs owned by members of the Alliance, subject to a signed
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable
+// trade secrets of the Alliance and its suppliers. The software is also
+// protected by copyright law and international treaty provisions. Application
+// programs incorporating this software must include the following statement
+// with their copyright notices:
+//
+//   This application incorporates Open Design Alliance software pursuant to a license
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance.
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OdaCommon.h"
+#include "RxObjectImpl.h"
+#include "StaticRxObject.h"
+#include "ExGiTiledRasterImage.h"
+#include "ExGiRasterImage.h"
+#include "RxRasterServices.h"
+#include "RxSystemServices.h"
+#include "OdPlatformStreamer.h"
+
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4100 ) //  unreferenced formal parameter
+#endif
+
+// Pixels helpers
+
+// Tiles and regions keep source pixel format, scanlines are padded to byte boundary only.
+static inline OdUInt32 odExPixelsPitch(OdUInt32 width, OdUInt32 nBitCount)
+{
+  return (width * nBitCount + 7) / 8;
+}
+
+static inline OdUInt32 odExGetIndex(const OdUInt8 *pRow, OdUInt32 x, OdUInt32 nBitCount)
+{
+  const OdUInt32 nPerByte = 8 / nBitCount;
+  return (pRow[x / nPerByte] >> ((nPerByte - 1 - x % nPerByte) * nBitCount)) & ((1 << nBitCount) - 1);
+}
+
+static inline void odExSetIndex(OdUInt8 *pRow, OdUInt32 x, OdUInt32 nBitCount, OdUInt32 nIndex)
+{
+  const OdUInt32 nPerByte = 8 / nBitCount, nShift = (nPerByte - 1 - x % nPerByte) * nBitCount;
+  OdUInt8 &nByte = pRow[x / nPerByte];
+  nByte = (OdUInt8)((nByte & ~(((1 << nBitCount) - 1) << nShift)) | (nIndex << nShift));
+}
+
+// Copies pixels between rows of the same format starting from arbitrary pixel positions.
+static void odExCopyPixels(const OdUInt8 *pSrc, OdUInt32 srcX, OdUInt8 *pDst, OdUInt32 dstX, OdUInt32 width, OdUInt32 nBitCount)
+{
+  if (nBitCount >= 8)
+  {
+    const OdUInt32 nBytes = nBitCount / 8;
+    ::memcpy(pDst + dstX * nBytes, pSrc + srcX * nBytes, width * nBytes);
+  }
+  else
+  {
+    OdUInt32 n = 0;
+    if (!((srcX * nBitCount) & 7) && !((dstX * nBitCount) & 7))
+    { // Byte aligned part is copied at once
+      const OdUInt32 nFullBytes = (width * nBitCount) / 8;
+      ::memcpy(pDst + (dstX * nBitCount) / 8, pSrc + (srcX * nBitCount) / 8, nFullBytes);
+      n = (nFullBytes * 8) / nBitCount;
+    }
+    for (; n < width; n++)
+      ::odExSetIndex(pDst, dstX + n, nBitCount, ::odExGetIndex(pSrc, srcX + n, nBitCount));
+  }
+}
+
+static inline OdUInt8 odExExpandChannel(OdUInt32 nVal, OdUInt8 nBits)
+{
+  if (!nBits)
+    return 0;
+  if (nBits >= 8)
+    return (OdUInt8)(nVal >> (nBits - 8));
+  return (OdUInt8)((nVal * 255) / ((1 << nBits) - 1));
+}
+
+// Converts part of scanline of any OdGiRasterImage format into BGR (nDstBytes is 3) or BGRA (nDstBytes is 4).
+static void odExConvertRowToBGRA(OdUInt32 bpp, const OdGiRasterImage::PixelFormatInfo &pf,
+                                 const OdUInt32 *pPalette, const OdUInt8 *pRow, OdUInt32 x, OdUInt32 width,
+                                 OdUInt8 *pDst, OdUInt32 nDstBytes)
+{
+  if (bpp <= 8)
+  {
+    for (OdUInt32 n = 0; n < width; n++, pDst += nDstBytes)
+    {
+      const OdUInt32 clr = pPalette[::odExGetIndex(pRow, x + n, bpp)];
+      pDst[0] = ODGETBLUE(clr); pDst[1] = ODGETGREEN(clr); pDst[2] = ODGETRED(clr);
+      if (nDstBytes > 3)
+        pDst[3] = 255;
+    }
+  }
+  else
+  {
+    const OdUInt32 nBytes = bpp / 8;
+    pRow += x * nBytes;
+    for (OdUInt32 n = 0; n < width; n++, pDst += nDstBytes, pRow += nBytes)
+    {
+      OdUInt32 nPixel = 0;
+      for (OdUInt32 nByte = 0; nByte < nBytes; nByte++)
+        nPixel |= OdUInt32(pRow[nByte]) << (nByte * 8);
+      pDst[0] = odExExpandChannel((nPixel >> pf.blueOffset) & OdGiRasterImage::calcColorMask(pf.numBlueBits), pf.numBlueBits);
+      pDst[1] = odExExpandChannel((nPixel >> pf.greenOffset) & OdGiRasterImage::calcColorMask(pf.numGreenBits), pf.numGreenBits);
+      pDst[2] = odExExpandChannel((nPixel >> pf.redOffset) & OdGiRasterImage::calcColorMask(pf.numRedBits), pf.numRedBits);
+      if (nDstBytes > 3)
+        pDst[3] = (pf.numAlphaBits) ? odExExpandChannel((nPixel >> pf.alphaOffset) & OdGiRasterImage::calcColorMask(pf.numAlphaBits), pf.numAlphaBits) : 255;
+    }
+  }
+}
+
+// Builds scanline of next mip level from two scanlines of previous one. True color pixels are
+// averaged by box filter, indexed pixels can't be averaged, so every second pixel is taken.
+static void odExDownsampleRow(const OdUInt8 *pRow0, const OdUInt8 *pRow1, OdUInt32 srcWidth,
+                              OdUInt8 *pDst, OdUInt32 dstWidth, OdUInt32 nBitCount)
+{
+  if (nBitCount >= 24)
+  {
+    const OdUInt32 nBytes = nBitCount / 8;
+    for (OdUInt32 x = 0; x < dstWidth; x++, pDst += nBytes)
+    {
+      const OdUInt32 x0 = x * 2 * nBytes, x1 = (x * 2 + 1 < srcWidth) ? (x0 + nBytes) : x0;
+      for (OdUInt32 c = 0; c < nBytes; c++)
+        pDst[c] = (OdUInt8)((OdUInt32(pRow0[x0 + c]) + pRow0[x1 + c] + pRow1[x0 + c] + pRow1[x1 + c] + 2) >> 2);
+    }
+  }
+  else if (nBitCount == 8)
+  {
+    for (OdUInt32 x = 0; x < dstWidth; x++)
+      pDst[x] = pRow0[x * 2];
+  }
+  else
+  {
+    for (OdUInt32 x = 0; x < dstWidth; x++)
+      ::odExSetIndex(pDst, x, nBitCount, ::odExGetIndex(pRow0, x * 2, nBitCount));
+  }
+}
+
+static void odExDownsample(const OdUInt8 *pSrc, OdUInt32 srcWidth, OdUInt32 srcHeight,
+                           OdUInt8 *pDst, OdUInt32 dstWidth, OdUInt32 dstHeight, OdUInt32 nBitCount)
+{
+  const OdUInt32 srcPitch = ::odExPixelsPitch(srcWidth, nBitCount), dstPitch = ::odExPixelsPitch(dstWidth, nBitCount);
+  for (OdUInt32 y = 0; y < dstHeight; y++, pDst += dstPitch)
+  {
+    const OdUInt8 *pRow0 = pSrc + (y * 2) * srcPitch;
+    const OdUInt8 *pRow1 = (y * 2 + 1 < srcHeight) ? (pRow0 + srcPitch) : pRow0;
+    ::odExDownsampleRow(pRow0, pRow1, srcWidth, pDst, dstWidth, nBitCount);
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+// Tile sources
+
+// Reads uncompressed BMP files scanline by scanline.
+class OdExGiBmpTileSource : public OdExGiRasterTileSource
+{
+  OdString       m_fileName;
+  OdStreamBufPtr m_pStream;
+  OdMutex        m_mutex;
+  Info           m_info;
+  OdUInt32       m_nOffBits;
+  OdUInt32       m_nBitCount;
+  OdUInt32       m_nPitch;
+  bool           m_bTopDown;
+  OdUInt32Array  m_palette;
+
+  OdStreamBuf *stream()
+  {
+    if (m_pStream.isNull())
+      m_pStream = odrxSystemServices()->createFile(m_fileName, Oda::kFileRead, Oda::kShareDenyWrite, Oda::kOpenExisting);
+    return m_pStream;
+  }
+public:
+  OdExGiBmpTileSource() : m_nOffBits(0), m_nBitCount(0), m_nPitch(0), m_bTopDown(false) { }
+
+  bool init(const OdString &fileName)
+  {
+    m_fileName = fileName;
+    OdStreamBuf *pBuf = stream();
+    if (OdPlatformStreamer::rdInt16(*pBuf) != 19778) // 'BM'
+      return false;
+    OdPlatformStreamer::rdInt32(*pBuf);                 // bfSize
+    OdPlatformStreamer::rdInt32(*pBuf);                 // bfReserved1, bfReserved2
+    m_nOffBits = (OdUInt32)OdPlatformStreamer::rdInt32(*pBuf);
+    const OdUInt32 nHdrSize = (OdUInt32)OdPlatformStreamer::rdInt32(*pBuf);
+    if (nHdrSize < 40)
+      return false; // OS/2 headers are processed by generic loader
+    const OdInt32 width = OdPlatformStreamer::rdInt32(*pBuf);
+    const OdInt32 height = OdPlatformStreamer::rdInt32(*pBuf);
+    OdPlatformStreamer::rdInt16(*pBuf);                 // biPlanes
+    m_nBitCount = (OdUInt16)OdPlatformStreamer::rdInt16(*pBuf);
+    const OdUInt32 nCompression = (OdUInt32)OdPlatformStreamer::rdInt32(*pBuf);
+    OdPlatformStreamer::rdInt32(*pBuf);                 // biSizeImage
+    const OdInt32 xPelsPerMeter = OdPlatformStreamer::rdInt32(*pBuf);
+    const OdInt32 yPelsPerMeter = OdPlatformStreamer::rdInt32(*pBuf);
+    OdUInt32 nClrUsed = (OdUInt32)OdPlatformStreamer::rdInt32(*pBuf);
+    if (width <= 0 || !height)
+      return false;
+    if (m_nBitCount != 1 && m_nBitCount != 4 && m_nBitCount != 8 && m_nBitCount != 24 && m_nBitCount != 32)
+      return false;
+    bool bHasAlpha = false;
+    if (nCompression == 3L || nCompression == 6L) // BI_BITFIELDS, BI_ALPHABITFIELDS
+    {
+      if (m_nBitCount != 32)
+        return false;
+      // Masks follow BITMAPINFOHEADER or are part of extended header. Alpha mask is present
+      // only in BITMAPV3INFOHEADER and later headers, or for BI_ALPHABITFIELDS.
+      const OdUInt32 nRedMask = (OdUInt32)OdPlatformStreamer::rdInt32(*pBuf);
+      const OdUInt32 nGreenMask = (OdUInt32)OdPlatformStreamer::rdInt32(*pBuf);
+      const OdUInt32 nBlueMask = (OdUInt32)OdPlatformStreamer::rdInt32(*pBuf);
+      const OdUInt32 nAlphaMask = (nHdrSize >= 56 || nCompression == 6L) ? (OdUInt32)OdPlatformStreamer::rdInt32(*pBuf) : 0;
+      // Only layouts which match BGRA tiles are read directly
+      if (nRedMask != 0x00FF0000 || nGreenMask != 0x0000FF00 || nBlueMask != 0x000000FF ||
+          (nAlphaMask != 0 && nAlphaMask != 0xFF000000))
+        return false;
+      bHasAlpha = nAlphaMask != 0;
+    }
+    else if (nCompression != 0L)
+      return false; // RLE images are processed by generic loader
+    m_info.m_width = (OdUInt32)width;
+    m_info.m_height = (OdUInt32)((height < 0) ? -height : height);
+    m_info.m_resUnits = OdGiRasterImage::kMeter;
+    m_info.m_xPelsPerUnit = xPelsPerMeter;
+    m_info.m_yPelsPerUnit = yPelsPerMeter;
+    m_info.m_bHasAlpha = bHasAlpha; // BI_RGB images keep unused fourth byte
+    m_info.m_nBitCount = m_nBitCount;
+    m_bTopDown = height < 0;
+    m_nPitch = OdGiRasterImage::calcBMPScanLineSize(m_info.m_width, m_nBitCount);
+    if (m_nBitCount <= 8)
+    {
+      if (!nClrUsed)
+        nClrUsed = 1 << m_nBitCount;
+      pBuf->seek(14 + nHdrSize, OdDb::kSeekFromStart);
+      m_palette.resize(1 << m_nBitCount, 0);
+      for (OdUInt32 nColor = 0; nColor < nClrUsed && nColor < m_palette.size(); nColor++)
+      {
+        OdUInt8 rgbq[4];
+        pBuf->getBytes(rgbq, 4);
+        m_palette[nColor] = ODRGB(rgbq[2], rgbq[1], rgbq[0]);
+      }
+      m_info.m_palette = m_palette;
+    }
+    // Stream is reopened on first tile request
+    m_pStream.release();
+    return true;
+  }
+
+  bool imageInfo(Info &info)
+  {
+    info = m_info;
+    return m_info.m_width != 0;
+  }
+
+  bool decodeRegion(OdUInt32 level, OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height, OdUInt8 *pDst)
+  {
+    if (level)
+      return false;
+    const OdUInt32 nFirstByte = (x * m_nBitCount) / 8;
+    const OdUInt32 nLastByte = ((x + width) * m_nBitCount + 7) / 8;
+    const OdUInt32 xInByte = x - (nFirstByte * 8) / m_nBitCount;
+    const OdUInt32 nDstPitch = ::odExPixelsPitch(width, m_nBitCount);
+    OdUInt8Array row; row.resize(nLastByte - nFirstByte);
+    TD_AUTOLOCK(m_mutex);
+    OdStreamBuf *pBuf = stream();
+    for (OdUInt32 nRow = 0; nRow < height; nRow++, pDst += nDstPitch)
+    {
+      const OdUInt32 nFileRow = m_bTopDown ? (m_info.m_height - 1 - (y + nRow)) : (y + nRow);
+      pBuf->seek(OdUInt64(m_nOffBits) + OdUInt64(nFileRow) * m_nPitch + nFirstByte, OdDb::kSeekFromStart);
+      pBuf->getBytes(row.asArrayPtr(), row.size());
+      ::odExCopyPixels(row.getPtr(), xInByte, pDst, 0, width, m_nBitCount);
+    }
+    return true;
+  }
+
+  void releaseResources()
+  {
+    TD_AUTOLOCK(m_mutex);
+    m_pStream.release();
+  }
+};
+
+OdExGiRasterTileSourcePtr odExCreateBmpTileSource(const OdString &fileName)
+{
+  OdSmartPtr<OdExGiBmpTileSource> pSource = OdRxObjectImpl<OdExGiBmpTileSource>::createObject();
+  try
+  {
+    if (pSource->init(fileName))
+      return pSource;
+  }
+  catch (const OdError&)
+  {
+  }
+  return OdExGiRasterTileSourcePtr();
+}
+
+// Reads regions from decoded raster image.
+class OdExGiImageTileSource : public OdExGiRasterTileSource
+{
+protected:
+  OdMutex            m_mutex;
+  OdGiRasterImagePtr m_pImage;
+  OdUInt32Array      m_palette;
+  Info               m_info;
+  bool               m_bConvert; // Source pixel format isn't kept by tiles
+
+  virtual const OdGiRasterImage *image()
+  {
+    return m_pImage;
+  }
+public:
+  OdExGiImageTileSource() : m_bConvert(false) { }
+
+  void setImage(const OdGiRasterImage *pImage)
+  {
+    m_pImage = pImage;
+    if (pImage)
+    {
+      m_info.m_width = pImage->pixelWidth();
+      m_info.m_height = pImage->pixelHeight();
+      m_info.m_resUnits = pImage->defaultResolution(m_info.m_xPelsPerUnit, m_info.m_yPelsPerUnit);
+      m_info.m_bHasAlpha = (pImage->colorDepth() == 32) && (pImage->transparencyMode() != OdGiRasterImage::kTransparencyOff);
+      m_palette.resize(pImage->numColors());
+      for (OdUInt32 nColor = 0; nColor < m_palette.size(); nColor++)
+        m_palette[nColor] = pImage->color(nColor);
+      const OdUInt32 nDepth = pImage->colorDepth();
+      const OdGiRasterImage::PixelFormatInfo pf = pImage->pixelFormat();
+      if (nDepth <= 8)
+        m_palette.resize(1 << nDepth, 0);
+      m_info.m_palette.clear();
+      m_bConvert = false;
+      if ((nDepth == 1 || nDepth == 4 || nDepth == 8) && pImage->numColors())
+        m_info.m_palette = m_palette;
+      else if (!(nDepth == 24 && pf.isBGR()) && !(nDepth == 32 && pf.isBGRA()))
+        m_bConvert = true;
+      // Formats which can't be kept as is are expanded to nearest true color format
+      m_info.m_nBitCount = (!m_bConvert) ? nDepth : ((pf.numAlphaBits && nDepth > 8) ? 32 : 24);
+    }
+  }
+
+  bool imageInfo(Info &info)
+  {
+    info = m_info;
+    return m_info.m_width != 0;
+  }
+
+  bool decodeRegion(OdUInt32 level, OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height, OdUInt8 *pDst)
+  {
+    if (level)
+      return false;
+    const OdGiRasterImage *pImage = image();
+    if (!pImage)
+      return false;
+    const OdGiRasterImage::PixelFormatInfo pf = pImage->pixelFormat();
+    const OdUInt32 nScanSize = pImage->scanLineSize();
+    const OdUInt8 *pBits = pImage->scanLines();
+    const OdUInt32 nDepth = pImage->colorDepth(), nDstPitch = ::odExPixelsPitch(width, m_info.m_nBitCount);
+    OdUInt8Array row;
+    if (!pBits)
+      row.resize(nScanSize);
+    for (OdUInt32 nRow = 0; nRow < height; nRow++, pDst += nDstPitch)
+    {
+      const OdUInt8 *pRow;
+      if (pBits)
+        pRow = pBits + OdUInt64(y + nRow) * nScanSize;
+      else
+      {
+        pImage->scanLines(row.asArrayPtr(), y + nRow, 1);
+        pRow = row.getPtr();
+      }
+      if (m_bConvert)
+        ::odExConvertRowToBGRA(nDepth, pf, m_palette.getPtr(), pRow, x, width, pDst, m_info.m_nBitCount / 8);
+      else
+        ::odExCopyPixels(pRow, x, pDst, 0, width, nDepth);
+    }
+    return true;
+  }
+};
+
+OdExGiRasterTileSourcePtr odExCreateImageTileSource(const OdGiRasterImage *pImage)
+{
+  OdSmartPtr<OdExGiImageTileSource> pSource = OdRxObjectImpl<OdExGiImageTileSource>::createObject();
+  pSource->setImage(pImage);
+  return pSource;
+}
+
+// Decodes image through raster services on first access. Only full resolution regions can be
+// decoded, and only by decoding the whole image. The decoded image is kept while full resolution
+// tiles are requested and dropped by releaseResources() as soon as overview levels are built.
+class OdExGiDeferredTileSource : public OdExGiImageTileSource
+{
+  OdRxRasterServicesPtr m_pRasSvcs;
+  OdString              m_fileName;
+  OdUInt32Array         m_flags;
+  bool                  m_bInfoValid;
+
+  void load()
+  {
+    OdGiRasterImagePtr pImage = m_pRasSvcs->loadRasterImage(m_fileName, m_flags.isEmpty() ? NULL : m_flags.getPtr());
+    setImage(pImage);
+    m_bInfoValid = !pImage.isNull();
+  }
+protected:
+  const OdGiRasterImage *image()
+  {
+    TD_AUTOLOCK(m_mutex);
+    if (m_pImage.isNull())
+      load();
+    return m_pImage;
+  }
+public:
+  OdExGiDeferredTileSource() : m_bInfoValid(false) { }
+
+  void init(OdRxRasterServices *pRasSvcs, const OdString &fileName, const OdUInt32 *pFlagsChain)
+  {
+    m_pRasSvcs = pRasSvcs;
+    m_fileName = fileName;
+    if (pFlagsChain)
+    {
+      for (; *pFlagsChain; pFlagsChain += 2)
+      {
+        if (*pFlagsChain == OdRxRasterServices::kLoadTiled || *pFlagsChain == OdRxRasterServices::kTileCacheSize)
+          continue;
+        m_flags.append(pFlagsChain[0]);
+        m_flags.append(pFlagsChain[1]);
+      }
+      if (!m_flags.isEmpty())
+        m_flags.append(0);
+    }
+  }
+
+  bool imageInfo(Info &info)
+  {
+    TD_AUTOLOCK(m_mutex);
+    if (!m_bInfoValid)
+      load();
+    info = m_info;
+    return m_bInfoValid;
+  }
+
+  bool decodeRegion(OdUInt32 level, OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height, OdUInt8 *pDst)
+  {
+    if (level)
+      return false;
+    OdGiRasterImagePtr pImage;
+    { // Keep image alive while decoding even if released concurrently
+      TD_AUTOLOCK(m_mutex);
+      if (m_pImage.isNull())
+        load();
+      pImage = m_pImage;
+    }
+    if (pImage.isNull())
+      return false;
+    return OdExGiImageTileSource::decodeRegion(level, x, y, width, height, pDst);
+  }
+
+  bool isRegionDecoder() const
+  {
+    return false;
+  }
+
+  void releaseResources()
+  {
+    TD_AUTOLOCK(m_mutex);
+    m_pImage.release();
+  }
+};
+
+OdExGiRasterTileSourcePtr odExCreateDeferredTileSource(OdRxRasterServices *pRasSvcs, const OdString &fileName, const OdUInt32 *pFlagsChain)
+{
+  OdSmartPtr<OdExGiDeferredTileSource> pSource = OdRxObjectImpl<OdExGiDeferredTileSource>::createObject();
+  pSource->init(pRasSvcs, fileName, pFlagsChain);
+  return pSource;
+}
+
+///////////////////////////////////////////////////////////////////
+// OdExGiRasterTileCache
+
+OdExGiRasterTileCache::OdExGiRasterTileCache()
+  : m_nBudget(OdUInt64(256) * 1024 * 1024)
+  , m_nImageIdSeed(0)
+{
+}
+
+OdExGiRasterTileCachePtr OdExGiRasterTileCache::createObject(OdUInt64 nBudget)
+{
+  OdExGiRasterTileCachePtr pCache = OdRxObjectImpl<OdExGiRasterTileCache>::createObject();
+  pCache->m_nBudget = nBudget;
+  return pCache;
+}
+
+void OdExGiRasterTileCache::evictExtra(OdUInt64 nReserve)
+{
+  while (!m_lru.empty() && (m_stats.m_nBytesUsed + nReserve > m_nBudget))
+  {
+    TileMap::iterator it = m_tiles.find(m_lru.back());
+    ODA_ASSERT(it != m_tiles.end());
+    m_stats.m_nBytesUsed -= it->second.m_pixels.size();
+    m_stats.m_nEvictions++;
+    m_tiles.erase(it);
+    m_lru.pop_back();
+  }
+  m_stats.m_nTiles = (OdUInt32)m_tiles.size();
+}
+
+void OdExGiRasterTileCache::setBudget(OdUInt64 nBudget)
+{
+  TD_AUTOLOCK(m_mutex);
+  m_nBudget = nBudget;
+  evictExtra(0);
+}
+
+OdUInt64 OdExGiRasterTileCache::budget() const
+{
+  TD_AUTOLOCK(m_mutex);
+  return m_nBudget;
+}
+
+OdExGiRasterTileCache::Stats OdExGiRasterTileCache::stats() const
+{
+  TD_AUTOLOCK(m_mutex);
+  return m_stats;
+}
+
+OdUInt32 OdExGiRasterTileCache::registerImage()
+{
+  TD_AUTOLOCK(m_mutex);
+  return ++m_nImageIdSeed;
+}
+
+void OdExGiRasterTileCache::purgeImage(OdUInt32 nImage)
+{
+  TD_AUTOLOCK(m_mutex);
+  TileKey key = { nImage, 0, 0, 0 };
+  TileMap::iterator it = m_tiles.lower_bound(key);
+  while (it != m_tiles.end() && it->first.m_nImage == nImage)
+  {
+    m_stats.m_nBytesUsed -= it->second.m_pixels.size();
+    m_lru.erase(it->second.m_lruPos);
+    m_tiles.erase(it++);
+  }
+  m_stats.m_nTiles = (OdUInt32)m_tiles.size();
+}
+
+bool OdExGiRasterTileCache::copyTileRows(OdUInt32 nImage, OdUInt32 nLevel, OdUInt32 tileX, OdUInt32 tileY,
+                                         OdUInt32 firstRow, OdUInt32 numRows, OdUInt32 firstCol, OdUInt32 numCols,
+                                         OdUInt8 *pDst, OdUInt32 dstPitch, OdUInt32 dstCol)
+{
+  TD_AUTOLOCK(m_mutex);
+  TileKey key = { nImage, nLevel, tileX, tileY };
+  TileMap::iterator it = m_tiles.find(key);
+  if (it == m_tiles.end())
+  {
+    m_stats.m_nMisses++;
+    return false;
+  }
+  m_stats.m_nHits++;
+  m_lru.splice(m_lru.begin(), m_lru, it->second.m_lruPos);
+  const TileEntry &entry = it->second;
+  ODA_ASSERT(firstRow + numRows <= entry.m_height && firstCol + numCols <= entry.m_width);
+  const OdUInt32 nPitch = ::odExPixelsPitch(entry.m_width, entry.m_nBitCount);
+  const OdUInt8 *pSrc = entry.m_pixels.getPtr() + firstRow * nPitch;
+  for (OdUInt32 nRow = 0; nRow < numRows; nRow++, pSrc += nPitch, pDst += dstPitch)
+    ::odExCopyPixels(pSrc, firstCol, pDst, dstCol, numCols, entry.m_nBitCount);
+  return true;
+}
+
+bool OdExGiRasterTileCache::hasTile(OdUInt32 nImage, OdUInt32 nLevel, OdUInt32 tileX, OdUInt32 tileY) const
+{
+  TD_AUTOLOCK(m_mutex);
+  TileKey key = { nImage, nLevel, tileX, tileY };
+  return m_tiles.find(key) != m_tiles.end();
+}
+
+void OdExGiRasterTileCache::putTile(OdUInt32 nImage, OdUInt32 nLevel, OdUInt32 tileX, OdUInt32 tileY,
+                                    OdUInt32 width, OdUInt32 height, OdUInt32 nBitCount, OdUInt8Array &pixels)
+{
+  TD_AUTOLOCK(m_mutex);
+  TileKey key = { nImage, nLevel, tileX, tileY };
+  if (m_tiles.find(key) != m_tiles.end())
+    return; // Already decoded by concurrent thread
+  evictExtra(pixels.size());
+  TileEntry &entry = m_tiles[key];
+  entry.m_pixels.swap(pixels);
+  entry.m_width = width;
+  entry.m_height = height;
+  entry.m_nBitCount = nBitCount;
+  m_lru.push_front(key);
+  entry.m_lruPos = m_lru.begin();
+  m_stats.m_nBytesUsed += entry.m_pixels.size();
+  if (m_stats.m_nBytesUsed > m_stats.m_nBytesPeak)
+    m_stats.m_nBytesPeak = m_stats.m_nBytesUsed;
+  m_stats.m_nTiles = (OdUInt32)m_tiles.size();
+}
+
+///////////////////////////////////////////////////////////////////
+// OdExGiTiledRasterImageShared - state shared between all levels of the image
+
+class OdExGiTiledRasterImageShared : public OdRxObject
+{
+public:
+  OdExGiRasterTileSourcePtr    m_pSource;
+  OdExGiRasterTileCachePtr     m_pCache;
+  OdRxThreadPoolServicePtr     m_pThreadPool;
+  OdExGiRasterTileSource::Info m_info;
+  OdUInt32                     m_nImage;
+  OdUInt32                     m_nTileSize;
+  OdUInt32                     m_nLevels;
+  OdMutex                      m_overviewMutex;
+
+  OdExGiTiledRasterImageShared() : m_nImage(0), m_nTileSize(0), m_nLevels(1) { }
+  ~OdExGiTiledRasterImageShared()
+  {
+    if (!m_pCache.isNull())
+      m_pCache->purgeImage(m_nImage);
+    if (!m_pSource.isNull())
+      m_pSource->releaseResources();
+  }
+
+  OdUInt32 levelWidth(OdUInt32 nLevel) const
+  {
+    return odmax(OdUInt32(1), (m_info.m_width + (1 << nLevel) - 1) >> nLevel);
+  }
+  OdUInt32 levelHeight(OdUInt32 nLevel) const
+  {
+    return odmax(OdUInt32(1), (m_info.m_height + (1 << nLevel) - 1) >> nLevel);
+  }
+  OdUInt32 numTilesX(OdUInt32 nLevel) const
+  {
+    return (levelWidth(nLevel) + m_nTileSize - 1) / m_nTileSize;
+  }
+  OdUInt32 numTilesY(OdUInt32 nLevel) const
+  {
+    return (levelHeight(nLevel) + m_nTileSize - 1) / m_nTileSize;
+  }
+
+  OdUInt32 pitch(OdUInt32 width) const
+  {
+    return ::odExPixelsPitch(width, m_info.m_nBitCount);
+  }
+
+  void readRegion(OdUInt32 nLevel, OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height, OdUInt8 *pDst, OdUInt32 dstPitch,
+                  bool bParallel = true);
+
+  // Cuts whole mip level into tiles and places them into the cache. Requested tile is returned as well,
+  // since cache budget could evict it while the rest of tiles are placed.
+  void putLevelTiles(OdUInt32 nCurLevel, const OdUInt8Array &levelPixels,
+                     OdUInt32 nLevel, OdUInt32 tileX, OdUInt32 tileY, OdUInt8Array &pixels)
+  {
+    const OdUInt32 levelPitch = pitch(levelWidth(nCurLevel));
+    for (OdUInt32 curTileY = 0; curTileY < numTilesY(nCurLevel); curTileY++)
+    {
+      for (OdUInt32 curTileX = 0; curTileX < numTilesX(nCurLevel); curTileX++)
+      {
+        const OdUInt32 x = curTileX * m_nTileSize, y = curTileY * m_nTileSize;
+        const OdUInt32 width = odmin(m_nTileSize, levelWidth(nCurLevel) - x);
+        const OdUInt32 height = odmin(m_nTileSize, levelHeight(nCurLevel) - y);
+        const OdUInt32 tilePitch = pitch(width);
+        OdUInt8Array tile; tile.resize(tilePitch * height);
+        for (OdUInt32 nRow = 0; nRow < height; nRow++)
+          ::odExCopyPixels(levelPixels.getPtr() + (y + nRow) * levelPitch, x, tile.asArrayPtr() + nRow * tilePitch, 0, width, m_info.m_nBitCount);
+        if ((nCurLevel == nLevel) && (curTileX == tileX) && (curTileY == tileY))
+          pixels = tile;
+        m_pCache->putTile(m_nImage, nCurLevel, curTileX, curTileY, width, height, m_info.m_nBitCount, tile);
+      }
+    }
+  }
+
+  // Sources which can't decode regions are decoded once, and all overview levels are built directly from
+  // the decoded image, which is released right after. So zoomed out views never decode full resolution
+  // tiles and never pass them through the cache.
+  void buildOverviews(OdUInt32 nLevel, OdUInt32 tileX, OdUInt32 tileY, OdUInt8Array &pixels)
+  {
+    TD_AUTOLOCK(m_overviewMutex);
+    const OdUInt32 tileWidth = odmin(m_nTileSize, levelWidth(nLevel) - tileX * m_nTileSize);
+    const OdUInt32 tileHeight = odmin(m_nTileSize, levelHeight(nLevel) - tileY * m_nTileSize);
+    // Could be built by concurrent thread already
+    if (m_pCache->copyTileRows(m_nImage, nLevel, tileX, tileY, 0, tileHeight, 0, tileWidth, pixels.asArrayPtr(), pitch(tileWidth)))
+      return;
+    OdUInt8Array levelPixels;
+    { // First overview level is built from pairs of full resolution scanlines
+      const OdUInt32 srcWidth = levelWidth(0), srcHeight = levelHeight(0), srcPitch = pitch(srcWidth);
+      const OdUInt32 dstWidth = levelWidth(1), dstHeight = levelHeight(1), dstPitch = pitch(dstWidth);
+      OdUInt8Array rows; rows.resize(srcPitch * 2);
+      levelPixels.resize(dstPitch * dstHeight, 0);
+      for (OdUInt32 y = 0; y < dstHeight; y++)
+      {
+        const OdUInt32 nRows = odmin(OdUInt32(2), srcHeight - y * 2);
+        if (!m_pSource->decodeRegion(0, 0, y * 2, srcWidth, nRows, rows.asArrayPtr()))
+          throw OdError(eInvalidInput);
+        ::odExDownsampleRow(rows.getPtr(), rows.getPtr() + ((nRows > 1) ? srcPitch : 0), srcWidth,
+                            levelPixels.asArrayPtr() + y * dstPitch, dstWidth, m_info.m_nBitCount);
+      }
+    }
+    m_pSource->releaseResources();
+    for (OdUInt32 nCurLevel = 1; nCurLevel < m_nLevels; nCurLevel++)
+    {
+      putLevelTiles(nCurLevel, levelPixels, nLevel, tileX, tileY, pixels);
+      if (nCurLevel + 1 < m_nLevels)
+      {
+        const OdUInt32 nextWidth = levelWidth(nCurLevel + 1), nextHeight = levelHeight(nCurLevel + 1);
+        OdUInt8Array nextPixels; nextPixels.resize(pitch(nextWidth) * nextHeight, 0);
+        ::odExDownsample(levelPixels.getPtr(), levelWidth(nCurLevel), levelHeight(nCurLevel),
+                         nextPixels.asArrayPtr(), nextWidth, nextHeight, m_info.m_nBitCount);
+        levelPixels.swap(nextPixels);
+      }
+    }
+  }
+
+  void decodeTile(OdUInt32 nLevel, OdUInt32 tileX, OdUInt32 tileY, OdUInt8Array &pixels, OdUInt32 &width, OdUInt32 &height)
+  {
+    const OdUInt32 x = tileX * m_nTileSize, y = tileY * m_nTileSize;
+    width = odmin(m_nTileSize, levelWidth(nLevel) - x);
+    height = odmin(m_nTileSize, levelHeight(nLevel) - y);
+    pixels.resize(pitch(width) * height, 0);
+    if (m_pSource->decodeRegion(nLevel, x, y, width, height, pixels.asArrayPtr()))
+      return;
+    if (!nLevel)
+      throw OdError(eInvalidInput);
+    if (!m_pSource->isRegionDecoder())
+    {
+      buildOverviews(nLevel, tileX, tileY, pixels);
+      return;
+    }
+    // Build from previous level
+    const OdUInt32 srcX = x * 2, srcY = y * 2;
+    const OdUInt32 srcWidth = odmin(width * 2, levelWidth(nLevel - 1) - srcX);
+    const OdUInt32 srcHeight = odmin(height * 2, levelHeight(nLevel - 1) - srcY);
+    OdUInt8Array srcPixels; srcPixels.resize(pitch(srcWidth) * srcHeight);
+    // Could be called from worker thread already, so previous level is decoded sequentially
+    readRegion(nLevel - 1, srcX, srcY, srcWidth, srcHeight, srcPixels.asArrayPtr(), pitch(srcWidth), false);
+    ::odExDownsample(srcPixels.getPtr(), srcWidth, srcHeight, pixels.asArrayPtr(), width, height, m_info.m_nBitCount);
+  }
+
+  void decodeAndPutTile(OdUInt32 nLevel, OdUInt32 tileX, OdUInt32 tileY)
+  {
+    OdUInt8Array pixels; OdUInt32 width, height;
+    decodeTile(nLevel, tileX, tileY, pixels, width, height);
+    m_pCache->putTile(m_nImage, nLevel, tileX, tileY, width, height, m_info.m_nBitCount, pixels);
+  }
+
+  void ensureTiles(OdUInt32 nLevel, OdUInt32 firstTileX, OdUInt32 firstTileY, OdUInt32 lastTileX, OdUInt32 lastTileY, bool bParallel);
+};
+
+// Decodes tiles in worker threads
+class OdExGiTileDecodeAtom : public OdApcAtom
+{
+public:
+  OdExGiTiledRasterImageShared *m_pShared;
+  OdUInt32                      m_nLevel;
+  const OdUInt32Array          *m_pTiles; // Pairs of tile indexes
+
+  void apcEntryPoint(OdApcParamType nTile)
+  {
+    m_pShared->decodeAndPutTile(m_nLevel, (*m_pTiles)[nTile * 2], (*m_pTiles)[nTile * 2 + 1]);
+  }
+};
+
+void OdExGiTiledRasterImageShared::ensureTiles(OdUInt32 nLevel, OdUInt32 firstTileX, OdUInt32 firstTileY,
+                                               OdUInt32 lastTileX, OdUInt32 lastTileY, bool bParallel)
+{
+  OdUInt32Array missing;
+  for (OdUInt32 tileY = firstTileY; tileY <= lastTileY; tileY++)
+  {
+    for (OdUInt32 tileX = firstTileX; tileX <= lastTileX; tileX++)
+    {
+      if (!m_pCache->hasTile(m_nImage, nLevel, tileX, tileY))
+        missing.append(tileX), missing.append(tileY);
+    }
+  }
+  const OdUInt32 nMissing = missing.size() / 2;
+  if (!nMissing)
+    return;
+  if (bParallel && (nMissing > 1) && !m_pThreadPool.isNull())
+  {
+    OdApcQueuePtr pQueue = m_pThreadPool->newMTQueue(ThreadsCounter::kNoAttributes, 0, kMtQueueAllowExecByMain);
+    OdStaticRxObject<OdExGiTileDecodeAtom> atom;
+    atom.m_pShared = this;
+    atom.m_nLevel = nLevel;
+    atom.m_pTiles = &missing;
+    for (OdUInt32 nTile = 0; nTile < nMissing; nTile++)
+      pQueue->addEntryPoint(&atom, (OdApcParamType)nTile);
+    pQueue->wait();
+  }
+  else
+  {
+    for (OdUInt32 nTile = 0; nTile < nMissing; nTile++)
+      decodeAndPutTile(nLevel, missing[nTile * 2], missing[nTile * 2 + 1]);
+  }
+}
+
+void OdExGiTiledRasterImageShared::readRegion(OdUInt32 nLevel, OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height,
+                                              OdUInt8 *pDst, OdUInt32 dstPitch, bool bParallel)
+{
+  if (!width || !height)
+    return;
+  const OdUInt32 firstTileX = x / m_nTileSize, lastTileX = (x + width - 1) / m_nTileSize;
+  const OdUInt32 firstTileY = y / m_nTileSize, lastTileY = (y + height - 1) / m_nTileSize;
+  // Decode missing tiles in parallel at once. Budget may still evict some of them before they
+  // will be copied, so copying loop falls back to synchronous decoding.
+  ensureTiles(nLevel, firstTileX, firstTileY, lastTileX, lastTileY, bParallel);
+  for (OdUInt32 tileY = firstTileY; tileY <= lastTileY; tileY++)
+  {
+    const OdUInt32 tileTop = tileY * m_nTileSize;
+    const OdUInt32 rowFrom = odmax(y, tileTop), rowTo = odmin(y + height, tileTop + m_nTileSize);
+    for (OdUInt32 tileX = firstTileX; tileX <= lastTileX; tileX++)
+    {
+      const OdUInt32 tileLeft = tileX * m_nTileSize;
+      const OdUInt32 colFrom = odmax(x, tileLeft), colTo = odmin(x + width, tileLeft + m_nTileSize);
+      OdUInt8 *pOut = pDst + (rowFrom - y) * dstPitch;
+      if (!m_pCache->copyTileRows(m_nImage, nLevel, tileX, tileY, rowFrom - tileTop, rowTo - rowFrom,
+                                  colFrom - tileLeft, colTo - colFrom, pOut, dstPitch, colFrom - x))
+      {
+        OdUInt8Array pixels; OdUInt32 tileWidth, tileHeight;
+        decodeTile(nLevel, tileX, tileY, pixels, tileWidth, tileHeight);
+        const OdUInt32 tilePitch = pitch(tileWidth);
+        const OdUInt8 *pIn = pixels.getPtr() + (rowFrom - tileTop) * tilePitch;
+        for (OdUInt32 nRow = rowFrom; nRow < rowTo; nRow++, pIn += tilePitch, pOut += dstPitch)
+          ::odExCopyPixels(pIn, colFrom - tileLeft, pOut, colFrom - x, colTo - colFrom, m_info.m_nBitCount);
+        m_pCache->putTile(m_nImage, nLevel, tileX, tileY, tileWidth, tileHeight, m_info.m_nBitCount, pixels);
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+// OdExGiTiledRasterImage
+
+OdExGiTiledRasterImage::OdExGiTiledRasterImage()
+  : m_nLevel(0)
+  , m_width(0)
+  , m_height(0)
+  , m_transparencyMode(kTransparencyOff)
+  , m_imageSource(kUndefinedSource)
+{
+}
+
+OdExGiTiledRasterImage::~OdExGiTiledRasterImage()
+{
+}
+
+OdExGiTiledRasterImagePtr OdExGiTiledRasterImage::createObject(OdExGiRasterTileSource *pSource,
+                                                               OdExGiRasterTileCache *pCache,
+                                                               OdRxThreadPoolService *pThreadPool,
+                                                               OdUInt32 nTileSize)
+{
+  ODA_ASSERT(pSource);
+  OdSmartPtr<OdExGiTiledRasterImageShared> pShared = OdRxObjectImpl<OdExGiTiledRasterImageShared>::createObject();
+  if (!pSource->imageInfo(pShared->m_info))
+    return OdExGiTiledRasterImagePtr();
+  pShared->m_pSource = pSource;
+  pShared->m_pCache = pCache;
+  if (pShared->m_pCache.isNull())
+    pShared->m_pCache = OdExGiRasterTileCache::createObject();
+  pShared->m_pThreadPool = pThreadPool;
+  pShared->m_nImage = pShared->m_pCache->registerImage();
+  pShared->m_nTileSize = 16;
+  while (pShared->m_nTileSize < nTileSize)
+    pShared->m_nTileSize <<= 1;
+  OdUInt32 nMaxDim = odmax(pShared->m_info.m_width, pShared->m_info.m_height);
+  while (nMaxDim > pShared->m_nTileSize)
+    pShared->m_nLevels++, nMaxDim = (nMaxDim + 1) >> 1;
+
+  OdExGiTiledRasterImagePtr pImage = OdRxObjectImpl<OdExGiTiledRasterImage>::createObject();
+  pImage->m_pShared = pShared;
+  pImage->m_width = pShared->m_info.m_width;
+  pImage->m_height = pShared->m_info.m_height;
+  pImage->m_transparencyMode = (pShared->m_info.m_bHasAlpha) ? kTransparency8Bit : kTransparencyOff;
+  return pImage;
+}
+
+OdExGiTiledRasterImageShared *OdExGiTiledRasterImage::shared() const
+{
+  // Shared state is internally synchronized
+  return const_cast<OdExGiTiledRasterImageShared*>(m_pShared.get());
+}
+
+OdUInt32 OdExGiTiledRasterImage::numLevels() const
+{
+  return shared()->m_nLevels;
+}
+
+OdGiRasterImagePtr OdExGiTiledRasterImage::levelImage(OdUInt32 nLevel) const
+{
+  if (nLevel >= numLevels())
+    nLevel = numLevels() - 1;
+  OdExGiTiledRasterImagePtr pImage = OdRxObjectImpl<OdExGiTiledRasterImage>::createObject();
+  pImage->copyFrom(this);
+  pImage->m_nLevel = nLevel;
+  pImage->m_width = shared()->levelWidth(nLevel);
+  pImage->m_height = shared()->levelHeight(nLevel);
+  return pImage;
+}
+
+OdUInt32 OdExGiTiledRasterImage::levelForScale(double imagePixelsPerDevicePixel) const
+{
+  OdUInt32 nLevel = 0;
+  while ((nLevel + 1 < numLevels()) && (imagePixelsPerDevicePixel >= 2.0))
+    nLevel++, imagePixelsPerDevicePixel *= 0.5;
+  return nLevel;
+}
+
+OdUInt32 OdExGiTiledRasterImage::tileSize() const
+{
+  return shared()->m_nTileSize;
+}
+
+OdExGiRasterTileCache *OdExGiTiledRasterImage::tileCache() const
+{
+  return shared()->m_pCache.get();
+}
+
+void OdExGiTiledRasterImage::ensureTiles(OdUInt32 firstTileX, OdUInt32 firstTileY, OdUInt32 lastTileX, OdUInt32 lastTileY, bool bParallel) const
+{
+  shared()->ensureTiles(m_nLevel, firstTileX, firstTileY, lastTileX, lastTileY, bParallel);
+}
+
+void OdExGiTiledRasterImage::readRegion(OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height, OdUInt8 *pDst, OdUInt32 dstPitch) const
+{
+  ODA_ASSERT(x + width <= m_width && y + height <= m_height);
+  shared()->readRegion(m_nLevel, x, y, width, height, pDst, dstPitch);
+}
+
+OdUInt32 OdExGiTiledRasterImage::bitCount() const
+{
+  return shared()->m_info.m_nBitCount;
+}
+
+void OdExGiTiledRasterImage::prefetch(OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height) const
+{
+  if (x >= m_width || y >= m_height || !width || !height)
+    return;
+  width = odmin(width, m_width - x); height = odmin(height, m_height - y);
+  const OdUInt32 nTileSize = tileSize();
+  ensureTiles(x / nTileSize, y / nTileSize, (x + width - 1) / nTileSize, (y + height - 1) / nTileSize, true);
+}
+
+OdRxObjectPtr OdExGiTiledRasterImage::clone() const
+{
+  OdExGiTiledRasterImagePtr pRes = OdRxObjectImpl<OdExGiTiledRasterImage>::createObject();
+  pRes->copyFrom(this);
+  return (OdRxObject*)pRes;
+}
+
+void OdExGiTiledRasterImage::copyFrom(const OdRxObject* pOtherObj)
+{
+  const OdExGiTiledRasterImage* pFrom = (const OdExGiTiledRasterImage*)pOtherObj;
+  ODA_ASSERT(pFrom);
+  m_pShared          = pFrom->m_pShared;
+  m_nLevel           = pFrom->m_nLevel;
+  m_width            = pFrom->m_width;
+  m_height           = pFrom->m_height;
+  m_transparencyMode = pFrom->m_transparencyMode;
+  m_imageSource      = pFrom->m_imageSource;
+  m_sourceFileName   = pFrom->m_sourceFileName;
+}
+
+OdUInt32 OdExGiTiledRasterImage::pixelWidth() const
+{
+  return m_width;
+}
+
+OdUInt32 OdExGiTiledRasterImage::pixelHeight() const
+{
+  return m_height;
+}
+
+OdGiRasterImage::Units OdExGiTiledRasterImage::defaultResolution(double& xPelsPerUnit, double& yPelsPerUnit) const
+{
+  const double scale = double(1 << m_nLevel);
+  xPelsPerUnit = shared()->m_info.m_xPelsPerUnit / scale;
+  yPelsPerUnit = shared()->m_info.m_yPelsPerUnit / scale;
+  return shared()->m_info.m_resUnits;
+}
+
+OdUInt32 OdExGiTiledRasterImage::colorDepth() const
+{
+  return bitCount();
+}
+
+OdUInt32 OdExGiTiledRasterImage::numColors() const
+{
+  return shared()->m_info.m_palette.size();
+}
+
+ODCOLORREF OdExGiTiledRasterImage::color(OdUInt32 colorIndex) const
+{
+  const OdUInt32Array &palette = shared()->m_info.m_palette;
+  return (colorIndex < palette.size()) ? palette[colorIndex] : 0;
+}
+
+OdUInt32 OdExGiTiledRasterImage::paletteDataSize() const
+{
+  return numColors() * 4;
+}
+
+void OdExGiTiledRasterImage::paletteData(OdUInt8* bytes) const
+{
+  const OdUInt32Array &palette = shared()->m_info.m_palette;
+  for (OdUInt32 nColor = 0; nColor < palette.size(); nColor++, bytes += 4)
+  {
+    bytes[0] = ODGETBLUE(palette[nColor]); bytes[1] = ODGETGREEN(palette[nColor]);
+    bytes[2] = ODGETRED(palette[nColor]); bytes[3] = 0;
+  }
+}
+
+OdUInt32 OdExGiTiledRasterImage::scanLineSize() const
+{
+  return calcBMPScanLineSize(m_width, bitCount());
+}
+
+const OdUInt8* OdExGiTiledRasterImage::scanLines() const
+{
+  // Image is never fully decoded
+  return NULL;
+}
+
+void OdExGiTiledRasterImage::scanLines(OdUInt8* scnLines, OdUInt32 firstScanline, OdUInt32 numLines) const
+{
+  readRegion(0, firstScanline, m_width, numLines, scnLines, scanLineSize());
+}
+
+OdGiRasterImage::PixelFormatInfo OdExGiTiledRasterImage::pixelFormat() const
+{
+  PixelFormatInfo pf;
+  if (bitCount() == 24)
+    pf.setBGR();
+  else // Palette colors are BGRA also
+    pf.setBGRA();
+  return pf;
+}
+
+OdUInt32 OdExGiTiledRasterImage::scanLinesAlignment() const
+{
+  return 4;
+}
+
+OdGiRasterImagePtr OdExGiTiledRasterImage::crop(OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height) const
+{
+  if (x >= m_width || y >= m_height)
+    return OdGiRasterImagePtr();
+  width = odmin(width, m_width - x); height = odmin(height, m_height - y);
+  OdExGiRasterImagePtr pCrop = OdRxObjectImpl<OdExGiRasterImage>::createObject();
+  pCrop->setMetrics(width, height, (OdUInt16)bitCount());
+  const OdUInt32 nColors = numColors();
+  if (nColors)
+  {
+    pCrop->setPalNumColors(nColors);
+    for (OdUInt32 nColor = 0; nColor < nColors; nColor++)
+    {
+      const ODCOLORREF clr = color(nColor);
+      pCrop->setPalColorAt(nColor, ODGETBLUE(clr), ODGETGREEN(clr), ODGETRED(clr));
+    }
+  }
+  double xPelsPerUnit, yPelsPerUnit;
+  const Units units = defaultResolution(xPelsPerUnit, yPelsPerUnit);
+  pCrop->setDefaultResolution(units, xPelsPerUnit, yPelsPerUnit);
+  const OdUInt32 nPitch = calcBMPScanLineSize(width, bitCount());
+  pCrop->bits().resize(nPitch * height);
+  readRegion(x, y, width, height, pCrop->bits().asArrayPtr(), nPitch);
+  pCrop->setTransparencyMode(m_transparencyMode);
+  pCrop->setImageSource(m_imageSource);
+  pCrop->setSourceFileName(m_sourceFileName);
+  return pCrop;
+}
+
+OdUInt32 OdExGiTiledRasterImage::supportedParams() const
+{
+  return kImageSource | kTransparencyMode | kSourceFileName;
+}
+
+OdGiRasterImage::ImageSource OdExGiTiledRasterImage::imageSource() const
+{
+  return m_imageSource;
+}
+
+void OdExGiTiledRasterImage::setImageSource(ImageSource source)
+{
+  m_imageSource = source;
+}
+
+const OdString &OdExGiTiledRasterImage::sourceFileName() const
+{
+  return m_sourceFileName;
+}
+
+void OdExGiTiledRasterImage::setSourceFileName(const OdString &fileName)
+{
+  m_sourceFileName = fileName;
+}
+
+OdGiRasterImage::TransparencyMode OdExGiTiledRasterImage::transparencyMode() const
+{
+  return m_transparencyMode;
+}
+
+void OdExGiTiledRasterImage::setTransparencyMode(TransparencyMode mode)
+{
+  m_transparencyMode = mode;
+}
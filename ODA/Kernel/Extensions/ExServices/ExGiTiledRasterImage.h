@@ -0,0 +1,385 @@
+///////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance").
+// All rights reserved.
+//
+// This software and its documentation and related materials are owned by
+// the Alliance. The software may only be incorporated into application
+// programs owned by members of the Alliance, subject to a signed
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable
+// trade secrets of the Alliance and its suppliers. The software is also
+// protected by copyright law and international treaty provisions. Application
+// programs incorporating this software must include the following statement
+// with their copyright notices:
+//
+//   This application incorporates Open Design Alliance software pursuant to a license
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance.
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _OD_ODEXGITILEDRASTERIMAGE_H_
+#define _OD_ODEXGITILEDRASTERIMAGE_H_
+
+#include "TD_PackPush.h"
+
+#include "Gi/GiRasterImage.h"
+#include "RxThreadPoolService.h"
+#include "RxRasterServices.h"
+#include "OdMutex.h"
+#include "UInt8Array.h"
+#include "UInt32Array.h"
+#include "OdList.h"
+
+#define STL_USING_MAP
+#include "OdaSTL.h"
+
+/** \details
+    This interface represents a decoder which is able to provide rectangular
+    regions of a raster image without decoding the whole image.
+
+    Regions are returned in the source pixel format described by Info: palette
+    indices for 1, 4 and 8 bits per pixel (leftmost pixel in the most significant
+    bits), BGR for 24 and BGRA for 32 bits per pixel. Scanlines are padded to byte
+    boundary only (pitch is (width * bitCount + 7) / 8) and go in bottom-up order
+    like OdGiRasterImage.
+
+    <group ExServices_Classes>
+    Library: Source code provided.
+*/
+class OdExGiRasterTileSource : public OdRxObject
+{
+public:
+  struct Info
+  {
+    OdUInt32               m_width;
+    OdUInt32               m_height;
+    OdGiRasterImage::Units m_resUnits;
+    double                 m_xPelsPerUnit;
+    double                 m_yPelsPerUnit;
+    bool                   m_bHasAlpha;
+    OdUInt32               m_nBitCount; // 1, 4, 8, 24 or 32
+    OdUInt32Array          m_palette;   // Colors of indexed formats
+
+    Info() : m_width(0), m_height(0), m_resUnits(OdGiRasterImage::kNone)
+           , m_xPelsPerUnit(0.0), m_yPelsPerUnit(0.0), m_bHasAlpha(false), m_nBitCount(32) { }
+  };
+
+  /** \details
+      Reads image metrics. Must be cheap: implementations are expected to read headers only.
+  */
+  virtual bool imageInfo(Info &info) = 0;
+
+  /** \details
+      Decodes a region of the image at the specified mip level.
+      \param level [in]  Mip level (0 is the full resolution image).
+      \param x [in]  Left pixel of the region at the specified level.
+      \param y [in]  First scanline of the region at the specified level.
+      \param width [in]  Region width in pixels.
+      \param height [in]  Region height in scanlines.
+      \param pDst [out]  Destination buffer of (width * bitCount + 7) / 8 * height bytes.
+      \returns
+      Returns false if the decoder can't natively provide the requested level. In this case level
+      is built by the caller from the previous one.
+      \remarks
+      Can be called from several worker threads at the same time.
+  */
+  virtual bool decodeRegion(OdUInt32 level, OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height, OdUInt8 *pDst) = 0;
+
+  /** \details
+      Returns true if decodeRegion() reads only the requested part of the image. Otherwise
+      overview levels are built at once from a single full decode, so that zoomed out views
+      never require full resolution tiles.
+  */
+  virtual bool isRegionDecoder() const { return true; }
+
+  /** \details
+      Releases decoder resources (open streams, intermediate buffers). Called when all tiles
+      of the image are evicted or the image is destroyed.
+  */
+  virtual void releaseResources() { }
+};
+
+typedef OdSmartPtr<OdExGiRasterTileSource> OdExGiRasterTileSourcePtr;
+
+/** \details
+    Creates tile source which reads uncompressed BMP files scanline by scanline on demand.
+    Returns null if the stream isn't an uncompressed BMP (32 bits per pixel images with
+    BGRA bit fields are accepted also). This is the only source which decodes regions
+    without decoding the whole image; all other formats are decoded entirely by
+    odExCreateDeferredTileSource().
+*/
+OdExGiRasterTileSourcePtr odExCreateBmpTileSource(const OdString &fileName);
+
+/** \details
+    Creates tile source which decodes the full image through the specified raster services
+    module. The decoded image is kept while full resolution tiles are requested and released
+    as soon as overview levels are built from it. Tiled loading flags are removed from the
+    specified loading flags chain.
+*/
+OdExGiRasterTileSourcePtr odExCreateDeferredTileSource(OdRxRasterServices *pRasSvcs, const OdString &fileName,
+                                                       const OdUInt32 *pFlagsChain = NULL);
+
+/** \details
+    Creates tile source over an already decoded raster image.
+*/
+OdExGiRasterTileSourcePtr odExCreateImageTileSource(const OdGiRasterImage *pImage);
+
+/** \details
+    This class represents memory bounded cache of decoded raster image tiles.
+    Single cache object can be shared between many tiled images, so that all
+    raster underlays of the drawing are limited by the same memory budget.
+
+    <group ExServices_Classes>
+    Library: Source code provided.
+*/
+class OdExGiRasterTileCache : public OdRxObject
+{
+public:
+  struct Stats
+  {
+    OdUInt64 m_nBytesUsed;
+    OdUInt64 m_nBytesPeak;
+    OdUInt64 m_nHits;
+    OdUInt64 m_nMisses;
+    OdUInt64 m_nEvictions;
+    OdUInt32 m_nTiles;
+
+    Stats() : m_nBytesUsed(0), m_nBytesPeak(0), m_nHits(0), m_nMisses(0), m_nEvictions(0), m_nTiles(0) { }
+  };
+protected:
+  struct TileKey
+  {
+    OdUInt32 m_nImage;
+    OdUInt32 m_nLevel;
+    OdUInt32 m_nTileX;
+    OdUInt32 m_nTileY;
+
+    bool operator <(const TileKey &k2) const
+    {
+      if (m_nImage != k2.m_nImage) return m_nImage < k2.m_nImage;
+      if (m_nLevel != k2.m_nLevel) return m_nLevel < k2.m_nLevel;
+      if (m_nTileY != k2.m_nTileY) return m_nTileY < k2.m_nTileY;
+      return m_nTileX < k2.m_nTileX;
+    }
+  };
+  struct TileEntry
+  {
+    OdUInt8Array                m_pixels;
+    OdUInt32                    m_width;
+    OdUInt32                    m_height;
+    OdUInt32                    m_nBitCount;
+    OdList<TileKey>::iterator   m_lruPos;
+  };
+  typedef std::map<TileKey, TileEntry> TileMap;
+
+  mutable OdMutex m_mutex;
+  TileMap         m_tiles;
+  OdList<TileKey> m_lru; // Most recently used tiles at front
+  OdUInt64        m_nBudget;
+  OdUInt32        m_nImageIdSeed;
+  Stats           m_stats;
+
+  void evictExtra(OdUInt64 nReserve);
+public:
+  OdExGiRasterTileCache();
+
+  /** \details
+      Creates new tiles cache with the specified memory budget in bytes.
+  */
+  static OdSmartPtr<OdExGiRasterTileCache> createObject(OdUInt64 nBudget = OdUInt64(256) * 1024 * 1024);
+
+  /** \details
+      Changes memory budget of this cache. Least recently used tiles are evicted immediately if
+      the new budget is less than the currently used memory.
+  */
+  void setBudget(OdUInt64 nBudget);
+  OdUInt64 budget() const;
+
+  /** \details
+      Returns cache usage statistics.
+  */
+  Stats stats() const;
+
+  /** \details
+      Returns unique identifier for new image which will use this cache.
+  */
+  OdUInt32 registerImage();
+  /** \details
+      Removes all tiles of the specified image.
+  */
+  void purgeImage(OdUInt32 nImage);
+
+  /** \details
+      Copies part of cached tile rows into destination buffer. Destination pixels of each
+      row start from dstCol pixel.
+      \returns
+      Returns false if tile isn't cached.
+  */
+  bool copyTileRows(OdUInt32 nImage, OdUInt32 nLevel, OdUInt32 tileX, OdUInt32 tileY,
+                    OdUInt32 firstRow, OdUInt32 numRows, OdUInt32 firstCol, OdUInt32 numCols,
+                    OdUInt8 *pDst, OdUInt32 dstPitch, OdUInt32 dstCol = 0);
+  /** \details
+      Checks whether tile is cached without touching the LRU order.
+  */
+  bool hasTile(OdUInt32 nImage, OdUInt32 nLevel, OdUInt32 tileX, OdUInt32 tileY) const;
+  /** \details
+      Places decoded tile into the cache. Pixels array is swapped into the cache.
+  */
+  void putTile(OdUInt32 nImage, OdUInt32 nLevel, OdUInt32 tileX, OdUInt32 tileY,
+               OdUInt32 width, OdUInt32 height, OdUInt32 nBitCount, OdUInt8Array &pixels);
+};
+
+typedef OdSmartPtr<OdExGiRasterTileCache> OdExGiRasterTileCachePtr;
+
+class OdExGiTiledRasterImageShared;
+
+/** \details
+    This interface is implemented by raster images which provide downsampled mip levels.
+    Renderers query it to draw zoomed out images from the level which matches the device
+    resolution instead of full resolution pixels. It is header only, so renderers don't
+    link with the module which implements the image.
+
+    <group ExServices_Classes>
+    Library: Source code provided.
+*/
+class OdExGiRasterImageLevels
+{
+public:
+  virtual ~OdExGiRasterImageLevels() { }
+
+  /** \details
+      Returns number of mip levels available for this image.
+  */
+  virtual OdUInt32 numLevels() const = 0;
+  /** \details
+      Returns mip level represented by this image object.
+  */
+  virtual OdUInt32 level() const = 0;
+  /** \details
+      Returns image which represents specified mip level.
+  */
+  virtual OdGiRasterImagePtr levelImage(OdUInt32 nLevel) const = 0;
+  /** \details
+      Selects mip level for specified number of image pixels per one device pixel.
+  */
+  virtual OdUInt32 levelForScale(double imagePixelsPerDevicePixel) const = 0;
+};
+
+/** \details
+    This class represents raster image which is split onto fixed size tiles and
+    mip levels, which are decoded lazily, only when requested, optionally on worker
+    threads, and kept inside memory bounded OdExGiRasterTileCache.
+
+    Tiles and image pixels keep the source pixel format, so indexed images stay
+    at their bit depth. scanLines() returns NULL, so consumers use
+    scanLines(OdUInt8*, firstScanline, numLines) or crop() which touch only the
+    required tiles.
+
+    <group ExServices_Classes>
+    Library: Source code provided.
+*/
+class OdExGiTiledRasterImage : public OdGiRasterImageParam, public OdExGiRasterImageLevels
+{
+protected:
+  OdSmartPtr<OdExGiTiledRasterImageShared> m_pShared;
+  OdUInt32                                 m_nLevel;
+  OdUInt32                                 m_width;
+  OdUInt32                                 m_height;
+  TransparencyMode                         m_transparencyMode;
+  ImageSource                              m_imageSource;
+  OdString                                 m_sourceFileName;
+
+  OdExGiTiledRasterImageShared *shared() const;
+  void ensureTiles(OdUInt32 firstTileX, OdUInt32 firstTileY, OdUInt32 lastTileX, OdUInt32 lastTileY, bool bParallel) const;
+  void readRegion(OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height, OdUInt8 *pDst, OdUInt32 dstPitch) const;
+  OdUInt32 bitCount() const;
+public:
+  enum
+  {
+    kDefaultTileSize = 256
+  };
+
+  OdExGiTiledRasterImage();
+  ~OdExGiTiledRasterImage();
+
+  /** \details
+      Creates tiled image.
+      \param pSource [in]  Tiles decoder.
+      \param pCache [in]  Tiles cache. New cache with default budget is created if null.
+      \param pThreadPool [in]  Optional thread pool service used to decode tiles in parallel.
+      \param nTileSize [in]  Tile size in pixels (rounded up to power of two).
+  */
+  static OdSmartPtr<OdExGiTiledRasterImage> createObject(OdExGiRasterTileSource *pSource,
+                                                         OdExGiRasterTileCache *pCache = NULL,
+                                                         OdRxThreadPoolService *pThreadPool = NULL,
+                                                         OdUInt32 nTileSize = kDefaultTileSize);
+
+  /** \details
+      Returns number of mip levels available for this image.
+  */
+  OdUInt32 numLevels() const;
+  /** \details
+      Returns mip level represented by this image object.
+  */
+  OdUInt32 level() const { return m_nLevel; }
+  /** \details
+      Returns image which represents specified mip level. Returned image shares tiles
+      decoder and cache with this image.
+  */
+  OdGiRasterImagePtr levelImage(OdUInt32 nLevel) const;
+  /** \details
+      Selects mip level for specified number of image pixels per one device pixel.
+  */
+  OdUInt32 levelForScale(double imagePixelsPerDevicePixel) const;
+  /** \details
+      Returns tile size in pixels.
+  */
+  OdUInt32 tileSize() const;
+  /** \details
+      Returns tiles cache used by this image.
+  */
+  OdExGiRasterTileCache *tileCache() const;
+
+  /** \details
+      Decodes all not cached tiles of the specified region of this level. Tiles are decoded
+      on worker threads if thread pool service is available.
+  */
+  void prefetch(OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height) const;
+
+  // OdGiRasterImage overrides
+
+  OdRxObjectPtr clone() const;
+  void copyFrom(const OdRxObject* pOtherObj);
+  OdUInt32 pixelWidth() const;
+  OdUInt32 pixelHeight() const;
+  Units defaultResolution(double& xPelsPerUnit, double& yPelsPerUnit) const;
+  OdUInt32 colorDepth() const;
+  OdUInt32 numColors() const;
+  ODCOLORREF color(OdUInt32 colorIndex) const;
+  OdUInt32 paletteDataSize() const;
+  void paletteData(OdUInt8* bytes) const;
+  OdUInt32 scanLineSize() const;
+  const OdUInt8* scanLines() const;
+  void scanLines(OdUInt8* scnLines, OdUInt32 firstScanline, OdUInt32 numLines = 1) const;
+  PixelFormatInfo pixelFormat() const;
+  OdUInt32 scanLinesAlignment() const;
+  OdGiRasterImagePtr crop(OdUInt32 x, OdUInt32 y, OdUInt32 width, OdUInt32 height) const;
+
+  OdUInt32 supportedParams() const;
+  ImageSource imageSource() const;
+  void setImageSource(ImageSource source);
+  const OdString &sourceFileName() const;
+  void setSourceFileName(const OdString &fileName);
+  TransparencyMode transparencyMode() const;
+  void setTransparencyMode(TransparencyMode mode);
+};
+
+typedef OdSmartPtr<OdExGiTiledRasterImage> OdExGiTiledRasterImagePtr;
+
+#include "TD_PackPop.h"
+
+#endif //#ifndef _OD_ODEXGITILEDRASTERIMAGE_H_
@@ -41,6 +41,8 @@ void ExUndoController::setLimits(OdUInt32 nMaxSteps, OdUInt32 nMaxMemory)
 {
   m_nMaxSteps  = nMaxSteps;
   m_nMaxMemory = nMaxMemory;
+  if (!m_pStore.isNull())
+    m_pStore->setLimits(nMaxSteps, nMaxMemory, m_pStore->maxBytes());
   freeExtra();
 }
 
@@ -114,6 +116,11 @@ bool ExUndoController::pushRecord(OdUInt32 nSizeOfRecToAppend)
 
 void ExUndoController::pushData(OdStreamBuf* pStream, OdUInt32 nSize, OdUInt32 opt)
 {
+  if (!m_pStore.isNull())
+  {
+    m_pStore->push(pStream, nSize, opt);
+    return;
+  }
   if(pushRecord(nSize + sizeof(OdUInt32)))
   {
     OdStaticRxObject<OdFlatMemStream> ms;
@@ -125,11 +132,15 @@ void ExUndoController::pushData(OdStreamBuf* pStream, OdUInt32 nSize, OdUInt32 o
 
 bool ExUndoController::hasData() const
 {
+  if (!m_pStore.isNull())
+    return m_pStore->hasData();
   return !m_records.empty();
 }
 
 OdUInt32 ExUndoController::popData(OdStreamBuf* pStream)
 {
+  if (!m_pStore.isNull())
+    return m_pStore->pop(pStream);
   if(!hasData())
     throw OdError(eEndOfFile);
   OdUInt32 nSize = m_records.back().size();
@@ -183,6 +194,8 @@ public:
 
 OdRxIteratorPtr ExUndoController::newRecordStackIterator() const
 {
+  if (!m_pStore.isNull())
+    return m_pStore->newRecordStackIterator();
   OdSmartPtr<ExUndoControllerIterator> pIter =
     OdRxObjectImpl<ExUndoControllerIterator>::createObject();
   pIter->m_iter = m_records.rbegin();
@@ -194,4 +207,17 @@ void ExUndoController::clearData()
 {
   m_records.clear();
   m_nMemoryUsed = 0;
+  if (!m_pStore.isNull())
+    m_pStore->clear();
+}
+
+void ExUndoController::setRecordStore(ExUndoRecordStore* pStore)
+{
+  clearData();
+  m_pStore = pStore;
+  if (!m_pStore.isNull())
+  {
+    m_pStore->clear();
+    m_pStore->setLimits(m_nMaxSteps, m_nMaxMemory, m_pStore->maxBytes());
+  }
 }
@@ -28,6 +28,7 @@
 #include "DbUndoController.h"
 #include "UInt8Array.h"
 #include "OdList.h"
+#include "ExUndoRecordStore.h"
 /** \details
   This class implements platform-independent UndoController objects.
   
@@ -40,6 +41,8 @@ class ExUndoController : public OdDbUndoController
 
   OdUInt32              m_nMaxSteps;
   OdUInt32              m_nMaxMemory;
+
+  ExUndoRecordStorePtr  m_pStore;
 protected:
   ExUndoController();
 
@@ -115,6 +118,20 @@ public:
   OdRxIteratorPtr newRecordStackIterator() const;
   
   void clearData();
+
+  /** \details
+    Sets record store which keeps records of this UndoController object in compressed form
+    with memory budget. If store is null, records are kept by this UndoController object itself.
+    \param pStore [in]  Pointer to the record store.
+    \remarks
+    Clears existing records.
+  */
+  void setRecordStore(ExUndoRecordStore* pStore);
+
+  /** \details
+    Returns record store of this UndoController object, or null if store isn't set.
+  */
+  ExUndoRecordStorePtr recordStore() const { return m_pStore; }
 };
 #include "TD_PackPop.h"
 
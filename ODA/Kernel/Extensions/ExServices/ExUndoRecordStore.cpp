@@ -0,0 +1,606 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StdAfx.h"
+#include "ExUndoRecordStore.h"
+#include "DbUndoController.h"
+#include "FlatMemStream.h"
+#include "RxObjectImpl.h"
+#include "DynamicLinker.h"
+#include "RxSystemServices.h"
+#include "OdPerfTimer.h"
+#include "UInt32Array.h"
+
+// Records smaller than this size aren't compressed
+#define EX_UNDOSTORE_MINPACKSIZE 64
+
+// LZ4 block format compatible codec
+
+#define EX_UNDOLZ_HASHLOG     12
+#define EX_UNDOLZ_MINMATCH    4
+#define EX_UNDOLZ_LASTLITERALS 5  // Last bytes of block are always literals
+#define EX_UNDOLZ_MFLIMIT     12  // Last match must start before this distance from block end
+#define EX_UNDOLZ_MAXOFFSET   65535
+
+static inline OdUInt32 exUndoLzRead32(const OdUInt8 *pData)
+{
+  OdUInt32 nVal;
+  ::memcpy(&nVal, pData, sizeof(OdUInt32));
+  return nVal;
+}
+
+static inline OdUInt32 exUndoLzHash(OdUInt32 nSeq)
+{
+  return (nSeq * 2654435761U) >> (32 - EX_UNDOLZ_HASHLOG);
+}
+
+static inline OdUInt8 *exUndoLzPutLength(OdUInt8 *pOut, OdUInt32 nLength)
+{
+  while (nLength >= 255)
+    *pOut++ = 255, nLength -= 255;
+  *pOut++ = (OdUInt8)nLength;
+  return pOut;
+}
+
+static inline OdUInt32 exUndoLzCompressBound(OdUInt32 nSize)
+{
+  return nSize + nSize / 255 + 16;
+}
+
+// Returns size of compressed data. Output buffer must be at least exUndoLzCompressBound(nSize) bytes.
+static OdUInt32 exUndoLzCompress(const OdUInt8 *pIn, OdUInt32 nSize, OdUInt8 *pOut)
+{
+  OdUInt8 *pOutStart = pOut;
+  OdUInt32 nAnchor = 0;
+  if (nSize > EX_UNDOLZ_MFLIMIT)
+  {
+    OdUInt32 hashTable[1 << EX_UNDOLZ_HASHLOG];
+    ::memset(hashTable, 0xFF, sizeof(hashTable));
+    const OdUInt32 nMatchLimit = nSize - EX_UNDOLZ_MFLIMIT;
+    const OdUInt32 nMatchEnd = nSize - EX_UNDOLZ_LASTLITERALS;
+    OdUInt32 nPos = 0;
+    while (nPos < nMatchLimit)
+    {
+      const OdUInt32 nSeq = exUndoLzRead32(pIn + nPos);
+      const OdUInt32 nHash = exUndoLzHash(nSeq);
+      const OdUInt32 nRef = hashTable[nHash];
+      hashTable[nHash] = nPos;
+      if ((nRef == 0xFFFFFFFF) || (nPos - nRef > EX_UNDOLZ_MAXOFFSET) || (exUndoLzRead32(pIn + nRef) != nSeq))
+      {
+        nPos++;
+        continue;
+      }
+      OdUInt32 nMatch = EX_UNDOLZ_MINMATCH;
+      while ((nPos + nMatch < nMatchEnd) && (pIn[nRef + nMatch] == pIn[nPos + nMatch]))
+        nMatch++;
+      // Sequence token, literals, offset and match length
+      const OdUInt32 nLiterals = nPos - nAnchor;
+      const OdUInt32 nMatchCode = nMatch - EX_UNDOLZ_MINMATCH;
+      OdUInt8 *pToken = pOut++;
+      *pToken = (OdUInt8)((odmin(nLiterals, 15U) << 4) | odmin(nMatchCode, 15U));
+      if (nLiterals >= 15)
+        pOut = exUndoLzPutLength(pOut, nLiterals - 15);
+      ::memcpy(pOut, pIn + nAnchor, nLiterals);
+      pOut += nLiterals;
+      const OdUInt32 nOffset = nPos - nRef;
+      *pOut++ = (OdUInt8)(nOffset & 0xFF);
+      *pOut++ = (OdUInt8)(nOffset >> 8);
+      if (nMatchCode >= 15)
+        pOut = exUndoLzPutLength(pOut, nMatchCode - 15);
+      nPos += nMatch;
+      nAnchor = nPos;
+    }
+  }
+  // Last literals
+  const OdUInt32 nLiterals = nSize - nAnchor;
+  *pOut++ = (OdUInt8)(odmin(nLiterals, 15U) << 4);
+  if (nLiterals >= 15)
+    pOut = exUndoLzPutLength(pOut, nLiterals - 15);
+  ::memcpy(pOut, pIn + nAnchor, nLiterals);
+  pOut += nLiterals;
+  return OdUInt32(pOut - pOutStart);
+}
+
+// Returns false if compressed data is invalid or doesn't match expected size
+static bool exUndoLzDecompress(const OdUInt8 *pIn, OdUInt32 nInSize, OdUInt8 *pOut, OdUInt32 nOutSize)
+{
+  OdUInt32 nIn = 0, nOut = 0;
+  while (nIn < nInSize)
+  {
+    const OdUInt8 token = pIn[nIn++];
+    OdUInt32 nLiterals = token >> 4;
+    if (nLiterals == 15)
+    {
+      OdUInt8 nByte;
+      do
+      {
+        if (nIn >= nInSize)
+          return false;
+        nByte = pIn[nIn++];
+        nLiterals += nByte;
+      } while (nByte == 255);
+    }
+    if ((nLiterals > nInSize - nIn) || (nLiterals > nOutSize - nOut))
+      return false;
+    ::memcpy(pOut + nOut, pIn + nIn, nLiterals);
+    nIn += nLiterals; nOut += nLiterals;
+    if (nIn == nInSize) // Last sequence contains literals only
+      break;
+    if (nInSize - nIn < 2)
+      return false;
+    const OdUInt32 nOffset = OdUInt32(pIn[nIn]) | (OdUInt32(pIn[nIn + 1]) << 8);
+    nIn += 2;
+    if (!nOffset || (nOffset > nOut))
+      return false;
+    OdUInt32 nMatch = token & 15;
+    if (nMatch == 15)
+    {
+      OdUInt8 nByte;
+      do
+      {
+        if (nIn >= nInSize)
+          return false;
+        nByte = pIn[nIn++];
+        nMatch += nByte;
+      } while (nByte == 255);
+    }
+    nMatch += EX_UNDOLZ_MINMATCH;
+    if (nMatch > nOutSize - nOut)
+      return false;
+    // Match could overlap output, so copy it bytewise
+    const OdUInt8 *pMatch = pOut + nOut - nOffset;
+    OdUInt8 *pDst = pOut + nOut;
+    for (OdUInt32 n = 0; n < nMatch; n++)
+      pDst[n] = pMatch[n];
+    nOut += nMatch;
+  }
+  return nOut == nOutSize;
+}
+
+// ExUndoRecordCompressor
+
+void ExUndoRecordCompressor::apcEntryPoint(OdApcParamType nRecordId)
+{
+  m_pStore->compressRecord((OdUInt64)nRecordId);
+}
+
+// ExUndoRecordStore
+
+ExUndoRecordStore::ExUndoRecordStore()
+  : m_nFlags(kDefaultFlags)
+  , m_nMaxSteps(0xFFFFFFFF)
+  , m_nMaxMemory(0x01000000)
+  , m_nMaxBytes(0x10000000)
+  , m_nSegmentSize(0x00400000)
+  , m_nNextId(1)
+  , m_nSpillCursor(1)
+  , m_nNextSegment(0)
+  , m_nWriteSegment(0xFFFFFFFF)
+{
+  m_compressor.m_pStore = this;
+}
+
+ExUndoRecordStore::~ExUndoRecordStore()
+{
+  // Background thread shouldn't access store after destruction
+  if (!m_pQueue.isNull())
+    m_pQueue->wait();
+}
+
+OdSmartPtr<ExUndoRecordStore> ExUndoRecordStore::createObject(OdUInt32 nFlags, OdRxThreadPoolService *pThreadPool)
+{
+  OdSmartPtr<ExUndoRecordStore> pStore = OdRxObjectImpl<ExUndoRecordStore>::createObject();
+  pStore->m_nFlags = nFlags;
+  if (GETBIT(nFlags, kCompress) && GETBIT(nFlags, kBackgroundCompression))
+  {
+    OdRxThreadPoolServicePtr pTP = pThreadPool;
+    if (pTP.isNull())
+      pTP = odrxDynamicLinker()->getModule(OdThreadPoolModuleName);
+    if (!pTP.isNull())
+      pStore->m_pQueue = pTP->newSTQueue();
+  }
+  return pStore;
+}
+
+void ExUndoRecordStore::setLimits(OdUInt32 maxSteps, OdUInt64 maxMemory, OdUInt64 maxBytes)
+{
+  TD_AUTOLOCK(m_mutex);
+  m_nMaxSteps = maxSteps;
+  m_nMaxMemory = maxMemory;
+  m_nMaxBytes = maxBytes;
+  enforceLimits();
+}
+
+void ExUndoRecordStore::setSpillOptions(OdUInt32 nSegmentSize, const OdString &spillFolder)
+{
+  TD_AUTOLOCK(m_mutex);
+  m_nSegmentSize = nSegmentSize;
+  m_spillFolder = spillFolder;
+  if (!m_spillFolder.isEmpty())
+  {
+    const OdChar lastChar = m_spillFolder.getAt(m_spillFolder.getLength() - 1);
+    if ((lastChar != L'/') && (lastChar != L'\\'))
+      m_spillFolder += L'/';
+  }
+}
+
+bool ExUndoRecordStore::packData(const OdBinaryData &rawData, OdBinaryData &packedData)
+{
+  const OdUInt32 nRawSize = rawData.size();
+  if (nRawSize < EX_UNDOSTORE_MINPACKSIZE)
+    return false;
+  packedData.resize(exUndoLzCompressBound(nRawSize));
+  const OdUInt32 nPackedSize = exUndoLzCompress(rawData.getPtr(), nRawSize, packedData.asArrayPtr());
+  if (nPackedSize >= nRawSize)
+    return false;
+  packedData.resize(nPackedSize);
+  packedData.setPhysicalLength(nPackedSize);
+  return true;
+}
+
+void ExUndoRecordStore::compressRecord(OdUInt64 nRecordId)
+{
+  OdBinaryData rawData;
+  {
+    TD_AUTOLOCK(m_mutex);
+    RecordMap::const_iterator it = m_records.find(nRecordId);
+    if ((it == m_records.end()) || (it->second.m_state != kPending))
+      return; // Record already popped or evicted
+    // Data buffer is shared, so record still can be popped while it is compressed
+    rawData = it->second.m_data;
+  }
+  OdBinaryData packedData;
+  const bool bPacked = packData(rawData, packedData);
+  TD_AUTOLOCK(m_mutex);
+  RecordMap::iterator it = m_records.find(nRecordId);
+  if ((it == m_records.end()) || (it->second.m_state != kPending))
+    return;
+  Record &rec = it->second;
+  if (bPacked)
+  {
+    m_stats.m_nMemoryBytes -= rec.m_data.size();
+    m_stats.m_nStoredBytes -= rec.m_data.size();
+    rec.m_data = packedData;
+    rec.m_bPacked = true;
+    m_stats.m_nMemoryBytes += rec.m_data.size();
+    m_stats.m_nStoredBytes += rec.m_data.size();
+  }
+  rec.m_state = kInMemory;
+  m_stats.m_nPending--;
+  // Spilling stopped on this record while it was queued
+  enforceLimits();
+}
+
+ExUndoRecordStore::Segment *ExUndoRecordStore::writeSegment(OdUInt32 nBytes)
+{
+  SegmentMap::iterator it = m_segments.find(m_nWriteSegment);
+  if ((it != m_segments.end()) && (!it->second.m_nSize || (it->second.m_nSize + nBytes <= m_nSegmentSize)))
+    return &it->second;
+  const OdString filePath = m_spillFolder.isEmpty() ? ::odrxSystemServices()->getTempFileName() :
+    OdString().format(OD_T("%lsexundo_%p_%u.tmp"), m_spillFolder.c_str(), (const void*)this, m_nNextSegment);
+  if (filePath.isEmpty())
+    throw OdError(eFileAccessErr);
+  // Temporary file is deleted on close
+  OdStreamBufPtr pFile = ::odrxSystemServices()->createFile(filePath,
+    (Oda::FileAccessMode)(Oda::kFileRead | Oda::kFileWrite | Oda::kFileDelete),
+    Oda::kShareDenyReadWrite, Oda::kCreateAlways);
+  m_nWriteSegment = m_nNextSegment++;
+  Segment &segment = m_segments[m_nWriteSegment];
+  segment.m_pFile = pFile;
+  m_stats.m_nSegments++;
+  return &segment;
+}
+
+bool ExUndoRecordStore::spillRecord(Record &rec)
+{
+  const OdUInt32 nBytes = rec.m_data.size();
+  Segment *pSegment;
+  try
+  {
+    pSegment = writeSegment(nBytes);
+    pSegment->m_pFile->seek((OdInt64)pSegment->m_nSize, OdDb::kSeekFromStart);
+    if (nBytes)
+      pSegment->m_pFile->putBytes(rec.m_data.getPtr(), nBytes);
+  }
+  catch (const OdError &)
+  {
+    return false;
+  }
+  rec.m_nSegment = m_nWriteSegment;
+  rec.m_nOffset = pSegment->m_nSize;
+  rec.m_nStoredSize = nBytes;
+  pSegment->m_nSize += nBytes;
+  pSegment->m_nRecords++;
+  rec.m_data = OdBinaryData();
+  rec.m_state = kSpilled;
+  m_stats.m_nMemoryBytes -= nBytes;
+  m_stats.m_nSpilledBytes += nBytes;
+  m_stats.m_nSpilled++;
+  return true;
+}
+
+void ExUndoRecordStore::readSpilled(const Record &rec, OdBinaryData &data)
+{
+  SegmentMap::iterator it = m_segments.find(rec.m_nSegment);
+  if (it == m_segments.end())
+    throw OdError(eFileInternalErr);
+  data.resize(rec.m_nStoredSize);
+  if (rec.m_nStoredSize)
+  {
+    it->second.m_pFile->seek((OdInt64)rec.m_nOffset, OdDb::kSeekFromStart);
+    it->second.m_pFile->getBytes(data.asArrayPtr(), rec.m_nStoredSize);
+  }
+}
+
+void ExUndoRecordStore::releaseSegmentRecord(const Record &rec)
+{
+  SegmentMap::iterator it = m_segments.find(rec.m_nSegment);
+  if (it == m_segments.end())
+    return;
+  Segment &segment = it->second;
+  // Popped records usually are at the segment tail, so their space can be reused
+  if (rec.m_nOffset + rec.m_nStoredSize == segment.m_nSize)
+    segment.m_nSize = rec.m_nOffset;
+  if (!--segment.m_nRecords)
+  {
+    if (it->first == m_nWriteSegment)
+      segment.m_nSize = 0;
+    else
+    {
+      m_segments.erase(it);
+      m_stats.m_nSegments--;
+    }
+  }
+}
+
+void ExUndoRecordStore::eraseRecord(RecordMap::iterator it)
+{
+  const Record &rec = it->second;
+  m_stats.m_nRecords--;
+  m_stats.m_nRawBytes -= rec.m_nRawSize;
+  if (rec.m_state == kSpilled)
+  {
+    m_stats.m_nStoredBytes -= rec.m_nStoredSize;
+    m_stats.m_nSpilledBytes -= rec.m_nStoredSize;
+    m_stats.m_nSpilled--;
+    releaseSegmentRecord(rec);
+  }
+  else
+  {
+    m_stats.m_nStoredBytes -= rec.m_data.size();
+    m_stats.m_nMemoryBytes -= rec.m_data.size();
+    if (rec.m_state == kPending)
+      m_stats.m_nPending--;
+  }
+  m_records.erase(it);
+}
+
+void ExUndoRecordStore::enforceLimits()
+{
+  // Spill the oldest records which exceed memory limit. Spilling stops on record which is still
+  // waiting for compression, it will be spilled later.
+  if (GETBIT(m_nFlags, kSpillToDisk))
+  {
+    RecordMap::iterator it = m_records.lower_bound(m_nSpillCursor);
+    while ((m_stats.m_nMemoryBytes > m_nMaxMemory) && (it != m_records.end()) && (it->second.m_state == kInMemory))
+    {
+      if (!spillRecord(it->second))
+      { // Temporary files aren't accessible, so limit memory by eviction
+        SETBIT_0(m_nFlags, kSpillToDisk);
+        break;
+      }
+      m_nSpillCursor = it->first + 1;
+      ++it;
+    }
+  }
+  const bool bSpill = GETBIT(m_nFlags, kSpillToDisk);
+  while (!m_records.empty() && ((m_records.size() > m_nMaxSteps) || (m_stats.m_nStoredBytes > m_nMaxBytes) ||
+                                (!bSpill && (m_stats.m_nMemoryBytes > m_nMaxMemory))))
+  {
+    eraseRecord(m_records.begin());
+    m_stats.m_nEvicted++;
+  }
+}
+
+void ExUndoRecordStore::push(OdStreamBuf *pStream, OdUInt32 nSize, OdUInt32 opt)
+{
+  OdPerfTimerWrapper timer;
+  timer.getTimer()->start();
+  Record rec;
+  rec.m_options = opt;
+  rec.m_nRawSize = nSize;
+  rec.m_data.resize(nSize);
+  if (nSize)
+  {
+    OdStaticRxObject<OdFlatMemStream> ms;
+    ms.init(rec.m_data.asArrayPtr(), nSize);
+    pStream->copyDataTo(&ms, pStream->tell(), pStream->tell() + nSize);
+  }
+  bool bQueue = false;
+  if (GETBIT(m_nFlags, kCompress) && (nSize >= EX_UNDOSTORE_MINPACKSIZE))
+  {
+    if (!m_pQueue.isNull())
+      rec.m_state = kPending, bQueue = true;
+    else
+    {
+      OdBinaryData packedData;
+      if (packData(rec.m_data, packedData))
+        rec.m_data = packedData, rec.m_bPacked = true;
+    }
+  }
+  OdUInt64 nId;
+  {
+    TD_AUTOLOCK(m_mutex);
+    nId = m_nNextId++;
+    m_records[nId] = rec;
+    m_stats.m_nRecords++;
+    m_stats.m_nRawBytes += nSize;
+    m_stats.m_nStoredBytes += rec.m_data.size();
+    m_stats.m_nMemoryBytes += rec.m_data.size();
+    if (bQueue)
+      m_stats.m_nPending++;
+    enforceLimits();
+  }
+  if (bQueue)
+    m_pQueue->addEntryPoint(&m_compressor, (OdApcParamType)nId);
+  timer.getTimer()->stop();
+  const double pushTime = timer.getTimer()->countedSec();
+  TD_AUTOLOCK(m_mutex);
+  m_stats.m_nPushes++;
+  m_stats.m_pushTime += pushTime;
+  m_stats.m_maxPushTime = odmax(m_stats.m_maxPushTime, pushTime);
+}
+
+OdUInt32 ExUndoRecordStore::pop(OdStreamBuf *pStream)
+{
+  OdPerfTimerWrapper timer;
+  timer.getTimer()->start();
+  OdBinaryData data;
+  OdUInt32 opt, nRawSize;
+  bool bPacked;
+  {
+    TD_AUTOLOCK(m_mutex);
+    if (m_records.empty())
+      throw OdError(eEndOfFile);
+    RecordMap::iterator it = m_records.end(); --it;
+    const Record &rec = it->second;
+    opt = rec.m_options;
+    nRawSize = rec.m_nRawSize;
+    bPacked = rec.m_bPacked;
+    if (rec.m_state == kSpilled)
+      readSpilled(rec, data);
+    else
+      data = rec.m_data;
+    eraseRecord(it);
+  }
+  if (bPacked)
+  {
+    OdBinaryData rawData;
+    rawData.resize(nRawSize);
+    if (!exUndoLzDecompress(data.getPtr(), data.size(), rawData.asArrayPtr(), nRawSize))
+      throw OdError(eFileInternalErr);
+    data = rawData;
+  }
+  if (nRawSize)
+    pStream->putBytes(data.getPtr(), nRawSize);
+  timer.getTimer()->stop();
+  const double popTime = timer.getTimer()->countedSec();
+  TD_AUTOLOCK(m_mutex);
+  m_stats.m_nPops++;
+  m_stats.m_popTime += popTime;
+  m_stats.m_maxPopTime = odmax(m_stats.m_maxPopTime, popTime);
+  return opt;
+}
+
+bool ExUndoRecordStore::hasData() const
+{
+  TD_AUTOLOCK(m_mutex);
+  return !m_records.empty();
+}
+
+OdUInt32 ExUndoRecordStore::numRecords() const
+{
+  TD_AUTOLOCK(m_mutex);
+  return (OdUInt32)m_records.size();
+}
+
+class ExUndoRecordStoreRecord : public OdDbUndoControllerRecord
+{
+public:
+  OdUInt32 m_options;
+  OdUInt32 options() const
+  {
+    return m_options;
+  }
+};
+
+class ExUndoRecordStoreIterator : public OdRxIterator
+{
+public:
+  OdUInt32Array m_options; // Snapshot of record options, the last record first
+  OdUInt32      m_nCurrent;
+
+  bool done() const
+  {
+    return (m_nCurrent >= m_options.size());
+  }
+  bool next()
+  {
+    if(done())
+      return false;
+    ++m_nCurrent;
+    return !done();
+  }
+  OdRxObjectPtr object() const
+  {
+    if(done())
+      throw OdError(eIteratorDone);
+    OdSmartPtr<ExUndoRecordStoreRecord> pRec =
+      OdRxObjectImpl<ExUndoRecordStoreRecord>::createObject();
+    pRec->m_options = m_options[m_nCurrent];
+    return pRec.get();
+  }
+};
+
+OdRxIteratorPtr ExUndoRecordStore::newRecordStackIterator() const
+{
+  OdSmartPtr<ExUndoRecordStoreIterator> pIter =
+    OdRxObjectImpl<ExUndoRecordStoreIterator>::createObject();
+  pIter->m_nCurrent = 0;
+  TD_AUTOLOCK(m_mutex);
+  pIter->m_options.reserve((OdUInt32)m_records.size());
+  for (RecordMap::const_reverse_iterator it = m_records.rbegin(); it != m_records.rend(); ++it)
+    pIter->m_options.push_back(it->second.m_options);
+  return pIter;
+}
+
+void ExUndoRecordStore::clear()
+{
+  TD_AUTOLOCK(m_mutex);
+  // Queued compression requests will not find erased records
+  m_records.clear();
+  m_segments.clear();
+  m_nSpillCursor = m_nNextId;
+  m_nWriteSegment = 0xFFFFFFFF;
+  m_stats.m_nRecords = m_stats.m_nPending = m_stats.m_nSpilled = m_stats.m_nSegments = 0;
+  m_stats.m_nRawBytes = m_stats.m_nStoredBytes = m_stats.m_nMemoryBytes = m_stats.m_nSpilledBytes = 0;
+}
+
+void ExUndoRecordStore::flush()
+{
+  if (!m_pQueue.isNull())
+    m_pQueue->wait();
+}
+
+ExUndoRecordStore::Stats ExUndoRecordStore::stats() const
+{
+  TD_AUTOLOCK(m_mutex);
+  return m_stats;
+}
+
+void ExUndoRecordStore::resetTimings()
+{
+  TD_AUTOLOCK(m_mutex);
+  m_stats.m_nEvicted = m_stats.m_nPushes = m_stats.m_nPops = 0;
+  m_stats.m_pushTime = m_stats.m_popTime = m_stats.m_maxPushTime = m_stats.m_maxPopTime = 0.0;
+}
@@ -0,0 +1,231 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _EX_UNDORECORDSTORE_H_
+#define _EX_UNDORECORDSTORE_H_
+
+#include "TD_PackPush.h"
+#include "RxObject.h"
+#include "RxIterator.h"
+#include "OdStreamBuf.h"
+#include "OdBinaryData.h"
+#include "OdMutex.h"
+#include "StaticRxObject.h"
+#include "RxThreadPoolService.h"
+#define STL_USING_MAP
+#include "OdaSTL.h"
+
+class ExUndoRecordStore;
+
+/** \details
+  Compresses undo records pushed into ExUndoRecordStore in the background thread.
+
+  <group ExServices_Classes> Library: Source provided.
+*/
+class ExUndoRecordCompressor : public OdApcAtom
+{
+  public:
+    ExUndoRecordStore *m_pStore;
+
+    ExUndoRecordCompressor() : m_pStore(NULL) { }
+    void apcEntryPoint(OdApcParamType nRecordId);
+};
+
+/** \details
+  This class implements memory budgeted storage for undo records, which can be shared by
+  ExUndoController and ExFileUndoController.
+
+  \remarks
+  Records are compressed by LZ4 block format compatible compressor in the background thread
+  (synchronously if thread pool module isn't loaded). If memory occupied by records exceeds
+  memory limit, the oldest records are spilled into segmented temporary files. Each segment
+  file is released as soon as all records written into it are popped or evicted. If total size
+  of the stored records or number of records exceeds the limits, the oldest records are evicted.
+
+  <group ExServices_Classes> Library: Source provided.
+*/
+class ExUndoRecordStore : public OdRxObject
+{
+  public:
+    enum Flags
+    {
+      kCompress              = 1, // Compress records
+      kBackgroundCompression = 2, // Compress records in the background thread
+      kSpillToDisk           = 4, // Spill records which exceed memory limit into temporary files
+      kDefaultFlags          = kCompress | kBackgroundCompression | kSpillToDisk
+    };
+    // Usage statistics
+    struct Stats
+    {
+      OdUInt32 m_nRecords;      // Number of stored records
+      OdUInt32 m_nPending;      // Records waiting for compression
+      OdUInt32 m_nSpilled;      // Records spilled into temporary files
+      OdUInt32 m_nSegments;     // Opened temporary file segments
+      OdUInt64 m_nRawBytes;     // Uncompressed size of stored records
+      OdUInt64 m_nStoredBytes;  // Size of stored records (in memory and spilled)
+      OdUInt64 m_nMemoryBytes;  // Size of records kept in memory
+      OdUInt64 m_nSpilledBytes; // Size of records kept in temporary files
+      OdUInt64 m_nEvicted;      // Number of evicted records
+      OdUInt64 m_nPushes;
+      OdUInt64 m_nPops;
+      double   m_pushTime;      // Total push time (in seconds)
+      double   m_popTime;       // Total pop time (in seconds)
+      double   m_maxPushTime;
+      double   m_maxPopTime;
+
+      Stats() : m_nRecords(0), m_nPending(0), m_nSpilled(0), m_nSegments(0), m_nRawBytes(0), m_nStoredBytes(0)
+              , m_nMemoryBytes(0), m_nSpilledBytes(0), m_nEvicted(0), m_nPushes(0), m_nPops(0)
+              , m_pushTime(0.0), m_popTime(0.0), m_maxPushTime(0.0), m_maxPopTime(0.0) { }
+
+      double compressionRatio() const { return m_nStoredBytes ? double(m_nRawBytes) / double(m_nStoredBytes) : 1.0; }
+      double averagePushTime() const { return m_nPushes ? m_pushTime / double(m_nPushes) : 0.0; }
+      double averagePopTime() const { return m_nPops ? m_popTime / double(m_nPops) : 0.0; }
+    };
+  protected:
+    enum RecordState
+    {
+      kInMemory = 0, // Data kept in memory
+      kPending,      // Uncompressed data kept in memory, compression is queued
+      kSpilled       // Data kept in temporary file segment
+    };
+    struct Record
+    {
+      OdUInt32     m_options;
+      OdUInt32     m_nRawSize;
+      OdUInt8      m_state;
+      bool         m_bPacked;   // Data is compressed
+      OdBinaryData m_data;      // Data kept in memory
+      OdUInt32     m_nSegment;  // Location of spilled data
+      OdUInt64     m_nOffset;
+      OdUInt32     m_nStoredSize;
+
+      Record() : m_options(0), m_nRawSize(0), m_state(kInMemory), m_bPacked(false), m_nSegment(0), m_nOffset(0), m_nStoredSize(0) { }
+    };
+    typedef std::map<OdUInt64, Record> RecordMap;
+    struct Segment
+    {
+      OdStreamBufPtr m_pFile;
+      OdUInt64       m_nSize;     // Written bytes
+      OdUInt32       m_nRecords;  // Records which are still stored in segment
+
+      Segment() : m_nSize(0), m_nRecords(0) { }
+    };
+    typedef std::map<OdUInt32, Segment> SegmentMap;
+
+    OdUInt32        m_nFlags;
+    OdUInt32        m_nMaxSteps;
+    OdUInt64        m_nMaxMemory;
+    OdUInt64        m_nMaxBytes;
+    OdUInt32        m_nSegmentSize;
+    OdString        m_spillFolder;
+    RecordMap       m_records;
+    OdUInt64        m_nNextId;
+    OdUInt64        m_nSpillCursor; // Records with lesser identifiers are already spilled or popped
+    SegmentMap      m_segments;
+    OdUInt32        m_nNextSegment;
+    OdUInt32        m_nWriteSegment;
+    Stats           m_stats;
+    mutable OdMutex m_mutex;
+    OdApcQueuePtr   m_pQueue;
+    OdStaticRxObject<ExUndoRecordCompressor> m_compressor;
+
+    friend class ExUndoRecordCompressor;
+    void compressRecord(OdUInt64 nRecordId);
+    static bool packData(const OdBinaryData &rawData, OdBinaryData &packedData);
+
+    void eraseRecord(RecordMap::iterator it);
+    void enforceLimits();
+    bool spillRecord(Record &rec);
+    Segment *writeSegment(OdUInt32 nBytes);
+    void readSpilled(const Record &rec, OdBinaryData &data);
+    void releaseSegmentRecord(const Record &rec);
+  public:
+    ExUndoRecordStore();
+    ~ExUndoRecordStore();
+
+    ODRX_USING_HEAP_OPERATORS(OdRxObject);
+
+    /** \details
+      Creates record store.
+      \param nFlags [in]  Combination of Flags.
+      \param pThreadPool [in]  Thread pool used for background compression. If null, thread pool
+      is taken from the loaded thread pool module.
+    */
+    static OdSmartPtr<ExUndoRecordStore> createObject(OdUInt32 nFlags = kDefaultFlags, OdRxThreadPoolService *pThreadPool = NULL);
+
+    /** \details
+      Sets the limits of this record store.
+      \param maxSteps [in]  Maximum number of records.
+      \param maxMemory [in]  Maximum size of records kept in memory (in bytes).
+      \param maxBytes [in]  Maximum size of all stored records, including spilled records (in bytes).
+    */
+    void setLimits(OdUInt32 maxSteps, OdUInt64 maxMemory, OdUInt64 maxBytes);
+    OdUInt32 maxSteps() const { return m_nMaxSteps; }
+    OdUInt64 maxMemory() const { return m_nMaxMemory; }
+    OdUInt64 maxBytes() const { return m_nMaxBytes; }
+
+    /** \details
+      Sets size of temporary file segments (in bytes) and folder for segment files.
+      \param nSegmentSize [in]  Segment size.
+      \param spillFolder [in]  Folder for temporary files. If empty, system temporary folder is used.
+    */
+    void setSpillOptions(OdUInt32 nSegmentSize, const OdString &spillFolder = OdString::kEmpty);
+
+    /** \details
+      Adds the specified number of bytes from the specified StreamBuf object as the last record.
+      \param pStreamBuf [in]  Pointer to the StreamBuf object from which the data are to be read.
+      \param numBytes [in]  Number of bytes to be read.
+      \param opt [in]  Record options.
+    */
+    void push(OdStreamBuf *pStreamBuf, OdUInt32 numBytes, OdUInt32 opt);
+
+    /** \details
+      Writes the last record to the specified StreamBuf object and removes it. Returns record options.
+      \param pStreamBuf [in]  Pointer to the StreamBuf object to which the data are to be written.
+    */
+    OdUInt32 pop(OdStreamBuf *pStreamBuf);
+
+    bool hasData() const;
+    OdUInt32 numRecords() const;
+
+    /** \details
+      Returns iterator through record options, starting from the last record.
+    */
+    OdRxIteratorPtr newRecordStackIterator() const;
+
+    void clear();
+
+    /** \details
+      Waits until all queued records are compressed.
+    */
+    void flush();
+
+    Stats stats() const;
+    void resetTimings();
+};
+
+typedef OdSmartPtr<ExUndoRecordStore> ExUndoRecordStorePtr;
+
+#include "TD_PackPop.h"
+
+#endif // _EX_UNDORECORDSTORE_H_
@@ -0,0 +1,199 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OdaCommon.h"
+#include "OdFileMapping.h"
+#include "RxSystemServices.h"
+
+#if defined(ODA_WINDOWS) && !defined(_WINRT)
+#include <windows.h>
+#define OD_FILEMAPPING_WINDOWS
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define OD_FILEMAPPING_POSIX
+#endif
+
+// Views offsets must be multiple of this value.
+static OdUInt64 odFileMappingGranularity()
+{
+#if defined(OD_FILEMAPPING_WINDOWS)
+  SYSTEM_INFO sysInfo;
+  ::GetSystemInfo(&sysInfo);
+  return sysInfo.dwAllocationGranularity;
+#elif defined(OD_FILEMAPPING_POSIX)
+  const long nPageSize = ::sysconf(_SC_PAGESIZE);
+  return (nPageSize > 0) ? OdUInt64(nPageSize) : OdUInt64(0x10000);
+#else
+  return 8;
+#endif
+}
+
+OdFileMapping::OdFileMapping()
+  : m_nLength(0)
+  , m_handle(0)
+{
+}
+
+OdFileMapping::~OdFileMapping()
+{
+  close();
+}
+
+bool OdFileMapping::open(const OdString &filePath)
+{
+  close();
+#if defined(OD_FILEMAPPING_WINDOWS)
+  HANDLE hFile = ::CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+  LARGE_INTEGER fileSize;
+  if (!::GetFileSizeEx(hFile, &fileSize) || (fileSize.QuadPart <= 0))
+  {
+    ::CloseHandle(hFile);
+    return false;
+  }
+  HANDLE hMap = ::CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+  ::CloseHandle(hFile); // Mapping object holds reference to the file
+  if (!hMap)
+    return false;
+  m_handle = (OdIntPtr)hMap;
+  m_nLength = (OdUInt64)fileSize.QuadPart;
+#elif defined(OD_FILEMAPPING_POSIX)
+  const int fd = ::open(OdAnsiString(filePath, CP_UTF_8).c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat fileStat;
+  if ((::fstat(fd, &fileStat) != 0) || (fileStat.st_size <= 0))
+  {
+    ::close(fd);
+    return false;
+  }
+  m_handle = (OdIntPtr)fd;
+  m_nLength = (OdUInt64)fileStat.st_size;
+#else
+  if (!::odrxSystemServices()->accessFile(filePath, Oda::kFileRead))
+    return false;
+  try
+  {
+    m_pStream = ::odrxSystemServices()->createFile(filePath, Oda::kFileRead, Oda::kShareDenyWrite, Oda::kOpenExisting);
+  }
+  catch (const OdError &)
+  {
+    return false;
+  }
+  m_nLength = m_pStream->length();
+  if (!m_nLength)
+  {
+    m_pStream.release();
+    return false;
+  }
+#endif
+  m_filePath = filePath;
+  return true;
+}
+
+void OdFileMapping::close()
+{
+#if defined(OD_FILEMAPPING_WINDOWS)
+  if (m_handle)
+    ::CloseHandle((HANDLE)m_handle);
+#elif defined(OD_FILEMAPPING_POSIX)
+  if (m_handle)
+    ::close((int)m_handle);
+#endif
+  m_handle = 0;
+  m_pStream.release();
+  m_nLength = 0;
+  m_filePath.empty();
+}
+
+bool OdFileMapping::map(View &view, OdUInt64 nOffset, OdUInt64 nSize) const
+{
+  ODA_ASSERT(view.isNull());
+  if (nOffset >= m_nLength)
+    return false;
+  nSize = odmin(nSize, m_nLength - nOffset);
+  if ((sizeof(void*) < 8) && (nSize > 0x7FFFFFFF))
+    return false; // Can't be addressed
+  const OdUInt64 nBaseOffset = nOffset - nOffset % ::odFileMappingGranularity();
+  const OdUInt64 nBaseSize = nSize + (nOffset - nBaseOffset);
+#if defined(OD_FILEMAPPING_WINDOWS)
+  void *pBase = ::MapViewOfFile((HANDLE)m_handle, FILE_MAP_READ, DWORD(nBaseOffset >> 32), DWORD(nBaseOffset & 0xFFFFFFFF), (SIZE_T)nBaseSize);
+  if (!pBase)
+    return false;
+  view.m_pBase = pBase;
+  view.m_pData = (const OdUInt8*)pBase + (nOffset - nBaseOffset);
+#elif defined(OD_FILEMAPPING_POSIX)
+  void *pBase = ::mmap(NULL, (size_t)nBaseSize, PROT_READ, MAP_SHARED, (int)m_handle, (off_t)nBaseOffset);
+  if (pBase == MAP_FAILED)
+    return false;
+  view.m_pBase = pBase;
+  view.m_pData = (const OdUInt8*)pBase + (nOffset - nBaseOffset);
+#else
+  // Platform doesn't support memory mapping, so read the region
+  if ((nSize > 0xFFFFFFFF) || !m_pStream.get())
+    return false;
+  view.m_fallbackData.resize((OdUInt32)((nSize + 7) / 8));
+  try
+  {
+    m_pStream->seek((OdInt64)nOffset, OdDb::kSeekFromStart);
+    m_pStream->getBytes(view.m_fallbackData.asArrayPtr(), (OdUInt32)nSize);
+  }
+  catch (const OdError &)
+  {
+    view.m_fallbackData.clear();
+    return false;
+  }
+  view.m_pData = (const OdUInt8*)view.m_fallbackData.getPtr();
+#endif
+  view.m_nSize = nSize;
+  view.m_nBase = nBaseSize;
+  return true;
+}
+
+void OdFileMapping::unmap(View &view)
+{
+#if defined(OD_FILEMAPPING_WINDOWS)
+  if (view.m_pBase)
+    ::UnmapViewOfFile(view.m_pBase);
+#elif defined(OD_FILEMAPPING_POSIX)
+  if (view.m_pBase)
+    ::munmap(view.m_pBase, (size_t)view.m_nBase);
+#endif
+  view.m_fallbackData.clear();
+  view.m_pData = NULL;
+  view.m_nSize = 0;
+  view.m_pBase = NULL;
+  view.m_nBase = 0;
+}
+
+bool OdFileMapping::mapFile(const OdString &filePath, View &view)
+{
+  OdFileMapping file;
+  // Views stay valid after the file is closed
+  return file.open(filePath) && file.map(view);
+}
@@ -0,0 +1,123 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _OD_FILEMAPPING_H_INCLUDED_
+#define _OD_FILEMAPPING_H_INCLUDED_
+
+#include "TD_PackPush.h"
+#include "OdaCommon.h"
+#include "OdString.h"
+#include "OdStreamBuf.h"
+#include "OdArray.h"
+
+/** \details
+    This class provides read only memory mapping of file regions.
+
+    Views are mapped by MapViewOfFile on Windows and by mmap on POSIX systems. On other
+    platforms view data is read into memory buffer, so clients access mapped data in the
+    same way everywhere. View data is 8-byte aligned if the view offset is 8-byte aligned.
+
+    Mapping of views from concurrent threads must be synchronized by the client.
+
+    <group ExServices_Classes>
+    Library: Source code provided.
+*/
+class OdFileMapping
+{
+public:
+  /** \details
+      Mapped file region. Views are plain copyable records which are unmapped explicitly
+      by OdFileMapping::unmap().
+  */
+  struct View
+  {
+    const OdUInt8 *m_pData;  // First byte of requested region
+    OdUInt64       m_nSize;  // Size of requested region
+    void          *m_pBase;  // Start of the system view (region offset is aligned down to page granularity)
+    OdUInt64       m_nBase;  // Size of the system view
+    OdArray<OdUInt64, OdMemoryAllocator<OdUInt64> > m_fallbackData; // Used if platform doesn't support memory mapping
+
+    View() : m_pData(NULL), m_nSize(0), m_pBase(NULL), m_nBase(0) { }
+
+    const OdUInt8 *data() const { return m_pData; }
+    OdUInt64 size() const { return m_nSize; }
+    bool isNull() const { return m_pData == NULL; }
+  };
+protected:
+  OdString       m_filePath;
+  OdUInt64       m_nLength;
+  OdIntPtr       m_handle;  // File mapping object on Windows, file descriptor on POSIX systems
+  OdStreamBufPtr m_pStream; // Used if platform doesn't support memory mapping
+private:
+  OdFileMapping(const OdFileMapping&);
+  OdFileMapping &operator =(const OdFileMapping&);
+public:
+  OdFileMapping();
+  ~OdFileMapping();
+
+  /** \details
+      Opens existing file for mapping. File stays shared for reading and deleting.
+      \returns
+      Returns false if file can't be opened or is empty.
+  */
+  bool open(const OdString &filePath);
+  /** \details
+      Closes the file. Views which are already mapped stay valid until unmapped.
+  */
+  void close();
+  /** \details
+      Returns true if file is opened.
+  */
+  bool isOpen() const { return m_nLength != 0; }
+  /** \details
+      Returns file length in bytes.
+  */
+  OdUInt64 length() const { return m_nLength; }
+  /** \details
+      Returns file path.
+  */
+  const OdString &filePath() const { return m_filePath; }
+
+  /** \details
+      Maps file region. Region is clamped by file length.
+      \param view [out]  Receives mapped region. Previous contents of the view must be unmapped.
+      \param nOffset [in]  Region offset in bytes, doesn't require any alignment.
+      \param nSize [in]  Region size in bytes. By default region continues up to the end of file.
+      \returns
+      Returns false if region is empty or can't be mapped.
+  */
+  bool map(View &view, OdUInt64 nOffset = 0, OdUInt64 nSize = OdUInt64(-1)) const;
+  /** \details
+      Unmaps view mapped by any OdFileMapping object and resets it.
+  */
+  static void unmap(View &view);
+
+  /** \details
+      Maps whole file into the specified view. File isn't kept opened.
+  */
+  static bool mapFile(const OdString &filePath, View &view);
+};
+
+#include "TD_PackPop.h"
+
+#endif // _OD_FILEMAPPING_H_INCLUDED_
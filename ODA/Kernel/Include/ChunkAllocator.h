@@ -26,6 +26,8 @@
 
 #include "RootExport.h"
 #include "RxObjectImpl.h"
+#include "OdMutex.h"
+#include <new>
 
 #include "TD_PackPush.h"
 
@@ -149,6 +151,362 @@ class AllocatorArrayML : public AllocatorArray
 #define ODCA_HEAP_ALLOCATOR_UNINIT(baseClass) \
   baseClass::s_aAlloc.uninit()
 
+// Arena allocator for transient objects
+
+#if defined(TD_SINGLE_THREAD)
+#define ODCA_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define ODCA_THREAD_LOCAL __declspec(thread)
+#else
+#define ODCA_THREAD_LOCAL __thread
+#endif
+
+/** \details
+    Allocator which serves allocations by advancing a pointer inside of large
+    chunks of memory. Separate allocations are never freed, reset() releases all
+    allocated memory at once and keeps chunks for reuse, so it is intended for
+    short-living objects, such as objects created during regeneration of single entity.
+
+    \remarks
+    Allocator isn't thread-safe, every thread should use own instance.
+    Allocator could be activated for calling thread by OdArenaAllocatorScope, objects
+    of classes which define ODCA_ARENA_HEAP_OPERATORS() and containers which use
+    OdArenaStlAllocator are allocated from active allocator while scope is alive.
+    Active allocator is tracked per module.
+
+    Chunks count objects allocated by allocObject() with interlocked operations, so
+    such objects may be released by any thread. Chunk which contains alive objects
+    isn't reused by reset() and isn't freed by purge() or destructor, it is freed
+    when its last object is released. So objects which outlive their scope stay valid,
+    debug builds assert on such objects.
+
+    <group Other_Classes> 
+*/
+class OdArenaAllocator : public IAllocator
+{
+public:
+  enum
+  {
+    kDefChunkSize = 64 * 1024, // Allocations larger than quarter of chunk get own block
+    kAlignment    = 16,
+    kMaxAlloc     = 0x7FFFFFFF - 2 * kAlignment // Maximal allocation size
+  };
+  /** \details
+      Allocator counters.
+  */
+  struct Stats
+  {
+    OdUInt64 m_nBytes;        // Bytes served since construction
+    OdUInt64 m_nObjects;      // Allocations served since construction
+    OdUInt64 m_nResets;       // Number of resets
+    OdUInt64 m_nPeakBytes;    // Maximal number of bytes served between resets
+    OdUInt64 m_nChunkBytes;   // Bytes currently allocated for chunks
+    OdUInt32 m_nChunks;       // Number of currently allocated chunks
+    OdUInt32 m_nLeakedChunks; // Chunks given up with alive objects
+  };
+protected:
+  struct Chunk
+  {
+    Chunk*       m_pNext;
+    size_t       m_nSize;
+    OdRefCounter m_nRefs;     // Alive objects plus reference of allocator
+  };
+  enum { kChunkHeader = (sizeof(Chunk) + kAlignment - 1) & ~(kAlignment - 1) };
+
+  Chunk*   m_pFirst;
+  Chunk*   m_pCur;
+  Chunk*   m_pLarge;
+  OdUInt8* m_pPos;
+  OdUInt8* m_pEnd;
+  size_t   m_nChunkSize;
+  OdUInt64 m_nScopeBytes;
+  int      m_nScopes;
+  Stats    m_stats;
+
+  static size_t alignSize(size_t nBytes) { return (nBytes + kAlignment - 1) & ~size_t(kAlignment - 1); }
+  static OdUInt8* chunkData(Chunk* pChunk) { return reinterpret_cast<OdUInt8*>(pChunk) + kChunkHeader; }
+
+  Chunk* newChunk(size_t nSize)
+  {
+    Chunk* pChunk = reinterpret_cast<Chunk*>(::odrxAlloc(kChunkHeader + nSize));
+    if (!pChunk)
+      throw OdError(eOutOfMemory);
+    pChunk->m_pNext = NULL;
+    pChunk->m_nSize = nSize;
+    pChunk->m_nRefs = 1;
+    m_stats.m_nChunks++;
+    m_stats.m_nChunkBytes += kChunkHeader + nSize;
+    return pChunk;
+  }
+  static void releaseChunk(Chunk* pChunk)
+  {
+    if (!--pChunk->m_nRefs)
+      ::odrxFree(pChunk);
+  }
+  // Gives up reference of allocator, chunk with alive objects is freed by its last object
+  void dropChunk(Chunk* pChunk)
+  {
+    m_stats.m_nChunks--;
+    m_stats.m_nChunkBytes -= kChunkHeader + pChunk->m_nSize;
+    if ((int)pChunk->m_nRefs != 1)
+    {
+      ODA_FAIL_ONCE(); // Objects allocated from arena are still alive
+      m_stats.m_nLeakedChunks++;
+    }
+    releaseChunk(pChunk);
+  }
+  void dropChunks(Chunk* pChunk)
+  {
+    while (pChunk)
+    {
+      Chunk* pNext = pChunk->m_pNext;
+      dropChunk(pChunk);
+      pChunk = pNext;
+    }
+  }
+  void setChunk(Chunk* pChunk)
+  {
+    m_pCur = pChunk;
+    m_pPos = pChunk ? chunkData(pChunk) : NULL;
+    m_pEnd = pChunk ? m_pPos + pChunk->m_nSize : NULL;
+  }
+  void* allocIn(size_t nBytes, Chunk*& pChunk)
+  {
+    if (nBytes > size_t(kMaxAlloc))
+      throw OdError(eOutOfMemory);
+    const size_t nSize = alignSize(nBytes ? nBytes : 1);
+    m_stats.m_nObjects++;
+    m_stats.m_nBytes += nSize;
+    m_nScopeBytes += nSize;
+    if (m_nScopeBytes > m_stats.m_nPeakBytes)
+      m_stats.m_nPeakBytes = m_nScopeBytes;
+    if (nSize > m_nChunkSize / 4)
+    {
+      pChunk = newChunk(nSize);
+      pChunk->m_pNext = m_pLarge;
+      m_pLarge = pChunk;
+      return chunkData(pChunk);
+    }
+    if (size_t(m_pEnd - m_pPos) < nSize)
+    {
+      if (!m_pCur)
+        setChunk(m_pFirst = newChunk(m_nChunkSize));
+      else if (m_pCur->m_pNext)
+        setChunk(m_pCur->m_pNext);
+      else
+        setChunk(m_pCur->m_pNext = newChunk(m_nChunkSize));
+    }
+    pChunk = m_pCur;
+    void* pMem = m_pPos;
+    m_pPos += nSize;
+    return pMem;
+  }
+  static OdArenaAllocator*& currentRef()
+  {
+    static ODCA_THREAD_LOCAL OdArenaAllocator* s_pCurrent = NULL;
+    return s_pCurrent;
+  }
+public:
+  /** \details
+      Constructor. Memory is allocated on the first allocation.
+      \param nChunkSize [in]  Size of memory chunks.
+  */
+  OdArenaAllocator(size_t nChunkSize = kDefChunkSize)
+    : m_pFirst(NULL), m_pCur(NULL), m_pLarge(NULL), m_pPos(NULL), m_pEnd(NULL)
+    , m_nChunkSize(alignSize(odmin(nChunkSize, size_t(kMaxAlloc)))), m_nScopeBytes(0), m_nScopes(0)
+  {
+    ::memset(&m_stats, 0, sizeof(Stats));
+  }
+  ~OdArenaAllocator()
+  {
+    ODA_ASSERT(!m_nScopes);
+    purge();
+  }
+
+  /** \details
+      Allocates memory aligned by kAlignment bytes.
+      \param nBytes [in]  Number of bytes.
+  */
+  void* alloc(int nBytes)
+  {
+    Chunk* pChunk;
+    return allocIn(nBytes > 0 ? size_t(nBytes) : 0, pChunk);
+  }
+
+  /** \details
+      Does nothing, memory is released by reset().
+  */
+  void release(void* /*p*/) { }
+
+#ifdef _DEBUG
+  int numChunks() { return (int)m_stats.m_nChunks; }
+#endif
+
+  /** \details
+      Releases all allocations. Chunks are kept for following allocations,
+      blocks of large allocations are freed. Chunks which contain alive objects
+      aren't reused.
+  */
+  void reset()
+  {
+    dropChunks(m_pLarge);
+    m_pLarge = NULL;
+    for (Chunk** ppChunk = &m_pFirst; *ppChunk; )
+    {
+      Chunk* pChunk = *ppChunk;
+      if ((int)pChunk->m_nRefs != 1)
+      {
+        *ppChunk = pChunk->m_pNext;
+        dropChunk(pChunk);
+      }
+      else
+        ppChunk = &pChunk->m_pNext;
+    }
+    setChunk(m_pFirst);
+    m_nScopeBytes = 0;
+    m_stats.m_nResets++;
+  }
+
+  /** \details
+      Releases all allocations and frees all chunks.
+  */
+  void purge()
+  {
+    dropChunks(m_pLarge);
+    dropChunks(m_pFirst);
+    m_pFirst = m_pLarge = NULL;
+    setChunk(NULL);
+    m_nScopeBytes = 0;
+  }
+
+  /** \details
+      Returns number of bytes served since last reset.
+  */
+  OdUInt64 bytesInUse() const { return m_nScopeBytes; }
+
+  /** \details
+      Returns allocator counters.
+  */
+  const Stats& stats() const { return m_stats; }
+
+  /** \details
+      Returns allocator which is active for calling thread or NULL.
+  */
+  static OdArenaAllocator* current() { return currentRef(); }
+
+  /** \details
+      Allocates object memory from allocator active for calling thread, or by
+      odrxAlloc() if there is no active allocator.
+      \param nBytes [in]  Object size.
+  */
+  static void* allocObject(size_t nBytes)
+  {
+    if (nBytes > size_t(kMaxAlloc) - kAlignment)
+      throw OdError(eOutOfMemory);
+    OdArenaAllocator* pArena = current();
+    Chunk* pChunk = NULL;
+    void** pHeader = reinterpret_cast<void**>(pArena ? pArena->allocIn(nBytes + kAlignment, pChunk) : ::odrxAlloc(nBytes + kAlignment));
+    if (!pHeader)
+      throw OdError(eOutOfMemory);
+    *pHeader = pChunk;
+    if (pChunk)
+      ++pChunk->m_nRefs;
+    return reinterpret_cast<OdUInt8*>(pHeader) + kAlignment;
+  }
+
+  /** \details
+      Releases object memory allocated by allocObject(). May be called by any thread.
+      \param pObject [in]  Object memory.
+  */
+  static void releaseObject(void* pObject)
+  {
+    if (!pObject)
+      return;
+    void** pHeader = reinterpret_cast<void**>(reinterpret_cast<OdUInt8*>(pObject) - kAlignment);
+    Chunk* pChunk = reinterpret_cast<Chunk*>(*pHeader);
+    if (pChunk)
+      releaseChunk(pChunk);
+    else
+      ::odrxFree(pHeader);
+  }
+
+  friend class OdArenaAllocatorScope;
+};
+
+/** \details
+    Activates arena allocator for calling thread during the lifetime of scope
+    object. When the outermost scope of allocator ends, allocator is reset, so
+    all objects allocated from it should be destroyed before.
+
+    <group Other_Classes> 
+*/
+class OdArenaAllocatorScope
+{
+  OdArenaAllocator& m_arena;
+  OdArenaAllocator* m_pPrev;
+
+  OdArenaAllocatorScope& operator = (const OdArenaAllocatorScope&);
+public:
+  OdArenaAllocatorScope(OdArenaAllocator& arena)
+    : m_arena(arena)
+    , m_pPrev(OdArenaAllocator::currentRef())
+  {
+    OdArenaAllocator::currentRef() = &arena;
+    arena.m_nScopes++;
+  }
+  ~OdArenaAllocatorScope()
+  {
+    OdArenaAllocator::currentRef() = m_pPrev;
+    if (!--m_arena.m_nScopes)
+      m_arena.reset();
+  }
+};
+
+// Allocates class objects from active arena allocator
+
+#define ODCA_ARENA_HEAP_OPERATORS() \
+  void* operator new(size_t size) { return OdArenaAllocator::allocObject(size); } \
+  void  operator delete(void* p) { OdArenaAllocator::releaseObject(p); }
+
+/** \details
+    STL allocator which allocates container elements from arena allocator active for
+    calling thread (see OdArenaAllocator::allocObject()).
+
+    <group Other_Classes> 
+*/
+template <class T>
+class OdArenaStlAllocator
+{
+public:
+  typedef T         value_type;
+  typedef T*        pointer;
+  typedef const T*  const_pointer;
+  typedef T&        reference;
+  typedef const T&  const_reference;
+  typedef size_t    size_type;
+  typedef ptrdiff_t difference_type;
+  template <class U> struct rebind { typedef OdArenaStlAllocator<U> other; };
+
+  OdArenaStlAllocator() { }
+  template <class U> OdArenaStlAllocator(const OdArenaStlAllocator<U>&) { }
+
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+  size_type max_size() const { return size_type(OdArenaAllocator::kMaxAlloc - OdArenaAllocator::kAlignment) / sizeof(T); }
+  pointer allocate(size_type n, const void* = 0)
+  {
+    if (n > max_size())
+      throw OdError(eOutOfMemory);
+    return static_cast<pointer>(OdArenaAllocator::allocObject(n * sizeof(T)));
+  }
+  void deallocate(pointer p, size_type) { OdArenaAllocator::releaseObject(p); }
+  void construct(pointer p, const T& val) { ::new(static_cast<void*>(p)) T(val); }
+  void destroy(pointer p) { p->~T(); }
+
+  bool operator ==(const OdArenaStlAllocator&) const { return true; }
+  bool operator !=(const OdArenaStlAllocator&) const { return false; }
+};
+
 /** \details
     <group Other_Classes> 
 */
@@ -0,0 +1,849 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef OD_GETRLODSIMPLIFICATION_H
+#define OD_GETRLODSIMPLIFICATION_H
+
+#include "Ge/GeTrMeshSimplification.h"
+#include "RxThreadPoolService.h"
+#include "DynamicLinker.h"
+#include "StaticRxObject.h"
+#include "OdMutex.h"
+#define STL_USING_ALGORITHM
+#define STL_USING_VECTOR
+#define STL_USING_QUEUE
+#include "OdaSTL.h"
+#include <math.h>
+
+namespace GeMesh
+{
+
+/** \details
+    Multi-level edge collapse simplification of triangle meshes with quadric error metric.
+
+    GeTrngSimplification::algo() produces a single simplification level per call. buildLevels()
+    runs one edge collapse sequence over the source mesh and takes a snapshot of the mesh each
+    time one of the requested triangle counts is reached, so coarse levels reuse all collapses
+    done for finer ones. buildLevelsParallel() splits very large meshes into spatial grid cells,
+    locks vertices shared by several cells and simplifies cells by thread pool threads. Seams
+    kept by the locked vertices are finished by a short serial pass over every merged level.
+
+    Output meshes contain vertices, vertex tags and triangles with face tags. Neighbor links
+    aren't filled, call OdGeTrMesh::fillNbLinks() if they are required.
+*/
+class GeTrngLodSimplification
+{
+public:
+    GeTrngLodSimplification()
+      : m_nLiveTr(0)
+      , m_bPreserveBorders(false)
+      , m_maxError2(-1.0)
+    {
+    }
+
+    /** \details
+      Enables locking of the open mesh border vertices. By default borders are kept
+      by penalty planes only and may be simplified.
+    */
+    void setPreserveBorders(bool bPreserve) { m_bPreserveBorders = bPreserve; }
+    bool preserveBorders() const { return m_bPreserveBorders; }
+
+    /** \details
+      Sets maximal quadric error (distance) of single collapse. Simplification stops
+      before collapse exceeding this error, so coarse levels may keep more triangles
+      than requested. Non-positive value disables the limit.
+    */
+    void setMaxError(double maxError) { m_maxError2 = (maxError > 0.0) ? maxError * maxError : -1.0; }
+
+    /** \details
+      Prepares simplification of specified mesh. Vertices flagged by nonzero pLockedVx
+      values (array of mesh.m_aVx size) are never moved or removed.
+    */
+    void reset(const OdGeTrMesh& mesh, const OdUInt8* pLockedVx = NULL)
+    {
+      const int nVx = (int)mesh.m_aVx.size(), nTr = (int)mesh.m_aTr.size();
+      m_vx.assign(mesh.m_aVx.asArrayPtr(), mesh.m_aVx.asArrayPtr() + nVx);
+      if ((int)mesh.m_aVxTag.size() == nVx)
+        m_vxTag.assign(mesh.m_aVxTag.asArrayPtr(), mesh.m_aVxTag.asArrayPtr() + nVx);
+      else
+        m_vxTag.clear();
+      m_Q.assign(nVx, Quadric());
+      m_stamp.assign(nVx, 0);
+      m_flags.assign(nVx, 0);
+      m_vxToTr.assign(nVx, std::vector<int>());
+      m_tr.resize(nTr);
+      m_trTag.resize(nTr);
+      m_nLiveTr = 0;
+      m_heap = std::priority_queue<Candidate>();
+      if (pLockedVx)
+      {
+        for (int v = 0; v < nVx; ++v)
+          if (pLockedVx[v])
+            m_flags[v] |= kLocked;
+      }
+      // Triangles and face quadrics
+      for (int t = 0; t < nTr; ++t)
+      {
+        const OdGeTr& tr = mesh.m_aTr[t];
+        m_tr[t] = tr.tr;
+        m_trTag[t] = tr.tagFace;
+        if (tr.tr[0] < 0 || tr.tr[0] >= nVx || tr.tr[1] < 0 || tr.tr[1] >= nVx || tr.tr[2] < 0 || tr.tr[2] >= nVx ||
+            tr.tr[0] == tr.tr[1] || tr.tr[1] == tr.tr[2] || tr.tr[0] == tr.tr[2])
+        {
+          m_tr[t][0] = -1;
+          continue;
+        }
+        ++m_nLiveTr;
+        for (int i = 0; i < 3; ++i)
+          m_vxToTr[tr.tr[i]].push_back(t);
+        OdGeVector3d n = (m_vx[tr.tr[1]] - m_vx[tr.tr[0]]).crossProduct(m_vx[tr.tr[2]] - m_vx[tr.tr[0]]);
+        const double len = n.length();
+        if (len < 1e-300)
+          continue;
+        n /= len;
+        Quadric q;
+        q.setPlane(n, -n.dotProduct(m_vx[tr.tr[0]].asVector()), len * 0.5);
+        for (int i = 0; i < 3; ++i)
+          m_Q[tr.tr[i]] += q;
+      }
+      // Edges: borders and face tag boundaries get penalty planes, every edge gets collapse candidate
+      std::vector<EdgeRef> edges;
+      edges.reserve(m_nLiveTr * 3);
+      for (int t = 0; t < nTr; ++t)
+      {
+        if (m_tr[t][0] < 0)
+          continue;
+        for (int i = 0; i < 3; ++i)
+          edges.push_back(EdgeRef(m_tr[t][i], m_tr[t][(i + 1) % 3], t));
+      }
+      std::sort(edges.begin(), edges.end());
+      for (size_t i = 0; i < edges.size(); )
+      {
+        size_t j = i + 1;
+        bool bFeature = false;
+        while (j < edges.size() && edges[j].m_v[0] == edges[i].m_v[0] && edges[j].m_v[1] == edges[i].m_v[1])
+        {
+          if (m_trTag[edges[j].m_tr] != m_trTag[edges[i].m_tr])
+            bFeature = true;
+          ++j;
+        }
+        const int a = edges[i].m_v[0], b = edges[i].m_v[1];
+        if (j - i == 1 || bFeature)
+        {
+          if (j - i == 1)
+          {
+            m_flags[a] |= kBorder;
+            m_flags[b] |= kBorder;
+          }
+          for (size_t k = i; k < j; ++k)
+            addEdgePenalty(a, b, edges[k].m_tr);
+        }
+        i = j;
+      }
+      if (m_bPreserveBorders)
+      {
+        for (int v = 0; v < nVx; ++v)
+          if (m_flags[v] & kBorder)
+            m_flags[v] |= kLocked;
+      }
+      for (size_t i = 0; i < edges.size(); ++i)
+      {
+        if (i && edges[i].m_v[0] == edges[i - 1].m_v[0] && edges[i].m_v[1] == edges[i - 1].m_v[1])
+          continue;
+        pushCandidate(edges[i].m_v[0], edges[i].m_v[1]);
+      }
+    }
+
+    /** \details
+      Number of triangles left in the current state of simplification.
+    */
+    int numTriangles() const { return m_nLiveTr; }
+
+    /** \details
+      Simplifies mesh passed to reset() and returns level meshes for each requested
+      simplification percent (percent of the source triangles to remove, 0..100) in the
+      order of pPercents array. All levels are produced by a single edge collapse run.
+      Returns false if there is nothing to simplify.
+    */
+    bool buildLevels(const double* pPercents, unsigned nLevels, OdArray<OdGeTrMesh>& levels)
+    {
+      std::vector<int> targets(nLevels);
+      for (unsigned i = 0; i < nLevels; ++i)
+        targets[i] = targetTriangles(m_nLiveTr, pPercents[i]);
+      return buildLevelsImpl(nLevels ? &targets[0] : NULL, nLevels, levels, NULL);
+    }
+
+    /** \details
+      Builds simplification levels for specified mesh (see buildLevels()). Meshes with more
+      than kMinPartitionTriangles triangles per thread pool CPU are split into nPartitions
+      spatial cells (0 - chosen automatically) simplified in parallel with locked cell
+      boundaries. If bFinishSeams is set, every merged level is additionally simplified with
+      unlocked cell boundaries to reach requested triangles count.
+    */
+    static bool buildLevelsParallel(const OdGeTrMesh& mesh, const double* pPercents, unsigned nLevels,
+                                    OdArray<OdGeTrMesh>& levels, unsigned nPartitions = 0,
+                                    bool bPreserveBorders = false, bool bFinishSeams = true)
+    {
+      const int nTr = (int)mesh.m_aTr.size(), nVx = (int)mesh.m_aVx.size();
+      OdRxThreadPoolServicePtr pThreadPool;
+      if (nTr >= 2 * kMinPartitionTriangles)
+        pThreadPool = ::odrxDynamicLinker()->getModule(OdThreadPoolModuleName);
+      const unsigned nCPUs = pThreadPool.isNull() ? 1 : (unsigned)pThreadPool->numCPUs();
+      if (!nPartitions)
+        nPartitions = odmin(nCPUs * 2, unsigned(nTr / kMinPartitionTriangles));
+      if (pThreadPool.isNull() || (nCPUs < 2) || (nPartitions < 2) || !nLevels)
+      {
+        GeTrngLodSimplification simp;
+        simp.setPreserveBorders(bPreserveBorders);
+        simp.reset(mesh);
+        return simp.buildLevels(pPercents, nLevels, levels);
+      }
+      // Spatial grid: split longest cell side until number of partitions is reached
+      OdGeExtents3d ext;
+      for (int v = 0; v < nVx; ++v)
+        ext.addPoint(mesh.m_aVx[v]);
+      const OdGeVector3d size = ext.maxPoint() - ext.minPoint();
+      int nDiv[3] = { 1, 1, 1 };
+      while (unsigned(nDiv[0] * nDiv[1] * nDiv[2] * 2) <= nPartitions)
+      {
+        int iAxis = 0;
+        for (int i = 1; i < 3; ++i)
+          if (size[i] / nDiv[i] > size[iAxis] / nDiv[iAxis])
+            iAxis = i;
+        nDiv[iAxis] *= 2;
+      }
+      nPartitions = nDiv[0] * nDiv[1] * nDiv[2];
+      // Assign triangles to cells by centroid, vertices used by several cells are locked
+      std::vector<int> trCell(nTr), vxCell(nVx, -1);
+      std::vector<int> cellTrCount(nPartitions, 0);
+      for (int t = 0; t < nTr; ++t)
+      {
+        const int3& tr = mesh.m_aTr[t].tr;
+        const OdGePoint3d &p0 = mesh.m_aVx[tr[0]], &p1 = mesh.m_aVx[tr[1]], &p2 = mesh.m_aVx[tr[2]];
+        const OdGePoint3d c((p0.x + p1.x + p2.x) / 3.0, (p0.y + p1.y + p2.y) / 3.0, (p0.z + p1.z + p2.z) / 3.0);
+        int nCell = 0;
+        for (int i = 2; i >= 0; --i)
+        {
+          int k = (size[i] > 0.0) ? int((c[i] - ext.minPoint()[i]) / size[i] * nDiv[i]) : 0;
+          nCell = nCell * nDiv[i] + odmax(0, odmin(k, nDiv[i] - 1));
+        }
+        trCell[t] = nCell;
+        ++cellTrCount[nCell];
+        for (int i = 0; i < 3; ++i)
+        {
+          int& vc = vxCell[tr[i]];
+          if (vc == -1)
+            vc = nCell;
+          else if (vc != nCell)
+            vc = -2;
+        }
+      }
+      std::vector<Partition> parts(nPartitions);
+      {
+        std::vector<std::vector<int> > cellTr(nPartitions);
+        for (unsigned p = 0; p < nPartitions; ++p)
+          cellTr[p].reserve(cellTrCount[p]);
+        for (int t = 0; t < nTr; ++t)
+          cellTr[trCell[t]].push_back(t);
+        std::vector<int> toLocal(nVx, -1);
+        const bool bVxTags = (int)mesh.m_aVxTag.size() == nVx;
+        for (unsigned p = 0; p < nPartitions; ++p)
+        {
+          Partition& part = parts[p];
+          part.m_mesh.m_aTr.resize((unsigned)cellTr[p].size());
+          for (size_t i = 0; i < cellTr[p].size(); ++i)
+          {
+            const OdGeTr& trSrc = mesh.m_aTr[cellTr[p][i]];
+            OdGeTr& tr = part.m_mesh.m_aTr[(unsigned)i];
+            tr.tagFace = trSrc.tagFace;
+            for (int j = 0; j < 3; ++j)
+            {
+              const int v = trSrc.tr[j];
+              if (toLocal[v] < 0)
+              {
+                toLocal[v] = (int)part.m_toGlobal.size();
+                part.m_toGlobal.push_back(v);
+                part.m_locked.push_back(vxCell[v] == -2);
+              }
+              tr.tr[j] = toLocal[v];
+            }
+          }
+          const unsigned nPartVx = (unsigned)part.m_toGlobal.size();
+          part.m_mesh.m_aVx.resize(nPartVx);
+          if (bVxTags)
+            part.m_mesh.m_aVxTag.resize(nPartVx);
+          for (unsigned i = 0; i < nPartVx; ++i)
+          {
+            const int v = part.m_toGlobal[i];
+            part.m_mesh.m_aVx[i] = mesh.m_aVx[v];
+            if (bVxTags)
+              part.m_mesh.m_aVxTag[i] = mesh.m_aVxTag[v];
+            toLocal[v] = -1;
+          }
+        }
+      }
+      // Simplify cells
+      std::vector<int> targets(nLevels);
+      PartitionJob partJob(parts, pPercents, nLevels, bPreserveBorders);
+      runParallel(pThreadPool, partJob, nPartitions);
+      // Merge cell levels, locked vertices are shared by global index
+      levels.resize(nLevels);
+      std::vector<int> toMerged(nVx, -1);
+      for (unsigned l = 0; l < nLevels; ++l)
+      {
+        OdGeTrMesh& merged = levels[l];
+        merged.clear();
+        targets[l] = targetTriangles(nTr, pPercents[l]);
+        std::vector<int> used;
+        unsigned nLevelVx = 0, nLevelTr = 0;
+        for (unsigned p = 0; p < nPartitions; ++p)
+        {
+          if (parts[p].m_levels.size() > l)
+          {
+            nLevelVx += parts[p].m_levels[l].m_aVx.size();
+            nLevelTr += parts[p].m_levels[l].m_aTr.size();
+          }
+        }
+        merged.m_aVx.reserve(nLevelVx);
+        if ((int)mesh.m_aVxTag.size() == nVx)
+          merged.m_aVxTag.reserve(nLevelVx);
+        merged.m_aTr.reserve(nLevelTr);
+        for (unsigned p = 0; p < nPartitions; ++p)
+        {
+          const Partition& part = parts[p];
+          if (part.m_levels.size() <= l)
+            continue;
+          const OdGeTrMesh& lev = part.m_levels[l];
+          const std::vector<int>& ids = part.m_vxIds[l];
+          std::vector<int> toLevel(lev.m_aVx.size());
+          for (unsigned i = 0; i < lev.m_aVx.size(); ++i)
+          {
+            int& m = toMerged[part.m_toGlobal[ids[i]]];
+            if (m < 0)
+            {
+              m = (int)merged.m_aVx.size();
+              used.push_back(part.m_toGlobal[ids[i]]);
+              merged.m_aVx.push_back(lev.m_aVx[i]);
+              if (!lev.m_aVxTag.isEmpty())
+                merged.m_aVxTag.push_back(lev.m_aVxTag[i]);
+            }
+            toLevel[i] = m;
+          }
+          for (unsigned t = 0; t < lev.m_aTr.size(); ++t)
+          {
+            OdGeTr tr;
+            tr.tagFace = lev.m_aTr[t].tagFace;
+            for (int j = 0; j < 3; ++j)
+              tr.tr[j] = toLevel[lev.m_aTr[t].tr[j]];
+            merged.m_aTr.push_back(tr);
+          }
+        }
+        for (size_t i = 0; i < used.size(); ++i)
+          toMerged[used[i]] = -1;
+      }
+      parts.clear();
+      // Finish seams of merged levels
+      if (bFinishSeams)
+      {
+        SeamJob seamJob(levels, &targets[0], bPreserveBorders);
+        runParallel(pThreadPool, seamJob, nLevels);
+      }
+      return true;
+    }
+
+    /** \details
+      Returns symmetric Hausdorff distance between meshes estimated on vertices: maximum of
+      distances from vertices of each mesh to other mesh computed by OdGeMesh::distanceTo().
+      If nMaxSamples is nonzero, no more than nMaxSamples evenly strided vertices of each mesh
+      are checked.
+    */
+    static double hausdorffDistance(const OdGeMesh& mesh1, const OdGeMesh& mesh2, unsigned nMaxSamples = 0)
+    {
+      return odmax(oneSidedDistance(mesh1, mesh2, nMaxSamples), oneSidedDistance(mesh2, mesh1, nMaxSamples));
+    }
+
+    enum
+    {
+      kMinPartitionTriangles = 50000
+    };
+
+protected:
+    enum VertexFlags
+    {
+      kLocked  = 1,
+      kBorder  = 2,
+      kRemoved = 4
+    };
+
+    // Symmetric 4x4 matrix of plane squared distances sum
+    struct Quadric
+    {
+      double m[10];
+      Quadric() { for (int i = 0; i < 10; ++i) m[i] = 0.0; }
+      void setPlane(const OdGeVector3d& n, double d, double w)
+      {
+        m[0] = w * n.x * n.x; m[1] = w * n.x * n.y; m[2] = w * n.x * n.z; m[3] = w * n.x * d;
+        m[4] = w * n.y * n.y; m[5] = w * n.y * n.z; m[6] = w * n.y * d;
+        m[7] = w * n.z * n.z; m[8] = w * n.z * d;
+        m[9] = w * d * d;
+      }
+      Quadric& operator +=(const Quadric& q) { for (int i = 0; i < 10; ++i) m[i] += q.m[i]; return *this; }
+      double error(const OdGePoint3d& p) const
+      {
+        return m[0] * p.x * p.x + 2.0 * m[1] * p.x * p.y + 2.0 * m[2] * p.x * p.z + 2.0 * m[3] * p.x +
+               m[4] * p.y * p.y + 2.0 * m[5] * p.y * p.z + 2.0 * m[6] * p.y +
+               m[7] * p.z * p.z + 2.0 * m[8] * p.z + m[9];
+      }
+      // Point minimizing error, false if quadric is degenerate
+      bool optimum(OdGePoint3d& p) const
+      {
+        const double c00 = m[4] * m[7] - m[5] * m[5], c01 = m[2] * m[5] - m[1] * m[7], c02 = m[1] * m[5] - m[2] * m[4];
+        const double det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+        const double norm = m[0] + m[4] + m[7];
+        if (fabs(det) <= 1e-12 * norm * norm * norm)
+          return false;
+        const double c11 = m[0] * m[7] - m[2] * m[2], c12 = m[1] * m[2] - m[0] * m[5], c22 = m[0] * m[4] - m[1] * m[1];
+        p.x = -(c00 * m[3] + c01 * m[6] + c02 * m[8]) / det;
+        p.y = -(c01 * m[3] + c11 * m[6] + c12 * m[8]) / det;
+        p.z = -(c02 * m[3] + c12 * m[6] + c22 * m[8]) / det;
+        return true;
+      }
+    };
+
+    // Collapse candidate, becomes stale when stamp of any vertex changes
+    struct Candidate
+    {
+      double m_cost;
+      int m_v[2];
+      OdUInt32 m_stamp[2];
+      OdGePoint3d m_pos;
+      bool operator <(const Candidate& c) const { return m_cost > c.m_cost; }
+    };
+
+    struct EdgeRef
+    {
+      int m_v[2];
+      int m_tr;
+      EdgeRef(int a, int b, int t) : m_tr(t) { m_v[0] = odmin(a, b); m_v[1] = odmax(a, b); }
+      bool operator <(const EdgeRef& e) const
+      {
+        if (m_v[0] != e.m_v[0]) return m_v[0] < e.m_v[0];
+        return m_v[1] < e.m_v[1];
+      }
+    };
+
+    static int targetTriangles(int nTr, double percent)
+    {
+      percent = odmax(0.0, odmin(percent, 100.0));
+      return int(floor(nTr * (100.0 - percent) / 100.0 + 0.5));
+    }
+
+    bool isRemoved(int t) const { return m_tr[t][0] < 0; }
+
+    // Plane through border or face tag boundary edge orthogonal to the triangle
+    void addEdgePenalty(int a, int b, int t)
+    {
+      const int3& tr = m_tr[t];
+      const OdGeVector3d e = m_vx[b] - m_vx[a];
+      OdGeVector3d n = (m_vx[tr[1]] - m_vx[tr[0]]).crossProduct(m_vx[tr[2]] - m_vx[tr[0]]);
+      n = e.crossProduct(n);
+      const double len = n.length();
+      if (len < 1e-300)
+        return;
+      n /= len;
+      Quadric q;
+      q.setPlane(n, -n.dotProduct(m_vx[a].asVector()), e.lengthSqrd() * 10.0);
+      m_Q[a] += q;
+      m_Q[b] += q;
+    }
+
+    void pushCandidate(int a, int b)
+    {
+      const bool bLockedA = (m_flags[a] & kLocked) != 0, bLockedB = (m_flags[b] & kLocked) != 0;
+      if (bLockedA && bLockedB)
+        return;
+      Quadric q = m_Q[a];
+      q += m_Q[b];
+      Candidate c;
+      if (bLockedA)
+        c.m_pos = m_vx[a];
+      else if (bLockedB)
+        c.m_pos = m_vx[b];
+      else if (!q.optimum(c.m_pos))
+      {
+        const OdGePoint3d mid = m_vx[a] + (m_vx[b] - m_vx[a]) * 0.5;
+        const double ea = q.error(m_vx[a]), eb = q.error(m_vx[b]), em = q.error(mid);
+        c.m_pos = (em <= ea && em <= eb) ? mid : ((ea <= eb) ? m_vx[a] : m_vx[b]);
+      }
+      c.m_cost = odmax(q.error(c.m_pos), 0.0);
+      c.m_v[0] = a;
+      c.m_v[1] = b;
+      c.m_stamp[0] = m_stamp[a];
+      c.m_stamp[1] = m_stamp[b];
+      m_heap.push(c);
+    }
+
+    static void removeFromList(std::vector<int>& list, int t)
+    {
+      std::vector<int>::iterator it = std::find(list.begin(), list.end(), t);
+      if (it != list.end())
+      {
+        *it = list.back();
+        list.pop_back();
+      }
+    }
+
+    // Collects vertices adjacent to v except excluded one
+    void collectNeighbors(int v, int vExclude, std::vector<int>& nbs) const
+    {
+      nbs.clear();
+      const std::vector<int>& trs = m_vxToTr[v];
+      for (size_t i = 0; i < trs.size(); ++i)
+      {
+        const int3& tr = m_tr[trs[i]];
+        for (int j = 0; j < 3; ++j)
+          if (tr[j] != v && tr[j] != vExclude)
+            nbs.push_back(tr[j]);
+      }
+      std::sort(nbs.begin(), nbs.end());
+      nbs.erase(std::unique(nbs.begin(), nbs.end()), nbs.end());
+    }
+
+    // Checks that triangles around v don't flip or degenerate when v is moved to pos
+    bool checkFan(int v, int vOther, const OdGePoint3d& pos) const
+    {
+      const std::vector<int>& trs = m_vxToTr[v];
+      for (size_t i = 0; i < trs.size(); ++i)
+      {
+        const int3& tr = m_tr[trs[i]];
+        if (tr[0] == vOther || tr[1] == vOther || tr[2] == vOther)
+          continue;
+        OdGePoint3d p[3] = { m_vx[tr[0]], m_vx[tr[1]], m_vx[tr[2]] };
+        const OdGeVector3d n0 = (p[1] - p[0]).crossProduct(p[2] - p[0]);
+        for (int j = 0; j < 3; ++j)
+          if (tr[j] == v)
+            p[j] = pos;
+        const OdGeVector3d n1 = (p[1] - p[0]).crossProduct(p[2] - p[0]);
+        const double l0 = n0.lengthSqrd(), l1 = n1.lengthSqrd();
+        if (l1 <= 1e-12 * l0)
+          return false;
+        const double d = n0.dotProduct(n1);
+        if (d <= 0.0 || d * d < 0.01 * l0 * l1)
+          return false;
+      }
+      return true;
+    }
+
+    bool collapse(const Candidate& c, std::vector<int>& nbsKeep, std::vector<int>& nbsRem)
+    {
+      int vKeep = c.m_v[0], vRem = c.m_v[1];
+      if (m_flags[vRem] & kLocked)
+        std::swap(vKeep, vRem);
+      // Link condition: common neighbors are opposite vertices of the collapsed triangles only
+      int nShared = 0;
+      const std::vector<int>& trsRem = m_vxToTr[vRem];
+      for (size_t i = 0; i < trsRem.size(); ++i)
+      {
+        const int3& tr = m_tr[trsRem[i]];
+        if (tr[0] == vKeep || tr[1] == vKeep || tr[2] == vKeep)
+          ++nShared;
+      }
+      if (!nShared || nShared > 2)
+        return false;
+      if ((m_flags[vKeep] & kBorder) && (m_flags[vRem] & kBorder) && (nShared != 1))
+        return false;
+      collectNeighbors(vKeep, vRem, nbsKeep);
+      collectNeighbors(vRem, vKeep, nbsRem);
+      int nCommon = 0;
+      for (size_t i = 0, j = 0; i < nbsKeep.size() && j < nbsRem.size(); )
+      {
+        if (nbsKeep[i] < nbsRem[j])
+          ++i;
+        else if (nbsRem[j] < nbsKeep[i])
+          ++j;
+        else
+        {
+          ++nCommon;
+          ++i;
+          ++j;
+        }
+      }
+      if (nCommon != nShared)
+        return false;
+      if (!checkFan(vKeep, vRem, c.m_pos) || !checkFan(vRem, vKeep, c.m_pos))
+        return false;
+      // Apply
+      m_vx[vKeep] = c.m_pos;
+      m_Q[vKeep] += m_Q[vRem];
+      m_flags[vKeep] |= m_flags[vRem] & kBorder;
+      m_flags[vRem] |= kRemoved;
+      ++m_stamp[vKeep];
+      ++m_stamp[vRem];
+      std::vector<int> trs;
+      trs.swap(m_vxToTr[vRem]);
+      for (size_t i = 0; i < trs.size(); ++i)
+      {
+        const int t = trs[i];
+        int3& tr = m_tr[t];
+        if (tr[0] == vKeep || tr[1] == vKeep || tr[2] == vKeep)
+        {
+          for (int j = 0; j < 3; ++j)
+            if (tr[j] != vRem)
+              removeFromList(m_vxToTr[tr[j]], t);
+          tr[0] = -1;
+          --m_nLiveTr;
+        }
+        else
+        {
+          for (int j = 0; j < 3; ++j)
+            if (tr[j] == vRem)
+              tr[j] = vKeep;
+          m_vxToTr[vKeep].push_back(t);
+        }
+      }
+      collectNeighbors(vKeep, -1, nbsKeep);
+      for (size_t i = 0; i < nbsKeep.size(); ++i)
+        pushCandidate(vKeep, nbsKeep[i]);
+      return true;
+    }
+
+    // Collapses edges until triangles count reaches target. Returns false if no more collapses possible.
+    bool collapseTo(int nTarget)
+    {
+      std::vector<int> nbsKeep, nbsRem;
+      while (m_nLiveTr > nTarget)
+      {
+        if (m_heap.empty())
+          return false;
+        const Candidate c = m_heap.top();
+        m_heap.pop();
+        if (((m_flags[c.m_v[0]] | m_flags[c.m_v[1]]) & kRemoved) ||
+            (c.m_stamp[0] != m_stamp[c.m_v[0]]) || (c.m_stamp[1] != m_stamp[c.m_v[1]]))
+          continue;
+        if (m_maxError2 >= 0.0 && c.m_cost > m_maxError2)
+        {
+          m_heap = std::priority_queue<Candidate>();
+          return false;
+        }
+        collapse(c, nbsKeep, nbsRem);
+      }
+      return true;
+    }
+
+    // Copies live triangles and used vertices into mesh, optionally returns source index of each vertex
+    void snapshot(OdGeTrMesh& mesh, std::vector<int>* pVxIds) const
+    {
+      mesh.clear();
+      std::vector<int> vxIds;
+      if (!pVxIds)
+        pVxIds = &vxIds;
+      pVxIds->clear();
+      std::vector<int> remap(m_vx.size(), -1);
+      for (size_t t = 0; t < m_tr.size(); ++t)
+      {
+        if (isRemoved((int)t))
+          continue;
+        for (int j = 0; j < 3; ++j)
+        {
+          const int v = m_tr[t][j];
+          if (remap[v] < 0)
+          {
+            remap[v] = (int)pVxIds->size();
+            pVxIds->push_back(v);
+          }
+        }
+      }
+      const unsigned nVx = (unsigned)pVxIds->size();
+      mesh.m_aVx.resize(nVx);
+      if (!m_vxTag.empty())
+        mesh.m_aVxTag.resize(nVx);
+      for (unsigned i = 0; i < nVx; ++i)
+      {
+        mesh.m_aVx[i] = m_vx[(*pVxIds)[i]];
+        if (!m_vxTag.empty())
+          mesh.m_aVxTag[i] = m_vxTag[(*pVxIds)[i]];
+      }
+      mesh.m_aTr.resize(m_nLiveTr);
+      unsigned nTr = 0;
+      for (size_t t = 0; t < m_tr.size(); ++t)
+      {
+        if (isRemoved((int)t))
+          continue;
+        OdGeTr& tr = mesh.m_aTr[nTr++];
+        tr.tagFace = m_trTag[t];
+        for (int j = 0; j < 3; ++j)
+          tr.tr[j] = remap[m_tr[t][j]];
+      }
+    }
+
+    bool buildLevelsImpl(const int* pTargets, unsigned nLevels, OdArray<OdGeTrMesh>& levels,
+                         std::vector<std::vector<int> >* pVxIds)
+    {
+      levels.resize(nLevels);
+      if (pVxIds)
+        pVxIds->resize(nLevels);
+      if (!nLevels || !m_nLiveTr)
+        return false;
+      // Levels are produced from finest to coarsest
+      std::vector<std::pair<int, unsigned> > order(nLevels);
+      for (unsigned i = 0; i < nLevels; ++i)
+        order[i] = std::make_pair(-pTargets[i], i);
+      std::sort(order.begin(), order.end());
+      for (unsigned i = 0; i < nLevels; ++i)
+      {
+        const unsigned nLevel = order[i].second;
+        collapseTo(-order[i].first);
+        snapshot(levels[nLevel], pVxIds ? &(*pVxIds)[nLevel] : NULL);
+      }
+      return true;
+    }
+
+    static double oneSidedDistance(const OdGeMesh& from, const OdGeMesh& to, unsigned nMaxSamples)
+    {
+      const unsigned nVx = from.m_aVx.size();
+      const unsigned nStep = (nMaxSamples && nVx > nMaxSamples) ? (nVx + nMaxSamples - 1) / nMaxSamples : 1;
+      double dist = 0.0;
+      OdGePoint3d ptClosest;
+      for (unsigned v = 0; v < nVx; v += nStep)
+        dist = odmax(dist, to.distanceTo(from.m_aVx[v], ptClosest, true));
+      return dist;
+    }
+
+    // Parallel processing support
+
+    struct Partition
+    {
+      OdGeTrMesh m_mesh;
+      std::vector<OdUInt8> m_locked;
+      std::vector<int> m_toGlobal;
+      OdArray<OdGeTrMesh> m_levels;
+      std::vector<std::vector<int> > m_vxIds;
+    };
+
+    struct ParallelJob
+    {
+      virtual ~ParallelJob() { }
+      virtual void run(unsigned nTask) = 0;
+    };
+
+    // Simplifies spatial cells, every cell gets the same percents as the whole mesh
+    struct PartitionJob : public ParallelJob
+    {
+      std::vector<Partition>& m_parts;
+      const double* m_pPercents;
+      unsigned m_nLevels;
+      bool m_bPreserveBorders;
+      PartitionJob(std::vector<Partition>& parts, const double* pPercents, unsigned nLevels, bool bPreserveBorders)
+        : m_parts(parts), m_pPercents(pPercents), m_nLevels(nLevels), m_bPreserveBorders(bPreserveBorders) { }
+      void run(unsigned nTask)
+      {
+        Partition& part = m_parts[nTask];
+        if (part.m_mesh.m_aTr.isEmpty())
+          return;
+        GeTrngLodSimplification simp;
+        simp.setPreserveBorders(m_bPreserveBorders);
+        simp.reset(part.m_mesh, &part.m_locked[0]);
+        std::vector<int> targets(m_nLevels);
+        for (unsigned i = 0; i < m_nLevels; ++i)
+          targets[i] = targetTriangles(simp.numTriangles(), m_pPercents[i]);
+        part.m_mesh.clear();
+        simp.buildLevelsImpl(&targets[0], m_nLevels, part.m_levels, &part.m_vxIds);
+      }
+    };
+
+    // Finishes merged levels with unlocked cell boundaries
+    struct SeamJob : public ParallelJob
+    {
+      OdArray<OdGeTrMesh>& m_levels;
+      const int* m_pTargets;
+      bool m_bPreserveBorders;
+      SeamJob(OdArray<OdGeTrMesh>& levels, const int* pTargets, bool bPreserveBorders)
+        : m_levels(levels), m_pTargets(pTargets), m_bPreserveBorders(bPreserveBorders) { }
+      void run(unsigned nTask)
+      {
+        OdGeTrMesh& level = m_levels[nTask];
+        if ((int)level.m_aTr.size() <= m_pTargets[nTask])
+          return;
+        GeTrngLodSimplification simp;
+        simp.setPreserveBorders(m_bPreserveBorders);
+        simp.reset(level);
+        simp.collapseTo(m_pTargets[nTask]);
+        simp.snapshot(level, NULL);
+      }
+    };
+
+    // Runs job tasks by thread pool threads, every thread takes next task from shared counter
+    class JobAtom : public OdApcAtom
+    {
+      ParallelJob* m_pJob;
+      unsigned m_nTasks;
+      OdMutex m_mutex;
+      unsigned m_nNext;
+    public:
+      JobAtom() : m_pJob(NULL), m_nTasks(0), m_nNext(0) { }
+      void init(ParallelJob* pJob, unsigned nTasks) { m_pJob = pJob; m_nTasks = nTasks; m_nNext = 0; }
+      void apcEntryPoint(OdApcParamType /*parameter*/)
+      {
+        for (;;)
+        {
+          unsigned nTask;
+          {
+            TD_AUTOLOCK(m_mutex);
+            if (m_nNext == m_nTasks)
+              break;
+            nTask = m_nNext++;
+          }
+          m_pJob->run(nTask);
+        }
+      }
+    };
+
+    static void runParallel(OdRxThreadPoolService* pThreadPool, ParallelJob& job, unsigned nTasks)
+    {
+      const unsigned nThreads = odmin((unsigned)pThreadPool->numCPUs(), nTasks);
+      OdStaticRxObject<JobAtom> atom;
+      atom.init(&job, nTasks);
+      OdApcQueuePtr pQueue = pThreadPool->newMTQueue(ThreadsCounter::kNoAttributes, nThreads, kMtQueueAllowExecByMain);
+      for (unsigned i = 0; i < nThreads; ++i)
+        pQueue->addEntryPoint(&atom, (OdApcParamType)i);
+      pQueue->wait();
+    }
+
+protected:
+    std::vector<OdGePoint3d> m_vx;
+    std::vector<int> m_vxTag;
+    std::vector<Quadric> m_Q;
+    std::vector<OdUInt32> m_stamp;
+    std::vector<OdUInt8> m_flags;
+    std::vector<std::vector<int> > m_vxToTr;
+    std::vector<int3> m_tr;
+    std::vector<int> m_trTag;
+    int m_nLiveTr;
+    std::priority_queue<Candidate> m_heap;
+    bool m_bPreserveBorders;
+    double m_maxError2;
+};
+
+}
+
+#endif
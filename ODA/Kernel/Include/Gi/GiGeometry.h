@@ -32,6 +32,8 @@
 
 #include "Gi/GiRasterImage.h"
 #include "Gi/GiMaterial.h"
+#include "OdArray.h"
+#include "OdString.h"
 
 class OdDbStub;
 class OdCmEntityColor;
@@ -969,6 +971,23 @@ public:
     const OdGePoint3d* vertexList,
     const OdGeVector3d* pNormal = 0,
     OdGsMarker baseSubEntMarker = -1) = 0;
+
+  /** \details
+    Introduces a polyline to this vectorization context.  
+
+    \param vertices [in]  View of vertices.
+    \param pNormal [in]  Pointer to the normal vector.
+    \param baseSubEntMarker [in]  Not used.
+    \remarks
+    Passes viewed vertices to polyline() without copying of the viewed array.
+  */
+  void polyline(
+    const OdArrayView<OdGePoint3d>& vertices,
+    const OdGeVector3d* pNormal = 0,
+    OdGsMarker baseSubEntMarker = -1)
+  {
+    polyline((OdInt32)vertices.size(), vertices.getPtr(), pNormal, baseSubEntMarker);
+  }
   
   /** \details
     Introduces a polygon to this vectorization context.  
@@ -1006,6 +1025,24 @@ public:
     const OdGePoint3d* vertexList,
     const OdGeVector3d* pNormal);
 
+  /** \details
+    Introduces a polygon to this vectorization context.
+
+    \param vertices [in]  View of vertices.
+    \param pNormal [in]  Pointer to the normal vector.
+    \remarks
+    Passes viewed vertices to polygon() without copying of the viewed array.
+  */
+  void polygon(
+    const OdArrayView<OdGePoint3d>& vertices,
+    const OdGeVector3d* pNormal = 0)
+  {
+    if (pNormal)
+      polygon((OdInt32)vertices.size(), vertices.getPtr(), pNormal);
+    else
+      polygon((OdInt32)vertices.size(), vertices.getPtr());
+  }
+
   /** \details
     Introduces a lightweight polyline into this vectorization context.
 
@@ -1052,6 +1089,30 @@ public:
     const OdGiEdgeData* pEdgeData = 0,
     const OdGiFaceData* pFaceData = 0,
     const OdGiVertexData* pVertexData = 0) = 0;
+
+  /** \details
+    Introduces a mesh into this vectorization context.
+
+    \param numRows [in]  Number of rows.
+    \param numColumns [in]  Number of columns.
+    \param vertices [in]  View of numRows x numColumns vertices.
+    \param pEdgeData [in]  Pointer to additional edge data.
+    \param pFaceData [in]  Pointer to additional face data.
+    \param pVertexData [in]  Pointer to additional vertex data.
+    \remarks
+    Passes viewed vertices to mesh() without copying of the viewed array.
+  */
+  void mesh(
+    OdInt32 numRows,
+    OdInt32 numColumns,
+    const OdArrayView<OdGePoint3d>& vertices,
+    const OdGiEdgeData* pEdgeData = 0,
+    const OdGiFaceData* pFaceData = 0,
+    const OdGiVertexData* pVertexData = 0)
+  {
+    ODA_ASSERT(vertices.size() == OdUInt32(numRows * numColumns));
+    mesh(numRows, numColumns, vertices.getPtr(), pEdgeData, pFaceData, pVertexData);
+  }
   
   /** \details
     Introduces a shell into this vectorization context.  
@@ -1083,6 +1144,27 @@ public:
     const OdGiEdgeData* pEdgeData = 0,
     const OdGiFaceData* pFaceData = 0,
     const OdGiVertexData* pVertexData = 0) = 0;
+
+  /** \details
+    Introduces a shell into this vectorization context.
+
+    \param vertices [in]  View of vertices.
+    \param faceList [in]  View of integers defining faces.
+    \param pEdgeData [in]  Pointer to additional edge data.
+    \param pFaceData [in]  Pointer to additional face data.
+    \param pVertexData [in]  Pointer to additional vertex data.
+    \remarks
+    Passes viewed vertices and faces to shell() without copying of the viewed arrays.
+  */
+  void shell(
+    const OdArrayView<OdGePoint3d>& vertices,
+    const OdArrayView<OdInt32>& faceList,
+    const OdGiEdgeData* pEdgeData = 0,
+    const OdGiFaceData* pFaceData = 0,
+    const OdGiVertexData* pVertexData = 0)
+  {
+    shell((OdInt32)vertices.size(), vertices.getPtr(), (OdInt32)faceList.size(), faceList.getPtr(), pEdgeData, pFaceData, pVertexData);
+  }
   
   /** \details
     Introduces text into this vectorization context.
@@ -1133,6 +1215,29 @@ public:
     OdInt32 length, 
     bool raw, 
     const OdGiTextStyle* pTextStyle) = 0;
+
+  /** \details
+    Introduces text into this vectorization context.
+
+    \param position [in]  Position of the text string.
+    \param normal [in]  Normal vector of the text.
+    \param direction [in]  Baseline direction of the text.
+    \param msg [in]  View of text string.
+    \param raw [in]  If and only if true, escape sequences, such as %%P, will not be converted to special characters.
+    \param pTextStyle [in]  Pointer to the TextStyle for the text.
+    \remarks
+    Passes viewed characters to text() without copying of the viewed string.
+  */
+  void text(
+    const OdGePoint3d& position,
+    const OdGeVector3d& normal,
+    const OdGeVector3d& direction,
+    const OdStringView& msg,
+    bool raw,
+    const OdGiTextStyle* pTextStyle)
+  {
+    text(position, normal, direction, msg.data(), (OdInt32)msg.getLength(), raw, pTextStyle);
+  }
   
   /** \details
     Introduces an Xline into this vectorization context.  
@@ -0,0 +1,269 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+#ifndef ODGSDEVICEPOOL_INC
+#define ODGSDEVICEPOOL_INC
+
+#include "TD_PackPush.h"
+
+#include "Gs/Gs.h"
+#include "Gs/GsBaseModule.h"
+#include "RxObjectImpl.h"
+#include "OdArray.h"
+#include "OdMutex.h"
+
+/** \details
+    Pool of vectorization devices, created by single Gs module, for reuse between
+    subsequent exports or renderings of different databases.
+
+    Device returned by acquire() has no views; client binds it to a database in the
+    same way as a newly created device (for example using setupActiveLayoutViews()).
+    Device returned into the pool by release() loses all views, so all Gs models and
+    drawables of previous database are released. Pool keeps Gs initialized while it
+    exists, so subsequent exports don't pay for Gs initialization and uninitialization.
+
+    Library: Source code provided.
+
+    <group OdGs_Classes>
+*/
+class OdGsDevicePool : public OdRxObject
+{
+  public:
+    /** \details
+      Pool usage statistics.
+    */
+    struct Stats
+    {
+      OdUInt32 m_nCreated;   // Number of devices created by pool module
+      OdUInt32 m_nReused;    // Number of acquire() calls served by idle device
+      OdUInt32 m_nReleased;  // Number of devices returned into idle list
+      OdUInt32 m_nDiscarded; // Number of devices discarded on release (failure or idle list overflow)
+      OdUInt32 m_nIdle;      // Number of idle devices
+      OdUInt32 m_nInUse;     // Number of devices currently acquired
+      OdUInt32 m_nPeakInUse; // Maximal number of simultaneously acquired devices
+
+      Stats() : m_nCreated(0), m_nReused(0), m_nReleased(0), m_nDiscarded(0)
+              , m_nIdle(0), m_nInUse(0), m_nPeakInUse(0) { }
+    };
+  protected:
+    OdGsModulePtr m_pModule;
+    OdArray<OdGsDevicePtr> m_idle;
+    OdUInt32 m_nMaxIdle;
+    mutable OdMutex m_mutex;
+    Stats m_stats;
+    bool m_bGsInitialized;
+  public:
+    OdGsDevicePool()
+      : m_nMaxIdle(4)
+      , m_bGsInitialized(false)
+    {
+    }
+    ~OdGsDevicePool()
+    {
+      clear();
+      m_pModule.release();
+      if (m_bGsInitialized)
+        ::odgsUninitialize();
+    }
+
+    /** \details
+      Creates pool of devices for specified Gs module.
+
+      \param pModule [in]  Gs module which creates pooled devices.
+      \param nMaxIdle [in]  Maximal number of idle devices kept by pool.
+    */
+    static OdSmartPtr<OdGsDevicePool> createObject(OdGsModule *pModule, OdUInt32 nMaxIdle = 4)
+    {
+      if (!pModule)
+        throw OdError(eInvalidInput);
+      OdSmartPtr<OdGsDevicePool> pPool = OdRxObjectImpl<OdGsDevicePool>::createObject();
+      ::odgsInitialize();
+      pPool->m_bGsInitialized = true;
+      pPool->m_pModule = pModule;
+      pPool->m_nMaxIdle = nMaxIdle;
+      return pPool;
+    }
+
+    /** \details
+      Returns Gs module which creates pooled devices.
+    */
+    OdGsModulePtr module() const { return m_pModule; }
+
+    /** \details
+      Sets maximal number of idle devices kept by pool.
+    */
+    void setMaxIdle(OdUInt32 nMaxIdle)
+    {
+      TD_AUTOLOCK(m_mutex);
+      m_nMaxIdle = nMaxIdle;
+      while (m_idle.size() > m_nMaxIdle)
+        m_idle.removeLast(), m_stats.m_nDiscarded++;
+    }
+    /** \details
+      Returns maximal number of idle devices kept by pool.
+    */
+    OdUInt32 maxIdle() const { return m_nMaxIdle; }
+
+    /** \details
+      Returns idle device or creates new one if pool is empty.
+    */
+    OdGsDevicePtr acquire()
+    {
+      OdGsDevicePtr pDevice;
+      {
+        TD_AUTOLOCK(m_mutex);
+        if (!m_idle.isEmpty())
+        {
+          pDevice = m_idle.last();
+          m_idle.removeLast();
+          m_stats.m_nReused++;
+        }
+        m_stats.m_nInUse++;
+        if (m_stats.m_nInUse > m_stats.m_nPeakInUse)
+          m_stats.m_nPeakInUse = m_stats.m_nInUse;
+      }
+      if (pDevice.isNull())
+      {
+        try
+        {
+          pDevice = m_pModule->createDevice();
+        }
+        catch (...)
+        {
+          TD_AUTOLOCK(m_mutex);
+          m_stats.m_nInUse--;
+          throw;
+        }
+        TD_AUTOLOCK(m_mutex);
+        m_stats.m_nCreated++;
+      }
+      return pDevice;
+    }
+
+    /** \details
+      Returns device, obtained by acquire(), into the pool.
+
+      \param pDevice [in]  Device to release.
+      \param bDiscard [in]  Destroy device instead of keeping it in idle list (device state is unknown after failure).
+      \remarks
+      Wrappers, created on top of device (like layout helpers), must be released by client before this call.
+    */
+    void release(OdGsDevice *pDevice, bool bDiscard = false)
+    {
+      if (!pDevice)
+        return;
+      OdGsDevicePtr pHold(pDevice);
+      if (!bDiscard)
+      {
+        try
+        {
+          pDevice->eraseAllViews();
+        }
+        catch (...)
+        {
+          bDiscard = true;
+        }
+      }
+      TD_AUTOLOCK(m_mutex);
+      if (m_stats.m_nInUse)
+        m_stats.m_nInUse--;
+      if (bDiscard || (m_idle.size() >= m_nMaxIdle))
+        m_stats.m_nDiscarded++;
+      else
+      {
+        m_idle.push_back(pHold);
+        m_stats.m_nReleased++;
+      }
+    }
+
+    /** \details
+      Destroys all idle devices.
+    */
+    void clear()
+    {
+      OdArray<OdGsDevicePtr> idle;
+      {
+        TD_AUTOLOCK(m_mutex);
+        idle.swap(m_idle);
+      }
+      // Devices destroyed outside of lock
+    }
+
+    /** \details
+      Returns pool usage statistics.
+    */
+    Stats stats() const
+    {
+      TD_AUTOLOCK(m_mutex);
+      Stats curStats = m_stats;
+      curStats.m_nIdle = m_idle.size();
+      return curStats;
+    }
+};
+
+/** \details
+    This template class is a specialization of the OdSmartPtr class for OdGsDevicePool object pointers.
+*/
+typedef OdSmartPtr<OdGsDevicePool> OdGsDevicePoolPtr;
+
+/** \details
+    Acquires device from pool (or creates new device if pool isn't specified) and
+    returns it into the pool on destruction.
+
+    <group OdGs_Classes>
+*/
+class OdGsDevicePoolLease
+{
+  OdGsDevicePool *m_pPool;
+  OdGsDevicePtr m_pDevice;
+  bool m_bDiscard;
+  public:
+    OdGsDevicePoolLease(OdGsDevicePool *pPool, OdGsModule *pModule)
+      : m_pPool(pPool)
+      , m_bDiscard(true)
+    {
+      if (m_pPool)
+        m_pDevice = m_pPool->acquire();
+      else
+        m_pDevice = pModule->createDevice();
+    }
+    ~OdGsDevicePoolLease()
+    {
+      if (m_pPool)
+        m_pPool->release(m_pDevice, m_bDiscard);
+    }
+
+    /** \details
+      Returns leased device.
+    */
+    OdGsDevice *device() { return m_pDevice.get(); }
+
+    /** \details
+      Marks device as suitable for reuse. Devices are discarded on release unless
+      this method called, so device left in unknown state by exception doesn't return into the pool.
+    */
+    void setSucceeded() { m_bDiscard = false; }
+};
+
+#include "TD_PackPop.h"
+
+#endif // ODGSDEVICEPOOL_INC
@@ -0,0 +1,359 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef __ODGSREGENSCHEDULER_H__
+#define __ODGSREGENSCHEDULER_H__
+
+#include "OdArray.h"
+#include "OdMutex.h"
+
+#include "TD_PackPush.h"
+
+/** \details
+  This class distributes entities between regeneration threads.
+
+  \remarks
+  Entities are grouped into contiguous batches of approximately equal estimated
+  cost, and each thread receives a contiguous range of batches with approximately
+  equal summary cost. Thread takes batches from the front of its own range, and
+  when its range becomes empty it steals batches from the back of the most loaded
+  range of other thread. Ranges are packed into single integers and modified by
+  compare-exchange, so batch queries don't require any locking.
+  Order of batches is fixed by build(), so results of batches could be
+  concatenated in batch order independently of thread which processed them.
+
+  <group OdGs_Classes> 
+    
+  Corresponding C++ library: Source code provided.
+*/
+class OdGsRegenBatchScheduler
+{
+public:
+  /** \details
+    Contiguous range of entities processed as single unit.
+  */
+  struct Batch
+  {
+    OdUInt32 m_first;  // Index of first entity
+    OdUInt32 m_count;  // Number of entities
+    OdUInt64 m_cost;   // Summary estimated cost of entities
+  };
+  enum
+  {
+    kMaxBatches  = 0x7FFF, // Batch indices are packed into 16 bits of range
+    kRangeStride = 16      // Ranges of threads are placed into separate cache lines
+  };
+protected:
+  OdArray<Batch, OdMemoryAllocator<Batch> > m_batches;
+  OdArray<int, OdMemoryAllocator<int> >     m_ranges;
+  OdUInt32                                  m_nThreads;
+
+  volatile int* range(OdUInt32 nThread)
+  {
+    return (volatile int*)m_ranges.asArrayPtr() + nThread * kRangeStride;
+  }
+  static int packRange(OdUInt32 nBegin, OdUInt32 nEnd) { return int((nBegin << 16) | nEnd); }
+  static OdUInt32 rangeBegin(int nRange) { return OdUInt32(nRange) >> 16; }
+  static OdUInt32 rangeEnd(int nRange) { return OdUInt32(nRange) & 0xFFFF; }
+
+  static bool updateRange(volatile int* pRange, int nNew, int nOld)
+  {
+#ifndef TD_SINGLE_THREAD
+    return OdInterlockedCompareExchange(pRange, nNew, nOld) == nOld;
+#else
+    if (*pRange != nOld)
+      return false;
+    *pRange = nNew;
+    return true;
+#endif
+  }
+public:
+  /** \details
+    Default constructor for the OdGsRegenBatchScheduler class.
+  */
+  OdGsRegenBatchScheduler() : m_nThreads(0) { }
+
+  /** \details
+    Builds batches and initial distribution of batches between threads.
+    \param pCosts [in]  Estimated costs of entities (zero cost is treated as 1).
+    \param nItems [in]  Number of entities.
+    \param nThreads [in]  Number of threads.
+    \param nBatchesPerThread [in]  Desired number of batches for each thread.
+  */
+  void build(const OdUInt32* pCosts, OdUInt32 nItems, OdUInt32 nThreads, OdUInt32 nBatchesPerThread = 8)
+  {
+    if (!nThreads)
+      nThreads = 1;
+    if (!nBatchesPerThread)
+      nBatchesPerThread = 1;
+    m_nThreads = nThreads;
+    m_batches.clear();
+    m_ranges.resize(nThreads * kRangeStride, 0);
+    OdUInt64 nTotal = 0;
+    OdUInt32 n;
+    for (n = 0; n < nItems; n++)
+      nTotal += pCosts[n] ? pCosts[n] : 1;
+    OdUInt64 nBatches = OdUInt64(nThreads) * nBatchesPerThread;
+    if (nBatches > kMaxBatches)
+      nBatches = kMaxBatches;
+    OdUInt64 nTarget = nTotal / nBatches;
+    if (nTotal % nBatches)
+      nTarget++;
+    if (!nTarget)
+      nTarget = 1;
+    m_batches.reserve(OdUInt32(nBatches) + 1);
+    Batch batch = { 0, 0, 0 };
+    for (n = 0; n < nItems; n++)
+    {
+      batch.m_cost += pCosts[n] ? pCosts[n] : 1;
+      batch.m_count++;
+      // Each batch is at least nTarget, so number of batches can't exceed nBatches
+      if (batch.m_cost >= nTarget)
+      {
+        m_batches.push_back(batch);
+        batch.m_first = n + 1;
+        batch.m_count = 0;
+        batch.m_cost = 0;
+      }
+    }
+    if (batch.m_count)
+      m_batches.push_back(batch);
+    // Split batches between threads by cumulative cost
+    const OdUInt32 nBatchesBuilt = m_batches.size();
+    OdUInt64 nCumulative = 0;
+    OdUInt32 nBatch = 0;
+    for (n = 0; n < nThreads; n++)
+    {
+      const OdUInt32 nBegin = nBatch;
+      const OdUInt64 nBound = (nTotal * (n + 1)) / nThreads;
+      while (nBatch < nBatchesBuilt && (n + 1 == nThreads || nCumulative + m_batches[nBatch].m_cost / 2 < nBound))
+        nCumulative += m_batches[nBatch++].m_cost;
+      *range(n) = packRange(nBegin, nBatch);
+    }
+  }
+
+  /** \details
+    Returns number of batches.
+  */
+  OdUInt32 numBatches() const { return m_batches.size(); }
+
+  /** \details
+    Returns batch by index.
+    \param nBatch [in]  Batch index.
+  */
+  const Batch& batch(OdUInt32 nBatch) const { return m_batches[nBatch]; }
+
+  /** \details
+    Returns number of threads specified in build().
+  */
+  OdUInt32 numThreads() const { return m_nThreads; }
+
+  /** \details
+    Takes next batch for processing by specified thread.
+    \param nThread [in]  Thread index.
+    \param nBatch [out]  Receives batch index.
+    \param bStolen [out]  Receives true if batch was taken from range of other thread.
+    \returns
+    false if all batches are already taken.
+    \remarks
+    Safe to call concurrently from different threads with different nThread.
+  */
+  bool next(OdUInt32 nThread, OdUInt32& nBatch, bool& bStolen)
+  {
+    volatile int* pOwn = range(nThread);
+    for (;;)
+    {
+      const int nRange = *pOwn;
+      const OdUInt32 nBegin = rangeBegin(nRange), nEnd = rangeEnd(nRange);
+      if (nBegin >= nEnd)
+        break;
+      if (updateRange(pOwn, packRange(nBegin + 1, nEnd), nRange))
+      {
+        nBatch = nBegin;
+        bStolen = false;
+        return true;
+      }
+    }
+    for (;;)
+    {
+      volatile int* pVictim = NULL;
+      int nVictimRange = 0;
+      OdUInt32 nMaxLeft = 0;
+      for (OdUInt32 n = 0; n < m_nThreads; n++)
+      {
+        if (n == nThread)
+          continue;
+        const int nRange = *range(n);
+        const OdUInt32 nBegin = rangeBegin(nRange), nEnd = rangeEnd(nRange);
+        if (nBegin < nEnd && nEnd - nBegin > nMaxLeft)
+        {
+          nMaxLeft = nEnd - nBegin;
+          pVictim = range(n);
+          nVictimRange = nRange;
+        }
+      }
+      if (!pVictim)
+        return false;
+      const OdUInt32 nBegin = rangeBegin(nVictimRange), nEnd = rangeEnd(nVictimRange);
+      if (updateRange(pVictim, packRange(nBegin, nEnd - 1), nVictimRange))
+      {
+        nBatch = nEnd - 1;
+        bStolen = true;
+        return true;
+      }
+    }
+  }
+};
+
+/** \details
+  This class maps shared definitions (for example block table records) to
+  estimated regeneration costs of their contents.
+
+  \remarks
+  Regeneration threads register costs of definitions they traversed, so other
+  threads don't traverse the same definitions again. Entries are appended to
+  preallocated storage and published in the open addressing table by
+  compare-exchange, so both insertion and lookup are lock-free. Entries are never
+  removed; when storage is exhausted insert() fails and caller keeps own value.
+
+  <group OdGs_Classes> 
+    
+  Corresponding C++ library: Source code provided.
+*/
+class OdGsRegenSharedCosts
+{
+protected:
+  struct Entry
+  {
+    const void* m_pKey;
+    OdUInt32    m_cost;
+  };
+  OdArray<Entry, OdMemoryAllocator<Entry> > m_entries;
+  OdArray<int, OdMemoryAllocator<int> >     m_slots;   // Entry index + 1, zero for free slot
+  volatile int                              m_nEntries;
+  OdUInt32                                  m_nMask;
+
+  OdUInt32 firstSlot(const void* pKey) const
+  {
+    const OdUInt64 nKey = OdUInt64(OdIntPtr(pKey)) >> 3;
+    return OdUInt32((nKey * OdUInt64(0x9E3779B97F4A7C15ULL)) >> 32) & m_nMask;
+  }
+  static int claimSlot(volatile int* pSlot, int nEntry)
+  {
+#ifndef TD_SINGLE_THREAD
+    return OdInterlockedCompareExchange(pSlot, nEntry, 0);
+#else
+    const int nPrev = *pSlot;
+    if (!nPrev)
+      *pSlot = nEntry;
+    return nPrev;
+#endif
+  }
+  int reserveEntry()
+  {
+#ifndef TD_SINGLE_THREAD
+    return OdInterlockedExchangeAdd(&m_nEntries, 1);
+#else
+    return m_nEntries++;
+#endif
+  }
+public:
+  /** \details
+    Default constructor for the OdGsRegenSharedCosts class.
+  */
+  OdGsRegenSharedCosts() : m_nEntries(0), m_nMask(0) { }
+
+  /** \details
+    Allocates storage. Must be called before concurrent access.
+    \param nMaxEntries [in]  Maximal number of registered definitions.
+  */
+  void init(OdUInt32 nMaxEntries)
+  {
+    OdUInt32 nSlots = 16;
+    while (nSlots < nMaxEntries * 2 && nSlots < 0x40000000)
+      nSlots <<= 1;
+    m_entries.resize(odmin(nMaxEntries, nSlots / 2));
+    m_slots.clear();
+    m_slots.resize(nSlots, 0);
+    m_nMask = nSlots - 1;
+    m_nEntries = 0;
+  }
+
+  /** \details
+    Finds registered cost of definition.
+    \param pKey [in]  Definition.
+    \param cost [out]  Receives cost.
+    \returns
+    false if definition isn't registered.
+  */
+  bool find(const void* pKey, OdUInt32& cost) const
+  {
+    if (m_slots.isEmpty())
+      return false;
+    const volatile int* pSlots = (const volatile int*)m_slots.getPtr();
+    for (OdUInt32 nSlot = firstSlot(pKey); ; nSlot = (nSlot + 1) & m_nMask)
+    {
+      const int nEntry = pSlots[nSlot];
+      if (!nEntry)
+        return false;
+      const Entry& entry = m_entries.getPtr()[nEntry - 1];
+      if (entry.m_pKey == pKey)
+      {
+        cost = entry.m_cost;
+        return true;
+      }
+    }
+  }
+
+  /** \details
+    Registers cost of definition. If definition is registered concurrently by other
+    thread, first registered value is kept.
+    \param pKey [in]  Definition.
+    \param cost [in]  Estimated cost.
+    \returns
+    false if storage is exhausted.
+    \remarks
+    Safe to call concurrently with other insert() and find() calls.
+  */
+  bool insert(const void* pKey, OdUInt32 cost)
+  {
+    const int nEntry = reserveEntry();
+    if (nEntry < 0 || OdUInt32(nEntry) >= m_entries.size())
+      return false;
+    // Entry is filled before it is published by compare-exchange (full barrier)
+    Entry& entry = m_entries.asArrayPtr()[nEntry];
+    entry.m_pKey = pKey;
+    entry.m_cost = cost;
+    volatile int* pSlots = (volatile int*)m_slots.asArrayPtr();
+    for (OdUInt32 nSlot = firstSlot(pKey); ; nSlot = (nSlot + 1) & m_nMask)
+    {
+      const int nPrev = claimSlot(pSlots + nSlot, nEntry + 1);
+      if (!nPrev || m_entries.getPtr()[nPrev - 1].m_pKey == pKey)
+        return true;
+    }
+  }
+};
+
+#include "TD_PackPop.h"
+
+#endif // __ODGSREGENSCHEDULER_H__
@@ -23,6 +23,8 @@
 #ifndef GS_VECT_PERFORMANCE_H
 #define GS_VECT_PERFORMANCE_H
 
+#include "OdArray.h"
+
 #include "TD_PackPush.h"
 
 /** \details
@@ -152,6 +154,94 @@ public:
     OdUInt32 m_numVectUsedUpdateScr;
 };
 
+/** \details
+  Statistics of single thread of parallel regeneration.
+
+  <group OdGs_Classes> 
+    
+  Corresponding C++ library: Source code provided.
+*/
+class GsRegenThreadStats
+{
+public:
+    /** \details
+      Default constructor for the GsRegenThreadStats class. Resets statistics.
+    */
+    GsRegenThreadStats() { reset(); }
+
+    /** \details
+      Resets number of regenerated items, batches, stolen batches, estimated cost and time to 0.
+    */
+    void reset()
+    {
+        m_nItems = 0;
+        m_nBatches = 0;
+        m_nStolenBatches = 0;
+        m_cost = 0;
+        m_time = 0;
+    }
+public:
+    OdUInt32 m_nItems;         // Number of regenerated entities
+    OdUInt32 m_nBatches;       // Number of processed batches
+    OdUInt32 m_nStolenBatches; // Number of batches taken from other threads
+    OdUInt64 m_cost;           // Sum of estimated costs of regenerated entities
+    double   m_time;           // Time spent in regeneration (seconds)
+};
+
+/** \details
+  Per-thread statistics of parallel regeneration.
+
+  \remarks
+  Filled by regeneration drivers which schedule entities by OdGsRegenBatchScheduler.
+  Kept apart from GsVectPerformanceData, which is part of the device layout.
+
+  <group OdGs_Classes> 
+    
+  Corresponding C++ library: Source code provided.
+*/
+class GsRegenPerformanceData
+{
+public:
+    /** \details
+      Resets statistics and sets number of threads.
+      \param nThreads [in]  Number of regeneration threads.
+    */
+    void reset(OdUInt32 nThreads)
+    {
+        m_threads.resize(nThreads);
+        for (OdUInt32 i = 0; i < nThreads; ++i)
+            m_threads[i].reset();
+    }
+
+    /** \details
+      Returns total number of regenerated items.
+    */
+    OdUInt32 numItems() const
+    {
+        OdUInt32 n = 0;
+        for (OdUInt32 i = 0; i < m_threads.size(); ++i)
+            n += m_threads[i].m_nItems;
+        return n;
+    }
+
+    /** \details
+      Returns ratio of maximal thread time to average thread time (1.0 for ideal balance).
+    */
+    double imbalance() const
+    {
+        double tmMax = 0, tmSum = 0;
+        for (OdUInt32 i = 0; i < m_threads.size(); ++i)
+        {
+            tmSum += m_threads[i].m_time;
+            if (m_threads[i].m_time > tmMax)
+                tmMax = m_threads[i].m_time;
+        }
+        return (tmSum > 0) ? tmMax * m_threads.size() / tmSum : 1.0;
+    }
+public:
+    OdArray<GsRegenThreadStats, OdMemoryAllocator<GsRegenThreadStats> > m_threads;
+};
+
 #include "TD_PackPop.h"
 
 #endif // GS_VECT_PERFORMANCE_H
@@ -1773,6 +1773,142 @@ private:
   }
 };
 
+template <class T, class A, class Mm> class OdArrayMemAlloc;
+
+/** \details
+    This template class implements non-owning read-only view of contiguous elements.
+
+    \remarks
+    View stores only pointer to the first element and number of elements. Unlike
+    copying of OdArray, constructing, copying and destroying of view doesn't modify
+    reference counter of array buffer, so views could be passed between threads
+    which concurrently read the same array without contention on the counter.
+    
+    View is valid while viewed array is alive and isn't modified.
+
+    <group Other_Classes>
+*/
+template <class T> class OdArrayView
+{
+public:
+  typedef unsigned int size_type;
+  typedef const T* const_iterator;
+  typedef const T* iterator;
+  typedef T value_type;
+  typedef const T& const_reference;
+
+  /** \details
+    Constructs empty view.
+  */
+  OdArrayView() : m_pData(0), m_nSize(0) { }
+
+  /** \details
+    Constructs view of specified elements.
+    \param pData [in]  Pointer to the first element.
+    \param nSize [in]  Number of elements.
+  */
+  OdArrayView(const T* pData, size_type nSize) : m_pData(pData), m_nSize(nSize) { }
+
+  /** \details
+    Constructs view of all elements of specified Array object.
+    \param arr [in]  Array to view.
+  */
+  template <class A>
+  OdArrayView(const OdArray<T, A>& arr) : m_pData(arr.getPtr()), m_nSize(arr.size()) { }
+
+  /** \details
+    Constructs view of all elements of specified Array object.
+    \param arr [in]  Array to view.
+  */
+  template <class A, class Mm>
+  OdArrayView(const OdArrayMemAlloc<T, A, Mm>& arr) : m_pData(arr.getPtr()), m_nSize(arr.size()) { }
+
+  /** \details
+    Returns the number of elements in this view.
+  */
+  size_type size() const { return m_nSize; }
+
+  /** \details
+    Returns the number of elements in this view.
+  */
+  size_type length() const { return m_nSize; }
+
+  /** \details
+    Returns true if and only if this view has no elements.
+  */
+  bool isEmpty() const { return m_nSize == 0; }
+
+  /** \details
+    Returns pointer to the first element of this view.
+  */
+  const T* getPtr() const { return m_pData; }
+
+  /** \details
+    Returns pointer to the first element of this view.
+  */
+  const T* asArrayPtr() const { return m_pData; }
+
+  /** \details
+    Returns iterator that references the first element of this view.
+  */
+  const_iterator begin() const { return m_pData; }
+
+  /** \details
+    Returns iterator that references the location after the last element of this view.
+  */
+  const_iterator end() const { return m_pData + m_nSize; }
+
+  /** \details
+    Returns the element at the specified index.
+    \param index [in]  Element index.
+  */
+  const T& operator [](size_type index) const
+  {
+    ODA_ASSERT(index < m_nSize);
+    return m_pData[index];
+  }
+
+  /** \details
+    Returns the element at the specified index.
+    \param index [in]  Element index.
+    \remarks
+    Throws eInvalidIndex if index is out of range.
+  */
+  const T& at(size_type index) const
+  {
+    if (index >= m_nSize)
+      throw OdError_InvalidIndex();
+    return m_pData[index];
+  }
+
+  /** \details
+    Returns the first element of this view.
+  */
+  const T& first() const { return at(0); }
+
+  /** \details
+    Returns the last element of this view.
+  */
+  const T& last() const { return at(m_nSize - 1); }
+
+  /** \details
+    Returns view of part of elements of this view.
+    \param startIndex [in]  Index of the first element.
+    \param numElements [in]  Number of elements, clamped by the end of this view.
+  */
+  OdArrayView subView(size_type startIndex, size_type numElements) const
+  {
+    if (startIndex > m_nSize)
+      throw OdError_InvalidIndex();
+    if (numElements > m_nSize - startIndex)
+      numElements = m_nSize - startIndex;
+    return OdArrayView(m_pData + startIndex, numElements);
+  }
+private:
+  const T*  m_pData;
+  size_type m_nSize;
+};
+
 #include "TD_PackPop.h"
 
 #endif // ODARRAY_H_INCLUDED
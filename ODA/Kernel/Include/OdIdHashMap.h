@@ -0,0 +1,272 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ODIDHASHMAP_H_INCLUDED
+#define ODIDHASHMAP_H_INCLUDED
+
+#include "TD_PackPush.h"
+
+#include "OdArray.h"
+#include "DbHandle.h"
+
+/** \details
+    This template class implements open addressing hash map keyed by database object identifiers
+    (OdDbObjectId, OdDgElementId or any other identifier type, which provides getHandle(), isNull()
+    and equality operator).
+
+    \remarks
+    Identifiers are hashed by their handles and compared by value, so identifiers of objects
+    from different databases with equal handles are different keys. Collisions are resolved
+    by linear probing, erased entries are removed by backward shift, so lookup never walks
+    through deleted entries. Hash table capacity is always power of two and table grows
+    when its load exceeds 3/4.
+
+    If number of source objects is known, table should be reserved by reserve() to avoid rehashing.
+    Otherwise reserveByHandseed() may be used: handles are allocated sequentially, so handseed is
+    an upper bound of number of objects, but it overestimates sparse databases, so number of
+    entries it reserves is limited and table grows on demand beyond that.
+
+    Copy of the map shares its table with source map until one of them is modified.
+
+    <group Other_Classes>
+*/
+template <class TId, class TValue>
+class OdIdHashMap
+{
+  public:
+    typedef OdUInt32 size_type;
+
+    // Maximal number of entries reserved by reserveByHandseed() (table of 64K entries)
+    enum { kMaxHandseedReserve = 0x8000 };
+  private:
+    struct Entry
+    {
+      TId    m_id;
+      TValue m_value;
+
+      Entry() : m_id(), m_value() { }
+    };
+    typedef OdArray<Entry, OdObjectsAllocator<Entry> > EntryArray;
+
+    EntryArray m_entries;    // Hash table, null identifier marks empty entry
+    size_type  m_nSize;      // Number of non-null keys
+    bool       m_bHasNull;   // Null identifier is mapped
+    TValue     m_nullValue;
+
+    static size_type hashOf(const TId& id)
+    {
+      OdUInt64 nHash = (OdUInt64)id.getHandle() * 0x9E3779B97F4A7C15ULL;
+      return (size_type)(nHash ^ (nHash >> 32));
+    }
+    size_type mask() const { return m_entries.size() - 1; }
+
+    // Returns index of entry for identifier or index of empty entry where it should be inserted
+    size_type findSlot(const Entry* pEntries, const TId& id) const
+    {
+      const size_type nMask = mask();
+      size_type nSlot = hashOf(id) & nMask;
+      while (!pEntries[nSlot].m_id.isNull() && !(pEntries[nSlot].m_id == id))
+        nSlot = (nSlot + 1) & nMask;
+      return nSlot;
+    }
+    void rehash(size_type nCapacity)
+    {
+      EntryArray oldEntries(m_entries);
+      const Entry* pOld = oldEntries.getPtr();
+      const size_type nOld = oldEntries.size();
+      m_entries.clear();
+      m_entries.resize(nCapacity);
+      Entry* pEntries = m_entries.asArrayPtr();
+      for (size_type nEntry = 0; nEntry < nOld; nEntry++)
+      {
+        if (!pOld[nEntry].m_id.isNull())
+          pEntries[findSlot(pEntries, pOld[nEntry].m_id)] = pOld[nEntry];
+      }
+    }
+    static size_type capacityFor(size_type nEntries)
+    {
+      size_type nCapacity = 16;
+      while (nCapacity - (nCapacity >> 2) <= nEntries)
+        nCapacity <<= 1;
+      return nCapacity;
+    }
+  public:
+    OdIdHashMap() : m_nSize(0), m_bHasNull(false), m_nullValue() { }
+    explicit OdIdHashMap(size_type nReserve) : m_nSize(0), m_bHasNull(false), m_nullValue()
+    {
+      reserve(nReserve);
+    }
+
+    /** \details
+        Returns number of mapped identifiers.
+    */
+    size_type size() const { return m_nSize + (m_bHasNull ? 1 : 0); }
+    bool empty() const { return !size(); }
+    /** \details
+        Returns current hash table capacity.
+    */
+    size_type capacity() const { return m_entries.size(); }
+
+    /** \details
+        Reserves hash table for specified number of identifiers.
+    */
+    void reserve(size_type nEntries)
+    {
+      const size_type nCapacity = capacityFor(nEntries);
+      if (nCapacity > m_entries.size())
+        rehash(nCapacity);
+    }
+    /** \details
+        Reserves hash table for identifiers of database with specified handseed.
+        \remarks
+        Reserved number of entries is limited by kMaxHandseedReserve, table grows on demand beyond this limit.
+    */
+    void reserveByHandseed(const OdDbHandle& handseed)
+    {
+      const OdUInt64 nHandseed = (OdUInt64)handseed;
+      reserve((nHandseed > (OdUInt64)kMaxHandseedReserve) ? (size_type)kMaxHandseedReserve : (size_type)nHandseed);
+    }
+
+    void clear()
+    {
+      m_entries.clear();
+      m_nSize = 0;
+      m_bHasNull = false;
+      m_nullValue = TValue();
+    }
+
+    /** \details
+        Returns pointer to value mapped to identifier or NULL if identifier isn't mapped.
+    */
+    const TValue* find(const TId& id) const
+    {
+      if (id.isNull())
+        return m_bHasNull ? &m_nullValue : NULL;
+      if (!m_nSize)
+        return NULL;
+      const Entry* pEntries = m_entries.getPtr();
+      const size_type nSlot = findSlot(pEntries, id);
+      return pEntries[nSlot].m_id.isNull() ? NULL : &pEntries[nSlot].m_value;
+    }
+    TValue* find(const TId& id)
+    {
+      if (id.isNull())
+        return m_bHasNull ? &m_nullValue : NULL;
+      if (!m_nSize)
+        return NULL;
+      Entry* pEntries = m_entries.asArrayPtr();
+      const size_type nSlot = findSlot(pEntries, id);
+      return pEntries[nSlot].m_id.isNull() ? NULL : &pEntries[nSlot].m_value;
+    }
+    bool contains(const TId& id) const { return find(id) != NULL; }
+
+    /** \details
+        Returns reference to value mapped to identifier. Maps identifier to default value if it isn't mapped yet.
+    */
+    TValue& operator [](const TId& id)
+    {
+      if (id.isNull())
+      {
+        if (!m_bHasNull)
+          m_bHasNull = true, m_nullValue = TValue();
+        return m_nullValue;
+      }
+      if (m_nSize + 1 > m_entries.size() - (m_entries.size() >> 2))
+        rehash(capacityFor(m_nSize + 1));
+      Entry* pEntries = m_entries.asArrayPtr();
+      const size_type nSlot = findSlot(pEntries, id);
+      if (pEntries[nSlot].m_id.isNull())
+      {
+        pEntries[nSlot].m_id = id;
+        pEntries[nSlot].m_value = TValue();
+        m_nSize++;
+      }
+      return pEntries[nSlot].m_value;
+    }
+    void insert(const TId& id, const TValue& value)
+    {
+      (*this)[id] = value;
+    }
+
+    /** \details
+        Removes identifier from map. Returns false if identifier isn't mapped.
+    */
+    bool erase(const TId& id)
+    {
+      if (id.isNull())
+      {
+        const bool bHad = m_bHasNull;
+        m_bHasNull = false;
+        m_nullValue = TValue();
+        return bHad;
+      }
+      if (!m_nSize)
+        return false;
+      Entry* pEntries = m_entries.asArrayPtr();
+      const size_type nMask = mask();
+      size_type nSlot = findSlot(pEntries, id);
+      if (pEntries[nSlot].m_id.isNull())
+        return false;
+      // Backward shift of following entries of the probe sequence
+      size_type nNext = nSlot;
+      for (;;)
+      {
+        nNext = (nNext + 1) & nMask;
+        if (pEntries[nNext].m_id.isNull())
+          break;
+        const size_type nHome = hashOf(pEntries[nNext].m_id) & nMask;
+        // Entry may be moved into freed slot if its home slot isn't in (nSlot, nNext] cyclic range
+        if ((nSlot <= nNext) ? ((nHome <= nSlot) || (nHome > nNext)) : ((nHome <= nSlot) && (nHome > nNext)))
+        {
+          pEntries[nSlot] = pEntries[nNext];
+          nSlot = nNext;
+        }
+      }
+      pEntries[nSlot] = Entry();
+      m_nSize--;
+      return true;
+    }
+
+    /** \details
+        Calls functor for each mapped identifier and value: fn(const TId&, TValue&).
+    */
+    template <class TFn>
+    void forEach(TFn &fn)
+    {
+      if (m_bHasNull)
+        fn(TId(), m_nullValue);
+      if (!m_nSize)
+        return;
+      Entry* pEntries = m_entries.asArrayPtr();
+      const size_type nEntries = m_entries.size();
+      for (size_type nEntry = 0; nEntry < nEntries; nEntry++)
+      {
+        if (!pEntries[nEntry].m_id.isNull())
+          fn(pEntries[nEntry].m_id, pEntries[nEntry].m_value);
+      }
+    }
+};
+
+#include "TD_PackPop.h"
+
+#endif // ODIDHASHMAP_H_INCLUDED
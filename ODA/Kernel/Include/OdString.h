@@ -1458,6 +1458,125 @@ public:
 
 //////////////////////////////////////////////////////////////////////////
 
+/** \details
+    This class implements non-owning read-only view of a character string.
+
+    \remarks
+    View stores only pointer to the first character and number of characters, viewed
+    characters are not necessary 0 terminated. Unlike copying of OdString,
+    constructing, copying and destroying of view doesn't modify reference counter of
+    string data, so views could be passed between threads which concurrently read the
+    same string without contention on the counter.
+    
+    View is valid while viewed string is alive and isn't modified.
+
+    <group Other_Classes>
+*/
+class OdStringView
+{
+public:
+  /** \details
+    Constructs empty view.
+  */
+  OdStringView() : m_pStr(0), m_nLength(0) { }
+
+  /** \details
+    Constructs view of 0 terminated string.
+    \param pStr [in]  0 terminated string or NULL.
+  */
+  OdStringView(const OdChar* pStr) : m_pStr(pStr), m_nLength(pStr ? (int)odStrLen((const wchar_t*)pStr) : 0) { }
+
+  /** \details
+    Constructs view of specified characters.
+    \param pStr [in]  Pointer to the first character.
+    \param nLength [in]  Number of characters.
+  */
+  OdStringView(const OdChar* pStr, int nLength) : m_pStr(pStr), m_nLength(nLength) { }
+
+  /** \details
+    Constructs view of specified String object.
+    \param str [in]  String to view.
+  */
+  OdStringView(const OdString& str) : m_pStr(str.c_str()), m_nLength(str.getLength()) { }
+
+  /** \details
+    Returns pointer to the first character of this view.
+    \remarks
+    Characters are 0 terminated only if view is constructed from 0 terminated string.
+  */
+  const OdChar* data() const { return m_pStr; }
+
+  /** \details
+    Returns the number of characters in this view.
+  */
+  int getLength() const { return m_nLength; }
+
+  /** \details
+    Returns true if and only if this view has no characters.
+  */
+  bool isEmpty() const { return m_nLength == 0; }
+
+  /** \details
+    Returns the character at the specified index.
+    \param charIndex [in]  Character index.
+  */
+  OdChar operator [](int charIndex) const
+  {
+    ODA_ASSERT(charIndex >= 0 && charIndex < m_nLength);
+    return m_pStr[charIndex];
+  }
+
+  /** \details
+    Returns view of part of characters of this view.
+    \param startIndex [in]  Index of the first character.
+    \param length [in]  Number of characters, clamped by the end of this view.
+  */
+  OdStringView mid(int startIndex, int length) const
+  {
+    ODA_ASSERT(startIndex >= 0 && startIndex <= m_nLength);
+    if (length > m_nLength - startIndex)
+      length = m_nLength - startIndex;
+    return OdStringView(m_pStr + startIndex, length);
+  }
+
+  /** \details
+    Compares this view with the specified one character by character.
+    \param other [in]  View to compare with.
+    \remarks
+    Returns zero if views are equal, negative value if this view is less than other, positive value otherwise.
+  */
+  int compare(const OdStringView& other) const
+  {
+    const int nLength = (m_nLength < other.m_nLength) ? m_nLength : other.m_nLength;
+    for (int i = 0; i < nLength; ++i)
+    {
+      if (m_pStr[i] != other.m_pStr[i])
+        return (m_pStr[i] < other.m_pStr[i]) ? -1 : 1;
+    }
+    return m_nLength - other.m_nLength;
+  }
+
+  bool operator ==(const OdStringView& other) const
+  {
+    return m_nLength == other.m_nLength && !compare(other);
+  }
+
+  bool operator !=(const OdStringView& other) const
+  {
+    return !operator ==(other);
+  }
+
+  /** \details
+    Returns String object which contains copy of characters of this view.
+  */
+  OdString toString() const { return m_nLength ? OdString(m_pStr, m_nLength) : OdString(); }
+private:
+  const OdChar* m_pStr;
+  int           m_nLength;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
 /** \details
     <group Other_Classes>
 */
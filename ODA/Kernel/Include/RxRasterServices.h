@@ -172,7 +172,13 @@ public:
     // Specify loading format explicitly
     kLoadFmt        = OD_FOURCC(lit_F, lit_M, lit_T, lit_ ),
     // Avoids post-reorientation of TIFF format images
-    kNoTIFFRotation = OD_FOURCC(lit_N, lit_T, lit_F, lit_R)
+    kNoTIFFRotation = OD_FOURCC(lit_N, lit_T, lit_F, lit_R),
+    // Load image as lazily decoded tiled image with mip levels (value is tile size, 0 for default).
+    // Only uncompressed BMP files are read region by region; other formats are decoded entirely
+    // on first tile request and the decoded image is dropped once tiles and mip levels are built.
+    kLoadTiled      = OD_FOURCC(lit_T, lit_I, lit_L, lit_E),
+    // Memory budget of tiles cache shared by tiled images in megabytes
+    kTileCacheSize  = OD_FOURCC(lit_T, lit_C, lit_S, lit_Z)
   };
 
   // Saving flags
@@ -0,0 +1,702 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SiPackedRTree_h_Included_
+#define _SiPackedRTree_h_Included_
+
+#include "Si/SiSpatialIndex.h"
+#include "RxObjectImpl.h"
+#include "ThreadsCounter.h"
+#include "Ge/GeDoubleArray.h"
+#define STL_USING_ALGORITHM
+#define STL_USING_VECTOR
+#include "OdaSTL.h"
+#include <math.h>
+
+#include "TD_PackPush.h"
+
+typedef OdArray<OdSiEntity*, OdMemoryAllocator<OdSiEntity*> > OdSiEntityPtrArray;
+
+/** \details
+    This class represents Spatial Index Batch Visitor objects.
+    Receives results of OdSiPackedRTree::queryBatch() together with index of the
+    query shape.
+    Corresponding C++ library: SpatialIndex
+    <group OdSi_Classes>
+*/
+struct OdSiBatchVisitor
+{
+  /** 
+    \param nShape [in] Index of shape in the array of query shapes.
+    \param entity [in] Pointer to any OdSiEntity object.
+    \param completelyInside [in] True if entity extents are completely inside the shape.
+  */
+  virtual void visit( OdUInt32 nShape, OdSiEntity* entity, bool completelyInside ) = 0;
+};
+
+/** \details
+    This class represents bulk loaded, packed R-tree Spatial Index objects.
+
+    Entities are packed into the tree by Sort-Tile-Recursive algorithm when the
+    index is built. Tree nodes are stored in one contiguous array and entities
+    of each subtree are stored contiguously, so subtrees which are completely
+    inside the query shape are reported without traversal.
+
+    Index is intended for mostly static data: insert() only marks the tree as modified
+    and it is rebuilt by build() or by the first query. remove() marks entity of built
+    tree as removed, tree is rebuilt only when removed entities make a quarter of the index.
+    Queries don't modify built tree, so after build() the index can be queried from
+    multiple threads concurrently. Tree which is modified is rebuilt once, even if it is
+    queried from multiple threads. Modifications concurrent with queries require
+    kSiAccessMtAware and kSiModifyMtAware flags.
+
+    Entities without proper extents are reported by every query as partially inside
+    the query shape, in the same way as by OdSiSpatialIndex. They are skipped by nearest().
+
+    In addition to OdSiSpatialIndex interface the class provides batched
+    multi-shape queries and k-nearest-neighbour queries.
+    Corresponding C++ library: SpatialIndex
+    <group OdSi_Classes>
+*/
+class OdSiPackedRTree : public OdSiSpatialIndex
+{
+protected:
+  struct Node
+  {
+    OdGeExtents3d m_ext;
+    OdUInt32 m_firstChild; // index of first child node
+    OdUInt32 m_nChildren;  // zero for leaf nodes
+    OdUInt32 m_firstEnt;   // first entity of the subtree
+    OdUInt32 m_nEnts;      // number of entities in the subtree
+  };
+  struct Item
+  {
+    OdGeExtents3d m_ext;
+    double m_center[3];
+    OdUInt32 m_index;
+  };
+  struct ItemLess
+  {
+    int m_axis;
+    ItemLess(int axis) : m_axis(axis) { }
+    bool operator ()(const Item& i1, const Item& i2) const { return i1.m_center[m_axis] < i2.m_center[m_axis]; }
+  };
+  struct HeapEntry
+  {
+    double m_dist;
+    OdUInt32 m_index;
+    bool m_bEntity;
+    bool operator <(const HeapEntry& e2) const { return m_dist > e2.m_dist; } // min-heap
+  };
+  enum { kNotFound = 0xFFFFFFFF };
+
+  // Entities: bounded in tree order, unbounded, then inserted after the last build.
+  // Removed entities of built tree are NULL until the next build.
+  std::vector<OdSiEntity*> m_entities;
+  std::vector<OdGeExtents3d> m_entExt;  // extents of bounded entities
+  std::vector<Node> m_nodes;            // root first
+  OdUInt32 m_nBounded;
+  OdUInt32 m_nBuilt;                    // number of entities packed by the last build
+  OdUInt32 m_nRemoved;                  // number of removed entities of built tree
+  OdUInt32 m_flags;
+  OdUInt32 m_nMaxNodeSize;
+  double m_eps;
+  OdGeTol m_tol;
+  bool m_bCustomTol;                    // tolerance is set by setTolerance(), don't scale it by extents
+  OdVolatile m_nModified;               // tree must be rebuilt before queries, reset after built tree is published
+  mutable OdMutex m_mutex;
+
+  OdSiPackedRTree()
+    : m_nBounded(0), m_nBuilt(0), m_nRemoved(0), m_flags(kSiNoFlags), m_nMaxNodeSize(16), m_eps(1e-10)
+    , m_bCustomTol(false), m_nModified(0)
+  { }
+
+  bool isPlanar() const { return GETBIT(m_flags, kSiPlanar); }
+  OdMutex* modifyMutex() const { return GETBIT(m_flags, kSiModifyMtAware) ? &m_mutex : NULL; }
+  OdMutex* accessMutex() const { return GETBIT(m_flags, kSiAccessMtAware) ? &m_mutex : NULL; }
+
+  static void strSort(Item* pBegin, Item* pEnd, int axis, int nDims, OdUInt32 nNodeSize)
+  {
+    std::sort(pBegin, pEnd, ItemLess(axis));
+    if (axis == nDims - 1)
+      return;
+    const OdUInt32 nItems = OdUInt32(pEnd - pBegin);
+    const OdUInt32 nNodes = (nItems + nNodeSize - 1) / nNodeSize;
+    const OdUInt32 nSlices = (OdUInt32)ceil(pow(double(nNodes), 1.0 / double(nDims - axis)));
+    const OdUInt32 nSliceItems = ((nNodes + nSlices - 1) / nSlices) * nNodeSize;
+    for (Item* pSlice = pBegin; pSlice < pEnd; pSlice += nSliceItems)
+      strSort(pSlice, odmin(pSlice + nSliceItems, pEnd), axis + 1, nDims, nNodeSize);
+  }
+  static void setItem(Item& item, const OdGeExtents3d& ext, OdUInt32 nIndex)
+  {
+    item.m_ext = ext;
+    item.m_center[0] = (ext.minPoint().x + ext.maxPoint().x) * 0.5;
+    item.m_center[1] = (ext.minPoint().y + ext.maxPoint().y) * 0.5;
+    item.m_center[2] = (ext.minPoint().z + ext.maxPoint().z) * 0.5;
+    item.m_index = nIndex;
+  }
+  double distance2(const OdGeExtents3d& ext, const OdGePoint3d& pt) const
+  {
+    double d2 = 0.0;
+    for (int nAxis = 0, nDims = isPlanar() ? 2 : 3; nAxis < nDims; nAxis++)
+    {
+      const double v = pt[nAxis], vMin = ext.minPoint()[nAxis], vMax = ext.maxPoint()[nAxis];
+      if (v < vMin)
+        d2 += (vMin - v) * (vMin - v);
+      else if (v > vMax)
+        d2 += (v - vMax) * (v - vMax);
+    }
+    return d2;
+  }
+
+  // Packs all entities which aren't removed. Called with m_mutex locked. Tree is built
+  // in local arrays and published when it is complete, modification flag is reset last.
+  void rebuild()
+  {
+    std::vector<Node> nodes;
+    std::vector<OdGeExtents3d> entExt;
+    std::vector<OdSiEntity*> entities;
+    std::vector<Item> items;
+    std::vector<OdSiEntity*> unbounded;
+    items.reserve(m_entities.size());
+    OdGeExtents3d ext;
+    for (OdUInt32 nEnt = 0; nEnt < m_entities.size(); nEnt++)
+    {
+      if (!m_entities[nEnt])
+        continue;
+      if (m_entities[nEnt]->extents(ext) && OdSi::properExtents(ext))
+      {
+        items.resize(items.size() + 1);
+        setItem(items.back(), ext, nEnt);
+      }
+      else
+        unbounded.push_back(m_entities[nEnt]);
+    }
+    const OdUInt32 nBounded = (OdUInt32)items.size();
+    entities.reserve(nBounded + unbounded.size());
+    if (!items.empty())
+    {
+      const int nDims = isPlanar() ? 2 : 3;
+      const OdUInt32 nNodeSize = m_nMaxNodeSize;
+      // Pack levels bottom-up. Leaves reference ranges of STR sorted entities,
+      // upper nodes reference ranges of the level below (reordered while packed).
+      std::vector<Item> entItems;
+      strSort(&items[0], &items[0] + items.size(), 0, nDims, nNodeSize);
+      entItems.swap(items);
+      std::vector< std::vector<Node> > levels(1);
+      for (OdUInt32 nItem = 0; nItem < entItems.size(); nItem++)
+      {
+        if (nItem % nNodeSize == 0)
+        {
+          levels[0].resize(levels[0].size() + 1);
+          Node& node = levels[0].back();
+          node.m_firstChild = node.m_nChildren = node.m_nEnts = 0;
+          node.m_firstEnt = nItem;
+        }
+        levels[0].back().m_ext.addExt(entItems[nItem].m_ext);
+        levels[0].back().m_nEnts++;
+      }
+      while (levels.back().size() > 1)
+      {
+        std::vector<Node>& level = levels.back();
+        items.resize(level.size());
+        for (OdUInt32 nNode = 0; nNode < level.size(); nNode++)
+          setItem(items[nNode], level[nNode].m_ext, nNode);
+        strSort(&items[0], &items[0] + items.size(), 0, nDims, nNodeSize);
+        std::vector<Node> packed(level.size()), parents;
+        for (OdUInt32 nNode = 0; nNode < level.size(); nNode++)
+        {
+          packed[nNode] = level[items[nNode].m_index];
+          if (nNode % nNodeSize == 0)
+          {
+            parents.resize(parents.size() + 1);
+            Node& node = parents.back();
+            node.m_firstChild = nNode;
+            node.m_nChildren = node.m_firstEnt = node.m_nEnts = 0;
+          }
+          parents.back().m_ext.addExt(packed[nNode].m_ext);
+          parents.back().m_nChildren++;
+        }
+        level.swap(packed);
+        levels.push_back(std::vector<Node>());
+        levels.back().swap(parents);
+      }
+      // Lay out nodes breadth-first from the root. Children of each node and
+      // leaves of each subtree become contiguous.
+      std::vector<std::pair<OdUInt32, OdUInt32> > queue; // level, index
+      queue.reserve(levels.size() * levels[0].size());
+      queue.push_back(std::make_pair(OdUInt32(levels.size() - 1), OdUInt32(0)));
+      nodes.reserve(queue.capacity());
+      for (OdUInt32 nQueued = 0; nQueued < queue.size(); nQueued++)
+      {
+        const OdUInt32 nLevel = queue[nQueued].first;
+        nodes.push_back(levels[nLevel][queue[nQueued].second]);
+        Node& node = nodes.back();
+        if (node.m_nChildren)
+        {
+          const OdUInt32 nFirst = node.m_firstChild;
+          node.m_firstChild = (OdUInt32)queue.size();
+          for (OdUInt32 nChild = 0; nChild < node.m_nChildren; nChild++)
+            queue.push_back(std::make_pair(nLevel - 1, nFirst + nChild));
+        }
+      }
+      // Store entities in leaf order (leaves are the last block of nodes) and
+      // compute entity ranges of subtrees
+      entExt.reserve(nBounded);
+      const OdUInt32 nFirstLeaf = OdUInt32(nodes.size() - levels[0].size());
+      for (OdUInt32 nLeaf = nFirstLeaf; nLeaf < nodes.size(); nLeaf++)
+      {
+        Node& leaf = nodes[nLeaf];
+        const OdUInt32 nFirst = leaf.m_firstEnt;
+        leaf.m_firstEnt = (OdUInt32)entities.size();
+        for (OdUInt32 nEnt = nFirst; nEnt < nFirst + leaf.m_nEnts; nEnt++)
+        {
+          entities.push_back(m_entities[entItems[nEnt].m_index]);
+          entExt.push_back(entItems[nEnt].m_ext);
+        }
+      }
+      for (OdUInt32 nNode = nFirstLeaf; nNode-- > 0; )
+      {
+        Node& node = nodes[nNode];
+        const Node& lastChild = nodes[node.m_firstChild + node.m_nChildren - 1];
+        node.m_firstEnt = nodes[node.m_firstChild].m_firstEnt;
+        node.m_nEnts = lastChild.m_firstEnt + lastChild.m_nEnts - node.m_firstEnt;
+      }
+    }
+    entities.insert(entities.end(), unbounded.begin(), unbounded.end());
+    // Publish built tree
+    m_nodes.swap(nodes);
+    m_entExt.swap(entExt);
+    m_entities.swap(entities);
+    m_nBounded = nBounded;
+    m_nBuilt = (OdUInt32)m_entities.size();
+    m_nRemoved = 0;
+    if (!m_bCustomTol && !m_nodes.empty())
+    {
+      const OdGeExtents3d& rootExt = m_nodes[0].m_ext;
+      const double diag = (rootExt.maxPoint() - rootExt.minPoint()).length();
+      m_tol.setEqualVector(m_eps);
+      m_tol.setEqualPoint(m_eps * odmax(diag, 1.0));
+    }
+    m_nModified = 0;
+  }
+
+  // Rebuilds modified tree. If bLocked is true, m_mutex is already locked by the caller.
+  void ensureBuilt(bool bLocked) const
+  {
+    if (!(int)m_nModified)
+      return;
+    OdSiPackedRTree* pThis = const_cast<OdSiPackedRTree*>(this);
+    if (bLocked)
+    {
+      pThis->rebuild();
+      return;
+    }
+    TD_AUTOLOCK(m_mutex);
+    if ((int)m_nModified)
+      pThis->rebuild();
+  }
+  void visitRange(OdUInt32 nFirst, OdUInt32 nCount, OdSiVisitor& visitor, bool completelyInside) const
+  {
+    for (OdUInt32 nEnt = nFirst; nEnt < nFirst + nCount; nEnt++)
+    {
+      if (m_entities[nEnt])
+        visitor.visit(m_entities[nEnt], completelyInside);
+    }
+  }
+  // Returns index of entity in built tree or kNotFound
+  OdUInt32 findBuilt(OdSiEntity* entity) const
+  {
+    OdGeExtents3d ext;
+    if (!m_nodes.empty() && entity->extents(ext) && OdSi::properExtents(ext))
+    {
+      // Only leaves which extents intersect current entity extents are searched
+      std::vector<OdUInt32> stack(1, 0);
+      while (!stack.empty())
+      {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+        if (node.m_ext.isDisjoint(ext, m_tol))
+          continue;
+        if (node.m_nChildren)
+        {
+          for (OdUInt32 nChild = node.m_firstChild; nChild < node.m_firstChild + node.m_nChildren; nChild++)
+            stack.push_back(nChild);
+          continue;
+        }
+        for (OdUInt32 nEnt = node.m_firstEnt; nEnt < node.m_firstEnt + node.m_nEnts; nEnt++)
+        {
+          if (m_entities[nEnt] == entity)
+            return nEnt;
+        }
+      }
+      for (OdUInt32 nEnt = m_nBounded; nEnt < m_nBuilt; nEnt++)
+      {
+        if (m_entities[nEnt] == entity)
+          return nEnt;
+      }
+    }
+    // Entity extents were changed after the build
+    for (OdUInt32 nEnt = 0; nEnt < m_nBuilt; nEnt++)
+    {
+      if (m_entities[nEnt] == entity)
+        return nEnt;
+    }
+    return kNotFound;
+  }
+  void queryBatchNode(OdUInt32 nNode, OdUInt32 nActive, OdUInt32 nActiveCount, const OdSiShapeConstPtrArray& shapes,
+                      OdSiBatchVisitor& visitor, std::vector<OdUInt32>& active) const
+  {
+    const Node& node = m_nodes[nNode];
+    const OdUInt32 nBase = (OdUInt32)active.size();
+    for (OdUInt32 n = nActive; n < nActive + nActiveCount; n++)
+    {
+      const OdUInt32 nShape = active[n];
+      if (!shapes[nShape]->intersects(node.m_ext, isPlanar(), m_tol))
+        continue;
+      if (shapes[nShape]->contains(node.m_ext, isPlanar(), m_tol))
+      {
+        for (OdUInt32 nEnt = node.m_firstEnt; nEnt < node.m_firstEnt + node.m_nEnts; nEnt++)
+        {
+          if (m_entities[nEnt])
+            visitor.visit(nShape, m_entities[nEnt], true);
+        }
+      }
+      else
+        active.push_back(nShape);
+    }
+    const OdUInt32 nPartial = OdUInt32(active.size()) - nBase;
+    if (!nPartial)
+      return;
+    if (node.m_nChildren)
+    {
+      for (OdUInt32 nChild = node.m_firstChild; nChild < node.m_firstChild + node.m_nChildren; nChild++)
+        queryBatchNode(nChild, nBase, nPartial, shapes, visitor, active);
+    }
+    else
+    {
+      for (OdUInt32 nEnt = node.m_firstEnt; nEnt < node.m_firstEnt + node.m_nEnts; nEnt++)
+      {
+        if (!m_entities[nEnt])
+          continue;
+        for (OdUInt32 n = nBase; n < nBase + nPartial; n++)
+        {
+          const OdSiShape* pShape = shapes[active[n]];
+          if (pShape->contains(m_entExt[nEnt], isPlanar(), m_tol))
+            visitor.visit(active[n], m_entities[nEnt], true);
+          else if (pShape->intersects(m_entExt[nEnt], isPlanar(), m_tol))
+            visitor.visit(active[n], m_entities[nEnt], false);
+        }
+      }
+    }
+    active.resize(nBase);
+  }
+public:
+  /** \details
+    Creates a packed R-tree SpatialIndex object with the specified parameters.
+    \param flags [in]  Specifies set of flags for Spatial Index creation.
+    \param initialNumEntity [in]  Expected number of entities.
+    \param maxCount [in]  Maximum number of entities or children in tree node.
+    \param eps [in]  Relative tolerance (equalVector).
+  */
+  static OdSmartPtr<OdSiPackedRTree> createObject( OdUInt32 flags, unsigned int initialNumEntity = 0, unsigned int maxCount = 16, double eps = 1e-10 )
+  {
+    OdSmartPtr<OdSiPackedRTree> pIndex = OdRxObjectImpl<OdSiPackedRTree>::createObject();
+    pIndex->m_flags = flags;
+    pIndex->m_eps = eps;
+    pIndex->m_tol = OdGeTol(eps, eps);
+    pIndex->setMaxNodeSize((unsigned char)odmin(maxCount, 255u));
+    pIndex->m_entities.reserve(initialNumEntity);
+    return pIndex;
+  }
+
+  virtual void insert( OdSiEntity* entity )
+  {
+    TD_AUTOLOCK_P(modifyMutex());
+    m_entities.push_back(entity);
+    m_nModified = 1;
+  }
+  /** \details
+    Inserts the specified SiEntity objects into the this SpatialIndex object.
+    \param entities [in]  Array of pointers to the OdSiEntity objects to insert.
+    \param nEntities [in]  Number of entities.
+  */
+  void insert( OdSiEntity* const* entities, OdUInt32 nEntities )
+  {
+    TD_AUTOLOCK_P(modifyMutex());
+    m_entities.insert(m_entities.end(), entities, entities + nEntities);
+    m_nModified = 1;
+  }
+  virtual bool remove( OdSiEntity* entity )
+  {
+    TD_AUTOLOCK_P(modifyMutex());
+    // Entities inserted after the last build aren't ordered
+    for (OdUInt32 nEnt = m_nBuilt; nEnt < m_entities.size(); nEnt++)
+    {
+      if (m_entities[nEnt] == entity)
+      {
+        m_entities[nEnt] = m_entities.back();
+        m_entities.pop_back();
+        return true;
+      }
+    }
+    const OdUInt32 nEnt = findBuilt(entity);
+    if (nEnt == kNotFound)
+      return false;
+    m_entities[nEnt] = NULL;
+    if (++m_nRemoved * 4 > m_nBuilt)
+      m_nModified = 1;
+    return true;
+  }
+  virtual void clear()
+  {
+    TD_AUTOLOCK_P(modifyMutex());
+    m_entities.clear();
+    m_entExt.clear();
+    m_nodes.clear();
+    m_nBounded = m_nBuilt = m_nRemoved = 0;
+    m_nModified = 0;
+  }
+
+  /** \details
+    Packs the tree if it was modified since the last build.
+    \remarks
+    Call this method after modifications to avoid rebuilding by the first query.
+  */
+  void build()
+  {
+    TD_AUTOLOCK(m_mutex);
+    if ((int)m_nModified)
+      rebuild();
+  }
+
+  virtual void query( const OdSiShape& shape, OdSiVisitor& visitor ) const
+  {
+    TD_AUTOLOCK_P(accessMutex());
+    ensureBuilt(accessMutex() != NULL);
+    if (OdSiShape::isNoSpace(&shape))
+      return;
+    if (OdSiShape::isOverallSpace(&shape))
+    {
+      visitRange(0, m_nBuilt, visitor, true);
+      return;
+    }
+    visitRange(m_nBounded, m_nBuilt - m_nBounded, visitor, false);
+    if (m_nodes.empty())
+      return;
+    std::vector<OdUInt32> stack(1, 0);
+    while (!stack.empty())
+    {
+      const Node& node = m_nodes[stack.back()];
+      stack.pop_back();
+      if (!shape.intersects(node.m_ext, isPlanar(), m_tol))
+        continue;
+      if (shape.contains(node.m_ext, isPlanar(), m_tol))
+        visitRange(node.m_firstEnt, node.m_nEnts, visitor, true);
+      else if (node.m_nChildren)
+      {
+        for (OdUInt32 nChild = node.m_firstChild + node.m_nChildren; nChild-- > node.m_firstChild; )
+          stack.push_back(nChild);
+      }
+      else
+      {
+        for (OdUInt32 nEnt = node.m_firstEnt; nEnt < node.m_firstEnt + node.m_nEnts; nEnt++)
+        {
+          if (!m_entities[nEnt])
+            continue;
+          if (shape.contains(m_entExt[nEnt], isPlanar(), m_tol))
+            visitor.visit(m_entities[nEnt], true);
+          else if (shape.intersects(m_entExt[nEnt], isPlanar(), m_tol))
+            visitor.visit(m_entities[nEnt], false);
+        }
+      }
+    }
+  }
+
+  /** \details
+    Queries set of shapes by single traversal of the tree. Each node is tested
+    only against shapes which partially intersect its parent.
+    \param shapes [in]  Array of query shapes.
+    \param visitor [in]  Receives entities together with index of the shape.
+  */
+  void queryBatch( const OdSiShapeConstPtrArray& shapes, OdSiBatchVisitor& visitor ) const
+  {
+    TD_AUTOLOCK_P(accessMutex());
+    ensureBuilt(accessMutex() != NULL);
+    std::vector<OdUInt32> active;
+    active.reserve(shapes.size() * 4);
+    for (OdUInt32 nShape = 0; nShape < shapes.size(); nShape++)
+    {
+      if (OdSiShape::isNoSpace(shapes[nShape]))
+        continue;
+      const bool bOverall = OdSiShape::isOverallSpace(shapes[nShape]);
+      for (OdUInt32 nEnt = bOverall ? 0 : m_nBounded; nEnt < m_nBuilt; nEnt++)
+      {
+        if (m_entities[nEnt])
+          visitor.visit(nShape, m_entities[nEnt], bOverall);
+      }
+      if (!bOverall)
+        active.push_back(nShape);
+    }
+    if (!active.empty() && !m_nodes.empty())
+      queryBatchNode(0, 0, (OdUInt32)active.size(), shapes, visitor, active);
+  }
+
+  /** \details
+    Finds entities nearest to the specified point. Distance is measured to
+    entity extents, so it is zero for all entities which extents contain the point.
+    \param point [in]  Query point.
+    \param nCount [in]  Maximal number of entities to find.
+    \param entities [out]  Receives entities ordered by distance.
+    \param pDistances [out]  Optional, receives distances to found entities.
+    \param maxDistance [in]  Entities farther than this distance are skipped.
+    \returns
+    Returns number of found entities.
+  */
+  OdUInt32 nearest( const OdGePoint3d& point, OdUInt32 nCount, OdSiEntityPtrArray& entities,
+                    OdGeDoubleArray* pDistances = NULL, double maxDistance = 1e300 ) const
+  {
+    TD_AUTOLOCK_P(accessMutex());
+    ensureBuilt(accessMutex() != NULL);
+    entities.clear();
+    if (pDistances)
+      pDistances->clear();
+    if (!nCount || m_nodes.empty())
+      return 0;
+    const double maxDist2 = (maxDistance < 1e150) ? maxDistance * maxDistance : maxDistance;
+    std::vector<HeapEntry> heap;
+    HeapEntry entry;
+    entry.m_dist = distance2(m_nodes[0].m_ext, point);
+    entry.m_index = 0;
+    entry.m_bEntity = false;
+    heap.push_back(entry);
+    while (!heap.empty() && (entities.size() < nCount))
+    {
+      std::pop_heap(heap.begin(), heap.end());
+      const HeapEntry top = heap.back();
+      heap.pop_back();
+      if (top.m_dist > maxDist2)
+        break;
+      if (top.m_bEntity)
+      {
+        entities.push_back(m_entities[top.m_index]);
+        if (pDistances)
+          pDistances->push_back(sqrt(top.m_dist));
+        continue;
+      }
+      const Node& node = m_nodes[top.m_index];
+      entry.m_bEntity = !node.m_nChildren;
+      const OdUInt32 nFirst = entry.m_bEntity ? node.m_firstEnt : node.m_firstChild;
+      const OdUInt32 nLast = nFirst + (entry.m_bEntity ? node.m_nEnts : node.m_nChildren);
+      for (entry.m_index = nFirst; entry.m_index < nLast; entry.m_index++)
+      {
+        if (entry.m_bEntity && !m_entities[entry.m_index])
+          continue;
+        entry.m_dist = distance2(entry.m_bEntity ? m_entExt[entry.m_index] : m_nodes[entry.m_index].m_ext, point);
+        if (entry.m_dist <= maxDist2)
+        {
+          heap.push_back(entry);
+          std::push_heap(heap.begin(), heap.end());
+        }
+      }
+    }
+    return entities.size();
+  }
+
+  /** \details
+    Packed tree depth is defined by number of entities and node size, so this method does nothing.
+  */
+  virtual void setMaxTreeDepth( unsigned char /*maxDepth*/ ) { }
+  virtual void setMaxNodeSize( unsigned char maxCount )
+  {
+    TD_AUTOLOCK_P(modifyMutex());
+    m_nMaxNodeSize = odmax(OdUInt32(maxCount), OdUInt32(2));
+    if (!m_entities.empty())
+      m_nModified = 1;
+  }
+  virtual bool extents( OdGeExtents3d& extents ) const
+  {
+    TD_AUTOLOCK_P(accessMutex());
+    ensureBuilt(accessMutex() != NULL);
+    if (m_nodes.empty())
+      return false;
+    extents = m_nodes[0].m_ext;
+    return true;
+  }
+  /** \details
+    Returns the depth of the packed tree.
+  */
+  virtual unsigned maxTreeDepth() const
+  {
+    TD_AUTOLOCK_P(accessMutex());
+    ensureBuilt(accessMutex() != NULL);
+    unsigned nDepth = 0;
+    for (OdUInt32 nNode = 0; nNode < m_nodes.size(); nNode = m_nodes[nNode].m_nChildren ? m_nodes[nNode].m_firstChild : OdUInt32(m_nodes.size()))
+      nDepth++;
+    return nDepth;
+  }
+  virtual unsigned maxNodeSize() const { return m_nMaxNodeSize; }
+  virtual const OdGeTol& tolerance() const
+  {
+    TD_AUTOLOCK_P(accessMutex());
+    ensureBuilt(accessMutex() != NULL);
+    return m_tol;
+  }
+  /** \details
+    Sets the tolerance. Tolerance set by this method is used as is, it isn't scaled
+    by extents of the index when the tree is rebuilt.
+  */
+  virtual void setTolerance( const OdGeTol& tol )
+  {
+    TD_AUTOLOCK_P(modifyMutex());
+    m_tol = tol;
+    m_eps = tol.equalVector();
+    m_bCustomTol = true;
+  }
+};
+
+typedef OdSmartPtr<OdSiPackedRTree> OdSiPackedRTreePtr;
+
+namespace OdSi
+{
+/** \details
+    Creates SpatialIndex object. Creates OdSiPackedRTree if flags contain
+    OdSiSpatialIndex::kSiPackedRTree, otherwise calls OdSiSpatialIndex::createObject().
+
+    \remarks
+    This is the only entry point which honours kSiPackedRTree: OdSiSpatialIndex::createObject()
+    is implemented by the prebuilt SpatialIndex library and ignores the flag. Indexes created
+    inside prebuilt libraries (for example OdDbPartialViewingIndex) keep the default tree.
+    FacetModeler FaceSpatialIndex::build() passes its flags here.
+*/
+inline OdSiSpatialIndexPtr createSpatialIndex( OdUInt32 flags, unsigned int initialNumEntity, unsigned int maxDepth = 30, unsigned int maxCount = 20, double eps = 1e-10 )
+{
+  if (GETBIT(flags, OdSiSpatialIndex::kSiPackedRTree))
+    return OdSiPackedRTree::createObject(flags, initialNumEntity, maxCount, eps);
+  return OdSiSpatialIndex::createObject(flags, initialNumEntity, maxDepth, maxCount, eps);
+}
+}
+
+#include "TD_PackPop.h"
+
+#endif
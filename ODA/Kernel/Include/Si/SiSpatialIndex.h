@@ -133,7 +133,9 @@ public:
     kSiModifyMtAware = (1 << 1), // Protect insert/remove/clear by mutex object.
     kSiAccessMtAware = (1 << 2), // Protect query/extents/tolerance by mutex object.
 
-    kSiFullMtAware   = (kSiModifyMtAware | kSiAccessMtAware)
+    kSiFullMtAware   = (kSiModifyMtAware | kSiAccessMtAware),
+
+    kSiPackedRTree   = (1 << 3)  // Create bulk loaded packed R-tree. Honoured only by OdSi::createSpatialIndex() in SiPackedRTree.h.
   };
 
   /** \details
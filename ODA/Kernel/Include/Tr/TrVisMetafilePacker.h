@@ -0,0 +1,604 @@
+/////////////////////////////////////////////////////////////////////////////// 
+// Copyright (C) 2002-2021, Open Design Alliance (the "Alliance"). 
+// All rights reserved. 
+// 
+// This software and its documentation and related materials are owned by 
+// the Alliance. The software may only be incorporated into application 
+// programs owned by members of the Alliance, subject to a signed 
+// Membership Agreement and Supplemental Software License Agreement with the
+// Alliance. The structure and organization of this software are the valuable  
+// trade secrets of the Alliance and its suppliers. The software is also 
+// protected by copyright law and international treaty provisions. Application  
+// programs incorporating this software must include the following statement 
+// with their copyright notices:
+//   
+//   This application incorporates Open Design Alliance software pursuant to a license 
+//   agreement with Open Design Alliance.
+//   Open Design Alliance Copyright (C) 2002-2021 by Open Design Alliance. 
+//   All rights reserved.
+//
+// By use of this software, its documentation or related materials, you 
+// acknowledge and accept the above terms.
+///////////////////////////////////////////////////////////////////////////////
+// Packing of metafiles into structure-of-arrays geometry blocks
+
+#ifndef ODTRVISMETAFILEPACKER
+#define ODTRVISMETAFILEPACKER
+
+#include "TD_PackPush.h"
+
+#include "TrVisDefs.h"
+#include "TrVisMetafileStream.h"
+#include "UInt8Array.h"
+#include "UInt16Array.h"
+#include "UInt32Array.h"
+#include "Ge/GePoint3d.h"
+
+/** \details
+  Geometry of consecutive metafiles which share rendering state, packed into large arrays. Positions
+  are quantized into 16 bits per component inside of block extents and stored as separate arrays for
+  each axis. Primitives are converted into points, lines and triangles lists; consecutive primitives
+  of the same list type share one draw call, so draw calls keep the order of source geometry.
+
+  Library: Source code provided.
+
+  <group ExRender_Classes>
+*/
+struct OdTrVisPackedGeometryBlock
+{
+  enum
+  {
+    kQuantizationSteps = 0xFFFF, // Number of quantization steps along block extents
+    kMaxVertices       = 0x10000 // Maximal number of block vertices (addressable by 16-bit indices)
+  };
+  struct DrawCall
+  {
+    OdTrVisGeomPrim m_primType;   // kTrVisPoints, kTrVisLines or kTrVisTriangles
+    OdUInt32        m_firstIndex; // First entry of m_indices
+    OdUInt32        m_nIndices;
+  };
+  struct Source
+  {
+    OdUInt64 m_sourceId;   // Identifier of source metafile
+    OdUInt32 m_nDrawCall;  // Draw call which contains source geometry
+    OdUInt32 m_firstIndex; // First entry of m_indices
+    OdUInt32 m_nIndices;
+  };
+  typedef OdArray<DrawCall, OdMemoryAllocator<DrawCall> > DrawCallArray;
+  typedef OdArray<Source, OdMemoryAllocator<Source> > SourceArray;
+
+  OdUInt8Array  m_state;     // Stream of state records shared by all block geometry
+  OdUInt8       m_geomType;  // OdTrVisGeomType set by state records
+  OdUInt8       m_visFlags;  // OdTrVisVisibilityFlags set by state records
+  OdUInt16Array m_posX;      // Quantized positions
+  OdUInt16Array m_posY;
+  OdUInt16Array m_posZ;
+  OdUInt16Array m_indices;   // Indices of all draw calls
+  DrawCallArray m_drawCalls; // Draw calls in order of source geometry
+  SourceArray   m_sources;   // Source ranges in order of source geometry (source can span several draw calls)
+  double        m_origin[3]; // Position = m_origin + quantized position * m_scale
+  double        m_scale[3];
+
+  OdTrVisPackedGeometryBlock()
+    : m_geomType(OdTrVisGeomType_Default)
+    , m_visFlags(OdTrVisVblFlag_Default)
+  {
+    m_origin[0] = m_origin[1] = m_origin[2] = 0.0;
+    m_scale[0] = m_scale[1] = m_scale[2] = 0.0;
+  }
+
+  OdUInt32 numVertices() const { return m_posX.size(); }
+
+  OdGePoint3d position(OdUInt32 nVertex) const
+  {
+    return OdGePoint3d(m_origin[0] + m_posX[nVertex] * m_scale[0],
+                       m_origin[1] + m_posY[nVertex] * m_scale[1],
+                       m_origin[2] + m_posZ[nVertex] * m_scale[2]);
+  }
+
+  // Writes dequantized positions as interleaved vertex array (for renderers without quantized attributes)
+  void unpackPositions(OdTrVisVertexType *pOut) const
+  { const OdUInt32 nVertices = numVertices();
+    const OdUInt16 *pX = m_posX.getPtr(), *pY = m_posY.getPtr(), *pZ = m_posZ.getPtr();
+    for (OdUInt32 nVertex = 0; nVertex < nVertices; nVertex++, pOut += 3)
+    {
+      pOut[0] = OdTrVisVertexType(m_origin[0] + pX[nVertex] * m_scale[0]);
+      pOut[1] = OdTrVisVertexType(m_origin[1] + pY[nVertex] * m_scale[1]);
+      pOut[2] = OdTrVisVertexType(m_origin[2] + pZ[nVertex] * m_scale[2]);
+    }
+  }
+
+  // Maximal distance along axis between source and dequantized positions
+  double maxError() const
+  {
+    return odmax(m_scale[0], odmax(m_scale[1], m_scale[2])) * 0.5;
+  }
+
+  OdUInt64 memorySize() const
+  {
+    return sizeof(OdTrVisPackedGeometryBlock) + m_state.size() + OdUInt64(numVertices()) * sizeof(OdUInt16) * 3 +
+           OdUInt64(m_indices.size()) * sizeof(OdUInt16) + m_drawCalls.size() * sizeof(DrawCall) + m_sources.size() * sizeof(Source);
+  }
+};
+
+/** \details
+  Merges metafiles which share rendering state into OdTrVisPackedGeometryBlock's. Metafile can be
+  packed if it contains only state records followed by geometry drawn from vertex arrays without
+  colors, normals, texture coordinates and markers; other metafiles must be played as is.
+
+  Packing keeps draw order: metafiles are merged into current block only if their state records
+  match state of the block, otherwise block is completed and next block started. Blocks and their
+  draw calls follow the order in which metafiles are added, so metafiles must be added in display
+  order and metafiles which were rejected must be played between the blocks completed before and
+  after them (call finish() before playing rejected metafile to complete current block).
+
+  Quantization is lossy, so packer requires maximal position error: blocks are split if merged
+  extents can't be quantized within it, and metafiles which can't be quantized within it alone
+  are rejected.
+
+  Library: Source code provided.
+
+  <group ExRender_Classes>
+*/
+class OdTrVisMetafilePacker
+{
+  public:
+    struct Stats
+    {
+      OdUInt32 m_nMetafiles;    // Metafiles passed to packer
+      OdUInt32 m_nPacked;       // Metafiles merged into blocks
+      OdUInt32 m_nBlocks;       // Produced blocks
+      OdUInt64 m_nSrcDrawCalls; // Draw records of packed metafiles
+      OdUInt64 m_nDrawCalls;    // Draw calls of produced blocks
+      OdUInt64 m_nSrcBytes;     // Memory of packed metafiles streams and arrays
+      OdUInt64 m_nBytes;        // Memory of produced blocks
+      double   m_maxError;      // Maximal quantization error
+
+      Stats() { reset(); }
+      void reset()
+      {
+        m_nMetafiles = m_nPacked = m_nBlocks = 0;
+        m_nSrcDrawCalls = m_nDrawCalls = m_nSrcBytes = m_nBytes = 0;
+        m_maxError = 0.0;
+      }
+      void add(const Stats &stats)
+      {
+        m_nMetafiles += stats.m_nMetafiles; m_nPacked += stats.m_nPacked; m_nBlocks += stats.m_nBlocks;
+        m_nSrcDrawCalls += stats.m_nSrcDrawCalls; m_nDrawCalls += stats.m_nDrawCalls;
+        m_nSrcBytes += stats.m_nSrcBytes; m_nBytes += stats.m_nBytes;
+        m_maxError = odmax(m_maxError, stats.m_maxError);
+      }
+      OdInt64 savedDrawCalls() const { return OdInt64(m_nSrcDrawCalls) - OdInt64(m_nDrawCalls); }
+      OdInt64 savedBytes() const { return OdInt64(m_nSrcBytes) - OdInt64(m_nBytes); }
+    };
+  protected:
+    typedef OdArray<OdTrVisVertexType, OdMemoryAllocator<OdTrVisVertexType> > VertexArray;
+    struct PendingBlock
+    {
+      OdUInt8Array  m_state;
+      VertexArray   m_vertices; // Interleaved positions
+      OdUInt16Array m_indices;
+      OdTrVisPackedGeometryBlock::DrawCallArray m_drawCalls;
+      OdTrVisPackedGeometryBlock::SourceArray m_sources;
+      OdTrVisVertexType m_min[3], m_max[3];
+      OdUInt8       m_geomType;
+      OdUInt8       m_visFlags;
+
+      PendingBlock() : m_geomType(OdTrVisGeomType_Default), m_visFlags(OdTrVisVblFlag_Default) { }
+      OdUInt32 numVertices() const { return m_vertices.size() / 3; }
+      bool hasState(const OdUInt8Array &state) const
+      {
+        return (m_state.size() == state.size()) && !::memcmp(m_state.getPtr(), state.getPtr(), state.size());
+      }
+    };
+  protected:
+    OdArray<OdTrVisPackedGeometryBlock> m_blocks;
+    PendingBlock  m_pending;
+    double        m_tolerance;
+    Stats         m_stats;
+    // Parsed metafile
+    OdUInt8Array  m_mfState;
+    OdUInt8       m_mfGeomType;
+    OdUInt8       m_mfVisFlags;
+    VertexArray   m_mfVertices;
+    OdUInt32Array m_mfIndices;
+    OdTrVisPackedGeometryBlock::DrawCallArray m_mfRuns; // Ranges of m_mfIndices in order of metafile primitives
+    OdUInt32Array m_mfArrayBase;
+    OdUInt32      m_mfDrawCalls;
+  public:
+    // Tolerance is maximal quantization error along axis in metafile coordinates
+    explicit OdTrVisMetafilePacker(double tolerance)
+      : m_tolerance(0.0)
+      , m_mfGeomType(OdTrVisGeomType_Default)
+      , m_mfVisFlags(OdTrVisVblFlag_Default)
+      , m_mfDrawCalls(0)
+    {
+      setTolerance(tolerance);
+    }
+
+    // Maximal quantization error, metafiles which can't be packed within it are rejected. Zero tolerance
+    // accepts only geometry without extent along quantized axes.
+    void setTolerance(double tolerance) { ODA_ASSERT(tolerance >= 0.0); m_tolerance = odmax(tolerance, 0.0); }
+    double tolerance() const { return m_tolerance; }
+
+    // Packs metafile geometry, returns false if metafile can't be packed and must be played as is
+    bool addMetafile(const OdTrVisFlatMetafileContainer *pMf, OdUInt64 sourceId)
+    {
+      m_stats.m_nMetafiles++;
+      if (!pMf || !parse(pMf) || !commit(sourceId))
+        return false;
+      m_stats.m_nPacked++;
+      m_stats.m_nSrcDrawCalls += m_mfDrawCalls;
+      m_stats.m_nSrcBytes += OdUInt64(pMf->size()) + pMf->calcArrayElementsSize();
+      return true;
+    }
+
+    // Completes current block, must be called after last added metafile and before playing rejected metafiles
+    void finish()
+    {
+      sealBlock();
+    }
+
+    OdUInt32 numBlocks() const { return m_blocks.size(); }
+    const OdTrVisPackedGeometryBlock &block(OdUInt32 nBlock) const { return m_blocks[nBlock]; }
+
+    const Stats &stats() const { return m_stats; }
+
+    void clear()
+    {
+      m_blocks.clear();
+      m_pending = PendingBlock();
+      m_stats.reset();
+    }
+  protected:
+    // Returns size of state record data or -1 if record isn't state record
+    static int stateRecordSize(OdTrVisMetaRecType recType, const OdUInt8 *pMemPtr)
+    {
+      switch (recType)
+      {
+        case OdTrVisMetaRecType_Empty:
+        case OdTrVisMetaRecType_UninitTexture:
+        return 0;
+        case OdTrVisMetaRecType_EnableOpt:
+        case OdTrVisMetaRecType_DisableOpt:
+        case OdTrVisMetaRecType_CullFace:
+        case OdTrVisMetaRecType_LStipple:
+        case OdTrVisMetaRecType_PStipple:
+        case OdTrVisMetaRecType_HLRStencil:
+        case OdTrVisMetaRecType_EnableShading:
+        case OdTrVisMetaRecType_DisableShading:
+        case OdTrVisMetaRecType_VisibilityFlags:
+        case OdTrVisMetaRecType_GeomMarker:
+        return 1;
+        case OdTrVisMetaRecType_Color:
+        case OdTrVisMetaRecType_SelectionStyle:
+        return 4;
+        case OdTrVisMetaRecType_Material:
+        case OdTrVisMetaRecType_Program:
+        case OdTrVisMetaRecType_VisualStyle:
+        return 8;
+        case OdTrVisMetaRecType_InitTexture:
+        return 8 + 1;
+        case OdTrVisMetaRecType_Lineweight:
+        return OdTrVisLwdSetting::isPs((OdTrVisLwdSetting::LwdType)OD_OGL_RDR_READVAL(OdUInt8, pMemPtr)) ?
+               sizeof(OdUInt8) + sizeof(double) : sizeof(OdUInt8) + sizeof(OdInt16);
+        case OdTrVisMetaRecType_Linestyle:
+        return (OD_OGL_RDR_READVAL(OdUInt8, pMemPtr) != 0) ? sizeof(OdUInt8) : sizeof(OdUInt8) * 3;
+        default:
+        return -1;
+      }
+    }
+
+    // Appends vertex array to metafile vertices at first use, returns base vertex
+    bool vertexArrayBase(const OdTrVisFlatMetafileContainer *pMf, OdTrVisArrayId arrayId, OdUInt32 &base, OdUInt32 &nVertices)
+    {
+      if (arrayId >= pMf->arrayElementsSize())
+        return false;
+      const OdTrVisArrayWrapper &arry = pMf->arrayElement(arrayId);
+      if (arry.m_type != OdTrVisArrayWrapper::Type_Vertex)
+        return false;
+      nVertices = arry.m_uSize / (sizeof(OdTrVisVertexType) * 3);
+      base = m_mfArrayBase[arrayId];
+      if (base == 0xFFFFFFFF)
+      {
+        base = m_mfArrayBase[arrayId] = m_mfVertices.size() / 3;
+        m_mfVertices.insert(m_mfVertices.end(), (const OdTrVisVertexType*)arry.m_pData, (const OdTrVisVertexType*)arry.m_pData + nVertices * 3);
+      }
+      return true;
+    }
+
+    // Extends last range if it has the same list type and adjoins, otherwise appends new range
+    static void appendRun(OdTrVisPackedGeometryBlock::DrawCallArray &runs, OdTrVisGeomPrim primType, OdUInt32 firstIndex, OdUInt32 nIndices)
+    {
+      if (!runs.isEmpty() && (runs.last().m_primType == primType) && (runs.last().m_firstIndex + runs.last().m_nIndices == firstIndex))
+        runs.last().m_nIndices += nIndices;
+      else
+      {
+        OdTrVisPackedGeometryBlock::DrawCall run;
+        run.m_primType = primType; run.m_firstIndex = firstIndex; run.m_nIndices = nIndices;
+        runs.push_back(run);
+      }
+    }
+
+    // Converts primitive into points, lines or triangles list
+    bool addPrimitive(OdUInt8 primType, const OdUInt16 *pIndices, OdUInt32 first, OdUInt32 count, OdUInt32 base)
+    {
+#define ODTRVIS_PACKIDX(n) (base + ((pIndices) ? OdUInt32(pIndices[n]) : (first + (n))))
+      const OdUInt32 nFirstIndex = m_mfIndices.size();
+      OdTrVisGeomPrim listType;
+      OdUInt32 nVert;
+      switch (primType)
+      {
+        case kTrVisPoints:
+          listType = kTrVisPoints;
+          for (nVert = 0; nVert < count; nVert++)
+            m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert));
+        break;
+        case kTrVisLines:
+          listType = kTrVisLines;
+          for (nVert = 0; nVert + 1 < count; nVert += 2)
+          { m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert));
+            m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert + 1)); }
+        break;
+        case kTrVisLineLoop:
+        case kTrVisLineStrip:
+          listType = kTrVisLines;
+          for (nVert = 0; nVert + 1 < count; nVert++)
+          { m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert));
+            m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert + 1)); }
+          if ((primType == kTrVisLineLoop) && (count > 2))
+          { m_mfIndices.push_back(ODTRVIS_PACKIDX(count - 1));
+            m_mfIndices.push_back(ODTRVIS_PACKIDX(0)); }
+        break;
+        case kTrVisTriangles:
+          listType = kTrVisTriangles;
+          for (nVert = 0; nVert + 2 < count; nVert += 3)
+          { m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert));
+            m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert + 1));
+            m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert + 2)); }
+        break;
+        case kTrVisTriangleStrip:
+          listType = kTrVisTriangles;
+          for (nVert = 0; nVert + 2 < count; nVert++)
+          { // Keep orientation of odd triangles
+            m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert + (nVert & 1)));
+            m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert + 1 - (nVert & 1)));
+            m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert + 2)); }
+        break;
+        case kTrVisTriangleFan:
+          listType = kTrVisTriangles;
+          for (nVert = 1; nVert + 1 < count; nVert++)
+          { m_mfIndices.push_back(ODTRVIS_PACKIDX(0));
+            m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert));
+            m_mfIndices.push_back(ODTRVIS_PACKIDX(nVert + 1)); }
+        break;
+        default:
+        return false;
+      }
+#undef ODTRVIS_PACKIDX
+      if (m_mfIndices.size() > nFirstIndex)
+        appendRun(m_mfRuns, listType, nFirstIndex, m_mfIndices.size() - nFirstIndex);
+      m_mfDrawCalls++;
+      return true;
+    }
+
+    // Reads metafile stream into state, vertices and primitive lists
+    bool parse(const OdTrVisFlatMetafileContainer *pMf)
+    {
+      m_mfState.clear(); m_mfVertices.clear(); m_mfIndices.clear(); m_mfRuns.clear();
+      m_mfArrayBase.resize(pMf->arrayElementsSize());
+      if (!m_mfArrayBase.isEmpty())
+        m_mfArrayBase.setAll(0xFFFFFFFF);
+      m_mfGeomType = OdTrVisGeomType_Default; m_mfVisFlags = OdTrVisVblFlag_Default;
+      m_mfDrawCalls = 0;
+      OdTrVisArrayId curArray = kTrVisNegativeArrayId;
+      OdUInt32 curBase = 0, curVertices = 0;
+      const OdUInt8 *pMemPtr = pMf->memoryPtr();
+      OD_OGL_RDR_INITIATE(pMemPtr, pMf->size());
+      while (OD_OGL_RDR_CHECKEOF(pMemPtr))
+      {
+        const OdUInt8 *pRecPtr = pMemPtr;
+        const OdTrVisMetaRecType recType = OD_OGL_RDR_READVALRETYPE(OdTrVisMetaRecType, OdUInt8, pMemPtr);
+        OD_OGL_RDR_SEEKINC(pMemPtr);
+        switch (recType)
+        {
+          case OdTrVisMetaRecType_EnableArray:
+            if (OD_OGL_RDR_READVAL(OdUInt8, pMemPtr) != OdTrVisMetaRecArrayType_Vertex)
+              return false;
+            curArray = OD_OGL_RDR_READVALOFFSET(OdUInt32, pMemPtr, 1);
+            if (!vertexArrayBase(pMf, curArray, curBase, curVertices))
+              return false;
+            OD_OGL_RDR_SEEKFWD(pMemPtr, 1 + sizeof(OdUInt32));
+          break;
+          case OdTrVisMetaRecType_DisableArray:
+            if (OD_OGL_RDR_READVAL(OdUInt8, pMemPtr) == OdTrVisMetaRecArrayType_Vertex)
+              curArray = kTrVisNegativeArrayId;
+            OD_OGL_RDR_SEEKINC(pMemPtr);
+          break;
+          case OdTrVisMetaRecType_DrawArrays:
+          { const OdUInt8 primType = OD_OGL_RDR_READVAL(OdUInt8, pMemPtr);
+            const OdInt32 first = OD_OGL_RDR_READVALOFFSET(OdInt32, pMemPtr, 1);
+            const OdInt32 count = OD_OGL_RDR_READVALOFFSET(OdInt32, pMemPtr, 1 + sizeof(OdInt32));
+            if (!isValidTrVisArrayId(curArray) || (first < 0) || (count < 0) || (OdUInt32(first + count) > curVertices) ||
+                !addPrimitive(primType, NULL, OdUInt32(first), OdUInt32(count), curBase))
+              return false;
+            OD_OGL_RDR_SEEKFWD(pMemPtr, (sizeof(OdInt32) << 1) + 1);
+          }
+          break;
+          case OdTrVisMetaRecType_DrawElements:
+          { const OdUInt8 primType = OD_OGL_RDR_READVAL(OdUInt8, pMemPtr);
+            const OdInt32 count = OD_OGL_RDR_READVALOFFSET(OdInt32, pMemPtr, 1);
+            const OdTrVisArrayId idxArray = OD_OGL_RDR_READVALOFFSET(OdUInt32, pMemPtr, 1 + sizeof(OdInt32));
+            if (!isValidTrVisArrayId(curArray) || (count < 0) || (idxArray >= pMf->arrayElementsSize()))
+              return false;
+            const OdTrVisArrayWrapper &arry = pMf->arrayElement(idxArray);
+            if ((arry.m_type != OdTrVisArrayWrapper::Type_Index) || (arry.m_uSize < count * sizeof(OdUInt16)))
+              return false;
+            const OdUInt16 *pIndices = (const OdUInt16*)arry.m_pData;
+            for (OdInt32 nIdx = 0; nIdx < count; nIdx++)
+            {
+              if (pIndices[nIdx] >= curVertices)
+                return false;
+            }
+            if (!addPrimitive(primType, pIndices, 0, OdUInt32(count), curBase))
+              return false;
+            OD_OGL_RDR_SEEKFWD(pMemPtr, sizeof(OdInt32) + 1 + sizeof(OdUInt32));
+          }
+          break;
+          case OdTrVisMetaRecType_VPoint:
+          case OdTrVisMetaRecType_VLine:
+          { const OdUInt32 nPoints = (recType == OdTrVisMetaRecType_VPoint) ? 1 : 2;
+            const OdUInt32 base = m_mfVertices.size() / 3;
+            const float *pFloats = (const float*)pMemPtr;
+            for (OdUInt32 nCoord = 0; nCoord < nPoints * 3; nCoord++)
+              m_mfVertices.push_back(OdTrVisVertexType(pFloats[nCoord]));
+            addPrimitive((nPoints == 1) ? kTrVisPoints : kTrVisLines, NULL, 0, nPoints, base);
+            OD_OGL_RDR_SEEKFWD(pMemPtr, sizeof(float) * 3 * nPoints);
+          }
+          break;
+          case OdTrVisMetaRecType_IPoint:
+          case OdTrVisMetaRecType_ILine:
+          { const OdUInt32 nPoints = (recType == OdTrVisMetaRecType_IPoint) ? 1 : 2;
+            OdUInt16 indices[2];
+            for (OdUInt32 nPoint = 0; nPoint < nPoints; nPoint++)
+            { const OdInt32 nIndex = OD_OGL_RDR_READVALOFFSET(OdInt32, pMemPtr, sizeof(OdInt32) * nPoint);
+              if (!isValidTrVisArrayId(curArray) || (nIndex < 0) || (OdUInt32(nIndex) >= curVertices))
+                return false;
+              indices[nPoint] = OdUInt16(nIndex);
+            }
+            addPrimitive((nPoints == 1) ? kTrVisPoints : kTrVisLines, indices, 0, nPoints, curBase);
+            OD_OGL_RDR_SEEKFWD(pMemPtr, sizeof(OdInt32) * nPoints);
+          }
+          break;
+          default:
+          { const int nSize = stateRecordSize(recType, pMemPtr);
+            if ((nSize < 0) || m_mfDrawCalls) // State changes between primitives aren't packed
+              return false;
+            if (recType == OdTrVisMetaRecType_GeomMarker)
+              m_mfGeomType = OD_OGL_RDR_READVAL(OdUInt8, pMemPtr);
+            else if (recType == OdTrVisMetaRecType_VisibilityFlags)
+              m_mfVisFlags = OD_OGL_RDR_READVAL(OdUInt8, pMemPtr);
+            OD_OGL_RDR_SEEKFWD(pMemPtr, nSize);
+            m_mfState.insert(m_mfState.end(), pRecPtr, pMemPtr);
+          }
+        }
+      }
+      return !m_mfRuns.isEmpty();
+    }
+
+    // Appends parsed metafile to current block, completes current block first if metafile can't be merged into it
+    bool commit(OdUInt64 sourceId)
+    {
+      const OdUInt32 nVertices = m_mfVertices.size() / 3;
+      if (!nVertices || (nVertices > OdTrVisPackedGeometryBlock::kMaxVertices))
+        return false;
+      OdTrVisVertexType vMin[3], vMax[3];
+      calcExtents(m_mfVertices.getPtr(), nVertices, vMin, vMax);
+      if (!isWithinTolerance(vMin, vMax))
+        return false;
+      if (m_pending.numVertices())
+      { OdTrVisVertexType uMin[3], uMax[3];
+        for (int nAxis = 0; nAxis < 3; nAxis++)
+        {
+          uMin[nAxis] = odmin(vMin[nAxis], m_pending.m_min[nAxis]);
+          uMax[nAxis] = odmax(vMax[nAxis], m_pending.m_max[nAxis]);
+        }
+        if (!m_pending.hasState(m_mfState) || (m_pending.numVertices() + nVertices > OdTrVisPackedGeometryBlock::kMaxVertices) ||
+            !isWithinTolerance(uMin, uMax))
+          sealBlock();
+      }
+      if (!m_pending.numVertices())
+      {
+        for (int nAxis = 0; nAxis < 3; nAxis++)
+          m_pending.m_min[nAxis] = vMin[nAxis], m_pending.m_max[nAxis] = vMax[nAxis];
+        m_pending.m_state = m_mfState;
+        m_pending.m_geomType = m_mfGeomType; m_pending.m_visFlags = m_mfVisFlags;
+      }
+      else
+      {
+        for (int nAxis = 0; nAxis < 3; nAxis++)
+        {
+          m_pending.m_min[nAxis] = odmin(vMin[nAxis], m_pending.m_min[nAxis]);
+          m_pending.m_max[nAxis] = odmax(vMax[nAxis], m_pending.m_max[nAxis]);
+        }
+      }
+      const OdUInt32 base = m_pending.numVertices();
+      m_pending.m_vertices.insert(m_pending.m_vertices.end(), m_mfVertices.begin(), m_mfVertices.end());
+      for (OdUInt32 nRun = 0; nRun < m_mfRuns.size(); nRun++)
+      { const OdTrVisPackedGeometryBlock::DrawCall &run = m_mfRuns[nRun];
+        const OdUInt32 firstIndex = m_pending.m_indices.size();
+        const OdUInt32 *pIndices = m_mfIndices.getPtr() + run.m_firstIndex;
+        for (OdUInt32 nIdx = 0; nIdx < run.m_nIndices; nIdx++)
+          m_pending.m_indices.push_back(OdUInt16(base + pIndices[nIdx]));
+        appendRun(m_pending.m_drawCalls, run.m_primType, firstIndex, run.m_nIndices);
+        OdTrVisPackedGeometryBlock::Source source;
+        source.m_sourceId = sourceId; source.m_nDrawCall = m_pending.m_drawCalls.size() - 1;
+        source.m_firstIndex = firstIndex; source.m_nIndices = run.m_nIndices;
+        m_pending.m_sources.push_back(source);
+      }
+      return true;
+    }
+
+    static void calcExtents(const OdTrVisVertexType *pVertices, OdUInt32 nVertices, OdTrVisVertexType *pMin, OdTrVisVertexType *pMax)
+    {
+      pMin[0] = pMax[0] = pVertices[0]; pMin[1] = pMax[1] = pVertices[1]; pMin[2] = pMax[2] = pVertices[2];
+      for (OdUInt32 nVertex = 1; nVertex < nVertices; nVertex++)
+      {
+        pVertices += 3;
+        for (int nAxis = 0; nAxis < 3; nAxis++)
+        {
+          if (pVertices[nAxis] < pMin[nAxis]) pMin[nAxis] = pVertices[nAxis];
+          else if (pVertices[nAxis] > pMax[nAxis]) pMax[nAxis] = pVertices[nAxis];
+        }
+      }
+    }
+
+    // Rounding to nearest step keeps error within half of step
+    bool isWithinTolerance(const OdTrVisVertexType *pMin, const OdTrVisVertexType *pMax) const
+    {
+      const double maxRange = m_tolerance * 2.0 * OdTrVisPackedGeometryBlock::kQuantizationSteps;
+      for (int nAxis = 0; nAxis < 3; nAxis++)
+      {
+        if (double(pMax[nAxis]) - double(pMin[nAxis]) > maxRange)
+          return false;
+      }
+      return true;
+    }
+
+    // Quantizes current block into output block and resets current block
+    void sealBlock()
+    {
+      const OdUInt32 nVertices = m_pending.numVertices();
+      if (!nVertices)
+        return;
+      m_blocks.push_back(OdTrVisPackedGeometryBlock());
+      OdTrVisPackedGeometryBlock &block = m_blocks.last();
+      block.m_state = m_pending.m_state;
+      block.m_geomType = m_pending.m_geomType; block.m_visFlags = m_pending.m_visFlags;
+      OdUInt16Array *pPos[3] = { &block.m_posX, &block.m_posY, &block.m_posZ };
+      for (int nAxis = 0; nAxis < 3; nAxis++)
+      {
+        const double range = double(m_pending.m_max[nAxis]) - double(m_pending.m_min[nAxis]);
+        const double toSteps = (range > 0.0) ? OdTrVisPackedGeometryBlock::kQuantizationSteps / range : 0.0;
+        block.m_origin[nAxis] = m_pending.m_min[nAxis];
+        block.m_scale[nAxis] = range / OdTrVisPackedGeometryBlock::kQuantizationSteps;
+        pPos[nAxis]->resize(nVertices);
+        OdUInt16 *pOut = pPos[nAxis]->asArrayPtr();
+        const OdTrVisVertexType *pIn = m_pending.m_vertices.getPtr() + nAxis;
+        for (OdUInt32 nVertex = 0; nVertex < nVertices; nVertex++, pIn += 3)
+          pOut[nVertex] = OdUInt16((double(*pIn) - block.m_origin[nAxis]) * toSteps + 0.5);
+      }
+      block.m_indices = m_pending.m_indices;
+      block.m_drawCalls = m_pending.m_drawCalls;
+      block.m_sources = m_pending.m_sources;
+      m_pending = PendingBlock();
+      m_stats.m_nBlocks++;
+      m_stats.m_nDrawCalls += block.m_drawCalls.size();
+      m_stats.m_nBytes += block.memorySize();
+      m_stats.m_maxError = odmax(m_stats.m_maxError, block.maxError());
+    }
+};
+
+#include "TD_PackPop.h"
+
+#endif // ODTRVISMETAFILEPACKER
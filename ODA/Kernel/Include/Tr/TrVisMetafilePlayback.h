@@ -29,6 +29,7 @@
 
 #include "TrVisDefs.h"
 #include "TrVisMetafileStream.h"
+#include "TrVisMetafilePacker.h"
 #include "Gi/GiConveyorGeometry.h"
 #include "MetafileTransformStack.h"
 #define STL_USING_SET
@@ -253,6 +254,135 @@ class OdTrVisMetafileConveyorPlayback : public OdTrVisMetafilePlayback, OdTrVisM
               bool bCheckMarks = true, bool bHighlighted = false);
 };
 
+/** \details
+  Receives draw calls of geometry blocks produced by OdTrVisMetafilePacker. Default implementation splits
+  draw call into separate primitives and passes them into point, line and triangle callbacks; renderers
+  which can bind block arrays override metafilePackedDrawCall() to issue whole range at once.
+
+  Library: Source code provided.
+
+  <group ExRender_Classes>
+*/
+class OdTrVisPackedGeometryPlaybackCallback : public OdTrVisMetafilePlaybackCallback
+{
+  public:
+    // Called for range of block indices which forms points, lines or triangles list
+    virtual bool metafilePackedDrawCall(const OdTrVisPackedGeometryBlock &block, OdTrVisGeomPrim primType,
+                                        OdUInt32 firstIndex, OdUInt32 nIndices)
+    { const OdUInt16 *pIndices = block.m_indices.getPtr() + firstIndex;
+      OdGePoint3d pts[3];
+      switch (primType)
+      {
+        case kTrVisPoints:
+          for (OdUInt32 nIdx = 0; nIdx < nIndices; nIdx++)
+          { pts[0] = block.position(pIndices[nIdx]);
+            if (!metafilePointProc(pts)) return false; }
+        break;
+        case kTrVisLines:
+          for (OdUInt32 nIdx = 0; nIdx + 1 < nIndices; nIdx += 2)
+          { pts[0] = block.position(pIndices[nIdx]); pts[1] = block.position(pIndices[nIdx + 1]);
+            if (!metafileLineProc(pts)) return false; }
+        break;
+        case kTrVisTriangles:
+          for (OdUInt32 nIdx = 0; nIdx + 2 < nIndices; nIdx += 3)
+          { pts[0] = block.position(pIndices[nIdx]); pts[1] = block.position(pIndices[nIdx + 1]); pts[2] = block.position(pIndices[nIdx + 2]);
+            if (!metafileTriangleProc(pts)) return false; }
+        break;
+        default:
+          ODA_FAIL();
+      }
+      return true;
+    }
+};
+
+/** \details
+  Plays geometry blocks produced by OdTrVisMetafilePacker, one callback per draw call. Blocks must be
+  played in order of their creation to keep draw order of source metafiles. Playback stops if callback
+  returns false.
+
+  Library: Source code provided.
+
+  <group ExRender_Classes>
+*/
+class OdTrVisPackedGeometryPlayback : public OdTrVisMetafilePlayback
+{
+  protected:
+    OdTrVisPackedGeometryPlaybackCallback *m_pPackedCallback;
+  public:
+    OdTrVisPackedGeometryPlayback(OdTrVisPackedGeometryPlaybackCallback *pCallback = NULL, PlayType playType = kPlayForSelection,
+                                  PlayMode playMode = kPlayModeUndefined)
+      : OdTrVisMetafilePlayback(pCallback, playType, false, playMode)
+      , m_pPackedCallback(pCallback)
+    {
+    }
+
+    inline void setPackedCallback(OdTrVisPackedGeometryPlaybackCallback *pCallback)
+    {
+      setCallback(pCallback); m_pPackedCallback = pCallback;
+    }
+    inline OdTrVisPackedGeometryPlaybackCallback *packedCallback() const
+    {
+      return m_pPackedCallback;
+    }
+
+    // Plays block geometry, if filter metafiles are set only geometry of filtered sources is played
+    bool playPacked(const OdTrVisPackedGeometryBlock &block, bool bHighlighted = false)
+    {
+      if (!m_pPackedCallback || !isBlockVisible(block, bHighlighted))
+        return true;
+      if (hasFilterMetafiles())
+      { // Adjacent filtered sources of the same draw call are played as single range
+        OdUInt32 nDrawCall = 0, firstIndex = 0, nIndices = 0;
+        for (OdUInt32 nSource = 0; nSource < block.m_sources.size(); nSource++)
+        { const OdTrVisPackedGeometryBlock::Source &source = block.m_sources[nSource];
+          if (!isMetafileFiltered(source.m_sourceId))
+            continue;
+          if (nIndices && (source.m_nDrawCall == nDrawCall) && (source.m_firstIndex == firstIndex + nIndices))
+          {
+            nIndices += source.m_nIndices;
+            continue;
+          }
+          if (nIndices && !m_pPackedCallback->metafilePackedDrawCall(block, block.m_drawCalls[nDrawCall].m_primType, firstIndex, nIndices))
+            return false;
+          nDrawCall = source.m_nDrawCall; firstIndex = source.m_firstIndex; nIndices = source.m_nIndices;
+        }
+        if (nIndices && !m_pPackedCallback->metafilePackedDrawCall(block, block.m_drawCalls[nDrawCall].m_primType, firstIndex, nIndices))
+          return false;
+      }
+      else
+      {
+        for (OdUInt32 nDrawCall = 0; nDrawCall < block.m_drawCalls.size(); nDrawCall++)
+        { const OdTrVisPackedGeometryBlock::DrawCall &drawCall = block.m_drawCalls[nDrawCall];
+          if (!m_pPackedCallback->metafilePackedDrawCall(block, drawCall.m_primType, drawCall.m_firstIndex, drawCall.m_nIndices))
+            return false;
+        }
+      }
+      return true;
+    }
+
+    bool playPacked(const OdTrVisMetafilePacker &packer, bool bHighlighted = false)
+    {
+      for (OdUInt32 nBlock = 0; nBlock < packer.numBlocks(); nBlock++)
+      {
+        if (!playPacked(packer.block(nBlock), bHighlighted))
+          return false;
+      }
+      return true;
+    }
+  protected:
+    bool isBlockVisible(const OdTrVisPackedGeometryBlock &block, bool bHighlighted) const
+    { // Select flags follow display flags of the same condition
+      const int nShift = GETBIT(m_configFlags, kIgnoreNonSelGeom) ? 1 : 0;
+      if (GETBIT(block.m_visFlags, (bHighlighted ? OdTrVisVblFlag_DontDisplayHighlighted : OdTrVisVblFlag_DontDisplayUnhighlighted) << nShift))
+        return false;
+      if (GETBIT(m_configFlags, kIgnore3d) && GETBIT(block.m_visFlags, OdTrVisVblFlag_DontDisplayIn2d << nShift))
+        return false;
+      if (GETBIT(m_configFlags, kIgnore2d) && GETBIT(block.m_visFlags, OdTrVisVblFlag_DontDisplayIn3d << nShift))
+        return false;
+      return m_pPackedCallback->metafileGeomVisibility((OdTrVisGeomType)block.m_geomType);
+    }
+};
+
 #include "TD_PackPop.h"
 
 #endif // ODTRVISMETAFILEPLAYBACK
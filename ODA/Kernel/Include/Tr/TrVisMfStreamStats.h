@@ -28,6 +28,7 @@
 #include "TD_PackPush.h"
 
 #include "TrVisMetafileStream.h"
+#include "TrVisMetafilePacker.h"
 
 /** \details
   Compute statistical metafile stream information.
@@ -44,6 +45,7 @@ class OdTrVisMetafileStreamStats
     DataAsB m_arrayStats[OdTrVisArrayWrapper::Type_Invalid];
     OdUInt32 m_nMetafiles; OdTrVisMetaRecType m_lastChunk;
     const OdUInt8 *m_pPrevStreamPos;
+    OdTrVisMetafilePacker::Stats m_packStats;
   protected:
   public:
     OdTrVisMetafileStreamStats() { clearStats(); }
@@ -53,6 +55,7 @@ class OdTrVisMetafileStreamStats
       ::memset(m_chunkStats, 0, sizeof(m_chunkStats));
       ::memset(m_arrayStats, 0, sizeof(m_arrayStats));
       m_nMetafiles = 0; m_lastChunk = OdTrVisMetaRecType_NTypes; m_pPrevStreamPos = NULL;
+      m_packStats.reset();
     }
 
     void startMetafileAnalyse(const OdTrVisFlatMetafileContainer *pMf)
@@ -76,6 +79,12 @@ class OdTrVisMetafileStreamStats
       m_chunkStats[m_lastChunk = curChunk].first++; m_pPrevStreamPos = pCurStreamPos;
     }
 
+    void addPackingStats(const OdTrVisMetafilePacker::Stats &packStats)
+    {
+      m_packStats.add(packStats);
+    }
+    const OdTrVisMetafilePacker::Stats &packingStats() const { return m_packStats; }
+
     OdString printStats() const
     { OdString resStr; DataAsB arrSumm = DataAsB(0, 0), chunkSumm = DataAsB(0, 0);
       resStr += OdString().format(OD_T("Statistics for %u metafile streams:\n"), m_nMetafiles);
@@ -98,6 +107,12 @@ class OdTrVisMetafileStreamStats
       }
       resStr += OdString().format(OD_T("Summary for %u chunks: %llu bytes\n"), chunkSumm.first, chunkSumm.second);
       resStr += OdString().format(OD_T("Total memory analysed: %llu bytes\n"), arrSumm.second + chunkSumm.second + chunkSumm.first);
+      if (m_packStats.m_nMetafiles)
+      {
+        resStr += OdString().format(OD_T("Packing: %u of %u metafiles merged into %u blocks\n"), m_packStats.m_nPacked, m_packStats.m_nMetafiles, m_packStats.m_nBlocks);
+        resStr += OdString().format(OD_T("Packing: %llu draw calls replaced by %llu (%lld saved)\n"), m_packStats.m_nSrcDrawCalls, m_packStats.m_nDrawCalls, m_packStats.savedDrawCalls());
+        resStr += OdString().format(OD_T("Packing: %llu bytes replaced by %llu (%lld saved), max position error %g\n"), m_packStats.m_nSrcBytes, m_packStats.m_nBytes, m_packStats.savedBytes(), m_packStats.m_maxError);
+      }
       return resStr;
     }
 };